@@ -0,0 +1,71 @@
+/**********
+ libmoirai.h
+
+ public interface of the Moirai LDS library (libmoirai.a), for running moirai from another program
+    the moirai command line program (moirai_main.c) is a thin wrapper around these functions
+ the runs are serialized, not reentrant
+    the stage arrays are not in the context yet: moving them into moirai_ctx and passing the context through the stages
+    is a separate change that has not been done, so two contexts cannot run at the same time in one process
+
+ a run is described by a moirai_ctx, which is created from an input control file and owns the input arguments,
+    the raster info, and the log file of the run
+ the context does not own the stage arrays: the stage functions still share the process-wide tables declared in moirai.h,
+    so a process runs one context at a time, from any thread:
+    moirai_ctx_run() returns ERROR_USAGE (1) if another context is running, also when the runs are started by different threads
+    the run-level tables are set up at the start of each run and freed at its end,
+    so different configurations can be run one after the other in the same process
+
+ usage:
+    int err;
+    moirai_ctx *ctx = moirai_ctx_create("input_files/moirai_input_basins235.txt", &err);
+    if (ctx != NULL) {
+        err = moirai_ctx_run(ctx);
+        moirai_ctx_free(ctx);
+    }
+
+ functions:
+ moirai_ctx_create():	read the input control file into a new context; NULL on error, with the error code in error_code
+ moirai_ctx_create_overrides():	the same, with blank separated name=value overrides of input control file values,
+						e.g. "diagnostics=1 outpath=./test/"; the names are the ones in the input file comments
+ moirai_ctx_run():		run the whole pipeline for the context; returns the moirai error code (0 = OK)
+ moirai_ctx_outpath():	the output path of the context, from the input control file
+ moirai_ctx_free():		free the context; returns ERROR_USAGE (1) without freeing it if its run is active
+ moirai_serve():		run contexts for requests from a local unix socket until a quit request; see moirai_serve.c
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+ **********/
+
+#ifndef LIBMOIRAI_H
+#define LIBMOIRAI_H
+
+typedef struct moirai_ctx moirai_ctx;	// one moirai run; defined in moirai.h
+
+moirai_ctx *moirai_ctx_create(const char *input_fname, int *error_code);
+moirai_ctx *moirai_ctx_create_overrides(const char *input_fname, const char *overrides, int *error_code);
+int moirai_ctx_run(moirai_ctx *ctx);
+const char *moirai_ctx_outpath(const moirai_ctx *ctx);
+int moirai_ctx_free(moirai_ctx *ctx);
+int moirai_serve(const char *socket_path);
+
+#endif
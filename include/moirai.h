@@ -61,6 +61,7 @@
 #include <time.h>
 #include <ctype.h>
 #include <netcdf.h>
+#include "libmoirai.h"
 
 #define CODENAME				"moirai"				// name of the compiled program
 #define VERSION         		"3.1"           			// current version
@@ -78,7 +79,7 @@
 
 // counts of useful variables
 //kbn 2020-06-01 Updating input arguments to include 6 new carbon states for soil_carbon
-#define NUM_IN_ARGS						76					// number of input variables in the input file
+#define NUM_IN_ARGS						86					// number of input variables in the input file
 #define NUM_ORIG_AEZ						18							// number of original GTAP/GCAM AEZs
 
 // necessary FAO input data info
@@ -128,24 +129,28 @@
 // useful flags and values
 #define NOMATCH					-1				// if there isn't a matching country across data sets
 #define NA_TEXT                  "-"            // if there is no iso3 or name for a country/territory
+#define NONE_TEXT				"none"			// input file value for an optional output file that is not written
+#define ALL_TEXT				"all"			// input file value for processing every available hyde year
+#define TABLE_CSV_TEXT			"csv"			// input file value for writing the csv output tables
+#define TABLE_NC_TEXT			"nc"			// input file value for writing the netcdf-4 output tables
+#define TABLE_CSV				1				// table_format flag: write the csv land type area and ref veg carbon tables
+#define TABLE_NC				2				// table_format flag: write the netcdf-4 land type area and ref veg carbon tables
 #define FAOCTRY2GCAMCTRYAEZID   10000           // the gcam country+aez id is fao country id * 10000 + aez id; this is also used for the region-glu image
 #define ZERO_THRESH				1/1000000.0		// if a landtype area value is less than this, it is zero
 #define ROUND_TOLERANCE			1/1000000.0		// tolerance for checking sums and zeros in read_protected and proc_lulc_area
 
-// working resolution is 5 arcmin (2160x4320), WGS84 spherical earth, lat-lon projection
+// working resolution is set by grid_res_sec in the input file (default 5 arcmin, 2160x4320)
+// WGS84 spherical earth, lat-lon projection
 // the origin is the upper left corner at 90 Lat and -180 Lon
 // the lat/lon dimensions need to have an even number of cells
-#define NUM_LAT					2160						// number of lats in working grids
-#define NUM_LON					4320						// number of lons in working grids
-#define NUM_CELLS				(NUM_LAT * NUM_LON)			// number of grid cells in working grids
-#define GRID_RES				(5.0/60.0)					// working grid resolution; decimal degree
-#define GRID_RES_SEC			300.0						// workding grid resolution; arc-seconds
+// the grid dimensions are runtime globals set by set_grid_geometry(); see below
+#define DEFAULT_GRID_RES_SEC	300.0						// default working grid resolution; arc-seconds
 #define NODATA					-9999						// nodata value
 
 // LULC input grid; the origin corner is 0 lon and -90 lat
-#define NUM_LAT_LULC			360							// number of lats in input lulc data
-#define NUM_LON_LULC			720							// number of lons in input lulc
-#define NUM_CELLS_LULC			(NUM_LAT_LULC * NUM_LON_LULC)			// number of grid cells in input lulc data
+// resolution is set by lulc_res_sec in the input file (default 30 arcmin, 360x720)
+// it must be an integer multiple of the working grid resolution
+#define DEFAULT_LULC_RES_SEC	1800.0						// default lulc input resolution; arc-seconds
 
 // some constants for calculating the area of a grid cell
 #define AVE_ER					6371007.181		// average earth radius; from MODIS land products WGS84 average spherical radius;  meters
@@ -164,6 +169,43 @@
 #define ERROR_IND				6							// error associated with failed index finding
 #define ERROR_COPY				7							// error associated with failed copy of output file
 
+// stage profile report; see stage_profile.c
+#define MAX_PROF_STAGES			200							// maximum number of profiled stages in one run
+#define MAX_PROF_NAME			100							// maximum length of a profiled stage name
+#define MAX_PROF_READERS		4							// maximum number of readers with i/o throughput in one stage
+#define STAGE_PROF_SUFFIX		"_stage_profile.json"		// replaces the log file extension to name the stage profile report
+
+// netcdf-4 output tables; see write_nc_table.c
+#define MAX_NC_TABLE_COLS		8							// maximum number of key or value columns of a table
+
+// unzipped sage crop netcdf file; see read_sage_crop.c
+#define SAGE_CROP_NCTAG			"_AreaYieldProduction.nc"	// suffix for the sage crop base file names
+
+// year-major spill file of the land type area; see year_spill.c
+#define YEAR_SPILL_FNAME		"land_type_area_years.tmp"	// written to the output path of each glu scenario, and removed
+
+// per-cell land type area store; see cell_store.c
+#define CELL_STORE_MAGIC		"MOIRAICS"					// first 8 bytes of the store file
+#define CELL_STORE_VERSION		1							// store layout version
+#define CELL_STORE_ISO_LEN		8							// bytes per iso abbreviation in the store country table
+#define CELL_STORE_ALIGN		8							// every store section starts at a multiple of this many bytes
+
+// stage checkpoint store; see checkpoint.c
+#define CHECKPOINT_VERSION		"1"							// change this when a checkpointed stage computes different outputs from the same inputs
+#define CHECKPOINT_DIGEST_BYTES	1048576						// the content of input files up to this size is in the key
+
+// stages that serve mode can keep or skip between requests; see serve_stages.c
+#define SERVE_SHARED_RASTERS	0							// the glu independent rasters and reference year areas, kept resident
+#define SERVE_MIRCA				1							// proc_mirca()
+#define SERVE_LAND_TYPE_AREA	2							// proc_land_type_area()
+#define SERVE_REFVEG_CARBON		3							// proc_refveg_carbon()
+#define SERVE_WATER_FOOTPRINT	4							// proc_water_footprint()
+#define SERVE_CROP_RENT			5							// proc_crop_rent()
+#define NUM_SERVE_STAGES		6
+#define SERVE_RUN				0							// status: the stage is processed in this request
+#define SERVE_KEPT				1							// status: the stage is not processed; its outputs are kept from an earlier request
+#define SERVE_RESTORED			2							// status: the stage is not processed; its outputs are restored from a checkpoint
+
 
 // variables for number of records based on input files
 int NUM_FAO_CTRY;                       // number of FAO/VMAP0 countries, including additions (see FAO_iso_VMAP0_ctry.csv)
@@ -177,10 +219,24 @@ int NUM_SAGE_CROP;						// number of SAGE crops (SAGE_crop) (see SAGE_gtap_fao_c
 int NUM_HYDE_TYPES;						// number of hyde land use types/files; the first 3 describe the total land use state
 int NUM_LULC_TYPES;						// number of input lulc types
 
+// working and lulc grid geometry; set by set_grid_geometry() from the input file
+int NUM_LAT;							// number of lats in working grids
+int NUM_LON;							// number of lons in working grids
+int NUM_CELLS;							// number of grid cells in working grids
+double GRID_RES;						// working grid resolution; decimal degree
+double GRID_RES_SEC;					// working grid resolution; arc-seconds
+int NUM_LAT_LULC;						// number of lats in input lulc data
+int NUM_LON_LULC;						// number of lons in input lulc data
+int NUM_CELLS_LULC;						// number of grid cells in input lulc data
+
+// hyde years to process; set by set_hyde_years() from the input file
+int num_hyde_years;						// number of hyde years to process for the land type area
+int *hyde_years;						// the hyde years to process, in increasing order
+
 // for downscaling the lulc data to the working grid
 int NUM_LU_CELLS;		// the number of lu working grid cells within a coarser res lulc cell
 float **rand_order;		// the array to store the within-coarse-cell-index of the lu cell, or each lulc cell
-float *****refveg_carbon_out;		// the potveg carbon out table;4th dim is the state of carbon; 5th dim is the two carbon density values and the area
+float ***refveg_carbon_out;		// the potveg carbon out table; dim1 is the refveg_carbon_tally slot, dim2 is the carbon type, dim3 is the state of carbon
 // useful utility variables
 char systime[MAXCHAR];					// array to store current time
 FILE *fplog;							// file pointer to log file for runtime output
@@ -204,6 +260,15 @@ int **reglr_aez_list;                   // AEZ codes for each land rent region -
 int *reglr_aez_num;                     // number of AEZs for each land rent region
 int **reggcam_aez_list;                 // AEZ codes for each gcam region - dim1=gcam region, dim2=aez codes
 int *reggcam_aez_num;                   // number of AEZs for each gcam region
+// glu index maps, made by write_glu_mapping() after the lists are sorted; NOMATCH = no region or glu
+int *ctry2reglr_ind;                    // land rent region index for each fao country
+int *ctry87_code2ind;                   // land rent region index of each land rent region code - dim=max_ctry87_code+1
+int max_ctry87_code;                    // largest land rent region code in country87codes_gtap
+int *ctry2reggcam_ind;                  // gcam region index for each fao country
+int **ctry_aez_reglr_ind;               // index in reglr_aez_list of each country aez - dim1=fao country, dim2=ctry_aez_num
+int **ctry_aez_reggcam_ind;             // index in reggcam_aez_list of each country aez - dim1=fao country, dim2=ctry_aez_num
+int *aez_code2ind_new;                  // index in aez_codes_new of each glu code - dim=max_aez_code_new+1
+int max_aez_code_new;                   // largest glu code in aez_codes_new
 // list of land type category mappings for the land type area and potveg carbon csv outputs
 int num_lt_cats;        // the number of categories
 int *lt_cats;           // the list of categories
@@ -217,7 +282,8 @@ float *hkg_glu_area;                // total valid taiwan glu area
 
 // raster data as 1-d arrays; numlat * numlon, start at upper left corner, lon varies fastest [NUM_LAT X NUM_LON]
 // these are allocated and free dynamically as needed in moirai_main.c
-// they are all 1d arrays of size NUM_CELLS, which is currently hardcoded for the 5 arcmin resolution
+// they are all 1d arrays of size NUM_CELLS, which is set at runtime from grid_res_sec
+// except harvestarea_in and yield_in, which hold one latitude band of at most band_nrows rows, windowed to the region subset (see get_lat_band.c)
 float *harvestarea_in;                  // input harvest area (km^2), reused by each individual crop
 float *yield_in;                        // input yield (metric tonnes / km^2), reused by each individual crop
 int *aez_bounds_new;                    // new aez boundaries (integers 1 to NUM_NEW_AEZ)
@@ -233,8 +299,6 @@ int *potveg_thematic;                   // potential vegetation thematic data (i
 int *refveg_thematic;                   // reference vegetation thematic data (integers 1 to NUM_SAGE_PVLT)
 int *refvegcarbon_thematic;                   // reference vegetation thematic data (integers 1 to NUM_SAGE_PVLT)
 short *country_fao;                     // fao country codes (integer fao code values)
-float *cell_area;                       // total area of grid cell; calculated based on spherical earth (km^2)
-float *cell_area_hyde;                  // total area of hyde land grid cells; from hyde data set (km^2)
 float *land_area_sage;                  // max land area of sage working grid cell (km^2)
 float *land_area_hyde;                  // max land area of hyde data cells (km^2)
 float *sage_minus_hyde_land_area;       // difference between the sage and hyde land area (km^2)
@@ -253,14 +317,37 @@ int *land_mask_potveg;                  // 1=land; 0=no land
 int *land_mask_refveg;                  // 1=land; 0=no land
 int *land_mask_forest;                  // 1=forest; 0=no forest
 
+// working grid geometry (see get_cell_area.c)
+// on a regular lat-lon grid the cell area depends only on the row, so it is stored per row [NUM_LAT]
+// use cell_area_at() and cell_area_hyde_at() to get the area of a working grid cell
+float *cell_area_row;                   // total area of the grid cells in each row; calculated based on spherical earth (km^2)
+float *cell_area_hyde_row;              // total area of the hyde land grid cells in each row; from hyde data set (km^2)
+unsigned char *cell_area_hyde_valid;    // bit mask of the cells with a valid hyde cell area; NULL if all are valid
+float *cell_area_hyde;                  // hyde cell area raster [NUM_CELLS], kept only if the input varies along a row; else NULL
+
+static inline float cell_area_at(int cell) {
+	return cell_area_row[cell / NUM_LON];
+}
+
+// NODATA if the hyde cell area of the cell is not valid
+static inline float cell_area_hyde_at(int cell) {
+	if (cell_area_hyde != NULL) {
+		return cell_area_hyde[cell];
+	}
+	if (cell_area_hyde_valid != NULL && !(cell_area_hyde_valid[cell / 8] & (1 << (cell % 8)))) {
+		return NODATA;
+	}
+	return cell_area_hyde_row[cell / NUM_LON];
+}
+
 //kbn 2020-02-29 Introducing objects for protected area rasters from Category 1 to 7
 float **protected_EPA; //dim 1 is the type of protected area, dim 2 is the grid cell
 //kbn 2020-06-01 Changing soil carbon variable
 //kbn 2020-06-29 Changing vegetation carbon variable
 float **soil_carbon_sage; //dim 1 is the type of state, dim 2 is the grid cell
-int ***soil_carbon_array_cells;//These are the total number of cells contained within each array
-float *****soil_carbon_array; //soil carbon array to calculate the soil carbon values for each state
-float *****veg_carbon_array; //vegetation carbon array to calculate vegetation carbon values for each state
+int *soil_carbon_array_cells;//These are the total number of cells contained within each array; dim 1 is the refveg_carbon_tally slot
+float ***soil_carbon_array; //soil carbon array to calculate the soil carbon values for each state; dim 1 is the refveg_carbon_tally slot
+float ***veg_carbon_array; //vegetation carbon array to calculate vegetation carbon values for each state; dim 1 is the refveg_carbon_tally slot
 float **veg_carbon_sage;  //dim 1 is the type of state, dim 2 is the grid cell
 //Add above and below ground ratio for vegetation carbon
 float **above_ground_ratio; //dim 1 is the type of state, dim 2 is the grid cell
@@ -339,6 +426,22 @@ int *lulc2hydecodes;									// isam lulc types to hyde32 lu types
 
 // data structure to store information about the input rasters
 typedef struct {
+	// working grid geometry; from grid_res_sec and lulc_res_sec in the input file
+	int grid_nrows;				// working grid number of rows
+	int grid_ncols;				// working grid number of columns
+	int grid_ncells;			// working grid number of grid cells
+	double grid_res;			// working grid resolution, decimal degrees
+	double grid_res_sec;		// working grid resolution, arc-seconds
+	double lulc_res;			// lulc input resolution, decimal degrees
+	int num_split;				// number of working grid cells in one dimension of a lulc cell
+	int band_nrows;				// number of working grid rows in one latitude band; grid_nrows if not tiled
+	int num_bands;				// number of latitude bands covering the working grid
+	int subset;					// 1 if the run is restricted to the region_subset countries; 0 = whole globe
+	int subset_row_min;			// first working grid row with a subset glu cell
+	int subset_row_max;			// last working grid row with a subset glu cell
+	int subset_col_min;			// first working grid column with a subset glu cell
+	int subset_col_max;			// last working grid column with a subset glu cell
+
 	// working grid cell area; calculated
 	int cell_area_nrows;		// input number of rows
 	int cell_area_ncols;		// input number of columns
@@ -572,8 +675,188 @@ typedef struct {
     char wf_fname[MAXCHAR];                 // file name for water footprint output
     char iso_map_fname[MAXCHAR];            // file name for mapping the raaster fao country codes to iso
     char lt_map_fname[MAXCHAR];             // file name for mapping the land type category codes to descriptions
+    char trace_fname[MAXCHAR];              // file name for the optional chrome trace event timeline; NONE_TEXT = no trace
+
+	// grid geometry
+	double grid_res_sec;				// working grid resolution, arc-seconds; must divide 180 degrees into an even number of rows
+	double lulc_res_sec;				// lulc input resolution, arc-seconds; must be an integer multiple of grid_res_sec
+	int band_lulc_rows;					// lulc rows in each latitude band of the crop raster reads; 0 = read the whole globe at once
+
+	// region subset
+	char region_subset[MAXCHAR];		// countries to process: iso:usa,can or region:1,7 or glu:12,35; NONE_TEXT = whole globe
+
+	// hyde years
+	char hyde_years[MAXCHAR];			// hyde years for the land type area: a list of years and ranges, e.g. 1975-2015; ALL_TEXT = all years
+
+	// glu batch
+	char glu_batch_fname[MAXCHAR];		// file name for the glu scenario batch file; NONE_TEXT = one run with aez_new_fname
+
+	// cell store
+	char cell_store_fname[MAXCHAR];		// file name for the per-cell land type area store (in outpath); NONE_TEXT = not written
+
+	// checkpoint
+	char checkpoint_path[MAXCHAR];		// path to the stage checkpoint store (with final "/"); NONE_TEXT = no checkpoints
+
+	// output table format
+	int table_format;					// formats of the land type area and ref veg carbon tables: TABLE_CSV and/or TABLE_NC
 } args_struct;
 
+// data structure to store the reads of one reader in a stage; see add_stage_reads() in stage_profile.c
+typedef struct {
+	char name[MAX_PROF_NAME];	// reader name, e.g. read_sage_crop
+	int num_reads;				// number of reads
+	long long bytes;			// bytes read (uncompressed data values)
+	double read_sec;			// wall time of the reads (s)
+} prof_reader_struct;
+
+// data structure to store the run time and resource use of one pipeline stage; see stage_profile.c
+typedef struct {
+	char name[MAX_PROF_NAME];	// stage name
+	double start_sec;			// wall time from the start of the run to the start of the stage (s)
+	double wall_sec;			// wall time (s)
+	double user_sec;			// user cpu time of this process (s)
+	double sys_sec;				// system cpu time of this process (s)
+	double child_sec;			// cpu time of child processes waited for during the stage, e.g. unzip (s)
+	long long bytes_read;		// bytes read by this process; -1 = not available
+	long long bytes_written;	// bytes written by this process; -1 = not available
+	long rss_start_kb;			// resident set size at the start of the stage (kB); -1 = not available
+	long rss_end_kb;			// resident set size at the end of the stage (kB); -1 = not available
+	long rss_hwm_kb;			// resident set size high-water mark during the stage (kB); -1 = not available
+	int hwm_reset;				// 1 = the high-water mark was reset at the start of the stage; 0 = it is the process high-water mark
+	int num_readers;			// number of readers with i/o throughput
+	prof_reader_struct readers[MAX_PROF_READERS];	// the reads of the readers that report them, e.g. the netcdf readers
+} stage_prof_struct;
+
+stage_prof_struct stage_prof[MAX_PROF_STAGES];	// the profiled stages, in run order
+int num_prof_stages;							// the number of completed profiled stages
+
+// data structure to store one glu scenario of a run; see read_glu_batch.c
+// the glu fields are filled by proc_glu_scenario() and held until the end of the run
+//	so that proc_land_type_area() can aggregate the land type area of every scenario in one pass
+typedef struct {
+	char name[MAXCHAR];					// scenario name; the output subdirectory in a batch run
+	char aez_new_fname[MAXCHAR];		// glu raster file name
+	char aez_new_info_fname[MAXCHAR];	// glu info file name
+	char outpath[MAXCHAR];				// output path
+	char ldsdestpath[MAXCHAR];			// destination path for the gcam data system input files
+	char mapdestpath[MAXCHAR];			// destination path for the mapping files
+	int *aez_bounds;					// glu raster after the region subset
+	int aez_nodata;						// glu raster nodata value
+	int *ctry_aez_num;					// number of glus in each fao country
+	int **ctry_aez_list;				// glu codes in each fao country
+	int subset_row_min;					// region subset bounding box; the whole working grid if there is no subset
+	int subset_row_max;
+	int subset_col_min;
+	int subset_col_max;
+} glu_scen_struct;
+
+glu_scen_struct *glu_scen;			// the glu scenarios of the run, in batch file order
+int num_glu_scen;					// the number of glu scenarios; 1 if there is no batch file
+
+// header of the per-cell land type area store file; see cell_store.c for the layout that follows it
+// this is also read by tools/moirai_reaggregate.c
+typedef struct {
+	char magic[8];				// CELL_STORE_MAGIC, without the terminating null
+	int version;				// CELL_STORE_VERSION
+	int num_cells;				// number of stored working grid cells
+	int num_years;				// number of hyde years
+	int num_lt_cats;			// number of land type categories
+	int num_ctry;				// number of fao countries in the country table
+	int num_protected;			// number of protected categories
+	int grid_nrows;				// working grid rows
+	int grid_ncols;				// working grid columns
+	int refveg_nodata;			// nodata value of the reference veg area
+	int lu_nodata;				// nodata value of the crop, pasture, and urban areas
+} cell_store_header_struct;
+
+// one record of the land type area spill file; see year_spill.c
+typedef struct {
+	int year_ind;				// index in hyde_years
+	int ctry_ind;				// fao country index
+	int aez_ind;				// glu index in the country glu list of the scenario
+	int lt_ind;					// land type category index in lt_cats
+	double area;				// area (km^2)
+} year_spill_rec_struct;
+
+// the land type area spill file of one glu scenario, with one run of records per year; see year_spill.c
+typedef struct {
+	char fname[MAXCHAR];			// file name with path
+	FILE *fp;						// the open file
+	int num_years;					// number of year runs
+	int cur_year;					// the run that is being written
+	long num_records;				// number of records written
+	long *run_start;				// first record of each run; dim = num_years + 1
+	long *run_pos;					// next record of each run to read in the merge
+	year_spill_rec_struct *buf;		// merge buffers; dim1 = year, dim2 = YEAR_SPILL_BUF_RECORDS
+	int *buf_len;					// number of records in each merge buffer
+	int *buf_pos;					// next record in each merge buffer
+} year_spill_struct;
+
+// sparse tally of the country X glu X land type category combinations that occur; see lt_tally.c
+typedef struct {
+	int *ctry_start;			// first country glu pair of each fao country; dim = NUM_FAO_CTRY + 1
+	int num_pairs;				// number of country glu pairs
+	int *num_keys;				// number of keys of each pair
+	int *max_keys;				// allocated number of keys of each pair
+	int **key_lt;				// land type category index of the keys of each pair, in increasing order
+	int **key_slot;				// slot of the keys of each pair
+	int num_slots;				// number of keys in all the pairs
+	int max_slots;				// allocated number of values
+	double *vals;				// one value per slot
+} lt_tally_struct;
+
+lt_tally_struct refveg_carbon_tally;	// the reference veg carbon keys of the current glu scenario; see write_glu_mapping.c
+
+// a read-only view of a binary raster file; see raster_view.c
+// the file is memory mapped, so its pages are loaded on first use and shared through the page cache
+typedef struct {
+	const void *data;			// the file contents, as values of insize bytes; NULL if the view is not open
+	int insize;					// bytes per value
+	int num_vals;				// number of whole values in the file
+	size_t map_bytes;			// bytes mapped; 0 if the contents were read into memory instead
+} raster_view_struct;
+
+// typed access to the values of a view
+static inline const float *raster_view_float(const raster_view_struct *view) { return (const float *) view->data; }
+static inline const int *raster_view_int(const raster_view_struct *view) { return (const int *) view->data; }
+static inline const short *raster_view_short(const raster_view_struct *view) { return (const short *) view->data; }
+
+// a long format output table for the netcdf-4 table format; see write_nc_table.c
+typedef struct {
+	int num_keys;								// number of key columns
+	int num_vals;								// number of value columns
+	const char *key_names[MAX_NC_TABLE_COLS];	// key column names; the coordinate dimension and variable names
+	char **key_labels[MAX_NC_TABLE_COLS];		// labels of the key values, indexed by key value; NULL = int coordinates
+	const char *val_names[MAX_NC_TABLE_COLS];	// value column names
+	const char *units;							// units of the values
+	int num_records;							// number of records
+	int max_records;							// allocated number of records
+	int *keys;									// key values; dim1=record, dim2=key
+	double *vals;								// values; dim1=record, dim2=value
+	// a table that is opened with open_nc_table() is written in slices as it is collected
+	//	the records above are then the slice that is not yet written
+	int is_open;								// 1 if the table file is open for the slices
+	int ncid;									// netcdf id of the open file
+	char fname[MAXCHAR];						// file name of the open file
+	int total_records;							// the record dimension length of the open file
+	int num_written;							// the number of records written to the open file
+	int *coords[MAX_NC_TABLE_COLS];				// the coordinates of each key of the open file, in increasing order
+	int num_coords[MAX_NC_TABLE_COLS];			// the number of coordinates of each key of the open file
+	int index_varid[MAX_NC_TABLE_COLS];			// key index map variable ids of the open file
+	int val_varid[MAX_NC_TABLE_COLS];			// value variable ids of the open file
+	int *index_col;								// one index map column of a slice
+	double *val_col;							// one value column of a slice
+} nc_table_struct;
+
+// one moirai run of the library interface; see libmoirai.h and moirai_ctx.c
+struct moirai_ctx {
+	char input_fname[MAXCHAR];	// the input control file
+	args_struct in_args;		// data structure for holding the control input file info
+	rinfo_struct raster_info;	// data structure for storing raster input file specific info
+	FILE *fplog;				// the log file of the run; fplog points to it while the run is active
+	char overrides[MAXRECSIZE];	// the name=value input argument overrides applied to the input control file; empty = none
+};
+
 // function declarations
 
 // read raster file functions
@@ -590,8 +873,8 @@ int read_urban(args_struct in_args, rinfo_struct *raster_info);
 int read_country_fao(args_struct in_args, rinfo_struct *raster_info);
 int read_country_gcam(args_struct in_args, rinfo_struct *raster_info);
 int read_region_gcam(args_struct in_args, rinfo_struct *raster_info);
-int read_sage_crop(char *fname, char *sagepath, char *cropfilebase_sage, rinfo_struct raster_info);
-int read_mirca(char *fname, float *mirca_grid);
+int read_sage_crop(char *fname, char *sagepath, char *cropfilebase_sage, rinfo_struct raster_info, int first_row, int num_rows);
+int read_mirca(char *fname, int first_row, int num_rows, int first_col, int num_cols, long *fpos, int *fpos_row, float *mirca_grid);
 int read_protected(args_struct in_args, rinfo_struct *raster_info);
 int read_lu_hyde(args_struct in_args, int year, float *crop_grid, float *pasture_grid, float *urban_grid);
 int read_lulc_isam(args_struct in_args, int year, float **lulc_input_grid);
@@ -601,6 +884,7 @@ int read_hyde32(args_struct in_args, rinfo_struct *raster_info, int year, float*
 int read_soil_carbon(args_struct in_args, rinfo_struct *raster_info);
 //kbn 2020-06-01 Changing veg carbon function below
 int read_veg_carbon(args_struct in_args, rinfo_struct *raster_info);
+int check_nc_grid(int ncid, int ncvarid, int nrows, int ncols, const char *fname);
 // read csv file functions
 int read_rent_orig(args_struct in_args);
 int read_country87_info(args_struct in_args);
@@ -610,18 +894,22 @@ int read_aez_new_info(args_struct in_args);
 int read_use_info_gtap(args_struct in_args);
 int read_lulc_info(args_struct in_args);
 int read_crop_info(args_struct in_args);
+int read_glu_batch(args_struct in_args);
 int read_production_fao(args_struct in_args);
 int read_yield_fao(args_struct in_args);
 int read_harvestarea_fao(args_struct in_args);
 int read_prodprice_fao(args_struct in_args);
-int read_water_footprint(char *fname, float *wf_grid);
+int read_water_footprint(char *fname, int first_row, int num_rows, int first_col, int num_cols, float *wf_grid);
 
 
 // raster processing functions
 int get_land_cells(args_struct in_args, rinfo_struct raster_info);
 int calc_refveg_area(args_struct in_args, rinfo_struct *raster_info);
 int calc_refcarbon_area(args_struct in_args, rinfo_struct raster_info);
+int set_carbon_arrays(void);
 int get_aez_val(int aez_array[], int index, int nrows, int ncols, int nodata_val, int *value);
+int get_lat_band(int cell, rinfo_struct raster_info, int *band_start_cell, int *band_end_cell);
+int get_band_cell(int cell, int band_start_cell, rinfo_struct raster_info);
 int proc_water_footprint(args_struct in_args, rinfo_struct raster_info);
 
 // additional spatial data processing functions
@@ -629,6 +917,8 @@ int proc_mirca(args_struct in_args, rinfo_struct raster_info);
 int proc_lulc_area(args_struct in_args, rinfo_struct raster_info, double *lulc_area, int *lu_indices, double **lu_area, double *refveg_area_out, int *refveg_them, int num_lu_cells, int lulc_index);
 int proc_land_type_area(args_struct in_args, rinfo_struct raster_info);
 int proc_refveg_carbon(args_struct in_args, rinfo_struct raster_info);
+int proc_crop_rent(args_struct in_args, rinfo_struct *raster_info, int scen_ind);
+int proc_glu_scenario(args_struct in_args, rinfo_struct *raster_info, int scen_ind);
 
 // text parsing utility functions (parse_utils.c)
 int get_float_field(char *line, const char *delim, int findex, float *fltval);
@@ -653,7 +943,7 @@ int write_rent_use_aez(args_struct in_args);
 int write_glu_mapping(args_struct in_args, rinfo_struct raster_info);
 
 // diagnostic write functions
-int write_raster_float(float out_array[], int out_length, char *out_name, args_struct in_args);
+int write_raster_float(const float out_array[], int out_length, char *out_name, args_struct in_args);
 int write_raster_int(int out_array[], int out_length, char *out_name, args_struct in_args);
 int write_raster_short(short out_array[], int out_length, char *out_name, args_struct in_args);
 int write_text_int(int out_array[], int out_length, char *out_name, args_struct in_args);
@@ -661,12 +951,95 @@ int write_text_char(char **out_array, int out_length, char *out_name, args_struc
 int write_csv_float3d(float out_array[], int d1[], int d2[], int d1_length, int d2_length, int d3_length,
 					  char *out_name, args_struct in_args);
 int write_csv_float2d(float out_array[], int d1[], int d1_length, int d2_length, char *out_name, args_struct in_args);
+int write_csv_sparse3d(float ***out_array, int d1[], int d1_length, int d2_num[], int **d2_list, int d3[], int d3_length,
+					   float scale, char *out_name, args_struct in_args);
+int write_csv_sparse2d(float **out_array, int d1[], int d1_length, int d2_num[], int **d2_list, char *out_name,
+					   args_struct in_args);
+// netcdf-4 output tables (write_nc_table.c)
+int init_nc_table(nc_table_struct *table, int num_keys, const char *key_names[], int num_vals, const char *val_names[],
+				  const char *units);
+int add_nc_table_record(nc_table_struct *table, const int keys[], const double vals[]);
+int write_nc_table(const nc_table_struct *table, const char *fname, const char *description);
+int open_nc_table(nc_table_struct *table, const char *fname, const char *description, int num_records,
+				  int *coords[], const int num_coords[]);
+int close_nc_table(nc_table_struct *table);
+void free_nc_table(nc_table_struct *table);
+void get_nc_table_fname(char *nc_fname, const char *csv_fname);
 
 // utility functions
 char *get_systime();
 int init_moirai(args_struct *in_args);
-int get_in_args(const char *fname, args_struct *in_args);
+int get_in_args(const char *fname, const char *overrides, args_struct *in_args);
+int set_grid_geometry(args_struct in_args, rinfo_struct *raster_info);
+int set_region_subset(args_struct in_args, rinfo_struct *raster_info);
+int set_hyde_years(args_struct in_args);
 int copy_to_destpath(args_struct in_args);
+int copy_land_type_area(args_struct in_args);
+int make_dirs(const char *path);
+void free_shared_rasters(rinfo_struct raster_info);
+void free_glu_tables(int all);
+// stage profiling functions (stage_profile.c)
+int init_stage_profile(args_struct in_args);
+int start_stage(const char *stage_name);
+int end_stage(void);
+int add_stage_reads(const char *reader, long long bytes, double read_sec);
+int write_stage_profile(int run_complete);
+// trace event timeline functions (trace_event.c)
+int init_trace(args_struct in_args);
+int trace_begin(const char *cat, const char *fmt, ...);
+int trace_end(void);
+void close_trace(void);
+// per-cell land type area store functions (cell_store.c)
+int init_cell_store(args_struct in_args, rinfo_struct raster_info, int row_min, int row_max, int col_min, int col_max);
+int add_cell_store(int grid_ind, int ctry_ind, int rv_value, double refveg_area, double crop_area, double pasture_area,
+				   double urban_area);
+int write_cell_store_year(int year_ind);
+int close_cell_store(void);
+// year-major land type area spill functions (year_spill.c)
+int open_year_spill(year_spill_struct *spill, const char *fname, int num_years);
+int add_year_spill(year_spill_struct *spill, int year_ind, int ctry_ind, int aez_ind, int lt_ind, double area);
+int start_year_merge(year_spill_struct *spill);
+int next_year_merge(year_spill_struct *spill, year_spill_rec_struct *rec, int *found);
+int close_year_spill(year_spill_struct *spill);
+// sparse country X glu X land type tally functions (lt_tally.c)
+int init_lt_tally(lt_tally_struct *tally, const int *ctry_aez_num);
+int add_lt_tally_key(lt_tally_struct *tally, int ctry_ind, int aez_ind, int lt_ind, int *slot);
+int find_lt_tally_slot(const lt_tally_struct *tally, int ctry_ind, int aez_ind, int lt_ind);
+void free_lt_tally(lt_tally_struct *tally);
+// binary raster file reading with the optional resident cache (raster_cache.c)
+int init_raster_cache(void);
+int read_raster_file(const char *fname, void *data, int insize, int ncells, int *num_read);
+int read_raster_block(const char *fname, void *data, int insize, int first, int ncells, int *num_read);
+int free_raster_cache(void);
+// memory mapped read-only raster views (raster_view.c)
+int open_raster_view(const char *fname, int insize, int ncells, raster_view_struct *view, int *num_read);
+int close_raster_view(raster_view_struct *view);
+// netcdf access layer for the large netcdf readers (nc_access.c)
+int nc_access_open(const char *fname, int *ncid);
+int nc_access_varid(int ncid, const char *varname, int *varid);
+int nc_access_read_float(int ncid, int varid, const size_t *start, const size_t *count, float *data, const char *reader);
+int nc_access_close(int ncid);
+int nc_access_close_all(void);
+int nc_access_prefetch(const char *fname);
+// stage checkpoint functions (checkpoint.c)
+int init_checkpoint(args_struct in_args, const char *stage_name);
+int add_checkpoint_arg(const char *name, const char *value);
+int add_checkpoint_num(const char *name, double num);
+int add_checkpoint_dir(const char *path);
+int add_checkpoint_output(const char *path, const char *fname);
+int restore_checkpoint(int *restored);
+int save_checkpoint(void);
+int set_land_type_area_checkpoint(args_struct in_args);
+int init_checkpoint_key(const char *stage_name);
+unsigned long long get_checkpoint_key(void);
+// serve mode stage functions (serve_stages.c)
+void start_serve_stages(void);
+void stop_serve_stages(void);
+int set_serve_stages(args_struct in_args, rinfo_struct *raster_info);
+int run_serve_stage(int stage);
+int save_stage_checkpoint(args_struct in_args, int stage, int scen_ind);
+void end_serve_stages(args_struct in_args, rinfo_struct *raster_info, int error_code);
+const char *get_serve_stage(int stage, int *status);
 // sorting function  that is used with qsort in proc_refveg_carbon.c
 int cmpfunc (const void * a, const void * b);
 
@@ -4,6 +4,7 @@
  aggregate the output fao country production and harvest area data to the gcam land units
  
  write these data as a diagnostic output
+    with a region subset, the gcam regions hold only the subset countries, so the file names get a _subset suffix
  
  arguments:
  args_struct in_args:	the input argument structure
@@ -52,19 +53,13 @@ int aggregate_crop2gcam(args_struct in_args) {
 	int ctry_index = NOMATCH;		// fao ctry index (to get region code)
     int aez_index = NOMATCH;        // aez index for current ctry index
     int reg_aez_index = NOMATCH;    // aez index for current reg index
-    int all_aez_index = NOMATCH;    // aez index in the list of all new aezs
-    int diag_index = NOMATCH;       // index of old-format 1d array for diagnostic output
 	int err = OK;			// error code for called functions
+	char subset_tag[MAXCHAR] = "";	// file name tag for the gcam region diagnostics; _subset with a region subset
+	char out_name[MAXCHAR];			// diagnostic file name
 	
     float ***harvestarea_crop_aez_gcam;			// array to output aggregated harvested area in ha
     float ***production_crop_aez_gcam;          // array to output aggregated produciton in metric tonnes
     
-    // to do: deal with this for gridded new aez input
-    // for now, fill an old-format 1d array for diagnostic output
-    // aez varies fastest, then crop, then gcam region
-    float *diag_harvestarea_crop_aez_gcam;          // array to output aggregated harvested area in ha
-    float *diag_production_crop_aez_gcam;          // array to output aggregated produciton in metric tonnes
-    
     // allocate memory for the diagnostic output
     harvestarea_crop_aez_gcam = calloc(NUM_GCAM_RGN, sizeof(float**));
     if(harvestarea_crop_aez_gcam == NULL) {
@@ -105,18 +100,6 @@ int aggregate_crop2gcam(args_struct in_args) {
             }
         } // end for j loop over aezs
     } // end for i loop over fao country
-
-    // allocate the 1d arrays
-    diag_harvestarea_crop_aez_gcam = calloc(NUM_GCAM_RGN * NUM_SAGE_CROP * NUM_NEW_AEZ, sizeof(float));
-    if(diag_harvestarea_crop_aez_gcam == NULL) {
-        fprintf(fplog,"Failed to allocate memory for diag_harvestarea_crop_aez_gcam:  aggregate_crop2gcam()\n");
-        return ERROR_MEM;
-    }
-    diag_production_crop_aez_gcam = calloc(NUM_GCAM_RGN * NUM_SAGE_CROP * NUM_NEW_AEZ, sizeof(float));
-    if(diag_production_crop_aez_gcam == NULL) {
-        fprintf(fplog,"Failed to allocate memory for diag_production_crop_aez_gcam:  aggregate_crop2gcam()\n");
-        return ERROR_MEM;
-    }
     
 	// loop over the countries
     // skip fao countries that do not have an economic region
@@ -128,24 +111,12 @@ int aggregate_crop2gcam(args_struct in_args) {
 			}
             continue;
         }else {
-            // get gcam region index; have already checked for NOMATCH
-            reg_index = NOMATCH;
-            for (i = 0; i < NUM_GCAM_RGN; i++) {
-                if (regioncodes_gcam[i] == ctry2regioncodes_gcam[ctry_index]) {
-                    reg_index = i;
-                    break;
-                }
-            }
+            // get gcam region index; have already checked for NOMATCH (see write_glu_mapping())
+            reg_index = ctry2reggcam_ind[ctry_index];
             // loop over the country aezs
             for (aez_index = 0; aez_index < ctry_aez_num[ctry_index]; aez_index++) {
                 // determine the region aez index
-                reg_aez_index = NOMATCH;
-                for (i = 0; i < reggcam_aez_num[reg_index]; i++) {
-                    if (ctry_aez_list[ctry_index][aez_index] == reggcam_aez_list[reg_index][i]) {
-                        reg_aez_index = i;
-                        break;
-                    }
-                }
+                reg_aez_index = ctry_aez_reggcam_ind[ctry_index][aez_index];
                 if (reg_aez_index == NOMATCH) {
                     // this shouldn't happen because the gcam region list was made from the country list (see write_glu_mapping())
                     fprintf(fplog,"Error finding gcam region index: aggregate_crop2gcam(); country=%i region=%i aez=%i\n",
@@ -160,46 +131,29 @@ int aggregate_crop2gcam(args_struct in_args) {
                     harvestarea_crop_aez_gcam[reg_index][reg_aez_index][crop_index] =
                         harvestarea_crop_aez_gcam[reg_index][reg_aez_index][crop_index] +
                         harvestarea_crop_aez[ctry_index][aez_index][crop_index];
-                    
-                    // get the aez index in the complete aez list
-                    all_aez_index = NOMATCH;
-                    for (i = 0; i < NUM_NEW_AEZ; i++) {
-                        if (aez_codes_new[i] == reggcam_aez_list[reg_index][reg_aez_index]) {
-                            all_aez_index = i;
-                            break;
-                        }
-                    }
-                    if (all_aez_index == NOMATCH) {
-                        // this shouldn't happen
-                        fprintf(fplog,"Error finding all aez index: aggregate_crop2gcam(); country=%i region=%i aez=%i\n",
-                                countrycodes_fao[ctry_index], regioncodes_gcam[reg_index], reggcam_aez_list[reg_index][reg_aez_index]);
-                        return ERROR_FILE;
-                    }
-                    // fill the 1d arrays
-                    diag_index = reg_index * NUM_SAGE_CROP * NUM_NEW_AEZ + crop_index * NUM_NEW_AEZ + all_aez_index;
-                    diag_harvestarea_crop_aez_gcam[diag_index] =
-                        diag_harvestarea_crop_aez_gcam[diag_index] +
-                        harvestarea_crop_aez[ctry_index][aez_index][crop_index];
-                    diag_production_crop_aez_gcam[diag_index] =
-                        diag_production_crop_aez_gcam[diag_index] +
-                        production_crop_aez[ctry_index][aez_index][crop_index];
-                    
                 } // end for crop loop
             } // end for country aez loop
         } // end else process this country because it is assigned to a gcam region
 	} // end loop over fao country
 	
 	if (in_args.diagnostics) {
-		// production
-		if ((err = write_csv_float3d(diag_production_crop_aez_gcam, regioncodes_gcam, cropcodes_sage, NUM_GCAM_RGN,
-									 NUM_SAGE_CROP, NUM_NEW_AEZ, "production_crop_aez_gcam.csv", in_args))) {
-			fprintf(fplog, "Error writing file %s: aggregate_crop2gam()\n", "production_crop_aez_gcam.csv");
+		// with a region subset, the gcam regions hold only the subset countries, so the tables are labeled as such
+		if (strcmp(in_args.region_subset, NONE_TEXT) != 0) {
+			strcpy(subset_tag, "_subset");
+			fprintf(fplog, "Region subset %s: the gcam region diagnostics hold only the subset countries: aggregate_crop2gcam()\n", in_args.region_subset);
+		}
+		// production; only the non-zero values of the region glus are written
+		sprintf(out_name, "production_crop_aez_gcam%s.csv", subset_tag);
+		if ((err = write_csv_sparse3d(production_crop_aez_gcam, regioncodes_gcam, NUM_GCAM_RGN, reggcam_aez_num, reggcam_aez_list,
+									  cropcodes_sage, NUM_SAGE_CROP, 1, out_name, in_args))) {
+			fprintf(fplog, "Error writing file %s: aggregate_crop2gam()\n", out_name);
 			return err;
 		}
 		// harvested area
-		if ((err = write_csv_float3d(diag_harvestarea_crop_aez_gcam, regioncodes_gcam, cropcodes_sage, NUM_GCAM_RGN,
-									 NUM_SAGE_CROP,NUM_NEW_AEZ, "harvestarea_crop_aez_gcam.csv", in_args))) {
-			fprintf(fplog, "Error writing file %s: aggregate_crop2gam()\n", "harvestarea_crop_aez_gcam.csv");
+		sprintf(out_name, "harvestarea_crop_aez_gcam%s.csv", subset_tag);
+		if ((err = write_csv_sparse3d(harvestarea_crop_aez_gcam, regioncodes_gcam, NUM_GCAM_RGN, reggcam_aez_num, reggcam_aez_list,
+									  cropcodes_sage, NUM_SAGE_CROP, 1, out_name, in_args))) {
+			fprintf(fplog, "Error writing file %s: aggregate_crop2gam()\n", out_name);
 			return err;
 		}
 	}
@@ -215,7 +169,4 @@ int aggregate_crop2gcam(args_struct in_args) {
     free(harvestarea_crop_aez_gcam);
     free(production_crop_aez_gcam);
     
-    free(diag_harvestarea_crop_aez_gcam);
-    free(diag_production_crop_aez_gcam);
-    
 	return OK;}
@@ -5,6 +5,7 @@
  one land rent region can include multiple gcam regions
  
  write these data as a diagnostic output
+    with a region subset, the gcam regions hold only the subset countries, so the file names get a _subset suffix
  
  arguments:
  args_struct in_args:	the input argument structure
@@ -47,24 +48,22 @@ int aggregate_use2gcam(args_struct in_args) {
 	// the records need to be aggregated from countries to regions
 	
 	int i,j, k;
-    int reggcam_code = 0;               // the current gcam region code
+    int aez_val;                        // the current glu code
     int reglr_index = NOMATCH;          // land rent region index
     int reggcam_index[NUM_FAO_CTRY];    // gcam region indices for current reglr
     int num_reggcam_index;              // the number of gcam regions for current reglr
-    int reggcam_out_ind;                // index in reggcam_index that is used for output
     int reglr_aez_index = NOMATCH;      // land rent region aez index
     int reggcam_aez_index = NOMATCH;    // gcam region aez index
+    int max_reglr_aez_num;              // the largest number of aezs in a land rent region
+    int *glu_slot;                      // index of each glu (by aez_codes_new index) in the list of the current gcam region
+    int *reglr_reggcam_ind;             // gcam region index of each aez of the current land rent region
+    int *reglr_reggcam_aez_ind;         // gcam region aez index of each aez of the current land rent region
     int use_index = NOMATCH;            // gtap index of use
-    int all_aez_index = NOMATCH;        // aez index in the list of all new aezs
-    int diag_index = NOMATCH;           // index of old-format 1d array for diagnostic output
 	int err = OK;			// error code for called functions
+	char subset_tag[MAXCHAR] = "";	// file name tag for the gcam region diagnostics; _subset with a region subset
+	char out_name[MAXCHAR];			// diagnostic file name
 	
 	float ***rent_use_aez_gcam;			// array to output diagnostics in USD
-    
-    // for now, use the old-format 1d array for diagnostic output
-    // aez varies fastest, then use, then gcam region
-    // to do: check for gridded new aez input
-    float *diag_rent_use_aez_gcam;
 	    
 	// allocate memory for the diagnostic output
 	rent_use_aez_gcam = calloc(NUM_GCAM_RGN, sizeof(float**));
@@ -87,30 +86,44 @@ int aggregate_use2gcam(args_struct in_args) {
         } // end for j loop over aezs
     } // end for i loop over fao country
 	
-    // allocate the 1d diagnostic array
-    diag_rent_use_aez_gcam = calloc(NUM_GCAM_RGN * NUM_GTAP_USE * NUM_NEW_AEZ, sizeof(float));
-    if(diag_rent_use_aez_gcam == NULL) {
-        fprintf(fplog,"Failed to allocate memory for diag_rent_use_aez_gcam:  aggregate_use2gcam()\n");
-        return ERROR_MEM;
-    }
-    
+	// lookup arrays for matching the land rent region aezs to the gcam region aezs
+	max_reglr_aez_num = 1;
+	for (i = 0; i < NUM_GTAP_CTRY87; i++) {
+		if (reglr_aez_num[i] > max_reglr_aez_num) {
+			max_reglr_aez_num = reglr_aez_num[i];
+		}
+	}
+	glu_slot = malloc(NUM_NEW_AEZ * sizeof(int));
+	reglr_reggcam_ind = malloc(max_reglr_aez_num * sizeof(int));
+	reglr_reggcam_aez_ind = malloc(max_reglr_aez_num * sizeof(int));
+	if(glu_slot == NULL || reglr_reggcam_ind == NULL || reglr_reggcam_aez_ind == NULL) {
+		fprintf(fplog,"Failed to allocate memory for the gcam region aez lookup:  aggregate_use2gcam()\n");
+		return ERROR_MEM;
+	}
+	for (i = 0; i < NUM_NEW_AEZ; i++) {
+		glu_slot[i] = NOMATCH;
+	}
+	
 	// loop over the land rent regions
 	for (reglr_index = 0; reglr_index < NUM_GTAP_CTRY87; reglr_index++) {
 
         // one land rent region can map to multiple countries and gcam regions
+        // the gcam regions are kept in fao country order, once each (see write_glu_mapping() for the country maps)
         num_reggcam_index = 0;
         for (j = 0; j < NUM_FAO_CTRY; j++) {
             // skip fao countries without economic region - they are not going to find matches with ctry87
-            if (ctry2regioncodes_gcam[j] == NOMATCH) {
+            if (ctry2regioncodes_gcam[j] == NOMATCH || ctry2reggcam_ind[j] == NOMATCH) {
                 continue;
-            }else if (country87codes_gtap[reglr_index] == ctry2ctry87codes_gtap[j]) {
-                reggcam_code = ctry2regioncodes_gcam[j];
-                for (k = 0; k < NUM_GCAM_RGN; k++) {
-                    if (regioncodes_gcam[k] == reggcam_code) {
-                        reggcam_index[num_reggcam_index++] = k;
+            }else if (ctry2reglr_ind[j] == reglr_index) {
+                for (k = 0; k < num_reggcam_index; k++) {
+                    if (reggcam_index[k] == ctry2reggcam_ind[j]) {
+                        break;
                     }
-                } // end for k loop to get current region index
-            } // end if-else fao country found so get region code and index
+                }
+                if (k == num_reggcam_index) {
+                    reggcam_index[num_reggcam_index++] = ctry2reggcam_ind[j];
+                }
+            } // end if-else fao country found so get region index
         } // end for j loop to find the gcam region indices for this land rent region
         if (num_reggcam_index == 0) {
             // this shouldn't happen because already skipping countries above
@@ -118,23 +131,39 @@ int aggregate_use2gcam(args_struct in_args) {
             return ERROR_IND;
         }
         
-        // loop over the land rent region aezs
+        // determine the gcam region aez index of each land rent region aez
+        // just select the first gcam region that has the aez
         for (reglr_aez_index = 0; reglr_aez_index < reglr_aez_num[reglr_index]; reglr_aez_index++) {
-            // determine the gcam region aez index
-            // just select the first one that matches
-            reggcam_aez_index = NOMATCH;
-            for (j = 0; j < num_reggcam_index; j++) {
-                for (i = 0; i < reggcam_aez_num[reggcam_index[j]]; i++) {
-                    if (reglr_aez_list[reglr_index][reglr_aez_index] == reggcam_aez_list[reggcam_index[j]][i]) {
-                        reggcam_aez_index = i;
-                        break;
-                    }
+            reglr_reggcam_ind[reglr_aez_index] = NOMATCH;
+            reglr_reggcam_aez_ind[reglr_aez_index] = NOMATCH;
+        }
+        for (j = 0; j < num_reggcam_index; j++) {
+            k = reggcam_index[j];
+            for (i = 0; i < reggcam_aez_num[k]; i++) {
+                aez_val = reggcam_aez_list[k][i];
+                if (aez_val >= 0 && aez_val <= max_aez_code_new && aez_code2ind_new[aez_val] != NOMATCH) {
+                    glu_slot[aez_code2ind_new[aez_val]] = i;
+                }
+            }
+            for (reglr_aez_index = 0; reglr_aez_index < reglr_aez_num[reglr_index]; reglr_aez_index++) {
+                aez_val = reglr_aez_list[reglr_index][reglr_aez_index];
+                if (reglr_reggcam_ind[reglr_aez_index] == NOMATCH && aez_val >= 0 && aez_val <= max_aez_code_new &&
+                    aez_code2ind_new[aez_val] != NOMATCH && glu_slot[aez_code2ind_new[aez_val]] != NOMATCH) {
+                    reglr_reggcam_ind[reglr_aez_index] = k;
+                    reglr_reggcam_aez_ind[reglr_aez_index] = glu_slot[aez_code2ind_new[aez_val]];
                 }
-                if (reggcam_aez_index != NOMATCH) {
-                    reggcam_out_ind = j;
-                    break;
+            }
+            for (i = 0; i < reggcam_aez_num[k]; i++) {
+                aez_val = reggcam_aez_list[k][i];
+                if (aez_val >= 0 && aez_val <= max_aez_code_new && aez_code2ind_new[aez_val] != NOMATCH) {
+                    glu_slot[aez_code2ind_new[aez_val]] = NOMATCH;
                 }
-            } // end j loop over gcam regions for this land rent region to find gcam aez index
+            }
+        } // end j loop over gcam regions for this land rent region to find gcam aez indices
+        
+        // loop over the land rent region aezs
+        for (reglr_aez_index = 0; reglr_aez_index < reglr_aez_num[reglr_index]; reglr_aez_index++) {
+            reggcam_aez_index = reglr_reggcam_aez_ind[reglr_aez_index];
             
             if (reggcam_aez_index == NOMATCH) {
                 // this shouldn't happen because the gcam region list was made from the country list (see write_glu_mapping())
@@ -147,41 +176,28 @@ int aggregate_use2gcam(args_struct in_args) {
             for (use_index = 0; use_index < NUM_GTAP_USE; use_index++) {
                 
                 // convert to USD for diagnostic output
-                rent_use_aez_gcam[reggcam_index[reggcam_out_ind]][reggcam_aez_index][use_index] =
-                rent_use_aez_gcam[reggcam_index[reggcam_out_ind]][reggcam_aez_index][use_index] +
+                rent_use_aez_gcam[reglr_reggcam_ind[reglr_aez_index]][reggcam_aez_index][use_index] =
+                rent_use_aez_gcam[reglr_reggcam_ind[reglr_aez_index]][reggcam_aez_index][use_index] +
                 rent_use_aez[reglr_index][reglr_aez_index][use_index] * MIL2ONE;
-                
-                // get the aez index in the complete aez list
-                all_aez_index = NOMATCH;
-                for (i = 0; i < NUM_NEW_AEZ; i++) {
-                    if (aez_codes_new[i] == reggcam_aez_list[reggcam_index[reggcam_out_ind]][reggcam_aez_index]) {
-                        all_aez_index = i;
-                        break;
-                    }
-                }
-                if (all_aez_index == NOMATCH) {
-                    // this shouldn't happen
-                    fprintf(fplog,"Error finding all aez index: aggregate_use2gcam(); land rent region=%i gcam region=%i aez=%i\n",
-                            country87codes_gtap[reglr_index], regioncodes_gcam[reggcam_index[reggcam_out_ind]],
-                            reggcam_aez_list[reggcam_index[reggcam_out_ind]][reggcam_aez_index]);
-                    return ERROR_FILE;
-                }
-                // fill the 1d arrays
-                diag_index =
-                    reggcam_index[reggcam_out_ind] * NUM_GTAP_USE * NUM_NEW_AEZ + use_index * NUM_NEW_AEZ + all_aez_index;
-                diag_rent_use_aez_gcam[diag_index] =
-                diag_rent_use_aez_gcam[diag_index] +
-                rent_use_aez[reglr_index][reglr_aez_index][use_index] * MIL2ONE;
-                
             } // end for loop over the use sectors
 		} // end for loop over the reglr aezs
 	} // end for loop over the land rent regions
+	
+	free(glu_slot);
+	free(reglr_reggcam_ind);
+	free(reglr_reggcam_aez_ind);
 
 	if (in_args.diagnostics) {
-		// land rent
-		if ((err = write_csv_float3d(diag_rent_use_aez_gcam, regioncodes_gcam, usecodes_gtap, NUM_GCAM_RGN,
-									 NUM_GTAP_USE, NUM_NEW_AEZ, "land_rent_aez_gcam.csv", in_args))) {
-			fprintf(fplog, "Error writing file %s: aggregate_use2gam()\n", "land_rent_aez_gcam.csv");
+		// with a region subset, the gcam regions hold only the subset countries, so the tables are labeled as such
+		if (strcmp(in_args.region_subset, NONE_TEXT) != 0) {
+			strcpy(subset_tag, "_subset");
+			fprintf(fplog, "Region subset %s: the gcam region diagnostics hold only the subset countries: aggregate_use2gcam()\n", in_args.region_subset);
+		}
+		// land rent; only the non-zero values of the region glus are written
+		sprintf(out_name, "land_rent_aez_gcam%s.csv", subset_tag);
+		if ((err = write_csv_sparse3d(rent_use_aez_gcam, regioncodes_gcam, NUM_GCAM_RGN, reggcam_aez_num, reggcam_aez_list,
+									  usecodes_gtap, NUM_GTAP_USE, 1, out_name, in_args))) {
+			fprintf(fplog, "Error writing file %s: aggregate_use2gam()\n", out_name);
 			return err;
 		}
 	}
@@ -193,7 +209,5 @@ int aggregate_use2gcam(args_struct in_args) {
         free(rent_use_aez_gcam[i]);
     }
 	free(rent_use_aez_gcam);
-    
-    free(diag_rent_use_aez_gcam);
 	
 	return OK;}
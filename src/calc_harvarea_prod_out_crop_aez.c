@@ -10,6 +10,12 @@
  the recalibration year is determined by the available fao data and must be consistent with prodprice_fao
   (see read_yield_fao(), read_harvestarea_fao(), read_production_fao(), and read_prodprice_fao())
  
+ the sage crop data are read one latitude band at a time as the land cells are visited (see get_lat_band())
+  so harvestarea_in and yield_in are indexed by the cell offset within the current band window (see get_band_cell())
+  the recalibration needs the country totals of the area pass before the yield pass, so each band is read twice
+  the crop file is kept open for all of its bands, and closed before the next crop (see nc_access.c)
+  the next crop file is read ahead by the kernel while the current crop is processed (see prefetch_next_crop())
+ 
  The diagnostics do show that the 2003-2007 avg fao data are slightly farther from the gtap data than the 1997-2003 fao data
  To figure this out the prod_val_fao and harvest_val_fao need to be calculated once per countryXcrop and stored, and they should be checked in conjunction with each other for consistency
  
@@ -49,6 +55,19 @@
 
 #include "moirai.h"
 
+// start the read-ahead of the unzipped netcdf file of the crop after cropind, if there is one
+static void prefetch_next_crop(const char *sagepath, int cropind) {
+	
+	char fname[MAXCHAR];		// the next crop file name
+	
+	if (cropind + 1 >= NUM_SAGE_CROP) {
+		return;
+	}
+	if (snprintf(fname, MAXCHAR, "%s%s%s", sagepath, &cropfilebase_sage[cropind + 1][0], SAGE_CROP_NCTAG) < MAXCHAR) {
+		nc_access_prefetch(fname);
+	}
+}
+
 int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_info) {
 	
 	float country_prod[NUM_FAO_CTRY * NUM_SAGE_CROP];			// aggregated values per fao country x crop (metric tonnes)
@@ -65,11 +84,11 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
 	int cropind;					// index for looping over crops
 	int aez_val;					// the glu number for current cell
 	int land_cell;					// the current land cell
+	int band_start_cell = 0;		// first cell of the latitude band in harvestarea_in and yield_in
+	int band_end_cell = 0;			// one past the last cell of the latitude band in harvestarea_in and yield_in
+	int band_cell;					// index of the current land cell within the latitude band
 	char fname[MAXCHAR];			// file name to open
 	
-    int all_aez_index;              // for the 1d old-format diagnostic output arrays
-    int diag_index;                 // for the 1d old-format diagnostic output arrays
-    
 	int serbia_code = 272;			// for merging serbia (272, srb) into serbia and montenegro (186, scg)
 	int montenegro_code = 273;		// for merging montenegro (273, mne) into serbia and montenegro (186, scg)
     int scg_code = 186;             // the fao code for accessing and storing merged serbia and montenegro (iso3 = scg)
@@ -91,9 +110,6 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
 	int err = OK;								// store error code from the write functions
 	int ncells = NUM_CELLS;						// the number of cells in the aez mask array
 	char out_name[] = "missing_aez_mask.bil";	// diagnositic output raster file name
-	char bildir[] = "sage/";					// the sage bil subdirectory of the outptus directory
-	char yieldtag[] = "_yield.bil";				// the rest of the output yield file name
-	char harvtag[] = "_harvarea.bil";			// the rest of the output yield file name
 	char out_name_prod[] = "production_crop_aez.csv";	// diagnostic output name for production
 	char out_name_harv[] = "harvestarea_crop_aez.csv";	// diagnostic output name for harvested area
 	char out_name_past[] = "pasturearea_aez.csv";	// diagnostic output name for pasture area
@@ -103,74 +119,27 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
     float mismatched_yield[NUM_SAGE_CROP];              // when harvested area=0
     int mismatched_yield_count[NUM_SAGE_CROP];          // to calc the avg mismatched yield
     
-	float *yield_recalib;				// the recalibrated yield for a single crop, if needed
-	float *area_recalib;				// the recalibrated area for a single crop, if needed
+	float *yield_recalib;				// the recalibrated yield for a single crop, if needed; by sage land cell index
+	float *area_recalib;				// the recalibrated area for a single crop, if needed; by sage land cell index
 	
-    // for now, use the old-format 1d arrays for the diagnostic outputs
-    // glu variest fastest, then crop, then country
-    // will this work if the glus are individual cells?
-    float *diag_harvestarea_crop_aez;            // harvested area output (ha), output to nearest integer
-    float *diag_production_crop_aez;             // production output (metric tonnes), output to nearest integer
-    // glu varies faster, then country
-    float *diag_pasturearea_aez;                 // pasture area (ha)
-    
-    
 	// initialize some local arrays for recalibration
 	for (i = 0; i < NUM_FAO_CTRY * NUM_SAGE_CROP; i++) {
 		country_prod[i] = 0;
 		country_harvarea[i] = 0;
 	}
-    
-    // allocate 1d arrays for diagnostic output
-    diag_harvestarea_crop_aez = calloc(NUM_FAO_CTRY * NUM_SAGE_CROP * NUM_NEW_AEZ, sizeof(float));
-    if(diag_harvestarea_crop_aez == NULL) {
-        fprintf(fplog,"Failed to allocate memory for diag_harvestarea_crop_aez:  calc_harvarea_prod_out_aez()\n");
-        return ERROR_MEM;
-    }
-    diag_production_crop_aez = calloc(NUM_FAO_CTRY * NUM_SAGE_CROP * NUM_NEW_AEZ, sizeof(float));
-    if(diag_production_crop_aez == NULL) {
-        fprintf(fplog,"Failed to allocate memory for diag_production_crop_aez:  calc_harvarea_prod_out_aez()\n");
-        return ERROR_MEM;
-    }
-    diag_pasturearea_aez = calloc(NUM_FAO_CTRY * NUM_NEW_AEZ, sizeof(float));
-    if(diag_pasturearea_aez == NULL) {
-        fprintf(fplog,"Failed to allocate memory for diag_pasturearea_aez:  calc_harvarea_prod_out_aez()\n");
-        return ERROR_MEM;
-    }
 	
 	// loop over SAGE crops
 	for (cropind = 0; cropind < NUM_SAGE_CROP; cropind++) {
 		
-		// read in yield and harvest area
+		trace_begin("crop", "%s", &cropfilebase_sage[cropind][0]);
+		prefetch_next_crop(in_args.sagepath, cropind);
+		
+		// yield and harvest area are read in by latitude band in the cell loop
 		// file units are converted from t/ha to t/km^2 and from fraction of land area to km^2
-		// this function ensures that valid yield and area values exist for sage land cells
+		// read_sage_crop() ensures that valid yield and area values exist for sage land cells
 		strcpy(fname, in_args.sagepath);
 		strcat(fname, &cropfilebase_sage[cropind][0]); // the read function will determine whether the file is zipped or not
-		if ((err = read_sage_crop(fname, in_args.sagepath, &cropfilebase_sage[cropind][0], raster_info))) {
-			fprintf(fplog, "Failed to read yield and area for crop %s: calc_harvarea_prod_out_aez()\n", fname);
-			return err;
-		}
-		
-		// deprecated diagnostic: write the unit-converted data as bil files
-		// these file are written into a subdirectory of the outputs directory
-        // and currently are not written
-		//if (in_args.diagnostics) {
-		if (0) {
-			strcpy(fname, bildir);
-			strcat(fname, &cropfilebase_sage[cropind][0]);
-			strcat(fname, yieldtag);
-			if ((err = write_raster_float(yield_in, NUM_CELLS, fname, in_args))) {
-				fprintf(fplog, "Failed to write yield raster for crop %s: calc_harvarea_prod_out_aez()\n", fname);
-				return err;
-			}
-			strcpy(fname, bildir);
-			strcat(fname, &cropfilebase_sage[cropind][0]);
-			strcat(fname, harvtag);
-			if ((err = write_raster_float(harvestarea_in, NUM_CELLS, fname, in_args))) {
-				fprintf(fplog, "Failed to write harvest area raster for crop %s: calc_harvarea_prod_out_aez()\n", fname);
-				return err;
-			}
-		}
+		band_end_cell = 0;
 		
         // initialize some arrays
         lost_harvested_area[cropind] = 0;
@@ -184,6 +153,22 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
 		// aggregate to land unit (aez within each fao country)
 		for (cellind = 0; cellind < num_land_cells_sage; cellind++) {
 			land_cell = land_cells_sage[cellind];
+			// read the latitude band of yield and harvest area that holds this cell
+			if (land_cell >= band_end_cell) {
+				if ((err = get_lat_band(land_cell, raster_info, &band_start_cell, &band_end_cell))) {
+					fprintf(fplog, "Failed to get latitude band for crop %s: calc_harvarea_prod_out_aez(); cellind = %i\n", fname, cellind);
+					return err;
+				}
+				trace_begin("io", "read_sage_crop %s", &cropfilebase_sage[cropind][0]);
+				err = read_sage_crop(fname, in_args.sagepath, &cropfilebase_sage[cropind][0], raster_info,
+									 band_start_cell / NUM_LON, (band_end_cell - band_start_cell) / NUM_LON);
+				trace_end();
+				if (err) {
+					fprintf(fplog, "Failed to read yield and area for crop %s: calc_harvarea_prod_out_aez()\n", fname);
+					return err;
+				}
+			}
+			band_cell = get_band_cell(land_cell, band_start_cell, raster_info);
 			// fao country index
 			if ((int) country_fao[land_cell] != raster_info.country_fao_nodata) {
 				ctry_index = NOMATCH;
@@ -195,7 +180,7 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
 				}	// end for i loop over fao ctry to find fao index
 			} else {
 				//fprintf(fplog, "No fao country exists for this cell: calc_harvarea_prod_out_aez(); cellind = %i\n", cellind);
-                lost_harvested_area[cropind] = lost_harvested_area[cropind] + harvestarea_in[land_cell];
+                lost_harvested_area[cropind] = lost_harvested_area[cropind] + harvestarea_in[band_cell];
 				continue;	// no country associated with these data so don't use this cell and go to the next one
 			}	// end if fao country else no country
 	
@@ -226,20 +211,6 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
                         }
                     }
                     
-                    // get the current glu index in the complete glu list
-                    all_aez_index = NOMATCH;
-                    for (i = 0; i < NUM_NEW_AEZ ; i++) {
-                        if (aez_codes_new[i] == aez_val) {
-                            all_aez_index = i;
-                            break;
-                        }
-                    }
-                    if (all_aez_index == NOMATCH) {
-                        fprintf(fplog, "Failed to get all_aez_index for crop %s in cellind = %i: calc_harvarea_prod_out_aez()\n",
-                                fname, cellind);
-                        return err;
-                    }
-                    
                     // get the current glu index in the country list
                     aez_index = NOMATCH;
                     for (i = 0; i < ctry_aez_num[ctry_index]; i++) {
@@ -255,20 +226,13 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
                     }
                     
                     // both values for this cell are set to zero if either area or yield are not non-zero, positive values
-                    if (harvestarea_in[land_cell] > 0 && yield_in[land_cell] > 0) {
+                    if (harvestarea_in[band_cell] > 0 && yield_in[band_cell] > 0) {
                         harvestarea_crop_aez[ctry_index][aez_index][cropind] =
                             harvestarea_crop_aez[ctry_index][aez_index][cropind] +
-                            KMSQ2HA * harvestarea_in[land_cell];
+                            KMSQ2HA * harvestarea_in[band_cell];
                         production_crop_aez[ctry_index][aez_index][cropind] =
                             production_crop_aez[ctry_index][aez_index][cropind] +
-                            harvestarea_in[land_cell] * yield_in[land_cell];
-                        
-                        // fill the 1d arrays
-                        diag_index = ctry_index * NUM_SAGE_CROP * NUM_NEW_AEZ + cropind * NUM_NEW_AEZ + all_aez_index;
-                        diag_harvestarea_crop_aez[diag_index] = diag_harvestarea_crop_aez[diag_index] +
-                            KMSQ2HA * harvestarea_in[land_cell];
-                        diag_production_crop_aez[diag_index] = diag_production_crop_aez[diag_index] +
-                            harvestarea_in[land_cell] * yield_in[land_cell];
+                            harvestarea_in[band_cell] * yield_in[band_cell];
                         
                         // aggregate to fao countries by sage crop, for recalibration; only area is needed here
                         // do this only for data that will be included in the ctryXglu pixel output
@@ -276,15 +240,15 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
                         // all fao indices have valid codes
                         recal_index = ctry_index * NUM_SAGE_CROP + cropind;
                         // to do: left hand operand of + is garbage value???
-                        country_harvarea[recal_index] = country_harvarea[recal_index] + harvestarea_in[land_cell];
+                        country_harvarea[recal_index] = country_harvarea[recal_index] + harvestarea_in[band_cell];
                         //if (recal_index == 24328) {
                         //    i=-1;
                         //}
                         
                     }else { // end if adding non-zero values from this cell to the total
-                        mismatched_harvested_area[cropind] = mismatched_harvested_area[cropind] + harvestarea_in[land_cell];
-                        if (yield_in[land_cell] > 0) {
-                            mismatched_yield[cropind] = mismatched_yield[cropind] + yield_in[land_cell];
+                        mismatched_harvested_area[cropind] = mismatched_harvested_area[cropind] + harvestarea_in[band_cell];
+                        if (yield_in[band_cell] > 0) {
+                            mismatched_yield[cropind] = mismatched_yield[cropind] + yield_in[band_cell];
                             mismatched_yield_count[cropind] = mismatched_yield_count[cropind] + 1;
                         }
                     }
@@ -309,11 +273,6 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
 						// pasture
 						pasturearea_aez[ctry_index][aez_index] = pasturearea_aez[ctry_index][aez_index] +
 							KMSQ2HA * pasture_area[land_cell];
-                        
-                        // fill the 1d array
-                        diag_index = ctry_index * NUM_NEW_AEZ + all_aez_index;
-                        diag_pasturearea_aez[diag_index] = diag_pasturearea_aez[diag_index] +
-                            KMSQ2HA * pasture_area[land_cell];
 						
 						// store the output countryXaez land mask
 						land_mask_ctryaez[land_cell] = 1;
@@ -323,6 +282,10 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
 			
 		}	// end for cellind loop over sage land cells
 		
+		// the crop file was kept open for its bands
+		nc_access_close_all();
+		
+		trace_end();
 	}	// end for cropind loop over sage crops
     
 	// most efficient way to recalibrate area and yield is to now loop over the crops,
@@ -352,12 +315,12 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
 		}
 		
 		// allocate recalib area and yield arrays
-		area_recalib = calloc(NUM_CELLS, sizeof(float));
+		area_recalib = calloc(num_land_cells_sage, sizeof(float));
 		if(area_recalib == NULL) {
 			fprintf(fplog,"Recalibrate: Failed to allocate memory for area_recalib:  calc_harvarea_prod_out_aez()\n");
 			return ERROR_MEM;
 		}
-		yield_recalib = calloc(NUM_CELLS, sizeof(float));
+		yield_recalib = calloc(num_land_cells_sage, sizeof(float));
 		if(yield_recalib == NULL) {
 			fprintf(fplog,"Recalibrate: Failed to allocate memory for yield_recalib:  calc_harvarea_prod_out_aez()\n");
 			return ERROR_MEM;
@@ -373,30 +336,38 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
 			}
 		}
 		
-		// need to zero the diagnostic production and harvest area arrays
-		for (i = 0; i < NUM_FAO_CTRY * NUM_SAGE_CROP * NUM_NEW_AEZ; i++) {
-			diag_production_crop_aez[i] = 0;
-			diag_harvestarea_crop_aez[i] = 0;
-		}
-		
 		// loop over crops, then cells, so that only two raster loops are needed per crop
 		// to do: write the recalibrated area and yield data for each crop
 		for (cropind = 0; cropind < NUM_SAGE_CROP; cropind++) {
 			
-			// read in yield and harvest area, again
-			// file units are converted from t/ha to t/km^2 and from fraction of land area to km^2
-			// this function ensures that valid yield and area values exist for sage land cells
+			trace_begin("crop", "%s recalibration", &cropfilebase_sage[cropind][0]);
+			prefetch_next_crop(in_args.sagepath, cropind);
+			
+			// read in yield and harvest area, again, by latitude band in the cell loops
 			strcpy(fname, in_args.sagepath);
 			strcat(fname, &cropfilebase_sage[cropind][0]); // the read function will determine whether the file is zipped or not
-			if ((err = read_sage_crop(fname, in_args.sagepath, &cropfilebase_sage[cropind][0], raster_info))) {
-				fprintf(fplog, "Failed to read yield and area for crop %s: calc_harvarea_prod_out_aez()\n", fname);
-				return err;
-			}
+			band_end_cell = 0;
 			
 			// area recalibration loop
 			for (cellind = 0; cellind < num_land_cells_sage; cellind++) {
 				land_cell = land_cells_sage[cellind];
-				area_recalib[land_cell] = 0;
+				// read the latitude band of yield and harvest area that holds this cell
+				if (land_cell >= band_end_cell) {
+					if ((err = get_lat_band(land_cell, raster_info, &band_start_cell, &band_end_cell))) {
+						fprintf(fplog, "Recalibrate: Failed to get latitude band for crop %s: calc_harvarea_prod_out_aez(); cellind = %i\n", fname, cellind);
+						return err;
+					}
+					trace_begin("io", "read_sage_crop %s", &cropfilebase_sage[cropind][0]);
+					err = read_sage_crop(fname, in_args.sagepath, &cropfilebase_sage[cropind][0], raster_info,
+										 band_start_cell / NUM_LON, (band_end_cell - band_start_cell) / NUM_LON);
+					trace_end();
+					if (err) {
+						fprintf(fplog, "Recalibrate: Failed to read yield and area for crop %s: calc_harvarea_prod_out_aez()\n", fname);
+						return err;
+					}
+				}
+				band_cell = get_band_cell(land_cell, band_start_cell, raster_info);
+				area_recalib[cellind] = 0;
 				// fao country index
 				if ((int) country_fao[land_cell] != raster_info.country_fao_nodata) {
 					ctry_index = NOMATCH;
@@ -428,7 +399,7 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
 					if (aez_val != raster_info.aez_new_nodata) {
                         
                         // use only cells with positve values for area and yield
-                        if (harvestarea_in[land_cell] > 0 && yield_in[land_cell] > 0) {
+                        if (harvestarea_in[band_cell] > 0 && yield_in[band_cell] > 0) {
 							
 							if (cropind == 5 && country_fao[land_cell] == 231) {
 								// maize in usa
@@ -490,27 +461,14 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
                                 if (country_harvarea[recal_index] < 0.0001) {
                                     fprintf(fplog, "Recalibrate: Bad country_harvarea[%i] = %e value at ctry_index = %i and cropind = %i: calc_harvarea_prod_out_aez()\n",
                                             recal_index, country_harvarea[recal_index], ctry_index, cropind);
-                                    area_recalib[land_cell] = 0;
+                                    area_recalib[cellind] = 0;
                                 } else {
-                                    area_recalib[land_cell] = harvestarea_in[land_cell] * harvest_val_fao / country_harvarea[recal_index];
+                                    area_recalib[cellind] = harvestarea_in[band_cell] * harvest_val_fao / country_harvarea[recal_index];
                                     country_prod[recal_index] = country_prod[recal_index] +
-                                    area_recalib[land_cell] * yield_in[land_cell];
+                                    area_recalib[cellind] * yield_in[band_cell];
                                 }
                             } else {
-                                area_recalib[land_cell] = 0;
-                            }
-                            
-                            // get the current aez index in the complete aez list
-                            all_aez_index = NOMATCH;
-                            for (i = 0; i < NUM_NEW_AEZ ; i++) {
-                                if (aez_codes_new[i] == aez_val) {
-                                    all_aez_index = i;
-                                    break;
-                                }
-                            }
-                            if (all_aez_index == NOMATCH) {
-                                fprintf(fplog, "Failed to get all_aez_index for crop %s for area recalib: calc_harvarea_prod_out_aez()\n", fname);
-                                return err;
+                                area_recalib[cellind] = 0;
                             }
                             
                             // get the current aez index in the country aez list
@@ -530,7 +488,7 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
                             // aggregate to fao country and aez
                             harvestarea_crop_aez[ctry_index][aez_index][cropind] =
                                 harvestarea_crop_aez[ctry_index][aez_index][cropind] +
-                                KMSQ2HA * area_recalib[land_cell];
+                                KMSQ2HA * area_recalib[cellind];
                             
                             if (harvestarea_crop_aez[ctry_index][aez_index][cropind] < 0 ||
                                 harvestarea_crop_aez[ctry_index][aez_index][cropind] > 30000000) {
@@ -538,11 +496,6 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
                                         harvestarea_crop_aez[ctry_index][aez_index][cropind], ctry_index, aez_index, cropind);
                             }
                             
-                            // fill the 1d array
-                            diag_index = ctry_index * NUM_SAGE_CROP * NUM_NEW_AEZ + cropind * NUM_NEW_AEZ + all_aez_index;
-                            diag_harvestarea_crop_aez[diag_index] = diag_harvestarea_crop_aez[diag_index] +
-                            KMSQ2HA * area_recalib[land_cell];
-                            
                         } // end if area and yield are both positve values for this cell
 						
 					}	// end if valid aez cell for area
@@ -552,9 +505,27 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
 			}	// end for cellind loop to recalibrate area
 			
 			// now loop again to recalibrate the yields and calculate the output production
+			// this needs the complete country production from the area loop, so the bands are read again
+			band_end_cell = 0;
 			for (cellind = 0; cellind < num_land_cells_sage; cellind++) {
 				land_cell = land_cells_sage[cellind];
-				yield_recalib[land_cell] = 0;
+				// read the latitude band of yield and harvest area that holds this cell
+				if (land_cell >= band_end_cell) {
+					if ((err = get_lat_band(land_cell, raster_info, &band_start_cell, &band_end_cell))) {
+						fprintf(fplog, "Recalibrate: Failed to get latitude band for crop %s: calc_harvarea_prod_out_aez(); cellind = %i\n", fname, cellind);
+						return err;
+					}
+					trace_begin("io", "read_sage_crop %s", &cropfilebase_sage[cropind][0]);
+					err = read_sage_crop(fname, in_args.sagepath, &cropfilebase_sage[cropind][0], raster_info,
+										 band_start_cell / NUM_LON, (band_end_cell - band_start_cell) / NUM_LON);
+					trace_end();
+					if (err) {
+						fprintf(fplog, "Recalibrate: Failed to read yield and area for crop %s: calc_harvarea_prod_out_aez()\n", fname);
+						return err;
+					}
+				}
+				band_cell = get_band_cell(land_cell, band_start_cell, raster_info);
+				yield_recalib[cellind] = 0;
 				// fao country index
 				if ((int) country_fao[land_cell] != raster_info.country_fao_nodata) {
 					ctry_index = NOMATCH;
@@ -583,7 +554,7 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
 					if (aez_val != raster_info.aez_new_nodata) {
                         
                         // do this only if the area and yield are positive for this cell
-                        if (area_recalib[land_cell] > 0 && yield_in[land_cell] > 0) {
+                        if (area_recalib[cellind] > 0 && yield_in[band_cell] > 0) {
 							
 							if (cropind == 5 && country_fao[land_cell] == 231) {
 								// maize in usa
@@ -646,25 +617,12 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
 								if (country_prod[recal_index] < 0.1) {
 									fprintf(fplog, "Recalibrate: Bad country_prod[recal_index][%i] = %e value at ctry_index = %i and cropind = %i: calc_harvarea_prod_out_aez()\n",
 											recal_index, country_prod[recal_index], ctry_index, cropind);
-									yield_recalib[land_cell] = 0;
+									yield_recalib[cellind] = 0;
 								} else {
-									yield_recalib[land_cell] = yield_in[land_cell] * prod_val_fao / country_prod[recal_index];
+									yield_recalib[cellind] = yield_in[band_cell] * prod_val_fao / country_prod[recal_index];
 								}
 							} else {
-								yield_recalib[land_cell] = 0;
-							}
-							
-							// get the current aez index in the complete aez list
-							all_aez_index = NOMATCH;
-							for (i = 0; i < NUM_NEW_AEZ ; i++) {
-								if (aez_codes_new[i] == aez_val) {
-									all_aez_index = i;
-									break;
-								}
-							}
-							if (all_aez_index == NOMATCH) {
-								fprintf(fplog, "Failed to get all_aez_index for crop %s for area recalib: calc_harvarea_prod_out_aez()\n", fname);
-								return err;
+								yield_recalib[cellind] = 0;
 							}
 							
 							// get the current aez index in the country aez list
@@ -685,7 +643,7 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
 							
 							production_crop_aez[ctry_index][aez_index][cropind] =
 							production_crop_aez[ctry_index][aez_index][cropind] +
-							area_recalib[land_cell] * yield_recalib[land_cell];
+							area_recalib[cellind] * yield_recalib[cellind];
 							
 							// this condition is not hit with the calibration to 2003-2007 avg annual values
 							// even without the preceding filter
@@ -695,11 +653,6 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
 										production_crop_aez[ctry_index][aez_index][cropind], ctry_index, aez_index, cropind);
 							}
 							
-							// fill the 1d array
-							diag_index = ctry_index * NUM_SAGE_CROP * NUM_NEW_AEZ + cropind * NUM_NEW_AEZ + all_aez_index;
-							diag_production_crop_aez[diag_index] = diag_production_crop_aez[diag_index] +
-							area_recalib[land_cell] * yield_recalib[land_cell];
-							
 						} // end if area and yield are both positive for this cell
 						
 					}	// end if valid aez cell for production/yield
@@ -714,6 +667,8 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
 				// maize
 				;
 			}
+			nc_access_close_all();
+			trace_end();
 		}	// end for cropind for area and production recalibration
 		
 		free(area_recalib);
@@ -735,19 +690,20 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
 			return err;
 		}
 		
-		// write the sage production and harvest area and pasture area by fao country, crop, and aez
-		if ((err = write_csv_float3d(diag_production_crop_aez, countrycodes_fao, cropcodes_sage,
-									 NUM_FAO_CTRY, NUM_SAGE_CROP, NUM_NEW_AEZ, out_name_prod, in_args))) {
+		// write the sage production and harvest area and pasture area by fao country, glu, and crop
+		// only the non-zero values of the country glus are written
+		if ((err = write_csv_sparse3d(production_crop_aez, countrycodes_fao, NUM_FAO_CTRY, ctry_aez_num, ctry_aez_list,
+									  cropcodes_sage, NUM_SAGE_CROP, 1, out_name_prod, in_args))) {
 			fprintf(fplog, "Error writing file %s: calc_harvarea_prod_out_crop_aez()\n", out_name_prod);
 			return err;
 		}
-		if ((err = write_csv_float3d(diag_harvestarea_crop_aez, countrycodes_fao, cropcodes_sage,
-									 NUM_FAO_CTRY, NUM_SAGE_CROP, NUM_NEW_AEZ, out_name_harv, in_args))) {
+		if ((err = write_csv_sparse3d(harvestarea_crop_aez, countrycodes_fao, NUM_FAO_CTRY, ctry_aez_num, ctry_aez_list,
+									  cropcodes_sage, NUM_SAGE_CROP, 1, out_name_harv, in_args))) {
 			fprintf(fplog, "Error writing file %s: calc_harvarea_prod_out_crop_aez()\n", out_name_harv);
 			return err;
 		}
-		if ((err = write_csv_float2d(diag_pasturearea_aez, countrycodes_fao,
-									 NUM_FAO_CTRY, NUM_NEW_AEZ, out_name_past, in_args))) {
+		if ((err = write_csv_sparse2d(pasturearea_aez, countrycodes_fao, NUM_FAO_CTRY, ctry_aez_num, ctry_aez_list,
+									  out_name_past, in_args))) {
 			fprintf(fplog, "Error writing file %s: calc_harvarea_prod_out_crop_aez()\n", out_name_past);
 			return err;
 		}
@@ -759,8 +715,4 @@ int calc_harvarea_prod_out_crop_aez(args_struct in_args, rinfo_struct raster_inf
 		}
 	}
 	
-    free(diag_production_crop_aez);
-    free(diag_harvestarea_crop_aez);
-    free(diag_pasturearea_aez);
-    
 	return OK;}
@@ -12,7 +12,7 @@
     with some additional pasture area info, which is independent, so can be from hyde
     with some additional forest area info, which is independent, and is calculated from this pot veg area
 
- the working area arrays should have been initialized to NODATA in get_land_cells()
+ the working area arrays should have been initialized to NODATA in calc_refveg_area()
 
  this function also sets the cell order for distribution of ref veg within coarse lulc cells,
  because this is the first time the hyde and lulc data are read.
@@ -81,9 +81,6 @@ int calc_refcarbon_area(args_struct in_args, rinfo_struct raster_info) {
 	int crop_ind = 1;		// index in lu_area of cropland values; may need to find these from an array
 	int pasture_ind = 2;	// index in lu_area of pasture values
 	
-    // hyde land use raster info
-    int ncols = raster_info.lu_ncols;				// num hyde lons
-	
 	// lulc raster info
 	int ncols_lulc = raster_info.lulc_input_ncols;		// num lulc input lons
 	int ncells_lulc = raster_info.lulc_input_ncells;	// number of lulc input cells
@@ -116,7 +113,7 @@ int calc_refcarbon_area(args_struct in_args, rinfo_struct raster_info) {
 	
 	
 	
-	num_split = ncols / ncols_lulc;
+	num_split = raster_info.num_split;
 	NUM_LU_CELLS = num_split * num_split;
 	
 	
@@ -14,9 +14,12 @@
     with some additional pasture area info, which is independent, so can be from hyde
     with some additional forest area info, which is independent, and is calculated from this pot veg area
 
- the working area arrays should have been initialized to NODATA in get_land_cells()
+ the working area arrays are initialized to NODATA here, and the ref veg and forest land masks to 0
 
- also store the forest cells based on the reference veg
+ also store the forest cells based on the reference veg, for the forest land rent calculations
+    these are further restricted to the valid output mask during processing
+
+ none of this depends on the glus, so it is done once for the run, with the first glu scenario
  
  this function does not check for valid country/glu
  
@@ -87,9 +90,6 @@ int calc_refveg_area(args_struct in_args, rinfo_struct *raster_info) {
 	int crop_ind = 1;		// index in lu_area of cropland values; may need to find these from an array
 	int pasture_ind = 2;	// index in lu_area of pasture values
 	
-    // hyde land use raster info
-    int ncols;				// num hyde lons
-	
 	// lulc raster info
 	int ncols_lulc;		// num lulc input lons
 	int ncells_lulc;	// number of lulc input cells
@@ -111,6 +111,20 @@ int calc_refveg_area(args_struct in_args, rinfo_struct *raster_info) {
 	double rfarea_check;
 	double luarea_check;
 	
+	// initialize the working area arrays and the ref veg and forest land masks
+	for (i = 0; i < NUM_CELLS; i++) {
+		cropland_area[i] = NODATA;
+		pasture_area[i] = NODATA;
+		urban_area[i] = NODATA;
+		refveg_area[i] = NODATA;
+		for (j = 0; j < NUM_HYDE_TYPES - NUM_HYDE_TYPES_MAIN; j++) {
+			lu_detail_area[j][i] = NODATA;
+		}
+		land_mask_refveg[i] = 0;
+		land_mask_forest[i] = 0;
+	}
+	num_forest_cells = 0;
+	
 	// first read in the appropriate hyde land use area data
 	if((err = read_hyde32(in_args, raster_info, REF_YEAR, cropland_area, pasture_area, urban_area, lu_detail_area)) != OK)
 	{
@@ -129,17 +143,16 @@ int calc_refveg_area(args_struct in_args, rinfo_struct *raster_info) {
 	// also set the random order once so it doesn't change over multiple calls of proc_lulc_area
 	
 	// determine how many base lu cells are in one lulc cell
-	// assume perfect fit of working grid into lulc data
+	// the fit of the working grid into the lulc grid is checked in set_grid_geometry()
 	// assume symmetric cells
-	ncols = raster_info->lu_ncols;
 	ncols_lulc = raster_info->lulc_input_ncols;
 	ncells_lulc = raster_info->lulc_input_ncells;
 	
-	num_split = ncols / ncols_lulc;
+	num_split = raster_info->num_split;
 	NUM_LU_CELLS = num_split * num_split;
 	
 	// allocate the random order array here
-	// this is deallocated at the end of proc_refveg_carbon()
+	// this is deallocated with the last glu scenario in proc_glu_scenario()
 	rand_order = calloc(ncells_lulc, sizeof(float*));
 	if(rand_order == NULL) {
 		fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for rand_order: calc_refveg_area()\n", get_systime(), ERROR_MEM);
@@ -320,6 +333,11 @@ int calc_refveg_area(args_struct in_args, rinfo_struct *raster_info) {
 			fprintf(fplog, "Error writing file %s: calc_refveg_area()\n", "refveg_thematic.bil");
 			return err;
 		}
+		// forest land mask
+		if ((err = write_raster_int(land_mask_forest, NUM_CELLS, "land_mask_forest.bil", in_args))) {
+			fprintf(fplog, "Error writing file %s: calc_refveg_area()\n", "land_mask_forest.bil");
+			return err;
+		}
 	}	// end if output diagnostics
 	
 	free(lulc_area);
@@ -62,7 +62,7 @@
 int calc_rent_ag_use_aez(args_struct in_args, rinfo_struct raster_info) {
     
     int i,j,k,m;
-    int aez_ind, aez_ind_reglr, crop_ind, use_ind, sum_index, ctry_ind, reglr_ind, out_index, all_aez_index;	// loop and placement indices
+    int aez_ind, aez_ind_reglr, crop_ind, use_ind, sum_index, ctry_ind, reglr_ind, out_index;	// loop and placement indices
     // find these based on the codes below
     int vnm_ind = NOMATCH;		// vietnam land rent region index
     int hkg_ind = NOMATCH;		// hong kong land rent region index
@@ -73,7 +73,6 @@ int calc_rent_ag_use_aez(args_struct in_args, rinfo_struct raster_info) {
     int hkg_code = 25;		// hong kong ctry87 index  (code minus 1)
     int twn_code = 60;		// taiwan ctry87 index  (code minus 1)
     
-    int diag_index;         // for a couple of 1d output diagnostic arrays
     int gro_sect = 3;		// the use code for the grain sector
     int ctl_sect = 9;		// the use code for the cattle, sheep, etc sector
     int rmk_sect = 11;		// the use code for the dairy sector
@@ -86,16 +85,9 @@ int calc_rent_ag_use_aez(args_struct in_args, rinfo_struct raster_info) {
     float *newrent87;		// store the new rent summed across aezs (i.e. per ctry87, per use sector)
     float **harvestsum;		// sum for averaging yield and price to gro sector and land rent region per aez (ha)
     float **pasture87_aez;	// pasture area per aez per land rent region (ha)
-    float *lrout;			// for diagnostic output in USD
     float *orout;			// for diagnostic output in USD
     float *nrout;			// for diagnostic output in USD
     
-    // for now, use old-format 1d arrays for these diagnostic outputs
-    // aez varies faster, then land rent region
-    // to do: check for gridded new aez input
-    float *diag_harvestsum;		// sum for averaging yield and price to gro sector and land rent region per aez (ha)
-    float *diag_pasture87_aez;	// pasture area per aez per land rent region (ha)
-    
     char out_name[] = "rent_use_aez_ag.csv";				// diagnostic output csv file name
     char out_name_past[] = "pasturearea87_aez.csv";		// diagnostic output for the aggregated pasture area
     
@@ -139,11 +131,6 @@ int calc_rent_ag_use_aez(args_struct in_args, rinfo_struct raster_info) {
         }
     }
     // allocate memory for the diagnostic output
-    lrout = calloc(NUM_GTAP_CTRY87 * NUM_GTAP_USE * NUM_NEW_AEZ, sizeof(float));
-    if(lrout == NULL) {
-        fprintf(fplog,"Failed to allocate memory for lrout:  calc_rent_ag_use_aez()\n");
-        return ERROR_MEM;
-    }
     orout = calloc(NUM_GTAP_CTRY87 * NUM_GTAP_USE, sizeof(float));
     if(orout == NULL) {
         fprintf(fplog,"Failed to allocate memory for orout:  calc_rent_ag_use_aez()\n");
@@ -154,16 +141,6 @@ int calc_rent_ag_use_aez(args_struct in_args, rinfo_struct raster_info) {
         fprintf(fplog,"Failed to allocate memory for nrout:  calc_rent_ag_use_aez()\n");
         return ERROR_MEM;
     }
-    diag_harvestsum = calloc(NUM_GTAP_CTRY87 * NUM_NEW_AEZ, sizeof(float));
-    if(diag_harvestsum == NULL) {
-        fprintf(fplog,"Failed to allocate memory for diag_harvestsum:  calc_rent_ag_use_aez()\n");
-        return ERROR_MEM;
-    }
-    diag_pasture87_aez = calloc(NUM_GTAP_CTRY87 * NUM_NEW_AEZ, sizeof(float));
-    if(diag_pasture87_aez == NULL) {
-        fprintf(fplog,"Failed to allocate memory for diag_pasture87_aez:  calc_rent_ag_use_aez()\n");
-        return ERROR_MEM;
-    }
     
     // get the indices of vietnam, hong kong, and taiwan
     // there shouldn't be a failure here, unless the codes above are wrong
@@ -200,14 +177,8 @@ int calc_rent_ag_use_aez(args_struct in_args, rinfo_struct raster_info) {
         // loop over the fao countries to calculate appropriate land values per ctry87 and use sector
         for (ctry_ind = 0; ctry_ind < NUM_FAO_CTRY; ctry_ind++) {
             
-            // get the land rent region index
-            reglr_ind = NOMATCH;
-            for (i = 0; i < NUM_GTAP_CTRY87; i++) {
-                if (country87codes_gtap[i] == ctry2ctry87codes_gtap[ctry_ind]) {
-                    reglr_ind = i;
-                    break;
-                }
-            }	// end for i loop to get reglr_ind
+            // get the land rent region index (see write_glu_mapping())
+            reglr_ind = ctry2reglr_ind[ctry_ind];
             
             // skip this fao country because it is not part of an economic region and thus not processed for output
             if(reglr_ind == NOMATCH) {
@@ -221,13 +192,7 @@ int calc_rent_ag_use_aez(args_struct in_args, rinfo_struct raster_info) {
             for (aez_ind = 0; aez_ind < ctry_aez_num[ctry_ind]; aez_ind++) {
                 
                 // get the index for this aez in the land rent region
-                aez_ind_reglr = NOMATCH;
-                for (i = 0; i < reglr_aez_num[reglr_ind]; i++) {
-                    if (ctry_aez_list[ctry_ind][aez_ind] == reglr_aez_list[reglr_ind][i]) {
-                        aez_ind_reglr = i;
-                        break;
-                    }
-                }	// end for i loop to get aez_ind_reglr
+                aez_ind_reglr = ctry_aez_reglr_ind[ctry_ind][aez_ind];
                 
                 // this should not happen
                 if(aez_ind_reglr == NOMATCH) {
@@ -261,21 +226,6 @@ int calc_rent_ag_use_aez(args_struct in_args, rinfo_struct raster_info) {
                  }
                  */
                 
-                // get the aez index in the complete aez list
-                all_aez_index = NOMATCH;
-                for (i = 0; i < NUM_NEW_AEZ; i++) {
-                    if (aez_codes_new[i] == reglr_aez_list[reglr_ind][aez_ind_reglr]) {
-                        all_aez_index = i;
-                        break;
-                    }
-                }
-                if (all_aez_index == NOMATCH) {
-                    // this shouldn't happen
-                    fprintf(fplog,"Error finding all aez index: calc_rent_frs_use_aez(); land rent region=%i aez=%i\n",
-                            country87codes_gtap[reglr_ind], reglr_aez_list[reglr_ind][aez_ind_reglr]);
-                    return ERROR_FILE;
-                }
-                
                 // ruminant sectors (ctl, rmk, wol)
                 // get the average grain sector (gro) yield from production / harvested area - area weighted!
                 // get the avearge grain sector (gro) prodprice - production weighted!
@@ -285,11 +235,6 @@ int calc_rent_ag_use_aez(args_struct in_args, rinfo_struct raster_info) {
                     if(prodprice_fao_reglr[k] != 0 && production_crop_aez[ctry_ind][aez_ind][crop_ind] != 0) {
                         harvestsum[reglr_ind][aez_ind_reglr] =
                         harvestsum[reglr_ind][aez_ind_reglr] + harvestarea_crop_aez[ctry_ind][aez_ind][crop_ind];
-                        
-                        // fill the 1d array
-                        diag_index = reglr_ind * NUM_NEW_AEZ + all_aez_index;
-                        diag_harvestsum[diag_index] = diag_harvestsum[diag_index] +
-                            harvestarea_crop_aez[ctry_ind][aez_ind][crop_ind];
                     }
                 } // end if gro sector
                 
@@ -297,11 +242,6 @@ int calc_rent_ag_use_aez(args_struct in_args, rinfo_struct raster_info) {
                 if (crop_ind == 0) {
                     pasture87_aez[reglr_ind][aez_ind_reglr] =
                     pasture87_aez[reglr_ind][aez_ind_reglr] + pasturearea_aez[ctry_ind][aez_ind];
-                    
-                    // fill the 1d array
-                    diag_index = reglr_ind * NUM_NEW_AEZ + all_aez_index;
-                    diag_pasture87_aez[diag_index] = diag_pasture87_aez[diag_index] +
-                        pasturearea_aez[ctry_ind][aez_ind];
                 }
                 
             }	// end for loop over country aezs
@@ -395,24 +335,7 @@ int calc_rent_ag_use_aez(args_struct in_args, rinfo_struct raster_info) {
                 // add up the new rent across aez to land rent region for diagnostics
                 newrent87[j] = newrent87[j] + rent_use_aez[reglr_ind][aez_ind_reglr][use_ind];
                 
-                // get the aez index in the complete aez list
-                all_aez_index = NOMATCH;
-                for (i = 0; i < NUM_NEW_AEZ; i++) {
-                    if (aez_codes_new[i] == reglr_aez_list[reglr_ind][aez_ind_reglr]) {
-                        all_aez_index = i;
-                        break;
-                    }
-                }
-                if (all_aez_index == NOMATCH) {
-                    // this shouldn't happen
-                    fprintf(fplog,"Error finding all aez index: calc_rent_frs_use_aez(); land rent region=%i aez=%i\n",
-                            country87codes_gtap[reglr_ind], reglr_aez_list[reglr_ind][aez_ind_reglr]);
-                    return ERROR_FILE;
-                }
-                
-                // convert origrent87, newrent87, and rent_use_aez to USD for diagnostic output
-                out_index = reglr_ind * NUM_GTAP_USE * NUM_NEW_AEZ + use_ind * NUM_NEW_AEZ + all_aez_index;
-                lrout[out_index] = MIL2ONE * rent_use_aez[reglr_ind][aez_ind_reglr][use_ind];
+                // convert origrent87 and newrent87 to USD for diagnostic output
                 nrout[j] = MIL2ONE * newrent87[j];
                 orout[j] = MIL2ONE * origrent87[j];
                 
@@ -421,13 +344,14 @@ int calc_rent_ag_use_aez(args_struct in_args, rinfo_struct raster_info) {
     }	// end for reglr_ind loop to calculate final land rent values
     
     if (in_args.diagnostics) {
-        if ((err = write_csv_float3d(lrout, country87codes_gtap, usecodes_gtap,
-                                     NUM_GTAP_CTRY87, NUM_GTAP_USE, NUM_NEW_AEZ, out_name, in_args))) {
+        // the land rent is written in USD; only the non-zero values of the land rent region glus are written
+        if ((err = write_csv_sparse3d(rent_use_aez, country87codes_gtap, NUM_GTAP_CTRY87, reglr_aez_num, reglr_aez_list,
+                                      usecodes_gtap, NUM_GTAP_USE, MIL2ONE, out_name, in_args))) {
             fprintf(fplog, "Error writing file %s: calc_rent_ag_use_aez()\n", out_name);
             return err;
         }
-        if ((err = write_csv_float2d(diag_pasture87_aez, country87codes_gtap,
-                                     NUM_GTAP_CTRY87, NUM_NEW_AEZ, out_name_past, in_args))) {
+        if ((err = write_csv_sparse2d(pasture87_aez, country87codes_gtap, NUM_GTAP_CTRY87, reglr_aez_num, reglr_aez_list,
+                                      out_name_past, in_args))) {
             fprintf(fplog, "Error writing file %s: calc_rent_ag_use_aez()\n", out_name_past);
             return err;
         }
@@ -446,8 +370,8 @@ int calc_rent_ag_use_aez(args_struct in_args, rinfo_struct raster_info) {
             fprintf(fplog, "Error writing file %s: calc_rent_ag_use_aez()\n", "value_sum.csv");
             return err;
         }
-        if ((err = write_csv_float2d(diag_harvestsum, country87codes_gtap,
-                                     NUM_GTAP_CTRY87, NUM_NEW_AEZ, "harvestsum.csv", in_args))) {
+        if ((err = write_csv_sparse2d(harvestsum, country87codes_gtap, NUM_GTAP_CTRY87, reglr_aez_num, reglr_aez_list,
+                                      "harvestsum.csv", in_args))) {
             fprintf(fplog, "Error writing file %s: calc_rent_ag_use_aez()\n", "harvestsum.csv");
             return err;
         }
@@ -462,11 +386,7 @@ int calc_rent_ag_use_aez(args_struct in_args, rinfo_struct raster_info) {
     }
     free(harvestsum);
     free(pasture87_aez);
-    free(lrout);
     free(orout);
     free(nrout);
     
-    free(diag_harvestsum);
-    free(diag_pasture87_aez);
-    
     return OK;}
@@ -12,6 +12,12 @@
  return value:
  integer error code: OK = 0, otherwise a non-zero error code
  
+ the forest cells are bucketed by land rent region and original aez with a counting sort into one index array,
+    so this takes time proportional to the number of forest cells
+ the land rent region of a cell comes from ctry87_code2ind, and its glu slot from aez_code2ind_new (see write_glu_mapping.c)
+ the buckets are processed serially: the buckets of a land rent region add to the same rent_use_aez rows,
+    and moirai has no threads, so the per-bucket pass is not run in parallel
+ 
  As I was unable to obtain the appropriate DGTM value data and forest type and biome data,
 	this algorithm simply redistributes forest land rent to new aez boundaries based on forest area
  
@@ -41,8 +47,6 @@
  
   Modified fall 2015 by Alan Di Vittorio
  
- to do: check lrout for gridded new aez input
- 
  **********/
 
 #include "moirai.h"
@@ -50,8 +54,10 @@
 int calc_rent_frs_use_aez(args_struct in_args, rinfo_struct raster_info) {
 	
 	int i, j;
-	int aez_ind_orig, aez_ind_reglr, use_ind, fa_ind, roa_ind, reglr_ind, out_index, all_aez_index;	// loop and placement indices
+	int aez_ind_orig, aez_ind_reglr, use_ind, fa_ind, roa_ind, reglr_ind;	// loop and placement indices
 	int forest_cell_ind;	// index for looping over forest_cells
+	int num_fa = NUM_GTAP_CTRY87 * NUM_ORIG_AEZ;	// number of land rent region x original aez buckets
+	int *glu_slot;			// index of each glu (by aez_codes_new index) in the list of the current land rent region
 	
 	int aez_val;			// the aez number for current cell
 	int frs_sect = 13;		// the use index for the forest sector
@@ -59,12 +65,12 @@ int calc_rent_frs_use_aez(args_struct in_args, rinfo_struct raster_info) {
 	
 	float *forest_area;         // forest area per original aez per land rent region (aez vaeries faster) (km^2)
 	float *rent_orig_per_area;	// original rent per forest area per aez per land rent region (aez vaeries faster) (million USD/km^2)
-	int *temp_indices;			// temp array for storing the forest cell indices when lengthening the forest_indices dim2
-	int **forest_indices;		// the forest cell indices per original aez per land rent region (aez vaeries faster); cell indices in dim2
-	int *num_forest_indices;	// the number of forest cell indices per original aez per land rent region (aez vaeries faster)
+	int *forest_fa_ind;			// the bucket of each forest cell; NOMATCH = no valid aez or land rent region
+	int *forest_indices;		// the forest cell indices, grouped by original aez per land rent region (aez vaeries faster)
+	int *forest_start;			// start of each bucket in forest_indices; bucket fa_ind ends at forest_start[fa_ind + 1]
+	int *forest_fill;			// next free position of each bucket when filling forest_indices
 	
 	float *newvorigrent87;		// store the new forest rent summed across aezs in USD (i.e. per ctry87, first dim is new, second dim is orig)
-	float *lrout;				// for diagnostic output in USD
 	
 	char out_name[] = "rent_use_aez_all.csv";			// diagnostic output csv file name for entire table
 	char out_comp_name[] = "newvorigrent87.csv";		// diagnostic output csv file name for ctry87 forest rent comparison
@@ -81,29 +87,22 @@ int calc_rent_frs_use_aez(args_struct in_args, rinfo_struct raster_info) {
 		fprintf(fplog,"Failed to allocate memory for rent_orig_per_area:  calc_rent_frs_use_aez()\n");
 		return ERROR_MEM;
 	}
-	num_forest_indices = calloc(NUM_GTAP_CTRY87 * NUM_ORIG_AEZ, sizeof(int));
-	if(num_forest_indices == NULL) {
-		fprintf(fplog,"Failed to allocate memory for num_forest_indices:  calc_rent_frs_use_aez()\n");
-		return ERROR_MEM;
-	}
-	temp_indices = calloc(NUM_CELLS, sizeof(int));
-	if(temp_indices == NULL) {
-		fprintf(fplog,"Failed to allocate memory for temp_indices:  calc_rent_frs_use_aez()\n");
+	forest_start = calloc(num_fa + 1, sizeof(int));
+	forest_fill = calloc(num_fa, sizeof(int));
+	// one extra element so that a run without forest cells is not zero size
+	forest_fa_ind = calloc(num_forest_cells + 1, sizeof(int));
+	forest_indices = calloc(num_forest_cells + 1, sizeof(int));
+	if(forest_start == NULL || forest_fill == NULL || forest_fa_ind == NULL || forest_indices == NULL) {
+		fprintf(fplog,"Failed to allocate memory for forest_indices:  calc_rent_frs_use_aez()\n");
 		return ERROR_MEM;
 	}
-	forest_indices = calloc(NUM_GTAP_CTRY87 * NUM_ORIG_AEZ, sizeof(int *));
-	if(forest_indices == NULL) {
-		fprintf(fplog,"Failed to allocate memory for dim1 of forest_indices:  calc_rent_frs_use_aez()\n");
+	glu_slot = malloc(NUM_NEW_AEZ * sizeof(int));
+	if(glu_slot == NULL) {
+		fprintf(fplog,"Failed to allocate memory for glu_slot:  calc_rent_frs_use_aez()\n");
 		return ERROR_MEM;
 	}
-	// the second dimension will be dynamically reallocated for each dim1 index as needed
-	// but put initial allocation here
-	for (i = 0; i < NUM_GTAP_CTRY87 * NUM_ORIG_AEZ; i++) {
-		forest_indices[i] = calloc(1, sizeof(int));
-		if(forest_indices[i] == NULL) {
-			fprintf(fplog,"Failed to allocate initial dummy memory for forest_indices[i]; i=%i:  calc_rent_frs_use_aez()\n", i);
-			return ERROR_MEM;
-		}
+	for (i = 0; i < NUM_NEW_AEZ; i++) {
+		glu_slot[i] = NOMATCH;
 	}
 	// allocate memory for the diagnostic output
 	newvorigrent87 = calloc(NUM_GTAP_CTRY87 * 2, sizeof(float));
@@ -111,15 +110,13 @@ int calc_rent_frs_use_aez(args_struct in_args, rinfo_struct raster_info) {
 		fprintf(fplog,"Failed to allocate memory for newvorigrent87:  calc_rent_frs_use_aez()\n");
 		return ERROR_MEM;
 	}
-	lrout = calloc(NUM_GTAP_CTRY87 * NUM_GTAP_USE * NUM_NEW_AEZ, sizeof(float));
-	if(lrout == NULL) {
-		fprintf(fplog,"Failed to allocate memory for lrout:  calc_rent_frs_use_aez()\n");
-		return ERROR_MEM;
-	}
 	
 	// loop over forest_cells to calculate forest area per cell and to assign forest cells to reglrxorigaez
+	// this first pass counts the cells in each bucket
 	for (forest_cell_ind = 0; forest_cell_ind < num_forest_cells; forest_cell_ind++) {
 		
+		forest_fa_ind[forest_cell_ind] = NOMATCH;
+		
 		// get the orig aez id; this function retrieves the nodata value if no associated aez is found
 		// do not use this cell data if there is no associated aez
 		if ((err = get_aez_val(aez_bounds_orig, forest_cells[forest_cell_ind], raster_info.aez_orig_nrows,
@@ -133,12 +130,9 @@ int calc_rent_frs_use_aez(args_struct in_args, rinfo_struct raster_info) {
 			
 			// get reglr index of this cell
 			reglr_ind = NOMATCH;
-			for (i = 0; i < NUM_GTAP_CTRY87; i++) {
-				if (country87codes_gtap[i] == country87_gtap[forest_cells[forest_cell_ind]]) {
-					reglr_ind = i;
-					break;
-				}
-			}	// end for i loop to get reglr_ind
+			if (country87_gtap[forest_cells[forest_cell_ind]] >= 0 && country87_gtap[forest_cells[forest_cell_ind]] <= max_ctry87_code) {
+				reglr_ind = ctry87_code2ind[country87_gtap[forest_cells[forest_cell_ind]]];
+			}
 			if(reglr_ind == NOMATCH) {	// now this should not happen
 				fprintf(fplog,"Failed to find land rent region index:  calc_rent_frs_use_aez()\n");
 				return ERROR_IND;
@@ -151,30 +145,36 @@ int calc_rent_frs_use_aez(args_struct in_args, rinfo_struct raster_info) {
 			fa_ind = reglr_ind * NUM_ORIG_AEZ + aez_ind_orig; // index of the 2d forest_area array
 			forest_area[fa_ind] = forest_area[fa_ind] + refveg_area[forest_cells[forest_cell_ind]];
 			
-			// grow the dim2 as needed, per orig aez and ctry87
-			for (i = 0; i < num_forest_indices[fa_ind]; i++) {
-				temp_indices[i] = forest_indices[fa_ind][i];
-			}
-			free(forest_indices[fa_ind]);
-			forest_indices[fa_ind] = calloc(num_forest_indices[fa_ind] + 1, sizeof(int));
-			if(forest_indices[fa_ind] == NULL) {
-				fprintf(fplog,"Failed to allocate memory for forest_indices[i]; i=%i:  calc_rent_frs_use_aez()\n", i);
-				return ERROR_MEM;
-			}
-			for (i = 0; i < num_forest_indices[fa_ind]; i++) {
-				forest_indices[fa_ind][i] = temp_indices[i];
-			}
-			forest_indices[fa_ind][num_forest_indices[fa_ind]++] = forest_cells[forest_cell_ind];
+			forest_fa_ind[forest_cell_ind] = fa_ind;
+			forest_start[fa_ind + 1]++;
 		
 		}	// end if valid aez cell
 	} // end for forest_cell_ind loop over forest cells
 	
+	// the second pass puts the cells in their buckets, in forest_cells order
+	for (fa_ind = 0; fa_ind < num_fa; fa_ind++) {
+		forest_start[fa_ind + 1] = forest_start[fa_ind + 1] + forest_start[fa_ind];
+		forest_fill[fa_ind] = forest_start[fa_ind];
+	}
+	for (forest_cell_ind = 0; forest_cell_ind < num_forest_cells; forest_cell_ind++) {
+		if (forest_fa_ind[forest_cell_ind] != NOMATCH) {
+			forest_indices[forest_fill[forest_fa_ind[forest_cell_ind]]++] = forest_cells[forest_cell_ind];
+		}
+	}
+	
 	// loop over reglrxorigaez to calculate the land rent per unit of forest area for reglrxorigaez:
 	//	rent_orig_per_area[reglrxorig_aez]=rent_orig_aez[reglrxusexorig_aez] / forest_area[reglrxorig_aez]
 	// also loop over the forest indices to calc rent_use_aez[reglr][newaez][use]:
 	//  rent_use_aez[reglr][newaez][use] =
 	//   rent_use_aez[reglr][newaez][use] + rent_orig_per_area[reglrxorig_aez] * forest_area[forest_indices[fa_ind][i]]
+	// the glus of each land rent region are spread over glu_slot (see write_glu_mapping() for aez_code2ind_new)
 	for (reglr_ind = 0; reglr_ind <  NUM_GTAP_CTRY87; reglr_ind++) {
+		for (j = 0; j < reglr_aez_num[reglr_ind]; j++) {
+			aez_val = reglr_aez_list[reglr_ind][j];
+			if (aez_val >= 0 && aez_val <= max_aez_code_new && aez_code2ind_new[aez_val] != NOMATCH) {
+				glu_slot[aez_code2ind_new[aez_val]] = j;
+			}
+		}
 		for (aez_ind_orig = 0; aez_ind_orig < NUM_ORIG_AEZ; aez_ind_orig++) {
 			// get the use sector index for forest sector
 			use_ind = NOMATCH;
@@ -197,23 +197,20 @@ int calc_rent_frs_use_aez(args_struct in_args, rinfo_struct raster_info) {
 				rent_orig_per_area[fa_ind] = rent_orig_aez[roa_ind] / forest_area[fa_ind];
 			}
 			
-			for (i = 0; i < num_forest_indices[fa_ind]; i++) {
+			for (i = forest_start[fa_ind]; i < forest_start[fa_ind + 1]; i++) {
 				// get the new aez id; this function retrieves the nodata value if no associated aez is found
 				// do not use this cell data if there is no associated new aez
-				if ((err = get_aez_val(aez_bounds_new, forest_indices[fa_ind][i], raster_info.aez_new_nrows,
+				if ((err = get_aez_val(aez_bounds_new, forest_indices[i], raster_info.aez_new_nrows,
 									   raster_info.aez_new_ncols, raster_info.aez_new_nodata, &aez_val))) {
-					fprintf(fplog, "Failed to get new aez_val for forest_indices[%i][%i]: calc_rent_frs_use_aez()\n", fa_ind, i);
+					fprintf(fplog, "Failed to get new aez_val for forest_indices[%i]: calc_rent_frs_use_aez()\n", i);
 					return err;
 				}
 				if (aez_val != raster_info.aez_new_nodata) {
                     // get the new aez index in this land rent region for this cell
                     aez_ind_reglr = NOMATCH;
-                    for (j = 0; j < reglr_aez_num[reglr_ind]; j++) {
-                        if (reglr_aez_list[reglr_ind][j] == aez_val) {
-                            aez_ind_reglr = j;
-                            break;
-                        }
-                    }	// end for i loop to get reglr_ind
+                    if (aez_val >= 0 && aez_val <= max_aez_code_new && aez_code2ind_new[aez_val] != NOMATCH) {
+                        aez_ind_reglr = glu_slot[aez_code2ind_new[aez_val]];
+                    }
                     if(aez_ind_reglr == NOMATCH) {	// now this should not happen
                         fprintf(fplog,"Failed to find aez index for land rent region index %i:  calc_rent_frs_use_aez()\n",
                                 reglr_ind);
@@ -221,11 +218,11 @@ int calc_rent_frs_use_aez(args_struct in_args, rinfo_struct raster_info) {
                     }
 
                     rent_use_aez[reglr_ind][aez_ind_reglr][use_ind] = rent_use_aez[reglr_ind][aez_ind_reglr][use_ind] +
-						rent_orig_per_area[fa_ind] * refveg_area[forest_indices[fa_ind][i]];
+						rent_orig_per_area[fa_ind] * refveg_area[forest_indices[i]];
                     
 					// for diagnostic output in USD, new in the first dim
 					newvorigrent87[reglr_ind * 2] = newvorigrent87[reglr_ind * 2] +
-						MIL2ONE * rent_orig_per_area[fa_ind] * refveg_area[forest_indices[fa_ind][i]];
+						MIL2ONE * rent_orig_per_area[fa_ind] * refveg_area[forest_indices[i]];
 				} // end if valid new aez value
 			}	// end for i loop over forest_indices to calc rent_use_aez
 			
@@ -243,40 +240,21 @@ int calc_rent_frs_use_aez(args_struct in_args, rinfo_struct raster_info) {
 			} // end if diagnostic output
 
 		}	// end for aez_ind_orig loop to calc rent_orig_per_area
-        
-        // convert rent_use_aez to USD for diagnostic output; this land rent region is done
-        
-        // loop over the new aezs in this land rent region
-        for (aez_ind_reglr = 0; aez_ind_reglr < reglr_aez_num[reglr_ind]; aez_ind_reglr++) {
-            
-            // get the new aez index in the complete aez list
-            all_aez_index = NOMATCH;
-            for (i = 0; i < NUM_NEW_AEZ; i++) {
-                if (aez_codes_new[i] == reglr_aez_list[reglr_ind][aez_ind_reglr]) {
-                    all_aez_index = i;
-                    break;
-                }
-            }
-            if (all_aez_index == NOMATCH) {
-                // this shouldn't happen
-                fprintf(fplog,"Error finding all aez index: calc_rent_frs_use_aez(); land rent region=%i aez=%i\n",
-                        country87codes_gtap[reglr_ind], reglr_aez_list[reglr_ind][aez_ind_reglr]);
-                return ERROR_IND;
-            }
-            
-            for (i = 0; i < NUM_GTAP_USE; i++) {
-                out_index = reglr_ind * NUM_GTAP_USE * NUM_NEW_AEZ + i * NUM_NEW_AEZ + all_aez_index;
-                lrout[out_index] = MIL2ONE * rent_use_aez[reglr_ind][aez_ind_reglr][i];
-            }
-            
-        } // end for loop over the new aezs in this land rent region to fill the diagnostic array
+		
+		for (j = 0; j < reglr_aez_num[reglr_ind]; j++) {
+			aez_val = reglr_aez_list[reglr_ind][j];
+			if (aez_val >= 0 && aez_val <= max_aez_code_new && aez_code2ind_new[aez_val] != NOMATCH) {
+				glu_slot[aez_code2ind_new[aez_val]] = NOMATCH;
+			}
+		}
         
 	}	// end for reglr_ind loop to calc rent_orig_per_area
 
 
 	if (in_args.diagnostics) {
-		if ((err = write_csv_float3d(lrout, country87codes_gtap, usecodes_gtap,
-									 NUM_GTAP_CTRY87, NUM_GTAP_USE, NUM_NEW_AEZ, out_name, in_args))) {
+		// the land rent is written in USD; only the non-zero values of the land rent region glus are written
+		if ((err = write_csv_sparse3d(rent_use_aez, country87codes_gtap, NUM_GTAP_CTRY87, reglr_aez_num, reglr_aez_list,
+									  usecodes_gtap, NUM_GTAP_USE, MIL2ONE, out_name, in_args))) {
 			fprintf(fplog, "Error writing file %s: calc_rent_frs_use_aez()\n", out_name);
 			return err;
 		}
@@ -294,13 +272,11 @@ int calc_rent_frs_use_aez(args_struct in_args, rinfo_struct raster_info) {
 	
 	free(newvorigrent87);
 	free(forest_area);
-	for (i = 0; i < NUM_GTAP_CTRY87 * NUM_ORIG_AEZ; i++) {
-		free(forest_indices[i]);
-	}
 	free(forest_indices);
-	free(temp_indices);
-	free(num_forest_indices);
-	free(lrout);
+	free(forest_start);
+	free(forest_fill);
+	free(forest_fa_ind);
+	free(glu_slot);
     free(rent_orig_per_area);
 	
 	return OK;}
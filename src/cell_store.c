@@ -0,0 +1,327 @@
+/**********
+ cell_store.c
+
+ write the per-cell land type area store: the working grid cell values that proc_land_type_area() aggregates
+    to country X glu X land type X year, before the aggregation
+ tools/moirai_reaggregate.c rebuilds the land type area table for another glu raster from this file,
+    without reading and disaggregating the hyde and lulc data again
+
+ the stored cells are those that proc_land_type_area() would add for a glu raster that covers every cell:
+    valid, non-zero hyde land area, in a valid economic country (serbia and montenegro merged), in the region subset box
+ the cells are stored in the order in which proc_land_type_area() visits them (lulc cell, then working grid row and column)
+    so that summing them in store order gives the same double values, and the same table, as a moirai run
+
+ the store is a binary file in native byte order, laid out in columns so that it can be memory mapped:
+    cell_store_header_struct
+    int hyde_years[num_years]
+    int lt_cats[num_lt_cats]
+    char iso[num_ctry][CELL_STORE_ISO_LEN]: countryabbrs_iso, null padded
+    int grid_ind[num_cells]: working grid 1d index
+    int ctry_ind[num_cells]: index in the country table
+    float protected[num_protected][num_cells]: fraction of the cell in each protected category
+    then for each year, in hyde_years order:
+        double refveg_area[num_cells], double crop_area[num_cells], double pasture_area[num_cells], double urban_area[num_cells] (km^2)
+        int rv_value[num_cells]: sage potential vegetation code of the reference veg; 0 = unknown
+ every section is zero padded to a multiple of CELL_STORE_ALIGN bytes
+ the areas are stored as computed, including nodata values, so that the reader applies the same nodata checks
+
+ functions:
+ init_cell_store():			find the stored cells, open the file, and write the header and the static columns
+ add_cell_store():			store the values of the next cell for the current year; called by proc_land_type_area()
+ write_cell_store_year():	write the columns of the current year
+ close_cell_store():		close the file and free the store arrays
+
+ arguments:
+ args_struct in_args:		the input argument structure
+ rinfo_struct raster_info:	information about input raster data
+ int row_min, row_max, col_min, col_max:	the region subset box of proc_land_type_area()
+ int grid_ind:				working grid 1d index of the cell; must be the next stored cell
+ int ctry_ind:				fao country index of the cell
+ int rv_value:				reference veg value of the cell
+ double refveg_area, crop_area, pasture_area, urban_area:	areas of the cell (km^2)
+ int year_ind:				index of the current year in hyde_years
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#include "moirai.h"
+
+// the open store
+static FILE *fpstore = NULL;
+static char store_fname[MAXCHAR];
+static int num_store_cells = 0;		// number of stored cells
+static int cur_cell = 0;			// the next cell to store in the current year
+static int *store_grid_ind;			// working grid 1d index of each stored cell
+static double *store_refveg;		// the year columns
+static double *store_crop;
+static double *store_pasture;
+static double *store_urban;
+static int *store_rv;
+
+// write a column and pad it to CELL_STORE_ALIGN bytes
+static int write_store_column(const void *col, size_t size, size_t num) {
+
+	char pad[CELL_STORE_ALIGN];
+	size_t num_pad = (CELL_STORE_ALIGN - (size * num) % CELL_STORE_ALIGN) % CELL_STORE_ALIGN;
+
+	memset(pad, 0, CELL_STORE_ALIGN);
+	if (num > 0 && fwrite(col, size, num, fpstore) != num) {
+		return ERROR_FILE;
+	}
+	if (num_pad > 0 && fwrite(pad, 1, num_pad, fpstore) != num_pad) {
+		return ERROR_FILE;
+	}
+	return OK;
+}
+
+// get the economic country index of a cell, with serbia and montenegro merged; NOMATCH if not stored
+//	ctry_code2ind is the fao country index of each fao country code up to max_ctry_code
+static int get_store_ctry(int grid_ind, const int *ctry_code2ind, int max_ctry_code) {
+
+	int ctry_ind;
+	int ctry_code = country_fao[grid_ind];
+	int scg_code = 186;         // fao code for serbia and montenegro
+	int srb_code = 272;         // fao code for serbia
+	int mne_code = 273;         // fao code for montenegro
+
+	if (ctry_code == mne_code || ctry_code == srb_code) {
+		ctry_code = scg_code;
+	}
+	ctry_ind = (ctry_code >= 0 && ctry_code <= max_ctry_code) ? ctry_code2ind[ctry_code] : NOMATCH;
+	if (ctry_ind == NOMATCH || ctry2ctry87codes_gtap[ctry_ind] == NOMATCH) {
+		return NOMATCH;
+	}
+	return ctry_ind;
+}
+
+int init_cell_store(args_struct in_args, rinfo_struct raster_info, int row_min, int row_max, int col_min, int col_max) {
+
+	int i, k, m, n;
+	int grid_ind;
+	int grid_y_ul, grid_x_ul;	// row and column of the ul corner working grid cell of a lulc cell
+	int num_split = raster_info.num_split;
+	int ncols_lulc = raster_info.lulc_input_ncols;
+	int ncells_lulc = raster_info.lulc_input_ncells;
+	int *store_ctry_ind = NULL;	// country index of each stored cell
+	int ctry_ind;				// country index of a cell
+	int *ctry_code2ind;			// fao country index of each fao country code
+	int max_ctry_code;			// largest fao country code
+	float *prot_col;			// one protected category column
+	char iso[CELL_STORE_ISO_LEN];
+	cell_store_header_struct header;
+
+	// map the fao country codes to the country indices, for the country lookup of each cell
+	max_ctry_code = 0;
+	for (m = 0; m < NUM_FAO_CTRY; m++) {
+		if (countrycodes_fao[m] > max_ctry_code) {
+			max_ctry_code = countrycodes_fao[m];
+		}
+	}
+	ctry_code2ind = malloc((max_ctry_code + 1) * sizeof(int));
+	if(ctry_code2ind == NULL) {
+		fprintf(fplog,"Failed to allocate memory for ctry_code2ind: init_cell_store()\n");
+		return ERROR_MEM;
+	}
+	for (m = 0; m <= max_ctry_code; m++) {
+		ctry_code2ind[m] = NOMATCH;
+	}
+	// the first index of a duplicated code, as in the linear search
+	for (m = NUM_FAO_CTRY - 1; m >= 0; m--) {
+		if (countrycodes_fao[m] >= 0) {
+			ctry_code2ind[countrycodes_fao[m]] = m;
+		}
+	}
+
+	// count the stored cells, in the proc_land_type_area() order
+	num_store_cells = 0;
+	for (k = 0; k < 2; k++) {
+		if (k == 1) {
+			store_grid_ind = calloc(num_store_cells, sizeof(int));
+			store_ctry_ind = calloc(num_store_cells, sizeof(int));
+			if(store_grid_ind == NULL || store_ctry_ind == NULL) {
+				fprintf(fplog,"Failed to allocate memory for the store cells: init_cell_store()\n");
+				return ERROR_MEM;
+			}
+			num_store_cells = 0;
+		}
+		for (i = 0; i < ncells_lulc; i++) {
+			grid_y_ul = (i / ncols_lulc) * num_split;
+			grid_x_ul = (i % ncols_lulc) * num_split;
+			if (grid_y_ul + num_split <= row_min || grid_y_ul > row_max ||
+				grid_x_ul + num_split <= col_min || grid_x_ul > col_max) {
+				continue;
+			}
+			for (m = grid_y_ul; m < grid_y_ul + num_split; m++) {
+				for (n = grid_x_ul; n < grid_x_ul + num_split; n++) {
+					grid_ind = m * NUM_LON + n;
+					if (land_area_hyde[grid_ind] == raster_info.land_area_hyde_nodata || land_area_hyde[grid_ind] == 0) {
+						continue;
+					}
+					ctry_ind = get_store_ctry(grid_ind, ctry_code2ind, max_ctry_code);
+					if (ctry_ind == NOMATCH) {
+						continue;
+					}
+					if (k == 1) {
+						store_grid_ind[num_store_cells] = grid_ind;
+						store_ctry_ind[num_store_cells] = ctry_ind;
+					}
+					num_store_cells++;
+				}
+			}
+		} // end for i loop over the lulc cells
+	} // end for k loop over the count and store passes
+	free(ctry_code2ind);
+
+	store_refveg = calloc(num_store_cells, sizeof(double));
+	store_crop = calloc(num_store_cells, sizeof(double));
+	store_pasture = calloc(num_store_cells, sizeof(double));
+	store_urban = calloc(num_store_cells, sizeof(double));
+	store_rv = calloc(num_store_cells, sizeof(int));
+	prot_col = calloc(num_store_cells, sizeof(float));
+	if(store_refveg == NULL || store_crop == NULL || store_pasture == NULL || store_urban == NULL || store_rv == NULL ||
+	   prot_col == NULL) {
+		fprintf(fplog,"Failed to allocate memory for the store columns: init_cell_store()\n");
+		return ERROR_MEM;
+	}
+
+	// open the file and write the header and the static columns
+	strcpy(store_fname, in_args.outpath);
+	strcat(store_fname, in_args.cell_store_fname);
+	if((fpstore = fopen(store_fname, "wb")) == NULL)
+	{
+		fprintf(fplog,"Failed to open file %s: init_cell_store()\n", store_fname);
+		return ERROR_FILE;
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CELL_STORE_MAGIC, 8);
+	header.version = CELL_STORE_VERSION;
+	header.num_cells = num_store_cells;
+	header.num_years = num_hyde_years;
+	header.num_lt_cats = num_lt_cats;
+	header.num_ctry = NUM_FAO_CTRY;
+	header.num_protected = NUM_EPA_PROTECTED;
+	header.grid_nrows = NUM_LAT;
+	header.grid_ncols = NUM_LON;
+	header.refveg_nodata = NODATA;
+	header.lu_nodata = raster_info.lu_nodata;
+
+	if (write_store_column(&header, sizeof(header), 1) != OK ||
+		write_store_column(hyde_years, sizeof(int), num_hyde_years) != OK ||
+		write_store_column(lt_cats, sizeof(int), num_lt_cats) != OK) {
+		fprintf(fplog,"Error writing file %s header: init_cell_store()\n", store_fname);
+		return ERROR_FILE;
+	}
+	for (i = 0; i < NUM_FAO_CTRY; i++) {
+		memset(iso, 0, CELL_STORE_ISO_LEN);
+		strncpy(iso, countryabbrs_iso[i], CELL_STORE_ISO_LEN - 1);
+		if (fwrite(iso, 1, CELL_STORE_ISO_LEN, fpstore) != CELL_STORE_ISO_LEN) {
+			fprintf(fplog,"Error writing file %s country table: init_cell_store()\n", store_fname);
+			return ERROR_FILE;
+		}
+	}
+	if (write_store_column(store_grid_ind, sizeof(int), num_store_cells) != OK ||
+		write_store_column(store_ctry_ind, sizeof(int), num_store_cells) != OK) {
+		fprintf(fplog,"Error writing file %s cell columns: init_cell_store()\n", store_fname);
+		return ERROR_FILE;
+	}
+	for (k = 0; k < NUM_EPA_PROTECTED; k++) {
+		for (i = 0; i < num_store_cells; i++) {
+			prot_col[i] = protected_EPA[k][store_grid_ind[i]];
+		}
+		if (write_store_column(prot_col, sizeof(float), num_store_cells) != OK) {
+			fprintf(fplog,"Error writing file %s protected column %i: init_cell_store()\n", store_fname, k);
+			return ERROR_FILE;
+		}
+	}
+
+	free(store_ctry_ind);
+	free(prot_col);
+
+	cur_cell = 0;
+	fprintf(fplog, "Cell store %s: %i cells X %i years: init_cell_store()\n", store_fname, num_store_cells, num_hyde_years);
+
+	return OK;}
+
+int add_cell_store(int grid_ind, int ctry_ind, int rv_value, double refveg_area, double crop_area, double pasture_area,
+				   double urban_area) {
+
+	// the cells have to arrive in the order found by init_cell_store()
+	if (cur_cell >= num_store_cells || store_grid_ind[cur_cell] != grid_ind) {
+		fprintf(fplog, "Error: cell %i (country index %i) is not the next stored cell: add_cell_store()\n", grid_ind, ctry_ind);
+		return ERROR_IND;
+	}
+
+	store_refveg[cur_cell] = refveg_area;
+	store_crop[cur_cell] = crop_area;
+	store_pasture[cur_cell] = pasture_area;
+	store_urban[cur_cell] = urban_area;
+	store_rv[cur_cell] = rv_value;
+	cur_cell++;
+
+	return OK;}
+
+int write_cell_store_year(int year_ind) {
+
+	if (cur_cell != num_store_cells) {
+		fprintf(fplog, "Error: %i of %i cells stored for year %i: write_cell_store_year()\n", cur_cell, num_store_cells,
+				hyde_years[year_ind]);
+		return ERROR_IND;
+	}
+
+	if (write_store_column(store_refveg, sizeof(double), num_store_cells) != OK ||
+		write_store_column(store_crop, sizeof(double), num_store_cells) != OK ||
+		write_store_column(store_pasture, sizeof(double), num_store_cells) != OK ||
+		write_store_column(store_urban, sizeof(double), num_store_cells) != OK ||
+		write_store_column(store_rv, sizeof(int), num_store_cells) != OK) {
+		fprintf(fplog,"Error writing file %s year %i: write_cell_store_year()\n", store_fname, hyde_years[year_ind]);
+		return ERROR_FILE;
+	}
+
+	cur_cell = 0;
+
+	return OK;}
+
+int close_cell_store(void) {
+
+	int err = OK;
+
+	if (fpstore != NULL && fclose(fpstore) != 0) {
+		fprintf(fplog,"Error writing file %s: close_cell_store()\n", store_fname);
+		err = ERROR_FILE;
+	}
+	fpstore = NULL;
+
+	free(store_grid_ind);
+	free(store_refveg);
+	free(store_crop);
+	free(store_pasture);
+	free(store_urban);
+	free(store_rv);
+
+	return err;}
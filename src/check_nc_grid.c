@@ -0,0 +1,66 @@
+/**********
+ check_nc_grid.c
+
+ check that the last two dimensions (lat, lon) of a netcdf variable match the expected grid
+    this keeps a file at a different resolution than set in the input file from being read into the grid arrays
+ the other dimensions (e.g. time, level, lc type) are not checked
+
+ arguments:
+ int ncid: the netcdf file id
+ int ncvarid: the netcdf variable id
+ int nrows: the expected number of rows (lats)
+ int ncols: the expected number of columns (lons)
+ const char *fname: the file name, for the log message
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+ 
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+ 
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+ 
+ This file is part of Moirai.
+ 
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+ **********/
+
+#include "moirai.h"
+
+int check_nc_grid(int ncid, int ncvarid, int nrows, int ncols, const char *fname) {
+	
+	int ndims;						// number of dimensions of the variable
+	int dimids[NC_MAX_VAR_DIMS];	// dimension ids of the variable
+	size_t dimlen_lat;				// length of the lat dimension
+	size_t dimlen_lon;				// length of the lon dimension
+	int ncerr;						// error return value; 0 = ok
+	
+	if ((ncerr = nc_inq_varndims(ncid, ncvarid, &ndims)) || ndims < 2 ||
+		(ncerr = nc_inq_vardimid(ncid, ncvarid, dimids)) ||
+		(ncerr = nc_inq_dimlen(ncid, dimids[ndims - 2], &dimlen_lat)) ||
+		(ncerr = nc_inq_dimlen(ncid, dimids[ndims - 1], &dimlen_lon))) {
+		fprintf(fplog,"Error %i when getting the grid dimensions of %s: check_nc_grid()\n", ncerr, fname);
+		return ERROR_FILE;
+	}
+	
+	if ((int) dimlen_lat != nrows || (int) dimlen_lon != ncols) {
+		fprintf(fplog,"Error: %s grid is %i x %i but %i x %i is expected; check grid_res_sec and lulc_res_sec: check_nc_grid()\n",
+				fname, (int) dimlen_lat, (int) dimlen_lon, nrows, ncols);
+		return ERROR_FILE;
+	}
+	
+	return OK;}
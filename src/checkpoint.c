@@ -0,0 +1,424 @@
+/**********
+ checkpoint.c
+
+ checkpoint store for the output files of a pipeline stage, so that a rerun with the same inputs restores them
+    instead of processing the stage again
+ the store is in checkpoint_path, with one directory for each stage and key: <checkpoint_path><stage>_<key>/
+    it holds a copy of each output file, named <output index>_<file name>, and manifest.txt, which is written last
+
+ a stage declares its checkpoint between init_checkpoint() and restore_checkpoint():
+    the input arguments that it depends on (add_checkpoint_arg(), add_checkpoint_num())
+    the directories of the input files that it reads (add_checkpoint_dir())
+    the output files that it writes (add_checkpoint_output())
+ the key is a 64 bit FNV-1a hash of the stage name, CHECKPOINT_VERSION, the arguments,
+    and the name, size, inode, and modification and status change times (with nanoseconds) of every regular file
+    in the input directories, and the content of the files up to CHECKPOINT_DIGEST_BYTES
+    so a changed argument or input file gives a new key, and the stage is processed again
+    the small csv tables are the files most likely to be edited in place, so their content is in the key;
+        a large raster rewritten with the same size keeps its inode but gets a new status change time
+    the output paths are not in the key, so the outputs are restored to the output paths of the current run
+ restore_checkpoint() copies the outputs of a complete checkpoint with the key to the output paths and sets restored = 1
+    otherwise the stage is processed and save_checkpoint() copies its outputs to the store
+ nothing is done if checkpoint_path is none; a checkpoint that cannot be saved or restored is logged but is not an error
+    a checkpoint file name longer than MAXCHAR is an error, so a truncated name is never used
+ old checkpoints are not removed; delete the directories in checkpoint_path to free the space
+ init_checkpoint_key() starts a declaration that only makes the key, without a checkpoint store, also if checkpoint_path is none
+    serve mode compares these keys between requests to find the stages that have to be processed again (see serve_stages.c)
+
+ functions:
+ init_checkpoint():			start the checkpoint declaration of a stage
+ init_checkpoint_key():		start the key of a stage, without a checkpoint store
+ get_checkpoint_key():		the key of the declaration
+ add_checkpoint_arg():		add a text input argument to the key
+ add_checkpoint_num():		add a numeric input argument to the key
+ add_checkpoint_dir():		add the regular files in an input directory to the key
+ add_checkpoint_output():	add an output file of the stage
+ restore_checkpoint():		restore the outputs if there is a complete checkpoint with the key
+ save_checkpoint():			save the outputs to the checkpoint store
+
+ arguments:
+ args_struct in_args:		the input file arguments
+ const char *stage_name:	the stage name, used in the checkpoint directory name
+ const char *name:			the input argument name
+ const char *value:			the text input argument value
+ double num:				the numeric input argument value
+ const char *path:			the input directory, or the output path of an output file (with final "/")
+ const char *fname:			the output file name without path
+ int *restored:				set to 1 if the outputs were restored, 0 if the stage has to be processed
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "moirai.h"
+#include <stdint.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#define FNV_OFFSET	14695981039346656037ULL
+#define FNV_PRIME	1099511628211ULL
+
+static int ckpt_on = 0;						// 1 = a checkpoint or key is declared
+static int ckpt_store = 0;					// 1 = the declaration has a checkpoint store
+static uint64_t ckpt_key;					// the key hash
+static char ckpt_dir[MAXCHAR];				// the checkpoint directory of the stage and key, with final "/"
+static char ckpt_stage[MAX_PROF_NAME];		// the stage name
+static char (*ckpt_paths)[MAXCHAR] = NULL;	// output path of each output file
+static char (*ckpt_fnames)[MAXCHAR] = NULL;	// name of each output file
+static int ckpt_num_out = 0;				// number of output files
+static char ckpt_root[MAXCHAR];				// checkpoint_path
+
+// add bytes to a FNV-1a hash
+static uint64_t hash_bytes(uint64_t hash, const void *bytes, size_t len) {
+
+	const unsigned char *b = bytes;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		hash ^= b[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+// add a text value to the key; the terminating zero separates consecutive values
+static void hash_str(const char *str) {
+	ckpt_key = hash_bytes(ckpt_key, str, strlen(str) + 1);
+}
+
+// the key names the checkpoint directory
+static int set_ckpt_dir(void) {
+	int len = snprintf(ckpt_dir, MAXCHAR, "%s%s_%016llx/", ckpt_root, ckpt_stage, (unsigned long long) ckpt_key);
+	if (len < 0 || len >= MAXCHAR) {
+		fprintf(fplog, "Checkpoint directory name of stage %s in %s is longer than %i characters: checkpoint\n",
+				ckpt_stage, ckpt_root, MAXCHAR - 1);
+		return ERROR_FILE;
+	}
+	return OK;
+}
+
+// the name of an output file in the checkpoint directory
+static int set_ckpt_fname(char *fname, int out_ind) {
+	int len = snprintf(fname, MAXCHAR, "%s%i_%s", ckpt_dir, out_ind, ckpt_fnames[out_ind]);
+	if (len < 0 || len >= MAXCHAR) {
+		fprintf(fplog, "Checkpoint file name of %s in %s is longer than %i characters: checkpoint\n",
+				ckpt_fnames[out_ind], ckpt_dir, MAXCHAR - 1);
+		return ERROR_FILE;
+	}
+	return OK;
+}
+
+// add the content of a file to its hash
+static int hash_file_content(const char *fname, uint64_t *file_hash) {
+
+	FILE *fpin;
+	unsigned char buf[65536];
+	size_t num_read;
+
+	if ((fpin = fopen(fname, "rb")) == NULL) {
+		return ERROR_FILE;
+	}
+	while ((num_read = fread(buf, 1, sizeof(buf), fpin)) > 0) {
+		*file_hash = hash_bytes(*file_hash, buf, num_read);
+	}
+	if (ferror(fpin)) {
+		fclose(fpin);
+		return ERROR_FILE;
+	}
+	fclose(fpin);
+	return OK;
+}
+
+// copy a file with cp, as copy_to_destpath() does
+static int copy_file(const char *src, const char *dest) {
+
+	char sys_string[3 * MAXCHAR];
+
+	snprintf(sys_string, sizeof(sys_string), "cp -f '%s' '%s'", src, dest);
+	if (system(sys_string) != 0) {
+		fprintf(fplog, "Failed to copy %s to %s: checkpoint\n", src, dest);
+		return ERROR_COPY;
+	}
+	return OK;
+}
+
+int init_checkpoint(args_struct in_args, const char *stage_name) {
+
+	if (strcmp(in_args.checkpoint_path, NONE_TEXT) == 0) {
+		ckpt_on = 0;
+		ckpt_store = 0;
+		return OK;
+	}
+
+	init_checkpoint_key(stage_name);
+	ckpt_store = 1;
+	strcpy(ckpt_root, in_args.checkpoint_path);
+
+	return OK;}
+
+int init_checkpoint_key(const char *stage_name) {
+
+	ckpt_on = 1;
+	ckpt_store = 0;
+	ckpt_num_out = 0;
+	free(ckpt_paths);
+	free(ckpt_fnames);
+	ckpt_paths = NULL;
+	ckpt_fnames = NULL;
+
+	strncpy(ckpt_stage, stage_name, MAX_PROF_NAME - 1);
+	ckpt_stage[MAX_PROF_NAME - 1] = '\0';
+	ckpt_key = FNV_OFFSET;
+	hash_str(ckpt_stage);
+	hash_str(CHECKPOINT_VERSION);
+
+	return OK;}
+
+unsigned long long get_checkpoint_key(void) {
+	return (unsigned long long) ckpt_key;
+}
+
+int add_checkpoint_arg(const char *name, const char *value) {
+
+	if (!ckpt_on) {
+		return OK;
+	}
+	hash_str(name);
+	hash_str(value);
+
+	return OK;}
+
+int add_checkpoint_num(const char *name, double num) {
+
+	char value[50];
+
+	snprintf(value, sizeof(value), "%.17g", num);
+	return add_checkpoint_arg(name, value);}
+
+int add_checkpoint_dir(const char *path) {
+
+	DIR *dir;
+	struct dirent *dent;
+	struct stat fileinfo;
+	char fname[MAXCHAR];
+	uint64_t file_hash;
+	uint64_t dir_hash = 0;		// sum of the file hashes, so that the order of the directory entries does not matter
+	int64_t file_val;
+	int num_files = 0;
+
+	if (!ckpt_on) {
+		return OK;
+	}
+
+	if ((dir = opendir(path)) == NULL) {
+		fprintf(fplog, "Failed to open directory %s for the %s checkpoint: add_checkpoint_dir()\n", path, ckpt_stage);
+		return ERROR_FILE;
+	}
+	while ((dent = readdir(dir)) != NULL) {
+		// a file that is left out of the key could change without changing the key
+		if (snprintf(fname, MAXCHAR, "%s%s", path, dent->d_name) >= MAXCHAR) {
+			fprintf(fplog, "File name %s%s is longer than %i characters for the %s checkpoint: add_checkpoint_dir()\n",
+					path, dent->d_name, MAXCHAR - 1, ckpt_stage);
+			closedir(dir);
+			return ERROR_FILE;
+		}
+		if (stat(fname, &fileinfo) != 0 || !S_ISREG(fileinfo.st_mode)) {
+			continue;
+		}
+		file_hash = hash_bytes(FNV_OFFSET, dent->d_name, strlen(dent->d_name) + 1);
+		file_val = (int64_t) fileinfo.st_size;
+		file_hash = hash_bytes(file_hash, &file_val, sizeof(file_val));
+		file_val = (int64_t) fileinfo.st_ino;
+		file_hash = hash_bytes(file_hash, &file_val, sizeof(file_val));
+		file_val = (int64_t) fileinfo.st_mtim.tv_sec;
+		file_hash = hash_bytes(file_hash, &file_val, sizeof(file_val));
+		file_val = (int64_t) fileinfo.st_mtim.tv_nsec;
+		file_hash = hash_bytes(file_hash, &file_val, sizeof(file_val));
+		file_val = (int64_t) fileinfo.st_ctim.tv_sec;
+		file_hash = hash_bytes(file_hash, &file_val, sizeof(file_val));
+		file_val = (int64_t) fileinfo.st_ctim.tv_nsec;
+		file_hash = hash_bytes(file_hash, &file_val, sizeof(file_val));
+		if (fileinfo.st_size <= CHECKPOINT_DIGEST_BYTES && hash_file_content(fname, &file_hash) != OK) {
+			fprintf(fplog, "Failed to read file %s for the %s checkpoint: add_checkpoint_dir()\n", fname, ckpt_stage);
+			closedir(dir);
+			return ERROR_FILE;
+		}
+		dir_hash += file_hash;
+		num_files++;
+	}
+	closedir(dir);
+
+	hash_str(path);
+	ckpt_key = hash_bytes(ckpt_key, &dir_hash, sizeof(dir_hash));
+	ckpt_key = hash_bytes(ckpt_key, &num_files, sizeof(num_files));
+
+	return OK;}
+
+int add_checkpoint_output(const char *path, const char *fname) {
+
+	char (*new_paths)[MAXCHAR];
+	char (*new_fnames)[MAXCHAR];
+
+	if (!ckpt_on) {
+		return OK;
+	}
+
+	if ((new_paths = realloc(ckpt_paths, (ckpt_num_out + 1) * sizeof(*ckpt_paths))) != NULL) {
+		ckpt_paths = new_paths;
+	}
+	if ((new_fnames = realloc(ckpt_fnames, (ckpt_num_out + 1) * sizeof(*ckpt_fnames))) != NULL) {
+		ckpt_fnames = new_fnames;
+	}
+	if (new_paths == NULL || new_fnames == NULL) {
+		fprintf(fplog, "Failed to allocate memory for the %s checkpoint outputs: add_checkpoint_output()\n", ckpt_stage);
+		return ERROR_MEM;
+	}
+	strcpy(ckpt_paths[ckpt_num_out], path);
+	strcpy(ckpt_fnames[ckpt_num_out], fname);
+	ckpt_num_out++;
+	// the output names are part of the key
+	hash_str(fname);
+
+	return OK;}
+
+int restore_checkpoint(int *restored) {
+
+	int i;
+	int num_out = 0;
+	char fname[MAXCHAR];
+	char dest[MAXCHAR];
+	char rec_str[MAXRECSIZE];
+	FILE *fpin;
+
+	*restored = 0;
+	if (!ckpt_on || !ckpt_store) {
+		return OK;
+	}
+
+	if (set_ckpt_dir() != OK) {
+		return ERROR_FILE;
+	}
+
+	// only a checkpoint with a complete manifest is used
+	strcpy(fname, ckpt_dir);
+	strcat(fname, "manifest.txt");
+	if ((fpin = fopen(fname, "r")) == NULL) {
+		fprintf(fplog, "\nNo %s checkpoint in %s; processing the stage: restore_checkpoint()\n", ckpt_stage, ckpt_dir);
+		return OK;
+	}
+	while (fgets(rec_str, MAXRECSIZE, fpin) != NULL) {
+		if (rec_str[0] != '#') {
+			num_out++;
+		}
+	}
+	fclose(fpin);
+	if (num_out != ckpt_num_out) {
+		fprintf(fplog, "\nIncomplete %s checkpoint in %s; processing the stage: restore_checkpoint()\n", ckpt_stage, ckpt_dir);
+		return OK;
+	}
+
+	for (i = 0; i < ckpt_num_out; i++) {
+		if (set_ckpt_fname(fname, i) != OK) {
+			return ERROR_FILE;
+		}
+		if (snprintf(dest, MAXCHAR, "%s%s", ckpt_paths[i], ckpt_fnames[i]) >= MAXCHAR) {
+			fprintf(fplog, "Output file name %s%s is longer than %i characters: restore_checkpoint()\n",
+					ckpt_paths[i], ckpt_fnames[i], MAXCHAR - 1);
+			return ERROR_FILE;
+		}
+		if (copy_file(fname, dest) != OK) {
+			fprintf(fplog, "\nFailed to restore the %s checkpoint in %s; processing the stage: restore_checkpoint()\n",
+					ckpt_stage, ckpt_dir);
+			return OK;
+		}
+	}
+
+	fprintf(fplog, "\nRestored %i %s output files from checkpoint %s: restore_checkpoint()\n", ckpt_num_out, ckpt_stage, ckpt_dir);
+	*restored = 1;
+
+	return OK;}
+
+int save_checkpoint(void) {
+
+	int i;
+	char fname[MAXCHAR];
+	char src[MAXCHAR];
+	FILE *fpout;
+
+	if (!ckpt_on || !ckpt_store) {
+		return OK;
+	}
+
+	// the key may have changed since restore_checkpoint(), if the stage added input files
+	if (set_ckpt_dir() != OK) {
+		return ERROR_FILE;
+	}
+
+	// a partial checkpoint of an earlier run is replaced
+	if (make_dirs(ckpt_dir) != OK) {
+		fprintf(fplog, "Failed to create checkpoint directory %s: %s; the %s outputs are not saved: save_checkpoint()\n",
+				ckpt_dir, strerror(errno), ckpt_stage);
+		return OK;
+	}
+	strcpy(fname, ckpt_dir);
+	strcat(fname, "manifest.txt");
+	remove(fname);
+
+	for (i = 0; i < ckpt_num_out; i++) {
+		if (snprintf(src, MAXCHAR, "%s%s", ckpt_paths[i], ckpt_fnames[i]) >= MAXCHAR) {
+			fprintf(fplog, "Output file name %s%s is longer than %i characters: save_checkpoint()\n",
+					ckpt_paths[i], ckpt_fnames[i], MAXCHAR - 1);
+			return ERROR_FILE;
+		}
+		if (set_ckpt_fname(fname, i) != OK) {
+			return ERROR_FILE;
+		}
+		if (copy_file(src, fname) != OK) {
+			fprintf(fplog, "The %s outputs are not saved to checkpoint %s: save_checkpoint()\n", ckpt_stage, ckpt_dir);
+			return OK;
+		}
+	}
+
+	// the manifest marks the checkpoint as complete
+	strcpy(fname, ckpt_dir);
+	strcat(fname, "manifest.txt");
+	if ((fpout = fopen(fname, "w")) == NULL) {
+		fprintf(fplog, "Failed to open file %s for write; the %s outputs are not saved: save_checkpoint()\n", fname, ckpt_stage);
+		return OK;
+	}
+	fprintf(fpout, "# %s checkpoint written by %s at %s", ckpt_stage, CODENAME, get_systime());
+	for (i = 0; i < ckpt_num_out; i++) {
+		fprintf(fpout, "%i_%s\n", i, ckpt_fnames[i]);
+	}
+	fclose(fpout);
+
+	fprintf(fplog, "Saved %i %s output files to checkpoint %s: save_checkpoint()\n", ckpt_num_out, ckpt_stage, ckpt_dir);
+
+	return OK;}
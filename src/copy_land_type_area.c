@@ -0,0 +1,82 @@
+/**********
+ copy_land_type_area.c
+
+ copy the land type area table of one glu scenario to its lds destination directory
+    the land type area of every scenario is written in one pass with the last scenario (see proc_glu_scenario.c),
+    so the tables are copied after that pass, instead of by copy_to_destpath() at the end of each scenario
+ the table is copied in the table formats that were written
+ a copy fails if system() fails or cp exits with a non-zero status, e.g. when the table is missing
+
+ NOTE: this call automatically overwrites any file of the same name
+
+ arguments:
+ args_struct in_args: the input file arguments, with the output and destination paths of the scenario
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#include "moirai.h"
+#include <sys/wait.h>
+
+int copy_land_type_area(args_struct in_args) {
+
+    int err = OK;
+    char fname[MAXCHAR];            // full path to filename
+    char nc_fname[MAXCHAR];         // netcdf table file name
+    char sys_string[MAXCHAR];       // string to pass to system()
+
+    char cp_str[] = "cp -f ";
+    char space_str[] = " ";
+
+    if (in_args.table_format & TABLE_CSV) {
+        strcpy(fname, in_args.outpath);
+        strcat(fname, in_args.land_type_area_fname);
+        strcpy(sys_string, cp_str);
+        strcat(sys_string, fname);
+        strcat(sys_string, space_str);
+        strcat(sys_string, in_args.ldsdestpath);
+        if((err = system(sys_string)) == -1 || WEXITSTATUS(err) != 0) {
+            fprintf(fplog, "\nError copying file %s to %s\n", fname, in_args.ldsdestpath);
+            return ERROR_COPY;
+        }
+    }
+    if (in_args.table_format & TABLE_NC) {
+        get_nc_table_fname(nc_fname, in_args.land_type_area_fname);
+        strcpy(fname, in_args.outpath);
+        strcat(fname, nc_fname);
+        strcpy(sys_string, cp_str);
+        strcat(sys_string, fname);
+        strcat(sys_string, space_str);
+        strcat(sys_string, in_args.ldsdestpath);
+        if((err = system(sys_string)) == -1 || WEXITSTATUS(err) != 0) {
+            fprintf(fplog, "\nError copying file %s to %s\n", fname, in_args.ldsdestpath);
+            return ERROR_COPY;
+        }
+    }
+
+    return OK;}
@@ -10,6 +10,9 @@
  the names of these files are set in the lds_input.txt file
  
  NOTE: this call automatically overwrites any file of the same name
+ a copy fails if system() fails or cp exits with a non-zero status, e.g. when the output file is missing
+ 
+ the land type area table is copied by copy_land_type_area(), after the land type area of every glu scenario is written
  
  there are currenlty 9, and there will be one more
  
@@ -47,11 +50,13 @@
  **********/
 
 #include "moirai.h"
+#include <sys/wait.h>
 
 int copy_to_destpath(args_struct in_args) {
     
     int err = OK;
     char fname[MAXCHAR];            // full path to filename
+    char nc_fname[MAXCHAR];         // netcdf table file name
     char sys_string[MAXCHAR];       // string to pass to system()
     
     char cp_str[] = "cp -f ";
@@ -64,7 +69,7 @@ int copy_to_destpath(args_struct in_args) {
     strcat(sys_string, fname);
     strcat(sys_string, space_str);
     strcat(sys_string, in_args.ldsdestpath);
-    if((err = system(sys_string)) == -1) {
+    if((err = system(sys_string)) == -1 || WEXITSTATUS(err) != 0) {
         fprintf(fplog, "\nError copying file %s to %s\n", fname, in_args.ldsdestpath);
         return ERROR_COPY;
     }
@@ -76,7 +81,7 @@ int copy_to_destpath(args_struct in_args) {
     strcat(sys_string, fname);
     strcat(sys_string, space_str);
     strcat(sys_string, in_args.ldsdestpath);
-    if((err = system(sys_string)) == -1) {
+    if((err = system(sys_string)) == -1 || WEXITSTATUS(err) != 0) {
         fprintf(fplog, "\nError copying file %s to %s\n", fname, in_args.ldsdestpath);
         return ERROR_COPY;
     }
@@ -88,7 +93,7 @@ int copy_to_destpath(args_struct in_args) {
     strcat(sys_string, fname);
     strcat(sys_string, space_str);
     strcat(sys_string, in_args.ldsdestpath);
-    if((err = system(sys_string)) == -1) {
+    if((err = system(sys_string)) == -1 || WEXITSTATUS(err) != 0) {
         fprintf(fplog, "\nError copying file %s to %s\n", fname, in_args.ldsdestpath);
         return ERROR_COPY;
     }
@@ -100,7 +105,7 @@ int copy_to_destpath(args_struct in_args) {
     strcat(sys_string, fname);
     strcat(sys_string, space_str);
     strcat(sys_string, in_args.ldsdestpath);
-    if((err = system(sys_string)) == -1) {
+    if((err = system(sys_string)) == -1 || WEXITSTATUS(err) != 0) {
         fprintf(fplog, "\nError copying file %s to %s\n", fname, in_args.ldsdestpath);
         return ERROR_COPY;
     }
@@ -112,33 +117,36 @@ int copy_to_destpath(args_struct in_args) {
     strcat(sys_string, fname);
     strcat(sys_string, space_str);
     strcat(sys_string, in_args.ldsdestpath);
-    if((err = system(sys_string)) == -1) {
+    if((err = system(sys_string)) == -1 || WEXITSTATUS(err) != 0) {
         fprintf(fplog, "\nError copying file %s to %s\n", fname, in_args.ldsdestpath);
         return ERROR_COPY;
     }
     
-    // land type area
-    strcpy(fname, in_args.outpath);
-    strcat(fname, in_args.land_type_area_fname);
-    strcpy(sys_string, cp_str);
-    strcat(sys_string, fname);
-    strcat(sys_string, space_str);
-    strcat(sys_string, in_args.ldsdestpath);
-    if((err = system(sys_string)) == -1) {
-        fprintf(fplog, "\nError copying file %s to %s\n", fname, in_args.ldsdestpath);
-        return ERROR_COPY;
+    // reference vegetation carbon, in the table formats that were written
+    if (in_args.table_format & TABLE_CSV) {
+        strcpy(fname, in_args.outpath);
+        strcat(fname, in_args.refveg_carbon_fname);
+        strcpy(sys_string, cp_str);
+        strcat(sys_string, fname);
+        strcat(sys_string, space_str);
+        strcat(sys_string, in_args.ldsdestpath);
+        if((err = system(sys_string)) == -1 || WEXITSTATUS(err) != 0) {
+            fprintf(fplog, "\nError copying file %s to %s\n", fname, in_args.ldsdestpath);
+            return ERROR_COPY;
+        }
     }
-    
-    // reference vegetation carbon
-    strcpy(fname, in_args.outpath);
-    strcat(fname, in_args.refveg_carbon_fname);
-    strcpy(sys_string, cp_str);
-    strcat(sys_string, fname);
-    strcat(sys_string, space_str);
-    strcat(sys_string, in_args.ldsdestpath);
-    if((err = system(sys_string)) == -1) {
-        fprintf(fplog, "\nError copying file %s to %s\n", fname, in_args.ldsdestpath);
-        return ERROR_COPY;
+    if (in_args.table_format & TABLE_NC) {
+        get_nc_table_fname(nc_fname, in_args.refveg_carbon_fname);
+        strcpy(fname, in_args.outpath);
+        strcat(fname, nc_fname);
+        strcpy(sys_string, cp_str);
+        strcat(sys_string, fname);
+        strcat(sys_string, space_str);
+        strcat(sys_string, in_args.ldsdestpath);
+        if((err = system(sys_string)) == -1 || WEXITSTATUS(err) != 0) {
+            fprintf(fplog, "\nError copying file %s to %s\n", fname, in_args.ldsdestpath);
+            return ERROR_COPY;
+        }
     }
     
     // water footprint file
@@ -148,7 +156,7 @@ int copy_to_destpath(args_struct in_args) {
     strcat(sys_string, fname);
     strcat(sys_string, space_str);
     strcat(sys_string, in_args.ldsdestpath);
-    if((err = system(sys_string)) == -1) {
+    if((err = system(sys_string)) == -1 || WEXITSTATUS(err) != 0) {
         fprintf(fplog, "\nError copying file %s to %s\n", fname, in_args.ldsdestpath);
         return ERROR_COPY;
     }
@@ -160,7 +168,7 @@ int copy_to_destpath(args_struct in_args) {
     strcat(sys_string, fname);
     strcat(sys_string, space_str);
     strcat(sys_string, in_args.mapdestpath);
-    if((err = system(sys_string)) == -1) {
+    if((err = system(sys_string)) == -1 || WEXITSTATUS(err) != 0) {
         fprintf(fplog, "\nError copying file %s to %s\n", fname, in_args.mapdestpath);
         return ERROR_COPY;
     }
@@ -172,7 +180,7 @@ int copy_to_destpath(args_struct in_args) {
     strcat(sys_string, fname);
     strcat(sys_string, space_str);
     strcat(sys_string, in_args.mapdestpath);
-    if((err = system(sys_string)) == -1) {
+    if((err = system(sys_string)) == -1 || WEXITSTATUS(err) != 0) {
         fprintf(fplog, "\nError copying file %s to %s\n", fname, in_args.mapdestpath);
         return ERROR_COPY;
     }
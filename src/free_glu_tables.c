@@ -0,0 +1,284 @@
+/**********
+ free_glu_tables.c
+
+ free the tables that proc_glu_scenario() reads and calculates for one glu scenario
+    these are the info arrays of the read_*_info() functions, the glu lists and index maps of write_glu_mapping(),
+    the per-scenario rasters and masks, the carbon arrays, and the crop and land rent outputs of proc_crop_rent()
+ the fao tables and the original land rent are read with the first glu scenario, so they are freed only with all = 1
+ this is called at the end of each glu scenario, and when the run ends (see moirai_ctx.c), also after a failed stage,
+    so every pointer is checked and then set to NULL; the rows of a partly allocated table are NULL
+ the glu raster and the country+glu lists are held in glu_scen after write_glu_mapping(), and are then only set to NULL here
+ call this before free_lt_tally(&refveg_carbon_tally), which resets the number of carbon array slots
+
+ arguments:
+ int all:	1 = also free the fao tables and the original land rent; 0 = keep them for the next glu scenario
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#include "moirai.h"
+
+// free a list of num_rows names; rows that were not allocated are NULL
+static void free_names(char ***names, int num_rows) {
+
+	int i;
+
+	if (*names != NULL) {
+		for (i = 0; i < num_rows; i++) {
+			free((*names)[i]);
+		}
+		free(*names);
+		*names = NULL;
+	}
+}
+
+// free an int table of num_rows rows; rows that were not allocated are NULL
+static void free_int_rows(int ***rows, int num_rows) {
+
+	int i;
+
+	if (*rows != NULL) {
+		for (i = 0; i < num_rows; i++) {
+			free((*rows)[i]);
+		}
+		free(*rows);
+		*rows = NULL;
+	}
+}
+
+// free a float table of num_rows x row_len[i] rows; the row lengths may be gone only if no row was allocated
+static void free_float_table(float ****table, int num_rows, const int *row_len) {
+
+	int i, j;
+
+	if (*table != NULL) {
+		for (i = 0; i < num_rows; i++) {
+			if ((*table)[i] != NULL) {
+				for (j = 0; j < row_len[i]; j++) {
+					free((*table)[i][j]);
+				}
+				free((*table)[i]);
+			}
+		}
+		free(*table);
+		*table = NULL;
+	}
+}
+
+// free a carbon array; it has one more slot than the carbon keys, and NUM_CARBON rows in each slot
+static void free_carbon_array(float ****carbon) {
+
+	int i, j;
+
+	if (*carbon != NULL) {
+		for (i = 0; i <= refveg_carbon_tally.num_slots; i++) {
+			if ((*carbon)[i] != NULL) {
+				for (j = 0; j < NUM_CARBON; j++) {
+					free((*carbon)[i][j]);
+				}
+				free((*carbon)[i]);
+			}
+		}
+		free(*carbon);
+		*carbon = NULL;
+	}
+}
+
+// 1 if a glu scenario holds the pointer
+static int held_in_glu_scen(const void *ptr) {
+
+	int scen_ind;
+
+	if (glu_scen == NULL) {
+		return 0;
+	}
+	for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+		if (ptr == glu_scen[scen_ind].aez_bounds || ptr == glu_scen[scen_ind].ctry_aez_num ||
+			ptr == glu_scen[scen_ind].ctry_aez_list) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+void free_glu_tables(int all) {
+
+	int i;
+
+	// the crop and land rent outputs; these use the glu counts, which are freed below
+	free_float_table(&harvestarea_crop_aez, NUM_FAO_CTRY, ctry_aez_num);
+	free_float_table(&production_crop_aez, NUM_FAO_CTRY, ctry_aez_num);
+	if (pasturearea_aez != NULL) {
+		for (i = 0; i < NUM_FAO_CTRY; i++) {
+			free(pasturearea_aez[i]);
+		}
+		free(pasturearea_aez);
+		pasturearea_aez = NULL;
+	}
+	free_float_table(&rent_use_aez, NUM_GTAP_CTRY87, reglr_aez_num);
+	free(harvestarea_in);
+	harvestarea_in = NULL;
+	free(yield_in);
+	yield_in = NULL;
+	if (all) {
+		free(yield_fao);
+		yield_fao = NULL;
+		free(harvestarea_fao);
+		harvestarea_fao = NULL;
+		free(production_fao);
+		production_fao = NULL;
+		free(prodprice_fao_reglr);
+		prodprice_fao_reglr = NULL;
+		free(rent_orig_aez);
+		rent_orig_aez = NULL;
+	}
+
+	// the carbon arrays
+	free_carbon_array(&soil_carbon_array);
+	free_carbon_array(&veg_carbon_array);
+	free(soil_carbon_array_cells);
+	soil_carbon_array_cells = NULL;
+
+	// the per-scenario rasters and masks
+	// the glu raster and the country+glu lists are freed with glu_scen once they are held there
+	if (!held_in_glu_scen(aez_bounds_new)) {
+		free(aez_bounds_new);
+	}
+	aez_bounds_new = NULL;
+	free(region_gcam);
+	region_gcam = NULL;
+	free(sage_minus_hyde_land_area);
+	sage_minus_hyde_land_area = NULL;
+	free(glacier_water_area_hyde);
+	glacier_water_area_hyde = NULL;
+	free(country87_gtap);
+	country87_gtap = NULL;
+	free(missing_aez_mask);
+	missing_aez_mask = NULL;
+	free(land_mask_ctryaez);
+	land_mask_ctryaez = NULL;
+	free(land_mask_aez_orig);
+	land_mask_aez_orig = NULL;
+	free(land_mask_aez_new);
+	land_mask_aez_new = NULL;
+	free(land_mask_sage);
+	land_mask_sage = NULL;
+	free(land_mask_hyde);
+	land_mask_hyde = NULL;
+	free(land_mask_fao);
+	land_mask_fao = NULL;
+	free(land_mask_potveg);
+	land_mask_potveg = NULL;
+	free(land_cells_aez_new);
+	land_cells_aez_new = NULL;
+	free(land_cells_sage);
+	land_cells_sage = NULL;
+	free(land_cells_hyde);
+	land_cells_hyde = NULL;
+	free(twn_glu_area);
+	twn_glu_area = NULL;
+	free(hkg_glu_area);
+	hkg_glu_area = NULL;
+
+	// the glu lists and index maps of write_glu_mapping()
+	free(lt_cats);
+	lt_cats = NULL;
+	free_int_rows(&ctry_aez_reglr_ind, NUM_FAO_CTRY);
+	free_int_rows(&ctry_aez_reggcam_ind, NUM_FAO_CTRY);
+	free_int_rows(&reglr_aez_list, NUM_GTAP_CTRY87);
+	free(reglr_aez_num);
+	reglr_aez_num = NULL;
+	free_int_rows(&reggcam_aez_list, NUM_GCAM_RGN);
+	free(reggcam_aez_num);
+	reggcam_aez_num = NULL;
+	if (!held_in_glu_scen(ctry_aez_list)) {
+		free_int_rows(&ctry_aez_list, NUM_FAO_CTRY);
+	}
+	ctry_aez_list = NULL;
+	if (!held_in_glu_scen(ctry_aez_num)) {
+		free(ctry_aez_num);
+	}
+	ctry_aez_num = NULL;
+	free(ctry2reglr_ind);
+	ctry2reglr_ind = NULL;
+	free(ctry2reggcam_ind);
+	ctry2reggcam_ind = NULL;
+	free(ctry87_code2ind);
+	ctry87_code2ind = NULL;
+	free(aez_code2ind_new);
+	aez_code2ind_new = NULL;
+
+	// the info arrays of the read_*_info() functions
+	free(countrycodes_fao);
+	countrycodes_fao = NULL;
+	free_names(&countryabbrs_iso, NUM_FAO_CTRY);
+	free_names(&countrynames_fao, NUM_FAO_CTRY);
+	free(ctry2ctry87codes_gtap);
+	ctry2ctry87codes_gtap = NULL;
+	free_names(&ctry2ctry87abbrs_gtap, NUM_FAO_CTRY);
+	free(country87codes_gtap);
+	country87codes_gtap = NULL;
+	free_names(&country87names_gtap, NUM_GTAP_CTRY87);
+	free_names(&country87abbrs_gtap, NUM_GTAP_CTRY87);
+	// the gcam region arrays are allocated with the ctry87 length
+	free(regioncodes_gcam);
+	regioncodes_gcam = NULL;
+	free_names(&regionnames_gcam, NUM_GTAP_CTRY87);
+	free(ctry2regioncodes_gcam);
+	ctry2regioncodes_gcam = NULL;
+	free(country_gcamiso2regioncodes_gcam);
+	country_gcamiso2regioncodes_gcam = NULL;
+	free_names(&countryabbrs_gcam_iso, NUM_GCAM_ISO_CTRY);
+	free(aez_codes_new);
+	aez_codes_new = NULL;
+	free_names(&aez_names_new, NUM_NEW_AEZ);
+	free(usecodes_gtap);
+	usecodes_gtap = NULL;
+	free_names(&usenames_gtap, NUM_GTAP_USE);
+	free_names(&usedescr_gtap, NUM_GTAP_USE);
+	free(landtypecodes_sage);
+	landtypecodes_sage = NULL;
+	free_names(&landtypenames_sage, NUM_SAGE_PVLT);
+	free(cropcodes_sage);
+	cropcodes_sage = NULL;
+	free(crop_sage2gtap_use);
+	crop_sage2gtap_use = NULL;
+	free(cropcodes_sage2fao);
+	cropcodes_sage2fao = NULL;
+	free_names(&cropnames_gtap, NUM_SAGE_CROP);
+	free_names(&cropdescr_sage, NUM_SAGE_CROP);
+	free_names(&cropfilebase_sage, NUM_SAGE_CROP);
+	free_names(&cropnames_sage2fao, NUM_SAGE_CROP);
+	free(lutypecodes_hyde);
+	lutypecodes_hyde = NULL;
+	free_names(&lutypenames_hyde, NUM_HYDE_TYPES);
+	free(lulccodes);
+	lulccodes = NULL;
+	free_names(&lulcnames, NUM_LULC_TYPES);
+	free(lulc2sagecodes);
+	lulc2sagecodes = NULL;
+	free(lulc2hydecodes);
+	lulc2hydecodes = NULL;
+}
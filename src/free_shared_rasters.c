@@ -0,0 +1,112 @@
+/**********
+ free_shared_rasters.c
+
+ free the rasters that do not depend on the glus, which proc_glu_scenario() reads and calculates with the first glu scenario
+    these are the cell area, land area, original aez, potveg, country, lulc land mask, protected area, carbon,
+    and sage cropland rasters, and the reference year areas, thematic grids, forest cells, and random cell order
+ this is called when the run ends (see moirai_ctx.c), also after a failed stage, so the pointers are set to NULL
+    serve mode calls it only when the next request changes the inputs of these rasters (see serve_stages.c)
+
+ arguments:
+ rinfo_struct raster_info: information about input raster data; lulc_input_ncells is the length of rand_order
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#include "moirai.h"
+
+// free a raster array of num_rows rows; rows that were not allocated are NULL
+static void free_rows(float ***rows, int num_rows) {
+
+	int i;
+
+	if (*rows != NULL) {
+		for (i = 0; i < num_rows; i++) {
+			free((*rows)[i]);
+		}
+		free(*rows);
+		*rows = NULL;
+	}
+}
+
+void free_shared_rasters(rinfo_struct raster_info) {
+
+	free(cell_area_row);
+	cell_area_row = NULL;
+	free(cell_area_hyde_row);
+	cell_area_hyde_row = NULL;
+	free(cell_area_hyde_valid);
+	cell_area_hyde_valid = NULL;
+	free(cell_area_hyde);
+	cell_area_hyde = NULL;
+	free(land_area_sage);
+	land_area_sage = NULL;
+	free(land_area_hyde);
+	land_area_hyde = NULL;
+	free(aez_bounds_orig);
+	aez_bounds_orig = NULL;
+	free(potveg_thematic);
+	potveg_thematic = NULL;
+	free(country_fao);
+	country_fao = NULL;
+	free(cropland_area_sage);
+	cropland_area_sage = NULL;
+
+	// the reference year areas
+	free(cropland_area);
+	cropland_area = NULL;
+	free(pasture_area);
+	pasture_area = NULL;
+	free(urban_area);
+	urban_area = NULL;
+	free_rows(&lu_detail_area, NUM_HYDE_TYPES - NUM_HYDE_TYPES_MAIN);
+	free(refveg_area);
+	refveg_area = NULL;
+	free(refcarbon_area);
+	refcarbon_area = NULL;
+	free(refveg_thematic);
+	refveg_thematic = NULL;
+	free(refvegcarbon_thematic);
+	refvegcarbon_thematic = NULL;
+	free_rows(&lulc_input_grid, NUM_LULC_TYPES);
+	free_rows(&rand_order, raster_info.lulc_input_ncells);
+	free(forest_cells);
+	forest_cells = NULL;
+	num_forest_cells = 0;
+	// the reference year land masks are freed after calc_refcarbon_area(), unless it failed
+	free(land_mask_lulc);
+	land_mask_lulc = NULL;
+	free(land_mask_refveg);
+	land_mask_refveg = NULL;
+	free(land_mask_forest);
+	land_mask_forest = NULL;
+
+	// the protected area and carbon rasters
+	free_rows(&protected_EPA, NUM_EPA_PROTECTED);
+	free_rows(&soil_carbon_sage, NUM_CARBON);
+	free_rows(&veg_carbon_sage, NUM_CARBON);
+	free_rows(&above_ground_ratio, NUM_CARBON);
+	free_rows(&below_ground_ratio, NUM_CARBON);
+}
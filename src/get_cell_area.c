@@ -1,7 +1,9 @@
 /**********
  get_cell_area.c
 
- calculate the spherical earth grid cell area for all cells and store it in cell_area[NUM_CELLS] (km^2)
+ calculate the spherical earth grid cell area for each row of the working grid and store it in cell_area_row[NUM_LAT] (km^2)
+    the working grid is a regular lat-lon grid, so all cells of a row have the same area
+    use cell_area_at() in moirai.h to get the area of a cell
  
  This is the area of the surface of a sphere delineated by the lat/lon values given
  from integral r^2.cos(lat).dlat.dlon; lat from -pi/2 to pi/2, lon from 0 to 2pi
@@ -18,7 +20,11 @@
  with an unlikely maximum of .67% in the case where r1 and r2 are the axes of the spheroid
  This is based on spherical comparisons of area at the different radii, assuming similar curvature to the spheroid
  
- also read the cell area for the hyde data into cell_area_hyde[NUM_CELLS]
+ also read the cell area for the hyde data and store it per row in cell_area_hyde_row[NUM_LAT]
+    the hyde cell area is nodata outside of the hyde land cells, so these cells are marked in the bit mask cell_area_hyde_valid
+    if the valid hyde cell area varies along a row, the whole raster is kept in cell_area_hyde[NUM_CELLS] instead
+    use cell_area_hyde_at() in moirai.h to get the hyde area of a cell
+ the full cell area rasters are made only for the diagnostic output
  
  arguments:
  args_struct in_args: the input file arguments
@@ -69,12 +75,12 @@ int get_cell_area(args_struct in_args, rinfo_struct *raster_info) {
 	// working units are km^2
 	
 	int i;
-	int nrows = 2160;				// num input lats
-	int ncols = 4320;				// num input lons
+	int nrows = raster_info->grid_nrows;	// num input lats
+	int ncols = raster_info->grid_ncols;	// num input lons
 	int ncells = nrows * ncols;		// number of input grid cells
 	float nodata = -9999;			// nodata value
     int insize = 4;                 // 4 byte float
-	double res = 5.0 / 60.0;		// resolution
+	double res = raster_info->grid_res;	// resolution
 	double xmin = -180.0;			// longitude min grid boundary
 	double xmax = 180.0;			// longitude max grid boundary
 	double ymin = -90.0;			// latitude min grid boundary
@@ -82,10 +88,13 @@ int get_cell_area(args_struct in_args, rinfo_struct *raster_info) {
 	
 	int rowind, colind;				// keep track of which cell
 	double dlon, conv, lat1, lat2;	// temporary values for calculating cell area
+	raster_view_struct hyde_view;	// the mapped hyde cell area file
+	const float *hyde_raster;		// the hyde cell area as read
+	float *out_raster;				// full raster for diagnostic output
 	
 	char fname[MAXCHAR];			// file name to open
-	FILE *fpin;						// file pointer
     int num_read;					// how many values read in
+    int num_nodata;					// number of hyde cells without a valid cell area
 	
 	int err = OK;							// store error code from the write file
 	char out_name[] = "cell_area.bil";		// diagnostic output raster file name
@@ -117,31 +126,69 @@ int get_cell_area(args_struct in_args, rinfo_struct *raster_info) {
 	strcpy(fname, in_args.inpath);
 	strcat(fname, in_args.cell_area_fname);
 	
-    if((fpin = fopen(fname, "rb")) == NULL)
+    // map the data
+    if(open_raster_view(fname, insize, ncells, &hyde_view, &num_read) != OK)
     {
         fprintf(fplog,"Failed to open file %s:  get_cell_area()\n", fname);
         return ERROR_FILE;
     }
-    
-    // read the data
-    num_read = (int) fread(cell_area_hyde, insize, ncells, fpin);
-    fclose(fpin);
     if(num_read != ncells)
     {
         fprintf(fplog, "Error reading file %s: get_cell_area(); num_read=%i != ncells=%i\n",
                 fname, num_read, ncells);
+        close_raster_view(&hyde_view);
         return ERROR_FILE;
     }
+    hyde_raster = raster_view_float(&hyde_view);
+    
+    // store the hyde cell area per row, unless it varies along a row
+    // the hyde cell area is valid only in the hyde land cells, so the valid cells are kept in a bit mask
+    cell_area_hyde = NULL;
+    cell_area_hyde_valid = calloc(ncells / 8 + 1, sizeof(unsigned char));
+    if(cell_area_hyde_valid == NULL) {
+        fprintf(fplog,"Failed to allocate memory for cell_area_hyde_valid:  get_cell_area()\n");
+        close_raster_view(&hyde_view);
+        return ERROR_MEM;
+    }
+    num_nodata = 0;
+    for (rowind = 0; rowind < nrows && cell_area_hyde == NULL; rowind++) {
+        cell_area_hyde_row[rowind] = NODATA;
+        for (colind = 0; colind < ncols; colind++) {
+            i = rowind * ncols + colind;
+            if (hyde_raster[i] == nodata) {
+                num_nodata++;
+                continue;
+            }
+            cell_area_hyde_valid[i / 8] |= (unsigned char) (1 << (i % 8));
+            if (cell_area_hyde_row[rowind] == NODATA) {
+                cell_area_hyde_row[rowind] = hyde_raster[i];
+            } else if (hyde_raster[i] != cell_area_hyde_row[rowind]) {
+                fprintf(fplog, "Warning: hyde cell area in %s varies along row %i; keeping the full raster: get_cell_area()\n",
+                        fname, rowind);
+                cell_area_hyde = malloc((size_t) ncells * sizeof(float));
+                if(cell_area_hyde == NULL) {
+                    fprintf(fplog,"Failed to allocate memory for cell_area_hyde:  get_cell_area()\n");
+                    close_raster_view(&hyde_view);
+                    return ERROR_MEM;
+                }
+                memcpy(cell_area_hyde, hyde_raster, (size_t) ncells * sizeof(float));
+                break;
+            }
+        }
+    }
+    if (cell_area_hyde != NULL || num_nodata == 0) {
+        free(cell_area_hyde_valid);
+        cell_area_hyde_valid = NULL;
+    }
+    close_raster_view(&hyde_view);
     
-	// calculate the grid cell area
-	for (i = 0; i < ncells; i++) {
+	// calculate the grid cell area of each row
+	for (rowind = 0; rowind < nrows; rowind++) {
          
-		// first get the lat boundaries and lon diff of the cell, in arc-seconds
-		rowind = (int) (i / ncols);
-		colind = i - rowind * ncols;
-		lat1 = 90 * DEG2SEC - rowind * GRID_RES_SEC;
-		lat2 = lat1 - GRID_RES_SEC;
-		dlon = GRID_RES_SEC;
+		// first get the lat boundaries and lon diff of the cells, in arc-seconds
+		lat1 = 90 * DEG2SEC - rowind * raster_info->grid_res_sec;
+		lat2 = lat1 - raster_info->grid_res_sec;
+		dlon = raster_info->grid_res_sec;
 		conv = DEG2RAD * SEC2DEG;
 		
 		// check for pole straddle
@@ -152,19 +199,31 @@ int get_cell_area(args_struct in_args, rinfo_struct *raster_info) {
 			return ERROR_CALC;
 		}
 
-		cell_area[i] = MSQ2KMSQ * AVE_ER * AVE_ER * dlon * conv * fabs(sin(lat2 * conv) - sin(lat1 * conv));
+		cell_area_row[rowind] = MSQ2KMSQ * AVE_ER * AVE_ER * dlon * conv * fabs(sin(lat2 * conv) - sin(lat1 * conv));
 		
-	}	// end for i loop to read and calculate the data
+	}	// end for rowind loop to calculate the data
 	
 	if (in_args.diagnostics) {
-		if ((err = write_raster_float(cell_area, ncells, out_name, in_args))) {
+		out_raster = calloc(ncells, sizeof(float));
+		if(out_raster == NULL) {
+			fprintf(fplog,"Failed to allocate memory for out_raster:  get_cell_area()\n");
+			return ERROR_MEM;
+		}
+		for (i = 0; i < ncells; i++) {
+			out_raster[i] = cell_area_at(i);
+		}
+		if ((err = write_raster_float(out_raster, ncells, out_name, in_args))) {
 			fprintf(fplog, "Error writing file %s: get_cell_area()\n", out_name);
 			return err;
 		}
-		if ((err = write_raster_float(cell_area_hyde, ncells, out_name_hyde, in_args))) {
+		for (i = 0; i < ncells; i++) {
+			out_raster[i] = cell_area_hyde_at(i);
+		}
+		if ((err = write_raster_float(out_raster, ncells, out_name_hyde, in_args))) {
 			fprintf(fplog, "Error writing hyde file %s: get_cell_area()\n", out_name_hyde);
 			return err;
 		}
+		free(out_raster);
 	}
 	
 	return OK;}
@@ -8,8 +8,14 @@
  this function assumes a specific order for the input values
  all blank and commented lines are ignored
  
+ overrides replace the values of some records: a blank separated list of name=value pairs, e.g. diagnostics=1 outpath=./test/
+    the names are the args_struct field names in in_arg_names below, which are also in the input file comments
+    the values are set as if they were in the input file; an unknown name is a usage error
+    the values can come from a serve mode socket client, so they may contain only letters, digits, and OVERRIDE_PUNCT
+ 
  arguments:
  char *fname:			the name of the input file, with path
+ char *overrides:		the name=value overrides; NULL or empty = none
  args_struct *in_args:	pointer to the in_args structure
 
  return value:
@@ -44,7 +50,103 @@
 
 #include "moirai.h"
 
-int get_in_args(const char *fname, args_struct *in_args) {
+// the input argument names, in record order; these name the overrides
+static const char *in_arg_names[NUM_IN_ARGS] = {
+	"diagnostics", "out_year_prod_ha_lr", "in_year_sage_crops", "out_year_usd", "in_year_lr_usd",
+	"lulc_out_year", "inpath", "outpath", "sagepath", "hydepath", "lulcpath", "mircapath", "wfpath",
+	"ldsdestpath", "mapdestpath", "cell_area_fname", "land_area_sage_fname", "land_area_hyde_fname",
+	"aez_new_fname", "aez_orig_fname", "potveg_fname", "country_fao_fname", "L1_fname", "L2_fname", "L3_fname",
+	"L4_fname", "ALL_IUCN_fname", "IUCN_1a_1b_2_fname", "nfert_rast_fname", "cropland_sage_fname",
+	"soil_carbon_wavg_fname", "soil_carbon_min_fname", "soil_carbon_median_fname", "soil_carbon_max_fname",
+	"soil_carbon_q1_fname", "soil_carbon_q3_fname", "veg_carbon_wavg_fname", "veg_carbon_min_fname",
+	"veg_carbon_median_fname", "veg_carbon_max_fname", "veg_carbon_q1_fname", "veg_carbon_q3_fname",
+	"veg_BG_wavg_fname", "veg_BG_median_fname", "veg_BG_min_fname", "veg_BG_max_fname", "veg_BG_q1_fname",
+	"veg_BG_q3_fname", "rent_orig_fname", "country87_gtap_fname", "country87map_fao_fname", "country_all_fname",
+	"aez_new_info_fname", "countrymap_iso_gcam_region_fname", "regionlist_gcam_fname", "use_gtap_fname",
+	"lt_sage_fname", "lu_hyde_fname", "lulc_fname", "crop_fname", "production_fao_fname", "yield_fao_fname",
+	"harvestarea_fao_fname", "prodprice_fao_fname", "convert_usd_fname", "lds_logname", "harvestarea_fname",
+	"production_fname", "rent_fname", "mirca_irr_fname", "mirca_rfd_fname", "land_type_area_fname",
+	"refveg_carbon_fname", "wf_fname", "iso_map_fname", "lt_map_fname", "trace_fname", "grid_res_sec",
+	"lulc_res_sec", "band_lulc_rows", "region_subset", "hyde_years", "glu_batch_fname", "cell_store_fname",
+	"checkpoint_path", "table_format"
+};
+
+// the characters allowed in an override value
+#define OVERRIDE_PUNCT	"._-/,:+~"
+#define OVERRIDE_CHARS	"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789" OVERRIDE_PUNCT
+
+// find the override value of a record; returns 1 and sets value if the name is in the overrides
+static int get_override(const char *overrides, const char *name, char *value) {
+
+	char over_str[MAXRECSIZE];
+	char *tok, *eq;
+	int found = 0;
+
+	strcpy(over_str, overrides);
+	// a later pair for the same name wins
+	for (tok = strtok(over_str, " \t"); tok != NULL; tok = strtok(NULL, " \t")) {
+		if ((eq = strchr(tok, '=')) != NULL && (size_t) (eq - tok) == strlen(name) && strncmp(tok, name, eq - tok) == 0) {
+			strcpy(value, eq + 1);
+			found = 1;
+		}
+	}
+	return found;
+}
+
+// check that every override is a name=value pair with a known name
+static int check_overrides(const char *overrides) {
+
+	char over_str[MAXRECSIZE];
+	char *tok, *eq;
+	int i;
+
+	strcpy(over_str, overrides);
+	for (tok = strtok(over_str, " \t"); tok != NULL; tok = strtok(NULL, " \t")) {
+		if ((eq = strchr(tok, '=')) == NULL) {
+			fprintf(stderr, "Invalid input override %s; use name=value: get_in_args()\n", tok);
+			return ERROR_USAGE;
+		}
+		*eq = '\0';
+		for (i = 0; i < NUM_IN_ARGS; i++) {
+			if (strcmp(tok, in_arg_names[i]) == 0) {
+				break;
+			}
+		}
+		if (i == NUM_IN_ARGS) {
+			fprintf(stderr, "Unknown input override %s: get_in_args()\n", tok);
+			return ERROR_USAGE;
+		}
+		// the paths and file names go into the cp commands of the output copies, so no shell characters are allowed
+		if (eq[1 + strspn(eq + 1, OVERRIDE_CHARS)] != '\0') {
+			fprintf(stderr, "Invalid input override %s value %s; use only letters, digits, and %s: get_in_args()\n",
+					tok, eq + 1, OVERRIDE_PUNCT);
+			return ERROR_USAGE;
+		}
+	}
+	return OK;
+}
+
+// parse the table_format value: a comma separated list of TABLE_CSV_TEXT and TABLE_NC_TEXT; returns the TABLE_* flags, 0 if invalid
+static int parse_table_format(const char *fld_str) {
+
+	int format = 0;
+	char format_str[MAXRECSIZE];
+	char *tok;
+
+	strcpy(format_str, fld_str);
+	for (tok = strtok(format_str, ","); tok != NULL; tok = strtok(NULL, ",")) {
+		if (strcmp(tok, TABLE_CSV_TEXT) == 0) {
+			format |= TABLE_CSV;
+		} else if (strcmp(tok, TABLE_NC_TEXT) == 0) {
+			format |= TABLE_NC;
+		} else {
+			return 0;
+		}
+	}
+	return format;
+}
+
+int get_in_args(const char *fname, const char *overrides, args_struct *in_args) {
 	
 	int length;						// length of input value string
 	int nrecords = NUM_IN_ARGS;		// number of input variables in file
@@ -55,6 +157,14 @@ int get_in_args(const char *fname, args_struct *in_args) {
 	char fld_str[MAXRECSIZE];		// whitespace removed input value
 	const char comment[] = "#";		// character that denotes a comment to disregard rest of line
 	
+	if (overrides == NULL) {
+		overrides = "";
+	}
+	if (strlen(overrides) >= MAXRECSIZE || check_overrides(overrides) != OK) {
+		fprintf(stderr, "Failed to apply the input overrides to file %s: get_in_args()\n", fname);
+		return ERROR_USAGE;
+	}
+	
 	// open input file
 	if((fpin = fopen(fname, "r")) == NULL)
 	{
@@ -73,6 +183,10 @@ int get_in_args(const char *fname, args_struct *in_args) {
 			// strip off the comment, if it exists
 			length = (int) strcspn(cln_str, comment);
 			strncpy(fld_str, cln_str, length);
+			// replace the value with its override, if any
+			if (count <= NUM_IN_ARGS) {
+				get_override(overrides, in_arg_names[count - 1], fld_str);
+			}
 			// set the input variable
 			switch (count) {
 				case 1:
@@ -302,6 +416,40 @@ int get_in_args(const char *fname, args_struct *in_args) {
                break;
             case 76:
                strcpy(in_args->lt_map_fname, fld_str);
+               break;
+            case 77:
+               strcpy(in_args->trace_fname, fld_str);
+               break;
+            case 78:
+               in_args->grid_res_sec = atof(fld_str);
+               break;
+            case 79:
+               in_args->lulc_res_sec = atof(fld_str);
+               break;
+            case 80:
+               in_args->band_lulc_rows = atoi(fld_str);
+               break;
+            case 81:
+               strcpy(in_args->region_subset, fld_str);
+               break;
+            case 82:
+               strcpy(in_args->hyde_years, fld_str);
+               break;
+            case 83:
+               strcpy(in_args->glu_batch_fname, fld_str);
+               break;
+            case 84:
+               strcpy(in_args->cell_store_fname, fld_str);
+               break;
+            case 85:
+               strcpy(in_args->checkpoint_path, fld_str);
+               break;
+            case 86:
+               if ((in_args->table_format = parse_table_format(fld_str)) == 0) {
+                  fprintf(stderr, "Invalid table_format %s in file %s; use csv, nc, or csv,nc: get_in_args()\n", fld_str, fname);
+                  fclose(fpin);
+                  return ERROR_USAGE;
+               }
                break;
 					
                     
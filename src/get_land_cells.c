@@ -17,9 +17,6 @@
    into land_cells_hyde[num_land_cells_hyde] (based on hyde land area, which is an effecive hyde land mask)
    the hyde grid cell area matches the land area as a land mask
  
- store forest cells based on ref veg and hyde land cells, for forest land rent calculations
-   these are further restricted to valid output mask during processing
- 
  also store the land cells of the new aez data in land_cells_aez_new[num_land_cells_aez_new], which are used
    to create mapping files; these are also processed to match the valid output mask
  
@@ -36,11 +33,11 @@
 
  spatial grid initializations happen here because it is the first time that there is a loop over the working grid
  
- also initialize the area and calibration arrays to NODATA
- 
  also initialize the land mask arrays to 0
+    the reference year area arrays, the ref veg and forest masks, and the forest cells are set once for the run
+    in calc_refveg_area(), because they do not depend on the glus
  
- the num_land_cells_#### variables are initialized in init_moirai.c
+ the num_land_cells_#### variables are initialized in init_moirai.c, and reset for each glu scenario in moirai_ctx.c
 
  also gets the non land cells for regions, basins and countries
  
@@ -230,8 +227,6 @@ int get_land_cells(args_struct in_args, rinfo_struct raster_info) {
 		land_mask_hyde[i] = 0;
 		land_mask_fao[i] = 0;
 		land_mask_potveg[i] = 0;
-		land_mask_refveg[i] = 0;
-		land_mask_forest[i] = 0;
         land_mask_ctryaez[i] = 0;
 		country87_gtap[i] = NODATA;
         glacier_water_area_hyde[i] = NODATA;
@@ -257,19 +252,24 @@ int get_land_cells(args_struct in_args, rinfo_struct raster_info) {
 			land_mask_aez_new[i] = 1;
 		}
 		// if sage land area, then add cell index to land_cells_sage array and land_mask_sage
+		// with a region subset only the cells of the subset countries (which keep their glu) are processed
 		if (land_area_sage[i] != raster_info.land_area_sage_nodata) {
-			land_cells_sage[num_land_cells_sage++] = i;
+			if (!raster_info.subset || aez_bounds_new[i] != raster_info.aez_new_nodata) {
+				land_cells_sage[num_land_cells_sage++] = i;
+			}
 			land_mask_sage[i] = 1;
 		}
 		// if hyde land area, then add cell index to land_cells_hyde array and land_mask_hyde
         // also keep track of residual water/ice area
 		if (land_area_hyde[i] != raster_info.land_area_hyde_nodata) {
             temp_float = land_area_hyde[i];
-            land_cells_hyde[num_land_cells_hyde++] = i;
+            if (!raster_info.subset || aez_bounds_new[i] != raster_info.aez_new_nodata) {
+                land_cells_hyde[num_land_cells_hyde++] = i;
+            }
 			land_mask_hyde[i] = 1;
-            if (cell_area_hyde[i] != raster_info.cell_area_hyde_nodata) {
-                temp_float = cell_area_hyde[i];
-                glacier_water_area_hyde[i] = cell_area_hyde[i] - land_area_hyde[i];
+            if (cell_area_hyde_at(i) != raster_info.cell_area_hyde_nodata) {
+                temp_float = cell_area_hyde_at(i);
+                glacier_water_area_hyde[i] = cell_area_hyde_at(i) - land_area_hyde[i];
             }
 		}
 		// if fao country, then add cell index to land_mask_fao
@@ -340,15 +340,9 @@ int get_land_cells(args_struct in_args, rinfo_struct raster_info) {
             sage_minus_hyde_land_area[i] = land_area_sage[i] - land_area_hyde[i];
         }
         
-		// initialize the working area arrays
-		cropland_area[i] = NODATA;
-		pasture_area[i] = NODATA;
-		urban_area[i] = NODATA;
-		refveg_area[i] = NODATA;
+		// initialize the working area array
+		// the reference year land use and ref veg area arrays are initialized in calc_refveg_area()
 		sage_minus_hyde_land_area[i] = NODATA;
-		for (k = 0; k < NUM_HYDE_TYPES - NUM_HYDE_TYPES_MAIN; k++) {
-			lu_detail_area[k][i] = NODATA;
-		}
 		
 		// initialize the aez value diagnostic array
 		missing_aez_mask[i] = 0;
@@ -615,11 +609,6 @@ int get_land_cells(args_struct in_args, rinfo_struct raster_info) {
 			fprintf(fplog, "Error writing file %s: get_land_cells()\n", "land_mask_potveg.bil");
 			return err;
 		}
-		// forest land mask
-		if ((err = write_raster_int(land_mask_forest, NUM_CELLS, "land_mask_forest.bil", in_args))) {
-			fprintf(fplog, "Error writing file %s: get_land_cells()\n", "land_mask_forest.bil");
-			return err;
-		}
         // hyde glacier-water area for land
         if ((err = write_raster_float(glacier_water_area_hyde, NUM_CELLS, "residual_ice_wat_area_hyde.bil", in_args))) {
             fprintf(fplog, "Error writing file %s: get_land_cells()\n", "residual_ice_wat_area_hyde.bil");
@@ -0,0 +1,93 @@
+/**********
+ get_lat_band.c
+
+ find the latitude band of the working grid that contains a given cell
+
+ the crop stages read their input rasters one latitude band at a time (see set_grid_geometry.c)
+    and visit the land cells in increasing cell order, so each band is read once per crop raster
+    the other stages and the static layers are not banded, so this does not bound the peak memory of a run
+ a band is raster_info.band_nrows rows of the working grid; the last band may be shorter
+ the band covers the rows of cell indices band_start_cell to band_end_cell - 1
+    so band_start_cell / NUM_LON is its first row and (band_end_cell - band_start_cell) / NUM_LON its number of rows
+ with a region subset, the band is windowed to the subset bounding box (see set_region_subset.c)
+    its rows are clipped to the rows of the box, and only the columns of the box are read
+    the band arrays hold the window row by row, so get_band_cell() gives the index of a cell within them
+    the whole working grid is the window if there is no subset
+
+ arguments:
+ int cell:					working grid cell index
+ rinfo_struct raster_info:	information about input raster data
+ int *band_start_cell:		address of variable to store the first cell index of the band
+ int *band_end_cell:		address of variable to store one past the last cell index of the band
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ get_band_cell() returns the index of a working grid cell within the band window that starts at band_start_cell
+    the cell has to be within the window
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+ 
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+ 
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+ 
+ This file is part of Moirai.
+ 
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+ **********/
+
+#include "moirai.h"
+
+int get_lat_band(int cell, rinfo_struct raster_info, int *band_start_cell, int *band_end_cell) {
+
+	int first_row;			// first row of the band
+	int end_row;			// one past the last row of the band
+
+	if (cell < 0 || cell >= NUM_CELLS) {
+		fprintf(fplog, "Error: cell %i is outside the working grid: get_lat_band()\n", cell);
+		return ERROR_IND;
+	}
+	if (cell / NUM_LON < raster_info.subset_row_min || cell / NUM_LON > raster_info.subset_row_max) {
+		fprintf(fplog, "Error: cell %i is outside the region subset rows %i-%i: get_lat_band()\n", cell,
+				raster_info.subset_row_min, raster_info.subset_row_max);
+		return ERROR_IND;
+	}
+
+	first_row = (cell / NUM_LON) / raster_info.band_nrows * raster_info.band_nrows;
+	end_row = first_row + raster_info.band_nrows;
+	if (end_row > NUM_LAT) {
+		end_row = NUM_LAT;
+	}
+
+	// clip the band to the region subset rows
+	if (first_row < raster_info.subset_row_min) {
+		first_row = raster_info.subset_row_min;
+	}
+	if (end_row > raster_info.subset_row_max + 1) {
+		end_row = raster_info.subset_row_max + 1;
+	}
+
+	*band_start_cell = first_row * NUM_LON;
+	*band_end_cell = end_row * NUM_LON;
+
+	return OK;}
+
+int get_band_cell(int cell, int band_start_cell, rinfo_struct raster_info) {
+	
+	int band_ncols = raster_info.subset_col_max - raster_info.subset_col_min + 1;	// number of columns in the window
+	
+	return (cell / NUM_LON - band_start_cell / NUM_LON) * band_ncols + cell % NUM_LON - raster_info.subset_col_min;}
@@ -56,6 +56,9 @@ int init_moirai(args_struct *in_args) {
 	in_args->out_year_usd = 0;
 	in_args->in_year_lr_usd = 0;
 	in_args->lulc_out_year = 0;
+	in_args->grid_res_sec = DEFAULT_GRID_RES_SEC;
+	in_args->lulc_res_sec = DEFAULT_LULC_RES_SEC;
+	in_args->band_lulc_rows = 0;
 	// file paths; must include final "/"
 	memset(in_args->inpath, '\0', MAXCHAR);
 	memset(in_args->outpath, '\0', MAXCHAR);
@@ -135,11 +138,24 @@ int init_moirai(args_struct *in_args) {
     memset(in_args->wf_fname, '\0', MAXCHAR);
     memset(in_args->iso_map_fname, '\0', MAXCHAR);
     memset(in_args->lt_map_fname, '\0', MAXCHAR);
+    memset(in_args->trace_fname, '\0', MAXCHAR);
+    // region subset; whole globe unless set in the input file
+    strcpy(in_args->region_subset, NONE_TEXT);
+    // hyde years; all years unless set in the input file
+    strcpy(in_args->hyde_years, ALL_TEXT);
+    // glu batch; one run with aez_new_fname unless set in the input file
+    strcpy(in_args->glu_batch_fname, NONE_TEXT);
+    // cell store; not written unless set in the input file
+    strcpy(in_args->cell_store_fname, NONE_TEXT);
+    // checkpoint; none unless set in the input file
+    strcpy(in_args->checkpoint_path, NONE_TEXT);
+    // output tables; csv unless set in the input file
+    in_args->table_format = TABLE_CSV;
 	
 	// number of land cells
 	num_land_cells_aez_new = 0;			// the actual number of land cell indices in land_cells_aez_new[]
 	num_land_cells_sage = 0;			// the actual number of land cell indices in land_cells_sage[]
 	num_land_cells_hyde = 0;			// the actual number of land cell indices in land_cells_hyde[]
-    num_forest_cells = 0;				// the actual number of land cell indices in forest_cells[]
+    // num_forest_cells is counted by calc_refveg_area(), and is kept with forest_cells between serve requests (see serve_stages.c)
 	
 	return OK;}
@@ -0,0 +1,192 @@
+/**********
+ lt_tally.c
+
+ sparse tally of the country X glu X land type category combinations that occur
+    most combinations are empty, because the glus of a country have only a few reference veg types and protected categories,
+        so the outputs by country X glu X land type are stored for the occurring combinations only
+    each occurring combination (key) has a slot, and the values of a key are stored by slot in the tally or by the caller
+ the country glu pairs are numbered in country, glu order: pair = ctry_start[ctry_ind] + aez_ind
+    each pair has its keys in increasing land type category index order, so looping over the pairs and their keys
+        visits the keys in output table order
+ the slots are numbered in the order that the keys are added, and do not change when keys are added later
+    so a caller can add keys during accumulation, as proc_land_type_area() does for the year-dependent reference veg types
+    or add all the keys first, as write_glu_mapping() does for the reference veg carbon, and then allocate its arrays by slot
+ vals holds one value per slot for the callers that need only a sum; it is zero for a new key
+
+ functions:
+ init_lt_tally():		set up an empty tally for the country glu lists
+ add_lt_tally_key():	get the slot of a key, and add the key if it is new
+ find_lt_tally_slot():	get the slot of a key; NOMATCH if the key has not been added
+ free_lt_tally():		free the tally
+
+ arguments:
+ lt_tally_struct *tally:	the tally
+ const int *ctry_aez_num:	the number of glus in each fao country
+ int ctry_ind:				the fao country index of the key
+ int aez_ind:				the glu index of the key within the country glu list
+ int lt_ind:				the land type category index of the key in lt_cats
+ int *slot:					the slot of the key
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+    find_lt_tally_slot() returns the slot, or NOMATCH
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#include "moirai.h"
+
+#define LT_TALLY_INIT_KEYS		4		// initial number of keys allocated for a pair
+#define LT_TALLY_INIT_SLOTS		1024	// initial number of slots allocated for the values
+
+// the position of lt_ind in the keys of a pair, or the position where it goes if it is not there
+static int key_pos(const lt_tally_struct *tally, int pair, int lt_ind) {
+	int lo = 0;
+	int hi = tally->num_keys[pair];
+	int mid;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (tally->key_lt[pair][mid] < lt_ind) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+int init_lt_tally(lt_tally_struct *tally, const int *ctry_aez_num) {
+
+	int i;
+
+	memset(tally, 0, sizeof(lt_tally_struct));
+	tally->ctry_start = malloc((NUM_FAO_CTRY + 1) * sizeof(int));
+	if (tally->ctry_start == NULL) {
+		fprintf(fplog, "Failed to allocate memory for ctry_start: init_lt_tally()\n");
+		return ERROR_MEM;
+	}
+	tally->ctry_start[0] = 0;
+	for (i = 0; i < NUM_FAO_CTRY; i++) {
+		tally->ctry_start[i + 1] = tally->ctry_start[i] + ctry_aez_num[i];
+	}
+	tally->num_pairs = tally->ctry_start[NUM_FAO_CTRY];
+
+	// one extra element so that a run without glus does not allocate zero size
+	tally->num_keys = calloc(tally->num_pairs + 1, sizeof(int));
+	tally->max_keys = calloc(tally->num_pairs + 1, sizeof(int));
+	tally->key_lt = calloc(tally->num_pairs + 1, sizeof(int*));
+	tally->key_slot = calloc(tally->num_pairs + 1, sizeof(int*));
+	tally->vals = calloc(LT_TALLY_INIT_SLOTS, sizeof(double));
+	if (tally->num_keys == NULL || tally->max_keys == NULL || tally->key_lt == NULL || tally->key_slot == NULL ||
+		tally->vals == NULL) {
+		fprintf(fplog, "Failed to allocate memory for the tally pairs: init_lt_tally()\n");
+		return ERROR_MEM;
+	}
+	tally->max_slots = LT_TALLY_INIT_SLOTS;
+	tally->num_slots = 0;
+
+	return OK;}
+
+int add_lt_tally_key(lt_tally_struct *tally, int ctry_ind, int aez_ind, int lt_ind, int *slot) {
+
+	int pair = tally->ctry_start[ctry_ind] + aez_ind;
+	int pos = key_pos(tally, pair, lt_ind);
+	int new_max;
+	int *temp_lt;
+	int *temp_slot;
+	double *temp_vals;
+
+	if (pos < tally->num_keys[pair] && tally->key_lt[pair][pos] == lt_ind) {
+		*slot = tally->key_slot[pair][pos];
+		return OK;
+	}
+
+	// grow the keys of the pair and the values by doubling
+	if (tally->num_keys[pair] == tally->max_keys[pair]) {
+		new_max = (tally->max_keys[pair] == 0) ? LT_TALLY_INIT_KEYS : 2 * tally->max_keys[pair];
+		temp_lt = realloc(tally->key_lt[pair], new_max * sizeof(int));
+		if (temp_lt == NULL) {
+			fprintf(fplog, "Failed to allocate memory for the keys of pair %i: add_lt_tally_key()\n", pair);
+			return ERROR_MEM;
+		}
+		tally->key_lt[pair] = temp_lt;
+		temp_slot = realloc(tally->key_slot[pair], new_max * sizeof(int));
+		if (temp_slot == NULL) {
+			fprintf(fplog, "Failed to allocate memory for the keys of pair %i: add_lt_tally_key()\n", pair);
+			return ERROR_MEM;
+		}
+		tally->key_slot[pair] = temp_slot;
+		tally->max_keys[pair] = new_max;
+	}
+	if (tally->num_slots == tally->max_slots) {
+		temp_vals = realloc(tally->vals, 2 * (size_t) tally->max_slots * sizeof(double));
+		if (temp_vals == NULL) {
+			fprintf(fplog, "Failed to allocate memory for %i tally values: add_lt_tally_key()\n", 2 * tally->max_slots);
+			return ERROR_MEM;
+		}
+		tally->vals = temp_vals;
+		tally->max_slots = 2 * tally->max_slots;
+	}
+
+	// insert the key in order
+	memmove(&tally->key_lt[pair][pos + 1], &tally->key_lt[pair][pos], (tally->num_keys[pair] - pos) * sizeof(int));
+	memmove(&tally->key_slot[pair][pos + 1], &tally->key_slot[pair][pos], (tally->num_keys[pair] - pos) * sizeof(int));
+	tally->key_lt[pair][pos] = lt_ind;
+	tally->key_slot[pair][pos] = tally->num_slots;
+	tally->num_keys[pair]++;
+	tally->vals[tally->num_slots] = 0;
+	*slot = tally->num_slots++;
+
+	return OK;}
+
+int find_lt_tally_slot(const lt_tally_struct *tally, int ctry_ind, int aez_ind, int lt_ind) {
+
+	int pair = tally->ctry_start[ctry_ind] + aez_ind;
+	int pos = key_pos(tally, pair, lt_ind);
+
+	if (pos < tally->num_keys[pair] && tally->key_lt[pair][pos] == lt_ind) {
+		return tally->key_slot[pair][pos];
+	}
+	return NOMATCH;
+}
+
+void free_lt_tally(lt_tally_struct *tally) {
+
+	int i;
+
+	if (tally->key_lt != NULL) {
+		for (i = 0; i < tally->num_pairs; i++) {
+			free(tally->key_lt[i]);
+			free(tally->key_slot[i]);
+		}
+	}
+	free(tally->ctry_start);
+	free(tally->num_keys);
+	free(tally->max_keys);
+	free(tally->key_lt);
+	free(tally->key_slot);
+	free(tally->vals);
+	memset(tally, 0, sizeof(lt_tally_struct));
+}
@@ -0,0 +1,89 @@
+/**********
+ make_dirs.c
+
+ create a directory and any missing parent directories, as mkdir -p does, with mkdir(2)
+    the output paths can be set by serve request overrides, so they are not passed to a shell
+ an existing directory is ok; an existing file with the name of a directory is an error
+ nothing is written to the log, because the output path is created before the log file in it is opened
+    the caller reports the error; errno is set by the mkdir() or stat() that failed
+
+ arguments:
+ const char *path:	the directory to create; a trailing "/" is allowed
+
+ return value:
+ integer error code: OK = 0, otherwise ERROR_FILE
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "moirai.h"
+#include <errno.h>
+#include <sys/stat.h>
+
+// create one directory; an existing directory is ok
+static int make_one_dir(const char *dir) {
+
+	struct stat st;
+
+	if (mkdir(dir, 0777) == 0) {
+		return OK;
+	}
+	if (errno == EEXIST && stat(dir, &st) == 0) {
+		if (S_ISDIR(st.st_mode)) {
+			return OK;
+		}
+		errno = ENOTDIR;
+	}
+	return ERROR_FILE;
+}
+
+int make_dirs(const char *path) {
+
+	char dir[MAXCHAR];
+	char *p;
+
+	if (path[0] == '\0') {
+		errno = ENOENT;
+		return ERROR_FILE;
+	}
+	if (strlen(path) >= MAXCHAR) {
+		errno = ENAMETOOLONG;
+		return ERROR_FILE;
+	}
+	strcpy(dir, path);
+
+	// create each parent in turn, then the whole path
+	for (p = dir + 1; *p != '\0'; p++) {
+		if (*p == '/' && *(p - 1) != '/') {
+			*p = '\0';
+			if (make_one_dir(dir) != OK) {
+				return ERROR_FILE;
+			}
+			*p = '/';
+		}
+	}
+	return make_one_dir(dir);}
@@ -0,0 +1,300 @@
+/**********
+ moirai_ctx.c
+
+ the library interface of moirai: create a run context from an input control file, run the pipeline, and free it
+    see libmoirai.h for the interface and moirai_main.c for the command line program
+
+ moirai_ctx_run() does what main() did before the library:
+    it creates the output paths, opens the log file, starts the stage profile and the trace,
+    sets the grid geometry and the hyde years, and processes each glu scenario with proc_glu_scenario()
+ the stage functions use the process-wide tables in moirai.h, so the runs are serialized, not reentrant:
+    only one context can run at a time in a process, and a context does not own the stage arrays
+    the stage arrays have not been moved into moirai_ctx; until they are, active_ctx is what keeps two runs apart
+    the context that is running is held in active_ctx, which is claimed with an atomic compare and exchange,
+        so another moirai_ctx_run() call, also from another thread, returns ERROR_USAGE instead of sharing the tables
+ the created output paths are written to the log file of the run, not to stdout
+ the log file, trace file, netcdf files, glu scenario tables, glu scenarios, and hyde years are closed and freed when the run ends, also on error,
+    so that the next run in the same process starts clean
+ the glu independent rasters are also freed when the run ends, unless serve mode keeps them for the next request (see serve_stages.c)
+
+ functions:
+ moirai_ctx_create():	read the input control file into a new context; NULL on error, with the error code in error_code
+ moirai_ctx_create_overrides():	the same, with name=value overrides of some input control file values (see get_in_args.c)
+ moirai_ctx_run():		run the whole pipeline for the context
+ moirai_ctx_outpath():	the output path of the context
+ moirai_ctx_free():		free the context; ERROR_USAGE if its run is still active, and the context is not freed
+
+ arguments:
+ const char *input_fname:	the input control file name, with path
+ const char *overrides:		the blank separated name=value overrides; NULL = none
+ int *error_code:			the error code of moirai_ctx_create(); may be NULL
+ moirai_ctx *ctx:			the run context
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#include "moirai.h"
+#include <stdatomic.h>
+#include <errno.h>
+
+static _Atomic(moirai_ctx *) active_ctx = NULL;	// the context that is running; NULL = none
+
+// create an output path once the log file is open, and log it
+static int make_output_path(const char *path) {
+	if (make_dirs(path) != OK) {
+		fprintf(fplog, "\nFailed to create output path %s: %s: moirai_ctx_run()\n", path, strerror(errno));
+		return ERROR_FILE;
+	}
+	fprintf(fplog, "Created output path %s\n", path);
+	return OK;
+}
+
+// free the run-level tables and close the run files, and release the process for the next run
+static int end_run(moirai_ctx *ctx, int error_code) {
+
+	int i, scen_ind;
+
+	// keep the shared rasters for the next serve request, or free them; this uses the glu scenarios and hyde years
+	end_serve_stages(ctx->in_args, &ctx->raster_info, error_code);
+
+	// free the glu scenario tables left by a failed stage; the carbon arrays use the carbon keys, and the glu lists use glu_scen
+	free_glu_tables(1);
+
+	// free the glu scenarios
+	if (glu_scen != NULL) {
+		for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+			free(glu_scen[scen_ind].aez_bounds);
+			if (glu_scen[scen_ind].ctry_aez_list != NULL) {
+				for (i = 0; i < NUM_FAO_CTRY; i++) {
+					free(glu_scen[scen_ind].ctry_aez_list[i]);
+				}
+			}
+			free(glu_scen[scen_ind].ctry_aez_list);
+			free(glu_scen[scen_ind].ctry_aez_num);
+		}
+		free(glu_scen);
+	}
+	glu_scen = NULL;
+	num_glu_scen = 0;
+	// netcdf files left open by a failed stage
+	nc_access_close_all();
+	// carbon keys left by a failed stage
+	free_lt_tally(&refveg_carbon_tally);
+
+	if (error_code == OK) {
+		fprintf(fplog, "\nSuccessful completion of program %s at %s\n", CODENAME, get_systime());
+		write_stage_profile(1);
+	}
+	// the hyde years are freed after the stage profile, which reports their number
+	free(hyde_years);
+	hyde_years = NULL;
+	num_hyde_years = 0;
+	close_trace();
+	if (ctx->fplog != NULL) {
+		fclose(ctx->fplog);
+		ctx->fplog = NULL;
+	}
+	fplog = NULL;
+	atomic_store(&active_ctx, NULL);
+
+	return error_code;}
+
+moirai_ctx *moirai_ctx_create(const char *input_fname, int *error_code) {
+	return moirai_ctx_create_overrides(input_fname, NULL, error_code);
+}
+
+moirai_ctx *moirai_ctx_create_overrides(const char *input_fname, const char *overrides, int *error_code) {
+
+	int err = OK;
+	moirai_ctx *ctx;
+
+	ctx = calloc(1, sizeof(moirai_ctx));
+	if (ctx == NULL) {
+		fprintf(stderr, "Failed to allocate memory for the moirai context: moirai_ctx_create()\n");
+		err = ERROR_MEM;
+	} else {
+		strncpy(ctx->input_fname, input_fname, MAXCHAR - 1);
+		if (overrides != NULL) {
+			strncpy(ctx->overrides, overrides, MAXRECSIZE - 1);
+		}
+		// initialize the input arguments
+		if((err = init_moirai(&ctx->in_args)) == OK) {
+			// read the input control file and fill the in_args structure
+			err = get_in_args(ctx->input_fname, ctx->overrides, &ctx->in_args);
+		}
+		if (err != OK) {
+			free(ctx);
+			ctx = NULL;
+		}
+	}
+
+	if (error_code != NULL) {
+		*error_code = err;
+	}
+	return ctx;}
+
+int moirai_ctx_run(moirai_ctx *ctx) {
+
+	int scen_ind;				// current glu scenario index
+	char fname[MAXCHAR];		// used to open files
+	args_struct in_args;		// the input file info of the context
+	args_struct scen_args;		// the input file info with the glu files and output paths of the current scenario
+	int error_code = OK;		// 0 = ok; non-zero = error
+	moirai_ctx *no_ctx = NULL;	// the expected active context: none
+
+	if (!atomic_compare_exchange_strong(&active_ctx, &no_ctx, ctx)) {
+		fprintf(stderr, "\nFailed to start %s run of %s: another run is active in this process: moirai_ctx_run()\n",
+				CODENAME, ctx->input_fname);
+		return ERROR_USAGE;
+	}
+	in_args = ctx->in_args;
+
+	// create log file name and open it
+	strcpy(fname, in_args.outpath);
+	strcat(fname, in_args.lds_logname);
+
+	// create the output path; it is logged once the log file in it is open
+	if (make_dirs(in_args.outpath) != OK) {
+		fprintf(stderr, "\nProgram terminated at %s with error_code = %i; could not create output path %s: %s\n",
+					get_systime(), ERROR_FILE, in_args.outpath, strerror(errno));
+		atomic_store(&active_ctx, NULL);
+		return ERROR_FILE;
+	}
+
+	if ((ctx->fplog = fopen(fname, "w")) == NULL) {
+		fprintf(stderr, "\nProgram terminated at %s with error_code = %i; could not open %s\n",
+					get_systime(), ERROR_FILE, fname);
+		atomic_store(&active_ctx, NULL);
+		return ERROR_FILE;
+	}
+	fplog = ctx->fplog;
+
+	fprintf(fplog, "\nProgram %s started at %s\n", CODENAME, get_systime());
+	if (ctx->overrides[0] != '\0') {
+		fprintf(fplog, "\nInput overrides of %s: %s\n", ctx->input_fname, ctx->overrides);
+	}
+
+	fprintf(fplog, "\nCreated output path %s\n", in_args.outpath);
+	// create the paths for copying outputs to: data files and mapping files
+	if((error_code = make_output_path(in_args.ldsdestpath)) || (error_code = make_output_path(in_args.mapdestpath))) {
+		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+		return end_run(ctx, error_code);
+	}
+
+	fprintf(fplog, "\nFor more detailed information regarding alignment of various input data set the diagnostics flag to 1 in the input file\n");
+
+	// start the per-stage timing and memory report; it is written next to the log file
+	init_stage_profile(in_args);
+
+	// open the optional trace event timeline
+	if((error_code = init_trace(in_args))) {
+		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+		return end_run(ctx, error_code);
+	}
+
+	// set the working grid and lulc grid dimensions; the raster readers check their inputs against these
+	if((error_code = set_grid_geometry(in_args, &ctx->raster_info))) {
+		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+		return end_run(ctx, error_code);
+	}
+
+	// set the hyde years to process for the land type area
+	if((error_code = set_hyde_years(in_args))) {
+		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+		return end_run(ctx, error_code);
+	}
+
+	// set the glu scenarios; there is one unless a glu batch file is set
+	if((error_code = read_glu_batch(in_args))) {
+		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+		return end_run(ctx, error_code);
+	}
+
+	// find the stages that a serve request has to process, and restore the raster info of the resident rasters
+	if((error_code = set_serve_stages(in_args, &ctx->raster_info))) {
+		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+		return end_run(ctx, error_code);
+	}
+
+	// set the rand() seed
+	// want it the same each time the program is run; the random cell order is set once, with the first scenario
+	srand(0);
+
+	// process each glu scenario with its own glu files and output paths
+	// the other inputs are the same for each scenario, so they are read with the first one and kept until the last one,
+	//	and the land type area is processed with the last one
+	for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+
+		scen_args = in_args;
+		strcpy(scen_args.aez_new_fname, glu_scen[scen_ind].aez_new_fname);
+		strcpy(scen_args.aez_new_info_fname, glu_scen[scen_ind].aez_new_info_fname);
+		strcpy(scen_args.outpath, glu_scen[scen_ind].outpath);
+		strcpy(scen_args.ldsdestpath, glu_scen[scen_ind].ldsdestpath);
+		strcpy(scen_args.mapdestpath, glu_scen[scen_ind].mapdestpath);
+
+		if (num_glu_scen > 1) {
+			fprintf(fplog, "\nGLU scenario %s started at %s\n", glu_scen[scen_ind].name, get_systime());
+			// create the scenario output paths
+			if((error_code = make_output_path(scen_args.outpath)) || (error_code = make_output_path(scen_args.ldsdestpath)) ||
+				(error_code = make_output_path(scen_args.mapdestpath))) {
+				fprintf(fplog, "Failed to create the output paths of glu scenario %s: moirai_ctx_run()\n", glu_scen[scen_ind].name);
+				return end_run(ctx, error_code);
+			}
+		}
+
+		// the land cell lists and the taiwan and hong kong land areas are filled again for each scenario
+		// the forest cells are set once, with the first scenario
+		num_land_cells_aez_new = 0;
+		num_land_cells_sage = 0;
+		num_land_cells_hyde = 0;
+		twn_land_area = 0;
+		hkg_land_area = 0;
+
+		if((error_code = proc_glu_scenario(scen_args, &ctx->raster_info, scen_ind))) {
+			fprintf(fplog, "Failed to process glu scenario %s: moirai_ctx_run()\n", glu_scen[scen_ind].name);
+			return end_run(ctx, error_code);
+		}
+	} // end for scen_ind loop over the glu scenarios
+
+	return end_run(ctx, OK);}
+
+const char *moirai_ctx_outpath(const moirai_ctx *ctx) {
+	return ctx->in_args.outpath;
+}
+
+int moirai_ctx_free(moirai_ctx *ctx) {
+	if (ctx == NULL) {
+		return OK;
+	}
+	// the running context owns the log file and the process-wide tables until end_run()
+	if (ctx == atomic_load(&active_ctx)) {
+		fprintf(stderr, "\nFailed to free the context of %s: its run is active: moirai_ctx_free()\n", ctx->input_fname);
+		return ERROR_USAGE;
+	}
+	free(ctx);
+	return OK;}
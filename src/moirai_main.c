@@ -296,1162 +296,48 @@ soil carbon (soil only for a depth of 0-30 cms)
 #include <stdlib.h>
 #include <stdio.h>
 
+// the pipeline is in the moirai library; see libmoirai.h and moirai_ctx.c
 int main(int argc, const char * argv[]) {
     
-    int i, j, k,l;
-    int array_cells =3;
-	char fname[MAXCHAR];		// used to open files
-	args_struct in_args;		// data structure for holding the control input file info
-	rinfo_struct raster_info;	// data structure for storing raster input file specific info
-    
-    char mkoutputpathcmd[MAXCHAR]; // used to create the output path
+	moirai_ctx *ctx;			// the run context: input file info, raster info, and log file
 	
 	// for code control
 	int error_code = OK;		// 0 = ok; non-zero = error
+	int free_error;				// error code of freeing the context
 	
-	// the only argument is the name of the input control file
+	// the only argument is the name of the input control file, or --serve with the socket for the resident server
+	if(argc == 3 && strcmp(argv[1], "--serve") == 0)
+	{
+		return moirai_serve(argv[2]);
+	}
 	if(argc != 2)
 	{
 		error_code = ERROR_USAGE;
 		fprintf(stdout, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
 		fprintf(stdout, "\nProper usage:\n");
 		fprintf(stdout, "%s <input file name with path>\n", CODENAME);
+		fprintf(stdout, "%s --serve <unix socket file name with path>\n", CODENAME);
 		return error_code;
 	}
 	
 	fprintf(stdout, "\nProgram %s started at %s\n", CODENAME, get_systime());
 	
-	// set the rand() seed
-	// want it the same each time the program is run
-	srand(0);
-	
-	// initialize all of the arrays
-	if((error_code = init_moirai(&in_args))) {
-		fprintf(stderr, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-	// read the input control file and fill the in_args structure
-	if((error_code = get_in_args(argv[1], &in_args))) {
+	// read the input control file
+	if((ctx = moirai_ctx_create(argv[1], &error_code)) == NULL) {
 		fprintf(stderr, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
 		return error_code;
 	}
 	
-	// create log file name and open it
-	strcpy(fname, in_args.outpath);
-	strcat(fname, in_args.lds_logname);
-    
-    // create the output path
-    strcpy(mkoutputpathcmd, "mkdir -p ");
-    strcat(mkoutputpathcmd, in_args.outpath);
-    printf("%s",mkoutputpathcmd);
-    system(mkoutputpathcmd);
-    
-	if ((fplog = fopen(fname, "w")) == NULL) {
-		fprintf(stderr, "\nProgram terminated at %s with error_code = %i; could not open %s\n",
-					get_systime(), ERROR_FILE, fname);
-		return ERROR_FILE;
-	}
-	
-	// create the paths for copying outputs to
-	// data files
-	strcpy(mkoutputpathcmd, "\nmkdir -p ");
-	strcat(mkoutputpathcmd, in_args.ldsdestpath);
-	printf("%s",mkoutputpathcmd);
-	system(mkoutputpathcmd);
-	// mapping files
-	strcpy(mkoutputpathcmd, "\nmkdir -p ");
-	strcat(mkoutputpathcmd, in_args.mapdestpath);
-	printf("%s",mkoutputpathcmd);
-	system(mkoutputpathcmd);
-	
-	fprintf(fplog, "\nProgram %s started at %s\n", CODENAME, get_systime());
-	
-	fprintf(fplog, "\nFor more detailed information regarding alignment of various input data set the diagnostics flag to 1 in the input file\n");
-
-	/*
-	// create a file to check each lulc cell that is easy to read into r and compare area values
-	strcpy(fname, in_args.outpath);
-	strcat(fname, "check_area.csv");
-	if ((debug_file = fopen(fname, "w")) == NULL) {
-		fprintf(stderr, "\nProgram terminated at %s with error_code = %i; could not open %s\n",
-				get_systime(), ERROR_FILE, fname);
-		return ERROR_FILE;
-	}
-	fprintf(debug_file, "func,year,lulc_cell,rf_area,lu_area,land_area\n");
-	
-	// create a file for particular lu values for a given lulc cell
-	strcpy(fname, in_args.outpath);
-	strcat(fname, "check_lulc_cell.csv");
-	if ((cell_file = fopen(fname, "w")) == NULL) {
-		fprintf(stderr, "\nProgram terminated at %s with error_code = %i; could not open %s\n",
-				get_systime(), ERROR_FILE, fname);
-		return ERROR_FILE;
-	}
-	fprintf(cell_file, "func,lu_index,wg_index,lulc_index,land_area,rf_area,lu_area,u_area,c_area,p_area\n");
-	*/
-	 
-    //////////
-    // start with the text info data
-    // these are csv files that determine mappings and number of aezs, crops, counties, regions
-    
-    ////////// read GTAP87 and GCAM region and FAO country info text files
-    
-    // one file	includes the alphabetical FAO country list and the FAO, VMAP0, iso ctry mapping
-    // array length and allocation done within read_country_info_all()
-    if((error_code = read_country_info_all(in_args))) {
-        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-        return error_code;
-    }
-    
-    // this includes both the GCAM/GTAP ctry87 list in land rent output order and the mapping between FAO ctry and GCAM/GTAP ctry87
-    // array length and allocation done within read_country87_info()
-    if((error_code = read_country87_info(in_args))) {
-        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-        return error_code;
-    }
-    
-    // this includes GCAM region list
-    // array length and allocation done within read_region_info_gcam()
-    if((error_code = read_region_info_gcam(in_args))) {
-        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-        return error_code;
-    }
-    
-    ////////// read the list of new aez codes and names
-    
-    // this is the list of new aezs
-    // array length and allocation done within read_aez_new_info()
-    if((error_code = read_aez_new_info(in_args))) {
-        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-        return error_code;
-    }
-    
-    ////////// read crop and use and land info text files
-    
-    // read GTAP use info
-    // this is the list in output order for land rent
-    // array length and allocation done within read_use_info_gtap()
-    if((error_code = read_use_info_gtap(in_args))) {
-        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-        return error_code;
-    }
-    
-    // read SAGE land type info
-    // array length and allocation done within read_lt_info_sage()
-    if((error_code = read_lulc_info(in_args))) {
-        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-        return error_code;
-    }
-    
-    // one file includes FAO to SAGE crop and to GTAP use mapping
-    // array length and allocation done within read_crop_info()
-    if((error_code = read_crop_info(in_args))) {
-        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-        return error_code;
-    }
-    
-	////////
-	// read the raster data, except the SAGE crop data, lulc data, and hyde lu data
-	
-	// calculate the total area of each working grid cell (spherical earth): cell_area[NUM_CELLS]
-    // and read in cell area of the hyde land cells (also spherical earth): cell_area_hyde[NUM_CELLS]
-    // first allocate the arrays
-    cell_area = calloc(NUM_CELLS, sizeof(float));
-    if(cell_area == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for cell_area: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    cell_area_hyde = calloc(NUM_CELLS, sizeof(float));
-    if(cell_area_hyde == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for cell_area_hyde: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-	if((error_code = get_cell_area(in_args, &raster_info))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-	// read the sage working grid land fraction and convert it to land area: land_area_sage[NUM_CELLS]
-    // first allocate the arrays
-    land_area_sage = calloc(NUM_CELLS, sizeof(float));
-    if(land_area_sage == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_area_sage: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-	if((error_code = read_land_area_sage(in_args, &raster_info))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-	// read the hyde land area: land_area_hyde[NUM_CELLS]
-    // first allocate the arrays
-    land_area_hyde = calloc(NUM_CELLS, sizeof(float));
-    if(land_area_hyde == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_area_hyde: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-	if((error_code = read_land_area_hyde(in_args, &raster_info))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-	// read new AEZ boundaries: aez_bounds_new[NUM_CELLS]
-    // first allocate the array
-    aez_bounds_new = calloc(NUM_CELLS, sizeof(int));
-    if(aez_bounds_new == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for aez_bounds_new: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    if((error_code = read_aez_new(in_args, &raster_info))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-	// read original AEZ boundaries:aez_bounds_orig[NUM_CELLS]
-    // first allocate the array
-    aez_bounds_orig = calloc(NUM_CELLS, sizeof(int));
-    if(aez_bounds_orig == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for aez_bounds_orig: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-	if((error_code = read_aez_orig(in_args, &raster_info))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-	// read potential vegetation data: potveg_thematic[NUM_CELLS]
-    // first allocate the array
-    potveg_thematic = calloc(NUM_CELLS, sizeof(int));
-    if(potveg_thematic == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for potveg_thematic: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-	if((error_code = read_potveg(in_args, &raster_info))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-	// read FAO country code data: country_fao[NUM_CELLS]
-    // first allocate array
-    country_fao = calloc(NUM_CELLS, sizeof(short));
-    if(country_fao == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for country_fao: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-	if((error_code = read_country_fao(in_args, &raster_info))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-	// read lulc land mask: land_mask_lulc[NUM_CELLS]
-	// first allocate array
-	land_mask_lulc = calloc(NUM_CELLS, sizeof(int));
-	if(land_mask_lulc == NULL) {
-		fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_lulc: main()\n", get_systime(), ERROR_MEM);
-		return ERROR_MEM;
-	}
-	if((error_code = read_lulc_land(in_args, REF_YEAR, &raster_info, land_mask_lulc))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-    /////////
-    // reconcile the raster data
-	
-    // allocate some raster arrays
-    cropland_area = calloc(NUM_CELLS, sizeof(float));
-    if(cropland_area == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for cropland_area: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    pasture_area = calloc(NUM_CELLS, sizeof(float));
-    if(pasture_area == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for pasture_area: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    urban_area = calloc(NUM_CELLS, sizeof(float));
-    if(urban_area == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for urban_area: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-	lu_detail_area = calloc(NUM_HYDE_TYPES - NUM_HYDE_TYPES_MAIN, sizeof(float*));
-	if(lu_detail_area == NULL) {
-		fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for lu_detail_area: main()\n", get_systime(), ERROR_MEM);
-		return ERROR_MEM;
-	}
-	for (i = 0; i < NUM_HYDE_TYPES - NUM_HYDE_TYPES_MAIN; i++) {
-		lu_detail_area[i] = calloc(NUM_CELLS, sizeof(float));
-		if(lu_detail_area[i] == NULL) {
-			fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for lu_detail_area[%i]: main()\n", get_systime(), ERROR_MEM, i);
-			return ERROR_MEM;
-		}
-	}
-    refveg_area = calloc(NUM_CELLS, sizeof(float));
-    if(refveg_area == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for refveg_area: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-
-    refcarbon_area = calloc(NUM_CELLS, sizeof(float));
-    if(refcarbon_area == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for refveg_area: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-
-    region_gcam = calloc(NUM_CELLS, sizeof(int));
-    if(region_gcam == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for region_gcam: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    sage_minus_hyde_land_area = calloc(NUM_CELLS, sizeof(float));
-    if(sage_minus_hyde_land_area == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for sage_minus_hyde_land_area: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    glacier_water_area_hyde = calloc(NUM_CELLS, sizeof(float));
-    if(glacier_water_area_hyde == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for glacier_water_area_hyde: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    country87_gtap = calloc(NUM_CELLS, sizeof(int));
-    if(country87_gtap == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for country87_gtap: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    missing_aez_mask = calloc(NUM_CELLS, sizeof(int));
-    if(missing_aez_mask == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for missing_aez_mask: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    land_mask_ctryaez = calloc(NUM_CELLS, sizeof(int));
-    if(land_mask_ctryaez == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_ctryaez: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    land_mask_aez_orig = calloc(NUM_CELLS, sizeof(int));
-    if(land_mask_aez_orig == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_aez_orig: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    land_mask_aez_new = calloc(NUM_CELLS, sizeof(int));
-    if(land_mask_aez_new == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_aez_new: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    land_mask_sage = calloc(NUM_CELLS, sizeof(int));
-    if(land_mask_sage == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_sage: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    land_mask_hyde = calloc(NUM_CELLS, sizeof(int));
-    if(land_mask_hyde == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_hyde: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    land_mask_fao = calloc(NUM_CELLS, sizeof(int));
-    if(land_mask_fao == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_fao: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    land_mask_potveg = calloc(NUM_CELLS, sizeof(int));
-    if(land_mask_potveg == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_potveg: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-	land_mask_refveg = calloc(NUM_CELLS, sizeof(int));
-	if(land_mask_refveg == NULL) {
-		fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_refveg: main()\n", get_systime(), ERROR_MEM);
-		return ERROR_MEM;
-	}
-    land_mask_forest = calloc(NUM_CELLS, sizeof(int));
-    if(land_mask_forest == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_forest: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-	lulc_input_grid = calloc(NUM_LULC_TYPES, sizeof(float*));
-	if(lulc_input_grid == NULL) {
-		fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for lulc_input_grid: main()\n", get_systime(), ERROR_MEM);
-		return ERROR_MEM;
-	}
-	for (i = 0; i < NUM_LULC_TYPES; i++) {
-		lulc_input_grid[i] = calloc(NUM_CELLS_LULC, sizeof(float));
-		if(lulc_input_grid[i] == NULL) {
-			fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for lulc_input_grid[%i]: main()\n", get_systime(), ERROR_MEM, i);
-			return ERROR_MEM;
-		}
-	}
-	refveg_thematic = calloc(NUM_CELLS, sizeof(int));
-	if(refveg_thematic == NULL) {
-		fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for refveg_thematic: main()\n", get_systime(), ERROR_MEM);
-		return ERROR_MEM;
-	}
-
-    refvegcarbon_thematic = calloc(NUM_CELLS, sizeof(int));
-	if(refvegcarbon_thematic == NULL) {
-		fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for refveg_thematic: main()\n", get_systime(), ERROR_MEM);
-		return ERROR_MEM;
-	}
-	
-    // allocate some arrays to keep track of valid raster cells
-    land_cells_aez_new = calloc(NUM_CELLS, sizeof(int));
-    if(land_cells_aez_new == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_cells_aez_new: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    land_cells_sage = calloc(NUM_CELLS, sizeof(int));
-    if(land_cells_sage == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_cells_sage: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    land_cells_hyde = calloc(NUM_CELLS, sizeof(int));
-    if(land_cells_hyde == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_cells_hyde: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    forest_cells = calloc(NUM_CELLS, sizeof(int));
-    if(forest_cells == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for forest_cells: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    
-    // it would be more efficient to write a loop over all cells here,
-    //  and write the following two functions to operate on a single cell
-    // the second function would be called only if the first one finds a land cell
-    
-	////
-	// determine the indices of the relevant land and forest cells in aez, sage, hyde, and fao data: land_cells_####[NUM_CELLS]
-	if((error_code = get_land_cells(in_args, raster_info))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-	////
-	// convert the hyde land use, lulc, and sage potential veg input data to working grid area
-	// the rand_order array is allocated here in calc_refvef_area and is deallocated in proc_refveg_carbon
-	if((error_code = calc_refveg_area(in_args, &raster_info))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}	
-    
-    if((error_code = calc_refcarbon_area(in_args, raster_info))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-    // free some raster arrays
-    free(region_gcam);
-    free(sage_minus_hyde_land_area);
-    free(glacier_water_area_hyde);
-    free(land_mask_aez_orig);
-    free(land_mask_aez_new);
-    free(land_mask_sage);
-    free(land_mask_hyde);
-    free(land_mask_fao);
-    free(land_mask_potveg);
-	free(land_mask_lulc);
-	
-	    free(land_mask_forest);
-		free(land_mask_refveg);
-   
-   // allocate space for hong kong and taiwan glu area tracking in write_glu_mapping
-   twn_glu_area = calloc(NUM_ORIG_AEZ, sizeof(float));
-   if(twn_glu_area == NULL) {
-      fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for twn_glu_area: main()\n", get_systime(), ERROR_MEM);
-      return ERROR_MEM;
-   }
-   hkg_glu_area = calloc(NUM_ORIG_AEZ, sizeof(float));
-   if(hkg_glu_area == NULL) {
-      fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for hkg_glu_area: main()\n", get_systime(), ERROR_MEM);
-      return ERROR_MEM;
-   }
-   
-	// store the country/land rent region + aez lists
-    // the arrays are allocated within write_glu_mapping()
-	if((error_code = write_glu_mapping(in_args, raster_info))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-    
-    // process the mirca data
-    //  mirca grid is allocated/freed within proc_mirca()
-    if((error_code = proc_mirca(in_args, raster_info))) {
-        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-        return error_code;
-    }
-	
-    //kbn 2020
-    protected_EPA = calloc(NUM_EPA_PROTECTED, sizeof(float*));
-    if(protected_EPA == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for protected_EPA: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    for (i = 0; i < NUM_EPA_PROTECTED; i++) {
-		protected_EPA[i] = calloc(NUM_CELLS, sizeof(float));
-		if(protected_EPA[i] == NULL) {
-			fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for protected_EPA[%i]: main()\n", get_systime(), ERROR_MEM, i);
-			return ERROR_MEM;
-		}
+	// run the pipeline; failures are reported in the log file
+	error_code = moirai_ctx_run(ctx);
+	if ((free_error = moirai_ctx_free(ctx)) != OK && error_code == OK) {
+		error_code = free_error;
 	}
-    
-    
-    if((error_code = read_protected(in_args, &raster_info))) {
-        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-        return error_code;
-    }
-    //kbn 2020/06/01 Add code for read_soil_c here
-    soil_carbon_sage = calloc(NUM_CARBON, sizeof(float*));
-    if(soil_carbon_sage == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for soil_carbon_sage: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    for (i = 0; i < NUM_CARBON; i++) {
-		soil_carbon_sage[i] = calloc(NUM_CELLS, sizeof(float));
-		if(soil_carbon_sage[i] == NULL) {
-			fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for soil_carbon_sage[%i]: main()\n", get_systime(), ERROR_MEM, i);
-			return ERROR_MEM;
-		}
-	}
-    
-    //Allocate the arrays to hold the number of cells
-    soil_carbon_array_cells = calloc(NUM_FAO_CTRY, sizeof(int**));
-    if(soil_carbon_array_cells == NULL) {
-        fprintf(fplog,"Failed to allocate memory for refveg_carbon_out: proc_refveg_carbon()\n");
-        return ERROR_MEM;
-    }
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        soil_carbon_array_cells[i] = calloc(ctry_aez_num[i], sizeof(int*));
-        if(soil_carbon_array_cells[i] == NULL) {
-            fprintf(fplog,"Failed to allocate memory for refveg_carbon_out[%i]: proc_refveg_carbon()\n", i);
-            return ERROR_MEM;
-        }
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            soil_carbon_array_cells[i][j] = calloc(num_lt_cats, sizeof(int));
-            if(soil_carbon_array_cells[i][j] == NULL) {
-                fprintf(fplog,"Failed to allocate memory for refveg_carbon_out[%i][%i]: proc_refveg_carbon()\n", i, j);
-                return ERROR_MEM;
-            }
-             // end for k loop over output values
-            } // end for j loop over aezs
-        }
-    
-  //Allocate the main soil_carbon_array
-    soil_carbon_array = calloc(NUM_FAO_CTRY, sizeof(float****));
-    if(soil_carbon_array == NULL) {
-        fprintf(fplog,"Failed to allocate memory for soil_carbon_array: proc_refveg_carbon()\n");
-        return ERROR_MEM;
-    }
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        soil_carbon_array[i] = calloc(ctry_aez_num[i], sizeof(float***));
-        if(soil_carbon_array[i] == NULL) {
-            fprintf(fplog,"Failed to allocate memory for soil_carbon_array[%i]: proc_refveg_carbon()\n", i);
-            return ERROR_MEM;
-        }
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            soil_carbon_array[i][j] = calloc(num_lt_cats, sizeof(float**));
-            if(soil_carbon_array[i][j] == NULL) {
-                fprintf(fplog,"Failed to allocate memory for soil_carbon_array[%i][%i]: proc_refveg_carbon()\n", i, j);
-                return ERROR_MEM;
-            }
-            for (k = 0; k < num_lt_cats; k++) {
-                soil_carbon_array[i][j][k] = calloc(NUM_CARBON, sizeof(float*));
-                if(soil_carbon_array[i][j][k] == NULL) {
-                    fprintf(fplog,"Failed to allocate memory for soil_carbon_array[%i][%i][%i]: proc_refveg_carbon()\n", i, j, k);
-                    return ERROR_MEM;
-                }//The last dimension will be assigned in read_soil_carbon.c
-                for (l = 0; l < NUM_CARBON; l++) {
-                soil_carbon_array[i][j][k][l] = calloc(array_cells, sizeof(float));
-                if(soil_carbon_array[i][j][k][l] == NULL) {
-                    fprintf(fplog,"Failed to allocate memory for soil_carbon_array[%i][%i][%i]: proc_refveg_carbon()\n", i, j, k);
-                    return ERROR_MEM;
-                }
-                }// end for k loop over output values
-            }// end for j loop over aezs
-        }// end for j loop over glus
-     }// end for i loop over fao country 
-    
-    //Allocate the vegetation carbon arrays
-    veg_carbon_array = calloc(NUM_FAO_CTRY, sizeof(float****));
-    if(veg_carbon_array == NULL) {
-        fprintf(fplog,"Failed to allocate memory for soil_carbon_array: proc_refveg_carbon()\n");
-        return ERROR_MEM;
-    }
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        veg_carbon_array[i] = calloc(ctry_aez_num[i], sizeof(float***));
-        if(veg_carbon_array[i] == NULL) {
-            fprintf(fplog,"Failed to allocate memory for soil_carbon_array[%i]: proc_refveg_carbon()\n", i);
-            return ERROR_MEM;
-        }
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            veg_carbon_array[i][j] = calloc(num_lt_cats, sizeof(float**));
-            if(veg_carbon_array[i][j] == NULL) {
-                fprintf(fplog,"Failed to allocate memory for soil_carbon_array[%i][%i]: proc_refveg_carbon()\n", i, j);
-                return ERROR_MEM;
-            }
-            for (k = 0; k < num_lt_cats; k++) {
-                veg_carbon_array[i][j][k] = calloc(NUM_CARBON, sizeof(float*));
-                if(veg_carbon_array[i][j][k] == NULL) {
-                    fprintf(fplog,"Failed to allocate memory for soil_carbon_array[%i][%i][%i]: proc_refveg_carbon()\n", i, j, k);
-                    return ERROR_MEM;
-                }//The last dimension will be assigned in read_soil_carbon.c
-                for (l = 0; l < NUM_CARBON; l++) {
-                veg_carbon_array[i][j][k][l] = calloc(array_cells, sizeof(float));
-                if(veg_carbon_array[i][j][k][l] == NULL) {
-                    fprintf(fplog,"Failed to allocate memory for soil_carbon_array[%i][%i][%i]: proc_refveg_carbon()\n", i, j, k);
-                    return ERROR_MEM;
-                }
-                }// end for k loop over output values
-            }// end for j loop over aezs
-        }// end for j loop over glus
-     }// end for i loop over fao country
-
-
-
-
-
-    //Call the read soil carbon function
-    if((error_code = read_soil_carbon(in_args, &raster_info))) {
-        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-        return error_code;
-    } 
-    
-    //kbn 2020/06/30 Add code for read_veg_c here
-    veg_carbon_sage = calloc(NUM_CARBON, sizeof(float*));
-    if(veg_carbon_sage == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for veg_carbon_sage: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    for (i = 0; i < NUM_CARBON; i++) {
-		veg_carbon_sage[i] = calloc(NUM_CELLS, sizeof(float));
-		if(veg_carbon_sage[i] == NULL) {
-			fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for veg_carbon_sage[%i]: main()\n", get_systime(), ERROR_MEM, i);
-			return ERROR_MEM;
-		}
-	}
-    
-    // Add above ground and below ground ratio for vegetation carbon
-    above_ground_ratio = calloc(NUM_CARBON, sizeof(float*));
-    if(above_ground_ratio == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for above_ground_ratio: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    for (i = 0; i < NUM_CARBON; i++) {
-		above_ground_ratio[i] = calloc(NUM_CELLS, sizeof(float));
-		if(above_ground_ratio[i] == NULL) {
-			fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for above_ground_ratio[%i]: main()\n", get_systime(), ERROR_MEM, i);
-			return ERROR_MEM;
-		}
-	}
-    
-    // Add above ground and below ground ratio for vegetation carbon
-    below_ground_ratio = calloc(NUM_CARBON, sizeof(float*));
-    if(below_ground_ratio == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for below_ground_ratio: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    for (i = 0; i < NUM_CARBON; i++) {
-		below_ground_ratio[i] = calloc(NUM_CELLS, sizeof(float));
-		if(below_ground_ratio[i] == NULL) {
-			fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for below_ground_ratio[%i]: main()\n", get_systime(), ERROR_MEM, i);
-			return ERROR_MEM;
-		}
-	}
-
-
-    if((error_code = read_veg_carbon(in_args, &raster_info))) {
-        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-        return error_code;
-    }
-
-
-    // process the land type area data
-    //  lu grids are allocated/freed within proc_land_type_area()
-    if((error_code = proc_land_type_area(in_args, raster_info))) {
-        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-        return error_code;
-    }
-    
-    // process the reference vegetation carbon data
-    //  needed arrays are allocated/freed within proc_refveg_carbon()
-	// the rand_order array that is allocated in calc_refvef_area is deallocated in proc_refveg_carbon
-    if((error_code = proc_refveg_carbon(in_args, raster_info))) {
-        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-        return error_code;
-    }
-    
-  //  fprintf(stdout, "\nStart freeing other carbon arrays %s\n", get_systime());
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            free(soil_carbon_array_cells[i][j]);
-        }free(soil_carbon_array_cells[i]);
-   }free(soil_carbon_array_cells);
-
-//fprintf(stdout, "\n Freed carbon array cells  %s\n", get_systime());
-       
-     
-  
-
-    // process the water footprint data
-    //  needed arrays are allocated/freed within proc_water_footprint()
- 
- //fprintf(stdout, "\n Start water footprint %s\n", get_systime());
- 
-    if((error_code = proc_water_footprint(in_args, raster_info))) {
-        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-        return error_code;
-    }
-	
-    // free the land type category array
-    free(lt_cats);
-    
-    // free some rasters
-	free(urban_area);
-	free(cell_area);
-	free(land_area_hyde);
-	free(cell_area_hyde);
-    free(land_cells_aez_new);
-    //kbn 2020
-    for (i = 0; i < NUM_EPA_PROTECTED; i++) {
-		free(protected_EPA[i]);
-	}
-	free(protected_EPA);
-    //kbn 2020/06/01 Add code for soil carbon here
-    for (i = 0; i < NUM_CARBON; i++) {
-		free(soil_carbon_sage[i]);
-	}
-	free(soil_carbon_sage);
-    //kbn 2020/06/30 Add code for veg carbon here
-    for (i = 0; i < NUM_CARBON; i++) {
-		free(veg_carbon_sage[i]);
-	}
-	free(veg_carbon_sage);
-    for (i = 0; i < NUM_CARBON; i++) {
-		free(above_ground_ratio[i]);
-	}
-	free(above_ground_ratio);
-    for (i = 0; i < NUM_CARBON; i++) {
-		free(below_ground_ratio[i]);
-	}
-	free(below_ground_ratio);
-    free(potveg_thematic);
-	free(refveg_thematic);
-    free(refvegcarbon_thematic);
-	for (i = 0; i < NUM_LULC_TYPES; i++) {
-		free(lulc_input_grid[i]);
-	}
-	free(lulc_input_grid);
-    //free soil and veg carbon arrays
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            for (k = 0; k < num_lt_cats; k++) {
-	           for(l=0; l< NUM_CARBON;l++){
-                   free(soil_carbon_array[i][j][k][l]);
-               }free(soil_carbon_array[i][j][k]);
-            }free(soil_carbon_array[i][j]);
-        }free(soil_carbon_array[i]);
-   }free(soil_carbon_array);
-   
-
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            for (k = 0; k < num_lt_cats; k++) {
-	           for(l=0; l<NUM_CARBON;l++){
-                   free(veg_carbon_array[i][j][k][l]);
-               }free(veg_carbon_array[i][j][k]);
-            }free(veg_carbon_array[i][j]);
-        }free(veg_carbon_array[i]);
-   }free(veg_carbon_array);
-  
- 
-
-    // allocate the arrays for all the fao input data (initialized to zero)
-    yield_fao = calloc(NUM_FAO_CTRY * NUM_SAGE_CROP * NUM_FAO_YRS, sizeof(float));
-    if(yield_fao == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for yield_fao: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    harvestarea_fao = calloc(NUM_FAO_CTRY * NUM_SAGE_CROP * NUM_FAO_YRS, sizeof(float));
-    if(harvestarea_fao == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for harvestarea_fao: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    production_fao = calloc(NUM_FAO_CTRY * NUM_SAGE_CROP * NUM_FAO_YRS, sizeof(float));
-    if(production_fao == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for production_fao: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    prodprice_fao_reglr = calloc(NUM_GTAP_CTRY87 * NUM_SAGE_CROP, sizeof(float));
-    if(prodprice_fao_reglr == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for prodprice_fao_reglr: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    
-    
-	// read in the FAO yield and harvest area data for optional harvested area and yield calibration
-	
-	// read FAO yield: yield_fao[NUM_FAO_CTRY * NUM_SAGE_CROP * NUM_FAO_YRS]
-	if((error_code = read_yield_fao(in_args))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-	// read FAO harvested area: harvestarea_fao[NUM_FAO_CTRY * NUM_SAGE_CROP * NUM_FAO_YRS]
-	if((error_code = read_harvestarea_fao(in_args))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-	// read in the FAO production data for disaggregating the land rents and re-calibrating yield and harvest inputs
-	// read FAO production: production_fao[NUM_FAO_CTRY * NUM_SAGE_CROP * NUM_FAO_YRS]
-	if((error_code = read_production_fao(in_args))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-    // allocate the arrays for reading in the sage crops (initialized to zero)
-    harvestarea_in = calloc(NUM_CELLS, sizeof(float));
-    if(harvestarea_in == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for harvestarea_in: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    yield_in = calloc(NUM_CELLS, sizeof(float));
-    if(yield_in == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for yield_in: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    
-    // allocate the output harvested area and production arrays, and the pasture area array (initialized to zero)
-    harvestarea_crop_aez = calloc(NUM_FAO_CTRY, sizeof(float**));
-    if(harvestarea_crop_aez == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for harvestarea_crop_aez: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        harvestarea_crop_aez[i] = calloc(ctry_aez_num[i], sizeof(float*));
-        if(harvestarea_crop_aez[i] == NULL) {
-            fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for harvestarea_crop_aez[%i]: main()\n", get_systime(), ERROR_MEM, i);
-            return ERROR_MEM;
-        }
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            harvestarea_crop_aez[i][j] = calloc(NUM_SAGE_CROP, sizeof(float));
-            if(harvestarea_crop_aez[i][j] == NULL) {
-                fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for harvestarea_crop_aez[%i][%i]: main()\n", get_systime(), ERROR_MEM, i, j);
-                return ERROR_MEM;
-            }
-        } // end for j loop over aezs
-    } // end for i loop over fao country
-    
-    production_crop_aez = calloc(NUM_FAO_CTRY, sizeof(float**));
-    if(production_crop_aez == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for production_crop_aez: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        production_crop_aez[i] = calloc(ctry_aez_num[i], sizeof(float*));
-        if(production_crop_aez[i] == NULL) {
-            fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for production_crop_aez[%i]: main()\n", get_systime(), ERROR_MEM, i);
-            return ERROR_MEM;
-        }
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            production_crop_aez[i][j] = calloc(NUM_SAGE_CROP, sizeof(float));
-            if(production_crop_aez[i][j] == NULL) {
-                fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for production_crop_aez[%i][%i]: main()\n", get_systime(), ERROR_MEM, i, j);
-                return ERROR_MEM;
-            }
-        } // end for j loop over aezs
-    } // end for i loop over fao country
-    
-    pasturearea_aez = calloc(NUM_FAO_CTRY, sizeof(float*));
-    if(pasturearea_aez == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for pasturearea_aez: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        pasturearea_aez[i] = calloc(ctry_aez_num[i], sizeof(float));
-        if(pasturearea_aez[i] == NULL) {
-            fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for pasturearea_aez[%i]: main()\n", get_systime(), ERROR_MEM, i);
-            return ERROR_MEM;
-        }
-    } // end for i loop over fao country
-	
-	////
-	// get the sage physical cropland area for normalizing the crop inputs
-	// allocate the raster array
-	cropland_area_sage = calloc(NUM_CELLS, sizeof(float));
-	if(cropland_area_sage == NULL) {
-		fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for cropland_area_sage: main()\n", get_systime(), ERROR_MEM);
-		return ERROR_MEM;
-	}
-	if((error_code = read_cropland_sage(in_args, &raster_info))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-	// calculate harvested area and production for SAGE_crop from FAO-calibrated SAGE crop data
-	//		read in data and perform calcs one crop at a time
-	//			these crop data are normalized to sage physical crop area then applied to hyde physical crop area
-	//				so that the input production is represented on a potentially different land base
-	//		if desired, calibrate SAGE crop harvested area to FAO PRODSTAT crop harvested area for a different reference year
-	//		if desired, calibrate SAGE crop yield to FAO PRODSTAT national production for a different reference year
-	//			original GTAP reference year is the same as the SAGE data (ca. 2000 as average of 1997-2003)
-	//			pixel-by-pixel calibration to country level data
-	//		calculate output values: country by aez by SAGE_crop
-	//			harvestarea_crop_aez[NUM_FAO_CTRY][ctry_aez_num][NUM_SAGE_CROP]
-	//			production_crop_aez[NUM_FAO_CTRY][ctry_aez_num][NUM_SAGE_CROP]
-	if((error_code = calc_harvarea_prod_out_crop_aez(in_args, raster_info))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-    // free some raster arrays
-    free(harvestarea_in);
-    free(yield_in);
-    free(pasture_area);
-    free(country_fao);
-    free(land_area_sage);
-    free(land_mask_ctryaez);
-    free(land_cells_sage);
-	free(cropland_area);
-	free(cropland_area_sage);
-	for (i = 0; i < NUM_HYDE_TYPES - NUM_HYDE_TYPES_MAIN; i++) {
-		free(lu_detail_area[i]);
-	}
-	free(lu_detail_area);
-	
-	// aggregate harvest area and production to gcam land units
-	if((error_code = aggregate_crop2gcam(in_args))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-	// write the output harvested area and production values
-	if((error_code = write_harvestarea_crop_aez(in_args))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	if((error_code = write_production_crop_aez(in_args))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-	//////////////////
-	// land rents
-	
-    // allocate the original input and new output land rent arrays (initialized to zero)
-    rent_orig_aez = calloc(NUM_GTAP_CTRY87 * NUM_GTAP_USE * NUM_ORIG_AEZ, sizeof(float));
-    if(rent_orig_aez == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for rent_orig_aez: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    rent_use_aez = calloc(NUM_GTAP_CTRY87, sizeof(float**));
-    if(rent_use_aez == NULL) {
-        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for rent_use_aez: main()\n", get_systime(), ERROR_MEM);
-        return ERROR_MEM;
-    }
-    for (i = 0; i < NUM_GTAP_CTRY87; i++) {
-        rent_use_aez[i] = calloc(reglr_aez_num[i], sizeof(float*));
-        if(rent_use_aez[i] == NULL) {
-            fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for rent_use_aez[%i]: main()\n", get_systime(), ERROR_MEM, i);
-            return ERROR_MEM;
-        }
-        for (j = 0; j < reglr_aez_num[i]; j++) {
-            rent_use_aez[i][j] = calloc(NUM_GTAP_USE, sizeof(float));
-            if(rent_use_aez[i][j] == NULL) {
-                fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for rent_use_aez[%i][%i]: main()\n", get_systime(), ERROR_MEM, i, j);
-                return ERROR_MEM;
-            }
-        } // end for j loop over aezs
-    } // end for i loop over fao country
-    
-	// read in original AgLU GTAP land rent data and fao price data needed for calculating new land rents
-	
-	// read original AgLU GTAP land rent: rent_orig_aez[NUM_GTAP_CTRY87 * NUM_GTAP_USE * NUM_ORIG_AEZ]
-	if((error_code = read_rent_orig(in_args))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-	// read FAO producer prices: prodprice_fao[NUM_FAO_CTRY * NUM_FAO_CROP]
-	if((error_code = read_prodprice_fao(in_args))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-	// calculate agricultural (including livestock) land rent values for new AEZs by GTAP_use
-	//		current GTAP reference year is ca. 2000
-	if((error_code = calc_rent_ag_use_aez(in_args, raster_info))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	 
-	// calculate forest land rent values for new AEZs by GTAP_use
-	//		current GTAP reference year is ca. 2000
-	if((error_code = calc_rent_frs_use_aez(in_args, raster_info))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	 
-    // free some raster arrays
-    free(aez_bounds_new);
-    free(aez_bounds_orig);
-    free(refveg_area);
-    free(refcarbon_area);
-    free(country87_gtap);
-    free(forest_cells);
-    free(land_cells_hyde);
-    free(missing_aez_mask);
-    
-	// write the land rent values
-	if((error_code = write_rent_use_aez(in_args))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-		return error_code;
-	}
-	
-	// aggregate land rent to gcam land units
-	if((error_code = aggregate_use2gcam(in_args))) {
-		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+	if (error_code != OK) {
+		fprintf(stderr, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
 		return error_code;
 	}
-	
-    // copy the gcam data system input files to the LDS destination directory
-    if((error_code = copy_to_destpath(in_args))) {
-        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
-        return error_code;
-    }
-   
-   // free the hong kong and taiwan glu area arrays
-   free(twn_glu_area);
-   free(hkg_glu_area);
-   
-    // free the reglr+aez arrays
-    for (i = 0; i < NUM_GTAP_CTRY87; i++) {
-        free(reglr_aez_list[i]);
-    }
-    free(reglr_aez_list);
-    
-    // free the country+aez arrays
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        free(ctry_aez_list[i]);
-    }
-    free(ctry_aez_list);
-    
-    // free the gcam+aez arrays
-    for (i = 0; i < NUM_GCAM_RGN; i++) {
-        free(reggcam_aez_list[i]);
-    }
-    free(reggcam_aez_list);
-
-    // free the info arrays
-    free(countrycodes_fao);
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        free(countryabbrs_iso[i]);
-        free(countrynames_fao[i]);
-        free(ctry2ctry87abbrs_gtap[i]);
-    }
-    free(countryabbrs_iso);
-    free(countrynames_fao);
-    free(ctry2ctry87codes_gtap);
-    free(ctry2ctry87abbrs_gtap);
-    free(country87codes_gtap);
-    for (i = 0; i < NUM_GTAP_CTRY87; i++) {
-        free(country87names_gtap[i]);
-        free(country87abbrs_gtap[i]);
-    }
-    free(country87names_gtap);
-    free(country87abbrs_gtap);
-    free(regioncodes_gcam);
-    for (i = 0; i < NUM_GCAM_RGN; i++) {
-        free(regionnames_gcam[i]);
-    }
-    free(regionnames_gcam);
-    free(ctry2regioncodes_gcam);
-    free(country_gcamiso2regioncodes_gcam);
-    for (i = 0; i < NUM_GCAM_ISO_CTRY; i++) {
-        free(countryabbrs_gcam_iso[i]);
-    }
-    free(countryabbrs_gcam_iso);
-    free(aez_codes_new);
-    for (i = 0; i < NUM_NEW_AEZ; i++) {
-        free(aez_names_new[i]);
-    }
-    free(aez_names_new);
-    free(usecodes_gtap);
-    for (i = 0; i < NUM_GTAP_USE; i++) {
-        free(usenames_gtap[i]);
-        free(usedescr_gtap[i]);
-    }
-    free(usenames_gtap);
-    free(usedescr_gtap);
-    free(landtypecodes_sage);
-    for (i = 0; i < NUM_SAGE_PVLT; i++) {
-        free(landtypenames_sage[i]);
-    }
-    free(landtypenames_sage);
-    free(cropcodes_sage);
-    free(crop_sage2gtap_use);
-    free(cropcodes_sage2fao);
-    for (i = 0; i < NUM_SAGE_CROP; i++) {
-        free(cropnames_gtap[i]);
-        free(cropdescr_sage[i]);
-        free(cropfilebase_sage[i]);
-        free(cropnames_sage2fao[i]);
-    }
-    free(cropnames_gtap);
-    free(cropdescr_sage);
-    free(cropfilebase_sage);
-    free(cropnames_sage2fao);
-	
-	free(lutypecodes_hyde);
-	free(lulccodes);
-	free(lulc2sagecodes);
-	free(lulc2hydecodes);
-	for (i = 0; i < NUM_HYDE_TYPES; i++) {
-		free(lutypenames_hyde[i]);
-	}
-	for (i = 0; i < NUM_LULC_TYPES; i++) {
-		free(lulcnames[i]);
-	}
-	free(lulcnames);
-	
-    // free the fao input data arrays
-    free(yield_fao);
-    free(harvestarea_fao);
-    free(production_fao);
-    free(prodprice_fao_reglr);
-    
-    // free the original land rent array
-    free(rent_orig_aez);
-    
-    // free the output and associated arrays
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            free(harvestarea_crop_aez[i][j]);
-            free(production_crop_aez[i][j]);
-        }
-        free(harvestarea_crop_aez[i]);
-        free(production_crop_aez[i]);
-        free(pasturearea_aez[i]);
-    }
-    free(harvestarea_crop_aez);
-    free(production_crop_aez);
-    free(pasturearea_aez);
-    for (i = 0; i < NUM_GTAP_CTRY87; i++) {
-        for (j = 0; j < reglr_aez_num[i]; j++) {
-            free(rent_use_aez[i][j]);
-        }
-        free(rent_use_aez[i]);
-    }
-    free(rent_use_aez);
-    
-    free(reglr_aez_num);
-    free(ctry_aez_num);
-    free(reggcam_aez_num);
     
     fprintf(stdout, "\nSuccessful completion of program %s at %s\n", CODENAME, get_systime());
-    
-	fprintf(fplog, "\nSuccessful completion of program %s at %s\n", CODENAME, get_systime());
-	fclose(fplog);
-	
-	//fclose(debug_file);
-	//fclose(cell_file);
 	
     return OK;}	// end moirai_main()
@@ -0,0 +1,280 @@
+/**********
+ moirai_serve.c
+
+ run moirai as a resident server that accepts run requests over a local unix socket: moirai --serve <socket path>
+    the server keeps the static base rasters in memory between requests (see raster_cache.c),
+    so only the first request that uses a raster reads it from disk, and later requests copy it from memory
+    a raster file that is modified or replaced between requests is read again
+    it also keeps the glu independent rasters and reference year areas that a request calculated (see serve_stages.c),
+    and processes only the stages whose input arguments or input files changed since the previous request
+
+ a client connects to the socket and sends one request line:
+    <input control file name with path> [<name>=<value> ...] [reply=tables]
+        run moirai with this input file, as moirai <input control file> would,
+        with the values of the named input arguments replaced (see get_in_args.c), e.g. diagnostics=1 outpath=./test/
+        reply=tables also sends the content of each csv table that is written
+    quit: stop the server
+ the server writes its replies on the same connection, one line each:
+    started <input control file name> [<name>=<value> ...]
+    stage <stage name> processed|kept|restored	(one line for each serve stage of a successful run; see serve_stages.c)
+    output <output file name with path> <size in bytes>
+        (one line for each file in the outpath of a successful run, and in its glu scenario subdirectories;
+        with reply=tables the line of a .csv file is followed by its size in bytes of file content)
+    done <error code> <outpath>				(error code 0 = OK; the run log in outpath has the details;
+												no outpath if the input control file could not be read)
+ the output files of a kept stage are the ones written by an earlier request to the same outpath
+    and those of a restored stage are copied from its checkpoint (see checkpoint.c)
+ for example, with socat:
+    echo "input_files/moirai_input_basins235.txt diagnostics=1" | socat -t 3600 - UNIX-CONNECT:/tmp/moirai.sock
+
+ requests are run one at a time, in the order they connect, because a process runs one context at a time (see libmoirai.h)
+    the server path names are relative to the working directory of the server
+
+ arguments:
+ const char *socket_path:	the unix socket file name, with path; an existing socket file is replaced
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "moirai.h"
+#include <signal.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#define SERVE_BACKLOG	16		// number of connections that can wait while a request runs
+
+// read one request line from the client; returns the length, or -1 if the client closed without a line
+static int read_request(int connfd, char *request) {
+
+	int len = 0;
+	char c;
+
+	while (len < MAXCHAR - 1 && read(connfd, &c, 1) == 1) {
+		if (c == '\n') {
+			break;
+		}
+		request[len++] = c;
+	}
+	request[len] = '\0';
+	// drop a trailing \r and blanks
+	while (len > 0 && isspace((unsigned char) request[len - 1])) {
+		request[--len] = '\0';
+	}
+	return (len == 0) ? -1 : len;
+}
+
+// split the request into the input control file name, the input argument overrides, and the reply option
+static int parse_request(const char *request, char *input_fname, char *overrides, int *send_tables) {
+
+	char req_str[MAXCHAR];
+	char *tok;
+
+	strcpy(req_str, request);
+	input_fname[0] = '\0';
+	overrides[0] = '\0';
+	*send_tables = 0;
+	for (tok = strtok(req_str, " \t"); tok != NULL; tok = strtok(NULL, " \t")) {
+		if (input_fname[0] == '\0') {
+			strcpy(input_fname, tok);
+		} else if (strcmp(tok, "reply=tables") == 0) {
+			*send_tables = 1;
+		} else if (strcmp(tok, "reply=files") == 0) {
+			*send_tables = 0;
+		} else {
+			if (overrides[0] != '\0') {
+				strcat(overrides, " ");
+			}
+			strcat(overrides, tok);
+		}
+	}
+	return OK;
+}
+
+// send the content of a file after its output line
+static void send_file(int connfd, const char *fname) {
+
+	FILE *fpin;
+	char buf[MAXRECSIZE];
+	size_t num_read;
+
+	if ((fpin = fopen(fname, "rb")) == NULL) {
+		return;
+	}
+	while ((num_read = fread(buf, 1, sizeof(buf), fpin)) > 0) {
+		if (write(connfd, buf, num_read) != (ssize_t) num_read) {
+			break;
+		}
+	}
+	fclose(fpin);
+}
+
+// list the files in the outpath of the run, and in its glu scenario subdirectories
+static void send_outputs(int connfd, const char *outpath, int send_tables, int depth) {
+
+	DIR *dir;
+	struct dirent *dent;
+	struct stat fileinfo;
+	char fname[MAXCHAR];
+	size_t len;
+
+	if ((dir = opendir(outpath)) == NULL) {
+		return;
+	}
+	while ((dent = readdir(dir)) != NULL) {
+		if (strcmp(dent->d_name, ".") == 0 || strcmp(dent->d_name, "..") == 0 ||
+			strlen(outpath) + strlen(dent->d_name) + 1 >= MAXCHAR) {
+			continue;
+		}
+		strcpy(fname, outpath);
+		strcat(fname, dent->d_name);
+		if (stat(fname, &fileinfo) != 0) {
+			continue;
+		}
+		if (S_ISREG(fileinfo.st_mode)) {
+			dprintf(connfd, "output %s %lld\n", fname, (long long) fileinfo.st_size);
+			len = strlen(fname);
+			if (send_tables && len > 4 && strcmp(fname + len - 4, ".csv") == 0) {
+				send_file(connfd, fname);
+			}
+		} else if (S_ISDIR(fileinfo.st_mode) && depth == 0) {
+			strcat(fname, "/");
+			send_outputs(connfd, fname, send_tables, depth + 1);
+		}
+	}
+	closedir(dir);
+}
+
+// send the status of the serve stages of the run
+static void send_stages(int connfd) {
+
+	int stage, status;
+	const char *name;
+
+	for (stage = 0; stage < NUM_SERVE_STAGES; stage++) {
+		name = get_serve_stage(stage, &status);
+		dprintf(connfd, "stage %s %s\n", name, (status == SERVE_RUN) ? "processed" : ((status == SERVE_KEPT) ? "kept" : "restored"));
+	}
+}
+
+int moirai_serve(const char *socket_path) {
+
+	int listenfd, connfd;			// the listening socket and the client connection
+	struct sockaddr_un addr;		// the socket address
+	char request[MAXCHAR];			// the request line
+	char input_fname[MAXCHAR];		// the input control file of the request
+	char overrides[MAXCHAR];		// the input argument overrides of the request
+	int send_tables;				// 1 = send the content of the csv tables
+	moirai_ctx *ctx;				// the run context of the request
+	int num_requests = 0;			// number of runs
+	int error_code = OK;			// 0 = ok; non-zero = error
+	int free_error;					// error code of freeing a request context
+
+	if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "Socket path %s is too long: moirai_serve()\n", socket_path);
+		return ERROR_USAGE;
+	}
+
+	// a client that disconnects during a run must not end the server; its replies are dropped
+	signal(SIGPIPE, SIG_IGN);
+
+	if ((listenfd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+		fprintf(stderr, "Failed to create socket %s: moirai_serve()\n", socket_path);
+		return ERROR_FILE;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, socket_path);
+	unlink(socket_path);
+	if (bind(listenfd, (struct sockaddr *) &addr, sizeof(addr)) < 0 || listen(listenfd, SERVE_BACKLOG) < 0) {
+		fprintf(stderr, "Failed to bind socket %s: moirai_serve()\n", socket_path);
+		close(listenfd);
+		return ERROR_FILE;
+	}
+
+	// keep the base rasters, and the shared rasters that the requests calculate, between requests
+	init_raster_cache();
+	start_serve_stages();
+
+	fprintf(stdout, "\n%s serving requests on %s at %s\n", CODENAME, socket_path, get_systime());
+	fflush(stdout);
+
+	while (1) {
+		if ((connfd = accept(listenfd, NULL, NULL)) < 0) {
+			fprintf(stderr, "Failed to accept a connection on %s: moirai_serve()\n", socket_path);
+			error_code = ERROR_FILE;
+			break;
+		}
+		if (read_request(connfd, request) < 0) {
+			close(connfd);
+			continue;
+		}
+		if (strcmp(request, "quit") == 0) {
+			dprintf(connfd, "bye\n");
+			close(connfd);
+			break;
+		}
+
+		num_requests++;
+		fprintf(stdout, "\nRequest %i (%s) started at %s\n", num_requests, request, get_systime());
+		fflush(stdout);
+		dprintf(connfd, "started %s\n", request);
+
+		// run the request as moirai_main() does
+		parse_request(request, input_fname, overrides, &send_tables);
+		if ((ctx = moirai_ctx_create_overrides(input_fname, overrides, &error_code)) == NULL) {
+			dprintf(connfd, "done %i\n", error_code);
+		} else {
+			if ((error_code = moirai_ctx_run(ctx)) == OK) {
+				send_stages(connfd);
+				send_outputs(connfd, moirai_ctx_outpath(ctx), send_tables, 0);
+			}
+			dprintf(connfd, "done %i %s\n", error_code, moirai_ctx_outpath(ctx));
+			if ((free_error = moirai_ctx_free(ctx)) != OK && error_code == OK) {
+				error_code = free_error;
+			}
+		}
+		fprintf(stdout, "\nRequest %i ended at %s with error_code = %i\n", num_requests, get_systime(), error_code);
+		fflush(stdout);
+		close(connfd);
+		// a failed request does not stop the server
+		error_code = OK;
+	}
+
+	close(listenfd);
+	unlink(socket_path);
+	stop_serve_stages();
+	free_raster_cache();
+
+	fprintf(stdout, "\n%s server stopped at %s after %i requests\n", CODENAME, get_systime(), num_requests);
+
+	return error_code;}
@@ -0,0 +1,284 @@
+/**********
+ nc_access.c
+
+ the netcdf access layer for the readers of large netcdf inputs (read_sage_crop(), read_lulc_isam())
+    open handles are kept and reused, so a file read one latitude band at a time is opened only once
+        up to NC_ACCESS_MAX_OPEN files are kept open; the least recently used file is closed to open another
+        nc_access_close_all() closes them at the end of the reading stage, and at the end of the run (see moirai_ctx.c)
+    the chunk cache of a chunked (netcdf-4) variable is sized from its chunking when the variable is first used:
+        it holds one row of chunks across all the other dimensions, so reading the grid one band of rows at a time
+        reads each chunk once; it is capped at NC_ACCESS_MAX_CACHE bytes
+        classic format files have no chunks and no chunk cache
+    each read is timed and added to the reader's i/o in the stage profile (see add_stage_reads() in stage_profile.c)
+ the readers fuse adjacent levels into one hyperslab read, e.g. the four sage crop levels of a band
+
+ the netcdf library is not thread safe, so the files are opened and read one at a time
+    instead of reading files concurrently, nc_access_prefetch() asks the kernel to read the next file ahead
+        in the background, so its disk reads overlap the processing of the current file
+
+ functions:
+ nc_access_open():			get an open handle for fname
+ nc_access_varid():			get the id of varname, and size its chunk cache on first use
+ nc_access_read_float():	read a float hyperslab of a variable and account it to the reader
+ nc_access_close():			close one handle, for a file that is read once
+ nc_access_close_all():		close all handles
+ nc_access_prefetch():		start an asynchronous kernel read-ahead of a file that will be opened next
+
+ arguments:
+ const char *fname:		the file name, with path
+ int *ncid:				the netcdf file id
+ int ncid:				the netcdf file id
+ const char *varname:	the variable name
+ int *varid:			the netcdf variable id
+ int varid:				the netcdf variable id
+ const size_t *start:	start index of the hyperslab in each dimension
+ const size_t *count:	length of the hyperslab in each dimension
+ float *data:			the array to fill
+ const char *reader:	the name of the reading function, for the stage profile and the trace
+
+ return value:
+ the netcdf error code, as for the netcdf functions: NC_NOERR = 0, otherwise a netcdf error code
+ nc_access_prefetch() returns 0, or the posix_fadvise() error number; a failed read-ahead does not stop the run
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "moirai.h"
+
+#define NC_ACCESS_MAX_OPEN		256					// maximum number of open handles
+#define NC_ACCESS_MAX_VARS		8					// variables per handle with a sized chunk cache
+#define NC_ACCESS_MAX_CACHE		(64 * 1048576)		// maximum chunk cache size per variable (bytes)
+
+// one open file
+typedef struct {
+	char fname[MAXCHAR];			// file name with path
+	int ncid;						// netcdf file id
+	long last_use;					// use counter value at the last open
+	int num_vars;					// number of variables with a sized chunk cache
+	int varids[NC_ACCESS_MAX_VARS];	// the variables with a sized chunk cache
+} nc_handle_struct;
+
+static nc_handle_struct nc_handles[NC_ACCESS_MAX_OPEN];
+static int num_nc_handles = 0;
+static long nc_use_count = 0;
+
+// wall clock, seconds
+static double get_wall_sec(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + (double) ts.tv_nsec / 1.0e9;
+}
+
+// the handle index of ncid; NOMATCH if it is not held here
+static int find_handle(int ncid) {
+	int i;
+	for (i = 0; i < num_nc_handles; i++) {
+		if (nc_handles[i].ncid == ncid) {
+			return i;
+		}
+	}
+	return NOMATCH;
+}
+
+// close and drop handle i
+static int drop_handle(int i) {
+	int ncerr = nc_close(nc_handles[i].ncid);
+	nc_handles[i] = nc_handles[--num_nc_handles];
+	return ncerr;
+}
+
+// size the chunk cache of a chunked variable for reading one row of chunks at a time
+static void size_chunk_cache(int ncid, int varid) {
+
+	int i;
+	int format;						// file format
+	int storage;					// NC_CHUNKED or NC_CONTIGUOUS
+	int ndims;						// number of dimensions of the variable
+	int dimids[NC_MAX_VAR_DIMS];	// dimension ids
+	size_t chunks[NC_MAX_VAR_DIMS];	// chunk lengths
+	size_t dimlen;					// dimension length
+	nc_type xtype;					// variable type
+	size_t type_size;				// bytes per value
+	size_t cache_size;				// chunk cache bytes
+	size_t nelems;					// number of chunks in the cache
+	size_t old_size, old_nelems;	// the current chunk cache
+	float preemption;				// the current preemption; kept
+
+	if (nc_inq_format(ncid, &format) || (format != NC_FORMAT_NETCDF4 && format != NC_FORMAT_NETCDF4_CLASSIC)) {
+		return;
+	}
+	if (nc_inq_var_chunking(ncid, varid, &storage, chunks) || storage != NC_CHUNKED ||
+		nc_inq_varndims(ncid, varid, &ndims) || nc_inq_vardimid(ncid, varid, dimids) ||
+		nc_inq_vartype(ncid, varid, &xtype) || nc_inq_type(ncid, xtype, NULL, &type_size)) {
+		return;
+	}
+
+	// all the chunks of one row of chunks: the row dimension is the second last (lat, lon)
+	cache_size = type_size;
+	nelems = 1;
+	for (i = 0; i < ndims; i++) {
+		cache_size *= chunks[i];
+		if (i != ndims - 2 && nc_inq_dimlen(ncid, dimids[i], &dimlen) == NC_NOERR && chunks[i] > 0) {
+			nelems *= (dimlen + chunks[i] - 1) / chunks[i];
+		}
+	}
+	cache_size *= nelems;
+	if (cache_size > NC_ACCESS_MAX_CACHE) {
+		nelems = nelems * NC_ACCESS_MAX_CACHE / cache_size;
+		cache_size = NC_ACCESS_MAX_CACHE;
+	}
+	if (nelems < 1) {
+		nelems = 1;
+	}
+	if (nc_get_var_chunk_cache(ncid, varid, &old_size, &old_nelems, &preemption) == NC_NOERR) {
+		nc_set_var_chunk_cache(ncid, varid, cache_size, nelems, preemption);
+	}
+}
+
+int nc_access_open(const char *fname, int *ncid) {
+
+	int i;
+	int lru = 0;					// least recently used handle
+	int ncerr;
+
+	nc_use_count++;
+	for (i = 0; i < num_nc_handles; i++) {
+		if (strcmp(nc_handles[i].fname, fname) == 0) {
+			nc_handles[i].last_use = nc_use_count;
+			*ncid = nc_handles[i].ncid;
+			return NC_NOERR;
+		}
+		if (nc_handles[i].last_use < nc_handles[lru].last_use) {
+			lru = i;
+		}
+	}
+
+	if (num_nc_handles == NC_ACCESS_MAX_OPEN) {
+		drop_handle(lru);
+	}
+	trace_begin("io", "nc_open %s", fname);
+	ncerr = nc_open(fname, NC_NOWRITE, ncid);
+	trace_end();
+	if (ncerr) {
+		return ncerr;
+	}
+	if (strlen(fname) < MAXCHAR) {
+		strcpy(nc_handles[num_nc_handles].fname, fname);
+		nc_handles[num_nc_handles].ncid = *ncid;
+		nc_handles[num_nc_handles].last_use = nc_use_count;
+		nc_handles[num_nc_handles].num_vars = 0;
+		num_nc_handles++;
+	}
+
+	return NC_NOERR;}
+
+int nc_access_varid(int ncid, const char *varname, int *varid) {
+
+	int i, h;
+	int ncerr;
+
+	if ((ncerr = nc_inq_varid(ncid, varname, varid))) {
+		return ncerr;
+	}
+	if ((h = find_handle(ncid)) == NOMATCH) {
+		return NC_NOERR;
+	}
+	for (i = 0; i < nc_handles[h].num_vars; i++) {
+		if (nc_handles[h].varids[i] == *varid) {
+			return NC_NOERR;
+		}
+	}
+	size_chunk_cache(ncid, *varid);
+	if (nc_handles[h].num_vars < NC_ACCESS_MAX_VARS) {
+		nc_handles[h].varids[nc_handles[h].num_vars++] = *varid;
+	}
+
+	return NC_NOERR;}
+
+int nc_access_read_float(int ncid, int varid, const size_t *start, const size_t *count, float *data, const char *reader) {
+
+	int i;
+	int ncerr;
+	int ndims;						// number of dimensions of the variable
+	long long nbytes;				// bytes read
+	double start_wall;				// read start time
+
+	if ((ncerr = nc_inq_varndims(ncid, varid, &ndims))) {
+		return ncerr;
+	}
+	nbytes = sizeof(float);
+	for (i = 0; i < ndims; i++) {
+		nbytes *= (long long) count[i];
+	}
+
+	trace_begin("io", "nc_get_vara_float %s", reader);
+	start_wall = get_wall_sec();
+	ncerr = nc_get_vara_float(ncid, varid, start, count, data);
+	add_stage_reads(reader, ncerr ? 0 : nbytes, get_wall_sec() - start_wall);
+	trace_end();
+
+	return ncerr;}
+
+int nc_access_close(int ncid) {
+
+	int h;
+
+	if ((h = find_handle(ncid)) == NOMATCH) {
+		return nc_close(ncid);
+	}
+	return drop_handle(h);}
+
+int nc_access_close_all(void) {
+
+	int ncerr = NC_NOERR;
+	int err;
+
+	while (num_nc_handles > 0) {
+		if ((err = drop_handle(num_nc_handles - 1))) {
+			ncerr = err;
+		}
+	}
+	nc_use_count = 0;
+
+	return ncerr;}
+
+int nc_access_prefetch(const char *fname) {
+
+	int fd;
+	int err;
+
+	// a file that does not exist yet (e.g. still zipped) is not an error; it is read without the read-ahead
+	if ((fd = open(fname, O_RDONLY)) < 0) {
+		return NC_NOERR;
+	}
+	err = posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+	close(fd);
+
+	return err;}
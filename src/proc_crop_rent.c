@@ -0,0 +1,310 @@
+/**********
+ proc_crop_rent.c
+
+ calculate the crop harvested area and production and the land rents of one glu scenario, and write them
+    this is the crop and land rent part of proc_glu_scenario(): the fao tables, the sage crops, and the gtap land rents
+    the land rents use the crop production, so these stages are processed together
+    serve mode does not call this if its inputs are the same as in the previous request (see serve_stages.c)
+ the fao tables and the original land rent do not depend on the glus,
+    so they are read with the first glu scenario and freed with the last one
+ the glu dependent output arrays are allocated here for each scenario
+    they are freed at the end of the scenario, and the fao tables with the last one, by free_glu_tables()
+    which moirai_ctx.c also calls when a stage fails
+
+ arguments:
+ args_struct in_args: the input file arguments for this scenario
+ rinfo_struct *raster_info: information about input raster data
+ int scen_ind: the index of the scenario in glu_scen
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#include "moirai.h"
+
+int proc_crop_rent(args_struct in_args, rinfo_struct *raster_info, int scen_ind) {
+    
+    int i, j;
+	
+	// for code control
+	int error_code = OK;		// 0 = ok; non-zero = error
+	
+    // the fao tables do not depend on the glus, so they are read with the first glu scenario and freed with the last one
+	if (scen_ind == 0) {
+	    // allocate the arrays for all the fao input data (initialized to zero)
+	    yield_fao = calloc(NUM_FAO_CTRY * NUM_SAGE_CROP * NUM_FAO_YRS, sizeof(float));
+	    if(yield_fao == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for yield_fao: proc_crop_rent()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+	    harvestarea_fao = calloc(NUM_FAO_CTRY * NUM_SAGE_CROP * NUM_FAO_YRS, sizeof(float));
+	    if(harvestarea_fao == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for harvestarea_fao: proc_crop_rent()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+	    production_fao = calloc(NUM_FAO_CTRY * NUM_SAGE_CROP * NUM_FAO_YRS, sizeof(float));
+	    if(production_fao == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for production_fao: proc_crop_rent()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+	    prodprice_fao_reglr = calloc(NUM_GTAP_CTRY87 * NUM_SAGE_CROP, sizeof(float));
+	    if(prodprice_fao_reglr == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for prodprice_fao_reglr: proc_crop_rent()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+    
+		// read in the FAO yield and harvest area data for optional harvested area and yield calibration
+	
+		// read FAO yield: yield_fao[NUM_FAO_CTRY * NUM_SAGE_CROP * NUM_FAO_YRS]
+		start_stage("read_yield_fao");
+		if((error_code = read_yield_fao(in_args))) {
+			fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+			return error_code;
+		}
+		end_stage();
+	
+		// read FAO harvested area: harvestarea_fao[NUM_FAO_CTRY * NUM_SAGE_CROP * NUM_FAO_YRS]
+		start_stage("read_harvestarea_fao");
+		if((error_code = read_harvestarea_fao(in_args))) {
+			fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+			return error_code;
+		}
+		end_stage();
+	
+		// read in the FAO production data for disaggregating the land rents and re-calibrating yield and harvest inputs
+		// read FAO production: production_fao[NUM_FAO_CTRY * NUM_SAGE_CROP * NUM_FAO_YRS]
+		start_stage("read_production_fao");
+		if((error_code = read_production_fao(in_args))) {
+			fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+			return error_code;
+		}
+		end_stage();
+	}
+	
+    // allocate the arrays for reading in the sage crops (initialized to zero)
+    // these hold one latitude band of the working grid
+    harvestarea_in = calloc(raster_info->band_nrows * NUM_LON, sizeof(float));
+    if(harvestarea_in == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for harvestarea_in: proc_crop_rent()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    yield_in = calloc(raster_info->band_nrows * NUM_LON, sizeof(float));
+    if(yield_in == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for yield_in: proc_crop_rent()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    
+    // allocate the output harvested area and production arrays, and the pasture area array (initialized to zero)
+    harvestarea_crop_aez = calloc(NUM_FAO_CTRY, sizeof(float**));
+    if(harvestarea_crop_aez == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for harvestarea_crop_aez: proc_crop_rent()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    for (i = 0; i < NUM_FAO_CTRY; i++) {
+        harvestarea_crop_aez[i] = calloc(ctry_aez_num[i], sizeof(float*));
+        if(harvestarea_crop_aez[i] == NULL) {
+            fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for harvestarea_crop_aez[%i]: proc_crop_rent()\n", get_systime(), ERROR_MEM, i);
+            return ERROR_MEM;
+        }
+        for (j = 0; j < ctry_aez_num[i]; j++) {
+            harvestarea_crop_aez[i][j] = calloc(NUM_SAGE_CROP, sizeof(float));
+            if(harvestarea_crop_aez[i][j] == NULL) {
+                fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for harvestarea_crop_aez[%i][%i]: proc_crop_rent()\n", get_systime(), ERROR_MEM, i, j);
+                return ERROR_MEM;
+            }
+        } // end for j loop over aezs
+    } // end for i loop over fao country
+    
+    production_crop_aez = calloc(NUM_FAO_CTRY, sizeof(float**));
+    if(production_crop_aez == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for production_crop_aez: proc_crop_rent()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    for (i = 0; i < NUM_FAO_CTRY; i++) {
+        production_crop_aez[i] = calloc(ctry_aez_num[i], sizeof(float*));
+        if(production_crop_aez[i] == NULL) {
+            fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for production_crop_aez[%i]: proc_crop_rent()\n", get_systime(), ERROR_MEM, i);
+            return ERROR_MEM;
+        }
+        for (j = 0; j < ctry_aez_num[i]; j++) {
+            production_crop_aez[i][j] = calloc(NUM_SAGE_CROP, sizeof(float));
+            if(production_crop_aez[i][j] == NULL) {
+                fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for production_crop_aez[%i][%i]: proc_crop_rent()\n", get_systime(), ERROR_MEM, i, j);
+                return ERROR_MEM;
+            }
+        } // end for j loop over aezs
+    } // end for i loop over fao country
+    
+    pasturearea_aez = calloc(NUM_FAO_CTRY, sizeof(float*));
+    if(pasturearea_aez == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for pasturearea_aez: proc_crop_rent()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    for (i = 0; i < NUM_FAO_CTRY; i++) {
+        pasturearea_aez[i] = calloc(ctry_aez_num[i], sizeof(float));
+        if(pasturearea_aez[i] == NULL) {
+            fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for pasturearea_aez[%i]: proc_crop_rent()\n", get_systime(), ERROR_MEM, i);
+            return ERROR_MEM;
+        }
+    } // end for i loop over fao country
+	
+	// calculate harvested area and production for SAGE_crop from FAO-calibrated SAGE crop data
+	//		read in data and perform calcs one crop at a time
+	//			these crop data are normalized to sage physical crop area then applied to hyde physical crop area
+	//				so that the input production is represented on a potentially different land base
+	//		if desired, calibrate SAGE crop harvested area to FAO PRODSTAT crop harvested area for a different reference year
+	//		if desired, calibrate SAGE crop yield to FAO PRODSTAT national production for a different reference year
+	//			original GTAP reference year is the same as the SAGE data (ca. 2000 as average of 1997-2003)
+	//			pixel-by-pixel calibration to country level data
+	//		calculate output values: country by aez by SAGE_crop
+	//			harvestarea_crop_aez[NUM_FAO_CTRY][ctry_aez_num][NUM_SAGE_CROP]
+	//			production_crop_aez[NUM_FAO_CTRY][ctry_aez_num][NUM_SAGE_CROP]
+	start_stage("calc_harvarea_prod_out_crop_aez");
+	if((error_code = calc_harvarea_prod_out_crop_aez(in_args, *raster_info))) {
+		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+		return error_code;
+	}
+	end_stage();
+	
+    // free the crop band arrays
+    free(harvestarea_in);
+    harvestarea_in = NULL;
+    free(yield_in);
+    yield_in = NULL;
+	
+	// aggregate harvest area and production to gcam land units
+	start_stage("aggregate_crop2gcam");
+	if((error_code = aggregate_crop2gcam(in_args))) {
+		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+		return error_code;
+	}
+	end_stage();
+	
+	// write the output harvested area and production values
+	start_stage("write_harvestarea_crop_aez");
+	if((error_code = write_harvestarea_crop_aez(in_args))) {
+		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+		return error_code;
+	}
+	end_stage();
+	start_stage("write_production_crop_aez");
+	if((error_code = write_production_crop_aez(in_args))) {
+		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+		return error_code;
+	}
+	end_stage();
+	
+	//////////////////
+	// land rents
+	
+    // allocate the new output land rent arrays (initialized to zero)
+    rent_use_aez = calloc(NUM_GTAP_CTRY87, sizeof(float**));
+    if(rent_use_aez == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for rent_use_aez: proc_crop_rent()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    for (i = 0; i < NUM_GTAP_CTRY87; i++) {
+        rent_use_aez[i] = calloc(reglr_aez_num[i], sizeof(float*));
+        if(rent_use_aez[i] == NULL) {
+            fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for rent_use_aez[%i]: proc_crop_rent()\n", get_systime(), ERROR_MEM, i);
+            return ERROR_MEM;
+        }
+        for (j = 0; j < reglr_aez_num[i]; j++) {
+            rent_use_aez[i][j] = calloc(NUM_GTAP_USE, sizeof(float));
+            if(rent_use_aez[i][j] == NULL) {
+                fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for rent_use_aez[%i][%i]: proc_crop_rent()\n", get_systime(), ERROR_MEM, i, j);
+                return ERROR_MEM;
+            }
+        } // end for j loop over aezs
+    } // end for i loop over fao country
+    
+	// read in original AgLU GTAP land rent data and fao price data needed for calculating new land rents
+	// these do not depend on the glus, so they are read with the first glu scenario and freed with the last one
+	if (scen_ind == 0) {
+	    // allocate the original input land rent array (initialized to zero)
+	    rent_orig_aez = calloc(NUM_GTAP_CTRY87 * NUM_GTAP_USE * NUM_ORIG_AEZ, sizeof(float));
+	    if(rent_orig_aez == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for rent_orig_aez: proc_crop_rent()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+	
+		// read original AgLU GTAP land rent: rent_orig_aez[NUM_GTAP_CTRY87 * NUM_GTAP_USE * NUM_ORIG_AEZ]
+		start_stage("read_rent_orig");
+		if((error_code = read_rent_orig(in_args))) {
+			fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+			return error_code;
+		}
+		end_stage();
+	
+		// read FAO producer prices: prodprice_fao[NUM_FAO_CTRY * NUM_FAO_CROP]
+		start_stage("read_prodprice_fao");
+		if((error_code = read_prodprice_fao(in_args))) {
+			fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+			return error_code;
+		}
+		end_stage();
+	}
+	
+	// calculate agricultural (including livestock) land rent values for new AEZs by GTAP_use
+	//		current GTAP reference year is ca. 2000
+	start_stage("calc_rent_ag_use_aez");
+	if((error_code = calc_rent_ag_use_aez(in_args, *raster_info))) {
+		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+		return error_code;
+	}
+	end_stage();
+	 
+	// calculate forest land rent values for new AEZs by GTAP_use
+	//		current GTAP reference year is ca. 2000
+	start_stage("calc_rent_frs_use_aez");
+	if((error_code = calc_rent_frs_use_aez(in_args, *raster_info))) {
+		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+		return error_code;
+	}
+	end_stage();
+	 
+	// write the land rent values
+	start_stage("write_rent_use_aez");
+	if((error_code = write_rent_use_aez(in_args))) {
+		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+		return error_code;
+	}
+	end_stage();
+	
+	// aggregate land rent to gcam land units
+	start_stage("aggregate_use2gcam");
+	if((error_code = aggregate_use2gcam(in_args))) {
+		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+		return error_code;
+	}
+	end_stage();
+	
+
+    // the output arrays are freed at the end of the glu scenario, and the fao tables and the original land rent with the last one
+    //  see free_glu_tables.c
+    
+    return OK;}
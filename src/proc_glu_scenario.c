@@ -0,0 +1,830 @@
+/**********
+ proc_glu_scenario.c
+ 
+ run the moirai processing stages for one glu scenario: glu_scen[scen_ind]
+    main() sets the glu file names and output paths in in_args from the scenario, and calls this for each scenario in turn
+    see read_glu_batch.c for the glu batch file
+ 
+ the inputs that do not depend on the glus are read with the first scenario
+    these are the hyde, lulc, potveg, carbon, protected area and sage rasters, the fao tables and the gtap land rents
+    the reference vegetation and carbon areas are also calculated only with the first scenario
+    the diagnostics of these shared stages are written to the output path of the first scenario
+    the fao tables and land rents are freed with the last scenario, by free_glu_tables()
+    the rasters and reference year areas are freed at the end of the run by free_shared_rasters(),
+        or kept for the next request in serve mode, which then does not read them again (see serve_stages.c)
+ serve mode also skips the output stages whose inputs did not change since the previous request: see run_serve_stage()
+    and an output stage that is restored from a checkpoint is skipped in every scenario; it is saved after the last one
+ the glu dependent arrays are allocated here for each scenario and freed at its end by free_glu_tables()
+    except that the glu raster and the country+glu lists are held in glu_scen[scen_ind] until the end of the run
+    a failed stage returns at once, and moirai_ctx.c frees what is left with free_glu_tables(), so the freed pointers are set to NULL
+ the land type area is processed only with the last scenario, for all of the scenarios at once
+    because the hyde and lulc year loop of proc_land_type_area() is most of the run time
+    and it does not depend on the glus until the areas are aggregated to country X glu
+    so the land type area tables of all the scenarios are copied to their destination paths after this pass
+ 
+ arguments:
+ args_struct in_args: the input file arguments for this scenario
+ rinfo_struct *raster_info: information about input raster data; the grid geometry is set
+    the fields set by the readers are kept for the later scenarios
+ int scen_ind: the index of the scenario in glu_scen
+ 
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+ 
+ Created on 18 Oct 2026
+ 
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+ 
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+ 
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+ 
+ This file is part of Moirai.
+ 
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+ **********/
+
+#include "moirai.h"
+
+int proc_glu_scenario(args_struct in_args, rinfo_struct *raster_info, int scen_ind) {
+    
+    int i, k,l;
+    int array_cells =3;
+    int restored = 0;           // 1 if the land type area outputs are restored from a checkpoint
+    int lt_scen_ind;            // glu scenario index for copying the land type area tables
+    args_struct lt_scen_args;   // the output paths of a glu scenario for copying its land type area table
+	
+	// for code control
+	int error_code = OK;		// 0 = ok; non-zero = error
+	
+    //////////
+    // start with the text info data
+    // these are csv files that determine mappings and number of aezs, crops, counties, regions
+    
+    ////////// read GTAP87 and GCAM region and FAO country info text files
+    
+    // one file	includes the alphabetical FAO country list and the FAO, VMAP0, iso ctry mapping
+    // array length and allocation done within read_country_info_all()
+    start_stage("read_country_info_all");
+    if((error_code = read_country_info_all(in_args))) {
+        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+        return error_code;
+    }
+    end_stage();
+    
+    // this includes both the GCAM/GTAP ctry87 list in land rent output order and the mapping between FAO ctry and GCAM/GTAP ctry87
+    // array length and allocation done within read_country87_info()
+    start_stage("read_country87_info");
+    if((error_code = read_country87_info(in_args))) {
+        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+        return error_code;
+    }
+    end_stage();
+    
+    // this includes GCAM region list
+    // array length and allocation done within read_region_info_gcam()
+    start_stage("read_region_info_gcam");
+    if((error_code = read_region_info_gcam(in_args))) {
+        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+        return error_code;
+    }
+    end_stage();
+    
+    ////////// read the list of new aez codes and names
+    
+    // this is the list of new aezs
+    // array length and allocation done within read_aez_new_info()
+    start_stage("read_aez_new_info");
+    if((error_code = read_aez_new_info(in_args))) {
+        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+        return error_code;
+    }
+    end_stage();
+    
+    ////////// read crop and use and land info text files
+    
+    // read GTAP use info
+    // this is the list in output order for land rent
+    // array length and allocation done within read_use_info_gtap()
+    start_stage("read_use_info_gtap");
+    if((error_code = read_use_info_gtap(in_args))) {
+        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+        return error_code;
+    }
+    end_stage();
+    
+    // read SAGE land type info
+    // array length and allocation done within read_lt_info_sage()
+    start_stage("read_lulc_info");
+    if((error_code = read_lulc_info(in_args))) {
+        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+        return error_code;
+    }
+    end_stage();
+    
+    // one file includes FAO to SAGE crop and to GTAP use mapping
+    // array length and allocation done within read_crop_info()
+    start_stage("read_crop_info");
+    if((error_code = read_crop_info(in_args))) {
+        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+        return error_code;
+    }
+    end_stage();
+    
+	////////
+	// read the raster data, except the SAGE crop data, lulc data, and hyde lu data
+	
+	// these rasters do not depend on the glus, so they are read with the first glu scenario and freed at the end of the run
+	//	serve mode keeps them for the next request with the same inputs (see serve_stages.c)
+	if (scen_ind == 0 && run_serve_stage(SERVE_SHARED_RASTERS)) {
+		// calculate the total area of the working grid cells in each row (spherical earth): cell_area_row[NUM_LAT]
+	    // and read in cell area of the hyde land cells (also spherical earth): cell_area_hyde_row[NUM_LAT]
+	    // first allocate the arrays
+	    cell_area_row = calloc(NUM_LAT, sizeof(float));
+	    if(cell_area_row == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for cell_area_row: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+	    cell_area_hyde_row = calloc(NUM_LAT, sizeof(float));
+	    if(cell_area_hyde_row == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for cell_area_hyde_row: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+		start_stage("get_cell_area");
+		if((error_code = get_cell_area(in_args, raster_info))) {
+			fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+			return error_code;
+		}
+		end_stage();
+	
+		// read the sage working grid land fraction and convert it to land area: land_area_sage[NUM_CELLS]
+	    // first allocate the arrays
+	    land_area_sage = calloc(NUM_CELLS, sizeof(float));
+	    if(land_area_sage == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_area_sage: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+		start_stage("read_land_area_sage");
+		if((error_code = read_land_area_sage(in_args, raster_info))) {
+			fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+			return error_code;
+		}
+		end_stage();
+	
+		// read the hyde land area: land_area_hyde[NUM_CELLS]
+	    // first allocate the arrays
+	    land_area_hyde = calloc(NUM_CELLS, sizeof(float));
+	    if(land_area_hyde == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_area_hyde: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+		start_stage("read_land_area_hyde");
+		if((error_code = read_land_area_hyde(in_args, raster_info))) {
+			fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+			return error_code;
+		}
+		end_stage();
+	
+		// read original AEZ boundaries:aez_bounds_orig[NUM_CELLS]
+	    // first allocate the array
+	    aez_bounds_orig = calloc(NUM_CELLS, sizeof(int));
+	    if(aez_bounds_orig == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for aez_bounds_orig: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+		start_stage("read_aez_orig");
+		if((error_code = read_aez_orig(in_args, raster_info))) {
+			fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+			return error_code;
+		}
+		end_stage();
+	
+		// read potential vegetation data: potveg_thematic[NUM_CELLS]
+	    // first allocate the array
+	    potveg_thematic = calloc(NUM_CELLS, sizeof(int));
+	    if(potveg_thematic == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for potveg_thematic: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+		start_stage("read_potveg");
+		if((error_code = read_potveg(in_args, raster_info))) {
+			fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+			return error_code;
+		}
+		end_stage();
+	
+		// read FAO country code data: country_fao[NUM_CELLS]
+	    // first allocate array
+	    country_fao = calloc(NUM_CELLS, sizeof(short));
+	    if(country_fao == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for country_fao: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+		start_stage("read_country_fao");
+		if((error_code = read_country_fao(in_args, raster_info))) {
+			fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+			return error_code;
+		}
+		end_stage();
+	
+		// read lulc land mask: land_mask_lulc[NUM_CELLS]
+		// first allocate array
+		land_mask_lulc = calloc(NUM_CELLS, sizeof(int));
+		if(land_mask_lulc == NULL) {
+			fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_lulc: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+			return ERROR_MEM;
+		}
+		start_stage("read_lulc_land");
+		if((error_code = read_lulc_land(in_args, REF_YEAR, raster_info, land_mask_lulc))) {
+			fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+			return error_code;
+		}
+		end_stage();
+	}
+	
+	// read new AEZ boundaries: aez_bounds_new[NUM_CELLS]
+    // first allocate the array
+    aez_bounds_new = calloc(NUM_CELLS, sizeof(int));
+    if(aez_bounds_new == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for aez_bounds_new: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    start_stage("read_aez_new");
+    if((error_code = read_aez_new(in_args, raster_info))) {
+		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+		return error_code;
+	}
+    end_stage();
+	
+    /////////
+    // reconcile the raster data
+	
+    // allocate some raster arrays
+    // the reference year area arrays do not depend on the glus, so they are allocated below with the first glu scenario
+    region_gcam = calloc(NUM_CELLS, sizeof(int));
+    if(region_gcam == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for region_gcam: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    sage_minus_hyde_land_area = calloc(NUM_CELLS, sizeof(float));
+    if(sage_minus_hyde_land_area == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for sage_minus_hyde_land_area: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    glacier_water_area_hyde = calloc(NUM_CELLS, sizeof(float));
+    if(glacier_water_area_hyde == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for glacier_water_area_hyde: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    country87_gtap = calloc(NUM_CELLS, sizeof(int));
+    if(country87_gtap == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for country87_gtap: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    missing_aez_mask = calloc(NUM_CELLS, sizeof(int));
+    if(missing_aez_mask == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for missing_aez_mask: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    land_mask_ctryaez = calloc(NUM_CELLS, sizeof(int));
+    if(land_mask_ctryaez == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_ctryaez: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    land_mask_aez_orig = calloc(NUM_CELLS, sizeof(int));
+    if(land_mask_aez_orig == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_aez_orig: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    land_mask_aez_new = calloc(NUM_CELLS, sizeof(int));
+    if(land_mask_aez_new == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_aez_new: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    land_mask_sage = calloc(NUM_CELLS, sizeof(int));
+    if(land_mask_sage == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_sage: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    land_mask_hyde = calloc(NUM_CELLS, sizeof(int));
+    if(land_mask_hyde == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_hyde: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    land_mask_fao = calloc(NUM_CELLS, sizeof(int));
+    if(land_mask_fao == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_fao: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    land_mask_potveg = calloc(NUM_CELLS, sizeof(int));
+    if(land_mask_potveg == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_potveg: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+	
+    // allocate some arrays to keep track of valid raster cells
+    land_cells_aez_new = calloc(NUM_CELLS, sizeof(int));
+    if(land_cells_aez_new == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_cells_aez_new: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    land_cells_sage = calloc(NUM_CELLS, sizeof(int));
+    if(land_cells_sage == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_cells_sage: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    land_cells_hyde = calloc(NUM_CELLS, sizeof(int));
+    if(land_cells_hyde == NULL) {
+        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_cells_hyde: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+        return ERROR_MEM;
+    }
+    
+    // it would be more efficient to write a loop over all cells here,
+    //  and write the following two functions to operate on a single cell
+    // the second function would be called only if the first one finds a land cell
+    
+	////
+	// restrict the run to the region_subset countries, if set; this removes the glu from the other cells
+	start_stage("set_region_subset");
+	if((error_code = set_region_subset(in_args, raster_info))) {
+		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+		return error_code;
+	}
+	end_stage();
+	
+	////
+	// determine the indices of the relevant land cells in aez, sage, hyde, and fao data: land_cells_####[NUM_CELLS]
+	start_stage("get_land_cells");
+	if((error_code = get_land_cells(in_args, *raster_info))) {
+		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+		return error_code;
+	}
+	end_stage();
+	
+	////
+	// the reference year areas do not depend on the glus, so they are calculated with the first glu scenario
+	//	and freed at the end of the run, with the rasters above
+	if (scen_ind == 0 && run_serve_stage(SERVE_SHARED_RASTERS)) {
+	    // allocate the reference year area arrays
+	    cropland_area = calloc(NUM_CELLS, sizeof(float));
+	    if(cropland_area == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for cropland_area: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+	    pasture_area = calloc(NUM_CELLS, sizeof(float));
+	    if(pasture_area == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for pasture_area: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+	    urban_area = calloc(NUM_CELLS, sizeof(float));
+	    if(urban_area == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for urban_area: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+		lu_detail_area = calloc(NUM_HYDE_TYPES - NUM_HYDE_TYPES_MAIN, sizeof(float*));
+		if(lu_detail_area == NULL) {
+			fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for lu_detail_area: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+			return ERROR_MEM;
+		}
+		for (i = 0; i < NUM_HYDE_TYPES - NUM_HYDE_TYPES_MAIN; i++) {
+			lu_detail_area[i] = calloc(NUM_CELLS, sizeof(float));
+			if(lu_detail_area[i] == NULL) {
+				fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for lu_detail_area[%i]: proc_glu_scenario()\n", get_systime(), ERROR_MEM, i);
+				return ERROR_MEM;
+			}
+		}
+	    refveg_area = calloc(NUM_CELLS, sizeof(float));
+	    if(refveg_area == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for refveg_area: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+	    refcarbon_area = calloc(NUM_CELLS, sizeof(float));
+	    if(refcarbon_area == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for refveg_area: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+		land_mask_refveg = calloc(NUM_CELLS, sizeof(int));
+		if(land_mask_refveg == NULL) {
+			fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_refveg: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+			return ERROR_MEM;
+		}
+	    land_mask_forest = calloc(NUM_CELLS, sizeof(int));
+	    if(land_mask_forest == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for land_mask_forest: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+		lulc_input_grid = calloc(NUM_LULC_TYPES, sizeof(float*));
+		if(lulc_input_grid == NULL) {
+			fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for lulc_input_grid: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+			return ERROR_MEM;
+		}
+		for (i = 0; i < NUM_LULC_TYPES; i++) {
+			lulc_input_grid[i] = calloc(NUM_CELLS_LULC, sizeof(float));
+			if(lulc_input_grid[i] == NULL) {
+				fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for lulc_input_grid[%i]: proc_glu_scenario()\n", get_systime(), ERROR_MEM, i);
+				return ERROR_MEM;
+			}
+		}
+		refveg_thematic = calloc(NUM_CELLS, sizeof(int));
+		if(refveg_thematic == NULL) {
+			fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for refveg_thematic: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+			return ERROR_MEM;
+		}
+	    refvegcarbon_thematic = calloc(NUM_CELLS, sizeof(int));
+		if(refvegcarbon_thematic == NULL) {
+			fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for refveg_thematic: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+			return ERROR_MEM;
+		}
+	    forest_cells = calloc(NUM_CELLS, sizeof(int));
+	    if(forest_cells == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for forest_cells: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+	
+		// convert the hyde land use, lulc, and sage potential veg input data to working grid area
+		// this also sets the forest cells, and the rand_order array, which is freed with the rasters above
+		start_stage("calc_refveg_area");
+		if((error_code = calc_refveg_area(in_args, raster_info))) {
+			fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+			return error_code;
+		}	
+		end_stage();
+    
+	    start_stage("calc_refcarbon_area");
+	    if((error_code = calc_refcarbon_area(in_args, *raster_info))) {
+			fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+			return error_code;
+		}
+	    end_stage();
+		// free the reference year land masks
+		free(land_mask_lulc);
+		land_mask_lulc = NULL;
+		free(land_mask_forest);
+		land_mask_forest = NULL;
+		free(land_mask_refveg);
+		land_mask_refveg = NULL;
+	}
+    
+    // free some raster arrays
+    free(region_gcam);
+    region_gcam = NULL;
+    free(sage_minus_hyde_land_area);
+    sage_minus_hyde_land_area = NULL;
+    free(glacier_water_area_hyde);
+    glacier_water_area_hyde = NULL;
+    free(land_mask_aez_orig);
+    land_mask_aez_orig = NULL;
+    free(land_mask_aez_new);
+    land_mask_aez_new = NULL;
+    free(land_mask_sage);
+    land_mask_sage = NULL;
+    free(land_mask_hyde);
+    land_mask_hyde = NULL;
+    free(land_mask_fao);
+    land_mask_fao = NULL;
+    free(land_mask_potveg);
+    land_mask_potveg = NULL;
+   
+   // allocate space for hong kong and taiwan glu area tracking in write_glu_mapping
+   twn_glu_area = calloc(NUM_ORIG_AEZ, sizeof(float));
+   if(twn_glu_area == NULL) {
+      fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for twn_glu_area: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+      return ERROR_MEM;
+   }
+   hkg_glu_area = calloc(NUM_ORIG_AEZ, sizeof(float));
+   if(hkg_glu_area == NULL) {
+      fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for hkg_glu_area: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+      return ERROR_MEM;
+   }
+   
+	// store the country/land rent region + aez lists
+    // the arrays are allocated within write_glu_mapping()
+	start_stage("write_glu_mapping");
+	if((error_code = write_glu_mapping(in_args, *raster_info))) {
+		fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+		return error_code;
+	}
+	end_stage();
+	
+	// hold the glu raster and the country+aez lists of this scenario for proc_land_type_area()
+	// they are freed in main() at the end of the run
+	glu_scen[scen_ind].aez_bounds = aez_bounds_new;
+	glu_scen[scen_ind].aez_nodata = raster_info->aez_new_nodata;
+	glu_scen[scen_ind].ctry_aez_num = ctry_aez_num;
+	glu_scen[scen_ind].ctry_aez_list = ctry_aez_list;
+	glu_scen[scen_ind].subset_row_min = raster_info->subset_row_min;
+	glu_scen[scen_ind].subset_row_max = raster_info->subset_row_max;
+	glu_scen[scen_ind].subset_col_min = raster_info->subset_col_min;
+	glu_scen[scen_ind].subset_col_max = raster_info->subset_col_max;
+    
+    // process the mirca data
+    //  mirca grid is allocated/freed within proc_mirca()
+    if (run_serve_stage(SERVE_MIRCA)) {
+        start_stage("proc_mirca");
+        if((error_code = proc_mirca(in_args, *raster_info)) ||
+           (error_code = save_stage_checkpoint(in_args, SERVE_MIRCA, scen_ind))) {
+            fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+            return error_code;
+        }
+        end_stage();
+    }
+	
+    // the protected area, carbon, and sage cropland rasters do not depend on the glus, so they are read with the first glu scenario
+    //	and freed at the end of the run, with the rasters above
+	if (scen_ind == 0 && run_serve_stage(SERVE_SHARED_RASTERS)) {
+	    //kbn 2020
+	    protected_EPA = calloc(NUM_EPA_PROTECTED, sizeof(float*));
+	    if(protected_EPA == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for protected_EPA: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+	    for (i = 0; i < NUM_EPA_PROTECTED; i++) {
+			protected_EPA[i] = calloc(NUM_CELLS, sizeof(float));
+			if(protected_EPA[i] == NULL) {
+				fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for protected_EPA[%i]: proc_glu_scenario()\n", get_systime(), ERROR_MEM, i);
+				return ERROR_MEM;
+			}
+		}
+    
+    
+	    start_stage("read_protected");
+	    if((error_code = read_protected(in_args, raster_info))) {
+	        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+	        return error_code;
+	    }
+	    end_stage();
+	    //kbn 2020/06/01 Add code for read_soil_c here
+	    soil_carbon_sage = calloc(NUM_CARBON, sizeof(float*));
+	    if(soil_carbon_sage == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for soil_carbon_sage: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+	    for (i = 0; i < NUM_CARBON; i++) {
+			soil_carbon_sage[i] = calloc(NUM_CELLS, sizeof(float));
+			if(soil_carbon_sage[i] == NULL) {
+				fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for soil_carbon_sage[%i]: proc_glu_scenario()\n", get_systime(), ERROR_MEM, i);
+				return ERROR_MEM;
+			}
+		}
+    
+	    // read the soil carbon states of every cell
+	    start_stage("read_soil_carbon");
+	    if((error_code = read_soil_carbon(in_args, raster_info))) {
+	        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+	        return error_code;
+	    } 
+	    end_stage();
+    
+	    //kbn 2020/06/30 Add code for read_veg_c here
+	    veg_carbon_sage = calloc(NUM_CARBON, sizeof(float*));
+	    if(veg_carbon_sage == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for veg_carbon_sage: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+	    for (i = 0; i < NUM_CARBON; i++) {
+			veg_carbon_sage[i] = calloc(NUM_CELLS, sizeof(float));
+			if(veg_carbon_sage[i] == NULL) {
+				fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for veg_carbon_sage[%i]: proc_glu_scenario()\n", get_systime(), ERROR_MEM, i);
+				return ERROR_MEM;
+			}
+		}
+    
+	    // Add above ground and below ground ratio for vegetation carbon
+	    above_ground_ratio = calloc(NUM_CARBON, sizeof(float*));
+	    if(above_ground_ratio == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for above_ground_ratio: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+	    for (i = 0; i < NUM_CARBON; i++) {
+			above_ground_ratio[i] = calloc(NUM_CELLS, sizeof(float));
+			if(above_ground_ratio[i] == NULL) {
+				fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for above_ground_ratio[%i]: proc_glu_scenario()\n", get_systime(), ERROR_MEM, i);
+				return ERROR_MEM;
+			}
+		}
+    
+	    // Add above ground and below ground ratio for vegetation carbon
+	    below_ground_ratio = calloc(NUM_CARBON, sizeof(float*));
+	    if(below_ground_ratio == NULL) {
+	        fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for below_ground_ratio: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+	        return ERROR_MEM;
+	    }
+	    for (i = 0; i < NUM_CARBON; i++) {
+			below_ground_ratio[i] = calloc(NUM_CELLS, sizeof(float));
+			if(below_ground_ratio[i] == NULL) {
+				fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for below_ground_ratio[%i]: proc_glu_scenario()\n", get_systime(), ERROR_MEM, i);
+				return ERROR_MEM;
+			}
+		}
+
+
+	    start_stage("read_veg_carbon");
+	    if((error_code = read_veg_carbon(in_args, raster_info))) {
+	        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+	        return error_code;
+	    }
+	    end_stage();
+	
+		// get the sage physical cropland area for normalizing the crop inputs in proc_crop_rent()
+		cropland_area_sage = calloc(NUM_CELLS, sizeof(float));
+		if(cropland_area_sage == NULL) {
+			fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for cropland_area_sage: proc_glu_scenario()\n", get_systime(), ERROR_MEM);
+			return ERROR_MEM;
+		}
+		start_stage("read_cropland_sage");
+		if((error_code = read_cropland_sage(in_args, raster_info))) {
+			fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+			return error_code;
+		}
+		end_stage();
+	}
+    
+    //Allocate the arrays to hold the number of cells
+    //the carbon arrays have one entry for each reference veg carbon key found in write_glu_mapping()
+    soil_carbon_array_cells = calloc(refveg_carbon_tally.num_slots + 1, sizeof(int));
+    if(soil_carbon_array_cells == NULL) {
+        fprintf(fplog,"Failed to allocate memory for soil_carbon_array_cells: proc_glu_scenario()\n");
+        return ERROR_MEM;
+    }
+    
+  //Allocate the main soil_carbon_array and the vegetation carbon arrays
+    soil_carbon_array = calloc(refveg_carbon_tally.num_slots + 1, sizeof(float**));
+    veg_carbon_array = calloc(refveg_carbon_tally.num_slots + 1, sizeof(float**));
+    if(soil_carbon_array == NULL || veg_carbon_array == NULL) {
+        fprintf(fplog,"Failed to allocate memory for soil_carbon_array and veg_carbon_array: proc_glu_scenario()\n");
+        return ERROR_MEM;
+    }
+    for (k = 0; k < refveg_carbon_tally.num_slots; k++) {
+        soil_carbon_array[k] = calloc(NUM_CARBON, sizeof(float*));
+        veg_carbon_array[k] = calloc(NUM_CARBON, sizeof(float*));
+        if(soil_carbon_array[k] == NULL || veg_carbon_array[k] == NULL) {
+            fprintf(fplog,"Failed to allocate memory for soil_carbon_array[%i]: proc_glu_scenario()\n", k);
+            return ERROR_MEM;
+        }//The last dimension will be assigned in set_carbon_arrays.c
+        for (l = 0; l < NUM_CARBON; l++) {
+            soil_carbon_array[k][l] = calloc(array_cells, sizeof(float));
+            veg_carbon_array[k][l] = calloc(array_cells, sizeof(float));
+            if(soil_carbon_array[k][l] == NULL || veg_carbon_array[k][l] == NULL) {
+                fprintf(fplog,"Failed to allocate memory for soil_carbon_array[%i][%i]: proc_glu_scenario()\n", k, l);
+                return ERROR_MEM;
+            }
+        }// end for l loop over carbon states
+    }// end for k loop over the carbon keys
+    
+    // count the land cells of each carbon key and size the soil and veg carbon arrays for them
+    start_stage("set_carbon_arrays");
+    if((error_code = set_carbon_arrays())) {
+        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+        return error_code;
+    }
+    end_stage();
+
+
+    // process the land type area data
+    //  lu grids are allocated/freed within proc_land_type_area()
+    //  this is done once, with the last glu scenario, and writes the land type area of every scenario
+    //  if checkpoint_path is set, the outputs are restored from a checkpoint with the same inputs instead (see checkpoint.c)
+    if (scen_ind == num_glu_scen - 1) {
+        if (run_serve_stage(SERVE_LAND_TYPE_AREA)) {
+            start_stage("proc_land_type_area");
+            if((error_code = set_land_type_area_checkpoint(in_args)) || (error_code = restore_checkpoint(&restored))) {
+                fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+                return error_code;
+            }
+            if (!restored) {
+                if((error_code = proc_land_type_area(in_args, *raster_info))) {
+                    fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+                    return error_code;
+                }
+                if((error_code = set_land_type_area_checkpoint(in_args)) || (error_code = save_checkpoint())) {
+                    fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+                    return error_code;
+                }
+            }
+            end_stage();
+        }
+        
+        // copy the land type area table of every scenario to its LDS destination directory
+        //  copy_to_destpath() runs at the end of each scenario, before the earlier scenarios have their tables
+        start_stage("copy_land_type_area");
+        for (lt_scen_ind = 0; lt_scen_ind < num_glu_scen; lt_scen_ind++) {
+            lt_scen_args = in_args;
+            strcpy(lt_scen_args.outpath, glu_scen[lt_scen_ind].outpath);
+            strcpy(lt_scen_args.ldsdestpath, glu_scen[lt_scen_ind].ldsdestpath);
+            if((error_code = copy_land_type_area(lt_scen_args))) {
+                fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+                return error_code;
+            }
+        }
+        end_stage();
+    } else {
+        fprintf(fplog, "\nThe land type area for glu scenario %s is processed with the last glu scenario\n", glu_scen[scen_ind].name);
+    }
+    
+    // process the reference vegetation carbon data
+    //  needed arrays are allocated/freed within proc_refveg_carbon()
+    if (run_serve_stage(SERVE_REFVEG_CARBON)) {
+        start_stage("proc_refveg_carbon");
+        if((error_code = proc_refveg_carbon(in_args, *raster_info)) ||
+           (error_code = save_stage_checkpoint(in_args, SERVE_REFVEG_CARBON, scen_ind))) {
+            fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+            return error_code;
+        }
+        end_stage();
+    }
+    
+  //  fprintf(stdout, "\nStart freeing other carbon arrays %s\n", get_systime());
+    free(soil_carbon_array_cells);
+    soil_carbon_array_cells = NULL;
+
+//fprintf(stdout, "\n Freed carbon array cells  %s\n", get_systime());
+       
+     
+  
+
+    // process the water footprint data
+    //  needed arrays are allocated/freed within proc_water_footprint()
+ 
+ //fprintf(stdout, "\n Start water footprint %s\n", get_systime());
+ 
+    if (run_serve_stage(SERVE_WATER_FOOTPRINT)) {
+        start_stage("proc_water_footprint");
+        if((error_code = proc_water_footprint(in_args, *raster_info)) ||
+           (error_code = save_stage_checkpoint(in_args, SERVE_WATER_FOOTPRINT, scen_ind))) {
+            fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+            return error_code;
+        }
+        end_stage();
+    }
+	
+    // free the land type category array
+    free(lt_cats);
+    lt_cats = NULL;
+    
+    // free some rasters
+    free(land_cells_aez_new);
+    land_cells_aez_new = NULL;
+    
+    //free soil and veg carbon arrays, and the carbon keys
+    for (k = 0; k < refveg_carbon_tally.num_slots; k++) {
+        for(l=0; l< NUM_CARBON;l++){
+            free(soil_carbon_array[k][l]);
+            free(veg_carbon_array[k][l]);
+        }
+        free(soil_carbon_array[k]);
+        free(veg_carbon_array[k]);
+    }
+    free(soil_carbon_array);
+    soil_carbon_array = NULL;
+    free(veg_carbon_array);
+    veg_carbon_array = NULL;
+    free_lt_tally(&refveg_carbon_tally);
+
+    // calculate the crop harvested area and production and the land rents, and write them
+    //  the fao tables and the original land rent are read with the first glu scenario and freed with the last one
+    if (run_serve_stage(SERVE_CROP_RENT)) {
+        if((error_code = proc_crop_rent(in_args, raster_info, scen_ind))) {
+            return error_code;
+        }
+        if((error_code = save_stage_checkpoint(in_args, SERVE_CROP_RENT, scen_ind))) {
+            fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+            return error_code;
+        }
+    }
+    
+    // free some raster arrays
+    // aez_bounds_new is held in glu_scen
+    free(land_mask_ctryaez);
+    land_mask_ctryaez = NULL;
+    free(land_cells_sage);
+    land_cells_sage = NULL;
+    free(country87_gtap);
+    country87_gtap = NULL;
+    free(land_cells_hyde);
+    land_cells_hyde = NULL;
+    free(missing_aez_mask);
+    missing_aez_mask = NULL;
+    
+    // copy the gcam data system input files to the LDS destination directory
+    start_stage("copy_to_destpath");
+    if((error_code = copy_to_destpath(in_args))) {
+        fprintf(fplog, "\nProgram terminated at %s with error_code = %i\n", get_systime(), error_code);
+        return error_code;
+    }
+    end_stage();
+   
+    // free the glu mapping and info arrays, and the fao tables and the original land rent with the last glu scenario
+    free_glu_tables(scen_ind == num_glu_scen - 1);
+
+    return OK;}
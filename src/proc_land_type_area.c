@@ -29,6 +29,7 @@
  
  the hyde lu input files are arc ascii raster files
  47 years available: 1700 - 2000 every 10 years, 2001-2016 each year
+    only the hyde_years[num_hyde_years] selected in the input file are processed and output (see set_hyde_years.c)
  the input file names are determined from the hyde input type file
  the first 3 files are the total crop, total pasture, and total urban area
  the remaining 9 files are the lu detail
@@ -51,6 +52,27 @@
  
  serbia and montenegro data are merged
  
+ the areas are aggregated to country X glu for every glu scenario in glu_scen (see read_glu_batch.c) in the same pass
+    so a glu batch run reads and disaggregates the hyde and lulc data only once
+    the table and the lulc_out_year grids are written to the output path of each scenario
+    the global area diagnostics include the cells that have a glu in any scenario
+ 
+ if cell_store_fname is not none, the cell values are also written to the per-cell store before they are aggregated
+    (see cell_store.c), so that the table can be rebuilt for another glu raster with tools/moirai_reaggregate.c
+ 
+ the areas of each year are aggregated in a country X glu X land type slice, which is spilled to a year-major file
+    in the output path of each scenario when the year is done, so only one year of the table is held in memory
+    the table is then written in its country, glu, land type, year order by a streaming merge of the years (see year_spill.c)
+ the slice is a sparse tally (see lt_tally.c): a country X glu X land type gets a slot when it first has area in a scenario,
+    so only the occurring land types are stored, cleared, and spilled each year
+    the slots are kept for the later years, as most land types occur in every year
+ 
+ table_format selects the csv table, the compressed netcdf-4 table (see write_nc_table.c), or both
+    the netcdf table has the same records, with the .csv extension of land_type_area_fname replaced by .nc
+    the netcdf table is also written during the merge, in slices: its record count is the number of spilled records,
+        and its coordinates are the countries, glus, land types, and years that are marked as they are spilled
+ the spill files are closed and removed when the land type area fails, so that no spill file is left in the output path
+ 
  arguments:
  args_struct in_args: the input file arguments
  rinfo_struct *raster_info: information about input raster data
@@ -85,7 +107,90 @@
 
 #include "moirai.h"
 
-int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
+// add area to the country X glu X land type of each glu scenario that has the cell glu; a land type gets a slot when it first has area
+static int add_scen_area(lt_tally_struct *area_out, const int *scen_aez_ind, int ctry_ind, int lt_ind, double area) {
+	
+	int scen_ind;
+	int slot;
+	int err = OK;
+	
+	if (area == 0) {
+		return OK;
+	}
+	for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+		if (scen_aez_ind[scen_ind] != NOMATCH) {
+			if ((err = add_lt_tally_key(&area_out[scen_ind], ctry_ind, scen_aez_ind[scen_ind], lt_ind, &slot)) != OK) {
+				return err;
+			}
+			area_out[scen_ind].vals[slot] = area_out[scen_ind].vals[slot] + area;
+		}
+	}
+	
+	return OK;}
+
+// compare two ints for qsort
+static int cmp_coord(const void *a, const void *b) {
+	int ia = *(const int *) a;
+	int ib = *(const int *) b;
+	return (ia > ib) - (ia < ib);
+}
+
+// the netcdf table coordinates of a glu scenario: the countries, glu codes, land types, and years with records
+//	pair_rec, lt_rec, and year_rec mark the country glu pairs, land type categories, and years of the spilled records
+static int get_table_coords(int scen_ind, const lt_tally_struct *tally, const char *pair_rec, const char *lt_rec,
+							const char *year_rec, int *coords[], int num_coords[]) {
+	
+	int i, k;
+	int ctry_ind, aez_ind;
+	int num_distinct;	// the number of distinct values of a key
+	
+	coords[0] = malloc(NUM_FAO_CTRY * sizeof(int));
+	coords[1] = malloc(((size_t) tally->num_pairs + 1) * sizeof(int));
+	coords[2] = malloc(((size_t) num_lt_cats + 1) * sizeof(int));
+	coords[3] = malloc(((size_t) num_hyde_years + 1) * sizeof(int));
+	if (coords[0] == NULL || coords[1] == NULL || coords[2] == NULL || coords[3] == NULL) {
+		fprintf(fplog, "Failed to allocate memory for the netcdf table coordinates: proc_land_type_area()\n");
+		return ERROR_MEM;
+	}
+	for (k = 0; k < 4; k++) {
+		num_coords[k] = 0;
+	}
+	for (ctry_ind = 0; ctry_ind < NUM_FAO_CTRY; ctry_ind++) {
+		for (aez_ind = 0; aez_ind < glu_scen[scen_ind].ctry_aez_num[ctry_ind]; aez_ind++) {
+			if (pair_rec[tally->ctry_start[ctry_ind] + aez_ind]) {
+				if (num_coords[0] == 0 || coords[0][num_coords[0] - 1] != ctry_ind) {
+					coords[0][num_coords[0]++] = ctry_ind;
+				}
+				coords[1][num_coords[1]++] = glu_scen[scen_ind].ctry_aez_list[ctry_ind][aez_ind];
+			}
+		}
+	}
+	for (i = 0; i < num_lt_cats; i++) {
+		if (lt_rec[i]) {
+			coords[2][num_coords[2]++] = lt_cats[i];
+		}
+	}
+	for (i = 0; i < num_hyde_years; i++) {
+		if (year_rec[i]) {
+			coords[3][num_coords[3]++] = hyde_years[i];
+		}
+	}
+	// the distinct values of each key, in increasing order; the countries are already
+	for (k = 1; k < 4; k++) {
+		qsort(coords[k], num_coords[k], sizeof(int), cmp_coord);
+		num_distinct = 0;
+		for (i = 0; i < num_coords[k]; i++) {
+			if (num_distinct == 0 || coords[k][i] != coords[k][num_distinct - 1]) {
+				coords[k][num_distinct++] = coords[k][i];
+			}
+		}
+		num_coords[k] = num_distinct;
+	}
+	
+	return OK;}
+
+// the land type area pass; the spill files of the glu scenarios are opened by proc_land_type_area()
+static int aggregate_land_type_area(args_struct in_args, rinfo_struct raster_info, year_spill_struct *spill) {
     
     // valid values in the hyde land area data set determine the land cells to process
     
@@ -106,9 +211,6 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
     int srb_code = 272;         // fao code for serbia
     int mne_code = 273;         // fao code for montenegro
 	
-	// hyde land use raster info
-	int ncols = raster_info.lu_ncols;				// num hyde lons
-	
 	// lulc raster info
 	int ncols_lulc = raster_info.lulc_input_ncols;		// num lulc input lons
 	int ncells_lulc = raster_info.lulc_input_ncells;	// number of lulc input cells
@@ -134,7 +236,15 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 	double *refveg_area_out;		// array for the reference veg areas in each working grid cell, for a single lulc cell
 	int *refveg_them;		// array for the reference veg tyep values in each working grid cell, for a single lulc cell
     
-    double ****area_out;		// output table as 4-d array
+    lt_tally_struct *area_out;	// the current year of the output table as a sparse country X glu X land type tally for each glu scenario
+	int pair;					// the country glu pair index in a tally
+	int key;					// the key index of a pair in a tally
+	int slot;					// the slot of a key in a tally
+    char **pair_rec;			// 1 for the country glu pairs with spilled records, for each glu scenario
+    char **lt_rec;				// 1 for the land type categories with spilled records, for each glu scenario
+    char **year_rec;			// 1 for the years with spilled records, for each glu scenario
+    year_spill_rec_struct spill_rec;	// the next record of the output table
+    int found;					// 1 if there is a next record
     double outval;           // the integer value to output
     int rv_value;           // the reference veg value for the current land type category
 	
@@ -143,6 +253,16 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
     int ctry_code;          // current fao country code
     int aez_ind;            // current aez index in ctry_aez_list[ctry_ind]
     int ctry_ind;           // current country index in ctry_aez_list
+    int scen_ind;           // current glu scenario index
+    int *scen_aez_ind;      // aez index of the current cell for each glu scenario; NOMATCH = no glu
+    int in_glu;             // 1 if the current cell has a glu in at least one glu scenario
+    int do_store = 0;       // 1 if the per-cell land type area store is written (see cell_store.c)
+    int *nonecon_grid;      // 1 if the cell has a glu but not a valid economic country, so it is not in the outputs
+    float *out_grid;        // output area grid for one glu scenario
+    int *out_them;          // output refveg thematic grid for one glu scenario
+    int row_min, row_max;   // working grid rows with a glu cell in any scenario
+    int col_min, col_max;   // working grid columns with a glu cell in any scenario
+    args_struct scen_args;  // the input arguments with the output path of the current glu scenario
     int cur_lt_cat;         // current land type category
     int cur_lt_cat_ind;     // current land type category index
     int nrecords = 0;       // count # of records written
@@ -156,27 +276,24 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 	float rfarea_check;
 	float luarea_check;
 	
-    int hyde_years[NUM_HYDE_YEARS]; // the years in the hyde historical lu files
-   
     char fname[MAXCHAR];        // current file name to write
 	char tmp_str[1100];        // temporary string
     FILE *fpout;                // out file pointer
+    nc_table_struct nc_table;   // the netcdf table of a glu scenario
+    const char *nc_key_names[] = {"iso", "glu_code", "land_type", "year"};
+    const char *nc_val_names[] = {"value"};
+    int nc_keys[4];             // the keys of a netcdf table record
+    int *nc_coords[4];          // the coordinates of the netcdf table keys
+    int nc_num_coords[4];       // the number of coordinates of each netcdf table key
+    char nc_fname[MAXCHAR];     // the netcdf table file name
+    char nc_path[MAXCHAR];      // the netcdf table file name, with path
     
     double tmp_dbl;
     
-    // create the array of available years
-    hyde_years[0] = HYDE_START_YEAR;
-    for (i = 1; i < (NUM_HYDE_YEARS - NUM_HYDE_POST2000_YEARS); i++) {
-        hyde_years[i] = hyde_years[i-1] + 10;
-    }
-	for (i = (NUM_HYDE_YEARS - NUM_HYDE_POST2000_YEARS); i < NUM_HYDE_YEARS; i++) {
-		hyde_years[i] = hyde_years[i-1] + 1;
-	}
-	
 	// determine how many base lu cells are in one lulc cell
-	// assume perfect fit of working grid into lulc data
+	// the fit of the working grid into the lulc grid is checked in set_grid_geometry()
 	// assume symmetric cells
-	num_split = ncols / ncols_lulc;
+	num_split = raster_info.num_split;
 	NUM_LU_CELLS = num_split * num_split;
 	
     // allocate arrays
@@ -270,32 +387,75 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 	}
 	
 	// output
-    area_out = calloc(NUM_FAO_CTRY, sizeof(double***));
+	// the glu scenario arrays are filled in proc_glu_scenario(); there is one scenario unless there is a glu batch file
+    area_out = calloc(num_glu_scen, sizeof(lt_tally_struct));
     if(area_out == NULL) {
         fprintf(fplog,"Failed to allocate memory for area_out: proc_land_type_area()\n");
         return ERROR_MEM;
     }
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        area_out[i] = calloc(ctry_aez_num[i], sizeof(double**));
-        if(area_out[i] == NULL) {
-            fprintf(fplog,"Failed to allocate memory for area_out[%i]: proc_land_type_area()\n", i);
+    for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+        if ((err = init_lt_tally(&area_out[scen_ind], glu_scen[scen_ind].ctry_aez_num)) != OK) {
+            return err;
+        }
+    } // end for scen_ind loop over glu scenarios
+    pair_rec = calloc(num_glu_scen, sizeof(char*));
+    lt_rec = calloc(num_glu_scen, sizeof(char*));
+    year_rec = calloc(num_glu_scen, sizeof(char*));
+    if(pair_rec == NULL || lt_rec == NULL || year_rec == NULL) {
+        fprintf(fplog,"Failed to allocate memory for the spilled record marks: proc_land_type_area()\n");
+        return ERROR_MEM;
+    }
+    for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+        pair_rec[scen_ind] = calloc(area_out[scen_ind].num_pairs + 1, sizeof(char));
+        lt_rec[scen_ind] = calloc(num_lt_cats + 1, sizeof(char));
+        year_rec[scen_ind] = calloc(num_hyde_years + 1, sizeof(char));
+        if(pair_rec[scen_ind] == NULL || lt_rec[scen_ind] == NULL || year_rec[scen_ind] == NULL) {
+            fprintf(fplog,"Failed to allocate memory for the spilled record marks: proc_land_type_area()\n");
             return ERROR_MEM;
         }
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            area_out[i][j] = calloc(num_lt_cats, sizeof(double*));
-            if(area_out[i][j] == NULL) {
-                fprintf(fplog,"Failed to allocate memory for area_out[%i][%i]: proc_land_type_area()\n", i, j);
-                return ERROR_MEM;
-            }
-            for (k = 0; k < num_lt_cats; k++) {
-                area_out[i][j][k] = calloc(NUM_HYDE_YEARS, sizeof(double));
-                if(area_out[i][j][k] == NULL) {
-                    fprintf(fplog,"Failed to allocate memory for area_out[%i][%i][%i]: proc_land_type_area()\n", i, j, k);
-                    return ERROR_MEM;
-                }
-            } // end for k loop over land type categories
-        } // end for j loop over aezs
-    } // end for i loop over fao country
+    }
+    scen_aez_ind = calloc(num_glu_scen, sizeof(int));
+    if(scen_aez_ind == NULL) {
+        fprintf(fplog,"Failed to allocate memory for scen_aez_ind: proc_land_type_area()\n");
+        return ERROR_MEM;
+    }
+    
+    // for the output grids
+    nonecon_grid = calloc(NUM_CELLS, sizeof(int));
+    if(nonecon_grid == NULL) {
+        fprintf(fplog,"Failed to allocate memory for nonecon_grid: proc_land_type_area()\n");
+        return ERROR_MEM;
+    }
+    out_grid = calloc(NUM_CELLS, sizeof(float));
+    if(out_grid == NULL) {
+        fprintf(fplog,"Failed to allocate memory for out_grid: proc_land_type_area()\n");
+        return ERROR_MEM;
+    }
+    out_them = calloc(NUM_CELLS, sizeof(int));
+    if(out_them == NULL) {
+        fprintf(fplog,"Failed to allocate memory for out_them: proc_land_type_area()\n");
+        return ERROR_MEM;
+    }
+    
+    // the region subset bounding box of all of the glu scenarios
+    row_min = NUM_LAT;
+    row_max = -1;
+    col_min = NUM_LON;
+    col_max = -1;
+    for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+        if (glu_scen[scen_ind].subset_row_min < row_min) {
+            row_min = glu_scen[scen_ind].subset_row_min;
+        }
+        if (glu_scen[scen_ind].subset_row_max > row_max) {
+            row_max = glu_scen[scen_ind].subset_row_max;
+        }
+        if (glu_scen[scen_ind].subset_col_min < col_min) {
+            col_min = glu_scen[scen_ind].subset_col_min;
+        }
+        if (glu_scen[scen_ind].subset_col_max > col_max) {
+            col_max = glu_scen[scen_ind].subset_col_max;
+        }
+    }
 	
 	// for tracking global area
 	global_lt_out = calloc(NUM_SAGE_PVLT + 1 + NUM_HYDE_TYPES, sizeof(double));
@@ -309,6 +469,15 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 		return ERROR_MEM;
 	}
 	
+	// the per-cell store, if requested; the static columns are written here and one block of columns per year
+	if (strcmp(in_args.cell_store_fname, NONE_TEXT) != 0) {
+		do_store = 1;
+		if ((err = init_cell_store(in_args, raster_info, row_min, row_max, col_min, col_max)) != OK) {
+			fprintf(fplog, "Failed to initialize the cell store: proc_land_type_area()\n");
+			return err;
+		}
+	}
+	
 	// swap these lines with the full for loop line to run a single year for testing
 	// and uncomment the p index declaration above
     // process each year
@@ -316,7 +485,7 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 	//just do REF_YEAR for testing
 	/*
 	p = NOMATCH;
-	for (m = 0; m < NUM_HYDE_YEARS; m++) {
+	for (m = 0; m < num_hyde_years; m++) {
 		if (hyde_years[m] == REF_YEAR) {
 			p = m;
 			break;
@@ -324,15 +493,19 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 	}
 	for (year_ind = p; year_ind < p+1; year_ind++) {
 	*/
-	for (year_ind = 0; year_ind < NUM_HYDE_YEARS; year_ind++) {
+	for (year_ind = 0; year_ind < num_hyde_years; year_ind++) {
 		
+		trace_begin("year", "%i", hyde_years[year_ind]);
 		fprintf(fplog,"\nCurrently processing Year: %i",year_ind+1);
 		if (in_args.diagnostics) {
 			fprintf(fplog, "\nYear %i: proc_land_type_area()\n", hyde_years[year_ind]);
 		}
 		
 		// first read in the appropriate hyde land use area data
-		if((err = read_hyde32(in_args, &raster_info, hyde_years[year_ind], crop_grid, pasture_grid, urban_grid, lu_detail_grid)) != OK)
+		trace_begin("io", "read_hyde32 %i", hyde_years[year_ind]);
+		err = read_hyde32(in_args, &raster_info, hyde_years[year_ind], crop_grid, pasture_grid, urban_grid, lu_detail_grid);
+		trace_end();
+		if(err != OK)
 		{
 			fprintf(fplog, "Failed to read lu hyde data for year %i: proc_land_type_area()\n", hyde_years[year_ind]);
 			return err;
@@ -344,7 +517,10 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 		} else {
 			lulc_year = hyde_years[year_ind];
 		}
-		if((err = read_lulc_isam(in_args, lulc_year, lulc_temp_grid)) != OK)
+		trace_begin("io", "read_lulc_isam %i", lulc_year);
+		err = read_lulc_isam(in_args, lulc_year, lulc_temp_grid);
+		trace_end();
+		if(err != OK)
 		{
 			fprintf(fplog, "Failed to read lulc data for year %i: proc_land_type_area()\n", lulc_year);
 			return err;
@@ -400,6 +576,12 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 			modf((double) (i / ncols_lulc), &int_dbl);
 			grid_y_ul = (int) int_dbl * (num_split);
 			grid_x_ul = (int) rem_dbl * (num_split);
+			// skip the lulc cells outside the region subset bounding box; they have no glu cells to output
+			// the box is the whole working grid if there is no subset
+			if (grid_y_ul + num_split <= row_min || grid_y_ul > row_max ||
+				grid_x_ul + num_split <= col_min || grid_x_ul > col_max) {
+				continue;
+			}
 			// now loop over the working grid cells to store the 1d indices and input areas, and initialize ref veg values
 			count = 0;
 			for (m = grid_y_ul; m < grid_y_ul + num_split; m++) {
@@ -451,7 +633,7 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 				// note that the carbon output from proc_refveg_carbon is for year REF_YEAR only - it uses these same filters
 				// set cell to nodata if it is not a land cell
 				// note that some (330) artcic cells originally have zero land area
-				// additional cells are set to zero below if they are not included in the output calcs
+				// additional cells are set to zero when the grids are written if they are not included in the output calcs
 				//		they are not included in outputs if there is no aez or country 87 value
 				
 				if (land_area_hyde[grid_ind] != raster_info.land_area_hyde_nodata) {
@@ -484,10 +666,18 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 
 				if (land_area_hyde[grid_ind] != raster_info.land_area_hyde_nodata && land_area_hyde[grid_ind] != 0) {
 					
-					aez_val = aez_bounds_new[grid_ind];
-					ctry_code = country_fao[grid_ind];
+					// process only if the cell has a glu in at least one glu scenario
+					in_glu = 0;
+					for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+						if (glu_scen[scen_ind].aez_bounds[grid_ind] != glu_scen[scen_ind].aez_nodata) {
+							in_glu = 1;
+						}
+					}
 					
-					if (aez_val != raster_info.aez_new_nodata) {
+					// the store holds every economic country cell, so that it can be aggregated to any glu raster
+					if (in_glu || do_store) {
+						ctry_code = country_fao[grid_ind];
+						
 						// get the fao country index
 						ctry_ind = NOMATCH;
 						for (m = 0; m < NUM_FAO_CTRY; m++) {
@@ -516,36 +706,12 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 						
 						// skip if not a valid economic country
 						if (ctry_ind == NOMATCH || ctry2ctry87codes_gtap[ctry_ind] == NOMATCH) {
-							// now update this year's grids to reflect that this cell is not included in the outputs
-							// set the areas to zero, and set the refveg category to nodata
-							crop_grid[grid_ind] = 0;
-							pasture_grid[grid_ind] = 0;
-							urban_grid[grid_ind] = 0;
-							for (m = NUM_HYDE_TYPES_MAIN; m < NUM_HYDE_TYPES; m++) {
-								lu_detail_grid[m-NUM_HYDE_TYPES_MAIN][grid_ind] = 0;
-							}
-							refveg_area_grid[grid_ind] = 0;
-                     refveg_them_out[grid_ind] = raster_info.potveg_nodata;
+							// flag this cell as not included in the outputs
+							// the output grids are set to zero area and nodata refveg category here, for the scenarios with a glu in the cell
+							nonecon_grid[grid_ind] = 1;
 							continue;
 						}
 						
-						// get the glu index within the country aez list
-						aez_ind = NOMATCH;
-						for (m = 0; m < ctry_aez_num[ctry_ind]; m++) {
-							if (ctry_aez_list[ctry_ind][m] == aez_val) {
-								aez_ind = m;
-								break;
-							}
-						} // end for m loop to get aez index
-						
-						// this shouldn't happen because the countryXglu list has been made already
-						if (aez_ind == NOMATCH) {
-							fprintf(fplog, "Failed to match glu %i to country %i: proc_land_type_area()\n",aez_val,ctry_code);
-							return ERROR_IND;
-						}
-						
-						// generate the land type category and add/store the area
-						
 						// get index of ref veg to make sure it is valid
 						rv_ind = NOMATCH;
 						for (m = 0; m < NUM_SAGE_PVLT; m++) {
@@ -562,8 +728,40 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 							rv_value = refveg_them[j];
 						}
 						
-						//Print log 
-						//fprintf(fplog, "Currently processing protected category %i:proc_land_type_area()\n", k);
+						if (do_store) {
+							if ((err = add_cell_store(grid_ind, ctry_ind, rv_value, refveg_area_out[j], lu_area[j][crop_ind],
+													  lu_area[j][pasture_ind], lu_area[j][urban_ind])) != OK) {
+								fprintf(fplog, "Failed to store cell %i for year %i: proc_land_type_area()\n", grid_ind, hyde_years[year_ind]);
+								return err;
+							}
+						}
+						if (!in_glu) {
+							continue;
+						}
+						
+						// get the glu index within the country aez list of each scenario; NOMATCH if the scenario has no glu here
+						for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+							aez_val = glu_scen[scen_ind].aez_bounds[grid_ind];
+							scen_aez_ind[scen_ind] = NOMATCH;
+							if (aez_val == glu_scen[scen_ind].aez_nodata) {
+								continue;
+							}
+							for (m = 0; m < glu_scen[scen_ind].ctry_aez_num[ctry_ind]; m++) {
+								if (glu_scen[scen_ind].ctry_aez_list[ctry_ind][m] == aez_val) {
+									scen_aez_ind[scen_ind] = m;
+									break;
+								}
+							} // end for m loop to get aez index
+							
+							// this shouldn't happen because the countryXglu list has been made already
+							if (scen_aez_ind[scen_ind] == NOMATCH) {
+								fprintf(fplog, "Failed to match glu %i to country %i: proc_land_type_area()\n",aez_val,ctry_code);
+								return ERROR_IND;
+							}
+						} // end for scen_ind loop to get aez index
+						
+						// generate the land type category and add/store the area
+						
 						// reference veg; i.e. non-crop, non-pasture, non-urban
 						
 						//kbn 2020
@@ -574,8 +772,6 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 							// reference veg
 							cur_lt_cat = rv_value * SCALE_POTVEG + k;
 							
-							//fprintf(fplog,"cur_lt_cat is %i",cur_lt_cat);
-							
 							cur_lt_cat_ind = NOMATCH;
 							for (m = 0; m < num_lt_cats; m++) {
 								if (lt_cats[m] == cur_lt_cat) {
@@ -588,41 +784,15 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 								return ERROR_IND;
 							}
 							if (refveg_area_out[j] != NODATA) { // don't add if NODATA
-								tmp_dbl =(refveg_area_out[j]) * temp_frac;
-								area_out[ctry_ind][aez_ind][cur_lt_cat_ind][year_ind] = area_out[ctry_ind][aez_ind][cur_lt_cat_ind][year_ind] +((refveg_area_out[j]) * temp_frac);
-								
-								//if(j = 100){
-								//fprintf(fplog,"protected area is %i, reference area is %lf, cur_lt_cat is %i",protected_EPA[k][j],refveg_area_out[j],cur_lt_cat);
-								//}
+								if ((err = add_scen_area(area_out, scen_aez_ind, ctry_ind, cur_lt_cat_ind, ((refveg_area_out[j]) * temp_frac))) != OK) {
+									return err;
+								}
 								
 								// sum the global out land type area
 								// use the rv values as the index to capture the unknown value of zero
 								global_lt_out[rv_value] = global_lt_out[rv_value] + ((refveg_area_out[j])* temp_frac);
 							}
 							
-							/*
-							if(countrycodes_fao[ctry_ind] == 58 && aez_val == 180) {
-								if(cur_lt_cat == 1007) {
-									fprintf(fplog, "ctry %i, glu %i, lt %i, rv = %i, gi = %i: ra = %lf, pf = %f \n", countrycodes_fao[ctry_ind], aez_val, cur_lt_cat, rv_ind, grid_ind, refveg_area_out[j], temp_frac);
-									if (refveg_area_out[j] != refveg_area[grid_ind]) {
-										;
-									}
-									if (temp_frac > 0) {
-										;
-									}
-								}
-								if(cur_lt_cat == 1303) {
-									fprintf(fplog, "ctry %i, glu %i, lt %i, rv = %i, gi = %i: ra = %lf, pf = %f \n", countrycodes_fao[ctry_ind], aez_val, cur_lt_cat, rv_ind, grid_ind, refveg_area_out[j], temp_frac);
-									if (refveg_area_out[j] != refveg_area[grid_ind]) {
-										;
-									}
-									if (temp_frac > 0) {
-										;
-									}
-								}
-							}
-							*/
-							
 							// crop
 							cur_lt_cat = rv_value * SCALE_POTVEG + CROP_LT_CODE + k;
 							cur_lt_cat_ind = NOMATCH;
@@ -637,8 +807,9 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 								return ERROR_IND;
 							}
 							if (lu_area[j][crop_ind] != raster_info.lu_nodata) { // don't add if nodata
-								tmp_dbl = lu_area[j][crop_ind];
-								area_out[ctry_ind][aez_ind][cur_lt_cat_ind][year_ind] = area_out[ctry_ind][aez_ind][cur_lt_cat_ind][year_ind] + ((lu_area[j][crop_ind])* temp_frac);
+								if ((err = add_scen_area(area_out, scen_aez_ind, ctry_ind, cur_lt_cat_ind, ((lu_area[j][crop_ind])* temp_frac))) != OK) {
+									return err;
+								}
 								// sum the global out land type area
 								// sage types plus one are first, then hyde types
 								global_lt_out[crop_ind + NUM_SAGE_PVLT + 1] = global_lt_out[crop_ind + NUM_SAGE_PVLT + 1] + ((lu_area[j][crop_ind]) * temp_frac);
@@ -658,8 +829,9 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 								return ERROR_IND;
 							}
 							if (lu_area[j][pasture_ind] != raster_info.lu_nodata) { // don't add if nodata
-								tmp_dbl = lu_area[j][pasture_ind];
-								area_out[ctry_ind][aez_ind][cur_lt_cat_ind][year_ind] = area_out[ctry_ind][aez_ind][cur_lt_cat_ind][year_ind] + ((lu_area[j][pasture_ind]) * temp_frac);
+								if ((err = add_scen_area(area_out, scen_aez_ind, ctry_ind, cur_lt_cat_ind, ((lu_area[j][pasture_ind]) * temp_frac))) != OK) {
+									return err;
+								}
 								// sum the global out land type area
 								// sage types plus one are first, then hyde types
 								global_lt_out[pasture_ind + NUM_SAGE_PVLT + 1] = global_lt_out[pasture_ind + NUM_SAGE_PVLT + 1] + ((lu_area[j][pasture_ind])* temp_frac);
@@ -674,14 +846,14 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 									break;
 								}
 							}
-							//fprintf(fplog, "Matching categories rv_value %i:,SCALE_POT_VEG %i:,URBAN_LT_CODE %i:,  protected %i\n,cur_cat %i", rv_value,SCALE_POTVEG,URBAN_LT_CODE,protected_thematic[grid_ind],cur_lt_cat);
 							if (cur_lt_cat_ind == NOMATCH) {
 								fprintf(fplog, "Failed to match lt_cat %i:,protected_epa %i:,urban,  proc_land_type_area()\n", cur_lt_cat,grid_ind);
 								return ERROR_IND;
 							}
 							if (lu_area[j][urban_ind] != raster_info.lu_nodata) { // don't add if nodata
-								tmp_dbl = lu_area[j][urban_ind];
-								area_out[ctry_ind][aez_ind][cur_lt_cat_ind][year_ind] = area_out[ctry_ind][aez_ind][cur_lt_cat_ind][year_ind] + ((lu_area[j][urban_ind])* temp_frac);
+								if ((err = add_scen_area(area_out, scen_aez_ind, ctry_ind, cur_lt_cat_ind, ((lu_area[j][urban_ind])* temp_frac))) != OK) {
+									return err;
+								}
 								// sum the global out land type area
 								// sage types plus one are first, then hyde types
 								global_lt_out[urban_ind + NUM_SAGE_PVLT + 1] = global_lt_out[urban_ind + NUM_SAGE_PVLT + 1] + ((lu_area[j][urban_ind]) * temp_frac);
@@ -689,7 +861,6 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 							
 							// sum the detailed lu categories also
 							for (m = NUM_HYDE_TYPES_MAIN; m < NUM_HYDE_TYPES; m++) {
-								tmp_dbl = lu_area[j][m];
 								if (lu_area[j][m] != raster_info.lu_nodata) { // don't add if nodata
 									global_lt_out[m + NUM_SAGE_PVLT + 1] = global_lt_out[m + NUM_SAGE_PVLT + 1] + (lu_area[j][m])* temp_frac;
 								}
@@ -738,106 +909,242 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
 			fprintf(fplog, "Global land area: out =\t%lf;\tin =\t%lf\n", global_area_out, global_area_in);
 		} // end if write diagnostics
 		
-		// write specified year's land cover/use grids if desired
-		
-		if (hyde_years[year_ind] == in_args.lulc_out_year) {
-			// cropland area
-			strcpy(fname, "cropland_area_");
-			sprintf(tmp_str, "%i.bil", hyde_years[year_ind]);
-			strcat(fname, tmp_str);
-			if ((err = write_raster_float(crop_grid, NUM_CELLS, fname, in_args))) {
-				fprintf(fplog, "Error writing file %s: proc_land_type_area()\n", fname);
-				return err;
-			}
-			// pasture area
-			strcpy(fname, "pasture_area_");
-			sprintf(tmp_str, "%i.bil", hyde_years[year_ind]);
-			strcat(fname, tmp_str);
-			if ((err = write_raster_float(pasture_grid, NUM_CELLS, fname, in_args))) {
-				fprintf(fplog, "Error writing file %s: proc_land_type_area()\n", fname);
-				return err;
-			}
-			// urban area
-			strcpy(fname, "urban_area_");
-			sprintf(tmp_str, "%i.bil", hyde_years[year_ind]);
-			strcat(fname, tmp_str);
-			if ((err = write_raster_float(urban_grid, NUM_CELLS, fname, in_args))) {
-				fprintf(fplog, "Error writing file %s: proc_land_type_area()\n", fname);
-				return err;
-			}
-			// reference vegetation area
-			strcpy(fname, "refveg_area_");
-			sprintf(tmp_str, "%i.bil", hyde_years[year_ind]);
-			strcat(fname, tmp_str);
-			if ((err = write_raster_float(refveg_area_grid, NUM_CELLS, fname, in_args))) {
-				fprintf(fplog, "Error writing file %s: proc_land_type_area()\n", fname);
-				return err;
+		// spill the records of this year that are written to the table, and clear the slice for the next year
+		for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+			// the pairs and their keys are in table order
+			for (ctry_ind = 0; ctry_ind < NUM_FAO_CTRY ; ctry_ind++) {
+				for (aez_ind = 0; aez_ind < glu_scen[scen_ind].ctry_aez_num[ctry_ind]; aez_ind++) {
+					pair = area_out[scen_ind].ctry_start[ctry_ind] + aez_ind;
+					for (key = 0; key < area_out[scen_ind].num_keys[pair]; key++) {
+						cur_lt_cat_ind = area_out[scen_ind].key_lt[pair][key];
+						slot = area_out[scen_ind].key_slot[pair][key];
+						outval = floor(0.5 + area_out[scen_ind].vals[slot] * KMSQ2HA);
+						if (outval > 0) {
+							if ((err = add_year_spill(&spill[scen_ind], year_ind, ctry_ind, aez_ind, cur_lt_cat_ind,
+													  area_out[scen_ind].vals[slot])) != OK) {
+								return err;
+							}
+							pair_rec[scen_ind][pair] = 1;
+							lt_rec[scen_ind][cur_lt_cat_ind] = 1;
+							year_rec[scen_ind][year_ind] = 1;
+						}
+						area_out[scen_ind].vals[slot] = 0;
+					}
+				}
 			}
-			// reference vegetation types
-			strcpy(fname, "refveg_thematic_");
-			sprintf(tmp_str, "%i.bil", hyde_years[year_ind]);
-			strcat(fname, tmp_str);
-			if ((err = write_raster_int(refveg_them_out, NUM_CELLS, fname, in_args))) {
-				fprintf(fplog, "Error writing file %s: proc_land_type_area()\n", fname);
+		} // end for scen_ind loop over glu scenarios
+		
+		if (do_store) {
+			if ((err = write_cell_store_year(year_ind)) != OK) {
+				fprintf(fplog, "Failed to write the cell store for year %i: proc_land_type_area()\n", hyde_years[year_ind]);
 				return err;
 			}
 		}
 		
+		// write specified year's land cover/use grids if desired
+		// for each glu scenario, the cells with a glu but without a valid economic country are set to zero
+		
+		if (hyde_years[year_ind] == in_args.lulc_out_year) {
+			for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+				scen_args = in_args;
+				strcpy(scen_args.outpath, glu_scen[scen_ind].outpath);
+				
+				// cropland area
+				for (j = 0; j < NUM_CELLS; j++) {
+					out_grid[j] = crop_grid[j];
+					if (nonecon_grid[j] && glu_scen[scen_ind].aez_bounds[j] != glu_scen[scen_ind].aez_nodata) {
+						out_grid[j] = 0;
+					}
+				}
+				strcpy(fname, "cropland_area_");
+				sprintf(tmp_str, "%i.bil", hyde_years[year_ind]);
+				strcat(fname, tmp_str);
+				if ((err = write_raster_float(out_grid, NUM_CELLS, fname, scen_args))) {
+					fprintf(fplog, "Error writing file %s: proc_land_type_area()\n", fname);
+					return err;
+				}
+				// pasture area
+				for (j = 0; j < NUM_CELLS; j++) {
+					out_grid[j] = pasture_grid[j];
+					if (nonecon_grid[j] && glu_scen[scen_ind].aez_bounds[j] != glu_scen[scen_ind].aez_nodata) {
+						out_grid[j] = 0;
+					}
+				}
+				strcpy(fname, "pasture_area_");
+				sprintf(tmp_str, "%i.bil", hyde_years[year_ind]);
+				strcat(fname, tmp_str);
+				if ((err = write_raster_float(out_grid, NUM_CELLS, fname, scen_args))) {
+					fprintf(fplog, "Error writing file %s: proc_land_type_area()\n", fname);
+					return err;
+				}
+				// urban area
+				for (j = 0; j < NUM_CELLS; j++) {
+					out_grid[j] = urban_grid[j];
+					if (nonecon_grid[j] && glu_scen[scen_ind].aez_bounds[j] != glu_scen[scen_ind].aez_nodata) {
+						out_grid[j] = 0;
+					}
+				}
+				strcpy(fname, "urban_area_");
+				sprintf(tmp_str, "%i.bil", hyde_years[year_ind]);
+				strcat(fname, tmp_str);
+				if ((err = write_raster_float(out_grid, NUM_CELLS, fname, scen_args))) {
+					fprintf(fplog, "Error writing file %s: proc_land_type_area()\n", fname);
+					return err;
+				}
+				// reference vegetation area
+				for (j = 0; j < NUM_CELLS; j++) {
+					out_grid[j] = refveg_area_grid[j];
+					if (nonecon_grid[j] && glu_scen[scen_ind].aez_bounds[j] != glu_scen[scen_ind].aez_nodata) {
+						out_grid[j] = 0;
+					}
+				}
+				strcpy(fname, "refveg_area_");
+				sprintf(tmp_str, "%i.bil", hyde_years[year_ind]);
+				strcat(fname, tmp_str);
+				if ((err = write_raster_float(out_grid, NUM_CELLS, fname, scen_args))) {
+					fprintf(fplog, "Error writing file %s: proc_land_type_area()\n", fname);
+					return err;
+				}
+				// reference vegetation types
+				for (j = 0; j < NUM_CELLS; j++) {
+					out_them[j] = refveg_them_out[j];
+					if (nonecon_grid[j] && glu_scen[scen_ind].aez_bounds[j] != glu_scen[scen_ind].aez_nodata) {
+						out_them[j] = raster_info.potveg_nodata;
+					}
+				}
+				strcpy(fname, "refveg_thematic_");
+				sprintf(tmp_str, "%i.bil", hyde_years[year_ind]);
+				strcat(fname, tmp_str);
+				if ((err = write_raster_int(out_them, NUM_CELLS, fname, scen_args))) {
+					fprintf(fplog, "Error writing file %s: proc_land_type_area()\n", fname);
+					return err;
+				}
+			} // end for scen_ind loop over glu scenarios
+		}
+		
+		trace_end();
     } // end for year_ind loop over the years
     
-    // write the output file
-    
-    strcpy(fname, in_args.outpath);
-    strcat(fname, in_args.land_type_area_fname);
-    fpout = fopen(fname,"w"); //float
-    if(fpout == NULL)
-    {
-        fprintf(fplog,"Failed to open file  %s for write:  proc_land_type_area()\n", fname);
-        return ERROR_FILE;
+    if (do_store) {
+        if ((err = close_cell_store()) != OK) {
+            return err;
+        }
     }
-    // write header lines
-    fprintf(fpout,"# File: %s\n", fname);
-    fprintf(fpout,"# Author: %s\n", CODENAME);
-    fprintf(fpout,"# Description: area (ha) for land cells in country X glu X land type X protected category X year\n");
-    fprintf(fpout,"# Original source: hyde land use areas; reference veg; land cover; country raster; glu raster; hyde land area\n");
-    fprintf(fpout,"# ----------\n");
-    fprintf(fpout,"iso,glu_code,land_type,year,value");
-    
-    // write the records (convert to ha and round to nearest integer)
-    for (ctry_ind = 0; ctry_ind < NUM_FAO_CTRY ; ctry_ind++) {
-        for (aez_ind = 0; aez_ind < ctry_aez_num[ctry_ind]; aez_ind++) {
-            for (cur_lt_cat_ind = 0; cur_lt_cat_ind < num_lt_cats; cur_lt_cat_ind++) {
-				for (year_ind = 0; year_ind < NUM_HYDE_YEARS; year_ind++) {
-                    tmp_dbl = area_out[ctry_ind][aez_ind][cur_lt_cat_ind][year_ind];
-                    outval = floor(0.5 + area_out[ctry_ind][aez_ind][cur_lt_cat_ind][year_ind] * KMSQ2HA);
-                    // output only positive values
-                    if (outval > 0) {
-                        fprintf(fpout,"\n%s,%i,%i,%i,%.0lf", countryabbrs_iso[ctry_ind], ctry_aez_list[ctry_ind][aez_ind],
-                                lt_cats[cur_lt_cat_ind], hyde_years[year_ind], outval);
-                        nrecords++;
-                    } // end if value is positive
-                } // end for year loop
-            } // end for land type loop
-        } // end for aez loop
-    } // end for country loop
     
-    fclose(fpout);
+    // write the output file for each glu scenario
     
-    fprintf(fplog, "Wrote file %s: proc_land_type_area(); records written=%i\n", fname, nrecords);
+    get_nc_table_fname(nc_fname, in_args.land_type_area_fname);
+    for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+        fpout = NULL;
+        if (in_args.table_format & TABLE_CSV) {
+            strcpy(fname, glu_scen[scen_ind].outpath);
+            strcat(fname, in_args.land_type_area_fname);
+            fpout = fopen(fname,"w"); //float
+            if(fpout == NULL)
+            {
+                fprintf(fplog,"Failed to open file  %s for write:  proc_land_type_area()\n", fname);
+                return ERROR_FILE;
+            }
+            // write header lines
+            fprintf(fpout,"# File: %s\n", fname);
+            fprintf(fpout,"# Author: %s\n", CODENAME);
+            fprintf(fpout,"# Description: area (ha) for land cells in country X glu X land type X protected category X year\n");
+            fprintf(fpout,"# Original source: hyde land use areas; reference veg; land cover; country raster; glu raster; hyde land area\n");
+            fprintf(fpout,"# ----------\n");
+            fprintf(fpout,"iso,glu_code,land_type,year,value");
+        }
+        if (in_args.table_format & TABLE_NC) {
+            // the table is written in slices during the merge, so it is not held in memory
+            if ((err = init_nc_table(&nc_table, 4, nc_key_names, 1, nc_val_names, "ha")) != OK) {
+                return err;
+            }
+            nc_table.key_labels[0] = countryabbrs_iso;
+            strcpy(nc_path, glu_scen[scen_ind].outpath);
+            strcat(nc_path, nc_fname);
+            if ((err = get_table_coords(scen_ind, &area_out[scen_ind], pair_rec[scen_ind], lt_rec[scen_ind], year_rec[scen_ind],
+                                        nc_coords, nc_num_coords)) == OK) {
+                err = open_nc_table(&nc_table, nc_path, "area (ha) for land cells in country X glu X land type X protected category X year",
+                                    (int) spill[scen_ind].num_records, nc_coords, nc_num_coords);
+            }
+            for (i = 0; i < 4; i++) {
+                free(nc_coords[i]);
+            }
+            if (err != OK) {
+                free_nc_table(&nc_table);
+                return err;
+            }
+        }
+        
+        // write the records (convert to ha and round to nearest integer)
+        // the spilled records are merged in country, glu, land type, year order; they are only the positive values
+        nrecords = 0;
+        if ((err = start_year_merge(&spill[scen_ind])) != OK) {
+            return err;
+        }
+        while ((err = next_year_merge(&spill[scen_ind], &spill_rec, &found)) == OK && found) {
+            ctry_ind = spill_rec.ctry_ind;
+            aez_ind = spill_rec.aez_ind;
+            cur_lt_cat_ind = spill_rec.lt_ind;
+            year_ind = spill_rec.year_ind;
+            outval = floor(0.5 + spill_rec.area * KMSQ2HA);
+            if (fpout != NULL) {
+                fprintf(fpout,"\n%s,%i,%i,%i,%.0lf", countryabbrs_iso[ctry_ind], glu_scen[scen_ind].ctry_aez_list[ctry_ind][aez_ind],
+                        lt_cats[cur_lt_cat_ind], hyde_years[year_ind], outval);
+            }
+            if (in_args.table_format & TABLE_NC) {
+                nc_keys[0] = ctry_ind;
+                nc_keys[1] = glu_scen[scen_ind].ctry_aez_list[ctry_ind][aez_ind];
+                nc_keys[2] = lt_cats[cur_lt_cat_ind];
+                nc_keys[3] = hyde_years[year_ind];
+                if ((err = add_nc_table_record(&nc_table, nc_keys, &outval)) != OK) {
+                    break;
+                }
+            }
+            nrecords++;
+        } // end while loop over the merged records
+        if (err != OK) {
+            if (in_args.table_format & TABLE_NC) {
+                free_nc_table(&nc_table);
+            }
+            return err;
+        }
+        if ((err = close_year_spill(&spill[scen_ind])) != OK) {
+            return err;
+        }
+        
+        if (fpout != NULL) {
+            fclose(fpout);
+            fprintf(fplog, "Wrote file %s: proc_land_type_area(); records written=%i\n", fname, nrecords);
+        }
+        if (in_args.table_format & TABLE_NC) {
+            err = close_nc_table(&nc_table);
+            free_nc_table(&nc_table);
+            if (err != OK) {
+                return err;
+            }
+            fprintf(fplog, "Wrote file %s: proc_land_type_area(); records written=%i\n", nc_path, nrecords);
+        }
+    } // end for scen_ind loop over glu scenarios
 	
     free(crop_grid);
     free(pasture_grid);
     free(urban_grid);
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            for (k = 0; k < num_lt_cats; k++) {
-                free(area_out[i][j][k]);
-            }
-            free(area_out[i][j]);
-        }
-        free(area_out[i]);
+    for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+        free_lt_tally(&area_out[scen_ind]);
     }
     free(area_out);
+    for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+        free(pair_rec[scen_ind]);
+        free(lt_rec[scen_ind]);
+        free(year_rec[scen_ind]);
+    }
+    free(pair_rec);
+    free(lt_rec);
+    free(year_rec);
+    free(scen_aez_ind);
+    free(nonecon_grid);
+    free(out_grid);
+    free(out_them);
 	for (i = 0; i < NUM_HYDE_TYPES - NUM_HYDE_TYPES_MAIN; i++) {
 		free(lu_detail_grid[i]);
 	}
@@ -862,3 +1169,32 @@ int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
     return OK;
 
 }
+
+int proc_land_type_area(args_struct in_args, rinfo_struct raster_info) {
+    
+    int scen_ind;
+    int err = OK;
+    char fname[MAXCHAR];        // spill file name
+    year_spill_struct *spill;	// the spilled years of the output table for each glu scenario
+    
+    spill = calloc(num_glu_scen, sizeof(year_spill_struct));
+    if(spill == NULL) {
+        fprintf(fplog,"Failed to allocate memory for spill: proc_land_type_area()\n");
+        return ERROR_MEM;
+    }
+    for (scen_ind = 0; scen_ind < num_glu_scen && err == OK; scen_ind++) {
+        strcpy(fname, glu_scen[scen_ind].outpath);
+        strcat(fname, YEAR_SPILL_FNAME);
+        err = open_year_spill(&spill[scen_ind], fname, num_hyde_years);
+    }
+    if (err == OK) {
+        err = aggregate_land_type_area(in_args, raster_info, spill);
+    }
+    
+    // the spill files are closed when the tables are written; close and remove the rest on error
+    for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+        close_year_spill(&spill[scen_ind]);
+    }
+    free(spill);
+    
+    return err;}
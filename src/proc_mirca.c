@@ -17,6 +17,8 @@
  
  units are hectares - outputs are rounded to hectares
  file names are built here and passed to read_mirca()
+ the mirca files are read one latitude band at a time as the land cells are visited (see get_lat_band())
+    the text files are read in order, so each read continues from the end of the previous band of the file
  the crop # has 1 digit for #<10, and 2 digits for #>=10
  
  process only valid sage land cells, as that is where the crop data comes from
@@ -66,8 +68,16 @@ int proc_mirca(args_struct in_args, rinfo_struct raster_info) {
     int srb_code = 272;         // fao code for serbia
     int mne_code = 273;         // fao code for montenegro
     
-    float *irr_grid;  // 1d array to store current mirca raster file; start up left corner, row by row; lon varies faster
-    float *rfd_grid;  // 1d array to store current mirca raster file; start up left corner, row by row; lon varies faster
+    float *irr_grid;  // 1d array to store one latitude band of current mirca raster file; start up left corner, row by row; lon varies faster
+    float *rfd_grid;  // 1d array to store one latitude band of current mirca raster file; start up left corner, row by row; lon varies faster
+    
+    int band_start_cell = 0;    // first cell of the latitude band in irr_grid and rfd_grid
+    int band_end_cell = 0;      // one past the last cell of the latitude band in irr_grid and rfd_grid
+    int band_cell;              // index of the current land cell within the latitude band
+    long irr_fpos = 0;          // file position of the next latitude band in the irrigated file
+    long rfd_fpos = 0;          // file position of the next latitude band in the rainfed file
+    int irr_row = 0;            // working grid row at irr_fpos; 0 = the start of the file
+    int rfd_row = 0;            // working grid row at rfd_fpos; 0 = the start of the file
 
     
     // output tables as 3-d arrays; ctry, glu, crop; crop varies fastest
@@ -82,8 +92,8 @@ int proc_mirca(args_struct in_args, rinfo_struct raster_info) {
     int nrecords_irr = 0;           // count # of irrigation records written
     int nrecords_rfd = 0;           // count # of rainfed records written
     
-    char fname[MAXCHAR];        // current file name to read, or write irrigation
-    char fname2[MAXCHAR];       // file name to write rainfed
+    char fname[MAXCHAR];        // current file name to read or write irrigation
+    char fname2[MAXCHAR];       // file name to read or write rainfed
     char tmp_str[MAXCHAR];		// stores a temporary string
     
     FILE *fpout;                // out file pointer for irrigation
@@ -96,13 +106,13 @@ int proc_mirca(args_struct in_args, rinfo_struct raster_info) {
     
     // allocate arrays
     
-    irr_grid = calloc(NUM_CELLS, sizeof(float));
+    irr_grid = calloc(raster_info.band_nrows * NUM_LON, sizeof(float));
     if(irr_grid == NULL) {
         fprintf(fplog,"Failed to allocate memory for irr_grid: proc_mirca()\n");
         return ERROR_MEM;
     }
     
-    rfd_grid = calloc(NUM_CELLS, sizeof(float));
+    rfd_grid = calloc(raster_info.band_nrows * NUM_LON, sizeof(float));
     if(rfd_grid == NULL) {
         fprintf(fplog,"Failed to allocate memory for rfd_grid: proc_mirca()\n");
         return ERROR_MEM;
@@ -146,31 +156,55 @@ int proc_mirca(args_struct in_args, rinfo_struct raster_info) {
     // loop over the MIRCA crops
     for (crop_index = 0; crop_index < NUM_MIRCA_CROPS; crop_index++) {
         
-        // read the irrigated crop file
+        trace_begin("crop", "mirca crop %i", crop_index + 1);
+        
+        // the irrigated and rainfed crop files are read by latitude band in the cell loop
+        //  the bands are read in order, and each one continues from where the last one ended
+        //  the rows between the bands that hold land cells are skipped over
         strcpy(fname, in_args.mircapath);
         strcat(fname, irr_base);
         sprintf(tmp_str, "%i%s", (crop_index+1), mirca_tag);
         strcat(fname, tmp_str);
-        if((err = read_mirca(fname, irr_grid)) != OK)
-        {
-            fprintf(fplog, "Failed to read file %s for input: proc_mirca()\n",fname);
-            return err;
-        }
-        
-        // read the rainfed crop file
-        strcpy(fname, in_args.mircapath);
-        strcat(fname, rfd_base);
-        sprintf(tmp_str, "%i%s", (crop_index+1), mirca_tag);
-        strcat(fname, tmp_str);
-        if((err = read_mirca(fname, rfd_grid)) != OK)
-        {
-            fprintf(fplog, "Failed to read file %s for input: proc_mirca()\n",fname);
-            return err;
-        }
+        strcpy(fname2, in_args.mircapath);
+        strcat(fname2, rfd_base);
+        strcat(fname2, tmp_str);
+        band_start_cell = 0;
+        band_end_cell = 0;
+        irr_row = 0;
+        rfd_row = 0;
         
         // loop over the valid sage land cells
         //  and skip it if no valid glu value or country value
         for (j = 0; j < num_land_cells_sage; j++) {
+            // read the latitude band that holds this cell
+            if (land_cells_sage[j] >= band_end_cell) {
+                if ((err = get_lat_band(land_cells_sage[j], raster_info, &band_start_cell, &band_end_cell)) != OK) {
+                    fprintf(fplog, "Failed to get latitude band at cell %i: proc_mirca()\n", land_cells_sage[j]);
+                    return err;
+                }
+                trace_begin("io", "read_mirca %s", fname);
+                err = read_mirca(fname, band_start_cell / NUM_LON, (band_end_cell - band_start_cell) / NUM_LON,
+                                 raster_info.subset_col_min, raster_info.subset_col_max - raster_info.subset_col_min + 1,
+                                 &irr_fpos, &irr_row, irr_grid);
+                trace_end();
+                if(err != OK)
+                {
+                    fprintf(fplog, "Failed to read file %s for input: proc_mirca()\n",fname);
+                    return err;
+                }
+                trace_begin("io", "read_mirca %s", fname2);
+                err = read_mirca(fname2, band_start_cell / NUM_LON, (band_end_cell - band_start_cell) / NUM_LON,
+                                 raster_info.subset_col_min, raster_info.subset_col_max - raster_info.subset_col_min + 1,
+                                 &rfd_fpos, &rfd_row, rfd_grid);
+                trace_end();
+                if(err != OK)
+                {
+                    fprintf(fplog, "Failed to read file %s for input: proc_mirca()\n",fname2);
+                    return err;
+                }
+            }
+            band_cell = get_band_cell(land_cells_sage[j], band_start_cell, raster_info);
+            
             aez_val = aez_bounds_new[land_cells_sage[j]];
             ctry_code = country_fao[land_cells_sage[j]];
             
@@ -220,11 +254,12 @@ int proc_mirca(args_struct in_args, rinfo_struct raster_info) {
                     return ERROR_IND;
                 }
 
-                irr_out[ctry_ind][aez_ind][crop_index] = irr_out[ctry_ind][aez_ind][crop_index] + irr_grid[land_cells_sage[j]];
-                rfd_out[ctry_ind][aez_ind][crop_index] = rfd_out[ctry_ind][aez_ind][crop_index] + rfd_grid[land_cells_sage[j]];
+                irr_out[ctry_ind][aez_ind][crop_index] = irr_out[ctry_ind][aez_ind][crop_index] + irr_grid[band_cell];
+                rfd_out[ctry_ind][aez_ind][crop_index] = rfd_out[ctry_ind][aez_ind][crop_index] + rfd_grid[band_cell];
                 
             }	// end if valid aez cell
         }	// end for j loop over valid sage land cells
+        trace_end();
     }   // end for loop over the mirca crops
     
     // write the output files
@@ -33,6 +33,9 @@
  
  serbia and montenegro data are merged
  
+ table_format selects the csv table, the compressed netcdf-4 table (see write_nc_table.c), or both
+    the netcdf table has the same records, with the .csv extension of refveg_carbon_fname replaced by .nc
+ 
  arguments:
  args_struct in_args: the input file arguments
  rinfo_struct *raster_info: information about input raster data
@@ -70,6 +73,14 @@
    return ( *(float*)a - *(float*)b );
 }
 
+// add one carbon type record of the output table to the netcdf table
+static int add_carbon_record(nc_table_struct *nc_table, int ctry_ind, int glu_code, int lt_cat, int c_type_ind,
+							 float wavg, float median, float min, float max, float q1, float q3) {
+	int keys[4] = {ctry_ind, glu_code, lt_cat, c_type_ind};
+	double vals[6] = {wavg, median, min, max, q1, q3};
+	return add_nc_table_record(nc_table, keys, vals);
+}
+
 int proc_refveg_carbon(args_struct in_args, rinfo_struct raster_info) {
     
     // valid values in the hyde land area data set determine the land cells to process
@@ -123,9 +134,9 @@ int proc_refveg_carbon(args_struct in_args, rinfo_struct raster_info) {
     float temp_float;           // temporary float
     float temp_ag_ratio;
     float temp_bg_ratio;
-    int ***soil_carbon_array_size; //temporary size of array, used to get the grid index
-    int ***soil_carbon_array_size_NODATA; //temporary size of array, used to get the grid index of the NODATA cells
-    int ***veg_carbon_array_size_NODATA; //temporary size of array, used to get the grid index of the NODATA cells
+    int *soil_carbon_array_size; //temporary size of array, used to get the grid index
+    int *soil_carbon_array_size_NODATA; //temporary size of array, used to get the grid index of the NODATA cells
+    int *veg_carbon_array_size_NODATA; //temporary size of array, used to get the grid index of the NODATA cells
     int memory_median=0;           //These are the cell indices to be used for soil_carbon_array and veg_carbon_array
     int memory_min=0;              //These are the cell indices to be used for soil_carbon_array and veg_carbon_array
     int memory_max=0;              //These are the cell indices to be used for soil_carbon_array and veg_carbon_array      
@@ -134,7 +145,7 @@ int proc_refveg_carbon(args_struct in_args, rinfo_struct raster_info) {
     int size_max=0;                //These are the cell indices to be used for soil_carbon_array and veg_carbon_array
     float global_soil_temp=0;
     // output table as 4-d array
-    float ***refveg_carbon_area;        // the reference area for carbon calculation  
+    float *refveg_carbon_area;        // the reference area for carbon calculation  
     int soilc_ind = 0;                  // index in output array
     int vegc_ag_ind = 1;                   // index in output array
     int vegc_bg_ind = 2;
@@ -147,11 +158,21 @@ int proc_refveg_carbon(args_struct in_args, rinfo_struct raster_info) {
     int cur_lt_cat_ind;             // current land type category index
     int cur_lt_cat_ind_temp;
     int cur_lt_cat_temp;
+    int num_slots;          // the number of reference veg carbon keys; the arrays are indexed by refveg_carbon_tally slot
+    int slot;               // slot of the current country glu land type category
+    int slot_temp;          // slot of the temporary land type category
+    int pair;               // current country glu pair in refveg_carbon_tally
+    int key;                // current key of the pair
     int num_out_vals = 3;   // the number of values to output (soil c den, veg c den, area for averaging)
     int nrecords = 0;       // count # of records written
     
     char fname[MAXCHAR];        // current file name to write
     FILE *fpout;                // out file pointer
+    nc_table_struct nc_table;   // the netcdf table
+    const char *nc_key_names[] = {"iso", "glu_code", "land_type", "c_type"};
+    const char *nc_val_names[] = {"weighted_average", "median_value", "min_value", "max_value", "q1_value", "q3_value"};
+    char *c_type_names[] = {"soil_c (0-30 cms)", "veg_c (above ground biomass)", "veg_c (below ground biomass)"};
+    char nc_fname[MAXCHAR];     // the netcdf table file name
     float temp_frac;           //Create temporary fraction for protected areas
     int size=0;                //Integer representing size of array
     int size_temp=0;           //
@@ -160,127 +181,41 @@ int proc_refveg_carbon(args_struct in_args, rinfo_struct raster_info) {
 
    
 
-    refveg_carbon_out = calloc(NUM_FAO_CTRY, sizeof(float****));
+    // the output arrays have one entry for each reference veg carbon key found in write_glu_mapping()
+    num_slots = refveg_carbon_tally.num_slots;
+    refveg_carbon_out = calloc(num_slots + 1, sizeof(float**));
     if(refveg_carbon_out == NULL) {
         fprintf(fplog,"Failed to allocate memory for refveg_carbon_out: proc_refveg_carbon()\n");
         return ERROR_MEM;
     }
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        refveg_carbon_out[i] = calloc(ctry_aez_num[i], sizeof(float***));
+    for (i = 0; i < num_slots; i++) {
+        refveg_carbon_out[i] = calloc(num_out_vals, sizeof(float*));
         if(refveg_carbon_out[i] == NULL) {
             fprintf(fplog,"Failed to allocate memory for refveg_carbon_out[%i]: proc_refveg_carbon()\n", i);
             return ERROR_MEM;
         }
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            refveg_carbon_out[i][j] = calloc(num_lt_cats, sizeof(float**));
-            if(refveg_carbon_out[i][j] == NULL) {
-                fprintf(fplog,"Failed to allocate memory for refveg_carbon_out[%i][%i]: proc_refveg_carbon()\n", i, j);
-                return ERROR_MEM;
-            }
-            for (k = 0; k < num_lt_cats; k++) {
-                refveg_carbon_out[i][j][k] = calloc(num_out_vals, sizeof(float*));
-                if(refveg_carbon_out[i][j][k] == NULL) {
-                    fprintf(fplog,"Failed to allocate memory for refveg_carbon_out[%i][%i][%i]: proc_refveg_carbon()\n", i, j, k);
-                    return ERROR_MEM;
-                }
-                for (l=0 ; l < num_out_vals; l++){
-                refveg_carbon_out[i][j][k][l] = calloc(NUM_CARBON, sizeof(float));
-                if(refveg_carbon_out[i][j][k][l] == NULL) {
-                    fprintf(fplog,"Failed to allocate memory for refveg_carbon_out[%i][%i][%i][%i]: proc_refveg_carbon()\n", i, j, k,l);
-                    return ERROR_MEM;
-                } 
-                }// end l loop for carbon states
-            } // end for k num_lt_cats
-        } // end for j loop over aez
-    } // end for i loop over fao country
+        for (l=0 ; l < num_out_vals; l++){
+        refveg_carbon_out[i][l] = calloc(NUM_CARBON, sizeof(float));
+        if(refveg_carbon_out[i][l] == NULL) {
+            fprintf(fplog,"Failed to allocate memory for refveg_carbon_out[%i][%i]: proc_refveg_carbon()\n", i, l);
+            return ERROR_MEM;
+        } 
+        }// end l loop for carbon states
+    } // end for i loop over the carbon keys
     
 
 
   //Allocate carbon area here
-   refveg_carbon_area = calloc(NUM_FAO_CTRY, sizeof(float**));
-    if(refveg_carbon_out == NULL) {
-        fprintf(fplog,"Failed to allocate memory for refveg_carbon_out: proc_refveg_carbon()\n");
-        return ERROR_MEM;
-    }
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        refveg_carbon_area[i] = calloc(ctry_aez_num[i], sizeof(float*));
-        if(refveg_carbon_area[i] == NULL) {
-            fprintf(fplog,"Failed to allocate memory for refveg_carbon_out[%i]: proc_refveg_carbon()\n", i);
-            return ERROR_MEM;
-        }
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            refveg_carbon_area[i][j] = calloc(num_lt_cats, sizeof(float));
-            if(refveg_carbon_area[i][j] == NULL) {
-                fprintf(fplog,"Failed to allocate memory for refveg_carbon_out[%i][%i]: proc_refveg_carbon()\n", i, j);
-                return ERROR_MEM;
-            }    
-            } // end for num_lt_cats
-        } // end for j loop over aez
-    
+    refveg_carbon_area = calloc(num_slots + 1, sizeof(float));
     //Use this variable to calculate size of arrays since we cannot use Sizeof in a for loop
-    soil_carbon_array_size = calloc(NUM_FAO_CTRY, sizeof(int**));
-    if(soil_carbon_array_size == NULL) {
-        fprintf(fplog,"Failed to allocate memory for refveg_carbon_out: proc_refveg_carbon()\n");
-        return ERROR_MEM;
-    }
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        soil_carbon_array_size[i] = calloc(ctry_aez_num[i], sizeof(int*));
-        if(soil_carbon_array_size[i] == NULL) {
-            fprintf(fplog,"Failed to allocate memory for refveg_carbon_out[%i]: proc_refveg_carbon()\n", i);
-            return ERROR_MEM;
-        }
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            soil_carbon_array_size[i][j] = calloc(num_lt_cats, sizeof(int));
-            if(soil_carbon_array_size[i][j] == NULL) {
-                fprintf(fplog,"Failed to allocate memory for refveg_carbon_out[%i][%i]: proc_refveg_carbon()\n", i, j);
-                return ERROR_MEM;
-            }   
-             // end for k loop over output values
-            } // end for j loop over aezs
-        }
-
-
-    soil_carbon_array_size_NODATA = calloc(NUM_FAO_CTRY, sizeof(int**));
-    if(soil_carbon_array_size_NODATA == NULL) {
-        fprintf(fplog,"Failed to allocate memory for refveg_carbon_out: proc_refveg_carbon()\n");
-        return ERROR_MEM;
-    }
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        soil_carbon_array_size_NODATA[i] = calloc(ctry_aez_num[i], sizeof(int*));
-        if(soil_carbon_array_size_NODATA[i] == NULL) {
-            fprintf(fplog,"Failed to allocate memory for refveg_carbon_out[%i]: proc_refveg_carbon()\n", i);
-            return ERROR_MEM;
-        }
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            soil_carbon_array_size_NODATA[i][j] = calloc(num_lt_cats, sizeof(int));
-            if(soil_carbon_array_size_NODATA[i][j] == NULL) {
-                fprintf(fplog,"Failed to allocate memory for refveg_carbon_out[%i][%i]: proc_refveg_carbon()\n", i, j);
-                return ERROR_MEM;
-            }   
-             // end for k loop over output values
-            } // end for j loop over aezs
-        } 
-    
-    veg_carbon_array_size_NODATA = calloc(NUM_FAO_CTRY, sizeof(int**));
-    if(veg_carbon_array_size_NODATA == NULL) {
-        fprintf(fplog,"Failed to allocate memory for refveg_carbon_out: proc_refveg_carbon()\n");
+    soil_carbon_array_size = calloc(num_slots + 1, sizeof(int));
+    soil_carbon_array_size_NODATA = calloc(num_slots + 1, sizeof(int));
+    veg_carbon_array_size_NODATA = calloc(num_slots + 1, sizeof(int));
+    if(refveg_carbon_area == NULL || soil_carbon_array_size == NULL || soil_carbon_array_size_NODATA == NULL ||
+       veg_carbon_array_size_NODATA == NULL) {
+        fprintf(fplog,"Failed to allocate memory for refveg_carbon_area and the carbon array sizes: proc_refveg_carbon()\n");
         return ERROR_MEM;
     }
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        veg_carbon_array_size_NODATA[i] = calloc(ctry_aez_num[i], sizeof(int*));
-        if(veg_carbon_array_size_NODATA[i] == NULL) {
-            fprintf(fplog,"Failed to allocate memory for refveg_carbon_out[%i]: proc_refveg_carbon()\n", i);
-            return ERROR_MEM;
-        }
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            veg_carbon_array_size_NODATA[i][j] = calloc(num_lt_cats, sizeof(int));
-            if(veg_carbon_array_size_NODATA[i][j] == NULL) {
-                fprintf(fplog,"Failed to allocate memory for refveg_carbon_out[%i][%i]: proc_refveg_carbon()\n", i, j);
-                return ERROR_MEM;
-            }   
-             // end for k loop over output values
-            } // end for j loop over aezs
-        }
 
 
     
@@ -382,6 +317,11 @@ int proc_refveg_carbon(args_struct in_args, rinfo_struct raster_info) {
 					fprintf(fplog, "Failed to match lt_cat %i: proc_refveg_carbon()\n", cur_lt_cat);
 					return ERROR_IND;
 				}
+				slot_temp = find_lt_tally_slot(&refveg_carbon_tally, ctry_ind, aez_ind, cur_lt_cat_ind_temp);
+				if (slot_temp == NOMATCH) {
+					fprintf(fplog, "Failed to match lt_cat %i to country %i glu %i: proc_refveg_carbon()\n", cur_lt_cat_temp, ctry_code, aez_val);
+					return ERROR_IND;
+				}
              //End calculation of temporary land type category
 
 
@@ -405,50 +345,55 @@ int proc_refveg_carbon(args_struct in_args, rinfo_struct raster_info) {
 					fprintf(fplog, "Failed to match lt_cat %i: proc_refveg_carbon()\n", cur_lt_cat);
 					return ERROR_IND;
 				}
+				slot = find_lt_tally_slot(&refveg_carbon_tally, ctry_ind, aez_ind, cur_lt_cat_ind);
+				if (slot == NOMATCH) {
+					fprintf(fplog, "Failed to match lt_cat %i to country %i glu %i: proc_refveg_carbon()\n", cur_lt_cat, ctry_code, aez_val);
+					return ERROR_IND;
+				}
                 
                 
                 //fprintf(stdout, "\nStarting cell %i country %i aez %i lt_cat %i started at %s\n", grid_ind,ctry_ind,aez_ind,cur_lt_cat_ind, get_systime());
               if (cur_lt_cat_ind==cur_lt_cat_ind_temp){  
               //Calculate the size here
-              soil_carbon_array_size[ctry_ind][aez_ind][cur_lt_cat_ind_temp]=soil_carbon_array_size[ctry_ind][aez_ind][cur_lt_cat_ind_temp]+1;
+              soil_carbon_array_size[slot_temp]=soil_carbon_array_size[slot_temp]+1;
 
               //Calculate the size of the NODATA cells
 
               if(soil_carbon_sage[1][grid_ind] == NODATA && soil_carbon_sage[2][grid_ind] == NODATA && soil_carbon_sage[3][grid_ind] == NODATA && soil_carbon_sage[4][grid_ind] == NODATA && soil_carbon_sage[5][grid_ind] == NODATA){
-               soil_carbon_array_size_NODATA[ctry_ind][aez_ind][cur_lt_cat_ind_temp] = soil_carbon_array_size_NODATA[ctry_ind][aez_ind][cur_lt_cat_ind_temp]+1;   
+               soil_carbon_array_size_NODATA[slot_temp] = soil_carbon_array_size_NODATA[slot_temp]+1;   
               }
              
              if(veg_carbon_sage[1][grid_ind] == NODATA && veg_carbon_sage[2][grid_ind] == NODATA && veg_carbon_sage[3][grid_ind] == NODATA && veg_carbon_sage[4][grid_ind] == NODATA && veg_carbon_sage[5][grid_ind] == NODATA){
-               veg_carbon_array_size_NODATA[ctry_ind][aez_ind][cur_lt_cat_ind_temp] = veg_carbon_array_size_NODATA[ctry_ind][aez_ind][cur_lt_cat_ind_temp]+1;   
+               veg_carbon_array_size_NODATA[slot_temp] = veg_carbon_array_size_NODATA[slot_temp]+1;   
               }
 
              //Now reduce the cells by 1
              //This ensures that we are always allocating in accordance with the size of the arrays and avoiding segmentation faults.
-             soil_carbon_array_cells[ctry_ind][aez_ind][cur_lt_cat_ind_temp]= soil_carbon_array_cells[ctry_ind][aez_ind][cur_lt_cat_ind_temp]-1;
+             soil_carbon_array_cells[slot_temp]= soil_carbon_array_cells[slot_temp]-1;
              //Make sure the number of cells is not 0              
               //Convert the curent number of cells to an integer
               //If number of cells is 10 we want to allocate from grid index 0-9. That's why we deduct 1 from above
-              memory_median = (float) floor((double) 0.5+ soil_carbon_array_cells[ctry_ind][aez_ind][cur_lt_cat_ind_temp]);
-              memory_min = (float) floor((double) 0.5+ soil_carbon_array_cells[ctry_ind][aez_ind][cur_lt_cat_ind_temp]);
-              memory_max = (float) floor((double) 0.5+ soil_carbon_array_cells[ctry_ind][aez_ind][cur_lt_cat_ind_temp]);
-              memory_q1 = (float) floor((double) 0.5+ soil_carbon_array_cells[ctry_ind][aez_ind][cur_lt_cat_ind_temp]);
-              memory_q3 = (float) floor((double) 0.5+ soil_carbon_array_cells[ctry_ind][aez_ind][cur_lt_cat_ind_temp]);
+              memory_median = (float) floor((double) 0.5+ soil_carbon_array_cells[slot_temp]);
+              memory_min = (float) floor((double) 0.5+ soil_carbon_array_cells[slot_temp]);
+              memory_max = (float) floor((double) 0.5+ soil_carbon_array_cells[slot_temp]);
+              memory_q1 = (float) floor((double) 0.5+ soil_carbon_array_cells[slot_temp]);
+              memory_q3 = (float) floor((double) 0.5+ soil_carbon_array_cells[slot_temp]);
               
              //Now use that as the grid index both for soil dnd vegetation carbon
-             soil_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][0][memory_median]=soil_carbon_sage[0][grid_ind];
-             soil_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][1][memory_median]=soil_carbon_sage[1][grid_ind];
-             soil_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][2][memory_min]=soil_carbon_sage[2][grid_ind];
-             soil_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][3][memory_max]=soil_carbon_sage[3][grid_ind];
-             soil_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][4][memory_q1]=soil_carbon_sage[4][grid_ind];
-             soil_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][5][memory_q3]=soil_carbon_sage[5][grid_ind];
-
-
-             veg_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][0][memory_median]=veg_carbon_sage[0][grid_ind];
-             veg_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][1][memory_median]=veg_carbon_sage[1][grid_ind];
-             veg_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][2][memory_min]=veg_carbon_sage[2][grid_ind];
-             veg_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][3][memory_max]=veg_carbon_sage[3][grid_ind];
-             veg_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][4][memory_q1]=veg_carbon_sage[4][grid_ind];
-             veg_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][5][memory_q3]=veg_carbon_sage[5][grid_ind];
+             soil_carbon_array[slot_temp][0][memory_median]=soil_carbon_sage[0][grid_ind];
+             soil_carbon_array[slot_temp][1][memory_median]=soil_carbon_sage[1][grid_ind];
+             soil_carbon_array[slot_temp][2][memory_min]=soil_carbon_sage[2][grid_ind];
+             soil_carbon_array[slot_temp][3][memory_max]=soil_carbon_sage[3][grid_ind];
+             soil_carbon_array[slot_temp][4][memory_q1]=soil_carbon_sage[4][grid_ind];
+             soil_carbon_array[slot_temp][5][memory_q3]=soil_carbon_sage[5][grid_ind];
+
+
+             veg_carbon_array[slot_temp][0][memory_median]=veg_carbon_sage[0][grid_ind];
+             veg_carbon_array[slot_temp][1][memory_median]=veg_carbon_sage[1][grid_ind];
+             veg_carbon_array[slot_temp][2][memory_min]=veg_carbon_sage[2][grid_ind];
+             veg_carbon_array[slot_temp][3][memory_max]=veg_carbon_sage[3][grid_ind];
+             veg_carbon_array[slot_temp][4][memory_q1]=veg_carbon_sage[4][grid_ind];
+             veg_carbon_array[slot_temp][5][memory_q3]=veg_carbon_sage[5][grid_ind];
 				
                
 				// calculate an area weighted average based on ref veg area for REF_YEAR
@@ -459,22 +404,22 @@ int proc_refveg_carbon(args_struct in_args, rinfo_struct raster_info) {
                 //sort arrays 
                 
                 //size is the current size of the array
-                size=soil_carbon_array_size[ctry_ind][aez_ind][cur_lt_cat_ind_temp];
+                size=soil_carbon_array_size[slot_temp];
                 
 
                 //sort the arrays based on size
-                qsort( soil_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][1],size,sizeof(float),cmpfunc);
-                qsort( soil_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][2],size,sizeof(float),cmpfunc);
-                qsort( soil_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][3],size,sizeof(float),cmpfunc);
-                qsort( soil_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][4],size,sizeof(float),cmpfunc);
-                qsort( soil_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][5],size,sizeof(float),cmpfunc);
+                qsort( soil_carbon_array[slot_temp][1],size,sizeof(float),cmpfunc);
+                qsort( soil_carbon_array[slot_temp][2],size,sizeof(float),cmpfunc);
+                qsort( soil_carbon_array[slot_temp][3],size,sizeof(float),cmpfunc);
+                qsort( soil_carbon_array[slot_temp][4],size,sizeof(float),cmpfunc);
+                qsort( soil_carbon_array[slot_temp][5],size,sizeof(float),cmpfunc);
               
 
-                qsort( veg_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][1],size,sizeof(float),cmpfunc);
-                qsort( veg_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][2],size,sizeof(float),cmpfunc);
-                qsort( veg_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][3],size,sizeof(float),cmpfunc);
-                qsort( veg_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][4],size,sizeof(float),cmpfunc);
-                qsort( veg_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][5],size,sizeof(float),cmpfunc);
+                qsort( veg_carbon_array[slot_temp][1],size,sizeof(float),cmpfunc);
+                qsort( veg_carbon_array[slot_temp][2],size,sizeof(float),cmpfunc);
+                qsort( veg_carbon_array[slot_temp][3],size,sizeof(float),cmpfunc);
+                qsort( veg_carbon_array[slot_temp][4],size,sizeof(float),cmpfunc);
+                qsort( veg_carbon_array[slot_temp][5],size,sizeof(float),cmpfunc);
                 }
 
                 //Recalculate size since we need the 'index' now not the size. This is an issue for the max array, q3 array. 
@@ -483,46 +428,46 @@ int proc_refveg_carbon(args_struct in_args, rinfo_struct raster_info) {
                 // Process only if the value is a non-NODATA value 
                
                if(soil_carbon_sage[0][grid_ind] != NODATA){
-				refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][0] =
-				refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][0] +
+				refveg_carbon_out[slot][soilc_ind][0] =
+				refveg_carbon_out[slot][soilc_ind][0] +
 				soil_carbon_sage[0][grid_ind] * refcarbon_area[grid_ind]*temp_frac;
                }
 
                 //2. Median
-				size= soil_carbon_array_size[ctry_ind][aez_ind][cur_lt_cat_ind_temp];
-                size_temp=(size/2)+soil_carbon_array_size_NODATA[ctry_ind][aez_ind][cur_lt_cat_ind_temp];
-                temp_float= soil_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][1][size_temp];
+				size= soil_carbon_array_size[slot_temp];
+                size_temp=(size/2)+soil_carbon_array_size_NODATA[slot_temp];
+                temp_float= soil_carbon_array[slot_temp][1][size_temp];
                 
-                refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][1] =
+                refveg_carbon_out[slot][soilc_ind][1] =
 				temp_float;
 
                 //3. Min
-                size_temp= soil_carbon_array_size_NODATA[ctry_ind][aez_ind][cur_lt_cat_ind_temp];
-                temp_float= soil_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][2][size_temp];
-                refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][2] =
+                size_temp= soil_carbon_array_size_NODATA[slot_temp];
+                temp_float= soil_carbon_array[slot_temp][2][size_temp];
+                refveg_carbon_out[slot][soilc_ind][2] =
 				temp_float;
                 
                 //4. Max
                 size_temp=size/2;
                 
-                temp_float= soil_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][3][size_max];
+                temp_float= soil_carbon_array[slot_temp][3][size_max];
                                
-                refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][3] =
+                refveg_carbon_out[slot][soilc_ind][3] =
 				temp_float ;
 
                 //5. Q1
-                size_temp=(size*0.25) + soil_carbon_array_size_NODATA[ctry_ind][aez_ind][cur_lt_cat_ind_temp];
-                temp_float= soil_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][4][size_temp];
+                size_temp=(size*0.25) + soil_carbon_array_size_NODATA[slot_temp];
+                temp_float= soil_carbon_array[slot_temp][4][size_temp];
 
 
-                refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][4] =
+                refveg_carbon_out[slot][soilc_ind][4] =
 				temp_float;
 
                 //6. Q3
-                size_temp=size*0.75 + soil_carbon_array_size_NODATA[ctry_ind][aez_ind][cur_lt_cat_ind_temp];
-                temp_float= soil_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][5][size_temp];
+                size_temp=size*0.75 + soil_carbon_array_size_NODATA[slot_temp];
+                temp_float= soil_carbon_array[slot_temp][5][size_temp];
 
-                refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][5] =
+                refveg_carbon_out[slot][soilc_ind][5] =
 				temp_float;
 
 				// veg c
@@ -537,12 +482,12 @@ int proc_refveg_carbon(args_struct in_args, rinfo_struct raster_info) {
                 
                 
                 if(veg_carbon_sage[0][grid_ind] != NODATA){
-				refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][0] =
-				refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][0] +
+				refveg_carbon_out[slot][vegc_ag_ind][0] =
+				refveg_carbon_out[slot][vegc_ag_ind][0] +
 				veg_carbon_sage[0][grid_ind] * refcarbon_area[grid_ind] * temp_frac * above_ground_ratio[0][grid_ind];
 				
-               refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][0] =
-			   refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][0] +
+               refveg_carbon_out[slot][vegc_bg_ind][0] =
+			   refveg_carbon_out[slot][vegc_bg_ind][0] +
 			   veg_carbon_sage[0][grid_ind] * refcarbon_area[grid_ind] * temp_frac * below_ground_ratio[0][grid_ind];
                
 
@@ -554,61 +499,61 @@ int proc_refveg_carbon(args_struct in_args, rinfo_struct raster_info) {
                
                
                }
-            temp_ag_ratio = refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][0]/(refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][0]+refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][0]);
+            temp_ag_ratio = refveg_carbon_out[slot][vegc_ag_ind][0]/(refveg_carbon_out[slot][vegc_bg_ind][0]+refveg_carbon_out[slot][vegc_ag_ind][0]);
                 temp_bg_ratio = 1 - temp_ag_ratio;
                 
                 
                 //2. Median
-                size_temp=(size/2)+veg_carbon_array_size_NODATA[ctry_ind][aez_ind][cur_lt_cat_ind_temp];
-                temp_float= veg_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][1][size_temp];
+                size_temp=(size/2)+veg_carbon_array_size_NODATA[slot_temp];
+                temp_float= veg_carbon_array[slot_temp][1][size_temp];
                 
-                refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][1] =
+                refveg_carbon_out[slot][vegc_ag_ind][1] =
 				temp_float*temp_ag_ratio;
 
-                refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][1] =
+                refveg_carbon_out[slot][vegc_bg_ind][1] =
 				temp_float* temp_bg_ratio;
                 //3. Min
-                size_temp=veg_carbon_array_size_NODATA[ctry_ind][aez_ind][cur_lt_cat_ind_temp];
-                temp_float= veg_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][2][size_temp];
+                size_temp=veg_carbon_array_size_NODATA[slot_temp];
+                temp_float= veg_carbon_array[slot_temp][2][size_temp];
                 
-                refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][2] =
+                refveg_carbon_out[slot][vegc_ag_ind][2] =
 				temp_float * temp_ag_ratio;
                 
-                refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][2] =
+                refveg_carbon_out[slot][vegc_bg_ind][2] =
 				temp_float * temp_bg_ratio;
 
                 //4. Max
                 size_temp=size/2;
-                temp_float= veg_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][3][size_max];
+                temp_float= veg_carbon_array[slot_temp][3][size_max];
                                
-                refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][3] =
+                refveg_carbon_out[slot][vegc_ag_ind][3] =
 				temp_float * temp_ag_ratio;
                 
-                refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][3] =
+                refveg_carbon_out[slot][vegc_bg_ind][3] =
 				temp_float * temp_bg_ratio;
                 //5. Q1
-                size_temp=(size*0.25)+veg_carbon_array_size_NODATA[ctry_ind][aez_ind][cur_lt_cat_ind_temp];
-                temp_float= veg_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][4][size_temp];
+                size_temp=(size*0.25)+veg_carbon_array_size_NODATA[slot_temp];
+                temp_float= veg_carbon_array[slot_temp][4][size_temp];
 
-                refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][4] =
+                refveg_carbon_out[slot][vegc_ag_ind][4] =
 				temp_float * temp_ag_ratio;
 
-                refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][4] =
+                refveg_carbon_out[slot][vegc_bg_ind][4] =
 				temp_float * temp_bg_ratio;
 
                 //6. Q3
-                size_temp=(size*0.75)+veg_carbon_array_size_NODATA[ctry_ind][aez_ind][cur_lt_cat_ind_temp];
-                temp_float= veg_carbon_array[ctry_ind][aez_ind][cur_lt_cat_ind_temp][5][size_temp];
+                size_temp=(size*0.75)+veg_carbon_array_size_NODATA[slot_temp];
+                temp_float= veg_carbon_array[slot_temp][5][size_temp];
 
-                refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][5] =
+                refveg_carbon_out[slot][vegc_ag_ind][5] =
 				temp_float * temp_ag_ratio;
 
-                refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][5] =
+                refveg_carbon_out[slot][vegc_bg_ind][5] =
 				temp_float * temp_bg_ratio;
 
 				// area
-				refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind] =
-				refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind] +
+				refveg_carbon_area[slot] =
+				refveg_carbon_area[slot] +
 				refcarbon_area[grid_ind]*temp_frac;
 				
 	          			
@@ -619,167 +564,207 @@ int proc_refveg_carbon(args_struct in_args, rinfo_struct raster_info) {
 	
     // write the output file
 	//fprintf(stdout, "\nSuccessfully processed all cells at %s\n", get_systime());
-    strcpy(fname, in_args.outpath);
-    strcat(fname, in_args.refveg_carbon_fname);
-    fpout = fopen(fname,"w"); //float
-    if(fpout == NULL)
-    {
-        fprintf(fplog,"Failed to open file  %s for write:  proc_refveg_carbon()\n", fname);
-        return ERROR_FILE;
+    fpout = NULL;
+    if (in_args.table_format & TABLE_CSV) {
+        strcpy(fname, in_args.outpath);
+        strcat(fname, in_args.refveg_carbon_fname);
+        fpout = fopen(fname,"w"); //float
+        if(fpout == NULL)
+        {
+            fprintf(fplog,"Failed to open file  %s for write:  proc_refveg_carbon()\n", fname);
+            return ERROR_FILE;
+        }
+        // write header lines
+        fprintf(fpout,"# File: %s\n", fname);
+        fprintf(fpout,"# Author: %s\n", CODENAME);
+        fprintf(fpout,"# Description: ref veg soil and veg carbon density (Mg/ha) for hyde land cells in country X glu X land type\n");
+        fprintf(fpout,"# Original source: soil c for sage pot veg; veg c for sage pot veg; reference veg; country raster; new glu raster; hyde land area\n");
+        fprintf(fpout,"# ----------\n");
+        fprintf(fpout,"iso,glu_code,land_type,c_type,weighted_average,median_value,min_value,max_value,q1_value,q3_value");
+    }
+    if (in_args.table_format & TABLE_NC) {
+        if ((err = init_nc_table(&nc_table, 4, nc_key_names, 6, nc_val_names, "Mg/ha")) != OK) {
+            return err;
+        }
+        nc_table.key_labels[0] = countryabbrs_iso;
+        nc_table.key_labels[3] = c_type_names;
     }
-    // write header lines
-    fprintf(fpout,"# File: %s\n", fname);
-    fprintf(fpout,"# Author: %s\n", CODENAME);
-    fprintf(fpout,"# Description: ref veg soil and veg carbon density (Mg/ha) for hyde land cells in country X glu X land type\n");
-    fprintf(fpout,"# Original source: soil c for sage pot veg; veg c for sage pot veg; reference veg; country raster; new glu raster; hyde land area\n");
-    fprintf(fpout,"# ----------\n");
-    fprintf(fpout,"iso,glu_code,land_type,c_type,weighted_average,median_value,min_value,max_value,q1_value,q3_value");
     
     // write the records (rounded to integer)
-    //Trying to free memory here since the free command seems to crash below
+    // only the keys that occur are written; the keys of each country glu are in land type order
     for (ctry_ind = 0; ctry_ind < NUM_FAO_CTRY ; ctry_ind++) {
         for (aez_ind = 0; aez_ind < ctry_aez_num[ctry_ind]; aez_ind++) {
-            for (cur_lt_cat_ind = 0; cur_lt_cat_ind < num_lt_cats; cur_lt_cat_ind++) {
+            pair = refveg_carbon_tally.ctry_start[ctry_ind] + aez_ind;
+            for (key = 0; key < refveg_carbon_tally.num_keys[pair]; key++) {
+				cur_lt_cat_ind = refveg_carbon_tally.key_lt[pair][key];
+				slot = refveg_carbon_tally.key_slot[pair][key];
 				// round the area first to match the proc_land_type area output categories
-				temp_float = (float) floor((double) 0.5 + refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind] * KMSQ2HA);
+				temp_float = (float) floor((double) 0.5 + refveg_carbon_area[slot] * KMSQ2HA);
 				if (temp_float > 0) {
 					
 					// output only the carbon values - soil is the first index
 					// dived by area to get average, convert to Mg/ha, and round at the end
 					
 					// soil carbon for each state
-					temp_float =  refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][0] /
-					refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind];
+					temp_float =  refveg_carbon_out[slot][soilc_ind][0] /
+					refveg_carbon_area[slot];
 					outval_soilc = (float) floor((double) 0.5 + temp_float);
 
-                    temp_float =  refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][1];
+                    temp_float =  refveg_carbon_out[slot][soilc_ind][1];
 					
 					outval_soilc_median = (float) floor((double) 0.5 + temp_float);
                     
-                    temp_float =  refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][2];
+                    temp_float =  refveg_carbon_out[slot][soilc_ind][2];
 					outval_soilc_min = (float) floor((double) 0.5 + temp_float);
                     
-                    temp_float =  refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][3];
+                    temp_float =  refveg_carbon_out[slot][soilc_ind][3];
 					outval_soilc_max = (float) floor((double) 0.5 + temp_float);
                     
-                    temp_float =  refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][4];
+                    temp_float =  refveg_carbon_out[slot][soilc_ind][4];
 					outval_soilc_q1 = (float) floor((double) 0.5 + temp_float);
 
-                    temp_float =  refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][5];
+                    temp_float =  refveg_carbon_out[slot][soilc_ind][5];
 					outval_soilc_q3 = (float) floor((double) 0.5 + temp_float);
 
 					// sum the total. Need to multiply by 100 to convert km2 to ha
-					global_soilc = global_soilc + (refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][0]*KMSQ2HA);
+					global_soilc = global_soilc + (refveg_carbon_out[slot][soilc_ind][0]*KMSQ2HA);
 
-                    global_soil_temp= refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][1]*refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind]*KMSQ2HA;
+                    global_soil_temp= refveg_carbon_out[slot][soilc_ind][1]*refveg_carbon_area[slot]*KMSQ2HA;
                     global_soilc_median = global_soilc_median + global_soil_temp;
                     
-                    global_soil_temp= refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][2]*refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind]*KMSQ2HA;
+                    global_soil_temp= refveg_carbon_out[slot][soilc_ind][2]*refveg_carbon_area[slot]*KMSQ2HA;
                     global_soilc_min = global_soilc_min + global_soil_temp;
 
                     
-                    global_soil_temp=refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][3]*refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind]*KMSQ2HA;
+                    global_soil_temp=refveg_carbon_out[slot][soilc_ind][3]*refveg_carbon_area[slot]*KMSQ2HA;
                     global_soilc_max = global_soilc_max + global_soil_temp;
                     
-                    global_soil_temp=refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][4]*refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind]*KMSQ2HA;
+                    global_soil_temp=refveg_carbon_out[slot][soilc_ind][4]*refveg_carbon_area[slot]*KMSQ2HA;
                     global_soilc_q1 = global_soilc_q1 + global_soil_temp;
                     
-                    global_soil_temp= refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][soilc_ind][5]*refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind]*KMSQ2HA;
+                    global_soil_temp= refveg_carbon_out[slot][soilc_ind][5]*refveg_carbon_area[slot]*KMSQ2HA;
                     global_soilc_q3 = global_soilc_q3 + global_soil_temp;
                     
 					// write the value only if weighted average is over 0 and all other values are 0 or above.
 					if (outval_soilc > 0 &&  outval_soilc_median >=0 && outval_soilc_min >=0 && outval_soilc_max >=0 &&  outval_soilc_q1 >=0  && outval_soilc_q3 >= 0 ) {
-						fprintf(fpout,"\n%s,%i,%i,%s", countryabbrs_iso[ctry_ind], ctry_aez_list[ctry_ind][aez_ind],
-								lt_cats[cur_lt_cat_ind], "soil_c (0-30 cms)");
-						fprintf(fpout,",%.0f", outval_soilc);
-                        fprintf(fpout,",%.0f", outval_soilc_median);
-                        fprintf(fpout,",%.0f", outval_soilc_min);
-                        fprintf(fpout,",%.0f", outval_soilc_max);
-                        fprintf(fpout,",%.0f", outval_soilc_q1);
-                        fprintf(fpout,",%.0f", outval_soilc_q3);
+						if (fpout != NULL) {
+							fprintf(fpout,"\n%s,%i,%i,%s", countryabbrs_iso[ctry_ind], ctry_aez_list[ctry_ind][aez_ind],
+									lt_cats[cur_lt_cat_ind], c_type_names[0]);
+							fprintf(fpout,",%.0f", outval_soilc);
+							fprintf(fpout,",%.0f", outval_soilc_median);
+							fprintf(fpout,",%.0f", outval_soilc_min);
+							fprintf(fpout,",%.0f", outval_soilc_max);
+							fprintf(fpout,",%.0f", outval_soilc_q1);
+							fprintf(fpout,",%.0f", outval_soilc_q3);
+						}
+						if (in_args.table_format & TABLE_NC) {
+							if ((err = add_carbon_record(&nc_table, ctry_ind, ctry_aez_list[ctry_ind][aez_ind], lt_cats[cur_lt_cat_ind], 0,
+									outval_soilc, outval_soilc_median, outval_soilc_min, outval_soilc_max, outval_soilc_q1, outval_soilc_q3)) != OK) {
+								free_nc_table(&nc_table);
+								return err;
+							}
+						}
 						nrecords++;
 					}
 					
 					// above ground biomass carbon for each state
-					temp_float = refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][0] /
-					refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind];
+					temp_float = refveg_carbon_out[slot][vegc_ag_ind][0] /
+					refveg_carbon_area[slot];
 					outval_vegc_ag = (float) floor((double) 0.5 + temp_float);
 					
-                    temp_float = refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][1];
+                    temp_float = refveg_carbon_out[slot][vegc_ag_ind][1];
 					outval_vegc_ag_median = (float) floor((double) 0.5 + temp_float);
                     
-                    temp_float = refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][2];
+                    temp_float = refveg_carbon_out[slot][vegc_ag_ind][2];
 					outval_vegc_ag_min = (float) floor((double) 0.5 + temp_float);
                     
-                    temp_float = refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][3];
+                    temp_float = refveg_carbon_out[slot][vegc_ag_ind][3];
 					outval_vegc_ag_max = (float) floor((double) 0.5 + temp_float);
 
-                    temp_float = refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][4];
+                    temp_float = refveg_carbon_out[slot][vegc_ag_ind][4];
 					outval_vegc_ag_q1 = (float) floor((double) 0.5 + temp_float);
 
-                    temp_float = refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][5];
+                    temp_float = refveg_carbon_out[slot][vegc_ag_ind][5];
 					outval_vegc_ag_q3 = (float) floor((double) 0.5 + temp_float);
 
                    // below ground biomass carbon for each state
-					temp_float = refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][0] /
-					refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind];
+					temp_float = refveg_carbon_out[slot][vegc_bg_ind][0] /
+					refveg_carbon_area[slot];
 					outval_vegc_bg = (float) floor((double) 0.5 + temp_float);
 					
-                    temp_float = refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][1];
+                    temp_float = refveg_carbon_out[slot][vegc_bg_ind][1];
 					outval_vegc_bg_median = (float) floor((double) 0.5 + temp_float);
                     
-                    temp_float = refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][2];
+                    temp_float = refveg_carbon_out[slot][vegc_bg_ind][2];
 					outval_vegc_bg_min = (float) floor((double) 0.5 + temp_float);
                     
-                    temp_float = refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][3];
+                    temp_float = refveg_carbon_out[slot][vegc_bg_ind][3];
 					outval_vegc_bg_max = (float) floor((double) 0.5 + temp_float);
 
-                    temp_float = refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][4];
+                    temp_float = refveg_carbon_out[slot][vegc_bg_ind][4];
 					outval_vegc_bg_q1 = (float) floor((double) 0.5 + temp_float);
 
-                    temp_float = refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][5];
+                    temp_float = refveg_carbon_out[slot][vegc_bg_ind][5];
 					outval_vegc_bg_q3 = (float) floor((double) 0.5 + temp_float);
 
 
                     // sum the total. Need to multiply by 100 for converting land from km2 to ha
                     if (outval_vegc_ag >= 0 &&  outval_vegc_ag_median >=0 && outval_vegc_ag_min >=0 && outval_vegc_ag_max >=0 &&  outval_vegc_ag_q1 >=0  && outval_vegc_ag_q3 >= 0 ) {
-					global_vegc_ag = global_vegc_ag + (refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][0]*KMSQ2HA);
-                    global_vegc_median_ag = global_vegc_median_ag + (refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][1]*refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind]*KMSQ2HA);
-                    global_vegc_min_ag = global_vegc_min_ag + (refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][2]*refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind]*KMSQ2HA);
-                    global_vegc_max_ag = global_vegc_max_ag + (refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][3]*refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind]*KMSQ2HA);
-                    global_vegc_q1_ag = global_vegc_q1_ag + (refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][4]*refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind]*KMSQ2HA);
-                    global_vegc_q3_ag = global_vegc_q3_ag + (refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_ag_ind][5]*refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind]*KMSQ2HA);
+					global_vegc_ag = global_vegc_ag + (refveg_carbon_out[slot][vegc_ag_ind][0]*KMSQ2HA);
+                    global_vegc_median_ag = global_vegc_median_ag + (refveg_carbon_out[slot][vegc_ag_ind][1]*refveg_carbon_area[slot]*KMSQ2HA);
+                    global_vegc_min_ag = global_vegc_min_ag + (refveg_carbon_out[slot][vegc_ag_ind][2]*refveg_carbon_area[slot]*KMSQ2HA);
+                    global_vegc_max_ag = global_vegc_max_ag + (refveg_carbon_out[slot][vegc_ag_ind][3]*refveg_carbon_area[slot]*KMSQ2HA);
+                    global_vegc_q1_ag = global_vegc_q1_ag + (refveg_carbon_out[slot][vegc_ag_ind][4]*refveg_carbon_area[slot]*KMSQ2HA);
+                    global_vegc_q3_ag = global_vegc_q3_ag + (refveg_carbon_out[slot][vegc_ag_ind][5]*refveg_carbon_area[slot]*KMSQ2HA);
 					
-                    global_vegc_bg = global_vegc_bg + (refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][0]*KMSQ2HA);
-                    global_vegc_median_bg = global_vegc_median_bg + (refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][1]*refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind]*KMSQ2HA);
-                    global_vegc_min_bg = global_vegc_min_bg + (refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][2]*refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind]*KMSQ2HA);
-                    global_vegc_max_bg = global_vegc_max_bg + (refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][3]*refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind]*KMSQ2HA);
-                    global_vegc_q1_bg = global_vegc_q1_bg + (refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][4]*refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind]*KMSQ2HA);
-                    global_vegc_q3_bg = global_vegc_q3_bg + (refveg_carbon_out[ctry_ind][aez_ind][cur_lt_cat_ind][vegc_bg_ind][5]*refveg_carbon_area[ctry_ind][aez_ind][cur_lt_cat_ind]*KMSQ2HA);
+                    global_vegc_bg = global_vegc_bg + (refveg_carbon_out[slot][vegc_bg_ind][0]*KMSQ2HA);
+                    global_vegc_median_bg = global_vegc_median_bg + (refveg_carbon_out[slot][vegc_bg_ind][1]*refveg_carbon_area[slot]*KMSQ2HA);
+                    global_vegc_min_bg = global_vegc_min_bg + (refveg_carbon_out[slot][vegc_bg_ind][2]*refveg_carbon_area[slot]*KMSQ2HA);
+                    global_vegc_max_bg = global_vegc_max_bg + (refveg_carbon_out[slot][vegc_bg_ind][3]*refveg_carbon_area[slot]*KMSQ2HA);
+                    global_vegc_q1_bg = global_vegc_q1_bg + (refveg_carbon_out[slot][vegc_bg_ind][4]*refveg_carbon_area[slot]*KMSQ2HA);
+                    global_vegc_q3_bg = global_vegc_q3_bg + (refveg_carbon_out[slot][vegc_bg_ind][5]*refveg_carbon_area[slot]*KMSQ2HA);
                     }
 
                     // write the value only if weighted average is over 0 and all other values are 0 or above.
 					if (outval_vegc_ag > 0 &&  outval_vegc_ag_median >=0 && outval_vegc_ag_min >=0 && outval_vegc_ag_max >=0 &&  outval_vegc_ag_q1 >=0  && outval_vegc_ag_q3 >= 0 ) {
-						fprintf(fpout,"\n%s,%i,%i,%s", countryabbrs_iso[ctry_ind], ctry_aez_list[ctry_ind][aez_ind],
-								lt_cats[cur_lt_cat_ind], "veg_c (above ground biomass)");
-						fprintf(fpout,",%.0f", outval_vegc_ag);
-                        fprintf(fpout,",%.0f", outval_vegc_ag_median);
-                        fprintf(fpout,",%.0f", outval_vegc_ag_min);
-                        fprintf(fpout,",%.0f", outval_vegc_ag_max);
-                        fprintf(fpout,",%.0f", outval_vegc_ag_q1);
-                        fprintf(fpout,",%.0f", outval_vegc_ag_q3);
+						if (fpout != NULL) {
+							fprintf(fpout,"\n%s,%i,%i,%s", countryabbrs_iso[ctry_ind], ctry_aez_list[ctry_ind][aez_ind],
+									lt_cats[cur_lt_cat_ind], c_type_names[1]);
+							fprintf(fpout,",%.0f", outval_vegc_ag);
+							fprintf(fpout,",%.0f", outval_vegc_ag_median);
+							fprintf(fpout,",%.0f", outval_vegc_ag_min);
+							fprintf(fpout,",%.0f", outval_vegc_ag_max);
+							fprintf(fpout,",%.0f", outval_vegc_ag_q1);
+							fprintf(fpout,",%.0f", outval_vegc_ag_q3);
+						}
+						if (in_args.table_format & TABLE_NC) {
+							if ((err = add_carbon_record(&nc_table, ctry_ind, ctry_aez_list[ctry_ind][aez_ind], lt_cats[cur_lt_cat_ind], 1,
+									outval_vegc_ag, outval_vegc_ag_median, outval_vegc_ag_min, outval_vegc_ag_max, outval_vegc_ag_q1, outval_vegc_ag_q3)) != OK) {
+								free_nc_table(&nc_table);
+								return err;
+							}
+						}
 						nrecords++;
 					                    }
                    
                    if (outval_vegc_bg > 0 &&  outval_vegc_bg_median >=0 && outval_vegc_bg_min >=0 && outval_vegc_bg_max >=0 &&  outval_vegc_bg_q1 >=0  && outval_vegc_bg_q3 >= 0 ) {
-						fprintf(fpout,"\n%s,%i,%i,%s", countryabbrs_iso[ctry_ind], ctry_aez_list[ctry_ind][aez_ind],
-								lt_cats[cur_lt_cat_ind], "veg_c (below ground biomass)");
-						fprintf(fpout,",%.0f", outval_vegc_bg);
-                        fprintf(fpout,",%.0f", outval_vegc_bg_median);
-                        fprintf(fpout,",%.0f", outval_vegc_bg_min);
-                        fprintf(fpout,",%.0f", outval_vegc_bg_max);
-                        fprintf(fpout,",%.0f", outval_vegc_bg_q1);
-                        fprintf(fpout,",%.0f", outval_vegc_bg_q3);
+						if (fpout != NULL) {
+							fprintf(fpout,"\n%s,%i,%i,%s", countryabbrs_iso[ctry_ind], ctry_aez_list[ctry_ind][aez_ind],
+									lt_cats[cur_lt_cat_ind], c_type_names[2]);
+							fprintf(fpout,",%.0f", outval_vegc_bg);
+							fprintf(fpout,",%.0f", outval_vegc_bg_median);
+							fprintf(fpout,",%.0f", outval_vegc_bg_min);
+							fprintf(fpout,",%.0f", outval_vegc_bg_max);
+							fprintf(fpout,",%.0f", outval_vegc_bg_q1);
+							fprintf(fpout,",%.0f", outval_vegc_bg_q3);
+						}
+						if (in_args.table_format & TABLE_NC) {
+							if ((err = add_carbon_record(&nc_table, ctry_ind, ctry_aez_list[ctry_ind][aez_ind], lt_cats[cur_lt_cat_ind], 2,
+									outval_vegc_bg, outval_vegc_bg_median, outval_vegc_bg_min, outval_vegc_bg_max, outval_vegc_bg_q1, outval_vegc_bg_q3)) != OK) {
+								free_nc_table(&nc_table);
+								return err;
+							}
+						}
 						nrecords++;
 					                    }
                                         
@@ -789,7 +774,20 @@ int proc_refveg_carbon(args_struct in_args, rinfo_struct raster_info) {
         } // end for glu loop
     } // end for country loop
 	
-    fclose(fpout);	
+    if (fpout != NULL) {
+        fclose(fpout);
+    }
+    if (in_args.table_format & TABLE_NC) {
+        get_nc_table_fname(nc_fname, in_args.refveg_carbon_fname);
+        strcpy(fname, in_args.outpath);
+        strcat(fname, nc_fname);
+        err = write_nc_table(&nc_table, fname, "ref veg soil and veg carbon density (Mg/ha) for hyde land cells in country X glu X land type");
+        free_nc_table(&nc_table);
+        if (err != OK) {
+            return err;
+        }
+        fprintf(fplog, "Wrote file %s: proc_refveg_carbon(); records written=%i\n", fname, nrecords);
+    }
 
     // also write the total global carbon values to the log file
     // in Mg 
@@ -814,30 +812,13 @@ int proc_refveg_carbon(args_struct in_args, rinfo_struct raster_info) {
     fprintf(fplog, "Veg C (below ground biomass) Q3 = %f\n", global_vegc_q3_bg);
 
   //Free all arrays
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            free(soil_carbon_array_size[i][j]);
-        }free(soil_carbon_array_size[i]);
-   }free(soil_carbon_array_size);
-    
-    
-    for (i = 0; i < NUM_FAO_CTRY; i++) {
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            free(refveg_carbon_area[i][j]);
-        }free(refveg_carbon_area[i]);
-    }free(refveg_carbon_area);
-    
-    
-  
-  for (i = 0; i < NUM_FAO_CTRY; i++) {
-        for (j = 0; j < ctry_aez_num[i]; j++) {
-            for (k = 0; k < num_lt_cats; k++) {
-                for(l = 0; l < num_out_vals; l++){
-                free(refveg_carbon_out[i][j][k][l]);    
-                }
-                free(refveg_carbon_out[i][j][k]);
-            }
-            free(refveg_carbon_out[i][j]);
+    free(soil_carbon_array_size);
+    free(soil_carbon_array_size_NODATA);
+    free(veg_carbon_array_size_NODATA);
+    free(refveg_carbon_area);
+    for (i = 0; i < num_slots; i++) {
+        for(l = 0; l < num_out_vals; l++){
+        free(refveg_carbon_out[i][l]);    
         }
         free(refveg_carbon_out[i]);
     }
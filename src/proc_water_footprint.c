@@ -31,6 +31,8 @@
  serbia and montenegro data are merged
  
  file names are constructed here, and passed to read_water_footprint()
+ the water files are read one latitude band at a time as the land cells are visited (see get_lat_band())
+    with a region subset, only the columns of the subset bounding box are read
  
  the diagnostic outputs are simple binary files of the input data
  these are hardcoded to not output because they require a subdirectory and a fair amount of space
@@ -83,6 +85,11 @@ int proc_water_footprint(args_struct in_args, rinfo_struct raster_info) {
     float *gn_grid;  // 1d array to store current green raster file; start up left corner, row by row; lon varies faster
     float *gy_grid;  // 1d array to store current gray raster file; start up left corner, row by row; lon varies faster
     float *tot_grid;  // 1d array to store current total raster file; start up left corner, row by row; lon varies faster
+    float *wf_grids[NUM_WF_TYPES];	// the blue, green, gray, and total arrays, in the file order of wf_bases
+    
+    int band_start_cell = 0;    // first cell of the latitude band in the water arrays
+    int band_end_cell = 0;      // one past the last cell of the latitude band in the water arrays
+    int band_cell;              // index of the current land cell within the latitude band
     
     // output table as 4-d array; ctry, glu, crop, water type; water type varies fastest
     float ****wf_out;		// the water volume data, in m^3, dim order: blue, green gray, total
@@ -95,8 +102,6 @@ int proc_water_footprint(args_struct in_args, rinfo_struct raster_info) {
     int nrecords_wf = 0;           // count # of irrigation records written
     
     char fname[MAXCHAR];        // current file name to read, or write
-    char tmp_str[MAXCHAR];		// stores a temporary string
-    char diag_name[MAXCHAR];	// for diagnostic output names
     FILE *fpout;                // out file pointer
     
     float wf_nodata = NODATA;  // wf binary file nodata value
@@ -108,6 +113,7 @@ int proc_water_footprint(args_struct in_args, rinfo_struct raster_info) {
     const char gn_base[] = "/wfgn_mmyr.gri";   // green base; 5 arcmin
     const char gy_base[] = "/wfgy_mmyr.gri";   // gray base; 5 arcmin
     const char tot_base[] = "/wftot_mmyr.gri";   // total base; 5 arcmin
+    const char *wf_bases[NUM_WF_TYPES] = {bl_base, gn_base, gy_base, tot_base};
     
     // wf crops (these are the data directory names)
     const char *crop_names[NUM_WF_CROPS] = {"Barley", "Cassava", "Coconuts", "Coffee", "Cotton", "Groundnut", "Maize", "Millet", "Oilpalm", "Olives", "Potatoes", "Rapeseed", "Rice", "Sorghum", "Soybean", "Sugarcane", "Sunflower", "Wheat"};
@@ -117,30 +123,35 @@ int proc_water_footprint(args_struct in_args, rinfo_struct raster_info) {
     
     // allocate arrays
     
-    bl_grid = calloc(NUM_CELLS, sizeof(float));
+    bl_grid = calloc(raster_info.band_nrows * NUM_LON, sizeof(float));
     if(bl_grid == NULL) {
         fprintf(fplog,"Failed to allocate memory for bl_grid: proc_water_footprint()\n");
         return ERROR_MEM;
     }
     
-    gn_grid = calloc(NUM_CELLS, sizeof(float));
+    gn_grid = calloc(raster_info.band_nrows * NUM_LON, sizeof(float));
     if(gn_grid == NULL) {
         fprintf(fplog,"Failed to allocate memory for gn_grid: proc_water_footprint()\n");
         return ERROR_MEM;
     }
     
-    gy_grid = calloc(NUM_CELLS, sizeof(float));
+    gy_grid = calloc(raster_info.band_nrows * NUM_LON, sizeof(float));
     if(gy_grid == NULL) {
         fprintf(fplog,"Failed to allocate memory for gy_grid: proc_water_footprint()\n");
         return ERROR_MEM;
     }
     
-    tot_grid = calloc(NUM_CELLS, sizeof(float));
+    tot_grid = calloc(raster_info.band_nrows * NUM_LON, sizeof(float));
     if(tot_grid == NULL) {
         fprintf(fplog,"Failed to allocate memory for tot_grid: proc_water_footprint()\n");
         return ERROR_MEM;
     }
     
+    wf_grids[0] = bl_grid;
+    wf_grids[1] = gn_grid;
+    wf_grids[2] = gy_grid;
+    wf_grids[3] = tot_grid;
+    
     wf_out = calloc(NUM_FAO_CTRY, sizeof(float***));
     if(wf_out == NULL) {
         fprintf(fplog,"Failed to allocate memory for wf_out: proc_water_footprint()\n");
@@ -171,49 +182,37 @@ int proc_water_footprint(args_struct in_args, rinfo_struct raster_info) {
     // loop over the wf crops
     for (crop_index = 0; crop_index < NUM_WF_CROPS; crop_index++) {
         
-        // read the blue water file
-        strcpy(fname, in_args.wfpath);
-        strcat(fname, crop_names[crop_index]);
-        strcat(fname, bl_base);
-        if((err = read_water_footprint(fname, bl_grid)) != OK)
-        {
-            fprintf(fplog, "Failed to read file %s for input: proc_water_footprint()\n",fname);
-            return err;
-        }
+        trace_begin("crop", "wf %s", crop_names[crop_index]);
         
-        // read the green water file
-        strcpy(fname, in_args.wfpath);
-        strcat(fname, crop_names[crop_index]);
-        strcat(fname, gn_base);
-        if((err = read_water_footprint(fname, gn_grid)) != OK)
-        {
-            fprintf(fplog, "Failed to read file %s for input: proc_water_footprint()\n",fname);
-            return err;
-        }
-        
-        // read the gray water file
-        strcpy(fname, in_args.wfpath);
-        strcat(fname, crop_names[crop_index]);
-        strcat(fname, gy_base);
-        if((err = read_water_footprint(fname, gy_grid)) != OK)
-        {
-            fprintf(fplog, "Failed to read file %s for input: proc_water_footprint()\n",fname);
-            return err;
-        }
-        
-        // read the total water file
-        strcpy(fname, in_args.wfpath);
-        strcat(fname, crop_names[crop_index]);
-        strcat(fname, tot_base);
-        if((err = read_water_footprint(fname, tot_grid)) != OK)
-        {
-            fprintf(fplog, "Failed to read file %s for input: proc_water_footprint()\n",fname);
-            return err;
-        }
+        // the water files are read by latitude band in the cell loop
+        band_end_cell = 0;
         
         // loop over the valid sage land cells
         //  and skip it if no valid glu value or country value
         for (j = 0; j < num_land_cells_sage; j++) {
+            // read the latitude band of the blue, green, gray, and total water files that holds this cell
+            if (land_cells_sage[j] >= band_end_cell) {
+                if ((err = get_lat_band(land_cells_sage[j], raster_info, &band_start_cell, &band_end_cell)) != OK) {
+                    fprintf(fplog, "Failed to get latitude band for cell %i: proc_water_footprint()\n", land_cells_sage[j]);
+                    return err;
+                }
+                for (k = 0; k < NUM_WF_TYPES; k++) {
+                    strcpy(fname, in_args.wfpath);
+                    strcat(fname, crop_names[crop_index]);
+                    strcat(fname, wf_bases[k]);
+                    trace_begin("io", "read_water_footprint %s", fname);
+                    err = read_water_footprint(fname, band_start_cell / NUM_LON, (band_end_cell - band_start_cell) / NUM_LON,
+                                               raster_info.subset_col_min, raster_info.subset_col_max - raster_info.subset_col_min + 1, wf_grids[k]);
+                    trace_end();
+                    if(err != OK)
+                    {
+                        fprintf(fplog, "Failed to read file %s for input: proc_water_footprint()\n",fname);
+                        return err;
+                    }
+                }
+            }
+            band_cell = get_band_cell(land_cells_sage[j], band_start_cell, raster_info);
+            
             glu_val = aez_bounds_new[land_cells_sage[j]];
             ctry_code = country_fao[land_cells_sage[j]];
             
@@ -266,74 +265,45 @@ int proc_water_footprint(args_struct in_args, rinfo_struct raster_info) {
                 //if(ctry_code == 103 && glu_val == 84) {
                 if(0) {
                     printf("grid_ind = %i; x = %f, y = %i\n", land_cells_sage[j], modf(land_cells_sage[j]/NUM_LON, &tmp_dbl) + 1, land_cells_sage[j]/NUM_LON + 1);
-                    printf("blue = %f\nwf_out_blu = %f\n", bl_grid[land_cells_sage[j]], wf_out[ctry_ind][glu_ind][crop_index][0]);
-                    printf("green = %f\nwf_out_grn = %f\n", gn_grid[land_cells_sage[j]], wf_out[ctry_ind][glu_ind][crop_index][1]);
-                    printf("gray = %f\nwf_out_gry = %f\n", gy_grid[land_cells_sage[j]], wf_out[ctry_ind][glu_ind][crop_index][2]);
-                    printf("tot = %f\nwf_out_tot = %f\n", tot_grid[land_cells_sage[j]], wf_out[ctry_ind][glu_ind][crop_index][3]);
+                    printf("blue = %f\nwf_out_blu = %f\n", bl_grid[band_cell], wf_out[ctry_ind][glu_ind][crop_index][0]);
+                    printf("green = %f\nwf_out_grn = %f\n", gn_grid[band_cell], wf_out[ctry_ind][glu_ind][crop_index][1]);
+                    printf("gray = %f\nwf_out_gry = %f\n", gy_grid[band_cell], wf_out[ctry_ind][glu_ind][crop_index][2]);
+                    printf("tot = %f\nwf_out_tot = %f\n", tot_grid[band_cell], wf_out[ctry_ind][glu_ind][crop_index][3]);
                 }
                 
                 // multiply the mm depth by the km^2 grid cell area and add it to the total for this country/glu/crop/wftype
                 // check for valid values first
                 
-                if (bl_grid[land_cells_sage[j]] != wf_nodata) {
+                if (bl_grid[band_cell] != wf_nodata) {
                     wf_out[ctry_ind][glu_ind][crop_index][0] = wf_out[ctry_ind][glu_ind][crop_index][0] +
-                        CONV2M3 * bl_grid[land_cells_sage[j]] * cell_area[land_cells_sage[j]];
+                        CONV2M3 * bl_grid[band_cell] * cell_area_at(land_cells_sage[j]);
                 }
-                if (gn_grid[land_cells_sage[j]] != wf_nodata) {
+                if (gn_grid[band_cell] != wf_nodata) {
                     wf_out[ctry_ind][glu_ind][crop_index][1] = wf_out[ctry_ind][glu_ind][crop_index][1] +
-                        CONV2M3 * gn_grid[land_cells_sage[j]] * cell_area[land_cells_sage[j]];
+                        CONV2M3 * gn_grid[band_cell] * cell_area_at(land_cells_sage[j]);
                 }
-                if (gy_grid[land_cells_sage[j]] != wf_nodata) {
+                if (gy_grid[band_cell] != wf_nodata) {
                     wf_out[ctry_ind][glu_ind][crop_index][2] = wf_out[ctry_ind][glu_ind][crop_index][2] +
-                        CONV2M3 * gy_grid[land_cells_sage[j]] * cell_area[land_cells_sage[j]];
+                        CONV2M3 * gy_grid[band_cell] * cell_area_at(land_cells_sage[j]);
                 }
-                if (tot_grid[land_cells_sage[j]] != wf_nodata) {
+                if (tot_grid[band_cell] != wf_nodata) {
                     wf_out[ctry_ind][glu_ind][crop_index][3] = wf_out[ctry_ind][glu_ind][crop_index][3] +
-                        CONV2M3 * tot_grid[land_cells_sage[j]] * cell_area[land_cells_sage[j]];
+                        CONV2M3 * tot_grid[band_cell] * cell_area_at(land_cells_sage[j]);
                 }
                 
                 //if(ctry_code == 103 && glu_val == 84) {
                 if(0) {
-                    printf("blue = %f\nwf_out_blu = %f\n", bl_grid[land_cells_sage[j]], wf_out[ctry_ind][glu_ind][crop_index][0]);
-                    printf("green = %f\nwf_out_grn = %f\n", gn_grid[land_cells_sage[j]], wf_out[ctry_ind][glu_ind][crop_index][1]);
-                    printf("gray = %f\nwf_out_gry = %f\n", gy_grid[land_cells_sage[j]], wf_out[ctry_ind][glu_ind][crop_index][2]);
-                    printf("tot = %f\nwf_out_tot = %f\n", tot_grid[land_cells_sage[j]], wf_out[ctry_ind][glu_ind][crop_index][3]);
+                    printf("blue = %f\nwf_out_blu = %f\n", bl_grid[band_cell], wf_out[ctry_ind][glu_ind][crop_index][0]);
+                    printf("green = %f\nwf_out_grn = %f\n", gn_grid[band_cell], wf_out[ctry_ind][glu_ind][crop_index][1]);
+                    printf("gray = %f\nwf_out_gry = %f\n", gy_grid[band_cell], wf_out[ctry_ind][glu_ind][crop_index][2]);
+                    printf("tot = %f\nwf_out_tot = %f\n", tot_grid[band_cell], wf_out[ctry_ind][glu_ind][crop_index][3]);
                 }
                 
             }	// end if valid glu cell
         }	// end for j loop over valid sage land cells
         
-        if (0) {
-            // blue
-            sprintf(tmp_str, "%s%s_%s%s", "wf_grids/", crop_names[crop_index], wftype_names[0], ".bil");
-            strcpy(diag_name, tmp_str);
-            if ((err = write_raster_float(bl_grid, NUM_CELLS, diag_name, in_args))) {
-                fprintf(fplog, "Error writing file %s: proc_water_footprint()\n", diag_name);
-                return err;
-            }
-            // green
-            sprintf(tmp_str, "%s%s_%s%s", "wf_grids/", crop_names[crop_index], wftype_names[1], ".bil");
-            strcpy(diag_name, tmp_str);
-            if ((err = write_raster_float(gn_grid, NUM_CELLS, diag_name, in_args))) {
-                fprintf(fplog, "Error writing file %s: proc_water_footprint()\n", diag_name);
-                return err;
-            }
-            // gray
-            sprintf(tmp_str, "%s%s_%s%s", "wf_grids/", crop_names[crop_index], wftype_names[2], ".bil");
-            strcpy(diag_name, tmp_str);
-            if ((err = write_raster_float(gy_grid, NUM_CELLS, diag_name, in_args))) {
-                fprintf(fplog, "Error writing file %s: proc_water_footprint()\n", diag_name);
-                return err;
-            }
-            // total
-            sprintf(tmp_str, "%s%s_%s%s", "wf_grids/", crop_names[crop_index], wftype_names[3], ".bil");
-            strcpy(diag_name, tmp_str);
-            if ((err = write_raster_float(tot_grid, NUM_CELLS, diag_name, in_args))) {
-                fprintf(fplog, "Error writing file %s: proc_water_footprint()\n", diag_name);
-                return err;
-            }
-        }
         
+        trace_end();
     }   // end for loop over the wf crops
     
     // write the output file
@@ -377,10 +347,6 @@ int proc_water_footprint(args_struct in_args, rinfo_struct raster_info) {
     
     fprintf(fplog, "Wrote file %s: proc_water_footprint(); records written=%i\n", fname, nrecords_wf);
     
-  for (i = 0; i < raster_info.lulc_input_ncells; i++) {
-		free(rand_order[i]);
-	}
-	free(rand_order);
     free(bl_grid);
     free(gn_grid);
     free(gy_grid);
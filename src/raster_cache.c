@@ -0,0 +1,248 @@
+/**********
+ raster_cache.c
+
+ read a whole binary raster file into an array, optionally through a process-wide cache of the file contents
+    the file is read through a memory mapped view (see raster_view.c), and copied into the array
+    readers that only read the values use a view directly instead, and need no array or cache
+    the cache is off by default, so a single run reads each file directly, as before
+    moirai --serve turns it on (see moirai_serve.c), so the base rasters are read from disk only by the first request
+        that uses them, and later requests copy them from memory
+
+ a cached file is identified by its name with path, its size, its modification time, and its inode
+    so a file that is replaced or modified between requests is read again
+ the cache is only used for the static base rasters that are copied into arrays (land areas, country, potveg, aez)
+    and for the protected area layers, which read_protected() streams in row blocks
+    the year dependent hyde and lulc inputs are too large to hold for every year and are read by their own functions
+
+ functions:
+ init_raster_cache():	turn the cache on
+ read_raster_file():	read ncells values of insize bytes from the start of fname into data
+ read_raster_block():	read ncells values of insize bytes from value index first of fname into data
+    this is for readers that stream a raster in row blocks; with the cache on, the whole file is cached on the first block
+ free_raster_cache():	free the cached contents and turn the cache off
+
+ arguments:
+ const char *fname:		the file name, with path
+ void *data:			the array to fill; it has at least ncells values of insize bytes
+ int insize:			the number of bytes per value
+ int first:				the index of the first value to read (read_raster_block() only)
+ int ncells:			the number of values to read
+ int *num_read:			the number of values read; less than ncells if the file is too short
+
+ return value:
+ integer error code: OK = 0, ERROR_FILE if the file cannot be opened
+    a short read is not an error here; the caller checks num_read as for fread()
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "moirai.h"
+#include <sys/stat.h>
+
+// one cached raster file
+typedef struct raster_cache_entry {
+	char fname[MAXCHAR];		// file name with path
+	off_t size;					// file size in bytes
+	time_t mtime_sec;			// modification time
+	long mtime_nsec;
+	ino_t ino;					// file serial number
+	int insize;					// bytes per value read
+	int num_read;				// number of values read
+	void *data;					// the values read
+	struct raster_cache_entry *next;
+} raster_cache_entry;
+
+static int cache_on = 0;					// 1 = cache the file contents
+static raster_cache_entry *cache_list = NULL;	// the cached files
+static double cache_bytes = 0;				// total bytes held in the cache
+
+int init_raster_cache(void) {
+	cache_on = 1;
+	return OK;}
+
+// find the cached entry of an unchanged file with at least ncells values; NULL if there is none
+static raster_cache_entry *find_cached(const char *fname, int insize, int ncells, const struct stat *fileinfo) {
+
+	raster_cache_entry *entry;
+
+	for (entry = cache_list; entry != NULL; entry = entry->next) {
+		if (strcmp(entry->fname, fname) == 0 && entry->size == fileinfo->st_size && entry->ino == fileinfo->st_ino &&
+			entry->mtime_sec == fileinfo->st_mtim.tv_sec && entry->mtime_nsec == fileinfo->st_mtim.tv_nsec &&
+			entry->insize == insize && entry->num_read >= ncells) {
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+// get the entry for fname, emptied and stamped with fileinfo, for new contents; NULL if it cannot be allocated
+// a changed file replaces its old entry
+static raster_cache_entry *new_cached(const char *fname, int insize, const struct stat *fileinfo) {
+
+	raster_cache_entry *entry;
+
+	for (entry = cache_list; entry != NULL; entry = entry->next) {
+		if (strcmp(entry->fname, fname) == 0 && entry->insize == insize) {
+			break;
+		}
+	}
+	if (entry == NULL) {
+		entry = calloc(1, sizeof(raster_cache_entry));
+		if (entry == NULL) {
+			return NULL;
+		}
+		strcpy(entry->fname, fname);
+		entry->insize = insize;
+		entry->next = cache_list;
+		cache_list = entry;
+	} else {
+		cache_bytes -= (double) entry->num_read * entry->insize;
+		free(entry->data);
+		entry->data = NULL;
+	}
+	entry->size = fileinfo->st_size;
+	entry->ino = fileinfo->st_ino;
+	entry->mtime_sec = fileinfo->st_mtim.tv_sec;
+	entry->mtime_nsec = fileinfo->st_mtim.tv_nsec;
+	entry->num_read = 0;
+	return entry;
+}
+
+int read_raster_file(const char *fname, void *data, int insize, int ncells, int *num_read) {
+
+	raster_view_struct view;	// the mapped file
+	struct stat fileinfo;		// file size, time, and inode
+	raster_cache_entry *entry;	// the cached file
+
+	*num_read = 0;
+
+	if (cache_on && stat(fname, &fileinfo) == 0 && (entry = find_cached(fname, insize, ncells, &fileinfo)) != NULL) {
+		memcpy(data, entry->data, (size_t) ncells * insize);
+		*num_read = ncells;
+		if (fplog != NULL) {
+			fprintf(fplog, "Read %s from the raster cache: read_raster_file()\n", fname);
+		}
+		return OK;
+	}
+
+	if(open_raster_view(fname, insize, ncells, &view, num_read) != OK) {
+		return ERROR_FILE;
+	}
+	memcpy(data, view.data, (size_t) *num_read * insize);
+	close_raster_view(&view);
+
+	// only complete reads are cached, so a short file is reported again by the caller on the next request
+	if (cache_on && *num_read == ncells && stat(fname, &fileinfo) == 0) {
+		if ((entry = new_cached(fname, insize, &fileinfo)) == NULL) {
+			// not an error; the file is just read again next time
+			return OK;
+		}
+		entry->data = malloc((size_t) ncells * insize);
+		if (entry->data != NULL) {
+			memcpy(entry->data, data, (size_t) ncells * insize);
+			entry->num_read = ncells;
+			cache_bytes += (double) ncells * insize;
+			if (fplog != NULL) {
+				fprintf(fplog, "Added %s to the raster cache (%.1f MB cached): read_raster_file()\n",
+						fname, cache_bytes / 1048576.0);
+			}
+		}
+	}
+
+	return OK;}
+
+int read_raster_block(const char *fname, void *data, int insize, int first, int ncells, int *num_read) {
+
+	FILE *fpin;					// file pointer
+	struct stat fileinfo;		// file size, time, and inode
+	raster_cache_entry *entry;	// the cached file
+	int file_vals;				// number of whole values in the file
+
+	*num_read = 0;
+
+	if (cache_on && stat(fname, &fileinfo) == 0) {
+		if ((entry = find_cached(fname, insize, first + ncells, &fileinfo)) != NULL) {
+			memcpy(data, (char *) entry->data + (size_t) first * insize, (size_t) ncells * insize);
+			*num_read = ncells;
+			if (first == 0 && fplog != NULL) {
+				fprintf(fplog, "Read %s from the raster cache: read_raster_block()\n", fname);
+			}
+			return OK;
+		}
+		// cache the whole file, so the later blocks and requests are copied from memory
+		file_vals = (int) (fileinfo.st_size / insize);
+		if (file_vals >= first + ncells && (entry = new_cached(fname, insize, &fileinfo)) != NULL &&
+			(entry->data = malloc((size_t) file_vals * insize)) != NULL) {
+			if((fpin = fopen(fname, "rb")) == NULL) {
+				return ERROR_FILE;
+			}
+			trace_begin("io", "fread %s", fname);
+			entry->num_read = (int) fread(entry->data, insize, file_vals, fpin);
+			trace_end();
+			fclose(fpin);
+			cache_bytes += (double) entry->num_read * insize;
+			if (entry->num_read >= first + ncells) {
+				memcpy(data, (char *) entry->data + (size_t) first * insize, (size_t) ncells * insize);
+				*num_read = ncells;
+				if (fplog != NULL) {
+					fprintf(fplog, "Added %s to the raster cache (%.1f MB cached): read_raster_block()\n",
+							fname, cache_bytes / 1048576.0);
+				}
+				return OK;
+			}
+			// the file was cut short since the stat; read the block below, and read the file again next time
+			cache_bytes -= (double) entry->num_read * insize;
+			entry->num_read = 0;
+		}
+	}
+
+	if((fpin = fopen(fname, "rb")) == NULL) {
+		return ERROR_FILE;
+	}
+	if (fseeko(fpin, (off_t) first * insize, SEEK_SET) == 0) {
+		trace_begin("io", "fread %s", fname);
+		*num_read = (int) fread(data, insize, ncells, fpin);
+		trace_end();
+	}
+	fclose(fpin);
+
+	return OK;}
+
+int free_raster_cache(void) {
+
+	raster_cache_entry *entry;
+
+	while (cache_list != NULL) {
+		entry = cache_list;
+		cache_list = entry->next;
+		free(entry->data);
+		free(entry);
+	}
+	cache_bytes = 0;
+	cache_on = 0;
+
+	return OK;}
@@ -0,0 +1,130 @@
+/**********
+ raster_view.c
+
+ open and close read-only views of binary raster (bil) files
+    the file is memory mapped, so a reader works on the file pages directly instead of a heap copy of the raster
+    the pages are loaded when they are first used, and are shared through the page cache
+        by all the moirai runs on the node that read the same file
+    if the file cannot be mapped (e.g. it is empty, or on a file system without mmap), it is read into memory instead,
+        and the view is used the same way
+
+ a view is read-only: readers that change the values copy them first (see read_raster_file() in raster_cache.c)
+    the raster_view_float(), raster_view_int(), and raster_view_short() accessors in moirai.h give typed access to the values
+    the caller checks num_read against the cells it needs, as for fread(); the view holds the whole file in any case
+
+ functions:
+ open_raster_view():	open a view of fname
+ close_raster_view():	close the view; closing a view that is not open does nothing
+
+ arguments:
+ const char *fname:			the file name, with path
+ int insize:				the number of bytes per value
+ int ncells:				the number of values the caller needs
+ raster_view_struct *view:	the view
+ int *num_read:				the number of values available, up to ncells; less than ncells if the file is too short
+
+ return value:
+ integer error code: OK = 0, ERROR_FILE if the file cannot be opened or read, ERROR_MEM if it cannot be held in memory
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "moirai.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+int open_raster_view(const char *fname, int insize, int ncells, raster_view_struct *view, int *num_read) {
+
+	int fd;						// file descriptor
+	struct stat fileinfo;		// file size
+	void *addr;					// the mapped or read contents
+	size_t nbytes;				// the file size
+	size_t num_got = 0;			// bytes read, if the file is not mapped
+	ssize_t got;
+
+	*num_read = 0;
+	view->data = NULL;
+	view->insize = insize;
+	view->num_vals = 0;
+	view->map_bytes = 0;
+
+	if ((fd = open(fname, O_RDONLY)) < 0) {
+		return ERROR_FILE;
+	}
+	if (fstat(fd, &fileinfo) != 0) {
+		close(fd);
+		return ERROR_FILE;
+	}
+	nbytes = (size_t) fileinfo.st_size;
+
+	trace_begin("io", "map %s", fname);
+	addr = (nbytes > 0) ? mmap(NULL, nbytes, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+	if (addr != MAP_FAILED) {
+		view->map_bytes = nbytes;
+	} else {
+		// read the file instead
+		if ((addr = malloc(nbytes > 0 ? nbytes : 1)) == NULL) {
+			trace_end();
+			close(fd);
+			return ERROR_MEM;
+		}
+		while (num_got < nbytes && (got = read(fd, (char *) addr + num_got, nbytes - num_got)) > 0) {
+			num_got += (size_t) got;
+		}
+		if (num_got < nbytes) {
+			free(addr);
+			trace_end();
+			close(fd);
+			return ERROR_FILE;
+		}
+	}
+	trace_end();
+	// the mapping stays valid after the file is closed
+	close(fd);
+
+	view->data = addr;
+	view->num_vals = (int) (nbytes / insize);
+	*num_read = (view->num_vals < ncells) ? view->num_vals : ncells;
+
+	return OK;}
+
+int close_raster_view(raster_view_struct *view) {
+
+	if (view->data != NULL) {
+		if (view->map_bytes > 0) {
+			munmap((void *) view->data, view->map_bytes);
+		} else {
+			free((void *) view->data);
+		}
+	}
+	view->data = NULL;
+	view->num_vals = 0;
+	view->map_bytes = 0;
+
+	return OK;}
@@ -49,19 +49,18 @@ int read_aez_orig(args_struct in_args, rinfo_struct *raster_info) {
 	// 5 arcmin resolution, extent = (-180,180, -90, 90), WGS84
 	// values are 1 - 18 global climate aezs
 	
-	int nrows = 2160;				// num input lats
-	int ncols = 4320;				// num input lons
+	int nrows = raster_info->grid_nrows;	// num input lats
+	int ncols = raster_info->grid_ncols;	// num input lons
 	int ncells = nrows * ncols;		// number of input grid cells
 	int nodata = -9999;			// nodata value
 	int insize = 4;					// 4 byte integers for input
-	double res = 5.0 / 60.0;		// resolution
+	double res = raster_info->grid_res;	// resolution
 	double xmin = -180.0;			// longitude min grid boundary
 	double xmax = 180.0;			// longitude max grid boundary
 	double ymin = -90.0;			// latitude min grid boundary
 	double ymax = 90.0;				// latitude max grid boundary
 	
 	char fname[MAXCHAR];			// file name to open
-	FILE *fpin;						// file pointer
 	int num_read;					// how many values read in
 	
 	int err = OK;								// store error code from the write file
@@ -83,15 +82,12 @@ int read_aez_orig(args_struct in_args, rinfo_struct *raster_info) {
 	strcpy(fname, in_args.inpath);
 	strcat(fname, in_args.aez_orig_fname);
 	
-	if((fpin = fopen(fname, "rb")) == NULL)
+	// read the data
+	if(read_raster_file(fname, aez_bounds_orig, insize, ncells, &num_read) != OK)
 	{
 		fprintf(fplog,"Failed to open file %s:  read_aez_orig()\n", fname);
 		return ERROR_FILE;
 	}
-	
-	// read the data
-	num_read = (int) fread(aez_bounds_orig, insize, ncells, fpin);
-	fclose(fpin);
 	if(num_read != ncells)
 	{
 		fprintf(fplog, "Error reading file %s: read_aez_orig(); num_read=%i != overlap_cols=%i\n",
@@ -47,19 +47,18 @@ int read_country_fao(args_struct in_args, rinfo_struct *raster_info) {
 	// 5 arcmin resolution, extent = (-180,180, -90, 90), WGS84
 	// values are integers
 	
-	int nrows = 2160;				// num input lats
-	int ncols = 4320;				// num input lons
+	int nrows = raster_info->grid_nrows;	// num input lats
+	int ncols = raster_info->grid_ncols;	// num input lons
 	int ncells = nrows * ncols;		// number of input grid cells
 	short nodata = -9999;			// nodata value
 	int insize = 2;					// 2 byte integers for input
-	double res = 5.0 / 60.0;		// resolution
+	double res = raster_info->grid_res;	// resolution
 	double xmin = -180.0;			// longitude min grid boundary
 	double xmax = 180.0;			// longitude max grid boundary
 	double ymin = -90.0;			// latitude min grid boundary
 	double ymax = 90.0;				// latitude max grid boundary
 	
 	char fname[MAXCHAR];			// file name to open
-	FILE *fpin;						// file pointer
 	int num_read;					// how many values read in
 	
 	int err = OK;								// store error code from the write file
@@ -81,15 +80,12 @@ int read_country_fao(args_struct in_args, rinfo_struct *raster_info) {
 	strcpy(fname, in_args.inpath);
 	strcat(fname, in_args.country_fao_fname);
 	
-	if((fpin = fopen(fname, "rb")) == NULL)
+	// read the data
+	if(read_raster_file(fname, country_fao, insize, ncells, &num_read) != OK)
 	{
 		fprintf(fplog,"Failed to open file %s:  read_country_fao()\n", fname);
 		return ERROR_FILE;
 	}
-	
-	// read the data
-	num_read = (int) fread(country_fao, insize, ncells, fpin);
-	fclose(fpin);
 	if(num_read != ncells)
 	{
 		fprintf(fplog, "Error reading file %s: read_country_fao(); num_read=%i != ncells=%i\n",
@@ -43,7 +43,7 @@ int read_cropland_sage(args_struct in_args, rinfo_struct *raster_info) {
 	
 	// SAGE 2000 cropland data
 	// netcdf file, all variables are float values
-	// variable farea has 4 dimensions, in order: time (1), level (1), latitude (2160), longitude (4320)
+	// variable farea has 4 dimensions, in order: time (1), level (1), latitude (NUM_LAT), longitude (NUM_LON)
 	// latitude ranges from 90 to -90; longitude from -180 to 180
 	// so the data will be read row by row from the upper left corner
 	// 5 arcmin resolution, extent = (-180,180, -90, 90), ?WGS84?
@@ -51,11 +51,11 @@ int read_cropland_sage(args_struct in_args, rinfo_struct *raster_info) {
 	// convert to working units of_sage km^2, based on sage land area data
 	
 	int i;							// loop variable
-	int nrows = 2160;				// num input lats
-	int ncols = 4320;				// num input lons
+	int nrows = raster_info->grid_nrows;	// num input lats
+	int ncols = raster_info->grid_ncols;	// num input lons
 	int ncells = nrows * ncols;		// number of input grid cells
 	float nodata = 9E20;			// nodata value
-	double res = 5.0 / 60.0;		// resolution
+	double res = raster_info->grid_res;	// resolution
 	double xmin = -180.0;			// longitude min grid boundary
 	double xmax = 180.0;			// longitude max grid boundary
 	double ymin = -90.0;			// latitude min grid boundary
@@ -97,6 +97,12 @@ int read_cropland_sage(args_struct in_args, rinfo_struct *raster_info) {
 		return ERROR_FILE;
 	}
 	
+	// the whole variable is read into the working grid array, so its dimensions have to match
+	if (check_nc_grid(ncid, ncvarid, nrows, ncols, fname) != OK) {
+		fprintf(fplog,"Grid mismatch for netcdf var %s: read_cropland_sage()\n", varname);
+		return ERROR_FILE;
+	}
+	
 	if ((ncerr = nc_get_var_float(ncid, ncvarid, cropland_area_sage))) {
 		fprintf(fplog,"Error %i when reading netcdf var %s: read_cropland_sage()\n", ncerr, varname);
 		return ERROR_FILE;
@@ -0,0 +1,172 @@
+/**********
+ read_glu_batch.c
+
+ set the glu scenarios of the run: glu_scen[num_glu_scen]
+    glu_batch_fname = none: one scenario with aez_new_fname and aez_new_info_fname, written to outpath
+    otherwise the glu batch file lists the scenarios, one csv record each, with 1 header row:
+        name,aez_new_fname,aez_new_info_fname
+    the glu files are in inpath, as for a single run
+    each scenario is written to a subdirectory <name>/ of outpath, ldsdestpath, and mapdestpath
+
+ the scenarios share all of the other inputs, and the land type area is aggregated for every scenario in one pass
+    over the hyde and lulc years (see proc_land_type_area.c), so each added scenario costs only its glu dependent stages
+
+ arguments:
+ args_struct in_args: the input file arguments
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Note that using \r\n with fscanf successfully catches all end of line combinations: \r, \n, \r\n
+ 	but only if there are no assignments!
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+ 
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+ 
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+ 
+ This file is part of Moirai.
+ 
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+ **********/
+
+#include "moirai.h"
+
+int read_glu_batch(args_struct in_args) {
+
+	int i, j;
+	int nrecords = 0;				// count number of scenarios
+
+	char fname[MAXCHAR];			// file name to open
+	FILE *fpin;						// file pointer
+	char rec_str[MAXRECSIZE];		// string to hold one record
+	const char* delim = ",";		// delimiter string for csv file
+	int err = OK;					// error code for the string parsing function
+
+	// one scenario from the input file
+	if (strcmp(in_args.glu_batch_fname, NONE_TEXT) == 0) {
+		num_glu_scen = 1;
+		glu_scen = calloc(num_glu_scen, sizeof(glu_scen_struct));
+		if(glu_scen == NULL) {
+			fprintf(fplog,"Failed to allocate memory for glu_scen: read_glu_batch()\n");
+			return ERROR_MEM;
+		}
+		strcpy(glu_scen[0].name, NONE_TEXT);
+		strcpy(glu_scen[0].aez_new_fname, in_args.aez_new_fname);
+		strcpy(glu_scen[0].aez_new_info_fname, in_args.aez_new_info_fname);
+		strcpy(glu_scen[0].outpath, in_args.outpath);
+		strcpy(glu_scen[0].ldsdestpath, in_args.ldsdestpath);
+		strcpy(glu_scen[0].mapdestpath, in_args.mapdestpath);
+		return OK;
+	}
+
+	// create file name and open it
+	strcpy(fname, in_args.inpath);
+	strcat(fname, in_args.glu_batch_fname);
+
+	if((fpin = fopen(fname, "r")) == NULL)
+	{
+		fprintf(fplog,"Failed to open file %s:  read_glu_batch()\n", fname);
+		return ERROR_FILE;
+	}
+
+	// skip the header line
+	if(fscanf(fpin, "%*[^\r\n]\r\n") == EOF)
+	{
+		fprintf(fplog,"Failed to scan over file %s header:  read_glu_batch()\n", fname);
+		return ERROR_FILE;
+	}
+
+	// count the records
+	while (fscanf(fpin, "%*[^\r\n]\r\n") != EOF) {
+		nrecords++;
+	}
+	if (nrecords == 0) {
+		fprintf(fplog,"Error: file %s has no glu scenario: read_glu_batch()\n", fname);
+		return ERROR_FILE;
+	}
+
+	num_glu_scen = nrecords;
+	glu_scen = calloc(num_glu_scen, sizeof(glu_scen_struct));
+	if(glu_scen == NULL) {
+		fprintf(fplog,"Failed to allocate memory for glu_scen: read_glu_batch()\n");
+		return ERROR_MEM;
+	}
+
+	rewind(fpin);
+
+	// skip the header line
+	if(fscanf(fpin, "%*[^\r\n]\r\n") == EOF)
+	{
+		fprintf(fplog,"Failed to scan over file %s header:  read_glu_batch()\n", fname);
+		return ERROR_FILE;
+	}
+
+	// read the scenario records
+	for (i = 0; i < num_glu_scen; i++) {
+		if (fscanf(fpin, "%[^\r\n]\r\n", rec_str) != EOF) {
+			if((err = get_text_field(rec_str, delim, 1, glu_scen[i].name)) != OK) {
+				fprintf(fplog, "Error processing file %s: read_glu_batch(); record=%i, column=1\n", fname, i + 1);
+				return err;
+			}
+			if((err = get_text_field(rec_str, delim, 2, glu_scen[i].aez_new_fname)) != OK) {
+				fprintf(fplog, "Error processing file %s: read_glu_batch(); record=%i, column=2\n", fname, i + 1);
+				return err;
+			}
+			if((err = get_text_field(rec_str, delim, 3, glu_scen[i].aez_new_info_fname)) != OK) {
+				fprintf(fplog, "Error processing file %s: read_glu_batch(); record=%i, column=3\n", fname, i + 1);
+				return err;
+			}
+		} else {
+			fprintf(fplog, "Error reading file %s: read_glu_batch(); record=%i\n", fname, i + 1);
+			return ERROR_FILE;
+		}
+
+		// the name is a subdirectory, so it has to be unique and a single path component
+		if (strlen(glu_scen[i].name) == 0 || strchr(glu_scen[i].name, '/') != NULL) {
+			fprintf(fplog, "Error: invalid glu scenario name %s in file %s: read_glu_batch(); record=%i\n",
+					glu_scen[i].name, fname, i + 1);
+			return ERROR_FILE;
+		}
+		for (j = 0; j < i; j++) {
+			if (strcmp(glu_scen[j].name, glu_scen[i].name) == 0) {
+				fprintf(fplog, "Error: duplicate glu scenario name %s in file %s: read_glu_batch(); record=%i\n",
+						glu_scen[i].name, fname, i + 1);
+				return ERROR_FILE;
+			}
+		}
+
+		// the output paths
+		strcpy(glu_scen[i].outpath, in_args.outpath);
+		strcat(glu_scen[i].outpath, glu_scen[i].name);
+		strcat(glu_scen[i].outpath, "/");
+		strcpy(glu_scen[i].ldsdestpath, in_args.ldsdestpath);
+		strcat(glu_scen[i].ldsdestpath, glu_scen[i].name);
+		strcat(glu_scen[i].ldsdestpath, "/");
+		strcpy(glu_scen[i].mapdestpath, in_args.mapdestpath);
+		strcat(glu_scen[i].mapdestpath, glu_scen[i].name);
+		strcat(glu_scen[i].mapdestpath, "/");
+	} // end for loop over records
+
+	fclose(fpin);
+
+	fprintf(fplog, "\nGLU batch %s: %i scenarios\n", in_args.glu_batch_fname, num_glu_scen);
+	for (i = 0; i < num_glu_scen; i++) {
+		fprintf(fplog, "%s: %s, %s\n", glu_scen[i].name, glu_scen[i].aez_new_fname, glu_scen[i].aez_new_info_fname);
+	}
+
+	return OK;}
@@ -142,6 +142,14 @@ int read_hyde32(args_struct in_args, rinfo_struct *raster_info, int year, float*
 		return ERROR_FILE;
 	}
 	
+	// the hyde grid has to match the working grid
+	if (nrows != raster_info->grid_nrows || ncols != raster_info->grid_ncols) {
+		fprintf(fplog,"Error: %s grid is %i x %i but the working grid is %i x %i; check grid_res_sec: read_hyde32()\n",
+				fname, nrows, ncols, raster_info->grid_nrows, raster_info->grid_ncols);
+		fclose(fpin);
+		return ERROR_FILE;
+	}
+	
 	ncells = nrows * ncols;
 	xmax = xmin + 360;
 	ymax = ymin + 180;
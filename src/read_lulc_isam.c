@@ -4,7 +4,7 @@
  read one ISAM LULC netcdf file
 	the files are gzipped orignially
 	this function will unzip them if necessary and then leave them unzipped (and keep the zipped file)
-    these are half-degree files (for now)
+    these are half-degree files by default; the resolution is set by lulc_res_sec in the input file
     origin is: lower left corner at -90 lat and 0 lon
 
  store the area in km^2 of each land type (1-34)
@@ -13,7 +13,7 @@
  	so the input data has to be shifted
  
  the file has 3 attribute variables and one additional dimension index:
-	longitude (360), latitude (720), lc_type (34, enumerated, no actual attribute variable), time (1)
+	longitude (NUM_LON_LULC), latitude (NUM_LAT_LULC), lc_type (34, enumerated, no actual attribute variable), time (1)
  the 34 lc_types are merely an index in the LC_fraction variable
  the data variables are:
     byte Dominant_type(latitude, longitude); only 17 land types, but different index than LC_fraction
@@ -24,6 +24,7 @@
     float latitude; center of pixel
     float longitude; center of pixel
     short time; year
+ the lc types of LC_fraction are read in one hyperslab through nc_access.c
  
  arguments:
  args_struct in_args:   the input file arguments
@@ -83,10 +84,10 @@ int read_lulc_isam(args_struct in_args, int year, float **lulc_input_grid) {
     int ncerr;						// error return value; 0 = ok
     const char lcfrac_name[] = "LC_fraction";         // the lc frac variable to read
     const char cell_area_name[] = "Grid_area";        // the grid cell area variable to read
-    size_t start_lcfrac[] = {0, 0, 0};              // start indices for lc fraction - the first value will change for each lc type
+    size_t start_lcfrac[] = {0, 0, 0};              // start indices for lc fraction; all the lc types are read at once
     static size_t start_grid[] = {0, 0};            // start indices for other data variables
-    static size_t count_lcfrac[] = {1, 360, 720};   // lengths for reading lc fraction
-    static size_t count_grid[] = {360, 720};        // lengths for reading other data variables
+    size_t count_lcfrac[] = {NUM_LULC_TYPES, 0, 0}; // lengths for reading lc fraction; the grid dims are set below
+    size_t count_grid[] = {0, 0};                   // lengths for reading other data variables; the grid dims are set below
 	
 	int grid_y;				// row for ul corner working grid cell in input cell
 	int grid_x;				// col for ul corner working grid cell in input cell
@@ -102,6 +103,11 @@ int read_lulc_isam(args_struct in_args, int year, float **lulc_input_grid) {
     const char nctag[] = ".nc";					// suffix for file names, netcdf, unzipped
     const char ncgztag[] = ".nc.gz";			// suffix for file names, netcdf, gzipped
 	
+	count_lcfrac[1] = nrows;
+	count_lcfrac[2] = ncols;
+	count_grid[0] = nrows;
+	count_grid[1] = ncols;
+	
 	// allcate array for the grid cell area
 	lulc_cell_area = calloc(ncells, sizeof(float));
 	if(lulc_cell_area == NULL) {
@@ -115,12 +121,14 @@ int read_lulc_isam(args_struct in_args, int year, float **lulc_input_grid) {
 		fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for temp_grid: main()\n", get_systime(), ERROR_MEM);
 		return ERROR_MEM;
 	}
-	for (i = 0; i < NUM_LULC_TYPES; i++) {
-		temp_grid[i] = calloc(NUM_CELLS_LULC, sizeof(float));
-		if(temp_grid[i] == NULL) {
-			fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for temp_grid[%i]: main()\n", get_systime(), ERROR_MEM, i);
-			return ERROR_MEM;
-		}
+	// the lc types are contiguous so that they are read in one hyperslab
+	temp_grid[0] = calloc((size_t) NUM_LULC_TYPES * NUM_CELLS_LULC, sizeof(float));
+	if(temp_grid[0] == NULL) {
+		fprintf(fplog,"\nProgram terminated at %s with error_code = %i\nFailed to allocate memory for temp_grid[0]: main()\n", get_systime(), ERROR_MEM);
+		return ERROR_MEM;
+	}
+	for (i = 1; i < NUM_LULC_TYPES; i++) {
+		temp_grid[i] = temp_grid[0] + (size_t) i * NUM_CELLS_LULC;
 	}
 	
     // finish file name and try to open it; if it fails, then it has not been unzipped
@@ -147,33 +155,36 @@ int read_lulc_isam(args_struct in_args, int year, float **lulc_input_grid) {
 	sprintf(tmp_str, "%i%s", year, nctag);
     strcat(lname, tmp_str);
     
-    if ((ncerr = nc_open(lname, NC_NOWRITE, &ncid))) {
+    if ((ncerr = nc_access_open(lname, &ncid))) {
         fprintf(fplog,"Failed to open %s for reading: read_lulc_isam(); ncerr = %i\n", lname, ncerr);
         return ERROR_FILE;
     }
     
     // get the grid cell area
-	if ((ncerr = nc_inq_varid(ncid, cell_area_name, &ncvarid))) {
+	if ((ncerr = nc_access_varid(ncid, cell_area_name, &ncvarid))) {
 		fprintf(fplog,"Error %i when getting netcdf var id for %s: read_lulc_isam()\n", ncerr, cell_area_name);
 		return ERROR_FILE;
 	}
-	if ((ncerr = nc_get_vara_float(ncid, ncvarid, start_grid, count_grid, lulc_cell_area))) {
+	if (check_nc_grid(ncid, ncvarid, nrows, ncols, lname) != OK) {
+		fprintf(fplog,"Grid mismatch for netcdf var %s: read_lulc_isam()\n", cell_area_name);
+		return ERROR_FILE;
+	}
+	ncerr = nc_access_read_float(ncid, ncvarid, start_grid, count_grid, lulc_cell_area, "read_lulc_isam");
+	if (ncerr) {
 		fprintf(fplog,"Error %i when reading netcdf var %s: read_lulc_isam()\n", ncerr, cell_area_name);
 		return ERROR_FILE;
 	}
 	
-    // loop over the land cover types to read them in
-	if ((ncerr = nc_inq_varid(ncid, lcfrac_name, &ncvarid))) {
+    // read the land cover types in one hyperslab
+	if ((ncerr = nc_access_varid(ncid, lcfrac_name, &ncvarid))) {
 		fprintf(fplog,"Error %i when getting netcdf var id for %s: read_lulc_isam()\n", ncerr, lcfrac_name);
 		return ERROR_FILE;
 	}
-	for (i = 0; i < NUM_LULC_TYPES; i++) {
-		start_lcfrac[0] = i;
-		if ((ncerr = nc_get_vara_float(ncid, ncvarid, start_lcfrac, count_lcfrac, &temp_grid[i][0]))) {
-			fprintf(fplog,"Error %i when reading netcdf var %s: read_lulc_isam()\n", ncerr, lcfrac_name);
-			return ERROR_FILE;
-		}
-	} // end for i loop over the lulc types
+	ncerr = nc_access_read_float(ncid, ncvarid, start_lcfrac, count_lcfrac, temp_grid[0], "read_lulc_isam");
+	if (ncerr) {
+		fprintf(fplog,"Error %i when reading netcdf var %s: read_lulc_isam()\n", ncerr, lcfrac_name);
+		return ERROR_FILE;
+	}
 	
     // loop over all the data to convert the values to working units and shift the data to start at upper left
     // do the land type aggregation and the grid disaggregation in a different function
@@ -199,13 +210,12 @@ int read_lulc_isam(args_struct in_args, int year, float **lulc_input_grid) {
 		} // end j loop over the land types
     }	// end for i loop over all grid cells
     
-    nc_close(ncid);
+    // each year file is read once
+    nc_access_close(ncid);
 	
 	free(lulc_cell_area);
 	
-	for (i = 0; i < NUM_LULC_TYPES; i++) {
-		free(temp_grid[i]);
-	}
+	free(temp_grid[0]);
 	free(temp_grid);
 	
     return OK;}
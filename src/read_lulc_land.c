@@ -4,14 +4,14 @@
  read one ISAM LULC netcdf file to get the land mask
 	the files are gzipped orignially
 	this function will unzip them if necessary and then leave them unzipped
- these are half-degree files (for now)
+ these are half-degree files by default; the resolution is set by lulc_res_sec in the input file
  origin is: lower left corner at -90 lat and 0 lon
  
  store the mask in the working grid
  so need to disaggregate and match the cells
  
  the file has 3 attribute variables and one additional dimension index:
-	longitude (360), latitude (720), lc_type (34, enumerated, no actual attribute variable), time (1)
+	longitude (NUM_LON_LULC), latitude (NUM_LAT_LULC), lc_type (34, enumerated, no actual attribute variable), time (1)
  the 34 lc_types are merely an index in the LC_fraction variable
  the data variables are:
  byte Dominant_type(latitude, longitude); only 17 land types, but different index than LC_fraction
@@ -61,11 +61,11 @@
 int read_lulc_land(args_struct in_args, int year, rinfo_struct *raster_info, int *land_mask_lulc) {
 	
 	int i, m, n;
-	int nrows = 360;				// num input lats
-	int ncols = 720;				// num input lons
+	int nrows = NUM_LAT_LULC;		// num input lats
+	int ncols = NUM_LON_LULC;		// num input lons
 	int ncells = nrows * ncols;		// number of input grid cells
 	float nodata = -99.0;           // nodata value - appears to be only in Dominant_type and Grid_area
-	double res = 30.0 / 60.0;		// input resolution
+	double res = raster_info->lulc_res;	// input resolution
 	double xmin = 0.0;			// input longitude min grid boundary
 	double xmax = 360.0;			// input longitude max grid boundary
 	double ymin = -90.0;			// input latitude min grid boundary
@@ -80,7 +80,7 @@ int read_lulc_land(args_struct in_args, int year, rinfo_struct *raster_info, int
 	int ncerr;						// error return value; 0 = ok
 	const char varname[] = "Mask";         // the land mask variable to read
 	static size_t start_grid[] = {0, 0};            // start indices for other data variables
-	static size_t count_grid[] = {360, 720};        // lengths for reading other data variables
+	size_t count_grid[] = {0, 0};                   // lengths for reading other data variables; the grid dims are set below
 	
 	int num_split;					// the number of cells to disaggregate to in 1 dimension
 	int grid_y_ul;				// row for ul corner working grid cell in input cell
@@ -109,6 +109,9 @@ int read_lulc_land(args_struct in_args, int year, rinfo_struct *raster_info, int
 	raster_info->lulc_input_ymin = ymin;
 	raster_info->lulc_input_ymax = ymax;
 	
+	count_grid[0] = nrows;
+	count_grid[1] = ncols;
+	
 	// allcate array for the grid cell area
 	lulc_input_mask = calloc(ncells, sizeof(int));
 	if(lulc_input_mask == NULL) {
@@ -150,6 +153,10 @@ int read_lulc_land(args_struct in_args, int year, rinfo_struct *raster_info, int
 		fprintf(fplog,"Error %i when getting netcdf var id for %s: read_lulc_land()\n", ncerr, varname);
 		return ERROR_FILE;
 	}
+	if (check_nc_grid(ncid, ncvarid, nrows, ncols, lname) != OK) {
+		fprintf(fplog,"Grid mismatch for netcdf var %s: read_lulc_land()\n", varname);
+		return ERROR_FILE;
+	}
 	if ((ncerr = nc_get_vara_int(ncid, ncvarid, start_grid, count_grid, lulc_input_mask))) {
 		fprintf(fplog,"Error %i when reading netcdf var %s: read_lulc_land()\n", ncerr, varname);
 		return ERROR_FILE;
@@ -157,7 +164,7 @@ int read_lulc_land(args_struct in_args, int year, rinfo_struct *raster_info, int
 	nc_close(ncid);
 	
 	// loop over all the data to convert the values to working grid
-	num_split = NUM_LON / ncols;
+	num_split = raster_info->num_split;
 	for (i = 0; i < ncells; i++) {
 		rem_dbl = fmod((double) i, (double) ncols);
 		modf((double) (i / ncols), &int_dbl);
@@ -1,7 +1,7 @@
 /**********
  read_mirca.c
  
- read one file of the mirca 2000 irragated/rainfed area into irr_grid[NUM_CELLS] and rfd_grid[NUM_CELLS]
+ read one latitude band of one file of the mirca 2000 irragated/rainfed area into irr_grid or rfd_grid
     the stored data are in the working grid, but without unit conversion
  
  there are separate files for irrigated and rainfed data
@@ -17,9 +17,20 @@
  
  also store hectares - no unit conversion
  
+ the file is read one latitude band at a time, in order (see proc_mirca())
+  the header is read and checked with the first band, and fpos carries the file position of the next band
+  the rows between the previous band and this one are skipped over, because a text file has to be scanned
+  only the columns of the band window are stored (see get_lat_band.c)
+ 
  arguments:
   char* fname:          file name to open, with path
-  float* mirca_grid:    the array to load the data into
+  int first_row:        first working grid row of the band to read
+  int num_rows:         number of rows in the band to read
+  int first_col:        first working grid column of the band window to store
+  int num_cols:         number of columns in the band window to store; NUM_LON if there is no region subset
+  long* fpos:           file position of the start of row fpos_row; set to the end of the band on return
+  int* fpos_row:        working grid row at fpos; 0 = the start of the file; set to the row after the band on return
+  float* mirca_grid:    the array to load the band window into, row by row
  
  return value:
  integer error code: OK = 0, otherwise a non-zero error code
@@ -51,7 +62,7 @@
 
 #include "moirai.h"
 
-int read_mirca(char *fname, float *mirca_grid) {
+int read_mirca(char *fname, int first_row, int num_rows, int first_col, int num_cols, long *fpos, int *fpos_row, float *mirca_grid) {
     
     // use this function to input data to the working grid
     
@@ -80,27 +91,53 @@ int read_mirca(char *fname, float *mirca_grid) {
         return ERROR_FILE;
     }
     
-    // read the header lines
-    if(fscanf(fpin,"%*s%i%*s%i%*s%lf%*s%lf%*s%lf%*s%i%*[^\r\n]\r\n", &ncols, &nrows, &xmin, &ymin, &res, &nodata) == EOF)
-    {
-        fprintf(fplog, "Failed to read file %s header:  read_mirca()\n", fname);
-        return ERROR_FILE;
+    if (first_row < *fpos_row) {
+        fprintf(fplog, "Error: row %i of file %s is before the previous band:  read_mirca()\n", first_row, fname);
+        fclose(fpin);
+        return ERROR_IND;
     }
     
-    // check the res
-    if (ncols != NUM_LON || nrows != NUM_LAT) {
-        printf("File %s dims do not match expected values:  read_mirca()\n", fname);
-        return ERROR_FILE;
-    }
+    // continue from the previous band
+    if (*fpos_row > 0) {
+        if (fseek(fpin, *fpos, SEEK_SET) != 0) {
+            fprintf(fplog, "Failed to seek to row %i of file %s:  read_mirca()\n", *fpos_row, fname);
+            fclose(fpin);
+            return ERROR_FILE;
+        }
+    } else {
+        // read the header lines
+        if(fscanf(fpin,"%*s%i%*s%i%*s%lf%*s%lf%*s%lf%*s%i%*[^\r\n]\r\n", &ncols, &nrows, &xmin, &ymin, &res, &nodata) == EOF)
+        {
+            fprintf(fplog, "Failed to read file %s header:  read_mirca()\n", fname);
+            return ERROR_FILE;
+        }
+    
+        // check the res
+        if (ncols != NUM_LON || nrows != NUM_LAT) {
+            printf("File %s dims do not match expected values:  read_mirca()\n", fname);
+            return ERROR_FILE;
+        }
+    }	// end if next band else first band with header
     
     //fprintf(fplog,"Start reading mirca at %s :  read_mirca()\n", get_systime());
     
-    // read the data
-    ncells = nrows * ncols;
+    // skip the rows before the band
+    for (i = 0; i < (first_row - *fpos_row) * NUM_LON; i++) {
+        if (fscanf(fpin, "%f", &value) == EOF) {
+            fprintf(fplog, "Failed to read mirca at %s:  read_mirca()\n", get_systime());
+            fclose(fpin);
+            return ERROR_FILE;
+        }
+    }
+    
+    // read the data, and store the band window
+    ncells = num_rows * NUM_LON;
     for (i = 0; i < ncells; i++) {
         if (fscanf(fpin, "%f", &value) != EOF) {
             // no need to convert units
-            mirca_grid[i] = value;
+            if (i % NUM_LON >= first_col && i % NUM_LON < first_col + num_cols) {
+                mirca_grid[(i / NUM_LON) * num_cols + i % NUM_LON - first_col] = value;
+            }
         } else {
             if (i == ncells) {
                 //fprintf(fplog,"Finished reading mirca at %s:  read_mirca()\n", get_systime());
@@ -113,6 +150,8 @@ int read_mirca(char *fname, float *mirca_grid) {
         
     }	// end for i loop to read the data
     
+    *fpos = ftell(fpin);
+    *fpos_row = first_row + num_rows;
     fclose(fpin);
     
     return OK;}
@@ -48,19 +48,18 @@ int read_potveg(args_struct in_args, rinfo_struct *raster_info) {
 	// input units are classes 1 - 15
 	// working units are classes 1 - 15
 	
-	int nrows = 2160;				// num input lats
-	int ncols = 4320;				// num input lons
+	int nrows = raster_info->grid_nrows;	// num input lats
+	int ncols = raster_info->grid_ncols;	// num input lons
 	int ncells = nrows * ncols;		// number of input grid cells
     int insize = 4;                 // 4 byte integers
 	int nodata = -9999;				// nodata value
-	double res = 5.0 / 60.0;		// resolution
+	double res = raster_info->grid_res;	// resolution
 	double xmin = -180.0;			// longitude min grid boundary
 	double xmax = 180.0;			// longitude max grid boundary
 	double ymin = -90.0;			// latitude min grid boundary
 	double ymax = 90.0;				// latitude max grid boundary
 	
 	char fname[MAXCHAR];			// file name to open
-	FILE *fpin;						// file pointer
 	int num_read;					// how many values read in
 	
 	int err = OK;									// store error code from the write file
@@ -81,15 +80,12 @@ int read_potveg(args_struct in_args, rinfo_struct *raster_info) {
 	strcpy(fname, in_args.inpath);
 	strcat(fname, in_args.potveg_fname);
 	
-    if((fpin = fopen(fname, "rb")) == NULL)
+    // read the data
+    if(read_raster_file(fname, potveg_thematic, insize, ncells, &num_read) != OK)
     {
         fprintf(fplog,"Failed to open file %s:  get_cell_area()\n", fname);
         return ERROR_FILE;
     }
-    
-    // read the data
-    num_read = (int) fread(potveg_thematic, insize, ncells, fpin);
-    fclose(fpin);
     if(num_read != ncells)
     {
         fprintf(fplog, "Error reading file %s: get_cell_area(); num_read=%i != ncells=%i\n",
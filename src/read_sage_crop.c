@@ -42,6 +42,10 @@
  	this treshold is  0.01 t / km^2, or 0.0001 t / ha is 2 orders of magnitude less than the min fao value of ~0.02 t / ha
  The abnormal values less than these thresholds are filtered out in this function. This has a negligible difference on the outputs.
 
+ the four levels of the band are read in one hyperslab through nc_access.c, which keeps the file open for the next band
+ the hyperslab is the band window: the band rows and, with a region subset, only the columns of the subset bounding box
+    so harvestarea_in and yield_in hold the window row by row (see get_lat_band.c)
+
  arguments:
  char *fname:	path and base filename for sage crop file to read
  rinfo_struct raster_info:	raster info structure
@@ -76,12 +80,17 @@
 
 #include "moirai.h"
 
-int read_sage_crop(char *fname, char *sagepath, char *cropfilebase_sage, rinfo_struct raster_info) {
+#define SAGE_READ_LEVELS	4		// harvest area, yield, harvest area quality, yield quality
+
+int read_sage_crop(char *fname, char *sagepath, char *cropfilebase_sage, rinfo_struct raster_info, int first_row, int num_rows) {
 
 	int i;
-	int nrows = 2160;				// num input lats
-	int ncols = 4320;				// num input lons
-	int ncells = nrows * ncols;		// number of input grid cells
+	int grid_ind;					// working grid index of band cell i
+	int nrows = raster_info.grid_nrows;	// num input lats
+	int ncols = raster_info.grid_ncols;	// num input lons
+	int first_col = raster_info.subset_col_min;		// first column of the band window
+	int num_cols = raster_info.subset_col_max - raster_info.subset_col_min + 1;	// number of columns in the band window
+	int ncells = num_rows * num_cols;	// number of input grid cells in the band window
 	float nodata = 9E20;			// nodata value
 	//double res = 5.0 / 60.0;		// resolution
 	//double xmin = -180.0;			// longitude min grid boundary
@@ -89,8 +98,9 @@ int read_sage_crop(char *fname, char *sagepath, char *cropfilebase_sage, rinfo_s
 	//double ymin = -90.0;			// latitude min grid boundary
 	//double ymax = 90.0;				// latitude max grid boundary
 	float temp_flt;
-	float *qual_yield;				// quality field for yield
-	float *qual_harv;				// quality field for area
+	float *levels_in;				// the four levels of the band, as read
+	float *qual_yield;				// quality field for yield, in levels_in
+	float *qual_harv;				// quality field for area, in levels_in
 
 	char lname[MAXCHAR];			// file name to open
 	FILE *fpin;						// file pointer
@@ -100,30 +110,30 @@ int read_sage_crop(char *fname, char *sagepath, char *cropfilebase_sage, rinfo_s
 	int ncerr;						// error return value; 0 = ok
 	// char *varname = "cropdata";		// name of the variable to read
 	char varname[MAXCHAR];  // name of the variable to read
-	static size_t start_yield[] = {0, 1, 0, 0};		// start indices for yield
-	static size_t start_harv[] = {0, 0, 0, 0};		// start indices for harvest area
-	static size_t start_qual_yield[] = {0, 3, 0, 0};		// start indices for yield
-	static size_t start_qual_harv[] = {0, 2, 0, 0};		// start indices for harvest area
-	static size_t count[] = {1, 1, 2160, 4320};		// lengths for reading yield
+	// the first four levels are read in one hyperslab: harvest area, yield, harvest area quality, yield quality
+	size_t start[] = {0, 0, 0, 0};					// start indices; the first row is set below
+	size_t count[] = {1, SAGE_READ_LEVELS, 0, 0};	// lengths; the grid dims are set below
 
 	// some input data file name suffixes
-	const char sage_crop_nctag[] = "_AreaYieldProduction.nc";					// suffix for sage base file names, netcdf, unzipped
+	const char sage_crop_nctag[] = SAGE_CROP_NCTAG;								// suffix for sage base file names, netcdf, unzipped
 	const char sage_crop_ncztag[] = "_HarvAreaYield2000_NetCDF.zip";				// suffix for sage base file names, netcdf, zipped
 
 	float harvest_thresh = 1e-8;
 	float yield_thresh = 0.0001;
 	
-	// allocate arrays for the quality fields
-	qual_harv = calloc(ncells, sizeof(float));
-	if(qual_harv == NULL) {
-		fprintf(fplog,"Failed to allocate memory for qual_harv:  read_sage_crop()\n");
-		return ERROR_MEM;
-	}
-	qual_yield = calloc(ncells, sizeof(float));
-	if(qual_yield == NULL) {
-		fprintf(fplog,"Failed to allocate memory for qual_yield:  read_sage_crop()\n");
+	start[2] = first_row;
+	start[3] = first_col;
+	count[2] = num_rows;
+	count[3] = num_cols;
+	
+	// allocate the array for the levels read; the quality fields stay in it
+	levels_in = calloc((size_t) SAGE_READ_LEVELS * ncells, sizeof(float));
+	if(levels_in == NULL) {
+		fprintf(fplog,"Failed to allocate memory for levels_in:  read_sage_crop()\n");
 		return ERROR_MEM;
 	}
+	qual_harv = levels_in + (size_t) 2 * ncells;
+	qual_yield = levels_in + (size_t) 3 * ncells;
 
 	// finish file name and try to open it; if it fails, then it has not been unzipped
 	strcpy(lname, fname);
@@ -145,53 +155,53 @@ int read_sage_crop(char *fname, char *sagepath, char *cropfilebase_sage, rinfo_s
 	strcpy(lname, fname);
 	strcat(lname, sage_crop_nctag);
 
-	if ((ncerr = nc_open(lname, NC_NOWRITE, &ncid))) {
+	// the file stays open for the next band (see nc_access.c)
+	if ((ncerr = nc_access_open(lname, &ncid))) {
 		fprintf(fplog,"Failed to open %s for reading: read_sage_crop(); ncerr = %i\n", lname, ncerr);
+		free(levels_in);
 		return ERROR_FILE;
 	}
 
   strcpy(varname,cropfilebase_sage);
   strcat(varname,"Data");
 
-	if ((ncerr = nc_inq_varid(ncid, varname, &ncvarid))) {
+	if ((ncerr = nc_access_varid(ncid, varname, &ncvarid))) {
 		fprintf(fplog,"Error %i when getting netcdf var id for %s: read_sage_crop()\n", ncerr, varname);
+		free(levels_in);
 		return ERROR_FILE;
 	}
-
-	if ((ncerr = nc_get_vara_float(ncid, ncvarid, start_yield, count, yield_in))) {
-		fprintf(fplog,"Error %i when reading netcdf var %s: read_sage_crop()\n", ncerr, varname);
-		return ERROR_FILE;
-	}
-
-	if ((ncerr = nc_get_vara_float(ncid, ncvarid, start_qual_yield, count, qual_yield))) {
-		fprintf(fplog,"Error %i when reading netcdf var %s: read_sage_crop()\n", ncerr, varname);
-		return ERROR_FILE;
-	}
-
-	if ((ncerr = nc_get_vara_float(ncid, ncvarid, start_harv, count, harvestarea_in))) {
-		fprintf(fplog,"Error %i when reading netcdf var %s: read_sage_crop()\n", ncerr, varname);
+	
+	if (check_nc_grid(ncid, ncvarid, nrows, ncols, lname) != OK) {
+		fprintf(fplog,"Grid mismatch for netcdf var %s: read_sage_crop()\n", varname);
+		free(levels_in);
 		return ERROR_FILE;
 	}
 
-	if ((ncerr = nc_get_vara_float(ncid, ncvarid, start_qual_harv, count, qual_harv))) {
+	ncerr = nc_access_read_float(ncid, ncvarid, start, count, levels_in, "read_sage_crop");
+	if (ncerr) {
 		fprintf(fplog,"Error %i when reading netcdf var %s: read_sage_crop()\n", ncerr, varname);
+		free(levels_in);
 		return ERROR_FILE;
 	}
+	memcpy(harvestarea_in, levels_in, (size_t) ncells * sizeof(float));
+	memcpy(yield_in, levels_in + ncells, (size_t) ncells * sizeof(float));
 
 	// loop over all the data to convert the values to working units
 	//  and to make sure that valid crop values exist for sage land cells
 	for (i = 0; i < ncells; i++) {
+		grid_ind = (first_row + i / num_cols) * ncols + first_col + i % num_cols;
+		
 		// do harvested area first to calibrate the sage individual crop data to the sage physical crop area
 		// this applies the sage cropping fraction to the hyde physical cropland area
 		// convert land area fraction to km^2
 		if (harvestarea_in[i] == nodata) {
-			if (land_area_sage[i] == raster_info.land_area_sage_nodata) {
+			if (land_area_sage[grid_ind] == raster_info.land_area_sage_nodata) {
 				harvestarea_in[i] = NODATA;
 			} else {
 				harvestarea_in[i] = 0;
 			}
 		} else {
-			if (land_area_sage[i] == raster_info.land_area_sage_nodata) {
+			if (land_area_sage[grid_ind] == raster_info.land_area_sage_nodata) {
 				harvestarea_in[i] = 0;
 			} else {
 				// this threshold (1e-8) is the fraction corresponding to 1 m^2 if a cell has 100 km^2 of land area
@@ -202,14 +212,14 @@ int read_sage_crop(char *fname, char *sagepath, char *cropfilebase_sage, rinfo_s
 					harvestarea_in[i] = 0;
 					// end if bad data then remove
 				} else if (qual_harv[i] != 0) {
-					if (cropland_area_sage[i] == raster_info.cropland_sage_nodata || cropland_area_sage[i] == 0) {
+					if (cropland_area_sage[grid_ind] == raster_info.cropland_sage_nodata || cropland_area_sage[grid_ind] == 0) {
 						harvestarea_in[i] = 0;
 					} else {
 						// get the original harvestarea_in in km^2
-						temp_flt = harvestarea_in[i]  * land_area_sage[i];
+						temp_flt = harvestarea_in[i]  * land_area_sage[grid_ind];
 						// now store adjusted harvestarea in km^2
 						// sage in harvested area fraction * sage land area / sage physical crop area * hyde physical crop area
-						harvestarea_in[i] = harvestarea_in[i]  * land_area_sage[i] / cropland_area_sage[i] * cropland_area[i];
+						harvestarea_in[i] = harvestarea_in[i]  * land_area_sage[grid_ind] / cropland_area_sage[grid_ind] * cropland_area[grid_ind];
 					}
 					if (qual_harv[i] == nodata && harvestarea_in[i] != 0) {
 						// this condition does not occur
@@ -227,13 +237,13 @@ int read_sage_crop(char *fname, char *sagepath, char *cropfilebase_sage, rinfo_s
 		
 		// normalize this yield to the sage input production and the normalized harvested area
 		if (yield_in[i] == nodata) {
-			if (land_area_sage[i] == raster_info.land_area_sage_nodata) {
+			if (land_area_sage[grid_ind] == raster_info.land_area_sage_nodata) {
 				yield_in[i] = NODATA;
 			} else {
 				yield_in[i] = 0;
 			}
 		} else {
-			if (land_area_sage[i] == raster_info.land_area_sage_nodata || harvestarea_in[i] == nodata || harvestarea_in[i] == 0 || harvestarea_in[i] == NODATA) {
+			if (land_area_sage[grid_ind] == raster_info.land_area_sage_nodata || harvestarea_in[i] == nodata || harvestarea_in[i] == 0 || harvestarea_in[i] == NODATA) {
 				yield_in[i] = 0;
 			} else {
 				// this treshold is  0.01 t / km^2, or 0.0001 t / ha, (min fao value is ~0.02 t / ha)
@@ -263,9 +273,6 @@ int read_sage_crop(char *fname, char *sagepath, char *cropfilebase_sage, rinfo_s
 		
 	}	// end for i loop over all grid cells
 
-	nc_close(ncid);
-
-	free(qual_harv);
-	free(qual_yield);
+	free(levels_in);
 
 	return OK;}
@@ -45,11 +45,11 @@
 int read_veg_carbon(args_struct in_args, rinfo_struct *raster_info) {
     
     //Grid dimensions
-    int nrows = 2160;				// num input lats
-    int ncols = 4320;				// num input lons
+    int nrows = raster_info->grid_nrows;	// num input lats
+    int ncols = raster_info->grid_ncols;	// num input lons
     int ncells = nrows * ncols;		// number of input grid cells
     int insize = 4;					// 4 byte floats
-    double res = 5.0 / 60.0;		// resolution
+    double res = raster_info->grid_res;	// resolution
     double xmin = -180.0;			// longitude min grid boundary
     double xmax = 180.0;			// longitude max grid boundary
     double ymin = -90.0;			// latitude min grid boundary
@@ -58,20 +58,31 @@ int read_veg_carbon(args_struct in_args, rinfo_struct *raster_info) {
     int i;
     char fname[MAXCHAR];			// file name to open
     
-    FILE *fpin;
     int num_read;					// how many values read in
-    float *wavg_array;  //Temporary arrays for above ground biomass
-    float *median_array; //Temporary arrays for above ground biomass
-    float *min_array; //Temporary arrays for above ground biomass
-    float *max_array; //Temporary arrays for above ground biomass
-    float *q1_array;  //Temporary arrays for above ground biomass
-    float *q3_array;  //Temporary arrays for above ground biomass
-    float *wavg_bg_array;  //Temporary arrays for below ground biomass
-    float *median_bg_array; //Temporary arrays for below ground biomass
-    float *min_bg_array; //Temporary arrays for below ground biomass
-    float *max_bg_array; //Temporary arrays for below ground biomass
-    float *q1_bg_array;  //Temporary arrays for below ground biomass
-    float *q3_bg_array;  //Temporary arrays for below ground biomass
+    const float *wavg_array;  //Mapped values of above ground biomass
+    raster_view_struct wavg_view; // the mapped file
+    const float *median_array; //Mapped values of above ground biomass
+    raster_view_struct median_view; // the mapped file
+    const float *min_array; //Mapped values of above ground biomass
+    raster_view_struct min_view; // the mapped file
+    const float *max_array; //Mapped values of above ground biomass
+    raster_view_struct max_view; // the mapped file
+    const float *q1_array;  //Mapped values of above ground biomass
+    raster_view_struct q1_view; // the mapped file
+    const float *q3_array;  //Mapped values of above ground biomass
+    raster_view_struct q3_view; // the mapped file
+    const float *wavg_bg_array;  //Mapped values of below ground biomass
+    raster_view_struct wavg_bg_view; // the mapped file
+    const float *median_bg_array; //Mapped values of below ground biomass
+    raster_view_struct median_bg_view; // the mapped file
+    const float *min_bg_array; //Mapped values of below ground biomass
+    raster_view_struct min_bg_view; // the mapped file
+    const float *max_bg_array; //Mapped values of below ground biomass
+    raster_view_struct max_bg_view; // the mapped file
+    const float *q1_bg_array;  //Mapped values of below ground biomass
+    raster_view_struct q1_bg_view; // the mapped file
+    const float *q3_bg_array;  //Mapped values of below ground biomass
+    raster_view_struct q3_bg_view; // the mapped file
 	
     int err = OK;								// store error code from the dignostic write file
     char out_name1[] = "veg_carbon_wavg.bil";		// file name for output diagnostics raster file
@@ -93,327 +104,241 @@ int read_veg_carbon(args_struct in_args, rinfo_struct *raster_info) {
     raster_info->protected_ymax = ymax;
    
 
-   //1. Allocate weighted average array
-    wavg_array = calloc(ncells, sizeof(float));
-    if(wavg_array == NULL) {
-        fprintf(fplog,"Failed to allocate memory for wavg_array: read_protected()\n");
-        return ERROR_MEM;
-    }
-
-    wavg_bg_array =calloc(ncells, sizeof(float));
-    if(wavg_bg_array == NULL) {
-        fprintf(fplog,"Failed to allocate memory for wavg_bg_array: read_protected()\n");
-        return ERROR_MEM;
-    }
-
+   //1. Weighted average
     // create file name and open it
     //1a. Above ground biomass (weighted average) 
     strcpy(fname, in_args.inpath);
     strcat(fname, in_args.veg_carbon_wavg_fname);
     
-    if((fpin = fopen(fname, "rb")) == NULL)
+    // read the data and check for same size as the working grid
+    if(open_raster_view(fname, insize, ncells, &wavg_view, &num_read) != OK)
     {
         fprintf(fplog,"Failed to open file %s:  read_soil_c()\n", fname);
         return ERROR_FILE;
     }
-
-    // read the data and check for same size as the working grid
-    num_read = (int) fread(wavg_array, insize, ncells, fpin);
-    fclose(fpin);
     if(num_read != NUM_CELLS)
     {
         fprintf(fplog, "Error reading file %s: read_soil_c(); num_read=%i != NUM_CELLS=%i\n",
                 fname, num_read, NUM_CELLS);
         return ERROR_FILE;
     }
+    wavg_array = raster_view_float(&wavg_view);
    
    //1b. Below ground biomass (weighted average) 
     strcpy(fname, in_args.inpath);
     strcat(fname, in_args.veg_BG_wavg_fname);
     
-    if((fpin = fopen(fname, "rb")) == NULL)
+    // read the data and check for same size as the working grid
+    if(open_raster_view(fname, insize, ncells, &wavg_bg_view, &num_read) != OK)
     {
         fprintf(fplog,"Failed to open file %s:  read_soil_c()\n", fname);
         return ERROR_FILE;
     }
-
-    // read the data and check for same size as the working grid
-    num_read = (int) fread(wavg_bg_array, insize, ncells, fpin);
-    fclose(fpin);
     if(num_read != NUM_CELLS)
     {
         fprintf(fplog, "Error reading file %s: read_soil_c(); num_read=%i != NUM_CELLS=%i\n",
                 fname, num_read, NUM_CELLS);
         return ERROR_FILE;
     }
+    wavg_bg_array = raster_view_float(&wavg_bg_view);
 
 
    //2a. Median array
-    median_array = calloc(ncells, sizeof(float));
-    if(median_array == NULL) {
-        fprintf(fplog,"Failed to allocate memory for L1_array: read_protected()\n");
-        return ERROR_MEM;
-    }
 
     // create file name and open it
     strcpy(fname, in_args.inpath);
     strcat(fname, in_args.veg_carbon_median_fname);
-    if((fpin = fopen(fname, "rb")) == NULL)
+    // read the data and check for same size as the working grid
+    if(open_raster_view(fname, insize, ncells, &median_view, &num_read) != OK)
     {
         fprintf(fplog,"Failed to open file %s:  read_soil_c()\n", fname);
         return ERROR_FILE;
     }
-
-    // read the data and check for same size as the working grid
-    num_read = (int) fread(median_array, insize, ncells, fpin);
-    fclose(fpin);
     if(num_read != NUM_CELLS)
     {
         fprintf(fplog, "Error reading file %s: read_veg_c(); num_read=%i != NUM_CELLS=%i\n",
                 fname, num_read, NUM_CELLS);
         return ERROR_FILE;
     }
+    median_array = raster_view_float(&median_view);
     
     //2b. Median array (below ground biomass)
-    median_bg_array = calloc(ncells, sizeof(float));
-    if(median_bg_array == NULL) {
-        fprintf(fplog,"Failed to allocate memory for L1_array: read_protected()\n");
-        return ERROR_MEM;
-    }
 
     // create file name and open it
     strcpy(fname, in_args.inpath);
     strcat(fname, in_args.veg_BG_median_fname);
-    if((fpin = fopen(fname, "rb")) == NULL)
+    // read the data and check for same size as the working grid
+    if(open_raster_view(fname, insize, ncells, &median_bg_view, &num_read) != OK)
     {
         fprintf(fplog,"Failed to open file %s:  read_veg_c()\n", fname);
         return ERROR_FILE;
     }
-
-    // read the data and check for same size as the working grid
-    num_read = (int) fread(median_bg_array, insize, ncells, fpin);
-    fclose(fpin);
     if(num_read != NUM_CELLS)
     {
         fprintf(fplog, "Error reading file %s: read_veg_c(); num_read=%i != NUM_CELLS=%i\n",
                 fname, num_read, NUM_CELLS);
         return ERROR_FILE;
     }
+    median_bg_array = raster_view_float(&median_bg_view);
 
    
 
     //3a min array (above ground biomass)
-    min_array = calloc(ncells, sizeof(float));
-    if(min_array == NULL) {
-        fprintf(fplog,"Failed to allocate memory for L1_array: read_protected()\n");
-        return ERROR_MEM;
-    }
 
     // create file name and open it
     strcpy(fname, in_args.inpath);
     strcat(fname, in_args.veg_carbon_min_fname);
-    if((fpin = fopen(fname, "rb")) == NULL)
+    // read the data and check for same size as the working grid
+    if(open_raster_view(fname, insize, ncells, &min_view, &num_read) != OK)
     {
         fprintf(fplog,"Failed to open file %s:  read_veg_c()\n", fname);
         return ERROR_FILE;
     }
-
-    // read the data and check for same size as the working grid
-    num_read = (int) fread(min_array, insize, ncells, fpin);
-    fclose(fpin);
     if(num_read != NUM_CELLS)
     {
         fprintf(fplog, "Error reading file %s: read_veg_c(); num_read=%i != NUM_CELLS=%i\n",
                 fname, num_read, NUM_CELLS);
         return ERROR_FILE;
     }
+    min_array = raster_view_float(&min_view);
     
     //3b min array (below ground biomass)
-    min_bg_array = calloc(ncells, sizeof(float));
-    if(min_bg_array == NULL) {
-        fprintf(fplog,"Failed to allocate memory for L1_array: read_protected()\n");
-        return ERROR_MEM;
-    }
 
     // create file name and open it
     strcpy(fname, in_args.inpath);
     strcat(fname, in_args.veg_BG_min_fname);
-    if((fpin = fopen(fname, "rb")) == NULL)
+    // read the data and check for same size as the working grid
+    if(open_raster_view(fname, insize, ncells, &min_bg_view, &num_read) != OK)
     {
         fprintf(fplog,"Failed to open file %s:  read_veg_c()\n", fname);
         return ERROR_FILE;
     }
-
-    // read the data and check for same size as the working grid
-    num_read = (int) fread(min_bg_array, insize, ncells, fpin);
-    fclose(fpin);
     if(num_read != NUM_CELLS)
     {
         fprintf(fplog, "Error reading file %s: read_veg_c(); num_read=%i != NUM_CELLS=%i\n",
                 fname, num_read, NUM_CELLS);
         return ERROR_FILE;
     }
+    min_bg_array = raster_view_float(&min_bg_view);
      
 
     //4a. max array
-    max_array = calloc(ncells, sizeof(float));
-    if(max_array == NULL) {
-        fprintf(fplog,"Failed to allocate memory for L1_array: read_protected()\n");
-        return ERROR_MEM;
-    }
 
     // create file name and open it
     strcpy(fname, in_args.inpath);
     strcat(fname, in_args.veg_carbon_max_fname);
-    if((fpin = fopen(fname, "rb")) == NULL)
+    // read the data and check for same size as the working grid
+    if(open_raster_view(fname, insize, ncells, &max_view, &num_read) != OK)
     {
         fprintf(fplog,"Failed to open file %s:  read_veg_c()\n", fname);
         return ERROR_FILE;
     }
-
-    // read the data and check for same size as the working grid
-    num_read = (int) fread(max_array, insize, ncells, fpin);
-    fclose(fpin);
     if(num_read != NUM_CELLS)
     {
         fprintf(fplog, "Error reading file %s: read_veg_c(); num_read=%i != NUM_CELLS=%i\n",
                 fname, num_read, NUM_CELLS);
         return ERROR_FILE;
     }
+    max_array = raster_view_float(&max_view);
     
     //4b. max array (below ground biomass)
-    max_bg_array = calloc(ncells, sizeof(float));
-    if(max_bg_array == NULL) {
-        fprintf(fplog,"Failed to allocate memory for L1_array: read_protected()\n");
-        return ERROR_MEM;
-    }
 
     // create file name and open it
     strcpy(fname, in_args.inpath);
     strcat(fname, in_args.veg_BG_max_fname);
-    if((fpin = fopen(fname, "rb")) == NULL)
+    // read the data and check for same size as the working grid
+    if(open_raster_view(fname, insize, ncells, &max_bg_view, &num_read) != OK)
     {
         fprintf(fplog,"Failed to open file %s:  read_veg_c()\n", fname);
         return ERROR_FILE;
     }
-
-    // read the data and check for same size as the working grid
-    num_read = (int) fread(max_bg_array, insize, ncells, fpin);
-    fclose(fpin);
     if(num_read != NUM_CELLS)
     {
         fprintf(fplog, "Error reading file %s: read_veg_c(); num_read=%i != NUM_CELLS=%i\n",
                 fname, num_read, NUM_CELLS);
         return ERROR_FILE;
     }
+    max_bg_array = raster_view_float(&max_bg_view);
     
 
 
     //5a q1 array
-    q1_array = calloc(ncells, sizeof(float));
-    if(q1_array == NULL) {
-        fprintf(fplog,"Failed to allocate memory for L1_array: read_protected()\n");
-        return ERROR_MEM;
-    }
 
     // create file name and open it
     strcpy(fname, in_args.inpath);
     strcat(fname, in_args.veg_carbon_q1_fname);
-    if((fpin = fopen(fname, "rb")) == NULL)
+    // read the data and check for same size as the working grid
+    if(open_raster_view(fname, insize, ncells, &q1_view, &num_read) != OK)
     {
         fprintf(fplog,"Failed to open file %s:  read_veg_c()\n", fname);
         return ERROR_FILE;
     }
-
-    // read the data and check for same size as the working grid
-    num_read = (int) fread(q1_array, insize, ncells, fpin);
-    fclose(fpin);
     if(num_read != NUM_CELLS)
     {
         fprintf(fplog, "Error reading file %s: read_veg_c(); num_read=%i != NUM_CELLS=%i\n",
                 fname, num_read, NUM_CELLS);
         return ERROR_FILE;
     }
+    q1_array = raster_view_float(&q1_view);
     
     //5b q1 array (below ground biomass)
-    q1_bg_array = calloc(ncells, sizeof(float));
-    if(q1_bg_array == NULL) {
-        fprintf(fplog,"Failed to allocate memory for L1_array: read_protected()\n");
-        return ERROR_MEM;
-    }
 
     // create file name and open it
     strcpy(fname, in_args.inpath);
     strcat(fname, in_args.veg_BG_q1_fname);
-    if((fpin = fopen(fname, "rb")) == NULL)
+    // read the data and check for same size as the working grid
+    if(open_raster_view(fname, insize, ncells, &q1_bg_view, &num_read) != OK)
     {
         fprintf(fplog,"Failed to open file %s:  read_veg_c()\n", fname);
         return ERROR_FILE;
     }
-
-    // read the data and check for same size as the working grid
-    num_read = (int) fread(q1_bg_array, insize, ncells, fpin);
-    fclose(fpin);
     if(num_read != NUM_CELLS)
     {
         fprintf(fplog, "Error reading file %s: read_veg_c(); num_read=%i != NUM_CELLS=%i\n",
                 fname, num_read, NUM_CELLS);
         return ERROR_FILE;
     }
+    q1_bg_array = raster_view_float(&q1_bg_view);
 
 
 
     //6a. q3 array
-    q3_array = calloc(ncells, sizeof(float));
-    if(q3_array == NULL) {
-        fprintf(fplog,"Failed to allocate memory for L1_array: read_protected()\n");
-        return ERROR_MEM;
-    }
 
     // create file name and open it
     strcpy(fname, in_args.inpath);
     strcat(fname, in_args.veg_carbon_q3_fname);
-    if((fpin = fopen(fname, "rb")) == NULL)
+    // read the data and check for same size as the working grid
+    if(open_raster_view(fname, insize, ncells, &q3_view, &num_read) != OK)
     {
         fprintf(fplog,"Failed to open file %s:  read_veg_c()\n", fname);
         return ERROR_FILE;
     }
-
-    // read the data and check for same size as the working grid
-    num_read = (int) fread(q3_array, insize, ncells, fpin);
-    fclose(fpin);
     if(num_read != NUM_CELLS)
     {
         fprintf(fplog, "Error reading file %s: read_veg_c(); num_read=%i != NUM_CELLS=%i\n",
                 fname, num_read, NUM_CELLS);
         return ERROR_FILE;
     }
+    q3_array = raster_view_float(&q3_view);
     
     //6b. q3 array (below ground biomass)
-    q3_bg_array = calloc(ncells, sizeof(float));
-    if(q3_bg_array == NULL) {
-        fprintf(fplog,"Failed to allocate memory for L1_array: read_protected()\n");
-        return ERROR_MEM;
-    }
 
     // create file name and open it
     strcpy(fname, in_args.inpath);
     strcat(fname, in_args.veg_BG_q3_fname);
-    if((fpin = fopen(fname, "rb")) == NULL)
+    // read the data and check for same size as the working grid
+    if(open_raster_view(fname, insize, ncells, &q3_bg_view, &num_read) != OK)
     {
         fprintf(fplog,"Failed to open file %s:  read_veg_c()\n", fname);
         return ERROR_FILE;
     }
-
-    // read the data and check for same size as the working grid
-    num_read = (int) fread(q3_bg_array, insize, ncells, fpin);
-    fclose(fpin);
     if(num_read != NUM_CELLS)
     {
         fprintf(fplog, "Error reading file %s: read_veg_c(); num_read=%i != NUM_CELLS=%i\n",
                 fname, num_read, NUM_CELLS);
         return ERROR_FILE;
     }
+    q3_bg_array = raster_view_float(&q3_bg_view);
 
       //kbn calc category data from input arrays
     for (i = 0; i < ncells; i++) {
@@ -536,18 +461,18 @@ int read_veg_carbon(args_struct in_args, rinfo_struct *raster_info) {
         }
     
     //Free arrays
-    free(wavg_array);
-    free(median_array);
-    free(min_array);
-    free(max_array);
-    free(q1_array);
-    free(q3_array);
-    free(wavg_bg_array);
-    free(median_bg_array);
-    free(min_bg_array);
-    free(max_bg_array);
-    free(q1_bg_array);
-    free(q3_bg_array);
+    close_raster_view(&wavg_view);
+    close_raster_view(&median_view);
+    close_raster_view(&min_view);
+    close_raster_view(&max_view);
+    close_raster_view(&q1_view);
+    close_raster_view(&q3_view);
+    close_raster_view(&wavg_bg_view);
+    close_raster_view(&median_bg_view);
+    close_raster_view(&min_bg_view);
+    close_raster_view(&max_bg_view);
+    close_raster_view(&q1_bg_view);
+    close_raster_view(&q3_bg_view);
     
     
     return OK;}
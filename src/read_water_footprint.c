@@ -5,7 +5,7 @@
   these are single band esri grid files
 
  water footprint files (converted to simple binary files from arc grid files by an r script):
- 4320 columns, 2160 rows, 5 arcmin res
+ NUM_LON columns, NUM_LAT rows, 5 arcmin res by default (the working grid)
  geographic projection of wgs84
  the original data have been resampled to the full grid with upper left corner at -180, +90
  float data type
@@ -21,7 +21,11 @@
 
   ARGUMENTS
       char* fname:       file name to open, with path
-      float* wf_grid:    the array to load the data into; this is the full globe, and has been initialized to the file nodata value
+      int first_row:     first working grid row of the latitude band to read
+      int num_rows:      number of rows in the latitude band to read
+      int first_col:     first working grid column of the band window to read
+      int num_cols:      number of columns in the band window to read; NUM_LON if there is no region subset
+      float* wf_grid:    the array to load the band into, row by row (see get_lat_band.c)
 
   so read the data into the appropriate location in the grid array
   row index: (90-83)*60/5 - 1
@@ -58,15 +62,15 @@
  
 #include "moirai.h"
 
-int read_water_footprint(char *fname, float *wf_grid) {
+int read_water_footprint(char *fname, int first_row, int num_rows, int first_col, int num_cols, float *wf_grid) {
     
-    int ncols = 4320;
-    int nrows = 2160;
-    int ncells = nrows * ncols;		// number of input grid cells
+    int i;
+    int ncols = NUM_LON;
+    int ncells = num_rows * num_cols;	// number of input grid cells in the band window
     int insize = 4;					// 4 byte floats
     
     FILE *fpin;						// file pointer
-    int num_read;					// how many values read in
+    int num_read = 0;				// how many values read in
     
     if((fpin = fopen(fname, "rb")) == NULL)
     {
@@ -74,8 +78,19 @@ int read_water_footprint(char *fname, float *wf_grid) {
         return ERROR_FILE;
     }
     
-    // read the data
-    num_read = (int) fread(wf_grid, insize, ncells, fpin);
+    // read the band; a window of full rows is read at once, otherwise each row of the window is read
+    for (i = 0; i < num_rows; i++) {
+        if (fseek(fpin, ((long) (first_row + i) * ncols + first_col) * insize, SEEK_SET) != 0) {
+            fprintf(fplog, "Failed to seek to row %i of file %s:  read_water_footprint()\n", first_row + i, fname);
+            fclose(fpin);
+            return ERROR_FILE;
+        }
+        if (num_cols == ncols) {
+            num_read = (int) fread(wf_grid, insize, ncells, fpin);
+            break;
+        }
+        num_read = num_read + (int) fread(&wf_grid[i * num_cols], insize, num_cols, fpin);
+    }
     fclose(fpin);
     if(num_read != ncells)
     {
@@ -0,0 +1,491 @@
+/**********
+ serve_stages.c
+
+ the stages that serve mode keeps or skips between requests (see moirai_serve.c)
+    the glu independent rasters and reference year areas (SERVE_SHARED_RASTERS) stay in memory after a successful request,
+        instead of being freed at the end of the run, and the next request uses them if their inputs are the same
+    an output stage (SERVE_MIRCA ... SERVE_CROP_RENT) is not processed if its inputs are the same as in the previous
+        successful request and its output files are still in the output paths, so those files are kept
+    every other stage is processed for each request: the csv info tables, the glu rasters, the region subset, the land cells,
+        the glu mapping, the carbon keys, and the copies to the destination paths
+ outside of serve mode every stage is processed and the shared rasters are freed at the end of each run
+
+ each stage has a key of the input arguments that it depends on, made with the checkpoint key functions (see checkpoint.c):
+    set_stage_key() below lists the arguments that feed each stage, so an argument change processes only the stages that it feeds
+    the key of every output stage includes the shared raster key, the glu scenarios, region_subset, outpath,
+        diagnostics, and table_format
+    the key of a stage includes the name, size, and modification time of the files in its input directories,
+        so a changed input file processes the stage again
+    the keys of a request are compared with the keys of the previous successful request, made at the end of that request,
+        after read_hyde32() has unzipped the hyde files
+ a failed request frees the shared rasters and forgets the keys, so the next request processes every stage
+
+ the output stages other than the land type area also have checkpoints (see checkpoint.c), in every run if checkpoint_path is set
+    the land type area has its own checkpoint, with the inputs of that stage only (see set_land_type_area_checkpoint.c)
+    the checkpoint key is the stage key without the output paths, and it holds the tables of every glu scenario
+    a stage that is processed is restored from its checkpoint before the first glu scenario, if there is one with the key,
+        and is not processed for any scenario; otherwise it is saved after the last glu scenario
+    the diagnostic files are not in the checkpoints, so there are no output stage checkpoints if diagnostics is on
+
+ functions:
+ start_serve_stages():	start serve mode
+ stop_serve_stages():	free the resident rasters and stop serve mode
+ set_serve_stages():	find the stages to process for a request; restores raster_info if the resident rasters are used
+ run_serve_stage():		1 if the stage is processed in this request, 0 if it is kept or restored
+ save_stage_checkpoint():	save the checkpoint of an output stage after the last glu scenario
+ end_serve_stages():	at the end of a run: keep the shared rasters and the keys for the next request, or free the rasters
+ get_serve_stage():		the name and status (SERVE_RUN, SERVE_KEPT, or SERVE_RESTORED) of a stage in the last request
+
+ arguments:
+ args_struct in_args:		the input file arguments of the request
+ rinfo_struct *raster_info:	the raster info of the request
+ int error_code:			the error code of the run
+ int stage:					the stage index, SERVE_*
+ int scen_ind:				the glu scenario index
+ int *status:				set to the status of the stage
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "moirai.h"
+#include <unistd.h>
+
+#define MAX_STAGE_TABLES	3		// the most output tables of an output stage
+
+static const char *stage_names[NUM_SERVE_STAGES] = {"shared_rasters", "proc_mirca", "proc_land_type_area",
+	"proc_refveg_carbon", "proc_water_footprint", "proc_crop_rent"};
+static int serve_on = 0;								// 1 = serve mode
+static int shared_resident = 0;							// 1 = the shared rasters of the previous request are in memory
+static rinfo_struct shared_info;						// the raster info of the resident shared rasters
+static int prev_ok = 0;									// 1 = prev_keys are the keys of the previous successful request
+static unsigned long long prev_keys[NUM_SERVE_STAGES];	// the stage keys of the previous successful request
+static int stage_status[NUM_SERVE_STAGES];				// SERVE_RUN, SERVE_KEPT, or SERVE_RESTORED for the current request
+
+// make the key of a stage from the input arguments that feed it; the output stages need the shared raster key
+//	ckpt = 1 declares a checkpoint store with the key, which does not have the output paths
+static int set_stage_key(args_struct in_args, int stage, int ckpt, unsigned long long shared_key, unsigned long long *key) {
+
+	int err = OK;
+	int i, scen_ind;
+	char key_str[50];
+
+	if (ckpt) {
+		if ((err = init_checkpoint(in_args, stage_names[stage])) != OK) {
+			return err;
+		}
+	} else {
+		init_checkpoint_key(stage_names[stage]);
+	}
+
+	if (stage == SERVE_SHARED_RASTERS) {
+		add_checkpoint_num("grid_res_sec", in_args.grid_res_sec);
+		add_checkpoint_num("lulc_res_sec", in_args.lulc_res_sec);
+		// the diagnostics of these stages are written to the output path of the first glu scenario
+		add_checkpoint_num("diagnostics", in_args.diagnostics);
+		if (in_args.diagnostics && !ckpt) {
+			add_checkpoint_arg("outpath", glu_scen[0].outpath);
+		}
+		add_checkpoint_arg("cell_area_fname", in_args.cell_area_fname);
+		add_checkpoint_arg("land_area_sage_fname", in_args.land_area_sage_fname);
+		add_checkpoint_arg("land_area_hyde_fname", in_args.land_area_hyde_fname);
+		add_checkpoint_arg("aez_orig_fname", in_args.aez_orig_fname);
+		add_checkpoint_arg("potveg_fname", in_args.potveg_fname);
+		add_checkpoint_arg("country_fao_fname", in_args.country_fao_fname);
+		add_checkpoint_arg("L1_fname", in_args.L1_fname);
+		add_checkpoint_arg("L2_fname", in_args.L2_fname);
+		add_checkpoint_arg("L3_fname", in_args.L3_fname);
+		add_checkpoint_arg("L4_fname", in_args.L4_fname);
+		add_checkpoint_arg("ALL_IUCN_fname", in_args.ALL_IUCN_fname);
+		add_checkpoint_arg("IUCN_1a_1b_2_fname", in_args.IUCN_1a_1b_2_fname);
+		add_checkpoint_arg("cropland_sage_fname", in_args.cropland_sage_fname);
+		add_checkpoint_arg("soil_carbon_wavg_fname", in_args.soil_carbon_wavg_fname);
+		add_checkpoint_arg("soil_carbon_min_fname", in_args.soil_carbon_min_fname);
+		add_checkpoint_arg("soil_carbon_median_fname", in_args.soil_carbon_median_fname);
+		add_checkpoint_arg("soil_carbon_max_fname", in_args.soil_carbon_max_fname);
+		add_checkpoint_arg("soil_carbon_q1_fname", in_args.soil_carbon_q1_fname);
+		add_checkpoint_arg("soil_carbon_q3_fname", in_args.soil_carbon_q3_fname);
+		add_checkpoint_arg("veg_carbon_wavg_fname", in_args.veg_carbon_wavg_fname);
+		add_checkpoint_arg("veg_carbon_min_fname", in_args.veg_carbon_min_fname);
+		add_checkpoint_arg("veg_carbon_median_fname", in_args.veg_carbon_median_fname);
+		add_checkpoint_arg("veg_carbon_max_fname", in_args.veg_carbon_max_fname);
+		add_checkpoint_arg("veg_carbon_q1_fname", in_args.veg_carbon_q1_fname);
+		add_checkpoint_arg("veg_carbon_q3_fname", in_args.veg_carbon_q3_fname);
+		add_checkpoint_arg("veg_BG_wavg_fname", in_args.veg_BG_wavg_fname);
+		add_checkpoint_arg("veg_BG_median_fname", in_args.veg_BG_median_fname);
+		add_checkpoint_arg("veg_BG_min_fname", in_args.veg_BG_min_fname);
+		add_checkpoint_arg("veg_BG_max_fname", in_args.veg_BG_max_fname);
+		add_checkpoint_arg("veg_BG_q1_fname", in_args.veg_BG_q1_fname);
+		add_checkpoint_arg("veg_BG_q3_fname", in_args.veg_BG_q3_fname);
+		// the csv info tables set the codes and the numbers of countries and land types that the rasters are read with
+		add_checkpoint_arg("country87_gtap_fname", in_args.country87_gtap_fname);
+		add_checkpoint_arg("country87map_fao_fname", in_args.country87map_fao_fname);
+		add_checkpoint_arg("country_all_fname", in_args.country_all_fname);
+		add_checkpoint_arg("countrymap_iso_gcam_region_fname", in_args.countrymap_iso_gcam_region_fname);
+		add_checkpoint_arg("regionlist_gcam_fname", in_args.regionlist_gcam_fname);
+		add_checkpoint_arg("use_gtap_fname", in_args.use_gtap_fname);
+		add_checkpoint_arg("lt_sage_fname", in_args.lt_sage_fname);
+		add_checkpoint_arg("lu_hyde_fname", in_args.lu_hyde_fname);
+		add_checkpoint_arg("lulc_fname", in_args.lulc_fname);
+		add_checkpoint_arg("crop_fname", in_args.crop_fname);
+		if ((err = add_checkpoint_dir(in_args.inpath)) != OK ||
+			(err = add_checkpoint_dir(in_args.hydepath)) != OK ||
+			(err = add_checkpoint_dir(in_args.lulcpath)) != OK) {
+			return err;
+		}
+		*key = get_checkpoint_key();
+		return OK;
+	}
+
+	// the inputs of every output stage
+	snprintf(key_str, sizeof(key_str), "%016llx", shared_key);
+	add_checkpoint_arg("shared_rasters", key_str);
+	add_checkpoint_num("diagnostics", in_args.diagnostics);
+	if (!ckpt) {
+		add_checkpoint_arg("outpath", in_args.outpath);
+	}
+	add_checkpoint_arg("region_subset", in_args.region_subset);
+	add_checkpoint_num("table_format", in_args.table_format);
+	for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+		add_checkpoint_arg("glu_scen", glu_scen[scen_ind].name);
+		add_checkpoint_arg("aez_new_fname", glu_scen[scen_ind].aez_new_fname);
+		add_checkpoint_arg("aez_new_info_fname", glu_scen[scen_ind].aez_new_info_fname);
+		if (!ckpt) {
+			add_checkpoint_arg("outpath", glu_scen[scen_ind].outpath);
+		}
+	}
+
+	// the inputs of the stage
+	switch (stage) {
+		case SERVE_MIRCA:
+			add_checkpoint_arg("mirca_irr_fname", in_args.mirca_irr_fname);
+			add_checkpoint_arg("mirca_rfd_fname", in_args.mirca_rfd_fname);
+			err = add_checkpoint_dir(in_args.mircapath);
+			break;
+		case SERVE_LAND_TYPE_AREA:
+			for (i = 0; i < num_hyde_years; i++) {
+				add_checkpoint_num("hyde_year", hyde_years[i]);
+			}
+			add_checkpoint_num("lulc_out_year", in_args.lulc_out_year);
+			add_checkpoint_arg("land_type_area_fname", in_args.land_type_area_fname);
+			add_checkpoint_arg("cell_store_fname", in_args.cell_store_fname);
+			break;
+		case SERVE_REFVEG_CARBON:
+			add_checkpoint_arg("refveg_carbon_fname", in_args.refveg_carbon_fname);
+			break;
+		case SERVE_WATER_FOOTPRINT:
+			add_checkpoint_arg("wf_fname", in_args.wf_fname);
+			err = add_checkpoint_dir(in_args.wfpath);
+			break;
+		case SERVE_CROP_RENT:
+			add_checkpoint_num("out_year_prod_ha_lr", in_args.out_year_prod_ha_lr);
+			add_checkpoint_num("in_year_sage_crops", in_args.in_year_sage_crops);
+			add_checkpoint_num("out_year_usd", in_args.out_year_usd);
+			add_checkpoint_num("in_year_lr_usd", in_args.in_year_lr_usd);
+			add_checkpoint_arg("rent_orig_fname", in_args.rent_orig_fname);
+			add_checkpoint_arg("production_fao_fname", in_args.production_fao_fname);
+			add_checkpoint_arg("yield_fao_fname", in_args.yield_fao_fname);
+			add_checkpoint_arg("harvestarea_fao_fname", in_args.harvestarea_fao_fname);
+			add_checkpoint_arg("prodprice_fao_fname", in_args.prodprice_fao_fname);
+			add_checkpoint_arg("convert_usd_fname", in_args.convert_usd_fname);
+			add_checkpoint_arg("harvestarea_fname", in_args.harvestarea_fname);
+			add_checkpoint_arg("production_fname", in_args.production_fname);
+			add_checkpoint_arg("rent_fname", in_args.rent_fname);
+			err = add_checkpoint_dir(in_args.sagepath);
+			break;
+		default:
+			break;
+	}
+	*key = get_checkpoint_key();
+
+	return err;
+}
+
+// the output tables of an output stage, and their TABLE_* formats; returns the number of tables
+static int get_stage_tables(args_struct in_args, int stage, const char **fnames, int *formats) {
+
+	int num_tables = 0;
+
+	switch (stage) {
+		case SERVE_MIRCA:
+			fnames[num_tables] = in_args.mirca_irr_fname;
+			formats[num_tables++] = TABLE_CSV;
+			fnames[num_tables] = in_args.mirca_rfd_fname;
+			formats[num_tables++] = TABLE_CSV;
+			break;
+		case SERVE_LAND_TYPE_AREA:
+			fnames[num_tables] = in_args.land_type_area_fname;
+			formats[num_tables++] = in_args.table_format;
+			break;
+		case SERVE_REFVEG_CARBON:
+			fnames[num_tables] = in_args.refveg_carbon_fname;
+			formats[num_tables++] = in_args.table_format;
+			break;
+		case SERVE_WATER_FOOTPRINT:
+			fnames[num_tables] = in_args.wf_fname;
+			formats[num_tables++] = TABLE_CSV;
+			break;
+		case SERVE_CROP_RENT:
+			fnames[num_tables] = in_args.harvestarea_fname;
+			formats[num_tables++] = TABLE_CSV;
+			fnames[num_tables] = in_args.production_fname;
+			formats[num_tables++] = TABLE_CSV;
+			fnames[num_tables] = in_args.rent_fname;
+			formats[num_tables++] = TABLE_CSV;
+			break;
+		default:
+			break;
+	}
+	return num_tables;
+}
+
+// 1 if a table is in the output path in each table format that is written
+static int table_exists(const char *outpath, const char *csv_fname, int table_format) {
+
+	char fname[MAXCHAR];
+	char nc_fname[MAXCHAR];
+
+	if (table_format & TABLE_CSV) {
+		snprintf(fname, MAXCHAR, "%s%s", outpath, csv_fname);
+		if (access(fname, F_OK) != 0) {
+			return 0;
+		}
+	}
+	if (table_format & TABLE_NC) {
+		get_nc_table_fname(nc_fname, csv_fname);
+		snprintf(fname, MAXCHAR, "%s%s", outpath, nc_fname);
+		if (access(fname, F_OK) != 0) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+// 1 if the output files of an output stage are in the output path of each glu scenario
+static int stage_outputs_exist(args_struct in_args, int stage) {
+
+	int scen_ind, i;
+	int num_tables;
+	const char *fnames[MAX_STAGE_TABLES];
+	int formats[MAX_STAGE_TABLES];
+
+	if ((num_tables = get_stage_tables(in_args, stage, fnames, formats)) == 0) {
+		return 0;
+	}
+	for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+		for (i = 0; i < num_tables; i++) {
+			if (!table_exists(glu_scen[scen_ind].outpath, fnames[i], formats[i])) {
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+// 1 if an output stage has a checkpoint in this run
+static int use_stage_checkpoint(args_struct in_args, int stage) {
+	return stage != SERVE_SHARED_RASTERS && stage != SERVE_LAND_TYPE_AREA && !in_args.diagnostics &&
+			strcmp(in_args.checkpoint_path, NONE_TEXT) != 0;
+}
+
+// declare the checkpoint of an output stage, with the tables of every glu scenario
+static int set_stage_checkpoint(args_struct in_args, int stage) {
+
+	int err = OK;
+	int scen_ind, i;
+	int num_tables;
+	unsigned long long shared_key, key;
+	const char *fnames[MAX_STAGE_TABLES];
+	int formats[MAX_STAGE_TABLES];
+	char nc_fname[MAXCHAR];
+
+	if ((err = set_stage_key(in_args, SERVE_SHARED_RASTERS, 1, 0, &shared_key)) != OK ||
+		(err = set_stage_key(in_args, stage, 1, shared_key, &key)) != OK) {
+		return err;
+	}
+	num_tables = get_stage_tables(in_args, stage, fnames, formats);
+	for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+		for (i = 0; i < num_tables; i++) {
+			if ((formats[i] & TABLE_CSV) &&
+				(err = add_checkpoint_output(glu_scen[scen_ind].outpath, fnames[i])) != OK) {
+				return err;
+			}
+			if (formats[i] & TABLE_NC) {
+				get_nc_table_fname(nc_fname, fnames[i]);
+				if ((err = add_checkpoint_output(glu_scen[scen_ind].outpath, nc_fname)) != OK) {
+					return err;
+				}
+			}
+		}
+	}
+	return OK;
+}
+
+// make the keys of all the stages; a key that cannot be made is not valid, and its stage is processed
+static void set_stage_keys(args_struct in_args, unsigned long long *keys, int *valid) {
+
+	int stage;
+
+	valid[SERVE_SHARED_RASTERS] = (set_stage_key(in_args, SERVE_SHARED_RASTERS, 0, 0, &keys[SERVE_SHARED_RASTERS]) == OK);
+	for (stage = SERVE_SHARED_RASTERS + 1; stage < NUM_SERVE_STAGES; stage++) {
+		valid[stage] = valid[SERVE_SHARED_RASTERS] &&
+						(set_stage_key(in_args, stage, 0, keys[SERVE_SHARED_RASTERS], &keys[stage]) == OK);
+	}
+}
+
+void start_serve_stages(void) {
+	serve_on = 1;
+	shared_resident = 0;
+	prev_ok = 0;
+}
+
+void stop_serve_stages(void) {
+	if (shared_resident) {
+		free_shared_rasters(shared_info);
+	}
+	serve_on = 0;
+	shared_resident = 0;
+	prev_ok = 0;
+}
+
+// restore the output stages that have a checkpoint with the key; they are not processed in this run
+static int restore_stage_checkpoints(args_struct in_args) {
+
+	int err = OK;
+	int stage;
+	int restored;
+
+	for (stage = SERVE_SHARED_RASTERS + 1; stage < NUM_SERVE_STAGES; stage++) {
+		if (stage_status[stage] != SERVE_RUN || !use_stage_checkpoint(in_args, stage)) {
+			continue;
+		}
+		if ((err = set_stage_checkpoint(in_args, stage)) != OK || (err = restore_checkpoint(&restored)) != OK) {
+			return err;
+		}
+		if (restored) {
+			stage_status[stage] = SERVE_RESTORED;
+		}
+	}
+	return OK;
+}
+
+int set_serve_stages(args_struct in_args, rinfo_struct *raster_info) {
+
+	int err = OK;
+	int stage;
+	unsigned long long keys[NUM_SERVE_STAGES];
+	int valid[NUM_SERVE_STAGES];
+
+	for (stage = 0; stage < NUM_SERVE_STAGES; stage++) {
+		stage_status[stage] = SERVE_RUN;
+	}
+	if (!serve_on) {
+		return restore_stage_checkpoints(in_args);
+	}
+
+	set_stage_keys(in_args, keys, valid);
+
+	// use the resident shared rasters, or free them for this request
+	if (shared_resident && prev_ok && valid[SERVE_SHARED_RASTERS] && keys[SERVE_SHARED_RASTERS] == prev_keys[SERVE_SHARED_RASTERS]) {
+		stage_status[SERVE_SHARED_RASTERS] = SERVE_KEPT;
+		*raster_info = shared_info;
+	} else if (shared_resident) {
+		free_shared_rasters(shared_info);
+		shared_resident = 0;
+	}
+
+	for (stage = SERVE_SHARED_RASTERS + 1; stage < NUM_SERVE_STAGES; stage++) {
+		if (prev_ok && valid[stage] && keys[stage] == prev_keys[stage] && stage_outputs_exist(in_args, stage)) {
+			stage_status[stage] = SERVE_KEPT;
+		}
+	}
+
+	if ((err = restore_stage_checkpoints(in_args)) != OK) {
+		return err;
+	}
+
+	fprintf(fplog, "\nServe request stages:\n");
+	for (stage = 0; stage < NUM_SERVE_STAGES; stage++) {
+		if (stage_status[stage] == SERVE_RUN) {
+			fprintf(fplog, "%s: processed\n", stage_names[stage]);
+		} else if (stage == SERVE_SHARED_RASTERS) {
+			fprintf(fplog, "%s: kept in memory from the previous request\n", stage_names[stage]);
+		} else if (stage_status[stage] == SERVE_RESTORED) {
+			fprintf(fplog, "%s: not processed; its outputs are restored from a checkpoint\n", stage_names[stage]);
+		} else {
+			fprintf(fplog, "%s: not processed; its outputs in the output path are kept from the previous request\n",
+					stage_names[stage]);
+		}
+	}
+
+	return OK;}
+
+int run_serve_stage(int stage) {
+	return stage_status[stage] == SERVE_RUN;
+}
+
+int save_stage_checkpoint(args_struct in_args, int stage, int scen_ind) {
+
+	int err = OK;
+
+	if (scen_ind != num_glu_scen - 1 || stage_status[stage] != SERVE_RUN || !use_stage_checkpoint(in_args, stage)) {
+		return OK;
+	}
+	if ((err = set_stage_checkpoint(in_args, stage)) != OK) {
+		return err;
+	}
+	return save_checkpoint();
+}
+
+void end_serve_stages(args_struct in_args, rinfo_struct *raster_info, int error_code) {
+
+	int stage;
+	int valid[NUM_SERVE_STAGES];
+
+	if (!serve_on || error_code != OK || glu_scen == NULL) {
+		free_shared_rasters(*raster_info);
+		shared_resident = 0;
+		prev_ok = 0;
+		return;
+	}
+
+	// the keys are made again after the run, because read_hyde32() may have unzipped hyde files
+	set_stage_keys(in_args, prev_keys, valid);
+	prev_ok = 1;
+	for (stage = 0; stage < NUM_SERVE_STAGES; stage++) {
+		prev_ok = prev_ok && valid[stage];
+	}
+	shared_info = *raster_info;
+	shared_resident = 1;
+}
+
+const char *get_serve_stage(int stage, int *status) {
+	*status = stage_status[stage];
+	return stage_names[stage];
+}
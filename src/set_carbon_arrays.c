@@ -0,0 +1,227 @@
+/**********
+ set_carbon_arrays.c
+ 
+ size the soil and veg carbon cell arrays for each country X glu X land type that occurs
+    they are indexed by the refveg_carbon_tally slot (see lt_tally.c and write_glu_mapping.c)
+    soil_carbon_array_cells[slot] counts the land cells of each slot, and proc_refveg_carbon() fills the arrays
+ this depends on the glus, so it is done for each glu scenario
+    the carbon rasters themselves are read once for the run, in read_soil_carbon() and read_veg_carbon()
+ 
+ arguments: none
+    the rasters and the country glu lists are globals that are set before this is called
+ 
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+ 
+ Created on 18 Oct 2026
+    this is the land cell loop that was in read_soil_carbon()
+ 
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+ 
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+ 
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+ 
+ This file is part of Moirai.
+ 
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+ 
+ **********/
+
+#include "moirai.h"
+
+int set_carbon_arrays(void) {
+    
+    int ncells = NUM_CELLS;		// number of working grid cells
+    int rv_ind;
+    int i,j, k=0;
+    int slot;                       // refveg_carbon_tally slot of the current country glu land type
+    int grid_ind;
+    int scg_code = 186;         // fao code for serbia and montenegro
+    int srb_code = 272;         // fao code for serbia
+    int mne_code = 273;         // fao code for montenegro
+    int rv_value;           // current ref veg value
+    int aez_val;            // current glu value
+    int ctry_code;          // current fao country code
+    int aez_ind;            // current glu index in ctry_aez_list[ctry_ind]
+    int ctry_ind;           // current country index in ctry_aez_list
+    int cur_lt_cat;             // current land type category
+    int cur_lt_cat_ind;             // current land type category index
+    int memory_median=0;        // This is used to calculate memory to be allocated
+    int memory_min=0;           // This is used to calculate memory to be allocated 
+    int memory_max=0;           // This is used to calculate memory to be allocated
+    int memory_q1=0;            // This is used to calculate memory to be allocated 
+    int memory_q3=0;            // This is used to calculate memory to be allocated
+    
+    //First loop to get the number of cells per array
+     for (j = 0; j < ncells ; j++){//for each cell
+               //assign a grid index
+               grid_ind = land_cells_hyde[j];                              
+               //assign aez and country code
+               aez_val = aez_bounds_new[grid_ind];
+               ctry_code = country_fao[grid_ind];
+
+               if (aez_val != -9999) {
+            // get the fao country index
+            
+            ctry_ind = NOMATCH;
+            for (i = 0; i < NUM_FAO_CTRY; i++) {
+                if (countrycodes_fao[i] == ctry_code) {
+                    ctry_ind = i;
+                    break;
+                }
+            } // end for i loop to get ctry index
+            
+
+             // merge serbia and montenegro for scg record
+            if (ctry_code == mne_code || ctry_code == srb_code) {
+                ctry_code = scg_code;
+                ctry_ind = NOMATCH;
+                for (i = 0; i < NUM_FAO_CTRY; i++) {
+                    if (countrycodes_fao[i] == ctry_code) {
+                        ctry_ind = i;
+                        break;
+                    }
+                }
+                if (ctry_ind == NOMATCH) {
+                    // this should never happen
+                    fprintf(fplog, "Error finding scg ctry index: proc_refveg_carbon()\n");
+                    return ERROR_IND;
+                }
+            } // end if serbia or montenegro
+            
+
+           
+            if (ctry_ind == NOMATCH || ctry2ctry87codes_gtap[ctry_ind] == NOMATCH) {
+				continue;
+			}
+
+            aez_ind = NOMATCH;
+            for (i = 0; i < ctry_aez_num[ctry_ind]; i++) {
+                if (ctry_aez_list[ctry_ind][i] == aez_val) {
+                    aez_ind = i;
+                    break;
+                }
+            }// end for i loop to get aez index
+            if (aez_ind == NOMATCH) {
+                fprintf(fplog, "Failed to match aez %i to country %i: proc_refveg_carbon()\n",aez_val,ctry_code);
+                return ERROR_IND;
+            }
+
+            // get index of sage pot veg; set value to 0 if unknown
+            rv_ind = NOMATCH;
+            for (i = 0; i < NUM_SAGE_PVLT; i++) {
+                if (refvegcarbon_thematic[grid_ind] == landtypecodes_sage[i]) {
+                    rv_ind = i;
+                    break;
+                }
+            }
+			// set the c values for this cell; use existing variables
+            if (rv_ind == NOMATCH) {
+                rv_value = 0;
+				}else {
+                rv_value = refvegcarbon_thematic[grid_ind];
+				
+            }
+
+            for (k=0; k< NUM_EPA_PROTECTED; k++){
+				// get index of land category
+				
+
+                cur_lt_cat = rv_value * SCALE_POTVEG + k;
+				cur_lt_cat_ind = NOMATCH;
+				for (i = 0; i < num_lt_cats; i++) {
+					if (lt_cats[i] == cur_lt_cat) {
+						cur_lt_cat_ind = i;
+						break;
+					}
+				}
+				if (cur_lt_cat_ind == NOMATCH) {
+					fprintf(fplog, "Failed to match lt_cat %i: proc_refveg_carbon()\n", cur_lt_cat);
+					return ERROR_IND;
+				}
+				// get the carbon array slot of this country glu land type
+				slot = find_lt_tally_slot(&refveg_carbon_tally, ctry_ind, aez_ind, cur_lt_cat_ind);
+				if (slot == NOMATCH) {
+					fprintf(fplog, "Failed to match lt_cat %i to country %i glu %i: set_carbon_arrays()\n", cur_lt_cat, ctry_code, aez_val);
+					return ERROR_IND;
+				}
+                //assign the actual soil carbon numbers
+               // Don't assign a value if the value is a NODATA value. 
+               
+               
+               
+
+
+                
+                //calculate the number of cells to hold within each array
+                
+                soil_carbon_array_cells[slot]= soil_carbon_array_cells[slot]+ 1; 
+                
+             
+             //Convert this to an integer
+              memory_median = (float) floor((double) 0.5+ soil_carbon_array_cells[slot]);
+              memory_min = (float) floor((double) 0.5+  soil_carbon_array_cells[slot]);
+              memory_max = (float) floor((double) 0.5+  soil_carbon_array_cells[slot]);
+              memory_q1 = (float) floor((double) 0.5+ soil_carbon_array_cells[slot]);
+              memory_q3 = (float) floor((double) 0.5+ soil_carbon_array_cells[slot]);   
+               
+                
+                //use the calculated number of cells to allocate memory for the soil_carbon_array. The number of cells won't change for veg_carbon so allocate the size of that array here as well. 
+                //Don't allocate 0 memory. If size is 0, then keep size at 1. This reduces problems during the free() calls later
+                if(memory_median>0){
+                
+                free(soil_carbon_array[slot][0]);  
+                soil_carbon_array[slot][0]=calloc(memory_median,sizeof(float));
+                
+                
+                free(soil_carbon_array[slot][1]);  
+                soil_carbon_array[slot][1]=calloc(memory_median,sizeof(float));
+            
+                free(soil_carbon_array[slot][2]);
+                soil_carbon_array[slot][2]=calloc(memory_min,sizeof(float));
+            
+                free(soil_carbon_array[slot][3]);
+                soil_carbon_array[slot][3]=calloc(memory_max,sizeof(float));
+            
+                free(soil_carbon_array[slot][4]);
+                soil_carbon_array[slot][4]=calloc(memory_q1,sizeof(float));
+            
+                free(soil_carbon_array[slot][5]);
+                soil_carbon_array[slot][5]=calloc(memory_q3,sizeof(float));
+
+                free(veg_carbon_array[slot][0]);  
+                veg_carbon_array[slot][0]=calloc(memory_median,sizeof(float));
+
+                free(veg_carbon_array[slot][1]);  
+                veg_carbon_array[slot][1]=calloc(memory_median,sizeof(float));
+            
+                free(veg_carbon_array[slot][2]);
+                veg_carbon_array[slot][2]=calloc(memory_min,sizeof(float));
+            
+                free(veg_carbon_array[slot][3]);
+                veg_carbon_array[slot][3]=calloc(memory_max,sizeof(float));
+            
+                free(veg_carbon_array[slot][4]);
+                veg_carbon_array[slot][4]=calloc(memory_q1,sizeof(float));
+            
+                free(veg_carbon_array[slot][5]);
+                veg_carbon_array[slot][5]=calloc(memory_q3,sizeof(float));
+                }
+
+            }//finish loop for protected areas
+        }//finish loop for aez
+    }//finish loop for cells
+
+    return OK;}
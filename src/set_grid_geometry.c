@@ -0,0 +1,122 @@
+/**********
+ set_grid_geometry.c
+
+ set the working grid and lulc input grid geometry from the resolutions in the input file
+    grid_res_sec and lulc_res_sec are in arc-seconds
+ the working grid covers the globe (-180 to 180 lon, -90 to 90 lat) with the origin at the upper left corner
+    so 180 degrees must divide into an even number of rows, and the number of columns is twice the rows
+    e.g., 300 arc-sec = 2160x4320 (the default), 150 arc-sec = 4320x8640, 30 arc-sec = 21600x43200
+ the lulc input grid also covers the globe, and each lulc cell must contain a whole number of working grid cells
+    num_split is the number of working grid cells in one dimension of a lulc cell
+ the crop stages can process the working grid in latitude bands of band_lulc_rows lulc rows (band_nrows working rows)
+    so that only one band of each crop raster buffer is in memory; band_lulc_rows = 0 processes the whole globe at once
+    only the crop raster reads are banded: get_land_cells(), proc_land_type_area(), proc_refveg_carbon(),
+    and the static layers still use whole globe arrays, so the peak memory is set by these, not by the band size
+
+ this sets the NUM_LAT, NUM_LON, NUM_CELLS, GRID_RES, GRID_RES_SEC, NUM_LAT_LULC, NUM_LON_LULC, NUM_CELLS_LULC globals
+    and the grid geometry in raster_info, which the raster readers check their inputs against
+ it has to be called before any raster data are read
+
+ arguments:
+ args_struct in_args: the input file arguments
+ rinfo_struct *raster_info: information about input raster data
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+ 
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+ 
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+ 
+ This file is part of Moirai.
+ 
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+ **********/
+
+#include "moirai.h"
+
+int set_grid_geometry(args_struct in_args, rinfo_struct *raster_info) {
+	
+	double nrows_dbl;			// number of working grid rows as computed from the resolution
+	double nrows_lulc_dbl;		// number of lulc rows as computed from the resolution
+	double split_dbl;			// number of working grid cells in one dimension of a lulc cell
+	
+	if (in_args.grid_res_sec <= 0 || in_args.lulc_res_sec <= 0) {
+		fprintf(fplog, "Error: grid_res_sec=%lf and lulc_res_sec=%lf must be positive: set_grid_geometry()\n",
+				in_args.grid_res_sec, in_args.lulc_res_sec);
+		return ERROR_USAGE;
+	}
+	
+	// working grid
+	nrows_dbl = 180.0 * DEG2SEC / in_args.grid_res_sec;
+	if (fabs(nrows_dbl - floor(nrows_dbl + 0.5)) > ROUND_TOLERANCE || ((int) floor(nrows_dbl + 0.5)) % 2 != 0) {
+		fprintf(fplog, "Error: grid_res_sec=%lf does not divide 180 degrees into an even number of rows: set_grid_geometry()\n",
+				in_args.grid_res_sec);
+		return ERROR_USAGE;
+	}
+	// NUM_CELLS is an int, and it is also used for the sizes of the raster reads
+	if (2.0 * floor(nrows_dbl + 0.5) * floor(nrows_dbl + 0.5) > 2147483647.0) {
+		fprintf(fplog, "Error: grid_res_sec=%lf gives too many working grid cells: set_grid_geometry()\n", in_args.grid_res_sec);
+		return ERROR_USAGE;
+	}
+	
+	// lulc grid
+	nrows_lulc_dbl = 180.0 * DEG2SEC / in_args.lulc_res_sec;
+	split_dbl = in_args.lulc_res_sec / in_args.grid_res_sec;
+	if (fabs(nrows_lulc_dbl - floor(nrows_lulc_dbl + 0.5)) > ROUND_TOLERANCE ||
+		fabs(split_dbl - floor(split_dbl + 0.5)) > ROUND_TOLERANCE || split_dbl < 1) {
+		fprintf(fplog, "Error: lulc_res_sec=%lf must divide 180 degrees evenly and be an integer multiple of grid_res_sec=%lf: set_grid_geometry()\n",
+				in_args.lulc_res_sec, in_args.grid_res_sec);
+		return ERROR_USAGE;
+	}
+	
+	if (in_args.band_lulc_rows < 0) {
+		fprintf(fplog, "Error: band_lulc_rows=%i must not be negative: set_grid_geometry()\n", in_args.band_lulc_rows);
+		return ERROR_USAGE;
+	}
+	
+	NUM_LAT = (int) floor(nrows_dbl + 0.5);
+	NUM_LON = 2 * NUM_LAT;
+	NUM_CELLS = NUM_LAT * NUM_LON;
+	GRID_RES_SEC = in_args.grid_res_sec;
+	GRID_RES = GRID_RES_SEC * SEC2DEG;
+	NUM_LAT_LULC = (int) floor(nrows_lulc_dbl + 0.5);
+	NUM_LON_LULC = 2 * NUM_LAT_LULC;
+	NUM_CELLS_LULC = NUM_LAT_LULC * NUM_LON_LULC;
+	
+	raster_info->grid_nrows = NUM_LAT;
+	raster_info->grid_ncols = NUM_LON;
+	raster_info->grid_ncells = NUM_CELLS;
+	raster_info->grid_res = GRID_RES;
+	raster_info->grid_res_sec = GRID_RES_SEC;
+	raster_info->lulc_res = in_args.lulc_res_sec * SEC2DEG;
+	raster_info->num_split = (int) floor(split_dbl + 0.5);
+	
+	// latitude bands are aligned to the lulc rows; the last band may be shorter
+	if (in_args.band_lulc_rows == 0 || in_args.band_lulc_rows >= NUM_LAT_LULC) {
+		raster_info->band_nrows = NUM_LAT;
+	} else {
+		raster_info->band_nrows = in_args.band_lulc_rows * raster_info->num_split;
+	}
+	raster_info->num_bands = (NUM_LAT + raster_info->band_nrows - 1) / raster_info->band_nrows;
+	
+	fprintf(fplog, "\nWorking grid: %i x %i cells at %lf arc-sec; lulc grid: %i x %i cells at %lf arc-sec; num_split = %i\n",
+			NUM_LAT, NUM_LON, GRID_RES_SEC, NUM_LAT_LULC, NUM_LON_LULC, in_args.lulc_res_sec, raster_info->num_split);
+	fprintf(fplog, "Crop stages: %i latitude band(s) of %i working grid rows\n", raster_info->num_bands, raster_info->band_nrows);
+	
+	return OK;}
@@ -0,0 +1,135 @@
+/**********
+ set_hyde_years.c
+
+ set the hyde years that proc_land_type_area() processes, from hyde_years in the input file
+    all = every available hyde year (1700 to 2000 by decade, then 2001 to 2016 yearly)
+    a comma separated list of years and ranges, e.g. 1975-2015 or 1700,1850,2000-2016
+ a single year must be an available hyde year; a range selects the available years within it
+ the years are stored in increasing order without duplicates, in the hyde_years[num_hyde_years] global table
+    which then sets the years read, the area_out allocation, and the Land_type_area output records
+
+ the hyde years are processed independently, so the output records for a year match those of an all year run
+
+ arguments:
+ args_struct in_args: the input file arguments
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+ 
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+ 
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+ 
+ This file is part of Moirai.
+ 
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+ **********/
+
+#include "moirai.h"
+
+int set_hyde_years(args_struct in_args) {
+
+	int i;
+	int year1, year2;				// first and last year of the current list entry
+	int found;						// number of available years selected by the current list entry
+	int avail_years[NUM_HYDE_YEARS];	// all available hyde years
+	int year_flag[NUM_HYDE_YEARS];	// 1 if the available hyde year is selected
+
+	char years[MAXCHAR];			// the year list, to be split
+	char *tok;						// current list entry
+	char *dash;						// the range separator in the current list entry
+
+	// create the array of available years
+	avail_years[0] = HYDE_START_YEAR;
+	for (i = 1; i < (NUM_HYDE_YEARS - NUM_HYDE_POST2000_YEARS); i++) {
+		avail_years[i] = avail_years[i-1] + 10;
+	}
+	for (i = (NUM_HYDE_YEARS - NUM_HYDE_POST2000_YEARS); i < NUM_HYDE_YEARS; i++) {
+		avail_years[i] = avail_years[i-1] + 1;
+	}
+
+	// select the years
+	for (i = 0; i < NUM_HYDE_YEARS; i++) {
+		year_flag[i] = 0;
+	}
+	if (strcmp(in_args.hyde_years, ALL_TEXT) == 0) {
+		for (i = 0; i < NUM_HYDE_YEARS; i++) {
+			year_flag[i] = 1;
+		}
+	} else {
+		strcpy(years, in_args.hyde_years);
+		for (tok = strtok(years, ","); tok != NULL; tok = strtok(NULL, ",")) {
+			// a range has a dash after its first digit
+			dash = strchr(tok + 1, '-');
+			year1 = atoi(tok);
+			if (dash == NULL) {
+				year2 = year1;
+			} else {
+				year2 = atoi(dash + 1);
+			}
+			if (year1 <= 0 || year2 < year1) {
+				fprintf(fplog, "Error: invalid hyde_years entry %s: set_hyde_years()\n", tok);
+				return ERROR_USAGE;
+			}
+			found = 0;
+			for (i = 0; i < NUM_HYDE_YEARS; i++) {
+				if (avail_years[i] >= year1 && avail_years[i] <= year2) {
+					year_flag[i] = 1;
+					found++;
+				}
+			}
+			if (found == 0) {
+				fprintf(fplog, "Error: hyde_years entry %s has no available hyde year: set_hyde_years()\n", tok);
+				return ERROR_USAGE;
+			}
+		} // end for loop over the list entries
+	}
+
+	// store the selected years in order
+	num_hyde_years = 0;
+	for (i = 0; i < NUM_HYDE_YEARS; i++) {
+		num_hyde_years = num_hyde_years + year_flag[i];
+	}
+	hyde_years = calloc(num_hyde_years, sizeof(int));
+	if(hyde_years == NULL) {
+		fprintf(fplog,"Failed to allocate memory for hyde_years:  set_hyde_years()\n");
+		return ERROR_MEM;
+	}
+	num_hyde_years = 0;
+	for (i = 0; i < NUM_HYDE_YEARS; i++) {
+		if (year_flag[i]) {
+			hyde_years[num_hyde_years++] = avail_years[i];
+		}
+	}
+
+	fprintf(fplog, "\nHYDE years %s: %i years, %i to %i\n", in_args.hyde_years, num_hyde_years,
+			hyde_years[0], hyde_years[num_hyde_years - 1]);
+
+	// the lulc output rasters are written only for a processed year
+	found = 0;
+	for (i = 0; i < num_hyde_years; i++) {
+		if (hyde_years[i] == in_args.lulc_out_year) {
+			found = 1;
+		}
+	}
+	if (!found) {
+		fprintf(fplog, "Warning: lulc_out_year %i is not in hyde_years, so the lulc output rasters are not written: set_hyde_years()\n",
+				in_args.lulc_out_year);
+	}
+
+	return OK;}
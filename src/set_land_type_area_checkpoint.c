@@ -0,0 +1,143 @@
+/**********
+ set_land_type_area_checkpoint.c
+
+ declare the checkpoint of the land type area stage, proc_land_type_area(); see checkpoint.c
+    this is the long stage of a run, because it reads and disaggregates the hyde and lulc data of every hyde year
+    its outputs are files only, so a rerun with the same inputs can restore them and skip the stage
+    (the later stages do not use any array that it fills)
+
+ inputs in the key:
+    the input arguments that the stage and the stages before it use for the land type area:
+        the grid geometry, region subset, hyde years, the land, country, glu, potveg, and protected area rasters,
+        the country, region, glu, and land type csv files, lulc_out_year, the cell store file name, and the table format
+    the glu scenario names and glu files
+    the files in inpath, hydepath, and lulcpath
+ outputs:
+    the land type area table of each glu scenario, in each table format
+    the lulc_out_year grids of each glu scenario, if lulc_out_year is one of the hyde years
+    the cell store, if it is written
+
+ this is called before the stage to restore the outputs, and again after the stage to save them,
+    because read_hyde32() unzips the hyde files into hydepath on the first run, which changes the key
+
+ arguments:
+ args_struct in_args: the input file arguments of the last glu scenario, which processes the land type area
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+ 
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+ 
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+ 
+ This file is part of Moirai.
+ 
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+ **********/
+
+#include "moirai.h"
+
+int set_land_type_area_checkpoint(args_struct in_args) {
+
+	int i, scen_ind;
+	int err = OK;					// error code from the checkpoint functions
+	int write_lulc_out = 0;			// 1 = the lulc_out_year grids are written
+	char fname[MAXCHAR];			// output file name
+	char nc_fname[MAXCHAR];			// netcdf land type area table file name
+	char *lulc_out_names[] = {"cropland_area_", "pasture_area_", "urban_area_", "refveg_area_", "refveg_thematic_"};
+	int num_lulc_out = 5;			// number of lulc_out_year grids
+
+	if ((err = init_checkpoint(in_args, "proc_land_type_area")) != OK) {
+		return err;
+	}
+
+	// the input arguments
+	add_checkpoint_num("grid_res_sec", in_args.grid_res_sec);
+	add_checkpoint_num("lulc_res_sec", in_args.lulc_res_sec);
+	add_checkpoint_arg("region_subset", in_args.region_subset);
+	for (i = 0; i < num_hyde_years; i++) {
+		add_checkpoint_num("hyde_year", hyde_years[i]);
+	}
+	add_checkpoint_num("lulc_out_year", in_args.lulc_out_year);
+	add_checkpoint_arg("cell_area_fname", in_args.cell_area_fname);
+	add_checkpoint_arg("land_area_sage_fname", in_args.land_area_sage_fname);
+	add_checkpoint_arg("land_area_hyde_fname", in_args.land_area_hyde_fname);
+	add_checkpoint_arg("aez_orig_fname", in_args.aez_orig_fname);
+	add_checkpoint_arg("potveg_fname", in_args.potveg_fname);
+	add_checkpoint_arg("country_fao_fname", in_args.country_fao_fname);
+	add_checkpoint_arg("L1_fname", in_args.L1_fname);
+	add_checkpoint_arg("L2_fname", in_args.L2_fname);
+	add_checkpoint_arg("L3_fname", in_args.L3_fname);
+	add_checkpoint_arg("L4_fname", in_args.L4_fname);
+	add_checkpoint_arg("ALL_IUCN_fname", in_args.ALL_IUCN_fname);
+	add_checkpoint_arg("IUCN_1a_1b_2_fname", in_args.IUCN_1a_1b_2_fname);
+	add_checkpoint_arg("country87_gtap_fname", in_args.country87_gtap_fname);
+	add_checkpoint_arg("country87map_fao_fname", in_args.country87map_fao_fname);
+	add_checkpoint_arg("country_all_fname", in_args.country_all_fname);
+	add_checkpoint_arg("countrymap_iso_gcam_region_fname", in_args.countrymap_iso_gcam_region_fname);
+	add_checkpoint_arg("regionlist_gcam_fname", in_args.regionlist_gcam_fname);
+	add_checkpoint_arg("lt_sage_fname", in_args.lt_sage_fname);
+	add_checkpoint_arg("lu_hyde_fname", in_args.lu_hyde_fname);
+	add_checkpoint_arg("lulc_fname", in_args.lulc_fname);
+	add_checkpoint_arg("cell_store_fname", in_args.cell_store_fname);
+	add_checkpoint_num("table_format", in_args.table_format);
+	for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+		add_checkpoint_arg("glu_scen", glu_scen[scen_ind].name);
+		add_checkpoint_arg("aez_new_fname", glu_scen[scen_ind].aez_new_fname);
+		add_checkpoint_arg("aez_new_info_fname", glu_scen[scen_ind].aez_new_info_fname);
+	}
+
+	// the input files
+	if ((err = add_checkpoint_dir(in_args.inpath)) != OK ||
+		(err = add_checkpoint_dir(in_args.hydepath)) != OK ||
+		(err = add_checkpoint_dir(in_args.lulcpath)) != OK) {
+		return err;
+	}
+
+	// the output files
+	for (i = 0; i < num_hyde_years; i++) {
+		if (hyde_years[i] == in_args.lulc_out_year) {
+			write_lulc_out = 1;
+		}
+	}
+	get_nc_table_fname(nc_fname, in_args.land_type_area_fname);
+	for (scen_ind = 0; scen_ind < num_glu_scen; scen_ind++) {
+		if ((in_args.table_format & TABLE_CSV) &&
+			(err = add_checkpoint_output(glu_scen[scen_ind].outpath, in_args.land_type_area_fname)) != OK) {
+			return err;
+		}
+		if ((in_args.table_format & TABLE_NC) &&
+			(err = add_checkpoint_output(glu_scen[scen_ind].outpath, nc_fname)) != OK) {
+			return err;
+		}
+		if (write_lulc_out) {
+			for (i = 0; i < num_lulc_out; i++) {
+				sprintf(fname, "%s%i.bil", lulc_out_names[i], in_args.lulc_out_year);
+				if ((err = add_checkpoint_output(glu_scen[scen_ind].outpath, fname)) != OK) {
+					return err;
+				}
+			}
+		}
+	}
+	if (strcmp(in_args.cell_store_fname, NONE_TEXT) != 0) {
+		if ((err = add_checkpoint_output(in_args.outpath, in_args.cell_store_fname)) != OK) {
+			return err;
+		}
+	}
+
+	return OK;}
@@ -0,0 +1,265 @@
+/**********
+ set_region_subset.c
+
+ restrict the run to a subset of countries, set by region_subset in the input file
+    none = the whole globe
+    iso:usa,can = the listed iso3 country codes
+    region:1,7 = the countries in the listed gcam regions
+    glu:12,35 = the countries that have land in the listed glus
+
+ the subset is always a set of whole countries, because the recalibration is scaled to country totals
+    so a glu subset keeps all of the glus of each country that it touches
+ the subset is also extended to whole land rent regions (gtap ctry87), because the land rent is scaled to their totals
+    and serbia, montenegro, and serbia and montenegro are merged in processing, so they are selected together
+ the outputs for the selected countries match the same rows of a whole globe run
+
+ cells outside the subset are given the glu nodata value, which removes them from every output
+    get_land_cells() then leaves them out of the land cell lists, so the crop stages skip them
+    and the crop stages read only the subset bounding box window of their latitude bands (see get_lat_band.c)
+    and proc_land_type_area() skips the lulc cells outside the subset bounding box
+ the gcam region diagnostics hold only the subset countries, so they are written with a _subset suffix
+    (see aggregate_crop2gcam.c and aggregate_use2gcam.c)
+
+ this has to be called after the country, gcam region, and glu data are read, and before get_land_cells()
+ the subset bounding box is stored in raster_info; it is the whole working grid if there is no subset
+
+ arguments:
+ args_struct in_args: the input file arguments
+ rinfo_struct *raster_info: information about input raster data
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+ 
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+ 
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+ 
+ This file is part of Moirai.
+ 
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+ **********/
+
+#include "moirai.h"
+
+int set_region_subset(args_struct in_args, rinfo_struct *raster_info) {
+
+	int i, j;
+	int subset_type;				// 1 = iso codes, 2 = gcam region codes, 3 = glu codes
+	int code;						// current integer code from the list
+	int found;						// number of countries added by the current code or closure pass
+	int max_code = 0;				// largest fao country code
+	int ctry_code;					// fao country code of the current cell
+	int row, col;					// row and column of the current cell
+	int num_ctry = 0;				// number of countries in the subset
+	int num_cells = 0;				// number of glu cells in the subset
+	int merge_scg;					// 1 if any of serbia and montenegro is in the subset
+	int scg_codes[] = {186, 272, 273};	// fao codes for serbia and montenegro, serbia, and montenegro
+	int *code2ctry;					// fao country index for each fao country code; NOMATCH = no country
+	int *ctry_flag;					// 1 if the fao country index is in the subset
+
+	char codes[MAXCHAR];			// the code list, to be split
+	char *sep;						// the type separator in region_subset
+	char *tok;						// current code in the list
+
+	// default is the whole working grid
+	raster_info->subset = 0;
+	raster_info->subset_row_min = 0;
+	raster_info->subset_row_max = NUM_LAT - 1;
+	raster_info->subset_col_min = 0;
+	raster_info->subset_col_max = NUM_LON - 1;
+
+	if (strcmp(in_args.region_subset, NONE_TEXT) == 0) {
+		return OK;
+	}
+
+	// get the subset type
+	sep = strchr(in_args.region_subset, ':');
+	if (sep == NULL) {
+		fprintf(fplog, "Error: region_subset %s must be none or type:code,code,...: set_region_subset()\n", in_args.region_subset);
+		return ERROR_USAGE;
+	}
+	if (strncmp(in_args.region_subset, "iso", sep - in_args.region_subset) == 0 && sep - in_args.region_subset == 3) {
+		subset_type = 1;
+	} else if (strncmp(in_args.region_subset, "region", sep - in_args.region_subset) == 0 && sep - in_args.region_subset == 6) {
+		subset_type = 2;
+	} else if (strncmp(in_args.region_subset, "glu", sep - in_args.region_subset) == 0 && sep - in_args.region_subset == 3) {
+		subset_type = 3;
+	} else {
+		fprintf(fplog, "Error: region_subset type in %s must be iso, region, or glu: set_region_subset()\n", in_args.region_subset);
+		return ERROR_USAGE;
+	}
+
+	// fao country index by fao country code, for the cell loops
+	for (i = 0; i < NUM_FAO_CTRY; i++) {
+		if (countrycodes_fao[i] > max_code) {
+			max_code = countrycodes_fao[i];
+		}
+	}
+	code2ctry = calloc(max_code + 1, sizeof(int));
+	if(code2ctry == NULL) {
+		fprintf(fplog,"Failed to allocate memory for code2ctry:  set_region_subset()\n");
+		return ERROR_MEM;
+	}
+	for (i = 0; i <= max_code; i++) {
+		code2ctry[i] = NOMATCH;
+	}
+	for (i = 0; i < NUM_FAO_CTRY; i++) {
+		if (countrycodes_fao[i] >= 0) {
+			code2ctry[countrycodes_fao[i]] = i;
+		}
+	}
+	ctry_flag = calloc(NUM_FAO_CTRY, sizeof(int));
+	if(ctry_flag == NULL) {
+		fprintf(fplog,"Failed to allocate memory for ctry_flag:  set_region_subset()\n");
+		free(code2ctry);
+		return ERROR_MEM;
+	}
+
+	// select the countries for each code
+	strcpy(codes, sep + 1);
+	for (tok = strtok(codes, ","); tok != NULL; tok = strtok(NULL, ",")) {
+		found = 0;
+		if (subset_type == 1) {
+			for (i = 0; i < NUM_FAO_CTRY; i++) {
+				if (strlen(countryabbrs_iso[i]) == strlen(tok)) {
+					for (j = 0; tok[j] != '\0' && tolower(tok[j]) == tolower(countryabbrs_iso[i][j]); j++) {
+					}
+					if (tok[j] == '\0') {
+						ctry_flag[i] = 1;
+						found++;
+					}
+				}
+			}
+		} else if (subset_type == 2) {
+			code = atoi(tok);
+			for (i = 0; i < NUM_FAO_CTRY; i++) {
+				if (ctry2regioncodes_gcam[i] == code) {
+					ctry_flag[i] = 1;
+					found++;
+				}
+			}
+		} else {
+			code = atoi(tok);
+			for (i = 0; i < NUM_CELLS; i++) {
+				if (aez_bounds_new[i] == code) {
+					ctry_code = (int) country_fao[i];
+					if (ctry_code != raster_info->country_fao_nodata && ctry_code >= 0 && ctry_code <= max_code &&
+						code2ctry[ctry_code] != NOMATCH) {
+						if (ctry_flag[code2ctry[ctry_code]] == 0) {
+							ctry_flag[code2ctry[ctry_code]] = 1;
+							found++;
+						}
+					}
+				}
+			}
+		}
+		if (found == 0) {
+			fprintf(fplog, "Warning: region_subset code %s does not select any new country: set_region_subset()\n", tok);
+		}
+	} // end for loop over the codes
+
+	// close the selection over the groups of countries that are processed together:
+	//    the land rent regions, which scale the land rent to their totals
+	//    and serbia and montenegro, which are merged in processing
+	// repeat until no country is added, because the two kinds of group can overlap
+	do {
+		found = 0;
+		for (i = 0; i < NUM_FAO_CTRY; i++) {
+			if (ctry_flag[i] == 0 || ctry2ctry87codes_gtap[i] == NOMATCH) {
+				continue;
+			}
+			for (j = 0; j < NUM_FAO_CTRY; j++) {
+				if (ctry_flag[j] == 0 && ctry2ctry87codes_gtap[j] == ctry2ctry87codes_gtap[i]) {
+					ctry_flag[j] = 1;
+					found++;
+				}
+			}
+		}
+		merge_scg = 0;
+		for (i = 0; i < 3; i++) {
+			ctry_code = scg_codes[i];
+			if (ctry_code <= max_code && code2ctry[ctry_code] != NOMATCH && ctry_flag[code2ctry[ctry_code]]) {
+				merge_scg = 1;
+			}
+		}
+		for (i = 0; i < 3 && merge_scg; i++) {
+			ctry_code = scg_codes[i];
+			if (ctry_code <= max_code && code2ctry[ctry_code] != NOMATCH && ctry_flag[code2ctry[ctry_code]] == 0) {
+				ctry_flag[code2ctry[ctry_code]] = 1;
+				found++;
+			}
+		}
+	} while (found > 0);
+
+	for (i = 0; i < NUM_FAO_CTRY; i++) {
+		num_ctry = num_ctry + ctry_flag[i];
+	}
+	if (num_ctry == 0) {
+		fprintf(fplog, "Error: region_subset %s does not select any country: set_region_subset()\n", in_args.region_subset);
+		free(code2ctry);
+		free(ctry_flag);
+		return ERROR_USAGE;
+	}
+
+	// remove the glu from the cells outside the subset, and get the subset bounding box
+	raster_info->subset_row_min = NUM_LAT;
+	raster_info->subset_row_max = -1;
+	raster_info->subset_col_min = NUM_LON;
+	raster_info->subset_col_max = -1;
+	for (i = 0; i < NUM_CELLS; i++) {
+		if (aez_bounds_new[i] == raster_info->aez_new_nodata) {
+			continue;
+		}
+		ctry_code = (int) country_fao[i];
+		if (ctry_code == raster_info->country_fao_nodata || ctry_code < 0 || ctry_code > max_code ||
+			code2ctry[ctry_code] == NOMATCH || ctry_flag[code2ctry[ctry_code]] == 0) {
+			aez_bounds_new[i] = raster_info->aez_new_nodata;
+			continue;
+		}
+		num_cells++;
+		row = i / NUM_LON;
+		col = i % NUM_LON;
+		if (row < raster_info->subset_row_min) {
+			raster_info->subset_row_min = row;
+		}
+		if (row > raster_info->subset_row_max) {
+			raster_info->subset_row_max = row;
+		}
+		if (col < raster_info->subset_col_min) {
+			raster_info->subset_col_min = col;
+		}
+		if (col > raster_info->subset_col_max) {
+			raster_info->subset_col_max = col;
+		}
+	} // end for i loop over the working grid
+
+	free(code2ctry);
+	free(ctry_flag);
+
+	if (num_cells == 0) {
+		fprintf(fplog, "Error: region_subset %s has no glu land cells: set_region_subset()\n", in_args.region_subset);
+		return ERROR_USAGE;
+	}
+
+	raster_info->subset = 1;
+
+	fprintf(fplog, "\nRegion subset %s: %i countries, %i glu cells, rows %i-%i, columns %i-%i\n", in_args.region_subset,
+			num_ctry, num_cells, raster_info->subset_row_min, raster_info->subset_row_max,
+			raster_info->subset_col_min, raster_info->subset_col_max);
+
+	return OK;}
@@ -0,0 +1,350 @@
+/**********
+ stage_profile.c
+
+ record run time and resource use for each stage of the moirai_main() pipeline
+    and write them as a json report next to the log file
+
+ each stage is bracketed in moirai_main() by start_stage() and end_stage()
+ for each stage this records:
+    wall time (s), cpu time of this process (user and system, s), cpu time of waited-for child processes (unzip/gunzip, s)
+    bytes read and written by this process (from /proc/self/io; logical bytes, including page cache hits)
+    resident set size at the start and end of the stage and the high-water mark during the stage (kB)
+ the rss high-water mark is reset at the start of each stage via /proc/self/clear_refs (linux >= 4.0)
+    if the reset is not available the reported high-water mark is the process high-water mark up to the end of the stage
+ the i/o and memory values are -1 if /proc is not available
+ readers that time their own reads (the netcdf readers, see nc_access.c) add them to the stage with add_stage_reads()
+    the report lists the reads, bytes, read time, and throughput of each of these readers in the stage
+
+ the report also has the number of working grid cells and hyde years of the run, for throughput (see make bench)
+    they are set by set_grid_geometry() and set_hyde_years() before the first stage
+ the report is rewritten at the end of each stage so that it is available for failed runs
+ the report name is the log file name with the extension replaced by STAGE_PROF_SUFFIX
+
+ functions:
+ init_stage_profile():	set the report file name and start the run clock
+ start_stage():			take the starting snapshot for the named stage
+ end_stage():			take the ending snapshot for the current stage and rewrite the report
+ add_stage_reads():		add the reads of a reader to the current stage
+ write_stage_profile():	write the report; the status is "complete" if run_complete = 1, otherwise "running"
+
+ arguments:
+ args_struct in_args:	the input argument structure
+ const char *stage_name:	name of the stage; normally the name of the function called
+ int run_complete:		1 = the whole pipeline has finished; 0 = it is still running or has failed
+ const char *reader:	name of the reading function
+ long long bytes:		bytes read
+ double read_sec:		wall time of the read (s)
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+ 
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+ 
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+ 
+ This file is part of Moirai.
+ 
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "moirai.h"
+#include <sys/time.h>
+#include <sys/resource.h>
+
+// starting snapshot of the current stage
+static int stage_open = 0;
+static double run_start_wall;
+static char run_start_time[MAXCHAR];
+static char prof_fname[MAXCHAR];
+static double start_wall;
+static double start_user;
+static double start_sys;
+static double start_child;
+static long long start_rchar;
+static long long start_wchar;
+static long start_rss_kb;
+
+// wall clock, seconds
+static double get_wall_sec(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + (double) ts.tv_nsec / 1.0e9;
+}
+
+// cpu time of this process and of its waited-for children, seconds
+static void get_cpu_sec(double *user_sec, double *sys_sec, double *child_sec) {
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	*user_sec = (double) ru.ru_utime.tv_sec + (double) ru.ru_utime.tv_usec / 1.0e6;
+	*sys_sec = (double) ru.ru_stime.tv_sec + (double) ru.ru_stime.tv_usec / 1.0e6;
+	getrusage(RUSAGE_CHILDREN, &ru);
+	*child_sec = (double) ru.ru_utime.tv_sec + (double) ru.ru_utime.tv_usec / 1.0e6 +
+		(double) ru.ru_stime.tv_sec + (double) ru.ru_stime.tv_usec / 1.0e6;
+}
+
+// logical bytes read and written by this process; -1 if not available
+static void get_io_bytes(long long *rchar, long long *wchar) {
+	FILE *fpio;
+	char line[MAXCHAR];
+	*rchar = -1;
+	*wchar = -1;
+	if ((fpio = fopen("/proc/self/io", "r")) == NULL) {
+		return;
+	}
+	while (fgets(line, MAXCHAR, fpio) != NULL) {
+		if (strncmp(line, "rchar:", 6) == 0) {
+			*rchar = atoll(&line[6]);
+		} else if (strncmp(line, "wchar:", 6) == 0) {
+			*wchar = atoll(&line[6]);
+		}
+	}
+	fclose(fpio);
+}
+
+// current and high-water resident set size, kB; -1 if not available
+static void get_rss_kb(long *rss_kb, long *hwm_kb) {
+	FILE *fpstat;
+	char line[MAXCHAR];
+	*rss_kb = -1;
+	*hwm_kb = -1;
+	if ((fpstat = fopen("/proc/self/status", "r")) == NULL) {
+		return;
+	}
+	while (fgets(line, MAXCHAR, fpstat) != NULL) {
+		if (strncmp(line, "VmRSS:", 6) == 0) {
+			*rss_kb = atol(&line[6]);
+		} else if (strncmp(line, "VmHWM:", 6) == 0) {
+			*hwm_kb = atol(&line[6]);
+		}
+	}
+	fclose(fpstat);
+}
+
+// reset the rss high-water mark to the current rss; returns 1 if the reset worked
+static int reset_rss_hwm(void) {
+	FILE *fpref;
+	if ((fpref = fopen("/proc/self/clear_refs", "w")) == NULL) {
+		return 0;
+	}
+	if (fputs("5", fpref) == EOF) {
+		fclose(fpref);
+		return 0;
+	}
+	if (fclose(fpref) != 0) {
+		return 0;
+	}
+	return 1;
+}
+
+int init_stage_profile(args_struct in_args) {
+
+	char *dot;
+
+	num_prof_stages = 0;
+	stage_open = 0;
+	run_start_wall = get_wall_sec();
+	strcpy(run_start_time, get_systime());
+	// get_systime() ends with a newline
+	run_start_time[strcspn(run_start_time, "\r\n")] = '\0';
+
+	// the report goes next to the log file
+	strcpy(prof_fname, in_args.outpath);
+	strcat(prof_fname, in_args.lds_logname);
+	dot = strrchr(prof_fname, '.');
+	if (dot != NULL && strchr(dot, '/') == NULL) {
+		*dot = '\0';
+	}
+	strcat(prof_fname, STAGE_PROF_SUFFIX);
+
+	return OK;}
+
+int start_stage(const char *stage_name) {
+
+	long hwm_kb;
+
+	if (stage_open) {
+		fprintf(fplog, "Warning: stage %s started before stage %s ended; the open stage is ended here: start_stage()\n",
+				stage_name, stage_prof[num_prof_stages].name);
+		end_stage();
+	}
+	if (num_prof_stages >= MAX_PROF_STAGES) {
+		fprintf(fplog, "Warning: more than %i profiled stages; %s is not profiled: start_stage()\n", MAX_PROF_STAGES, stage_name);
+		return OK;
+	}
+
+	memset(stage_prof[num_prof_stages].name, '\0', MAX_PROF_NAME);
+	strncpy(stage_prof[num_prof_stages].name, stage_name, MAX_PROF_NAME - 1);
+	stage_prof[num_prof_stages].hwm_reset = reset_rss_hwm();
+	stage_prof[num_prof_stages].num_readers = 0;
+	get_rss_kb(&start_rss_kb, &hwm_kb);
+	get_io_bytes(&start_rchar, &start_wchar);
+	get_cpu_sec(&start_user, &start_sys, &start_child);
+	start_wall = get_wall_sec();
+	stage_open = 1;
+	trace_begin("stage", "%s", stage_name);
+
+	return OK;}
+
+int end_stage(void) {
+
+	double end_wall;
+	double end_user, end_sys, end_child;
+	long long end_rchar, end_wchar;
+	long end_rss_kb, hwm_kb;
+	stage_prof_struct *sp;
+
+	if (!stage_open) {
+		return OK;
+	}
+
+	end_wall = get_wall_sec();
+	trace_end();
+	get_cpu_sec(&end_user, &end_sys, &end_child);
+	get_io_bytes(&end_rchar, &end_wchar);
+	get_rss_kb(&end_rss_kb, &hwm_kb);
+
+	sp = &stage_prof[num_prof_stages];
+	sp->start_sec = start_wall - run_start_wall;
+	sp->wall_sec = end_wall - start_wall;
+	sp->user_sec = end_user - start_user;
+	sp->sys_sec = end_sys - start_sys;
+	sp->child_sec = end_child - start_child;
+	if (start_rchar >= 0 && end_rchar >= 0) {
+		sp->bytes_read = end_rchar - start_rchar;
+		sp->bytes_written = end_wchar - start_wchar;
+	} else {
+		sp->bytes_read = -1;
+		sp->bytes_written = -1;
+	}
+	sp->rss_start_kb = start_rss_kb;
+	sp->rss_end_kb = end_rss_kb;
+	sp->rss_hwm_kb = hwm_kb;
+
+	num_prof_stages++;
+	stage_open = 0;
+
+	return write_stage_profile(0);}
+
+int add_stage_reads(const char *reader, long long bytes, double read_sec) {
+
+	int i;
+	stage_prof_struct *sp;
+
+	if (!stage_open) {
+		return OK;
+	}
+	sp = &stage_prof[num_prof_stages];
+	for (i = 0; i < sp->num_readers; i++) {
+		if (strcmp(sp->readers[i].name, reader) == 0) {
+			break;
+		}
+	}
+	if (i == sp->num_readers) {
+		if (sp->num_readers == MAX_PROF_READERS) {
+			return OK;
+		}
+		memset(sp->readers[i].name, '\0', MAX_PROF_NAME);
+		strncpy(sp->readers[i].name, reader, MAX_PROF_NAME - 1);
+		sp->readers[i].num_reads = 0;
+		sp->readers[i].bytes = 0;
+		sp->readers[i].read_sec = 0;
+		sp->num_readers++;
+	}
+	sp->readers[i].num_reads++;
+	sp->readers[i].bytes += bytes;
+	sp->readers[i].read_sec += read_sec;
+
+	return OK;}
+
+int write_stage_profile(int run_complete) {
+
+	int i, j;
+	double total_wall;
+	double user_sec, sys_sec, child_sec;
+	double mb_read_per_sec;
+	long rss_kb, hwm_kb;
+	long peak_rss_kb;
+	FILE *fpout;
+	stage_prof_struct *sp;
+
+	if (prof_fname[0] == '\0') {
+		return OK;
+	}
+
+	if ((fpout = fopen(prof_fname, "w")) == NULL) {
+		fprintf(fplog, "Failed to open file %s: write_stage_profile()\n", prof_fname);
+		return ERROR_FILE;
+	}
+
+	total_wall = get_wall_sec() - run_start_wall;
+	get_cpu_sec(&user_sec, &sys_sec, &child_sec);
+	get_rss_kb(&rss_kb, &hwm_kb);
+	// the per-stage resets also reset the process high-water mark, so the run peak is the max over the stages
+	peak_rss_kb = hwm_kb;
+	for (i = 0; i < num_prof_stages; i++) {
+		if (stage_prof[i].rss_hwm_kb > peak_rss_kb) {
+			peak_rss_kb = stage_prof[i].rss_hwm_kb;
+		}
+	}
+
+	fprintf(fpout, "{\n");
+	fprintf(fpout, "  \"program\": \"%s\",\n", CODENAME);
+	fprintf(fpout, "  \"version\": \"%s\",\n", VERSION);
+	fprintf(fpout, "  \"started\": \"%s\",\n", run_start_time);
+	fprintf(fpout, "  \"status\": \"%s\",\n", run_complete ? "complete" : "running");
+	fprintf(fpout, "  \"num_stages\": %i,\n", num_prof_stages);
+	fprintf(fpout, "  \"total_wall_sec\": %.6f,\n", total_wall);
+	fprintf(fpout, "  \"total_user_sec\": %.6f,\n", user_sec);
+	fprintf(fpout, "  \"total_sys_sec\": %.6f,\n", sys_sec);
+	fprintf(fpout, "  \"total_child_sec\": %.6f,\n", child_sec);
+	fprintf(fpout, "  \"peak_rss_kb\": %ld,\n", peak_rss_kb);
+	fprintf(fpout, "  \"num_cells\": %i,\n", NUM_CELLS);
+	fprintf(fpout, "  \"num_hyde_years\": %i,\n", num_hyde_years);
+	fprintf(fpout, "  \"stages\": [\n");
+	for (i = 0; i < num_prof_stages; i++) {
+		sp = &stage_prof[i];
+		if (sp->wall_sec > 0 && sp->bytes_read >= 0) {
+			mb_read_per_sec = sp->bytes_read / 1.0e6 / sp->wall_sec;
+		} else {
+			mb_read_per_sec = 0;
+		}
+		fprintf(fpout, "    {\"name\": \"%s\", \"start_sec\": %.6f, \"wall_sec\": %.6f, \"cpu_sec\": %.6f, "
+				"\"user_sec\": %.6f, \"sys_sec\": %.6f, \"child_sec\": %.6f, "
+				"\"bytes_read\": %lld, \"bytes_written\": %lld, \"read_mb_per_sec\": %.3f, "
+				"\"rss_start_kb\": %ld, \"rss_end_kb\": %ld, \"rss_hwm_kb\": %ld, \"hwm_reset\": %s, \"readers\": [",
+				sp->name, sp->start_sec, sp->wall_sec, sp->user_sec + sp->sys_sec,
+				sp->user_sec, sp->sys_sec, sp->child_sec,
+				sp->bytes_read, sp->bytes_written, mb_read_per_sec,
+				sp->rss_start_kb, sp->rss_end_kb, sp->rss_hwm_kb, sp->hwm_reset ? "true" : "false");
+		for (j = 0; j < sp->num_readers; j++) {
+			fprintf(fpout, "%s{\"name\": \"%s\", \"reads\": %i, \"bytes\": %lld, \"read_sec\": %.6f, \"mb_per_sec\": %.3f}",
+					(j > 0) ? ", " : "", sp->readers[j].name, sp->readers[j].num_reads, sp->readers[j].bytes,
+					sp->readers[j].read_sec,
+					(sp->readers[j].read_sec > 0) ? sp->readers[j].bytes / 1.0e6 / sp->readers[j].read_sec : 0);
+		}
+		fprintf(fpout, "]}%s\n", (i < num_prof_stages - 1) ? "," : "");
+	}
+	fprintf(fpout, "  ]\n");
+	fprintf(fpout, "}\n");
+
+	fclose(fpout);
+
+	return OK;}
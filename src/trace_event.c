@@ -0,0 +1,176 @@
+/**********
+ trace_event.c
+
+ write an optional timeline of the run in the chrome Trace Event Format (json array format)
+    this can be loaded into chrome://tracing, ui.perfetto.dev, or other trace viewers
+
+ spans are nested on each thread: stage -> year or crop -> i/o call
+    stage spans are opened and closed by start_stage() and end_stage() in stage_profile.c
+    year spans are in proc_land_type_area(); crop spans are in calc_harvarea_prod_out_crop_aez(), proc_mirca(), and proc_water_footprint()
+    i/o spans wrap the raster reader calls and each nc_get_vara_float() call
+ each span is written as a single complete ("X") event when it ends
+    so spans from different threads do not interleave within a line
+    each thread keeps its own span stack and gets its own trace thread id on first use
+    a span that is not ended (e.g. due to an error return) is not written
+ the json array format does not require the closing bracket, so the file is readable even if the run fails
+
+ no trace is written if trace_fname is NONE_TEXT; in this case the functions return immediately
+
+ functions:
+ init_trace():		open the trace file (in the output directory) and write the metadata
+ trace_begin():		open a span on the calling thread; the span name is a printf format and arguments
+ trace_end():		close the most recently opened span on the calling thread and write it
+ close_trace():		write the closing bracket and close the trace file; this is registered with atexit()
+
+ arguments:
+ args_struct in_args:	the input argument structure
+ const char *cat:		span category: "stage", "year", "crop", or "io"
+ const char *fmt:		printf format for the span name, followed by its arguments
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+ 
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+ 
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+ 
+ This file is part of Moirai.
+ 
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "moirai.h"
+#include <stdarg.h>
+#include <stdatomic.h>
+
+#define MAX_TRACE_DEPTH		32			// maximum span nesting depth per thread
+#define MAX_TRACE_NAME		200			// maximum length of a span name
+
+static FILE *fptrace = NULL;			// trace file; NULL = tracing is off
+static double trace_start_us;			// monotonic clock at init_trace(), microseconds
+static atomic_int next_trace_tid = 1;	// next trace thread id to assign
+static int atexit_set = 0;				// 1 = close_trace() is registered with atexit()
+
+// per-thread span stack
+static _Thread_local int trace_tid = 0;
+static _Thread_local int trace_depth = 0;
+static _Thread_local double span_start_us[MAX_TRACE_DEPTH];
+static _Thread_local char span_cat[MAX_TRACE_DEPTH][MAX_PROF_NAME];
+static _Thread_local char span_name[MAX_TRACE_DEPTH][MAX_TRACE_NAME];
+
+// monotonic clock, microseconds
+static double get_trace_us(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec * 1.0e6 + (double) ts.tv_nsec / 1.0e3;
+}
+
+// assign a trace thread id to the calling thread on first use and name it in the trace
+static void set_trace_tid(void) {
+	if (trace_tid == 0) {
+		trace_tid = atomic_fetch_add(&next_trace_tid, 1);
+		fprintf(fptrace, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %i, \"args\": {\"name\": \"%s %i\"}},\n",
+				trace_tid, (trace_tid == 1) ? "main" : "worker", trace_tid);
+	}
+}
+
+void close_trace(void) {
+	if (fptrace != NULL) {
+		// the final metadata record avoids a trailing comma before the closing bracket
+		fprintf(fptrace, "{\"name\": \"trace_end\", \"ph\": \"i\", \"s\": \"g\", \"pid\": 1, \"tid\": %i, \"ts\": %.3f}\n]\n",
+				(trace_tid == 0) ? 1 : trace_tid, get_trace_us() - trace_start_us);
+		fclose(fptrace);
+		fptrace = NULL;
+	}
+}
+
+int init_trace(args_struct in_args) {
+
+	char fname[MAXCHAR];
+
+	if (in_args.trace_fname[0] == '\0' || strcmp(in_args.trace_fname, NONE_TEXT) == 0) {
+		return OK;
+	}
+
+	strcpy(fname, in_args.outpath);
+	strcat(fname, in_args.trace_fname);
+	if ((fptrace = fopen(fname, "w")) == NULL) {
+		fprintf(fplog, "Failed to open file %s: init_trace()\n", fname);
+		return ERROR_FILE;
+	}
+
+	trace_start_us = get_trace_us();
+	fprintf(fptrace, "[\n");
+	fprintf(fptrace, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"%s %s\"}},\n", CODENAME, VERSION);
+	set_trace_tid();
+
+	// make sure that the trace is closed even if the run ends early
+	// register it once, for a process with several runs (see moirai_ctx.c)
+	if (!atexit_set) {
+		atexit(close_trace);
+		atexit_set = 1;
+	}
+
+	return OK;}
+
+int trace_begin(const char *cat, const char *fmt, ...) {
+
+	va_list ap;
+
+	if (fptrace == NULL) {
+		return OK;
+	}
+	set_trace_tid();
+	if (trace_depth >= MAX_TRACE_DEPTH) {
+		// too deep: count it so that the matching trace_end() is ignored
+		trace_depth++;
+		return OK;
+	}
+
+	va_start(ap, fmt);
+	vsnprintf(span_name[trace_depth], MAX_TRACE_NAME, fmt, ap);
+	va_end(ap);
+	strncpy(span_cat[trace_depth], cat, MAX_PROF_NAME - 1);
+	span_cat[trace_depth][MAX_PROF_NAME - 1] = '\0';
+	span_start_us[trace_depth] = get_trace_us();
+	trace_depth++;
+
+	return OK;}
+
+int trace_end(void) {
+
+	double end_us;
+
+	if (fptrace == NULL || trace_depth == 0) {
+		return OK;
+	}
+	trace_depth--;
+	if (trace_depth >= MAX_TRACE_DEPTH) {
+		return OK;
+	}
+
+	end_us = get_trace_us();
+	// one fprintf per event so that events from different threads do not interleave
+	fprintf(fptrace, "{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %i, \"ts\": %.3f, \"dur\": %.3f},\n",
+			span_name[trace_depth], span_cat[trace_depth], trace_tid,
+			span_start_us[trace_depth] - trace_start_us, end_us - span_start_us[trace_depth]);
+
+	return OK;}
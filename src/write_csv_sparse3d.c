@@ -0,0 +1,91 @@
+/**********
+ write_csv_sparse3d.c
+
+ write a long format csv text file from a 3d float array that is sparse in its 2nd (glu) dimension
+
+ arguments:
+ float ***out_array:	array to write; dim1=d1[d1_length], dim2=glu[d2_num[dim1]], dim3=d3[d3_length]
+ int d1[]:				array of numeric codes to write for the first dimension
+ int d1_length:			length of dimension 1
+ int d2_num[]:			number of glus for each first dimension category
+ int **d2_list:			glu codes for each first dimension category (e.g. ctry_aez_list)
+ int d3[]:				array of numeric codes to write for the third dimension
+ int d3_length:			length of dimension 3
+ float scale:			factor applied to the values on output (e.g. MIL2ONE); 1 = no scaling
+ char *out_name:		name of output file
+ args_struct in_args:	the input argument structure
+
+ the output is organized as follows:
+	each row is a single non-zero value: d1 code, glu code, d3 code, value
+	the third dimension varies fastest, then the glu, then the first dimension
+	zero values are not written, so the file size scales with the actual country/region X glu pairs
+
+ only two decimal points are output
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+ 
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+ 
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+ 
+ This file is part of Moirai.
+ 
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#include "moirai.h"
+
+int write_csv_sparse3d(float ***out_array, int d1[], int d1_length, int d2_num[], int **d2_list, int d3[], int d3_length,
+					   float scale, char *out_name, args_struct in_args) {
+
+	int i,j,k;
+	char fname[MAXCHAR];			// file name to open
+	FILE *fpout;					// file pointer
+	int nrecords = 0;				// the number of records written
+	float out_val;					// the scaled value to write
+
+	// create file name and open it
+	strcpy(fname, in_args.outpath);
+	strcat(fname, out_name);
+
+	if((fpout = fopen(fname, "w")) == NULL)
+	{
+		fprintf(fplog,"Failed to open file %s: write_csv_sparse3d()\n", fname);
+		return ERROR_FILE;
+	}
+
+	for (i = 0; i < d1_length; i++) {
+		for (j = 0; j < d2_num[i]; j++) {
+			for (k = 0; k < d3_length; k++) {
+				if (out_array[i][j][k] != 0) {
+					out_val = scale * out_array[i][j][k];
+					fprintf(fpout,"%i,%i,%i,%.2f\n", d1[i], d2_list[i][j], d3[k], out_val);
+					nrecords++;
+				}
+			}
+		}
+	}
+
+	if (fclose(fpout) != 0) {
+		fprintf(fplog, "Error writing file %s: write_csv_sparse3d(); records written=%i\n", fname, nrecords);
+		return ERROR_FILE;
+	}
+
+	return OK;}
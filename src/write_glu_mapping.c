@@ -25,6 +25,18 @@
  land use code: 0=unmanaged, 10=cropland, 20=pasture, 30=urbanland (crop, pasture, and urban are set in moirai.h)
  protected code: 0 to 7, see read_protected
  corresponds with the land type area and potveg carbon output csv files
+
+ also find the reference veg carbon keys: the country X glu X land type categories that occur in the valid hyde land cells
+    they are stored in refveg_carbon_tally (see lt_tally.c), so the carbon arrays are allocated and written for these only
+ 
+ the glu lists are built with a hash set of (region, glu) pairs and grown by doubling, so this is linear in the land cells
+    and does not depend on the number of glus; the lists keep the order in which the glus are found until they are sorted
+ 
+ also make the glu index maps used by the land rent and aggregation stages, after the lists are sorted:
+ ctry2reglr_ind and ctry2reggcam_ind: the land rent region and gcam region index of each fao country
+ ctry87_code2ind: the land rent region index of each land rent region code, also for the forest cells in calc_rent_frs_use_aez()
+ ctry_aez_reglr_ind and ctry_aez_reggcam_ind: the index of each country glu in the glu list of its land rent region and gcam region
+ aez_code2ind_new: the index of each glu code in aez_codes_new
  
  write only as a diagnostic:
  MOIRAI_reglr_GLU.csv    // file name for diagnostic gcam reglr+gluid to lr region abbr mapping
@@ -81,6 +93,183 @@
 
 #include "moirai.h"
 
+// open addressing hash set of (region index, glu code) pairs, with the index of the glu in the region list
+typedef struct {
+   long long *keys;    // region index * 2^32 + glu code; -1 = empty bucket
+   int *vals;          // index of the glu in the region list
+   int bits;           // number of buckets = 2^bits
+   int num;            // number of pairs stored
+} glu_set_struct;
+
+static int glu_set_init(glu_set_struct *set, int bits) {
+   int i;
+   set->bits = bits;
+   set->num = 0;
+   set->keys = malloc(((size_t) 1 << bits) * sizeof(long long));
+   set->vals = malloc(((size_t) 1 << bits) * sizeof(int));
+   if (set->keys == NULL || set->vals == NULL) {
+      free(set->keys);
+      free(set->vals);
+      return ERROR_MEM;
+   }
+   for (i = 0; i < (1 << bits); i++) {
+      set->keys[i] = -1;
+   }
+   return OK;}
+
+static void glu_set_free(glu_set_struct *set) {
+   free(set->keys);
+   free(set->vals);
+}
+
+// bucket of the key, or of the empty bucket where it goes
+static int glu_set_bucket(glu_set_struct *set, long long key) {
+   int mask = (1 << set->bits) - 1;
+   int b = (int) (((unsigned long long) key * 0x9E3779B97F4A7C15ULL) >> (64 - set->bits));
+   while (set->keys[b] != -1 && set->keys[b] != key) {
+      b = (b + 1) & mask;
+   }
+   return b;
+}
+
+// the index of the glu in the region list; NOMATCH if the glu is not in the region yet
+static int glu_set_find(glu_set_struct *set, int region, int glu) {
+   long long key = ((long long) region << 32) | (unsigned int) glu;
+   int b = glu_set_bucket(set, key);
+   return (set->keys[b] == -1) ? NOMATCH : set->vals[b];
+}
+
+// store a new glu of the region; the set is doubled when half full
+static int glu_set_add(glu_set_struct *set, int region, int glu, int val) {
+   long long key = ((long long) region << 32) | (unsigned int) glu;
+   glu_set_struct bigger;
+   int i, b;
+   
+   if (2 * (set->num + 1) > (1 << set->bits)) {
+      if (glu_set_init(&bigger, set->bits + 1) != OK) {
+         return ERROR_MEM;
+      }
+      for (i = 0; i < (1 << set->bits); i++) {
+         if (set->keys[i] != -1) {
+            b = glu_set_bucket(&bigger, set->keys[i]);
+            bigger.keys[b] = set->keys[i];
+            bigger.vals[b] = set->vals[i];
+         }
+      }
+      bigger.num = set->num;
+      glu_set_free(set);
+      *set = bigger;
+   }
+   b = glu_set_bucket(set, key);
+   set->keys[b] = key;
+   set->vals[b] = val;
+   set->num++;
+   return OK;}
+
+// append a glu to a region list, doubling its allocation when it is full
+static int append_glu(int **list, int *num, int *cap, int glu) {
+   int *temp_list;
+   if (*num == *cap) {
+      temp_list = realloc(*list, 2 * (*cap) * sizeof(int));
+      if (temp_list == NULL) {
+         return ERROR_MEM;
+      }
+      *list = temp_list;
+      *cap = 2 * (*cap);
+   }
+   (*list)[(*num)++] = glu;
+   return OK;}
+
+static int compare_glu(const void *a, const void *b) {
+   int x = *(const int *) a;
+   int y = *(const int *) b;
+   return (x > y) - (x < y);
+}
+
+// add the reference veg carbon keys of the country glus to refveg_carbon_tally
+// these are the reference veg type of each valid hyde land cell with each protected category, in unmanaged land
+//    with the same cells and serbia and montenegro merge as read_soil_carbon() and proc_refveg_carbon()
+static int add_refveg_carbon_keys(rinfo_struct raster_info, const int *ctry_code2ind, int max_ctry_code, int scg_ind) {
+   int i, k;
+   int grid_ind;       // working grid index of the current cell
+   int ctry_code;      // fao country code
+   int ctry_ind;       // fao country index
+   int aez_val;        // glu value
+   int *aez_ptr;       // the glu in the sorted country glu list
+   int rv_value;       // reference veg value; 0 = unknown
+   int *rv_lt_ind;     // lt_cats index of each reference veg value X protected category, in unmanaged land
+   int slot;           // tally slot of the key
+   int err = OK;
+   
+   int srb_code = 272;         // fao code for serbia
+   int mne_code = 273;         // fao code for montenegro
+   
+   rv_lt_ind = malloc((NUM_SAGE_PVLT + 1) * NUM_EPA_PROTECTED * sizeof(int));
+   if(rv_lt_ind == NULL) {
+      fprintf(fplog,"Failed to allocate memory for rv_lt_ind:  write_glu_mapping()\n");
+      return ERROR_MEM;
+   }
+   for (i = 0; i < (NUM_SAGE_PVLT + 1) * NUM_EPA_PROTECTED; i++) {
+      rv_lt_ind[i] = NOMATCH;
+      for (k = 0; k < num_lt_cats; k++) {
+         if (lt_cats[k] == (i / NUM_EPA_PROTECTED) * SCALE_POTVEG + i % NUM_EPA_PROTECTED) {
+            rv_lt_ind[i] = k;
+            break;
+         }
+      }
+   }
+   
+   if ((err = init_lt_tally(&refveg_carbon_tally, ctry_aez_num)) != OK) {
+      free(rv_lt_ind);
+      return err;
+   }
+   for (i = 0; i < num_land_cells_hyde; i++) {
+      grid_ind = land_cells_hyde[i];
+      aez_val = aez_bounds_new[grid_ind];
+      ctry_code = country_fao[grid_ind];
+      if (aez_val == raster_info.aez_new_nodata) {
+         continue;
+      }
+      if (ctry_code == mne_code || ctry_code == srb_code) {
+         ctry_ind = scg_ind;
+      } else {
+         ctry_ind = (ctry_code >= 0 && ctry_code <= max_ctry_code) ? ctry_code2ind[ctry_code] : NOMATCH;
+      }
+      if (ctry_ind == NOMATCH || ctry2ctry87codes_gtap[ctry_ind] == NOMATCH) {
+         continue;
+      }
+      // a cell glu that is not in the country list is reported by the carbon stages
+      aez_ptr = bsearch(&aez_val, ctry_aez_list[ctry_ind], ctry_aez_num[ctry_ind], sizeof(int), compare_glu);
+      if (aez_ptr == NULL) {
+         continue;
+      }
+      rv_value = 0;
+      for (k = 0; k < NUM_SAGE_PVLT; k++) {
+         if (refvegcarbon_thematic[grid_ind] == landtypecodes_sage[k]) {
+            rv_value = refvegcarbon_thematic[grid_ind];
+            break;
+         }
+      }
+      // an unmatched land type category is reported by the carbon stages
+      if (rv_value < 0 || rv_value > NUM_SAGE_PVLT) {
+         continue;
+      }
+      for (k = 0; k < NUM_EPA_PROTECTED; k++) {
+         if (rv_lt_ind[rv_value * NUM_EPA_PROTECTED + k] != NOMATCH &&
+             (err = add_lt_tally_key(&refveg_carbon_tally, ctry_ind, (int) (aez_ptr - ctry_aez_list[ctry_ind]),
+                                     rv_lt_ind[rv_value * NUM_EPA_PROTECTED + k], &slot)) != OK) {
+            free(rv_lt_ind);
+            return err;
+         }
+      }
+   } // end for i loop over the hyde land cells
+   free(rv_lt_ind);
+   
+   fprintf(fplog, "Reference veg carbon keys: %i of %i country X glu X land type combinations: write_glu_mapping()\n",
+           refveg_carbon_tally.num_slots, refveg_carbon_tally.num_pairs * num_lt_cats);
+   
+   return OK;}
+
 int write_glu_mapping(args_struct in_args, rinfo_struct raster_info) {
    
    int i,j,k;
@@ -92,8 +281,17 @@ int write_glu_mapping(args_struct in_args, rinfo_struct raster_info) {
    int reggcam_ind;    // gcam region index
    int aez_val;		// new aez value
    int cur_lt_cat_ind; // for creating the land type category array
-   
-   int temp_vals[NUM_NEW_AEZ];	// temp storage for the aezs and region indices
+   int *glu_slot;      // index of each glu (by aez_codes_new index) in the list of the current region
+   int *ctry_code2ind; // fao country index of each fao country code
+   int max_ctry_code;  // largest fao country code
+   int scg_ind;        // fao country index of serbia and montenegro
+   int *ctry_aez_cap;  // allocated length of each country glu list
+   int *reglr_aez_cap; // allocated length of each land rent region glu list
+   int *reggcam_aez_cap; // allocated length of each gcam region glu list
+   glu_set_struct ctry_set;    // the glus stored for each country
+   glu_set_struct reglr_set;   // the glus stored for each land rent region
+   glu_set_struct reggcam_set; // the glus stored for each gcam region
+   int err = OK;       // error code for the hash sets
    
    int scg_code = 186;         // fao code for serbia and montenegro
    int srb_code = 272;         // fao code for serbia
@@ -227,18 +425,123 @@ int write_glu_mapping(args_struct in_args, rinfo_struct raster_info) {
    
    fclose(fpout1);
    
+   // map the glu codes to their index in aez_codes_new, for the glu names here and for the later stages
+   max_aez_code_new = 0;
+   for (k = 0; k < NUM_NEW_AEZ; k++) {
+      if (aez_codes_new[k] > max_aez_code_new) {
+         max_aez_code_new = aez_codes_new[k];
+      }
+   }
+   aez_code2ind_new = malloc((max_aez_code_new + 1) * sizeof(int));
+   if(aez_code2ind_new == NULL) {
+      fprintf(fplog,"Failed to allocate memory for aez_code2ind_new:  write_glu_mapping()\n");
+      return ERROR_MEM;
+   }
+   for (i = 0; i <= max_aez_code_new; i++) {
+      aez_code2ind_new[i] = NOMATCH;
+   }
+   // the first record of a repeated code is used, as with a search of aez_codes_new
+   for (k = NUM_NEW_AEZ - 1; k >= 0; k--) {
+      if (aez_codes_new[k] >= 0) {
+         aez_code2ind_new[aez_codes_new[k]] = k;
+      }
+   }
+   
+   // map the fao country codes to their index
+   max_ctry_code = 0;
+   for (i = 0; i < NUM_FAO_CTRY; i++) {
+      if (countrycodes_fao[i] > max_ctry_code) {
+         max_ctry_code = countrycodes_fao[i];
+      }
+   }
+   ctry_code2ind = malloc((max_ctry_code + 1) * sizeof(int));
+   if(ctry_code2ind == NULL) {
+      fprintf(fplog,"Failed to allocate memory for ctry_code2ind:  write_glu_mapping()\n");
+      return ERROR_MEM;
+   }
+   for (i = 0; i <= max_ctry_code; i++) {
+      ctry_code2ind[i] = NOMATCH;
+   }
+   for (i = NUM_FAO_CTRY - 1; i >= 0; i--) {
+      if (countrycodes_fao[i] >= 0) {
+         ctry_code2ind[countrycodes_fao[i]] = i;
+      }
+   }
+   scg_ind = (scg_code <= max_ctry_code) ? ctry_code2ind[scg_code] : NOMATCH;
+   
+   // map the land rent region codes to their index
+   max_ctry87_code = 0;
+   for (i = 0; i < NUM_GTAP_CTRY87; i++) {
+      if (country87codes_gtap[i] > max_ctry87_code) {
+         max_ctry87_code = country87codes_gtap[i];
+      }
+   }
+   ctry87_code2ind = malloc((max_ctry87_code + 1) * sizeof(int));
+   if(ctry87_code2ind == NULL) {
+      fprintf(fplog,"Failed to allocate memory for ctry87_code2ind:  write_glu_mapping()\n");
+      return ERROR_MEM;
+   }
+   for (i = 0; i <= max_ctry87_code; i++) {
+      ctry87_code2ind[i] = NOMATCH;
+   }
+   for (i = NUM_GTAP_CTRY87 - 1; i >= 0; i--) {
+      if (country87codes_gtap[i] >= 0) {
+         ctry87_code2ind[country87codes_gtap[i]] = i;
+      }
+   }
+   
+   // map the countries to their land rent region and gcam region
+   ctry2reglr_ind = calloc(NUM_FAO_CTRY, sizeof(int));
+   ctry2reggcam_ind = calloc(NUM_FAO_CTRY, sizeof(int));
+   if(ctry2reglr_ind == NULL || ctry2reggcam_ind == NULL) {
+      fprintf(fplog,"Failed to allocate memory for the country region maps:  write_glu_mapping()\n");
+      return ERROR_MEM;
+   }
+   for (ctry_ind = 0; ctry_ind < NUM_FAO_CTRY; ctry_ind++) {
+      ctry2reglr_ind[ctry_ind] = NOMATCH;
+      if (ctry2ctry87codes_gtap[ctry_ind] >= 0 && ctry2ctry87codes_gtap[ctry_ind] <= max_ctry87_code) {
+         ctry2reglr_ind[ctry_ind] = ctry87_code2ind[ctry2ctry87codes_gtap[ctry_ind]];
+      }
+      ctry2reggcam_ind[ctry_ind] = NOMATCH;
+      for (i = 0; i < NUM_GCAM_RGN; i++) {
+         if (regioncodes_gcam[i] == ctry2regioncodes_gcam[ctry_ind]) {
+            ctry2reggcam_ind[ctry_ind] = i;
+            break;
+         }
+      }
+   }
+   
+   // the allocated length of each glu list; each list starts with one element
+   ctry_aez_cap = malloc(NUM_FAO_CTRY * sizeof(int));
+   reglr_aez_cap = malloc(NUM_GTAP_CTRY87 * sizeof(int));
+   reggcam_aez_cap = malloc(NUM_GCAM_RGN * sizeof(int));
+   if(ctry_aez_cap == NULL || reglr_aez_cap == NULL || reggcam_aez_cap == NULL) {
+      fprintf(fplog,"Failed to allocate memory for the glu list lengths:  write_glu_mapping()\n");
+      return ERROR_MEM;
+   }
+   for (i = 0; i < NUM_FAO_CTRY; i++) {
+      ctry_aez_cap[i] = 1;
+   }
+   for (i = 0; i < NUM_GTAP_CTRY87; i++) {
+      reglr_aez_cap[i] = 1;
+   }
+   for (i = 0; i < NUM_GCAM_RGN; i++) {
+      reggcam_aez_cap[i] = 1;
+   }
+   if(glu_set_init(&ctry_set, 10) != OK || glu_set_init(&reglr_set, 10) != OK || glu_set_init(&reggcam_set, 10) != OK) {
+      fprintf(fplog,"Failed to allocate memory for the glu sets:  write_glu_mapping()\n");
+      return ERROR_MEM;
+   }
+   
    // get the aezs associated with the countries
    // include all fao countries here
    for (land_cell_ind = 0; land_cell_ind < num_land_cells_aez_new; land_cell_ind++) {
       aez_val = aez_bounds_new[land_cells_aez_new[land_cell_ind]];
       ctry_code = country_fao[land_cells_aez_new[land_cell_ind]];
       ctry_ind = NOMATCH;
-      for (i = 0; i < NUM_FAO_CTRY; i++) {
-         if (countrycodes_fao[i] == ctry_code) {
-            ctry_ind = i;
-            break;
-         }
-      } // end for i loop to get ctry index
+      if (ctry_code >= 0 && ctry_code <= max_ctry_code) {
+         ctry_ind = ctry_code2ind[ctry_code];
+      }
       
       // only process if there is a country and valid hyde land
       if (ctry_ind == NOMATCH || land_area_hyde[land_cells_aez_new[land_cell_ind]] == raster_info.land_area_hyde_nodata){
@@ -246,10 +549,9 @@ int write_glu_mapping(args_struct in_args, rinfo_struct raster_info) {
       }
       
       // get the index of this glu, if it exists
-      for (j = 0; j < ctry_aez_num[ctry_ind]; j++) {
-         if (aez_val == ctry_aez_list[ctry_ind][j]) {
-            break;
-         }
+      j = glu_set_find(&ctry_set, ctry_ind, aez_val);
+      if (j == NOMATCH) {
+         j = ctry_aez_num[ctry_ind];
       }
       
       // store hong kong and taiwan valid glu areas, and total valid country areas
@@ -268,32 +570,16 @@ int write_glu_mapping(args_struct in_args, rinfo_struct raster_info) {
       // skip this cell if this new glu has already been stored for this country
       if (j == ctry_aez_num[ctry_ind]) {
          // store this aez
-         // grow the dim2 as needed, per country
-         // aez values
-         for (i = 0; i < ctry_aez_num[ctry_ind]; i++) {
-            temp_vals[i] = ctry_aez_list[ctry_ind][i];
-         }
-         free(ctry_aez_list[ctry_ind]);
-         ctry_aez_list[ctry_ind] = calloc(ctry_aez_num[ctry_ind] + 1, sizeof(int));
-         if(ctry_aez_list[ctry_ind] == NULL) {
+         if ((err = glu_set_add(&ctry_set, ctry_ind, aez_val, ctry_aez_num[ctry_ind])) != OK ||
+             (err = append_glu(&ctry_aez_list[ctry_ind], &ctry_aez_num[ctry_ind], &ctry_aez_cap[ctry_ind], aez_val)) != OK) {
             fprintf(fplog,"Failed to allocate memory for ctry_aez_list[ctry_ind]; ctry_ind=%i:  write_glu_mapping()\n", ctry_ind);
-            return ERROR_MEM;
+            return err;
          }
-         for (i = 0; i < ctry_aez_num[ctry_ind]; i++) {
-            ctry_aez_list[ctry_ind][i] = temp_vals[i];
-         }
-         ctry_aez_list[ctry_ind][ctry_aez_num[ctry_ind]++] = aez_val;
          
          // merge serbia and montenegro for scg record
          if (ctry_code == mne_code || ctry_code == srb_code) {
             ctry_code = scg_code;
-            ctry_ind = NOMATCH;
-            for (j = 0; j < NUM_FAO_CTRY; j++) {
-               if (countrycodes_fao[j] == ctry_code) {
-                  ctry_ind = j;
-                  break;
-               }
-            }
+            ctry_ind = scg_ind;
             if (ctry_ind == NOMATCH) {
                // this should never happen
                fprintf(fplog, "Error finding scg ctry index: write_glu_mapping()\n");
@@ -301,38 +587,19 @@ int write_glu_mapping(args_struct in_args, rinfo_struct raster_info) {
             }
             
             // check to see if it is already stored
-            for (j = 0; j < ctry_aez_num[ctry_ind]; j++) {
-               if (aez_val == ctry_aez_list[ctry_ind][j]) {
-                  break;
-               }
-            }
-            if (j == ctry_aez_num[ctry_ind]) {
+            if (glu_set_find(&ctry_set, ctry_ind, aez_val) == NOMATCH) {
                // now store this aez for scg
-               for (i = 0; i < ctry_aez_num[ctry_ind]; i++) {
-                  temp_vals[i] = ctry_aez_list[ctry_ind][i];
-               }
-               free(ctry_aez_list[ctry_ind]);
-               ctry_aez_list[ctry_ind] = calloc(ctry_aez_num[ctry_ind] + 1, sizeof(int));
-               if(ctry_aez_list[ctry_ind] == NULL) {
+               if ((err = glu_set_add(&ctry_set, ctry_ind, aez_val, ctry_aez_num[ctry_ind])) != OK ||
+                   (err = append_glu(&ctry_aez_list[ctry_ind], &ctry_aez_num[ctry_ind], &ctry_aez_cap[ctry_ind], aez_val)) != OK) {
                   fprintf(fplog,"Failed to allocate memory for ctry_aez_list[ctry_ind]; ctry_ind=%i:  write_glu_mapping()\n", ctry_ind);
-                  return ERROR_MEM;
+                  return err;
                }
-               for (i = 0; i < ctry_aez_num[ctry_ind]; i++) {
-                  ctry_aez_list[ctry_ind][i] = temp_vals[i];
-               }
-               ctry_aez_list[ctry_ind][ctry_aez_num[ctry_ind]++] = aez_val;
             } // end if new aez val for scg
          } // end if serbia or montenegro
          
          // now store this aez for the land rent region
          // use scg index as set above because serbia and montenegro are not separately mapped to a region
-         reglr_ind = NOMATCH;
-         for (i = 0; i < NUM_GTAP_CTRY87; i++) {
-            if (country87codes_gtap[i] == ctry2ctry87codes_gtap[ctry_ind]) {
-               reglr_ind = i;
-               break;
-            }
-         }
+         reglr_ind = ctry2reglr_ind[ctry_ind];
          if (reglr_ind == NOMATCH) {
             // this happens when a country is not assigned to a land rent region
             // which means that it is not output
@@ -340,38 +607,18 @@ int write_glu_mapping(args_struct in_args, rinfo_struct raster_info) {
             continue;
          }
          // now store this aez for the land rent region, if it isn't there already
-         for (j = 0; j < reglr_aez_num[reglr_ind]; j++) {
-            if (aez_val == reglr_aez_list[reglr_ind][j]) {
-               break;
-            }
-         }
-         
-         if (j == reglr_aez_num[reglr_ind]) {
-            for (i = 0; i < reglr_aez_num[reglr_ind]; i++) {
-               temp_vals[i] = reglr_aez_list[reglr_ind][i];
-            }
-            free(reglr_aez_list[reglr_ind]);
-            reglr_aez_list[reglr_ind] = calloc(reglr_aez_num[reglr_ind] + 1, sizeof(int));
-            if(reglr_aez_list[reglr_ind] == NULL) {
+         if (glu_set_find(&reglr_set, reglr_ind, aez_val) == NOMATCH) {
+            if ((err = glu_set_add(&reglr_set, reglr_ind, aez_val, reglr_aez_num[reglr_ind])) != OK ||
+                (err = append_glu(&reglr_aez_list[reglr_ind], &reglr_aez_num[reglr_ind], &reglr_aez_cap[reglr_ind], aez_val)) != OK) {
                fprintf(fplog,"Failed to allocate memory for reglr_aez_list[reglr_ind]; reglr_ind=%i:  write_glu_mapping()\n", reglr_ind);
-               return ERROR_MEM;
-            }
-            for (i = 0; i < reglr_aez_num[reglr_ind]; i++) {
-               reglr_aez_list[reglr_ind][i] = temp_vals[i];
+               return err;
             }
-            reglr_aez_list[reglr_ind][reglr_aez_num[reglr_ind]++] = aez_val;
          } // end if new aez for a land rent region
          
          // now store this aez for the gcam region
          // use scg index as set above because serbia and montenegro are not separately mapped to a region
          // countries are only assigned to gcam regions if they are also assigned to ctry87, so no need to check here
-         reggcam_ind = NOMATCH;
-         for (i = 0; i < NUM_GCAM_RGN; i++) {
-            if (regioncodes_gcam[i] == ctry2regioncodes_gcam[ctry_ind]) {
-               reggcam_ind = i;
-               break;
-            }
-         }
+         reggcam_ind = ctry2reggcam_ind[ctry_ind];
          if (reggcam_ind == NOMATCH) {
             // this happens when a country is not assigned to a gcam region or ctry87
             // which means that it is not output
@@ -379,30 +626,24 @@ int write_glu_mapping(args_struct in_args, rinfo_struct raster_info) {
             continue;
          }
          // now store this aez for the gcam region, if it isn't there already
-         for (j = 0; j < reggcam_aez_num[reggcam_ind]; j++) {
-            if (aez_val == reggcam_aez_list[reggcam_ind][j]) {
-               break;
-            }
-         }
-         if (j == reggcam_aez_num[reggcam_ind]) {
-            for (i = 0; i < reggcam_aez_num[reggcam_ind]; i++) {
-               temp_vals[i] = reggcam_aez_list[reggcam_ind][i];
-            }
-            free(reggcam_aez_list[reggcam_ind]);
-            reggcam_aez_list[reggcam_ind] = calloc(reggcam_aez_num[reggcam_ind] + 1, sizeof(int));
-            if(reggcam_aez_list[reggcam_ind] == NULL) {
+         if (glu_set_find(&reggcam_set, reggcam_ind, aez_val) == NOMATCH) {
+            if ((err = glu_set_add(&reggcam_set, reggcam_ind, aez_val, reggcam_aez_num[reggcam_ind])) != OK ||
+                (err = append_glu(&reggcam_aez_list[reggcam_ind], &reggcam_aez_num[reggcam_ind], &reggcam_aez_cap[reggcam_ind], aez_val)) != OK) {
                fprintf(fplog,"Failed to allocate memory for reggcam_aez_list[reggcam_ind]; reggcam_ind=%i:  write_glu_mapping()\n", reggcam_ind);
-               return ERROR_MEM;
+               return err;
             }
-            for (i = 0; i < reggcam_aez_num[reggcam_ind]; i++) {
-               reggcam_aez_list[reggcam_ind][i] = temp_vals[i];
-            }
-            reggcam_aez_list[reggcam_ind][reggcam_aez_num[reggcam_ind]++] = aez_val;
          } // end if new aez for a gcam region
          
       }	// end if this cell is a new aez to be stored
    }	// end for land_cell_ind loop over land_cells_aez_new
    
+   glu_set_free(&ctry_set);
+   glu_set_free(&reglr_set);
+   glu_set_free(&reggcam_set);
+   free(ctry_aez_cap);
+   free(reglr_aez_cap);
+   free(reggcam_aez_cap);
+   
    // write the country and aez mapping to iso gcam file
    strcpy(fname1, in_args.outpath);
    strcat(fname1, oname1);
@@ -460,21 +701,8 @@ int write_glu_mapping(args_struct in_args, rinfo_struct raster_info) {
    // country file
    // sort the aezs in each country by integer code
    for (ctry_ind = 0; ctry_ind < NUM_FAO_CTRY; ctry_ind++) {
-      // sort the aez values first; not pretty, but it works
-      for (j = 0; j < ctry_aez_num[ctry_ind]; j++) {
-         temp_vals[j] = ctry_aez_list[ctry_ind][j];
-      }
-      for (j = 0; j < ctry_aez_num[ctry_ind]; j++) {
-         ctry_aez_list[ctry_ind][j] = temp_vals[j];
-         for (i = j + 1; i < ctry_aez_num[ctry_ind]; i++) {
-            if (temp_vals[i] < ctry_aez_list[ctry_ind][j]) {
-               ctry_aez_list[ctry_ind][j] = temp_vals[i];
-               aez_val = temp_vals[j];
-               temp_vals[j] = temp_vals[i];
-               temp_vals[i] = aez_val;
-            }
-         }	// end for i loop over remaining elements
-      }	// end for j loop to sort
+      // sort the aez values first
+      qsort(ctry_aez_list[ctry_ind], ctry_aez_num[ctry_ind], sizeof(int), compare_glu);
       
       // now write the sorted values, but only if country mapped to ctry87
       for (j = 0; j < ctry_aez_num[ctry_ind]; j++) {
@@ -483,10 +711,8 @@ int write_glu_mapping(args_struct in_args, rinfo_struct raster_info) {
             gcam_id = countrycodes_fao[ctry_ind] * FAOCTRY2GCAMCTRYAEZID + ctry_aez_list[ctry_ind][j];
             // get the glu index to find the glu name
             k = NOMATCH;
-            for (k = 0; k < NUM_NEW_AEZ; k++) {
-               if (aez_codes_new[k] == ctry_aez_list[ctry_ind][j]) {
-                  break;
-               }
+            if (ctry_aez_list[ctry_ind][j] >= 0 && ctry_aez_list[ctry_ind][j] <= max_aez_code_new) {
+               k = aez_code2ind_new[ctry_aez_list[ctry_ind][j]];
             }
             if (k == NOMATCH) { // this shouldn't happen
                fprintf(fplog, "Error finding glu index for glu name: write_glu_mapping()\n");
@@ -502,31 +728,16 @@ int write_glu_mapping(args_struct in_args, rinfo_struct raster_info) {
    // land rent region file
    // sort the aezs in each land rent region by integer code
    for (reglr_ind = 0; reglr_ind < NUM_GTAP_CTRY87; reglr_ind++) {
-      // sort the aez values first; not pretty, but it works
-      for (j = 0; j < reglr_aez_num[reglr_ind]; j++) {
-         temp_vals[j] = reglr_aez_list[reglr_ind][j];
-      }
-      for (j = 0; j < reglr_aez_num[reglr_ind]; j++) {
-         reglr_aez_list[reglr_ind][j] = temp_vals[j];
-         for (i = j + 1; i < reglr_aez_num[reglr_ind]; i++) {
-            if (temp_vals[i] < reglr_aez_list[reglr_ind][j]) {
-               reglr_aez_list[reglr_ind][j] = temp_vals[i];
-               aez_val = temp_vals[j];
-               temp_vals[j] = temp_vals[i];
-               temp_vals[i] = aez_val;
-            }
-         }	// end for i loop over remaining elements
-      }	// end for j loop to sort
+      // sort the aez values first
+      qsort(reglr_aez_list[reglr_ind], reglr_aez_num[reglr_ind], sizeof(int), compare_glu);
       
       if (in_args.diagnostics) {
          // now write the sorted values
          for (j = 0; j < reglr_aez_num[reglr_ind]; j++) {
             // get the glu index to find the glu name
             k = NOMATCH;
-            for (k = 0; k < NUM_NEW_AEZ; k++) {
-               if (aez_codes_new[k] == reglr_aez_list[reglr_ind][j]) {
-                  break;
-               }
+            if (reglr_aez_list[reglr_ind][j] >= 0 && reglr_aez_list[reglr_ind][j] <= max_aez_code_new) {
+               k = aez_code2ind_new[reglr_aez_list[reglr_ind][j]];
             }
             if (k == NOMATCH) { // this shouldn't happen
                fprintf(fplog, "Error finding glu index for glu name: write_glu_mapping()\n");
@@ -541,31 +752,16 @@ int write_glu_mapping(args_struct in_args, rinfo_struct raster_info) {
    // gcam region file
    // sort the aezs in each gcam region by integer code
    for (reggcam_ind = 0; reggcam_ind < NUM_GCAM_RGN; reggcam_ind++) {
-      // sort the aez values first; not pretty, but it works
-      for (j = 0; j < reggcam_aez_num[reggcam_ind]; j++) {
-         temp_vals[j] = reggcam_aez_list[reggcam_ind][j];
-      }
-      for (j = 0; j < reggcam_aez_num[reggcam_ind]; j++) {
-         reggcam_aez_list[reggcam_ind][j] = temp_vals[j];
-         for (i = j + 1; i < reggcam_aez_num[reggcam_ind]; i++) {
-            if (temp_vals[i] < reggcam_aez_list[reggcam_ind][j]) {
-               reggcam_aez_list[reggcam_ind][j] = temp_vals[i];
-               aez_val = temp_vals[j];
-               temp_vals[j] = temp_vals[i];
-               temp_vals[i] = aez_val;
-            }
-         }	// end for i loop over remaining elements
-      }	// end for j loop to sort
+      // sort the aez values first
+      qsort(reggcam_aez_list[reggcam_ind], reggcam_aez_num[reggcam_ind], sizeof(int), compare_glu);
       
       if (in_args.diagnostics) {
          // now write the sorted values
          for (j = 0; j < reggcam_aez_num[reggcam_ind]; j++) {
             // get the glu index to find the glu name
             k = NOMATCH;
-            for (k = 0; k < NUM_NEW_AEZ; k++) {
-               if (aez_codes_new[k] == reggcam_aez_list[reggcam_ind][j]) {
-                  break;
-               }
+            if (reggcam_aez_list[reggcam_ind][j] >= 0 && reggcam_aez_list[reggcam_ind][j] <= max_aez_code_new) {
+               k = aez_code2ind_new[reggcam_aez_list[reggcam_ind][j]];
             }
             if (k == NOMATCH) { // this shouldn't happen
                fprintf(fplog, "Error finding glu index for glu name: write_glu_mapping()\n");
@@ -602,4 +798,89 @@ int write_glu_mapping(args_struct in_args, rinfo_struct raster_info) {
       
    }	// end if diagnostics
    
+   // map the country glus to the region glus
+   ctry_aez_reglr_ind = calloc(NUM_FAO_CTRY, sizeof(int *));
+   ctry_aez_reggcam_ind = calloc(NUM_FAO_CTRY, sizeof(int *));
+   glu_slot = malloc(NUM_NEW_AEZ * sizeof(int));
+   if(ctry_aez_reglr_ind == NULL || ctry_aez_reggcam_ind == NULL || glu_slot == NULL) {
+      fprintf(fplog,"Failed to allocate memory for the glu index maps:  write_glu_mapping()\n");
+      return ERROR_MEM;
+   }
+   for (ctry_ind = 0; ctry_ind < NUM_FAO_CTRY; ctry_ind++) {
+      // one extra element so that countries without glus are not zero size
+      ctry_aez_reglr_ind[ctry_ind] = malloc((ctry_aez_num[ctry_ind] + 1) * sizeof(int));
+      ctry_aez_reggcam_ind[ctry_ind] = malloc((ctry_aez_num[ctry_ind] + 1) * sizeof(int));
+      if(ctry_aez_reglr_ind[ctry_ind] == NULL || ctry_aez_reggcam_ind[ctry_ind] == NULL) {
+         fprintf(fplog,"Failed to allocate memory for the glu index maps; ctry_ind=%i:  write_glu_mapping()\n", ctry_ind);
+         return ERROR_MEM;
+      }
+      for (j = 0; j < ctry_aez_num[ctry_ind]; j++) {
+         ctry_aez_reglr_ind[ctry_ind][j] = NOMATCH;
+         ctry_aez_reggcam_ind[ctry_ind][j] = NOMATCH;
+      }
+   }
+   
+   // each region list is spread over glu_slot once, then its countries look up their glus in it
+   for (i = 0; i < NUM_NEW_AEZ; i++) {
+      glu_slot[i] = NOMATCH;
+   }
+   for (reglr_ind = 0; reglr_ind < NUM_GTAP_CTRY87; reglr_ind++) {
+      for (j = 0; j < reglr_aez_num[reglr_ind]; j++) {
+         aez_val = reglr_aez_list[reglr_ind][j];
+         if (aez_val >= 0 && aez_val <= max_aez_code_new && aez_code2ind_new[aez_val] != NOMATCH) {
+            glu_slot[aez_code2ind_new[aez_val]] = j;
+         }
+      }
+      for (ctry_ind = 0; ctry_ind < NUM_FAO_CTRY; ctry_ind++) {
+         if (ctry2reglr_ind[ctry_ind] != reglr_ind) {
+            continue;
+         }
+         for (j = 0; j < ctry_aez_num[ctry_ind]; j++) {
+            aez_val = ctry_aez_list[ctry_ind][j];
+            if (aez_val >= 0 && aez_val <= max_aez_code_new && aez_code2ind_new[aez_val] != NOMATCH) {
+               ctry_aez_reglr_ind[ctry_ind][j] = glu_slot[aez_code2ind_new[aez_val]];
+            }
+         }
+      }
+      for (j = 0; j < reglr_aez_num[reglr_ind]; j++) {
+         aez_val = reglr_aez_list[reglr_ind][j];
+         if (aez_val >= 0 && aez_val <= max_aez_code_new && aez_code2ind_new[aez_val] != NOMATCH) {
+            glu_slot[aez_code2ind_new[aez_val]] = NOMATCH;
+         }
+      }
+   } // end for reglr_ind loop over land rent regions
+   for (reggcam_ind = 0; reggcam_ind < NUM_GCAM_RGN; reggcam_ind++) {
+      for (j = 0; j < reggcam_aez_num[reggcam_ind]; j++) {
+         aez_val = reggcam_aez_list[reggcam_ind][j];
+         if (aez_val >= 0 && aez_val <= max_aez_code_new && aez_code2ind_new[aez_val] != NOMATCH) {
+            glu_slot[aez_code2ind_new[aez_val]] = j;
+         }
+      }
+      for (ctry_ind = 0; ctry_ind < NUM_FAO_CTRY; ctry_ind++) {
+         if (ctry2reggcam_ind[ctry_ind] != reggcam_ind) {
+            continue;
+         }
+         for (j = 0; j < ctry_aez_num[ctry_ind]; j++) {
+            aez_val = ctry_aez_list[ctry_ind][j];
+            if (aez_val >= 0 && aez_val <= max_aez_code_new && aez_code2ind_new[aez_val] != NOMATCH) {
+               ctry_aez_reggcam_ind[ctry_ind][j] = glu_slot[aez_code2ind_new[aez_val]];
+            }
+         }
+      }
+      for (j = 0; j < reggcam_aez_num[reggcam_ind]; j++) {
+         aez_val = reggcam_aez_list[reggcam_ind][j];
+         if (aez_val >= 0 && aez_val <= max_aez_code_new && aez_code2ind_new[aez_val] != NOMATCH) {
+            glu_slot[aez_code2ind_new[aez_val]] = NOMATCH;
+         }
+      }
+   } // end for reggcam_ind loop over gcam regions
+   free(glu_slot);
+   
+   // the reference veg carbon keys need the sorted country glu lists and the land type categories
+   err = add_refveg_carbon_keys(raster_info, ctry_code2ind, max_ctry_code, scg_ind);
+   free(ctry_code2ind);
+   if (err != OK) {
+      return err;
+   }
+   
    return OK;}
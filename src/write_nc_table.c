@@ -0,0 +1,484 @@
+/**********
+ write_nc_table.c
+
+ write a long format output table as a compressed netcdf-4 file, for the land type area and ref veg carbon tables
+    the table is collected one record at a time, in the order of the csv records (see proc_land_type_area.c
+        and proc_refveg_carbon.c), and written when it is complete
+    or, if the number of records and the coordinates are known before the records, the file is opened first
+        and the records are written in slices of NC_TABLE_CHUNK_RECORDS as they are collected, so the table is not held
+        in memory; proc_land_type_area() does this with the records of its year merge
+    the file holds the same records as the csv table, so it is sparse:
+        dimension record:		one entry per record
+        dimension <key>:		the distinct values of each key column, in increasing order
+        variable <key>(<key>):	the coordinate values: int codes, or strings for keys with labels (e.g. the iso abbreviations)
+        variable <key>_index(record):	the index map of the records into the <key> coordinate
+        variable <value>(record):		each value column, as double, with the units attribute
+    the record variables are chunked along the record dimension and compressed with the shuffle and deflate filters,
+        so a reader can load a slice of the table without parsing text
+    the country X glu dimensions are ragged, so the table is not written as a dense array
+
+ functions:
+ init_nc_table():		set the key and value columns of an empty table
+ add_nc_table_record():	add a record to the table; the slice is written when it is full if the table is open
+ write_nc_table():		write the table to fname
+ open_nc_table():		create fname and write the coordinates, to write the records in slices
+ close_nc_table():		write the last slice and close the file; every record of the record dimension must be added
+ free_nc_table():		free the records of the table, and close the file if it is open (e.g. on error)
+ get_nc_table_fname():	the netcdf file name for a csv table file name: the .csv extension is replaced by .nc
+
+ arguments:
+ nc_table_struct *table:	the table
+ int num_keys:				number of key columns
+ const char *key_names[]:	names of the key columns; set table->key_labels[] for keys with string coordinates
+ int num_vals:				number of value columns
+ const char *val_names[]:	names of the value columns
+ const char *units:			units of the values
+ const int keys[]:			the key values of the record; for a key with labels, the index of its label
+ const double vals[]:		the values of the record
+ const char *fname:			the netcdf file name, with path
+ const char *description:	description of the table, written as a global attribute
+ int num_records:			the number of records of the open table
+ int *coords[]:				the coordinates of each key of the open table, in increasing order; copied
+ const int num_coords[]:	the number of coordinates of each key
+ char *nc_fname:			the netcdf file name; at least MAXCHAR long
+ const char *csv_fname:		the csv file name
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#include "moirai.h"
+
+#define NC_TABLE_CHUNK_RECORDS	16384	// records per chunk of the record variables
+#define NC_TABLE_DEFLATE_LEVEL	4		// deflate level of the record variables
+#define NC_TABLE_INIT_RECORDS	4096	// initial record capacity of a table
+
+// compare two ints for qsort and bsearch
+static int cmp_int(const void *a, const void *b) {
+	int ia = *(const int *) a;
+	int ib = *(const int *) b;
+	return (ia > ib) - (ia < ib);
+}
+
+int init_nc_table(nc_table_struct *table, int num_keys, const char *key_names[], int num_vals, const char *val_names[],
+				  const char *units) {
+
+	int i;
+
+	if (num_keys > MAX_NC_TABLE_COLS || num_vals > MAX_NC_TABLE_COLS) {
+		fprintf(fplog, "Too many columns for a netcdf table: %i keys, %i values > %i: init_nc_table()\n",
+				num_keys, num_vals, MAX_NC_TABLE_COLS);
+		return ERROR_IND;
+	}
+	memset(table, 0, sizeof(nc_table_struct));
+	table->num_keys = num_keys;
+	table->num_vals = num_vals;
+	for (i = 0; i < num_keys; i++) {
+		table->key_names[i] = key_names[i];
+	}
+	for (i = 0; i < num_vals; i++) {
+		table->val_names[i] = val_names[i];
+	}
+	table->units = units;
+
+	return OK;}
+
+// define a record variable: chunked along the record dimension and compressed
+static int def_record_var(int ncid, const char *name, nc_type xtype, int rec_dimid, size_t chunk, int *varid) {
+
+	int ncerr;
+
+	if ((ncerr = nc_def_var(ncid, name, xtype, 1, &rec_dimid, varid)) ||
+		(ncerr = nc_def_var_chunking(ncid, *varid, NC_CHUNKED, &chunk)) ||
+		(ncerr = nc_def_var_deflate(ncid, *varid, 1, 1, NC_TABLE_DEFLATE_LEVEL))) {
+		return ncerr;
+	}
+	return NC_NOERR;
+}
+
+// define the dimensions and variables, and write the coordinates to the open file ncid
+//	an empty table has zero length (unlimited) dimensions
+// returns the netcdf error code
+static int def_table(int ncid, const nc_table_struct *table, const char *description, int num_records, int *coords[],
+					 const int num_coords[], const char **labels, int index_varid[], int val_varid[]) {
+
+	int i, k;
+	int ncerr;										// netcdf error code
+	int rec_dimid;									// record dimension id
+	int key_dimid[MAX_NC_TABLE_COLS];				// key dimension ids
+	int coord_varid[MAX_NC_TABLE_COLS];				// key coordinate variable ids
+	char var_name[MAXCHAR];							// index map variable name
+	size_t chunk;									// record chunk length
+	const char index_desc[] = "index of the record in the coordinate";
+
+	chunk = (num_records < NC_TABLE_CHUNK_RECORDS) ? (size_t) num_records : NC_TABLE_CHUNK_RECORDS;
+	if (chunk == 0) {
+		chunk = 1;
+	}
+	if ((ncerr = nc_put_att_text(ncid, NC_GLOBAL, "title", strlen(description), description)) ||
+		(ncerr = nc_put_att_text(ncid, NC_GLOBAL, "source", strlen(CODENAME), CODENAME)) ||
+		(ncerr = nc_def_dim(ncid, "record", (size_t) num_records, &rec_dimid))) {
+		return ncerr;
+	}
+	for (k = 0; k < table->num_keys; k++) {
+		sprintf(var_name, "%s_index", table->key_names[k]);
+		if ((ncerr = nc_def_dim(ncid, table->key_names[k], (size_t) num_coords[k], &key_dimid[k])) ||
+			(ncerr = nc_def_var(ncid, table->key_names[k], (table->key_labels[k] != NULL) ? NC_STRING : NC_INT,
+								1, &key_dimid[k], &coord_varid[k])) ||
+			(ncerr = def_record_var(ncid, var_name, NC_INT, rec_dimid, chunk, &index_varid[k])) ||
+			(ncerr = nc_put_att_text(ncid, index_varid[k], "description", strlen(index_desc), index_desc))) {
+			return ncerr;
+		}
+	}
+	for (k = 0; k < table->num_vals; k++) {
+		if ((ncerr = def_record_var(ncid, table->val_names[k], NC_DOUBLE, rec_dimid, chunk, &val_varid[k])) ||
+			(ncerr = nc_put_att_text(ncid, val_varid[k], "units", strlen(table->units), table->units))) {
+			return ncerr;
+		}
+	}
+	if ((ncerr = nc_enddef(ncid))) {
+		return ncerr;
+	}
+
+	for (k = 0; k < table->num_keys; k++) {
+		if (num_coords[k] > 0) {
+			if (table->key_labels[k] != NULL) {
+				for (i = 0; i < num_coords[k]; i++) {
+					labels[i] = table->key_labels[k][coords[k][i]];
+				}
+				ncerr = nc_put_var_string(ncid, coord_varid[k], labels);
+			} else {
+				ncerr = nc_put_var_int(ncid, coord_varid[k], coords[k]);
+			}
+			if (ncerr) {
+				return ncerr;
+			}
+		}
+	}
+
+	return NC_NOERR;
+}
+
+// fill index_col with the coordinates of key k of the first num_records records of the table
+// returns NOMATCH if a key value is not one of the coordinates, otherwise OK
+static int fill_index_col(const nc_table_struct *table, int k, int num_records, int *coords, int num_coords, int *index_col) {
+
+	int i;
+	const int *found;								// the coordinate of a record key
+
+	for (i = 0; i < num_records; i++) {
+		found = bsearch(&table->keys[(size_t) i * table->num_keys + k], coords, num_coords, sizeof(int), cmp_int);
+		if (found == NULL) {
+			return NOMATCH;
+		}
+		index_col[i] = (int) (found - coords);
+	}
+	return OK;
+}
+
+// define the table and write the coordinates and the record columns to the open file ncid
+// returns the netcdf error code
+static int put_table(int ncid, const nc_table_struct *table, const char *description, int *coords[], const int num_coords[],
+					 int *index_col, double *val_col, const char **labels) {
+
+	int i, k;
+	int ncerr;										// netcdf error code
+	int index_varid[MAX_NC_TABLE_COLS];				// key index map variable ids
+	int val_varid[MAX_NC_TABLE_COLS];				// value variable ids
+	int num_records = table->num_records;
+
+	if ((ncerr = def_table(ncid, table, description, num_records, coords, num_coords, labels, index_varid, val_varid))) {
+		return ncerr;
+	}
+	for (k = 0; k < table->num_keys && num_records > 0; k++) {
+		fill_index_col(table, k, num_records, coords[k], num_coords[k], index_col);
+		if ((ncerr = nc_put_var_int(ncid, index_varid[k], index_col))) {
+			return ncerr;
+		}
+	}
+	for (k = 0; k < table->num_vals && num_records > 0; k++) {
+		for (i = 0; i < num_records; i++) {
+			val_col[i] = table->vals[(size_t) i * table->num_vals + k];
+		}
+		if ((ncerr = nc_put_var_double(ncid, val_varid[k], val_col))) {
+			return ncerr;
+		}
+	}
+
+	return NC_NOERR;
+}
+
+// write the collected records of an open table as the next slice of the record variables
+static int put_slice(nc_table_struct *table) {
+
+	int i, k;
+	int ncerr = NC_NOERR;							// netcdf error code
+	size_t start = (size_t) table->num_written;		// the first record of the slice
+	size_t count = (size_t) table->num_records;		// the records of the slice
+
+	if (table->num_records == 0) {
+		return OK;
+	}
+	if (table->num_written + table->num_records > table->total_records) {
+		fprintf(fplog, "More than %i records for %s: write_nc_table()\n", table->total_records, table->fname);
+		return ERROR_IND;
+	}
+	for (k = 0; k < table->num_keys && ncerr == NC_NOERR; k++) {
+		if (fill_index_col(table, k, table->num_records, table->coords[k], table->num_coords[k], table->index_col) != OK) {
+			fprintf(fplog, "A %s value of a record is not a coordinate of %s: write_nc_table()\n", table->key_names[k],
+					table->fname);
+			return ERROR_IND;
+		}
+		ncerr = nc_put_vara_int(table->ncid, table->index_varid[k], &start, &count, table->index_col);
+	}
+	for (k = 0; k < table->num_vals && ncerr == NC_NOERR; k++) {
+		for (i = 0; i < table->num_records; i++) {
+			table->val_col[i] = table->vals[(size_t) i * table->num_vals + k];
+		}
+		ncerr = nc_put_vara_double(table->ncid, table->val_varid[k], &start, &count, table->val_col);
+	}
+	if (ncerr) {
+		fprintf(fplog, "Failed to write %s: write_nc_table(); %s\n", table->fname, nc_strerror(ncerr));
+		return ERROR_FILE;
+	}
+	table->num_written += table->num_records;
+	table->num_records = 0;
+
+	return OK;}
+
+int add_nc_table_record(nc_table_struct *table, const int keys[], const double vals[]) {
+
+	int new_max;	// the new record capacity
+	int *new_keys;
+	double *new_vals;
+	int err;
+
+	if (table->is_open && table->num_records == table->max_records) {
+		if ((err = put_slice(table)) != OK) {
+			return err;
+		}
+	}
+	if (table->num_records == table->max_records) {
+		new_max = (table->max_records == 0) ? NC_TABLE_INIT_RECORDS : 2 * table->max_records;
+		new_keys = realloc(table->keys, (size_t) new_max * table->num_keys * sizeof(int));
+		if (new_keys == NULL) {
+			fprintf(fplog, "Failed to allocate memory for %i netcdf table records: add_nc_table_record()\n", new_max);
+			return ERROR_MEM;
+		}
+		table->keys = new_keys;
+		new_vals = realloc(table->vals, (size_t) new_max * table->num_vals * sizeof(double));
+		if (new_vals == NULL) {
+			fprintf(fplog, "Failed to allocate memory for %i netcdf table records: add_nc_table_record()\n", new_max);
+			return ERROR_MEM;
+		}
+		table->vals = new_vals;
+		table->max_records = new_max;
+	}
+	memcpy(table->keys + (size_t) table->num_records * table->num_keys, keys, table->num_keys * sizeof(int));
+	memcpy(table->vals + (size_t) table->num_records * table->num_vals, vals, table->num_vals * sizeof(double));
+	table->num_records++;
+
+	return OK;}
+
+int write_nc_table(const nc_table_struct *table, const char *fname, const char *description) {
+
+	int i, k;
+	int ncid;										// netcdf file id
+	int ncerr;										// netcdf error code
+	int err = OK;									// moirai error code
+	int *coords[MAX_NC_TABLE_COLS] = {NULL};		// the distinct values of each key, in increasing order
+	int num_coords[MAX_NC_TABLE_COLS] = {0};		// the number of distinct values of each key
+	int *index_col;									// one index map column
+	double *val_col;								// one value column
+	const char **labels;							// the labels of the coordinate values of a key
+	int num_records = table->num_records;
+
+	index_col = malloc(((size_t) num_records + 1) * sizeof(int));
+	val_col = malloc(((size_t) num_records + 1) * sizeof(double));
+	labels = malloc(((size_t) num_records + 1) * sizeof(char *));
+	if (index_col == NULL || val_col == NULL || labels == NULL) {
+		fprintf(fplog, "Failed to allocate memory for the columns of %s: write_nc_table()\n", fname);
+		err = ERROR_MEM;
+	}
+
+	// the coordinates of each key are its distinct values
+	for (k = 0; k < table->num_keys && err == OK; k++) {
+		coords[k] = malloc(((size_t) num_records + 1) * sizeof(int));
+		if (coords[k] == NULL) {
+			fprintf(fplog, "Failed to allocate memory for the coordinates of %s: write_nc_table()\n", table->key_names[k]);
+			err = ERROR_MEM;
+			break;
+		}
+		for (i = 0; i < num_records; i++) {
+			coords[k][i] = table->keys[(size_t) i * table->num_keys + k];
+		}
+		qsort(coords[k], num_records, sizeof(int), cmp_int);
+		for (i = 0; i < num_records; i++) {
+			if (num_coords[k] == 0 || coords[k][i] != coords[k][num_coords[k] - 1]) {
+				coords[k][num_coords[k]++] = coords[k][i];
+			}
+		}
+	}
+
+	if (err == OK) {
+		if ((ncerr = nc_create(fname, NC_CLOBBER | NC_NETCDF4, &ncid))) {
+			fprintf(fplog, "Failed to create %s: write_nc_table(); %s\n", fname, nc_strerror(ncerr));
+			err = ERROR_FILE;
+		} else {
+			ncerr = put_table(ncid, table, description, coords, num_coords, index_col, val_col, labels);
+			if (ncerr) {
+				nc_close(ncid);
+			} else {
+				ncerr = nc_close(ncid);
+			}
+			if (ncerr) {
+				fprintf(fplog, "Failed to write %s: write_nc_table(); %s\n", fname, nc_strerror(ncerr));
+				err = ERROR_FILE;
+			}
+		}
+	}
+
+	for (k = 0; k < table->num_keys; k++) {
+		free(coords[k]);
+	}
+	free(index_col);
+	free(val_col);
+	free(labels);
+
+	return err;}
+
+int open_nc_table(nc_table_struct *table, const char *fname, const char *description, int num_records,
+				  int *coords[], const int num_coords[]) {
+
+	int k;
+	int ncerr;										// netcdf error code
+	int max_coords = 0;								// the largest number of coordinates of a key
+	const char **labels;							// the labels of the coordinate values of a key
+
+	strcpy(table->fname, fname);
+	table->total_records = num_records;
+	table->num_written = 0;
+	table->num_records = 0;
+	table->max_records = NC_TABLE_CHUNK_RECORDS;
+	table->keys = malloc((size_t) NC_TABLE_CHUNK_RECORDS * table->num_keys * sizeof(int));
+	table->vals = malloc((size_t) NC_TABLE_CHUNK_RECORDS * table->num_vals * sizeof(double));
+	table->index_col = malloc(NC_TABLE_CHUNK_RECORDS * sizeof(int));
+	table->val_col = malloc(NC_TABLE_CHUNK_RECORDS * sizeof(double));
+	if (table->keys == NULL || table->vals == NULL || table->index_col == NULL || table->val_col == NULL) {
+		fprintf(fplog, "Failed to allocate memory for the slices of %s: open_nc_table()\n", fname);
+		return ERROR_MEM;
+	}
+	for (k = 0; k < table->num_keys; k++) {
+		table->coords[k] = malloc(((size_t) num_coords[k] + 1) * sizeof(int));
+		if (table->coords[k] == NULL) {
+			fprintf(fplog, "Failed to allocate memory for the coordinates of %s: open_nc_table()\n", table->key_names[k]);
+			return ERROR_MEM;
+		}
+		memcpy(table->coords[k], coords[k], num_coords[k] * sizeof(int));
+		table->num_coords[k] = num_coords[k];
+		if (num_coords[k] > max_coords) {
+			max_coords = num_coords[k];
+		}
+	}
+	labels = malloc(((size_t) max_coords + 1) * sizeof(char *));
+	if (labels == NULL) {
+		fprintf(fplog, "Failed to allocate memory for the coordinate labels of %s: open_nc_table()\n", fname);
+		return ERROR_MEM;
+	}
+
+	if ((ncerr = nc_create(fname, NC_CLOBBER | NC_NETCDF4, &table->ncid))) {
+		fprintf(fplog, "Failed to create %s: open_nc_table(); %s\n", fname, nc_strerror(ncerr));
+		free(labels);
+		return ERROR_FILE;
+	}
+	table->is_open = 1;
+	ncerr = def_table(table->ncid, table, description, num_records, table->coords, table->num_coords, labels,
+					  table->index_varid, table->val_varid);
+	free(labels);
+	if (ncerr) {
+		fprintf(fplog, "Failed to write %s: open_nc_table(); %s\n", fname, nc_strerror(ncerr));
+		return ERROR_FILE;
+	}
+
+	return OK;}
+
+int close_nc_table(nc_table_struct *table) {
+
+	int ncerr;										// netcdf error code
+	int err;
+
+	if ((err = put_slice(table)) != OK) {
+		return err;
+	}
+	if (table->num_written != table->total_records) {
+		fprintf(fplog, "Wrote %i of the %i records of %s: close_nc_table()\n", table->num_written, table->total_records,
+				table->fname);
+		return ERROR_IND;
+	}
+	table->is_open = 0;
+	if ((ncerr = nc_close(table->ncid))) {
+		fprintf(fplog, "Failed to write %s: close_nc_table(); %s\n", table->fname, nc_strerror(ncerr));
+		return ERROR_FILE;
+	}
+
+	return OK;}
+
+void free_nc_table(nc_table_struct *table) {
+
+	int k;
+
+	if (table->is_open) {
+		nc_close(table->ncid);
+		table->is_open = 0;
+	}
+	for (k = 0; k < MAX_NC_TABLE_COLS; k++) {
+		free(table->coords[k]);
+		table->coords[k] = NULL;
+	}
+	free(table->index_col);
+	free(table->val_col);
+	free(table->keys);
+	free(table->vals);
+	table->index_col = NULL;
+	table->val_col = NULL;
+	table->keys = NULL;
+	table->vals = NULL;
+	table->num_records = 0;
+	table->max_records = 0;
+}
+
+void get_nc_table_fname(char *nc_fname, const char *csv_fname) {
+
+	size_t len = strlen(csv_fname);
+
+	strncpy(nc_fname, csv_fname, MAXCHAR - 4);
+	nc_fname[MAXCHAR - 4] = '\0';
+	if (len >= 4 && len < MAXCHAR - 4 && strcmp(csv_fname + len - 4, ".csv") == 0) {
+		nc_fname[len - 4] = '\0';
+	}
+	strcat(nc_fname, ".nc");
+}
@@ -6,7 +6,7 @@
  no header
  
  arguments:
- float out_array[]:		array to write to file
+ const float out_array[]:		array to write to file
  int out_length:		length of array to write to file
  char *out_name:		name of output file
  args_struct in_args:	the input argument structure
@@ -41,7 +41,7 @@
 
 #include "moirai.h"
 
-int write_raster_float(float out_array[], int out_length, char *out_name, args_struct in_args) {
+int write_raster_float(const float out_array[], int out_length, char *out_name, args_struct in_args) {
 
 	char fname[MAXCHAR];			// file name to open
 	FILE *fpout;					// file pointer
@@ -0,0 +1,228 @@
+/**********
+ year_spill.c
+
+ spill the land type area of each year to a temporary year-major file, and merge it back into the table order
+    proc_land_type_area() aggregates one hyde year at a time, so it holds only the country X glu X land type slice
+        of the current year, instead of the whole table for every year, and spills the slice when the year is done
+    the table is written in country, glu, land type, year order (year varies fastest), so the spilled years are
+        merged back into that order with a streaming merge of the year runs, without holding the table in memory
+
+ the spill file is a binary file in native byte order, with one run of records for each year, in hyde_years order
+    each run is in country, glu, land type order, as the slice is spilled in that order
+    only the records that are written to the table are spilled (see proc_land_type_area.c), so the file is about the size of the table
+ the merge reads each run through a buffer of YEAR_SPILL_BUF_RECORDS records,
+    and returns the record with the lowest country, glu, land type key, and the lowest year for equal keys
+ the file is removed when it is closed
+
+ functions:
+ open_year_spill():		create the spill file
+ add_year_spill():		add a record to the run of year_ind; the years are added in order
+ start_year_merge():	end the last run and set up the merge
+ next_year_merge():		get the next record in table order
+ close_year_spill():	close and remove the spill file, and free the merge buffers
+
+ arguments:
+ year_spill_struct *spill:		the spill file
+ const char *fname:				the spill file name, with path
+ int num_years:					the number of years (runs)
+ int year_ind:					the year index of the record
+ int ctry_ind:					the fao country index of the record
+ int aez_ind:					the glu index of the record within the country glu list
+ int lt_ind:					the land type category index of the record
+ double area:					the area of the record
+ year_spill_rec_struct *rec:	the next record
+ int *found:					1 if rec was set, 0 if all the records have been merged
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+
+ **********/
+
+#include "moirai.h"
+
+#define YEAR_SPILL_BUF_RECORDS	4096	// records read at a time from each year run
+
+// compare the table keys of two records: country, glu, land type
+static int cmp_spill_key(const year_spill_rec_struct *a, const year_spill_rec_struct *b) {
+	if (a->ctry_ind != b->ctry_ind) {
+		return (a->ctry_ind < b->ctry_ind) ? -1 : 1;
+	}
+	if (a->aez_ind != b->aez_ind) {
+		return (a->aez_ind < b->aez_ind) ? -1 : 1;
+	}
+	if (a->lt_ind != b->lt_ind) {
+		return (a->lt_ind < b->lt_ind) ? -1 : 1;
+	}
+	return 0;
+}
+
+// refill the buffer of a year run; the buffer is left empty at the end of the run
+static int fill_run_buf(year_spill_struct *spill, int year_ind) {
+
+	long num_left = spill->run_start[year_ind + 1] - spill->run_pos[year_ind];
+	size_t num_read;
+
+	spill->buf_pos[year_ind] = 0;
+	spill->buf_len[year_ind] = 0;
+	if (num_left <= 0) {
+		return OK;
+	}
+	if (num_left > YEAR_SPILL_BUF_RECORDS) {
+		num_left = YEAR_SPILL_BUF_RECORDS;
+	}
+	if (fseek(spill->fp, spill->run_pos[year_ind] * (long) sizeof(year_spill_rec_struct), SEEK_SET) != 0 ||
+		(num_read = fread(spill->buf + (size_t) year_ind * YEAR_SPILL_BUF_RECORDS, sizeof(year_spill_rec_struct),
+						  num_left, spill->fp)) != (size_t) num_left) {
+		fprintf(fplog, "Failed to read the year %i run of %s: next_year_merge()\n", year_ind, spill->fname);
+		return ERROR_FILE;
+	}
+	spill->run_pos[year_ind] += num_left;
+	spill->buf_len[year_ind] = (int) num_left;
+	return OK;
+}
+
+int open_year_spill(year_spill_struct *spill, const char *fname, int num_years) {
+
+	memset(spill, 0, sizeof(year_spill_struct));
+	strcpy(spill->fname, fname);
+	spill->num_years = num_years;
+	spill->cur_year = 0;
+	spill->run_start = calloc(num_years + 1, sizeof(long));
+	spill->run_pos = calloc(num_years, sizeof(long));
+	spill->buf_len = calloc(num_years, sizeof(int));
+	spill->buf_pos = calloc(num_years, sizeof(int));
+	if (spill->run_start == NULL || spill->run_pos == NULL || spill->buf_len == NULL || spill->buf_pos == NULL) {
+		fprintf(fplog, "Failed to allocate memory for the runs of %s: open_year_spill()\n", fname);
+		return ERROR_MEM;
+	}
+	if ((spill->fp = fopen(fname, "w+b")) == NULL) {
+		fprintf(fplog, "Failed to open file %s for write: open_year_spill()\n", fname);
+		return ERROR_FILE;
+	}
+
+	return OK;}
+
+int add_year_spill(year_spill_struct *spill, int year_ind, int ctry_ind, int aez_ind, int lt_ind, double area) {
+
+	year_spill_rec_struct rec;
+
+	// the runs of the years without records are empty
+	while (spill->cur_year < year_ind) {
+		spill->cur_year++;
+		spill->run_start[spill->cur_year] = spill->num_records;
+	}
+	rec.year_ind = year_ind;
+	rec.ctry_ind = ctry_ind;
+	rec.aez_ind = aez_ind;
+	rec.lt_ind = lt_ind;
+	rec.area = area;
+	if (fwrite(&rec, sizeof(year_spill_rec_struct), 1, spill->fp) != 1) {
+		fprintf(fplog, "Failed to write to %s: add_year_spill()\n", spill->fname);
+		return ERROR_FILE;
+	}
+	spill->num_records++;
+
+	return OK;}
+
+int start_year_merge(year_spill_struct *spill) {
+
+	int i;
+
+	while (spill->cur_year < spill->num_years) {
+		spill->cur_year++;
+		spill->run_start[spill->cur_year] = spill->num_records;
+	}
+	if (fflush(spill->fp) != 0) {
+		fprintf(fplog, "Failed to write to %s: start_year_merge()\n", spill->fname);
+		return ERROR_FILE;
+	}
+	spill->buf = malloc((size_t) spill->num_years * YEAR_SPILL_BUF_RECORDS * sizeof(year_spill_rec_struct));
+	if (spill->buf == NULL) {
+		fprintf(fplog, "Failed to allocate memory for the merge buffers of %s: start_year_merge()\n", spill->fname);
+		return ERROR_MEM;
+	}
+	for (i = 0; i < spill->num_years; i++) {
+		spill->run_pos[i] = spill->run_start[i];
+		if (fill_run_buf(spill, i) != OK) {
+			return ERROR_FILE;
+		}
+	}
+
+	return OK;}
+
+int next_year_merge(year_spill_struct *spill, year_spill_rec_struct *rec, int *found) {
+
+	int i;
+	int min_year = NOMATCH;					// the run with the next record
+	const year_spill_rec_struct *head;		// the next record of a run
+	const year_spill_rec_struct *min_head = NULL;
+
+	// the lowest key; the first year of equal keys wins, so the years of a key are in order
+	for (i = 0; i < spill->num_years; i++) {
+		if (spill->buf_pos[i] < spill->buf_len[i]) {
+			head = spill->buf + (size_t) i * YEAR_SPILL_BUF_RECORDS + spill->buf_pos[i];
+			if (min_head == NULL || cmp_spill_key(head, min_head) < 0) {
+				min_head = head;
+				min_year = i;
+			}
+		}
+	}
+	if (min_head == NULL) {
+		*found = 0;
+		return OK;
+	}
+	*rec = *min_head;
+	*found = 1;
+	if (++spill->buf_pos[min_year] == spill->buf_len[min_year]) {
+		return fill_run_buf(spill, min_year);
+	}
+
+	return OK;}
+
+int close_year_spill(year_spill_struct *spill) {
+
+	int err = OK;
+
+	if (spill->fp != NULL) {
+		fclose(spill->fp);
+		spill->fp = NULL;
+		if (remove(spill->fname) != 0) {
+			fprintf(fplog, "Failed to remove %s: close_year_spill()\n", spill->fname);
+			err = ERROR_FILE;
+		}
+	}
+	free(spill->run_start);
+	free(spill->run_pos);
+	free(spill->buf_len);
+	free(spill->buf_pos);
+	free(spill->buf);
+	spill->run_start = NULL;
+	spill->run_pos = NULL;
+	spill->buf_len = NULL;
+	spill->buf_pos = NULL;
+	spill->buf = NULL;
+
+	return err;}
@@ -0,0 +1,1254 @@
+/**********
+ moirai_bench_data.c
+
+ generate a synthetic moirai input data set for performance measurement
+ 	the full input data set is too large to move around, so this writes files with the same names, formats,
+ 	variables, and layouts that the moirai readers expect, but with made-up values
+ 	the values are deterministic functions of the seed, so the same options always produce the same files
+
+ what is written (see the moirai readers for the formats):
+ 	all of the input csv files, with 87 ctry87 regions, 13 gtap uses, 32 gcam regions, and 2 fao countries per ctry87 region
+ 		plus a few countries without a ctry87 region; hong kong (302) and taiwan (303) are included
+ 	the binary rasters: cell area, land area, glu, original aez, potential vegetation, country, epa suitability/protection,
+ 		soil and vegetation carbon, and the water footprint .gri files
+ 	the netcdf files: sage crops (_AreaYieldProduction.nc), sage cropland, and isam land cover for each needed year
+ 	the ascii grids: hyde 3.2 land use for each hyde year, and the mirca harvested area files
+ 	the moirai input file moirai_input_bench.txt, which points at these files
+
+ the land mask, countries, glus, and land cover are defined at the isam 0.5 degree resolution
+ 	country and glu boundaries are jittered at the working resolution so that 0.5 degree cells are split
+ the hyde and isam years are grouped into num_years distinct data sets (e.g. 1700-1860 all share one data set)
+ 	only the first year of each group is written; the other years are hard links to it
+ 	the crops are grouped the same way into num_crop_files distinct sage crop files
+ 		the crops in a group share the sage file base name (and so the file and its netcdf variable) of the first crop
+ 	all mirca crops share one irrigated and one rainfed file, and all water footprint crops share one set of 4 files
+ 	note that hard-linked files may be served from the page cache, so use num_years = 47 and num_crop_files = num_crops
+ 		to measure cold i/o for every file
+
+ usage:
+ moirai_bench_data [-y num_years] [-c num_crops] [-k num_crop_files] [-g num_glus] [-r num_rows] [-b band_lulc_rows] [-s seed] out_dir
+
+ 	-y num_years:		number of distinct hyde/isam year data sets (1 to NUM_HYDE_YEARS); default 2
+ 	-c num_crops:		number of sage crops (1 to 175); default 175
+ 	-k num_crop_files:	number of distinct sage crop files (1 to num_crops); default 2
+ 	-g num_glus:		number of glus (geographic land units; at least NUM_ORIG_AEZ); default 235
+ 	-r num_rows:		number of working grid rows (a multiple of the 360 half-degree lulc rows); columns = 2 * rows; default 2160
+ 						the matching grid_res_sec is written to the input file
+ 	-b band_lulc_rows:	band_lulc_rows written to the input file (lulc rows per latitude band in the crop stages); default 0 = whole globe
+ 	-s seed:			random seed; default 1
+ 	out_dir:			output directory; it is created if needed and existing files are overwritten
+
+ 	the input files go in out_dir/indata/ and the moirai outputs go in out_dir/outputs/
+ 	run moirai from any directory with: moirai out_dir/moirai_input_bench.txt
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+ 
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+ 
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+ 
+ This file is part of Moirai.
+ 
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+ **********/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "moirai.h"
+#include <stdint.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#define NUM_BENCH_CTRY87		87		// number of gtap ctry87 regions; calc_rent_ag_use_aez() uses the vnm, hkg, and twn indices
+#define NUM_BENCH_CTRY_PER87	2		// fao countries per ctry87 region
+#define NUM_BENCH_CTRY_EXTRA	6		// fao countries without a ctry87 region
+#define NUM_BENCH_GCAM_RGN		32		// number of gcam regions
+#define NUM_BENCH_USE			13		// number of gtap uses; read_rent_orig() expects 87 x 13 records
+#define NUM_BENCH_CROP_USE		8		// the first 8 gtap uses are crops
+#define NUM_BENCH_PVLT			15		// number of sage potential vegetation types
+#define NUM_BENCH_LULC_LU		8		// number of isam land use types after the NUM_LULC_LC_TYPES land cover types
+#define NUM_BENCH_MAX_CROPS		175		// number of crops in the sage data set
+#define NUM_BENCH_SOIL			6		// number of soil carbon rasters
+#define NUM_BENCH_VEG			12		// number of above and below ground vegetation carbon rasters
+#define SAGE_NODATA				9E20	// sage netcdf nodata value
+#define HKG_CTRY87_IND			25		// hong kong ctry87 index; fao code 302
+#define TWN_CTRY87_IND			60		// taiwan ctry87 index; fao code 303
+#define VNM_CTRY87_IND			66		// vietnam ctry87 index
+
+// the hyde 3.2 land use types, in the order that proc_lulc_area() expects
+static const char *hyde_names[] = {"uopp_", "cropland", "grazing", "pasture", "rangeland", "ir_norice", "rf_norice",
+	"ir_rice", "rf_rice", "tot_irri", "tot_rainfed", "tot_rice"};
+#define NUM_BENCH_HYDE			12
+
+static const char *pvlt_names[] = {"Tropical Evergreen Forest/Woodland", "Tropical Deciduous Forest/Woodland",
+	"Temperate Broadleaf Evergreen Forest/Woodland", "Temperate Needleleaf Evergreen Forest/Woodland",
+	"Temperate Deciduous Forest/Woodland", "Boreal Evergreen Forest/Woodland", "Boreal Deciduous Forest/Woodland",
+	"Evergreen/Deciduous Mixed Forest/Woodland", "Savanna", "Grassland/Steppe", "Dense Shrubland", "Open Shrubland",
+	"Tundra", "Desert", "Polar Desert/Rock/Ice"};
+
+static const char *use_abbrs[] = {"pdr", "wht", "gro", "v_f", "osd", "c_b", "pfb", "ocr", "ctl", "oap", "rmk", "wol", "frs"};
+static const char *use_names[] = {"Paddy rice", "Wheat", "Cereal grains nec", "Vegetables fruit nuts", "Oil seeds",
+	"Sugar cane and sugar beet", "Plant-based fibers", "Crops nec", "Cattle sheep goats horses", "Animal products nec",
+	"Raw milk", "Wool silk-worm cocoons", "Forestry"};
+
+static const char *lu_lulc_names[] = {"urban", "c3 annual crop", "c4 annual crop", "c3 perennial crop", "c4 perennial crop",
+	"c3 nitrogen fixing crop", "pasture", "rangeland"};
+static const int lu_lulc_hyde[] = {1, 2, 2, 2, 2, 2, 3, 3};
+static const float lu_lulc_share[] = {0.02, 0.15, 0.1, 0.1, 0.05, 0.1, 0.2, 0.28};
+
+static const char *wf_crops[] = {"Barley", "Cassava", "Coconuts", "Coffee", "Cotton", "Groundnut", "Maize", "Millet",
+	"Oilpalm", "Olives", "Potatoes", "Rapeseed", "Rice", "Sorghum", "Soybean", "Sugarcane", "Sunflower", "Wheat"};
+static const char *wf_types[] = {"wfbl", "wfgn", "wfgy", "wftot"};
+
+static const char *soil_fnames[] = {"soil_carbon_weighted_average_95pct.bil", "soil_carbon_min_95pct.bil",
+	"soil_carbon_median_95pct.bil", "soil_carbon_max_95pct.bil", "soil_carbon_q1_95pct.bil", "soil_carbon_q3_95pct.bil"};
+static const char *veg_fnames[] = {"veg_carbon_wavg.bil", "veg_carbon_min.bil", "veg_carbon_median.bil",
+	"veg_carbon_max.bil", "veg_carbon_q1.bil", "veg_carbon_q3.bil",
+	"veg_BG_carbon_weighted_average.bil", "veg_BG_carbon_median.bil", "veg_BG_carbon_min.bil",
+	"veg_BG_carbon_max.bil", "veg_BG_carbon_q1.bil", "veg_BG_carbon_q3.bil"};
+// multiplier of the weighted average for each carbon statistic, in file order
+static const float soil_stat_scale[] = {1.0, 0.5, 0.95, 2.0, 0.75, 1.25};
+static const float veg_stat_scale[] = {1.0, 0.5, 0.95, 2.0, 0.75, 1.25, 1.0, 0.95, 0.5, 2.0, 0.75, 1.25};
+
+// generator settings
+static int num_years = 2;
+static int num_crops = NUM_BENCH_MAX_CROPS;
+static int num_crop_files = 2;
+static int num_glus = 235;
+static int nrows = 0;						// set from DEFAULT_GRID_RES_SEC unless given with -r
+static int band_lulc_rows = 0;				// written to the input file; 0 = no latitude bands
+static int ncols;
+static int ncells;
+static int scale;							// working cells per 0.5 degree cell, in each direction
+static uint64_t seed = 1;
+
+// output directories, with final "/"
+static char outdir[MAXCHAR];
+static char indir[MAXCHAR];
+static char sagedir[MAXCHAR];
+static char hydedir[MAXCHAR];
+static char isamdir[MAXCHAR];
+static char mircadir[MAXCHAR];
+static char wfdir[MAXCHAR];
+
+// 0.5 degree grids, upper left origin like the working grid
+static unsigned char *land_half;	// 1 = land
+static int *ctry_half;				// index into the country arrays; -1 = ocean
+static int *glu_half;				// glu code; -1 = ocean
+
+// countries
+static int num_ctry;
+static int *ctry_codes;
+static int *ctry_87ind;				// ctry87 index; -1 = none
+static char (*ctry_isos)[4];
+
+// working grids shared across writers
+static float *grid_cell_area;			// km^2
+static float *grid_land_area;		// km^2; NODATA for ocean
+
+// hash of two values and the seed, mapped to [0,1)
+static double hash_unit(uint64_t a, uint64_t b) {
+	uint64_t z = seed * 0x9E3779B97F4A7C15ULL + a * 0xBF58476D1CE4E5B9ULL + b * 0x94D049BB133111EBULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	z = z ^ (z >> 31);
+	return (double) (z >> 11) / 9007199254740992.0;
+}
+
+// build a file or directory name with snprintf; returns ERROR_FILE if it does not fit in MAXCHAR
+static int make_path(char *path, const char *format, ...) {
+	va_list ap;
+	int len;
+	va_start(ap, format);
+	len = vsnprintf(path, MAXCHAR, format, ap);
+	va_end(ap);
+	if (len < 0 || len >= MAXCHAR) {
+		fprintf(stderr, "Path longer than %i characters: %s: moirai_bench_data\n", MAXCHAR - 1, path);
+		return ERROR_FILE;
+	}
+	return OK;
+}
+
+static int make_dir(const char *path) {
+	if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+		fprintf(stderr, "Failed to create directory %s: moirai_bench_data\n", path);
+		return ERROR_FILE;
+	}
+	return OK;
+}
+
+// replace dst with a hard link to src
+static int link_file(const char *src, const char *dst) {
+	unlink(dst);
+	if (link(src, dst) != 0) {
+		fprintf(stderr, "Failed to link %s to %s: moirai_bench_data\n", dst, src);
+		return ERROR_FILE;
+	}
+	return OK;
+}
+
+static FILE *open_out(const char *dir, const char *name, const char *mode) {
+	char fname[MAXCHAR];
+	FILE *fpout;
+	if (make_path(fname, "%s%s", dir, name)) {
+		return NULL;
+	}
+	if ((fpout = fopen(fname, mode)) == NULL) {
+		fprintf(stderr, "Failed to open file %s: moirai_bench_data\n", fname);
+	}
+	return fpout;
+}
+
+static int write_bil(const char *name, const void *data, size_t size) {
+	FILE *fpout;
+	if ((fpout = open_out(indir, name, "wb")) == NULL) {
+		return ERROR_FILE;
+	}
+	if (fwrite(data, size, ncells, fpout) != (size_t) ncells) {
+		fprintf(stderr, "Failed to write file %s%s: moirai_bench_data\n", indir, name);
+		fclose(fpout);
+		return ERROR_FILE;
+	}
+	fclose(fpout);
+	return OK;
+}
+
+// first crop of the sage crop file group of crop j; the crops in a group share its file
+static int crop_file_first(int j) {
+	int d = j * num_crop_files / num_crops;
+	while (j > 0 && (j - 1) * num_crop_files / num_crops == d) {
+		j--;
+	}
+	return j;
+}
+
+// 0.5 degree cell containing working cell (row, col)
+static int half_index(int row, int col) {
+	return (row / scale) * NUM_LON_LULC + col / scale;
+}
+
+// the 0.5 degree cell whose country or glu is used for working cell i
+// 	the working cell is shifted by up to a quarter degree so that boundaries cut through 0.5 degree cells
+static int jitter_half(int i, int salt) {
+	int row = i / ncols;
+	int col = i % ncols;
+	int home = half_index(row, col);
+	int jrow = row + (int) ((hash_unit(i, salt) - 0.5) * scale);
+	int jcol = col + (int) ((hash_unit(i, salt + 1) - 0.5) * scale);
+	int jind;
+	if (jrow < 0 || jrow >= nrows) {
+		return home;
+	}
+	jcol = (jcol + ncols) % ncols;
+	jind = half_index(jrow, jcol);
+	return land_half[jind] ? jind : home;
+}
+
+// land if a smooth function of lat and lon is above a threshold; about 30% of the globe
+static void make_land(void) {
+	int r, c;
+	double lat, lon;
+	double f;
+	double p[6];
+	for (r = 0; r < 6; r++) {
+		p[r] = 2 * PI * hash_unit(r, 1);
+	}
+	for (r = 0; r < NUM_LAT_LULC; r++) {
+		lat = (90.0 - (r + 0.5) * 0.5) * DEG2RAD;
+		for (c = 0; c < NUM_LON_LULC; c++) {
+			lon = (-180.0 + (c + 0.5) * 0.5) * DEG2RAD;
+			f = sin(3 * lon + p[0]) * cos(2 * lat + p[1]) + 0.6 * sin(7 * lon + p[2]) * sin(5 * lat + p[3]) +
+				0.3 * sin(13 * lon + 11 * lat + p[4]) + 0.2 * cos(17 * lon + p[5]) * cos(19 * lat);
+			land_half[r * NUM_LON_LULC + c] = (f > 0.45 && fabs(lat) < 84.0 * DEG2RAD) ? 1 : 0;
+		}
+	}
+}
+
+// assign each land 0.5 degree cell to the nearest of num_seeds seed cells on land
+static int make_voronoi(int num_seeds, int salt, int *owner) {
+	int i, j, k;
+	int *seed_ind;
+	int num_land = 0;
+	int *land_list;
+	double lat, dlat, dlon, dist, best;
+
+	land_list = calloc(NUM_CELLS_LULC, sizeof(int));
+	seed_ind = calloc(num_seeds, sizeof(int));
+	if (land_list == NULL || seed_ind == NULL) {
+		fprintf(stderr, "Failed to allocate memory for voronoi seeds: moirai_bench_data\n");
+		return ERROR_MEM;
+	}
+	for (i = 0; i < NUM_CELLS_LULC; i++) {
+		if (land_half[i]) {
+			land_list[num_land++] = i;
+		}
+	}
+	if (num_land < num_seeds) {
+		fprintf(stderr, "Only %i land cells for %i regions: moirai_bench_data\n", num_land, num_seeds);
+		return ERROR_CALC;
+	}
+	// partial shuffle to pick distinct seed cells
+	for (k = 0; k < num_seeds; k++) {
+		j = k + (int) (hash_unit(k, salt) * (num_land - k));
+		i = land_list[k];
+		land_list[k] = land_list[j];
+		land_list[j] = i;
+		seed_ind[k] = land_list[k];
+	}
+	for (i = 0; i < NUM_CELLS_LULC; i++) {
+		owner[i] = -1;
+		if (!land_half[i]) {
+			continue;
+		}
+		lat = 90.0 - (i / NUM_LON_LULC + 0.5) * 0.5;
+		best = 1e30;
+		for (k = 0; k < num_seeds; k++) {
+			dlat = (i / NUM_LON_LULC - seed_ind[k] / NUM_LON_LULC) * 0.5;
+			dlon = fabs((double) (i % NUM_LON_LULC - seed_ind[k] % NUM_LON_LULC)) * 0.5;
+			if (dlon > 180.0) {
+				dlon = 360.0 - dlon;
+			}
+			dlon = dlon * cos(lat * DEG2RAD);
+			dist = dlat * dlat + dlon * dlon;
+			if (dist < best) {
+				best = dist;
+				owner[i] = k;
+			}
+		}
+	}
+	free(land_list);
+	free(seed_ind);
+	return OK;
+}
+
+static int make_countries(void) {
+	int i, j, k;
+	num_ctry = NUM_BENCH_CTRY87 * NUM_BENCH_CTRY_PER87 + NUM_BENCH_CTRY_EXTRA;
+	ctry_codes = calloc(num_ctry, sizeof(int));
+	ctry_87ind = calloc(num_ctry, sizeof(int));
+	ctry_isos = calloc(num_ctry, sizeof(*ctry_isos));
+	if (ctry_codes == NULL || ctry_87ind == NULL || ctry_isos == NULL) {
+		fprintf(stderr, "Failed to allocate memory for countries: moirai_bench_data\n");
+		return ERROR_MEM;
+	}
+	for (k = 0; k < num_ctry; k++) {
+		// codes stay below the serbia and montenegro codes (186, 272, 273)
+		ctry_codes[k] = k + 1;
+		ctry_87ind[k] = (k < NUM_BENCH_CTRY87 * NUM_BENCH_CTRY_PER87) ? k / NUM_BENCH_CTRY_PER87 : -1;
+		sprintf(ctry_isos[k], "x%c%c", 'a' + (k / 26) % 26, 'a' + k % 26);
+	}
+	k = HKG_CTRY87_IND * NUM_BENCH_CTRY_PER87;
+	ctry_codes[k] = 302;
+	strcpy(ctry_isos[k], "hkg");
+	k = TWN_CTRY87_IND * NUM_BENCH_CTRY_PER87;
+	ctry_codes[k] = 303;
+	strcpy(ctry_isos[k], "twn");
+	k = VNM_CTRY87_IND * NUM_BENCH_CTRY_PER87;
+	strcpy(ctry_isos[k], "vnm");
+
+	if ((i = make_voronoi(num_ctry, 100, ctry_half)) != OK) {
+		return i;
+	}
+	if ((i = make_voronoi(num_glus, 200, glu_half)) != OK) {
+		return i;
+	}
+	// glu codes are 1-based
+	for (j = 0; j < NUM_CELLS_LULC; j++) {
+		if (glu_half[j] >= 0) {
+			glu_half[j]++;
+		}
+	}
+	return OK;
+}
+
+/***** csv files *****/
+
+static int write_csv_files(void) {
+	int i, j, k, y;
+	int use;
+	double v, ha, yld;
+	FILE *fp;
+	const int elem_codes[] = {5510, 5419, 5312, 5532};
+	const char *elem_names[] = {"Production", "Yield", "Area harvested", "Producer Price (USD/tonne)"};
+	const char *elem_units[] = {"tonnes", "hg/ha", "ha", "USD"};
+	const char *fao_fnames[] = {"FAO_production_1993_2016.csv", "FAO_yield_1993_2016.csv",
+		"FAO_harvarea_1993_2016.csv", "FAO_producerprice_1993_2016.csv"};
+
+	// fao countries and iso
+	if ((fp = open_out(indir, "FAO_iso_VMAP0_ctry.csv", "w")) == NULL) { return ERROR_FILE; }
+	fprintf(fp, "fao_code,iso3_abbr,fao_name,vmap0_code,vmap0_name\n");
+	for (k = 0; k < num_ctry; k++) {
+		fprintf(fp, "%i,%s,Country %i,%i,Country %i\n", ctry_codes[k], ctry_isos[k], ctry_codes[k], ctry_codes[k], ctry_codes[k]);
+	}
+	fclose(fp);
+
+	// gtap ctry87
+	if ((fp = open_out(indir, "GTAP_GCAM_ctry87.csv", "w")) == NULL) { return ERROR_FILE; }
+	fprintf(fp, "ctry87_code,ctry87_abbr,ctry87_name\n");
+	for (j = 0; j < NUM_BENCH_CTRY87; j++) {
+		fprintf(fp, "%i,%s,Region87 %i\n", j + 1, ctry_isos[j * NUM_BENCH_CTRY_PER87], j + 1);
+	}
+	fclose(fp);
+
+	// fao country to ctry87; same order as the country list
+	if ((fp = open_out(indir, "FAO_ctry_GCAM_ctry87.csv", "w")) == NULL) { return ERROR_FILE; }
+	fprintf(fp, "fao_code,iso3_abbr,fao_name,ctry87_code,ctry87_abbr\n");
+	for (k = 0; k < num_ctry; k++) {
+		if (ctry_87ind[k] >= 0) {
+			fprintf(fp, "%i,%s,Country %i,%i,%s\n", ctry_codes[k], ctry_isos[k], ctry_codes[k], ctry_87ind[k] + 1,
+					ctry_isos[ctry_87ind[k] * NUM_BENCH_CTRY_PER87]);
+		} else {
+			fprintf(fp, "%i,%s,Country %i,%i,%s\n", ctry_codes[k], ctry_isos[k], ctry_codes[k], NOMATCH, NA_TEXT);
+		}
+	}
+	fclose(fp);
+
+	// gcam regions; 4 header lines
+	if ((fp = open_out(indir, "GCAM_region_names_32reg.csv", "w")) == NULL) { return ERROR_FILE; }
+	fprintf(fp, "# File: GCAM_region_names_32reg.csv\n# Title: synthetic GCAM region names\n# Column types: in\nGCAM_region_ID,region\n");
+	for (j = 0; j < NUM_BENCH_GCAM_RGN; j++) {
+		fprintf(fp, "%i,Region %i\n", j + 1, j + 1);
+	}
+	fclose(fp);
+
+	// iso to gcam region; 4 header lines; countries without a ctry87 region are not listed
+	if ((fp = open_out(indir, "iso_GCAM_regID_32reg.csv", "w")) == NULL) { return ERROR_FILE; }
+	fprintf(fp, "# File: iso_GCAM_regID_32reg.csv\n# Title: synthetic iso to GCAM region mapping\n# Column types: ccci\niso,country_name,region_GCAM3,GCAM_region_ID\n");
+	for (k = 0; k < num_ctry; k++) {
+		if (ctry_87ind[k] >= 0) {
+			fprintf(fp, "%s,Country %i,Region %i,%i\n", ctry_isos[k], ctry_codes[k],
+					ctry_87ind[k] % NUM_BENCH_GCAM_RGN + 1, ctry_87ind[k] % NUM_BENCH_GCAM_RGN + 1);
+		}
+	}
+	fclose(fp);
+
+	// glus
+	if ((fp = open_out(indir, "GLU_bench.csv", "w")) == NULL) { return ERROR_FILE; }
+	fprintf(fp, "glu_code,glu_name\n");
+	for (j = 0; j < num_glus; j++) {
+		fprintf(fp, "%i,GLU%03i\n", j + 1, j + 1);
+	}
+	fclose(fp);
+
+	// gtap uses
+	if ((fp = open_out(indir, "GTAP_use.csv", "w")) == NULL) { return ERROR_FILE; }
+	fprintf(fp, "gtap_use_code,gtap_use_name,gtap_use_description\n");
+	for (j = 0; j < NUM_BENCH_USE; j++) {
+		fprintf(fp, "%i,%s,%s\n", j + 1, use_abbrs[j], use_names[j]);
+	}
+	fclose(fp);
+
+	// sage potential vegetation; 4 header lines
+	if ((fp = open_out(indir, "SAGE_PVLT.csv", "w")) == NULL) { return ERROR_FILE; }
+	fprintf(fp, "# File: SAGE_PVLT.csv\n# Title: SAGE potential vegetation land types\n# Column types: ic\nsage_code,sage_name\n");
+	for (j = 0; j < NUM_BENCH_PVLT; j++) {
+		fprintf(fp, "%i,%s\n", j + 1, pvlt_names[j]);
+	}
+	fclose(fp);
+
+	// hyde land use types
+	if ((fp = open_out(indir, "hyde32_lu.csv", "w")) == NULL) { return ERROR_FILE; }
+	fprintf(fp, "hyde_code,hyde_name\n");
+	for (j = 0; j < NUM_BENCH_HYDE; j++) {
+		fprintf(fp, "%i,%s\n", j + 1, hyde_names[j]);
+	}
+	fclose(fp);
+
+	// isam land cover (mapped to sage) and land use (mapped to hyde) types
+	if ((fp = open_out(indir, "isam_2_sage_hyde_mapping.csv", "w")) == NULL) { return ERROR_FILE; }
+	fprintf(fp, "isam_code,isam_name,mapped_code,mapped_name\n");
+	for (j = 0; j < NUM_LULC_LC_TYPES; j++) {
+		// the last land cover type (e.g. water/ice) has no sage type
+		if (j == NUM_LULC_LC_TYPES - 1) {
+			fprintf(fp, "%i,isam land cover %i,%i,%s\n", j + 1, j + 1, NOMATCH, NA_TEXT);
+		} else {
+			fprintf(fp, "%i,isam land cover %i,%i,%s\n", j + 1, j + 1, j % NUM_BENCH_PVLT + 1, pvlt_names[j % NUM_BENCH_PVLT]);
+		}
+	}
+	for (j = 0; j < NUM_BENCH_LULC_LU; j++) {
+		fprintf(fp, "%i,%s,%i,%s\n", NUM_LULC_LC_TYPES + j + 1, lu_lulc_names[j], lu_lulc_hyde[j], hyde_names[lu_lulc_hyde[j] - 1]);
+	}
+	fclose(fp);
+
+	// sage crops
+	if ((fp = open_out(indir, "SAGE_gtap_fao_crop2use.csv", "w")) == NULL) { return ERROR_FILE; }
+	fprintf(fp, "sage_code,sage_filebase,sage_description,gtap_crop,gtap_use_code,gtap_use_name,fao_code,fao_name\n");
+	for (j = 0; j < num_crops; j++) {
+		use = j % NUM_BENCH_CROP_USE;
+		fprintf(fp, "%i,crop%03i,synthetic crop %i,%s,%i,%s,%i,Crop %03i\n", j + 1, crop_file_first(j) + 1, j + 1, use_abbrs[use], use + 1,
+				use_abbrs[use], 1000 + j, j + 1);
+	}
+	fclose(fp);
+
+	// fao statistics; (value, flag) pairs for each year
+	for (i = 0; i < 4; i++) {
+		if ((fp = open_out(indir, fao_fnames[i], "w")) == NULL) { return ERROR_FILE; }
+		fprintf(fp, "CountryCode,Country,ItemCode,Item,ElementCode,Element,Unit");
+		for (y = FAO_START_YEAR; y <= FAO_END_YEAR; y++) {
+			fprintf(fp, ",Y%i,Y%iF", y, y);
+		}
+		fprintf(fp, "\n");
+		for (k = 0; k < num_ctry; k++) {
+			for (j = 0; j < num_crops; j++) {
+				if (hash_unit(k * NUM_BENCH_MAX_CROPS + j, 300) > 0.7) {
+					continue;
+				}
+				fprintf(fp, "%i,Country %i,%i,Crop %03i,%i,%s,%s", ctry_codes[k], ctry_codes[k], 1000 + j, j + 1,
+						elem_codes[i], elem_names[i], elem_units[i]);
+				for (y = 0; y < NUM_FAO_YRS; y++) {
+					ha = 100.0 + 100000.0 * hash_unit(k * NUM_BENCH_MAX_CROPS + j, 301) * (1.0 + 0.01 * y);
+					yld = 5000.0 + 50000.0 * hash_unit(k * NUM_BENCH_MAX_CROPS + j, 302) * (1.0 + 0.005 * y);
+					switch (i) {
+						case 0: v = ha * yld / 10000.0; break;
+						case 1: v = yld; break;
+						case 2: v = ha; break;
+						default: v = 50.0 + 500.0 * hash_unit(k * NUM_BENCH_MAX_CROPS + j, 303) * (1.0 + 0.02 * y); break;
+					}
+					fprintf(fp, ",%.0f,", v);
+				}
+				fprintf(fp, "\n");
+			}
+		}
+		fclose(fp);
+	}
+
+	// gtap land rent (million USD); 6 header lines; ctry87 x use records
+	if ((fp = open_out(indir, "GTAP_value_milUSD.csv", "w")) == NULL) { return ERROR_FILE; }
+	fprintf(fp, "# File: GTAP_value_milUSD.csv\n# Title: synthetic GTAP land rent\n# Units: million USD\n");
+	fprintf(fp, "# Source: moirai_bench_data\n# Column types: ii%s\nctry87,use", "nnnnnnnnnnnnnnnnnn");
+	for (j = 0; j < NUM_ORIG_AEZ; j++) {
+		fprintf(fp, ",AEZ%i", j + 1);
+	}
+	fprintf(fp, "\n");
+	for (k = 0; k < NUM_BENCH_CTRY87; k++) {
+		for (use = 0; use < NUM_BENCH_USE; use++) {
+			fprintf(fp, "%i,%i", k + 1, use + 1);
+			for (j = 0; j < NUM_ORIG_AEZ; j++) {
+				v = hash_unit((k * NUM_BENCH_USE + use) * NUM_ORIG_AEZ + j, 310);
+				fprintf(fp, ",%.4f", (v < 0.3) ? 0.0 : 20.0 * v);
+			}
+			fprintf(fp, "\n");
+		}
+	}
+	fclose(fp);
+
+	// consumer price index
+	if ((fp = open_out(indir, "cpi_bench.csv", "w")) == NULL) { return ERROR_FILE; }
+	fprintf(fp, "year,cpi\n");
+	for (y = 1970; y <= 2017; y++) {
+		fprintf(fp, "%i,%.3f\n", y, 38.8 * pow(1.04, y - 1970));
+	}
+	fclose(fp);
+
+	return OK;
+}
+
+/***** binary rasters *****/
+
+static int write_rasters(void) {
+	int i, j, p, err;
+	int row;
+	double lat1, lat2;
+	double a, b, c;
+	float *fbuf;
+	int *ibuf;
+	short *sbuf;
+	float *epa[6];
+	const char *epa_fnames[] = {"L1_processed.bil", "L2_processed.bil", "L3_processed.bil", "L4_processed.bil",
+		"All_IUCN_processed.bil", "1a_1b_2_processed.bil"};
+
+	fbuf = calloc(ncells, sizeof(float));
+	ibuf = calloc(ncells, sizeof(int));
+	sbuf = calloc(ncells, sizeof(short));
+	if (fbuf == NULL || ibuf == NULL || sbuf == NULL) {
+		fprintf(stderr, "Failed to allocate memory for raster buffers: moirai_bench_data\n");
+		return ERROR_MEM;
+	}
+
+	// spherical earth cell area (km^2), as in get_cell_area()
+	for (i = 0; i < ncells; i++) {
+		row = i / ncols;
+		lat1 = 90.0 - row * 180.0 / nrows;
+		lat2 = lat1 - 180.0 / nrows;
+		grid_cell_area[i] = MSQ2KMSQ * AVE_ER * AVE_ER * (360.0 / ncols) * DEG2RAD * fabs(sin(lat2 * DEG2RAD) - sin(lat1 * DEG2RAD));
+	}
+	if ((err = write_bil("hyde_cell_plus.bil", grid_cell_area, sizeof(float)))) { return err; }
+
+	// sage land fraction and hyde land area
+	for (i = 0; i < ncells; i++) {
+		p = half_index(i / ncols, i % ncols);
+		fbuf[i] = land_half[p] ? 0.7 + 0.3 * hash_unit(i, 1) : NODATA;
+		grid_land_area[i] = land_half[p] ? grid_cell_area[i] * (0.7 + 0.3 * hash_unit(i, 2)) : NODATA;
+	}
+	if ((err = write_bil("sage_land_frac.bil", fbuf, sizeof(float)))) { return err; }
+	if ((err = write_bil("hyde_land_plus.bil", grid_land_area, sizeof(float)))) { return err; }
+
+	// glus, original aezs, potential vegetation, and countries
+	for (i = 0; i < ncells; i++) {
+		p = half_index(i / ncols, i % ncols);
+		ibuf[i] = land_half[p] ? glu_half[jitter_half(i, 10)] : NODATA;
+	}
+	if ((err = write_bil("GLU_bench.gri", ibuf, sizeof(int)))) { return err; }
+	for (i = 0; i < ncells; i++) {
+		p = half_index(i / ncols, i % ncols);
+		ibuf[i] = land_half[p] ? 1 + (int) (NUM_ORIG_AEZ * hash_unit(p, 3)) : NODATA;
+	}
+	if ((err = write_bil("AEZ_orig_bench.gri", ibuf, sizeof(int)))) { return err; }
+	for (i = 0; i < ncells; i++) {
+		p = half_index(i / ncols, i % ncols);
+		ibuf[i] = land_half[p] ? 1 + (int) (NUM_BENCH_PVLT * hash_unit(p, 4)) : NODATA;
+	}
+	if ((err = write_bil("potveg_plus.bil", ibuf, sizeof(int)))) { return err; }
+	for (i = 0; i < ncells; i++) {
+		p = half_index(i / ncols, i % ncols);
+		sbuf[i] = land_half[p] ? (short) ctry_codes[ctry_half[jitter_half(i, 20)]] : NODATA;
+	}
+	if ((err = write_bil("fao_ctry_rast.bil", sbuf, sizeof(short)))) { return err; }
+
+	// epa suitability and protection fractions; every cell, including ocean, must have valid nested fractions:
+	// 	L4 <= L2 <= L3 <= L1, IUCN 1a/1b/2 >= L1 - L2, all IUCN >= IUCN 1a/1b/2 + L2 - L4, all IUCN + L4 <= 1
+	for (j = 0; j < 6; j++) {
+		if ((epa[j] = calloc(ncells, sizeof(float))) == NULL) {
+			fprintf(stderr, "Failed to allocate memory for epa rasters: moirai_bench_data\n");
+			return ERROR_MEM;
+		}
+	}
+	for (i = 0; i < ncells; i++) {
+		p = half_index(i / ncols, i % ncols);
+		if (!land_half[p]) {
+			continue;
+		}
+		a = 0.5 * hash_unit(i, 5);
+		b = 0.4 * a + 0.2 * hash_unit(i, 6);
+		c = b + 0.1 * a + 0.1 * hash_unit(i, 7);
+		epa[0][i] = a;
+		epa[1][i] = 0.6 * a;
+		epa[2][i] = 0.8 * a;
+		epa[3][i] = 0.5 * a;
+		epa[4][i] = c;
+		epa[5][i] = b;
+	}
+	for (j = 0; j < 6; j++) {
+		if ((err = write_bil(epa_fnames[j], epa[j], sizeof(float)))) { return err; }
+		free(epa[j]);
+	}
+
+	// soil carbon (kg/m^2) and vegetation carbon (scaled by 1 / VEG_CARBON_SCALER)
+	for (j = 0; j < NUM_BENCH_SOIL; j++) {
+		for (i = 0; i < ncells; i++) {
+			p = half_index(i / ncols, i % ncols);
+			fbuf[i] = land_half[p] ? soil_stat_scale[j] * (2.0 + 30.0 * hash_unit(p, 8)) : NODATA;
+		}
+		if ((err = write_bil(soil_fnames[j], fbuf, sizeof(float)))) { return err; }
+	}
+	for (j = 0; j < NUM_BENCH_VEG; j++) {
+		for (i = 0; i < ncells; i++) {
+			p = half_index(i / ncols, i % ncols);
+			fbuf[i] = land_half[p] ? veg_stat_scale[j] * (j < 6 ? 10.0 : 3.0) * (1.0 + 150.0 * hash_unit(p, 9)) : NODATA;
+		}
+		if ((err = write_bil(veg_fnames[j], fbuf, sizeof(float)))) { return err; }
+	}
+
+	free(fbuf);
+	free(ibuf);
+	free(sbuf);
+	return OK;
+}
+
+/***** water footprint and mirca *****/
+
+static int write_water_footprint(void) {
+	int i, j, k, p;
+	char fname[MAXCHAR];
+	char first[MAXCHAR];
+	FILE *fp;
+	float *fbuf;
+
+	if ((fbuf = calloc(ncells, sizeof(float))) == NULL) {
+		fprintf(stderr, "Failed to allocate memory for water footprint: moirai_bench_data\n");
+		return ERROR_MEM;
+	}
+	for (j = 0; j < NUM_WF_CROPS; j++) {
+		if (make_path(fname, "%s%s", wfdir, wf_crops[j]) || make_dir(fname)) { return ERROR_FILE; }
+	}
+	// the first crop has the data; the other crops link to it
+	for (k = 0; k < NUM_WF_TYPES; k++) {
+		for (i = 0; i < ncells; i++) {
+			p = half_index(i / ncols, i % ncols);
+			fbuf[i] = (land_half[p] && hash_unit(i, 40) < 0.3) ? 1000.0 * hash_unit(i, 41 + k) : NODATA;
+		}
+		if (make_path(first, "%s%s/%s_mmyr.gri", wfdir, wf_crops[0], wf_types[k])) { return ERROR_FILE; }
+		if ((fp = fopen(first, "wb")) == NULL) {
+			fprintf(stderr, "Failed to open file %s: moirai_bench_data\n", first);
+			return ERROR_FILE;
+		}
+		if (fwrite(fbuf, sizeof(float), ncells, fp) != (size_t) ncells) {
+			fprintf(stderr, "Failed to write file %s: moirai_bench_data\n", first);
+			fclose(fp);
+			return ERROR_FILE;
+		}
+		fclose(fp);
+		for (j = 1; j < NUM_WF_CROPS; j++) {
+			if (make_path(fname, "%s%s/%s_mmyr.gri", wfdir, wf_crops[j], wf_types[k]) || link_file(first, fname)) {
+				return ERROR_FILE;
+			}
+		}
+	}
+	free(fbuf);
+	return OK;
+}
+
+// arc/info ascii grid header
+static void write_asc_header(FILE *fp, int nodata) {
+	fprintf(fp, "ncols %i\nnrows %i\nxllcorner -180\nyllcorner -90\ncellsize %.15f\nNODATA_value %i\n",
+			ncols, nrows, 180.0 / nrows, nodata);
+}
+
+// write one grid row per line
+static int write_asc_values(FILE *fp, const float *data, const char *fname) {
+	int r, c;
+	for (r = 0; r < nrows; r++) {
+		for (c = 0; c < ncols; c++) {
+			if (data[r * ncols + c] == 0) {
+				fputs(c ? " 0" : "0", fp);
+			} else {
+				fprintf(fp, c ? " %.6g" : "%.6g", data[r * ncols + c]);
+			}
+		}
+		fputc('\n', fp);
+	}
+	if (ferror(fp)) {
+		fprintf(stderr, "Failed to write file %s: moirai_bench_data\n", fname);
+		return ERROR_FILE;
+	}
+	return OK;
+}
+
+static int write_mirca(void) {
+	int i, j, k, p, err;
+	char fname[MAXCHAR];
+	char first[MAXCHAR];
+	const char *bases[] = {"ANNUAL_AREA_HARVESTED_IRC_CROP", "ANNUAL_AREA_HARVESTED_RFC_CROP"};
+	FILE *fp;
+	float *fbuf;
+
+	if ((fbuf = calloc(ncells, sizeof(float))) == NULL) {
+		fprintf(stderr, "Failed to allocate memory for mirca: moirai_bench_data\n");
+		return ERROR_MEM;
+	}
+	// harvested area (ha); the first crop has the data and the other crops link to it
+	for (k = 0; k < 2; k++) {
+		for (i = 0; i < ncells; i++) {
+			p = half_index(i / ncols, i % ncols);
+			fbuf[i] = (land_half[p] && hash_unit(i, 50 + k) < 0.25) ? (float) (int) (1 + 100.0 * hash_unit(i, 52)) : 0;
+		}
+		if (make_path(first, "%s%s1_HA.ASC", mircadir, bases[k])) { return ERROR_FILE; }
+		if ((fp = fopen(first, "w")) == NULL) {
+			fprintf(stderr, "Failed to open file %s: moirai_bench_data\n", first);
+			return ERROR_FILE;
+		}
+		write_asc_header(fp, -9);
+		err = write_asc_values(fp, fbuf, first);
+		fclose(fp);
+		if (err != OK) { return err; }
+		for (j = 2; j <= NUM_MIRCA_CROPS; j++) {
+			if (make_path(fname, "%s%s%i_HA.ASC", mircadir, bases[k], j) || link_file(first, fname)) {
+				return ERROR_FILE;
+			}
+		}
+	}
+	free(fbuf);
+	return OK;
+}
+
+/***** hyde and isam years *****/
+
+// the hyde years, as in proc_land_type_area()
+static void get_hyde_years(int *hyde_years) {
+	int i;
+	hyde_years[0] = HYDE_START_YEAR;
+	for (i = 1; i < NUM_HYDE_YEARS - NUM_HYDE_POST2000_YEARS; i++) {
+		hyde_years[i] = hyde_years[i - 1] + 10;
+	}
+	for (; i < NUM_HYDE_YEARS; i++) {
+		hyde_years[i] = hyde_years[i - 1] + 1;
+	}
+}
+
+// land use intensity for a data set year; 0 at HYDE_START_YEAR, 1 at the last hyde year
+static double year_intensity(int year, int last_year) {
+	return 0.1 + 0.9 * (double) (year - HYDE_START_YEAR) / (double) (last_year - HYDE_START_YEAR);
+}
+
+static int write_hyde(void) {
+	int hyde_years[NUM_HYDE_YEARS];
+	int m, d, k, i, err;
+	int first_m = 0;
+	int cur_set = -1;
+	double t, crop, graz, rice, irr;
+	char name[MAXCHAR];
+	char fname[MAXCHAR];
+	char first[MAXCHAR];
+	FILE *fp;
+	float *fbuf;
+
+	if ((fbuf = calloc(ncells, sizeof(float))) == NULL) {
+		fprintf(stderr, "Failed to allocate memory for hyde: moirai_bench_data\n");
+		return ERROR_MEM;
+	}
+	get_hyde_years(hyde_years);
+	for (m = 0; m < NUM_HYDE_YEARS; m++) {
+		d = m * num_years / NUM_HYDE_YEARS;
+		if (d != cur_set) {
+			// write the data set for the first year in this group
+			cur_set = d;
+			first_m = m;
+			t = year_intensity(hyde_years[m], hyde_years[NUM_HYDE_YEARS - 1]);
+			fprintf(stdout, "hyde data set %i: year %i\n", d, hyde_years[m]);
+			for (k = 0; k < NUM_BENCH_HYDE; k++) {
+				for (i = 0; i < ncells; i++) {
+					if (grid_land_area[i] == NODATA) {
+						fbuf[i] = NODATA;
+						continue;
+					}
+					crop = grid_land_area[i] * 0.3 * t * hash_unit(i, 60);
+					graz = grid_land_area[i] * 0.35 * t * hash_unit(i, 61);
+					rice = crop * 0.2 * hash_unit(i, 62);
+					irr = 0.3 * hash_unit(i, 63);
+					switch (k) {
+						case 0: fbuf[i] = grid_land_area[i] * 0.02 * t * hash_unit(i, 64); break;
+						case 1: fbuf[i] = crop; break;
+						case 2: fbuf[i] = graz; break;
+						case 3: fbuf[i] = 0.4 * graz; break;
+						case 4: fbuf[i] = 0.6 * graz; break;
+						case 5: fbuf[i] = (crop - rice) * irr; break;
+						case 6: fbuf[i] = (crop - rice) * (1 - irr); break;
+						case 7: fbuf[i] = rice * irr; break;
+						case 8: fbuf[i] = rice * (1 - irr); break;
+						case 9: fbuf[i] = crop * irr; break;
+						case 10: fbuf[i] = crop * (1 - irr); break;
+						default: fbuf[i] = rice; break;
+					}
+				}
+				sprintf(name, "%s%iAD.asc", hyde_names[k], hyde_years[m]);
+				if ((fp = open_out(hydedir, name, "w")) == NULL) { return ERROR_FILE; }
+				write_asc_header(fp, NODATA);
+				err = write_asc_values(fp, fbuf, name);
+				fclose(fp);
+				if (err != OK) { return err; }
+			}
+		} else {
+			for (k = 0; k < NUM_BENCH_HYDE; k++) {
+				if (make_path(first, "%s%s%iAD.asc", hydedir, hyde_names[k], hyde_years[first_m]) ||
+					make_path(fname, "%s%s%iAD.asc", hydedir, hyde_names[k], hyde_years[m]) || link_file(first, fname)) {
+					return ERROR_FILE;
+				}
+			}
+		}
+	}
+	free(fbuf);
+	return OK;
+}
+
+#define NC_CHECK(call) if ((ncerr = (call))) { \
+	fprintf(stderr, "Error %i (%s) writing netcdf file %s: moirai_bench_data\n", ncerr, nc_strerror(ncerr), fname); \
+	return ERROR_FILE; }
+
+// isam land cover file; lat from -90 and lon from 0, as read by read_lulc_isam()
+static int write_isam_file(const char *fname, int year, int last_year) {
+	int ncid, ncerr;
+	int dimids[3];
+	int area_id, frac_id, mask_id, lat_id, lon_id;
+	int i, j, r, c, p;
+	int num_lulc = NUM_LULC_LC_TYPES + NUM_BENCH_LULC_LU;
+	int dom, sub;
+	double t, lu_total;
+	double lat1, lat2;
+	float *area, *frac, *lat, *lon;
+	int *mask;
+
+	area = calloc(NUM_CELLS_LULC, sizeof(float));
+	frac = calloc((size_t) num_lulc * NUM_CELLS_LULC, sizeof(float));
+	mask = calloc(NUM_CELLS_LULC, sizeof(int));
+	lat = calloc(NUM_LAT_LULC, sizeof(float));
+	lon = calloc(NUM_LON_LULC, sizeof(float));
+	if (area == NULL || frac == NULL || mask == NULL || lat == NULL || lon == NULL) {
+		fprintf(stderr, "Failed to allocate memory for isam: moirai_bench_data\n");
+		return ERROR_MEM;
+	}
+	t = year_intensity(year, last_year);
+	for (r = 0; r < NUM_LAT_LULC; r++) {
+		lat[r] = -90.0 + (r + 0.5) * 0.5;
+		lat1 = -90.0 + r * 0.5;
+		lat2 = lat1 + 0.5;
+		for (c = 0; c < NUM_LON_LULC; c++) {
+			lon[c] = (c + 0.5) * 0.5;
+			i = r * NUM_LON_LULC + c;
+			// the matching upper-left-origin 0.5 degree cell
+			p = (NUM_LAT_LULC - 1 - r) * NUM_LON_LULC + ((c < NUM_LON_LULC / 2) ? c + NUM_LON_LULC / 2 : c - NUM_LON_LULC / 2);
+			area[i] = AVE_ER * AVE_ER * 0.5 * DEG2RAD * fabs(sin(lat2 * DEG2RAD) - sin(lat1 * DEG2RAD));
+			mask[i] = land_half[p];
+			if (!land_half[p]) {
+				continue;
+			}
+			// fractions are in units of 0.0001 and sum to 10000
+			lu_total = 0.6 * t * hash_unit(p, 70);
+			for (j = 0; j < NUM_BENCH_LULC_LU; j++) {
+				frac[(size_t) (NUM_LULC_LC_TYPES + j) * NUM_CELLS_LULC + i] = 10000.0 * lu_total * lu_lulc_share[j];
+			}
+			dom = (int) ((NUM_LULC_LC_TYPES - 1) * hash_unit(p, 71));
+			sub = (int) ((NUM_LULC_LC_TYPES - 1) * hash_unit(p, 72));
+			frac[(size_t) dom * NUM_CELLS_LULC + i] += 10000.0 * (1.0 - lu_total) * 0.7;
+			frac[(size_t) sub * NUM_CELLS_LULC + i] += 10000.0 * (1.0 - lu_total) * 0.3;
+		}
+	}
+
+	NC_CHECK(nc_create(fname, NC_CLOBBER | NC_64BIT_OFFSET, &ncid));
+	NC_CHECK(nc_def_dim(ncid, "lctype", num_lulc, &dimids[0]));
+	NC_CHECK(nc_def_dim(ncid, "lat", NUM_LAT_LULC, &dimids[1]));
+	NC_CHECK(nc_def_dim(ncid, "lon", NUM_LON_LULC, &dimids[2]));
+	NC_CHECK(nc_def_var(ncid, "lat", NC_FLOAT, 1, &dimids[1], &lat_id));
+	NC_CHECK(nc_def_var(ncid, "lon", NC_FLOAT, 1, &dimids[2], &lon_id));
+	NC_CHECK(nc_def_var(ncid, "Grid_area", NC_FLOAT, 2, &dimids[1], &area_id));
+	NC_CHECK(nc_def_var(ncid, "LC_fraction", NC_FLOAT, 3, dimids, &frac_id));
+	NC_CHECK(nc_def_var(ncid, "Mask", NC_INT, 2, &dimids[1], &mask_id));
+	NC_CHECK(nc_put_att_text(ncid, area_id, "units", 3, "m^2"));
+	NC_CHECK(nc_put_att_text(ncid, frac_id, "units", 6, "0.0001"));
+	NC_CHECK(nc_enddef(ncid));
+	NC_CHECK(nc_put_var_float(ncid, lat_id, lat));
+	NC_CHECK(nc_put_var_float(ncid, lon_id, lon));
+	NC_CHECK(nc_put_var_float(ncid, area_id, area));
+	NC_CHECK(nc_put_var_float(ncid, frac_id, frac));
+	NC_CHECK(nc_put_var_int(ncid, mask_id, mask));
+	NC_CHECK(nc_close(ncid));
+
+	free(area);
+	free(frac);
+	free(mask);
+	free(lat);
+	free(lon);
+	return OK;
+}
+
+static int write_isam(void) {
+	int hyde_years[NUM_HYDE_YEARS];
+	int isam_years[NUM_HYDE_YEARS];
+	int num_isam = 0;
+	int m, d, err;
+	int first_m = 0;
+	int cur_set = -1;
+	char fname[MAXCHAR];
+	char first[MAXCHAR];
+
+	// the isam years needed by proc_land_type_area(); hyde years before LULC_START_YEAR use LULC_START_YEAR
+	get_hyde_years(hyde_years);
+	for (m = 0; m < NUM_HYDE_YEARS; m++) {
+		if (hyde_years[m] >= LULC_START_YEAR) {
+			isam_years[num_isam++] = hyde_years[m];
+		}
+	}
+	for (m = 0; m < num_isam; m++) {
+		d = m * num_years / num_isam;
+		if (make_path(fname, "%sISAM_HYDE32_LANDCOVER_%i.nc", isamdir, isam_years[m])) { return ERROR_FILE; }
+		if (d != cur_set) {
+			cur_set = d;
+			first_m = m;
+			fprintf(stdout, "isam data set %i: year %i\n", d, isam_years[m]);
+			if ((err = write_isam_file(fname, isam_years[m], isam_years[num_isam - 1])) != OK) {
+				return err;
+			}
+		} else {
+			if (make_path(first, "%sISAM_HYDE32_LANDCOVER_%i.nc", isamdir, isam_years[first_m]) || link_file(first, fname)) {
+				return ERROR_FILE;
+			}
+		}
+	}
+	return OK;
+}
+
+/***** sage netcdf *****/
+
+static int write_sage(void) {
+	int ncid, ncerr;
+	int dimids[4];
+	int varid;
+	int i, j, k, p, d;
+	size_t start[] = {0, 0, 0, 0};
+	size_t count[] = {1, 1, 0, 0};
+	char fname[MAXCHAR];
+	char varname[MAXCHAR];
+	float *fbuf;
+	float *harv;
+
+	count[2] = nrows;
+	count[3] = ncols;
+	fbuf = calloc(ncells, sizeof(float));
+	harv = calloc(ncells, sizeof(float));
+	if (fbuf == NULL || harv == NULL) {
+		fprintf(stderr, "Failed to allocate memory for sage: moirai_bench_data\n");
+		return ERROR_MEM;
+	}
+
+	// physical cropland fraction of land
+	for (i = 0; i < ncells; i++) {
+		p = half_index(i / ncols, i % ncols);
+		fbuf[i] = land_half[p] ? 0.05 + 0.5 * hash_unit(i, 80) : SAGE_NODATA;
+	}
+	if (make_path(fname, "%sCropland2000_5min.nc", indir)) { return ERROR_FILE; }
+	NC_CHECK(nc_create(fname, NC_CLOBBER | NC_64BIT_OFFSET, &ncid));
+	NC_CHECK(nc_def_dim(ncid, "latitude", nrows, &dimids[0]));
+	NC_CHECK(nc_def_dim(ncid, "longitude", ncols, &dimids[1]));
+	NC_CHECK(nc_def_var(ncid, "farea", NC_FLOAT, 2, dimids, &varid));
+	NC_CHECK(nc_enddef(ncid));
+	NC_CHECK(nc_put_var_float(ncid, varid, fbuf));
+	NC_CHECK(nc_close(ncid));
+
+	// crops: level 0 = harvested area fraction, 1 = yield (t/ha), 2 = harvested area quality, 3 = yield quality
+	// only the first crop of each group has a file; the reader builds the variable name from the file base name
+	for (j = 0; j < num_crops; j++) {
+		d = j * num_crop_files / num_crops;
+		if (crop_file_first(j) != j) {
+			continue;
+		}
+		if (make_path(fname, "%scrop%03i_AreaYieldProduction.nc", sagedir, j + 1)) { return ERROR_FILE; }
+		fprintf(stdout, "sage crop file %i: crop %i\n", d, j + 1);
+		sprintf(varname, "crop%03iData", j + 1);
+		NC_CHECK(nc_create(fname, NC_CLOBBER | NC_64BIT_OFFSET, &ncid));
+		NC_CHECK(nc_def_dim(ncid, "time", 1, &dimids[0]));
+		NC_CHECK(nc_def_dim(ncid, "level", 4, &dimids[1]));
+		NC_CHECK(nc_def_dim(ncid, "latitude", nrows, &dimids[2]));
+		NC_CHECK(nc_def_dim(ncid, "longitude", ncols, &dimids[3]));
+		NC_CHECK(nc_def_var(ncid, varname, NC_FLOAT, 4, dimids, &varid));
+		NC_CHECK(nc_enddef(ncid));
+		for (i = 0; i < ncells; i++) {
+			p = half_index(i / ncols, i % ncols);
+			if (!land_half[p]) {
+				harv[i] = SAGE_NODATA;
+			} else if (hash_unit(i, 1000 + 3 * d) < 0.3) {
+				harv[i] = 0.001 + 0.2 * hash_unit(i, 1001 + 3 * d);
+			} else {
+				harv[i] = 0;
+			}
+		}
+		for (k = 0; k < 4; k++) {
+			for (i = 0; i < ncells; i++) {
+				if (harv[i] == (float) SAGE_NODATA) {
+					fbuf[i] = SAGE_NODATA;
+				} else if (k == 0) {
+					fbuf[i] = harv[i];
+				} else if (k == 1) {
+					fbuf[i] = (harv[i] > 0) ? 0.5 + 8.0 * hash_unit(i, 1002 + 3 * d) : 0;
+				} else {
+					fbuf[i] = (harv[i] > 0) ? 1 : 0;
+				}
+			}
+			start[1] = k;
+			NC_CHECK(nc_put_vara_float(ncid, varid, start, count, fbuf));
+		}
+		NC_CHECK(nc_close(ncid));
+	}
+
+	free(fbuf);
+	free(harv);
+	return OK;
+}
+
+/***** moirai input file *****/
+
+static int write_input_file(void) {
+	FILE *fp;
+	int i;
+
+	if ((fp = open_out(outdir, "moirai_input_bench.txt", "w")) == NULL) {
+		return ERROR_FILE;
+	}
+	fprintf(fp, "# input file for moirai land data system, written by moirai_bench_data\n");
+	fprintf(fp, "# synthetic inputs: %i year data sets, %i crops in %i files, %i glus, %i x %i grid, seed %llu\n",
+			num_years, num_crops, num_crop_files, num_glus, nrows, ncols, (unsigned long long) seed);
+	fprintf(fp, "# the comment character is \"#\"; input values must be in this order\n\n");
+	fprintf(fp, "0\t\t\t# diagnostics: 0 = no, 1 = yes\n\n");
+	fprintf(fp, "0\t\t\t# out_year_prod_ha_lr\n");
+	fprintf(fp, "2000\t\t# in_year_sage_crops\n");
+	fprintf(fp, "2001\t\t# out_year_usd\n");
+	fprintf(fp, "2001\t\t# in_year_lr_usd\n");
+	fprintf(fp, "2015\t\t# lulc_out_year\n\n");
+	fprintf(fp, "%s\t# inpath\n", indir);
+	fprintf(fp, "%soutputs/\t# outpath\n", outdir);
+	fprintf(fp, "%s\t# sagepath\n", sagedir);
+	fprintf(fp, "%s\t# hydepath\n", hydedir);
+	fprintf(fp, "%s\t# lulcpath\n", isamdir);
+	fprintf(fp, "%s\t# mircapath\n", mircadir);
+	fprintf(fp, "%s\t# wfpath\n", wfdir);
+	fprintf(fp, "%soutputs/aglu-data/moirai/\t# ldsdestpath\n", outdir);
+	fprintf(fp, "%soutputs/aglu-data/mappings/\t# mapdestpath\n\n", outdir);
+	fprintf(fp, "hyde_cell_plus.bil\t# cell_area_fname\n");
+	fprintf(fp, "sage_land_frac.bil\t# land_area_sage_fname\n");
+	fprintf(fp, "hyde_land_plus.bil\t# land_area_hyde_fname\n");
+	fprintf(fp, "GLU_bench.gri\t# aez_new_fname\n");
+	fprintf(fp, "AEZ_orig_bench.gri\t# aez_orig_fname\n");
+	fprintf(fp, "potveg_plus.bil\t# potveg_fname\n");
+	fprintf(fp, "fao_ctry_rast.bil\t# country_fao_fname\n");
+	fprintf(fp, "L1_processed.bil\t# L1_fname\n");
+	fprintf(fp, "L2_processed.bil\t# L2_fname\n");
+	fprintf(fp, "L3_processed.bil\t# L3_fname\n");
+	fprintf(fp, "L4_processed.bil\t# L4_fname\n");
+	fprintf(fp, "All_IUCN_processed.bil\t# ALL_IUCN_fname\n");
+	fprintf(fp, "1a_1b_2_processed.bil\t# IUCN_1a_1b_2_fname\n");
+	fprintf(fp, "Nfert_0083d.img\t# nfert_rast_fname (deprecated; not written or read)\n");
+	fprintf(fp, "Cropland2000_5min.nc\t# cropland_sage_fname\n");
+	// soil_fnames and veg_fnames are in input file order
+	for (i = 0; i < NUM_BENCH_SOIL; i++) {
+		fprintf(fp, "%s\t# soil carbon %i\n", soil_fnames[i], i + 1);
+	}
+	for (i = 0; i < NUM_BENCH_VEG; i++) {
+		fprintf(fp, "%s\t# veg carbon %i\n", veg_fnames[i], i + 1);
+	}
+	fprintf(fp, "\n");
+	fprintf(fp, "GTAP_value_milUSD.csv\t# rent_orig_fname\n");
+	fprintf(fp, "GTAP_GCAM_ctry87.csv\t# country87_gtap_fname\n");
+	fprintf(fp, "FAO_ctry_GCAM_ctry87.csv\t# country87map_fao_fname\n");
+	fprintf(fp, "FAO_iso_VMAP0_ctry.csv\t# country_all_fname\n");
+	fprintf(fp, "GLU_bench.csv\t# aez_new_info_fname\n");
+	fprintf(fp, "iso_GCAM_regID_32reg.csv\t# countrymap_iso_gcam_region_fname\n");
+	fprintf(fp, "GCAM_region_names_32reg.csv\t# regionlist_gcam_fname\n");
+	fprintf(fp, "GTAP_use.csv\t# use_gtap_fname\n");
+	fprintf(fp, "SAGE_PVLT.csv\t# lt_sage_fname\n");
+	fprintf(fp, "hyde32_lu.csv\t# lu_hyde_fname\n");
+	fprintf(fp, "isam_2_sage_hyde_mapping.csv\t# lulc_fname\n");
+	fprintf(fp, "SAGE_gtap_fao_crop2use.csv\t# crop_fname\n");
+	fprintf(fp, "FAO_production_1993_2016.csv\t# production_fao_fname\n");
+	fprintf(fp, "FAO_yield_1993_2016.csv\t# yield_fao_fname\n");
+	fprintf(fp, "FAO_harvarea_1993_2016.csv\t# harvestarea_fao_fname\n");
+	fprintf(fp, "FAO_producerprice_1993_2016.csv\t# prodprice_fao_fname\n");
+	fprintf(fp, "cpi_bench.csv\t# convert_usd_fname\n\n");
+	fprintf(fp, "moirai_log_bench.txt\t# lds_logname\n");
+	fprintf(fp, "MOIRAI_ag_HA_ha.csv\t# harvestarea_fname\n");
+	fprintf(fp, "MOIRAI_ag_prod_t.csv\t# production_fname\n");
+	fprintf(fp, "MOIRAI_value_milUSD.csv\t# rent_fname\n");
+	fprintf(fp, "MIRCA_irrHA_ha.csv\t# mirca_irr_fname\n");
+	fprintf(fp, "MIRCA_rfdHA_ha.csv\t# mirca_rfd_fname\n");
+	fprintf(fp, "Land_type_area_ha.csv\t# land_type_area_fname\n");
+	fprintf(fp, "Ref_veg_carbon_Mg_per_ha.csv\t# refveg_carbon_fname\n");
+	fprintf(fp, "Water_footprint_m3.csv\t# wf_fname\n");
+	fprintf(fp, "MOIRAI_ctry_GLU.csv\t# iso_map_fname\n");
+	fprintf(fp, "MOIRAI_land_types.csv\t# lt_map_fname\n");
+	fprintf(fp, "%s\t# trace_fname\n", NONE_TEXT);
+	fprintf(fp, "\n%.17g\t# grid_res_sec\n", 180.0 * DEG2SEC / nrows);
+	fprintf(fp, "%.17g\t# lulc_res_sec\n", DEFAULT_LULC_RES_SEC);
+	fprintf(fp, "%i\t# band_lulc_rows\n", band_lulc_rows);
+	fprintf(fp, "none\t# region_subset\n");
+	fprintf(fp, "all\t# hyde_years\n");
+	fprintf(fp, "none\t# glu_batch_fname\n");
+	fprintf(fp, "none\t# cell_store_fname\n");
+	fprintf(fp, "none\t# checkpoint_path\n");
+	fprintf(fp, "csv\t# table_format\n");
+	fclose(fp);
+	return OK;
+}
+
+static void usage(void) {
+	fprintf(stderr, "usage: moirai_bench_data [-y num_years] [-c num_crops] [-k num_crop_files] [-g num_glus] "
+			"[-r num_rows] [-b band_lulc_rows] [-s seed] out_dir\n");
+}
+
+int main(int argc, char *argv[]) {
+
+	int opt;
+	int err = OK;
+	char path[MAXCHAR];
+
+	while ((opt = getopt(argc, argv, "y:c:k:g:r:b:s:")) != -1) {
+		switch (opt) {
+			case 'y': num_years = atoi(optarg); break;
+			case 'c': num_crops = atoi(optarg); break;
+			case 'k': num_crop_files = atoi(optarg); break;
+			case 'g': num_glus = atoi(optarg); break;
+			case 'r': nrows = atoi(optarg); break;
+			case 'b': band_lulc_rows = atoi(optarg); break;
+			case 's': seed = strtoull(optarg, NULL, 10); break;
+			default: usage(); return ERROR_USAGE;
+		}
+	}
+	if (optind != argc - 1) {
+		usage();
+		return ERROR_USAGE;
+	}
+	// the isam grid is always half degree here; the working grid is set by -r
+	NUM_LAT_LULC = (int) (180.0 * DEG2SEC / DEFAULT_LULC_RES_SEC);
+	NUM_LON_LULC = 2 * NUM_LAT_LULC;
+	NUM_CELLS_LULC = NUM_LAT_LULC * NUM_LON_LULC;
+	if (nrows == 0) {
+		nrows = (int) (180.0 * DEG2SEC / DEFAULT_GRID_RES_SEC);
+	}
+	if (num_years < 1 || num_years > NUM_HYDE_YEARS || num_crops < 1 || num_crops > NUM_BENCH_MAX_CROPS ||
+		num_crop_files < 1 || num_crop_files > num_crops || num_glus < NUM_ORIG_AEZ ||
+		nrows < NUM_LAT_LULC || nrows % NUM_LAT_LULC != 0 || band_lulc_rows < 0) {
+		fprintf(stderr, "Invalid option value: years 1-%i, crops 1-%i, crop files 1-crops, glus >= %i, rows a multiple of %i, band rows >= 0\n",
+				NUM_HYDE_YEARS, NUM_BENCH_MAX_CROPS, NUM_ORIG_AEZ, NUM_LAT_LULC);
+		return ERROR_USAGE;
+	}
+	ncols = 2 * nrows;
+	ncells = nrows * ncols;
+	scale = nrows / NUM_LAT_LULC;
+
+	// directories
+	if (make_path(outdir, "%s%s", argv[optind], (argv[optind][strlen(argv[optind]) - 1] != '/') ? "/" : "") ||
+		make_path(indir, "%sindata/", outdir) || make_path(sagedir, "%ssage/", indir) ||
+		make_path(hydedir, "%shyde/", indir) || make_path(isamdir, "%sisam/", indir) ||
+		make_path(mircadir, "%smirca/", indir) || make_path(wfdir, "%swf/", indir)) {
+		return ERROR_FILE;
+	}
+	if (make_dir(outdir) || make_dir(indir) || make_dir(sagedir) || make_dir(hydedir) || make_dir(isamdir) ||
+		make_dir(mircadir) || make_dir(wfdir)) {
+		return ERROR_FILE;
+	}
+	if (make_path(path, "%soutputs", outdir) || make_dir(path)) { return ERROR_FILE; }
+	if (make_path(path, "%soutputs/aglu-data", outdir) || make_dir(path)) { return ERROR_FILE; }
+	if (make_path(path, "%soutputs/aglu-data/moirai", outdir) || make_dir(path)) { return ERROR_FILE; }
+	if (make_path(path, "%soutputs/aglu-data/mappings", outdir) || make_dir(path)) { return ERROR_FILE; }
+
+	land_half = calloc(NUM_CELLS_LULC, sizeof(unsigned char));
+	ctry_half = calloc(NUM_CELLS_LULC, sizeof(int));
+	glu_half = calloc(NUM_CELLS_LULC, sizeof(int));
+	grid_cell_area = calloc(ncells, sizeof(float));
+	grid_land_area = calloc(ncells, sizeof(float));
+	if (land_half == NULL || ctry_half == NULL || glu_half == NULL || grid_cell_area == NULL || grid_land_area == NULL) {
+		fprintf(stderr, "Failed to allocate memory for grids: moirai_bench_data\n");
+		return ERROR_MEM;
+	}
+
+	fprintf(stdout, "Writing synthetic moirai inputs to %s at %s", outdir, get_systime());
+	make_land();
+	if ((err = make_countries()) ||
+		(err = write_csv_files()) ||
+		(err = write_rasters()) ||
+		(err = write_water_footprint()) ||
+		(err = write_mirca()) ||
+		(err = write_sage()) ||
+		(err = write_isam()) ||
+		(err = write_hyde()) ||
+		(err = write_input_file())) {
+		fprintf(stderr, "moirai_bench_data terminated with error_code = %i\n", err);
+		return err;
+	}
+	fprintf(stdout, "Finished at %s", get_systime());
+
+	return OK;}
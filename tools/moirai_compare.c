@@ -0,0 +1,580 @@
+/**********
+ moirai_compare.c
+
+ compare a moirai output directory against a golden (reference) output directory
+ 	and optionally compare a stage profile report against a baseline report
+
+ every .csv and .bil file under golden_dir (including subdirectories) must exist under test_dir with the same relative path
+ csv files are compared record by record and field by field
+ 	fields that are numbers in both files are equal if |test - golden| <= abs_tol + rel_tol * max(|test|, |golden|)
+ 	other fields must match exactly
+ 	comment lines (starting with #) are skipped because they contain the output path
+ bil files are compared cell by cell with the same tolerance, and summary statistics are reported
+ 	the files have no header, so the cell type is inferred: 2 bytes per working grid cell is short,
+ 	and 4 bytes per cell is int if every value read as int is within +-2^24, otherwise float
+ 	cells that are NODATA in only one of the files are counted separately
+ the stage profiles (see stage_profile.c) are matched by stage name and occurrence
+ 	a stage is slower if test wall_sec > baseline wall_sec * (1 + time_tol) + time_slack
+ 	the same test is applied to the total wall time; stages only in one of the reports are listed
+
+ usage:
+ moirai_compare [-a abs_tol] [-r rel_tol] [-t time_tol] [-s time_slack] [-g grid_res_sec] [-b baseline_profile -p test_profile] [-v] golden_dir test_dir
+
+ 	-a abs_tol:				absolute tolerance for numeric values; default 0
+ 	-r rel_tol:				relative tolerance for numeric values; default 1e-6
+ 	-t time_tol:			allowed fractional slowdown of each stage; default 0.10
+ 	-s time_slack:			allowed absolute slowdown of each stage (s), for short stages; default 0.5
+ 	-g grid_res_sec:		working grid resolution of the runs (arc-seconds), for the bil cell type; default DEFAULT_GRID_RES_SEC
+ 	-b baseline_profile:	stored stage profile report; the timing comparison is skipped if this file does not exist
+ 	-p test_profile:		stage profile report of the run being checked
+ 	-v:						list every difference, instead of the first MAX_LISTED_DIFFS per file
+ 	golden_dir:				the reference outputs, e.g. example_outputs/basins235
+ 	test_dir:				the outputs to check, e.g. outputs/basins235
+
+ return value:
+ OK = 0 if all files match and no stage is slower
+ ERROR_FILE if a golden file is missing from test_dir or cannot be read
+ ERROR_CALC if any file differs or any stage is slower
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+ **********/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "moirai.h"
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#define MAX_LISTED_DIFFS	5		// differences listed per file unless -v is given
+#define MAX_CMP_STAGES		(2 * MAX_PROF_STAGES)	// stages read from a profile report
+#define INT_CELL_LIMIT		16777216	// 2^24; larger 4-byte values are taken to be floats
+
+// comparison settings
+static double abs_tol = 0;
+static double rel_tol = 1.0e-6;
+static double time_tol = 0.10;
+static double time_slack = 0.5;
+static int verbose = 0;
+
+// totals over all files
+static int num_files = 0;
+static int num_diff_files = 0;
+static int num_missing = 0;
+
+typedef struct {
+	char name[MAX_PROF_NAME];
+	int occurrence;			// 1 for the first stage with this name, 2 for the second, ...
+	double wall_sec;
+} cmp_stage_struct;
+
+static int values_differ(double golden, double test) {
+	double scale = (fabs(golden) > fabs(test)) ? fabs(golden) : fabs(test);
+	return fabs(test - golden) > abs_tol + rel_tol * scale;
+}
+
+// return 1 and set value if the whole field is a number
+static int parse_number(const char *field, double *value) {
+	char *end;
+	if (*field == '\0') {
+		return 0;
+	}
+	*value = strtod(field, &end);
+	return *end == '\0';
+}
+
+// split a record in place at the commas and the line end; returns the number of fields
+static int split_record(char *rec, char **fields, int max_fields) {
+	int n = 0;
+	rec[strcspn(rec, "\r\n")] = '\0';
+	fields[n++] = rec;
+	while ((rec = strchr(rec, ',')) != NULL && n < max_fields) {
+		*rec++ = '\0';
+		fields[n++] = rec;
+	}
+	return n;
+}
+
+// read the next non-comment record; returns -1 at the end of the file
+static ssize_t next_record(char **rec, size_t *len, FILE *fp, long *line_num) {
+	ssize_t nread;
+	while ((nread = getline(rec, len, fp)) != -1) {
+		(*line_num)++;
+		if ((*rec)[0] != '#') {
+			break;
+		}
+	}
+	return nread;
+}
+
+/***** csv *****/
+
+static int compare_csv(const char *golden_name, const char *test_name, const char *rel_name) {
+	FILE *fpg, *fpt;
+	char *grec = NULL, *trec = NULL;
+	size_t glen = 0, tlen = 0;
+	ssize_t gread, tread;
+	char *gfields[MAXRECSIZE / 2], *tfields[MAXRECSIZE / 2];
+	int ng, nt, j;
+	long gline = 0, tline = 0;
+	long num_records = 0, num_values = 0, num_diffs = 0, num_listed = 0;
+	double gval = 0, tval = 0, diff, max_abs = 0, max_rel = 0;
+	int gnum, tnum, differs;
+
+	if ((fpg = fopen(golden_name, "r")) == NULL) {
+		fprintf(stdout, "ERROR    %s: cannot open golden file\n", rel_name);
+		return ERROR_FILE;
+	}
+	if ((fpt = fopen(test_name, "r")) == NULL) {
+		fclose(fpg);
+		fprintf(stdout, "MISSING  %s\n", rel_name);
+		num_missing++;
+		return ERROR_FILE;
+	}
+
+	while (1) {
+		gread = next_record(&grec, &glen, fpg, &gline);
+		tread = next_record(&trec, &tlen, fpt, &tline);
+		if (gread == -1 || tread == -1) {
+			break;
+		}
+		num_records++;
+		ng = split_record(grec, gfields, MAXRECSIZE / 2);
+		nt = split_record(trec, tfields, MAXRECSIZE / 2);
+		if (ng != nt && (verbose || num_listed < MAX_LISTED_DIFFS)) {
+			fprintf(stdout, "         line %li/%li: %i fields != golden %i fields\n", tline, gline, nt, ng);
+		}
+		for (j = 0; j < ng || j < nt; j++) {
+			// a column that is in only one of the records is a difference
+			if (j >= ng || j >= nt) {
+				num_diffs++;
+				if (verbose || num_listed++ < MAX_LISTED_DIFFS) {
+					fprintf(stdout, "         line %li field %i: %s\n", tline, j + 1,
+							(j >= nt) ? "missing from the test record" : "not in the golden record");
+				}
+				continue;
+			}
+			gval = 0;
+			tval = 0;
+			gnum = parse_number(gfields[j], &gval);
+			tnum = parse_number(tfields[j], &tval);
+			if (gnum && tnum) {
+				num_values++;
+				differs = values_differ(gval, tval);
+				diff = fabs(tval - gval);
+				if (diff > max_abs) { max_abs = diff; }
+				if (gval != 0 && diff / fabs(gval) > max_rel) { max_rel = diff / fabs(gval); }
+			} else {
+				differs = strcmp(gfields[j], tfields[j]) != 0;
+			}
+			if (differs) {
+				num_diffs++;
+				if (verbose || num_listed++ < MAX_LISTED_DIFFS) {
+					fprintf(stdout, "         line %li field %i: %s != golden %s\n", tline, j + 1, tfields[j], gfields[j]);
+				}
+			}
+		}
+	}
+	// any records left in either file are differences
+	while (gread != -1) {
+		num_diffs++;
+		if (verbose || num_listed++ < MAX_LISTED_DIFFS) {
+			fprintf(stdout, "         golden line %li is missing from the test file\n", gline);
+		}
+		gread = next_record(&grec, &glen, fpg, &gline);
+	}
+	while (tread != -1) {
+		num_diffs++;
+		if (verbose || num_listed++ < MAX_LISTED_DIFFS) {
+			fprintf(stdout, "         test line %li is not in the golden file\n", tline);
+		}
+		tread = next_record(&trec, &tlen, fpt, &tline);
+	}
+
+	fclose(fpg);
+	fclose(fpt);
+	free(grec);
+	free(trec);
+
+	fprintf(stdout, "%-8s %s: %li records, %li numeric values, %li differences, max abs diff %g, max rel diff %g\n",
+			num_diffs ? "DIFF" : "OK", rel_name, num_records, num_values, num_diffs, max_abs, max_rel);
+	if (num_diffs) {
+		num_diff_files++;
+		return ERROR_CALC;
+	}
+	return OK;
+}
+
+/***** bil *****/
+
+// read a whole bil file as doubles; the cell type is inferred from the size and the values
+static double *read_bil(const char *fname, long *num_cells, const char **type_name) {
+	FILE *fp;
+	struct stat st;
+	size_t nbytes, i, n;
+	unsigned char *buf;
+	double *vals;
+	int is_int = 1;
+	int ival;
+	short sval;
+	float fval;
+
+	if (stat(fname, &st) != 0 || (fp = fopen(fname, "rb")) == NULL) {
+		return NULL;
+	}
+	nbytes = (size_t) st.st_size;
+	buf = malloc(nbytes > 0 ? nbytes : 1);
+	if (buf == NULL || fread(buf, 1, nbytes, fp) != nbytes) {
+		fclose(fp);
+		free(buf);
+		return NULL;
+	}
+	fclose(fp);
+
+	if (nbytes == (size_t) NUM_CELLS * sizeof(short)) {
+		n = NUM_CELLS;
+		*type_name = "short";
+	} else {
+		n = nbytes / 4;
+		for (i = 0; i < n; i++) {
+			memcpy(&ival, &buf[i * 4], 4);
+			if (ival > INT_CELL_LIMIT || ival < -INT_CELL_LIMIT) {
+				is_int = 0;
+				break;
+			}
+		}
+		*type_name = is_int ? "int" : "float";
+	}
+	if ((vals = malloc((n > 0 ? n : 1) * sizeof(double))) == NULL) {
+		free(buf);
+		return NULL;
+	}
+	for (i = 0; i < n; i++) {
+		if (nbytes == (size_t) NUM_CELLS * sizeof(short)) {
+			memcpy(&sval, &buf[i * 2], 2);
+			vals[i] = sval;
+		} else if (is_int) {
+			memcpy(&ival, &buf[i * 4], 4);
+			vals[i] = ival;
+		} else {
+			memcpy(&fval, &buf[i * 4], 4);
+			vals[i] = fval;
+		}
+	}
+	free(buf);
+	*num_cells = (long) n;
+	return vals;
+}
+
+static int compare_bil(const char *golden_name, const char *test_name, const char *rel_name) {
+	double *gvals, *tvals;
+	long ng = 0, nt = 0, i;
+	long num_diffs = 0, num_nodata_diffs = 0, num_valid = 0, num_listed = 0;
+	const char *gtype = "", *ttype = "";
+	double diff, max_abs = 0, sum_abs = 0, sum_sq = 0, gsum = 0, tsum = 0;
+
+	if ((gvals = read_bil(golden_name, &ng, &gtype)) == NULL) {
+		fprintf(stdout, "ERROR    %s: cannot read golden file\n", rel_name);
+		return ERROR_FILE;
+	}
+	if ((tvals = read_bil(test_name, &nt, &ttype)) == NULL) {
+		free(gvals);
+		fprintf(stdout, "MISSING  %s\n", rel_name);
+		num_missing++;
+		return ERROR_FILE;
+	}
+	if (ng != nt) {
+		fprintf(stdout, "DIFF     %s: %li %s cells != golden %li %s cells\n", rel_name, nt, ttype, ng, gtype);
+		free(gvals);
+		free(tvals);
+		num_diff_files++;
+		return ERROR_CALC;
+	}
+
+	for (i = 0; i < ng; i++) {
+		if ((gvals[i] == NODATA) != (tvals[i] == NODATA)) {
+			num_nodata_diffs++;
+			if (verbose || num_listed++ < MAX_LISTED_DIFFS) {
+				fprintf(stdout, "         cell %li: %g != golden %g\n", i, tvals[i], gvals[i]);
+			}
+			continue;
+		}
+		if (gvals[i] == NODATA) {
+			continue;
+		}
+		num_valid++;
+		gsum += gvals[i];
+		tsum += tvals[i];
+		diff = fabs(tvals[i] - gvals[i]);
+		sum_abs += diff;
+		sum_sq += diff * diff;
+		if (diff > max_abs) { max_abs = diff; }
+		if (values_differ(gvals[i], tvals[i])) {
+			num_diffs++;
+			if (verbose || num_listed++ < MAX_LISTED_DIFFS) {
+				fprintf(stdout, "         cell %li: %g != golden %g\n", i, tvals[i], gvals[i]);
+			}
+		}
+	}
+	free(gvals);
+	free(tvals);
+
+	fprintf(stdout, "%-8s %s: %li %s cells, %li valid, %li differences, %li nodata mismatches, "
+			"max abs diff %g, mean abs diff %g, rms diff %g, sum %.10g (golden %.10g)\n",
+			(num_diffs || num_nodata_diffs) ? "DIFF" : "OK", rel_name, ng, gtype, num_valid, num_diffs, num_nodata_diffs,
+			max_abs, (num_valid > 0) ? sum_abs / num_valid : 0, (num_valid > 0) ? sqrt(sum_sq / num_valid) : 0, tsum, gsum);
+	if (num_diffs || num_nodata_diffs) {
+		num_diff_files++;
+		return ERROR_CALC;
+	}
+	return OK;
+}
+
+/***** directory walk *****/
+
+static int has_suffix(const char *name, const char *suffix) {
+	size_t n = strlen(name), m = strlen(suffix);
+	return n >= m && strcmp(name + n - m, suffix) == 0;
+}
+
+// compare every csv and bil file under golden_root/rel_dir; returns the first error found
+static int compare_dir(const char *golden_root, const char *test_root, const char *rel_dir) {
+	DIR *dp;
+	struct dirent *de;
+	struct stat st;
+	char gpath[MAXCHAR], tpath[MAXCHAR], rel_name[MAXCHAR];
+	int err, rv = OK;
+
+	sprintf(gpath, "%s%s", golden_root, rel_dir);
+	if ((dp = opendir(gpath)) == NULL) {
+		fprintf(stdout, "ERROR    cannot open golden directory %s\n", gpath);
+		return ERROR_FILE;
+	}
+	while ((de = readdir(dp)) != NULL) {
+		if (de->d_name[0] == '.') {
+			continue;
+		}
+		snprintf(rel_name, MAXCHAR, "%s%s", rel_dir, de->d_name);
+		snprintf(gpath, MAXCHAR, "%s%s", golden_root, rel_name);
+		snprintf(tpath, MAXCHAR, "%s%s", test_root, rel_name);
+		if (stat(gpath, &st) != 0) {
+			continue;
+		}
+		if (S_ISDIR(st.st_mode)) {
+			strcat(rel_name, "/");
+			err = compare_dir(golden_root, test_root, rel_name);
+		} else if (has_suffix(de->d_name, ".csv")) {
+			num_files++;
+			err = compare_csv(gpath, tpath, rel_name);
+		} else if (has_suffix(de->d_name, ".bil")) {
+			num_files++;
+			err = compare_bil(gpath, tpath, rel_name);
+		} else {
+			err = OK;
+		}
+		if (rv == OK) {
+			rv = err;
+		}
+	}
+	closedir(dp);
+	return rv;
+}
+
+/***** stage profile *****/
+
+// get the number after "key": in a line; returns 1 if found
+static int get_json_number(const char *line, const char *key, double *value) {
+	char pattern[MAXCHAR];
+	const char *p;
+	sprintf(pattern, "\"%s\": ", key);
+	if ((p = strstr(line, pattern)) == NULL) {
+		return 0;
+	}
+	*value = atof(p + strlen(pattern));
+	return 1;
+}
+
+// read the total and the stage wall times from a stage profile report; returns the number of stages or -1
+static int read_profile(const char *fname, cmp_stage_struct *stages, double *total_wall) {
+	FILE *fp;
+	char line[MAXRECSIZE];
+	const char *p;
+	int n = 0, i;
+	size_t len;
+
+	if ((fp = fopen(fname, "r")) == NULL) {
+		return -1;
+	}
+	*total_wall = 0;
+	// the report has one stage per line
+	while (fgets(line, MAXRECSIZE, fp) != NULL) {
+		get_json_number(line, "total_wall_sec", total_wall);
+		if ((p = strstr(line, "{\"name\": \"")) == NULL || n >= MAX_CMP_STAGES) {
+			continue;
+		}
+		p += strlen("{\"name\": \"");
+		len = strcspn(p, "\"");
+		if (len >= MAX_PROF_NAME) {
+			len = MAX_PROF_NAME - 1;
+		}
+		memset(stages[n].name, '\0', MAX_PROF_NAME);
+		strncpy(stages[n].name, p, len);
+		get_json_number(line, "wall_sec", &stages[n].wall_sec);
+		stages[n].occurrence = 1;
+		for (i = 0; i < n; i++) {
+			if (strcmp(stages[i].name, stages[n].name) == 0) {
+				stages[n].occurrence++;
+			}
+		}
+		n++;
+	}
+	fclose(fp);
+	return n;
+}
+
+static int time_slower(double baseline, double test) {
+	return test > baseline * (1 + time_tol) + time_slack;
+}
+
+static int compare_profiles(const char *baseline_name, const char *test_name) {
+	cmp_stage_struct *base, *test;
+	int nb, nt, i, j, found;
+	int num_slower = 0;
+	double base_total, test_total;
+
+	base = calloc(MAX_CMP_STAGES, sizeof(cmp_stage_struct));
+	test = calloc(MAX_CMP_STAGES, sizeof(cmp_stage_struct));
+	if (base == NULL || test == NULL) {
+		return ERROR_MEM;
+	}
+	if ((nb = read_profile(baseline_name, base, &base_total)) < 0) {
+		fprintf(stdout, "SKIP     timing: no baseline profile %s\n", baseline_name);
+		free(base);
+		free(test);
+		return OK;
+	}
+	if ((nt = read_profile(test_name, test, &test_total)) < 0) {
+		fprintf(stdout, "MISSING  timing: cannot read profile %s\n", test_name);
+		free(base);
+		free(test);
+		return ERROR_FILE;
+	}
+
+	for (i = 0; i < nb; i++) {
+		found = 0;
+		for (j = 0; j < nt; j++) {
+			if (strcmp(base[i].name, test[j].name) == 0 && base[i].occurrence == test[j].occurrence) {
+				found = 1;
+				break;
+			}
+		}
+		if (!found) {
+			fprintf(stdout, "         stage %s (%i) is only in the baseline\n", base[i].name, base[i].occurrence);
+			continue;
+		}
+		if (time_slower(base[i].wall_sec, test[j].wall_sec)) {
+			num_slower++;
+		}
+		fprintf(stdout, "%-8s stage %s: %.3f s, baseline %.3f s (%+.1f%%)\n",
+				time_slower(base[i].wall_sec, test[j].wall_sec) ? "SLOWER" : "OK", test[j].name, test[j].wall_sec,
+				base[i].wall_sec, (base[i].wall_sec > 0) ? 100.0 * (test[j].wall_sec / base[i].wall_sec - 1) : 0);
+	}
+	for (j = 0; j < nt; j++) {
+		found = 0;
+		for (i = 0; i < nb; i++) {
+			if (strcmp(base[i].name, test[j].name) == 0 && base[i].occurrence == test[j].occurrence) {
+				found = 1;
+				break;
+			}
+		}
+		if (!found) {
+			fprintf(stdout, "         stage %s (%i) is not in the baseline\n", test[j].name, test[j].occurrence);
+		}
+	}
+	if (time_slower(base_total, test_total)) {
+		num_slower++;
+	}
+	fprintf(stdout, "%-8s total: %.3f s, baseline %.3f s (%+.1f%%); %i of %i stages slower\n",
+			time_slower(base_total, test_total) ? "SLOWER" : "OK", test_total, base_total,
+			(base_total > 0) ? 100.0 * (test_total / base_total - 1) : 0, num_slower, nb);
+
+	free(base);
+	free(test);
+	return num_slower ? ERROR_CALC : OK;
+}
+
+static void usage(void) {
+	fprintf(stderr, "usage: moirai_compare [-a abs_tol] [-r rel_tol] [-t time_tol] [-s time_slack] [-g grid_res_sec] "
+			"[-b baseline_profile -p test_profile] [-v] golden_dir test_dir\n");
+}
+
+int main(int argc, char *argv[]) {
+
+	int opt;
+	int err_files, err_time = OK;
+	char golden_root[MAXCHAR], test_root[MAXCHAR];
+	char baseline_profile[MAXCHAR], test_profile[MAXCHAR];
+	double grid_res_sec = DEFAULT_GRID_RES_SEC;
+
+	memset(baseline_profile, '\0', MAXCHAR);
+	memset(test_profile, '\0', MAXCHAR);
+	while ((opt = getopt(argc, argv, "a:r:t:s:g:b:p:v")) != -1) {
+		switch (opt) {
+			case 'a': abs_tol = atof(optarg); break;
+			case 'r': rel_tol = atof(optarg); break;
+			case 't': time_tol = atof(optarg); break;
+			case 's': time_slack = atof(optarg); break;
+			case 'g': grid_res_sec = atof(optarg); break;
+			case 'b': strncpy(baseline_profile, optarg, MAXCHAR - 1); break;
+			case 'p': strncpy(test_profile, optarg, MAXCHAR - 1); break;
+			case 'v': verbose = 1; break;
+			default: usage(); return ERROR_USAGE;
+		}
+	}
+	if (optind != argc - 2 || (baseline_profile[0] != '\0') != (test_profile[0] != '\0') || grid_res_sec <= 0) {
+		usage();
+		return ERROR_USAGE;
+	}
+	NUM_LAT = (int) floor(180.0 * DEG2SEC / grid_res_sec + 0.5);
+	NUM_LON = 2 * NUM_LAT;
+	NUM_CELLS = NUM_LAT * NUM_LON;
+	strcpy(golden_root, argv[optind]);
+	strcpy(test_root, argv[optind + 1]);
+	if (golden_root[strlen(golden_root) - 1] != '/') { strcat(golden_root, "/"); }
+	if (test_root[strlen(test_root) - 1] != '/') { strcat(test_root, "/"); }
+
+	fprintf(stdout, "# comparing %s against golden %s: abs_tol %g, rel_tol %g\n", test_root, golden_root, abs_tol, rel_tol);
+	err_files = compare_dir(golden_root, test_root, "");
+	fprintf(stdout, "# %i files compared: %i differ, %i missing\n", num_files, num_diff_files, num_missing);
+
+	if (baseline_profile[0] != '\0') {
+		fprintf(stdout, "# comparing stage profile %s against baseline %s: time_tol %g, time_slack %g s\n",
+				test_profile, baseline_profile, time_tol, time_slack);
+		err_time = compare_profiles(baseline_profile, test_profile);
+	}
+
+	if (err_files != OK) {
+		return err_files;
+	}
+	return err_time;}
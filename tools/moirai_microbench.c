@@ -0,0 +1,930 @@
+/**********
+ moirai_microbench.c
+
+ time the moirai kernels in isolation on synthetic buffers
+ 	this links the moirai object files (all except moirai_main.o) and calls the real functions where they are
+ 	self-contained, after setting up only the globals that each function uses
+ 	the lookups and the carbon quantiles are inline loops in proc_refveg_carbon() and proc_land_type_area(),
+ 		so they are reproduced here with the same loop structure on synthetic tables
+
+ kernels:
+ 	read_hyde32:			ascii parsing of the 12 hyde land use files for one year (hyde_rows x 2*hyde_rows grid)
+ 	read_lulc_isam:			netcdf read and regrid of one isam land cover file (NUM_LULC_TYPES x NUM_CELLS_LULC)
+ 	proc_lulc_area:			disaggregation of one lulc cell to its NUM_LU_CELLS working cells, for num_lulc lulc cells
+ 							this includes filling the input arrays for each lulc cell, as in proc_land_type_area()
+ 	read_protected:			read of the six epa rasters and derivation of the NUM_EPA_PROTECTED categories (full grid)
+ 	lookup_country:			linear search of countrycodes_fao[] for each land cell
+ 	lookup_glu:				linear search of the country glu list ctry_aez_list[] for each land cell
+ 	lookup_category:		linear search of lt_cats[] for each land cell and protected category
+ 	carbon_quantile:		append each cell to its group and sort the 5 statistic arrays for soil and veg carbon,
+ 							then pick the median, min, max, q1, and q3, as in proc_refveg_carbon()
+ 	write_csv_float2d:		write a num_records x NUM_LULC_TYPES csv table
+ 	write_csv_float3d:		write a NUM_FAO_CTRY x glu x NUM_SAGE_CROP csv table
+ 	write_harvestarea:		write_harvestarea_crop_aez() for NUM_FAO_CTRY countries and NUM_SAGE_CROP crops
+
+ each kernel is run num_reps times and the fastest run is reported
+ 	ns_per_cell is the time per unit in the count column (grid cell, lookup, or csv value)
+ 	mb_per_sec is the throughput of the kernel input: file bytes for the readers, in-memory bytes for the other
+ 		kernels, and file bytes written for the csv writers
+ 	the input files are written to scratch_dir before the timing, so the readers are normally timed from the page cache
+
+ usage:
+ moirai_microbench [-n num_reps] [-r hyde_rows] [-l num_lulc] [-g group_size] [-k kernel] [-s seed] scratch_dir
+
+ 	-n num_reps:		number of timed runs of each kernel; default 3
+ 	-r hyde_rows:		number of rows in the hyde ascii grid; columns = 2 * rows; default 1080 (2160 is the full 5 arcmin grid)
+ 	-l num_lulc:		number of lulc cells for proc_lulc_area; default 20000
+ 	-g group_size:		number of cells per country/glu/category group for carbon_quantile; default 400
+ 	-k kernel:			run only the kernels whose name starts with this string (e.g. read, lookup, write_csv); default all
+ 	-s seed:			random seed; default 1
+ 	scratch_dir:		directory for the input files and the csv outputs; it is created if needed
+
+ return value:
+ integer error code: OK = 0, otherwise a non-zero error code
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+ **********/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "moirai.h"
+#include <stdint.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#define NUM_MB_HYDE			12		// number of hyde land use files
+#define NUM_MB_PVLT			15		// number of sage potential vegetation types
+#define NUM_MB_LULC_LU		8		// number of isam land use types after the NUM_LULC_LC_TYPES land cover types
+#define NUM_MB_FAO_CTRY		250		// number of fao countries for the lookups and the csv writers
+#define NUM_MB_MAX_GLU		30		// maximum number of glus per country
+#define NUM_MB_CROP			175		// number of sage crops
+#define NUM_MB_CARBON_STATS	5		// median, min, max, q1, q3; the weighted average is not sorted
+#define NUM_MB_GROUPS		20		// number of carbon quantile groups
+#define NUM_MB_CSV_RECORDS	10000	// number of records for write_csv_float2d
+#define MB_YEAR				2000	// year for the hyde and isam file names
+
+static const char *hyde_names[] = {"uopp_", "cropland", "grazing", "pasture", "rangeland", "ir_norice", "rf_norice",
+	"ir_rice", "rf_rice", "tot_irri", "tot_rainfed", "tot_rice"};
+static const char *epa_names[] = {"mb_L1.bil", "mb_L2.bil", "mb_L3.bil", "mb_L4.bil", "mb_ALL_IUCN.bil", "mb_IUCN_1a_1b_2.bil"};
+static const int lu_lulc_hyde[] = {1, 2, 2, 2, 2, 2, 3, 3};
+
+// benchmark settings
+static int num_reps = 3;
+static int hyde_rows = 1080;
+static int num_lulc = 20000;
+static int group_size = 400;
+static char kernel_prefix[MAXCHAR];
+static uint64_t seed = 1;
+static char scratch[MAXCHAR];
+
+static args_struct mb_args;
+static rinfo_struct mb_rinfo;
+
+/***** utilities *****/
+
+// deterministic value in [0,1) for index i and salt k (splitmix64)
+static double hash_unit(uint64_t i, uint64_t k) {
+	uint64_t z = i * 0x9E3779B97F4A7C15ULL + (k + 1) * 0xBF58476D1CE4E5B9ULL + seed * 0x94D049BB133111EBULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	z = z ^ (z >> 31);
+	return (double) (z >> 11) / 9007199254740992.0;
+}
+
+static double get_sec(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + (double) ts.tv_nsec / 1.0e9;
+}
+
+static long long file_bytes(const char *fname) {
+	struct stat st;
+	if (stat(fname, &st) != 0) {
+		return 0;
+	}
+	return (long long) st.st_size;
+}
+
+// build a file or directory name with snprintf; returns ERROR_FILE if it does not fit in MAXCHAR
+static int make_path(char *path, const char *format, ...) {
+	va_list ap;
+	int len;
+	va_start(ap, format);
+	len = vsnprintf(path, MAXCHAR, format, ap);
+	va_end(ap);
+	if (len < 0 || len >= MAXCHAR) {
+		fprintf(stderr, "Path longer than %i characters: %s: moirai_microbench\n", MAXCHAR - 1, path);
+		return ERROR_FILE;
+	}
+	return OK;
+}
+
+static int make_dir(const char *path) {
+	if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+		fprintf(stderr, "Failed to create directory %s: moirai_microbench\n", path);
+		return ERROR_FILE;
+	}
+	return OK;
+}
+
+// a kernel group is run if its name and the -k string match up to the shorter of the two
+static int run_kernel(const char *name) {
+	size_t len = strlen(kernel_prefix);
+	if (strlen(name) < len) {
+		len = strlen(name);
+	}
+	return strncmp(name, kernel_prefix, len) == 0;
+}
+
+static void print_result(const char *name, const char *units, long long count, long long bytes, double best_sec) {
+	fprintf(stdout, "%-20s\t%-8s\t%12lld\t%10.4f\t%12.2f\t%10.1f\n", name, units, count, best_sec,
+			(count > 0) ? best_sec * 1.0e9 / count : 0, (best_sec > 0) ? bytes / 1.0e6 / best_sec : 0);
+	fflush(stdout);
+}
+
+static float *alloc_float(size_t n, const char *name) {
+	float *p = calloc(n, sizeof(float));
+	if (p == NULL) {
+		fprintf(stderr, "Failed to allocate memory for %s: moirai_microbench\n", name);
+	}
+	return p;
+}
+
+/***** shared working grid globals *****/
+
+// cell area, hyde land area, and potential vegetation on the full working grid
+//	land is a smooth pattern in the 0.5 degree cells so that most lulc cells are all land or all ocean
+static int setup_grid(void) {
+	int i, r, c, err;
+	double lat1, lat2, f;
+
+	// default 5 arcmin working grid and half degree lulc grid
+	mb_args.grid_res_sec = DEFAULT_GRID_RES_SEC;
+	mb_args.lulc_res_sec = DEFAULT_LULC_RES_SEC;
+	if ((err = set_grid_geometry(mb_args, &mb_rinfo)) != OK) {
+		return err;
+	}
+
+	// the hyde cell area is stored per row, as get_cell_area() does for a regular grid
+	cell_area_hyde = NULL;
+	cell_area_hyde_row = alloc_float(NUM_LAT, "cell_area_hyde_row");
+	land_area_hyde = alloc_float(NUM_CELLS, "land_area_hyde");
+	potveg_thematic = calloc(NUM_CELLS, sizeof(int));
+	if (cell_area_hyde_row == NULL || land_area_hyde == NULL || potveg_thematic == NULL) {
+		return ERROR_MEM;
+	}
+	for (r = 0; r < NUM_LAT; r++) {
+		lat1 = 90.0 - r * 180.0 / NUM_LAT;
+		lat2 = lat1 - 180.0 / NUM_LAT;
+		cell_area_hyde_row[r] = AVE_ER * AVE_ER * (360.0 / NUM_LON) * DEG2RAD * fabs(sin(lat1 * DEG2RAD) - sin(lat2 * DEG2RAD));
+		for (c = 0; c < NUM_LON; c++) {
+			i = r * NUM_LON + c;
+			f = 0.5 + 0.25 * sin(c / 37.0) + 0.25 * cos(r / 23.0);
+			if (f > 0.45 && fabs(lat1) < 84.0) {
+				land_area_hyde[i] = cell_area_hyde_row[r] * (0.8 + 0.2 * hash_unit(i, 1));
+			} else {
+				land_area_hyde[i] = NODATA;
+			}
+			// potential vegetation is always valid here
+			potveg_thematic[i] = 1 + (int) (NUM_MB_PVLT * hash_unit(i / 6, 2));
+		}
+	}
+	mb_rinfo.land_area_hyde_nodata = NODATA;
+	mb_rinfo.lu_nodata = NODATA;
+	mb_rinfo.lulc_input_nodata = NODATA;
+	mb_rinfo.potveg_nodata = NODATA;
+
+	NUM_HYDE_TYPES = NUM_MB_HYDE;
+	NUM_SAGE_PVLT = NUM_MB_PVLT;
+	NUM_LULC_TYPES = NUM_LULC_LC_TYPES + NUM_MB_LULC_LU;
+	NUM_LU_CELLS = mb_rinfo.num_split * mb_rinfo.num_split;
+	return OK;
+}
+
+/***** read_hyde32 *****/
+
+static int bench_hyde32(void) {
+	int i, k, r, c, rep, err;
+	int ncols = 2 * hyde_rows;
+	int ncells = hyde_rows * ncols;
+	long long bytes = 0;
+	double t, best = 0;
+	float *urban, *crop, *pasture;
+	rinfo_struct hyde_rinfo = mb_rinfo;		// read_hyde32() checks the file dims against the grid, so match them here
+	char path[MAXCHAR];
+	char fname[MAXCHAR];
+	FILE *fp;
+
+	if (make_path(path, "%shyde/", scratch) || make_dir(path)) { return ERROR_FILE; }
+	strcpy(mb_args.hydepath, path);
+
+	lutypenames_hyde = calloc(NUM_MB_HYDE, sizeof(char *));
+	if (lutypenames_hyde == NULL) { return ERROR_MEM; }
+	for (k = 0; k < NUM_MB_HYDE; k++) {
+		lutypenames_hyde[k] = (char *) hyde_names[k];
+		if (make_path(fname, "%s%s%iAD.asc", path, hyde_names[k], MB_YEAR)) { return ERROR_FILE; }
+		if ((fp = fopen(fname, "w")) == NULL) {
+			fprintf(stderr, "Failed to open file %s: moirai_microbench\n", fname);
+			return ERROR_FILE;
+		}
+		fprintf(fp, "ncols         %i\r\nnrows         %i\r\nxllcorner     -180\r\nyllcorner     -90\r\n"
+				"cellsize      %.15f\r\nNODATA_value  -9999\r\n", ncols, hyde_rows, 360.0 / ncols);
+		for (r = 0; r < hyde_rows; r++) {
+			for (c = 0; c < ncols; c++) {
+				i = r * ncols + c;
+				if (0.5 + 0.25 * sin(c / 37.0) + 0.25 * cos(r / 23.0) > 0.45) {
+					fprintf(fp, "%s%.6f", (c == 0) ? "" : " ", 10.0 * hash_unit(i, 10 + k));
+				} else {
+					fprintf(fp, "%s-9999", (c == 0) ? "" : " ");
+				}
+			}
+			fprintf(fp, "\r\n");
+		}
+		fclose(fp);
+		bytes += file_bytes(fname);
+	}
+
+	urban = alloc_float(ncells, "urban");
+	crop = alloc_float(ncells, "crop");
+	pasture = alloc_float(ncells, "pasture");
+	lu_detail_area = calloc(NUM_MB_HYDE - NUM_HYDE_TYPES_MAIN, sizeof(float *));
+	if (urban == NULL || crop == NULL || pasture == NULL || lu_detail_area == NULL) { return ERROR_MEM; }
+	for (k = 0; k < NUM_MB_HYDE - NUM_HYDE_TYPES_MAIN; k++) {
+		if ((lu_detail_area[k] = alloc_float(ncells, "lu_detail_area")) == NULL) { return ERROR_MEM; }
+	}
+	hyde_rinfo.grid_nrows = hyde_rows;
+	hyde_rinfo.grid_ncols = ncols;
+	hyde_rinfo.grid_ncells = ncells;
+
+	for (rep = 0; rep < num_reps; rep++) {
+		t = get_sec();
+		if ((err = read_hyde32(mb_args, &hyde_rinfo, MB_YEAR, crop, pasture, urban, lu_detail_area)) != OK) {
+			fprintf(stderr, "read_hyde32() failed with error %i: moirai_microbench\n", err);
+			return err;
+		}
+		t = get_sec() - t;
+		if (rep == 0 || t < best) { best = t; }
+	}
+	print_result("read_hyde32", "cell", (long long) ncells * NUM_MB_HYDE, bytes, best);
+
+	free(urban);
+	free(crop);
+	free(pasture);
+	for (k = 0; k < NUM_MB_HYDE - NUM_HYDE_TYPES_MAIN; k++) {
+		free(lu_detail_area[k]);
+	}
+	free(lu_detail_area);
+	return OK;
+}
+
+/***** read_lulc_isam *****/
+
+#define NC_CHECK(call) if ((ncerr = (call))) { \
+	fprintf(stderr, "Error %i (%s) writing netcdf file %s: moirai_microbench\n", ncerr, nc_strerror(ncerr), fname); \
+	return ERROR_FILE; }
+
+static int bench_lulc_isam(void) {
+	int i, j, rep, err, ncid, ncerr;
+	int dimids[3];
+	int area_id, frac_id;
+	double t, best = 0;
+	float *area, *frac;
+	char fname[MAXCHAR];
+
+	strcpy(mb_args.lulcpath, scratch);
+	if (make_path(fname, "%sISAM_HYDE32_LANDCOVER_%i.nc", scratch, MB_YEAR)) { return ERROR_FILE; }
+	area = alloc_float(NUM_CELLS_LULC, "isam area");
+	frac = alloc_float((size_t) NUM_LULC_TYPES * NUM_CELLS_LULC, "isam frac");
+	if (area == NULL || frac == NULL) { return ERROR_MEM; }
+	for (i = 0; i < NUM_CELLS_LULC; i++) {
+		area[i] = 2.5e9 * cos((-90.0 + (i / NUM_LON_LULC + 0.5) * 0.5) * DEG2RAD);
+		j = (int) (NUM_LULC_TYPES * hash_unit(i, 20));
+		frac[(size_t) j * NUM_CELLS_LULC + i] = 6000;
+		j = (int) (NUM_LULC_TYPES * hash_unit(i, 21));
+		frac[(size_t) j * NUM_CELLS_LULC + i] += 4000;
+	}
+	NC_CHECK(nc_create(fname, NC_CLOBBER | NC_64BIT_OFFSET, &ncid));
+	NC_CHECK(nc_def_dim(ncid, "lctype", NUM_LULC_TYPES, &dimids[0]));
+	NC_CHECK(nc_def_dim(ncid, "lat", NUM_LAT_LULC, &dimids[1]));
+	NC_CHECK(nc_def_dim(ncid, "lon", NUM_LON_LULC, &dimids[2]));
+	NC_CHECK(nc_def_var(ncid, "Grid_area", NC_FLOAT, 2, &dimids[1], &area_id));
+	NC_CHECK(nc_def_var(ncid, "LC_fraction", NC_FLOAT, 3, dimids, &frac_id));
+	NC_CHECK(nc_enddef(ncid));
+	NC_CHECK(nc_put_var_float(ncid, area_id, area));
+	NC_CHECK(nc_put_var_float(ncid, frac_id, frac));
+	NC_CHECK(nc_close(ncid));
+	free(area);
+	free(frac);
+
+	lulc_input_grid = calloc(NUM_LULC_TYPES, sizeof(float *));
+	if (lulc_input_grid == NULL) { return ERROR_MEM; }
+	for (j = 0; j < NUM_LULC_TYPES; j++) {
+		if ((lulc_input_grid[j] = alloc_float(NUM_CELLS_LULC, "lulc_input_grid")) == NULL) { return ERROR_MEM; }
+	}
+
+	for (rep = 0; rep < num_reps; rep++) {
+		t = get_sec();
+		if ((err = read_lulc_isam(mb_args, MB_YEAR, lulc_input_grid)) != OK) {
+			fprintf(stderr, "read_lulc_isam() failed with error %i: moirai_microbench\n", err);
+			return err;
+		}
+		t = get_sec() - t;
+		if (rep == 0 || t < best) { best = t; }
+	}
+	print_result("read_lulc_isam", "cell", (long long) NUM_LULC_TYPES * NUM_CELLS_LULC, file_bytes(fname), best);
+
+	for (j = 0; j < NUM_LULC_TYPES; j++) {
+		free(lulc_input_grid[j]);
+	}
+	free(lulc_input_grid);
+	return OK;
+}
+
+/***** proc_lulc_area *****/
+
+static int bench_lulc_area(void) {
+	int i, j, m, n, c, rep, err, count, tmp;
+	int first_lulc = (NUM_LAT_LULC / 4) * NUM_LON_LULC;	// start in the northern mid-latitudes
+	int num_split = NUM_LAT / NUM_LAT_LULC;
+	int row, col;
+	int *lu_indices, *refveg_them;
+	double *lulc_area, *refveg_area_out;
+	double **lu_area;
+	double t, best = 0;
+
+	if (first_lulc + num_lulc > NUM_CELLS_LULC) {
+		num_lulc = NUM_CELLS_LULC - first_lulc;
+	}
+
+	// randomized order of the working cells within each lulc cell, as in calc_refveg_area()
+	rand_order = calloc(NUM_CELLS_LULC, sizeof(float *));
+	if (rand_order == NULL) { return ERROR_MEM; }
+	for (c = first_lulc; c < first_lulc + num_lulc; c++) {
+		if ((rand_order[c] = alloc_float(NUM_LU_CELLS, "rand_order")) == NULL) { return ERROR_MEM; }
+		for (j = 0; j < NUM_LU_CELLS; j++) {
+			rand_order[c][j] = j;
+		}
+		for (j = NUM_LU_CELLS - 1; j > 0; j--) {
+			m = (int) ((j + 1) * hash_unit(c * NUM_LU_CELLS + j, 30));
+			tmp = rand_order[c][j];
+			rand_order[c][j] = rand_order[c][m];
+			rand_order[c][m] = tmp;
+		}
+	}
+
+	lulc2sagecodes = calloc(NUM_LULC_TYPES, sizeof(int));
+	lulc2hydecodes = calloc(NUM_LULC_TYPES, sizeof(int));
+	landtypecodes_sage = calloc(NUM_SAGE_PVLT, sizeof(int));
+	lulc_area = calloc(NUM_LULC_TYPES, sizeof(double));
+	lu_indices = calloc(NUM_LU_CELLS, sizeof(int));
+	refveg_them = calloc(NUM_LU_CELLS, sizeof(int));
+	refveg_area_out = calloc(NUM_LU_CELLS, sizeof(double));
+	lu_area = calloc(NUM_LU_CELLS, sizeof(double *));
+	if (lulc2sagecodes == NULL || lulc2hydecodes == NULL || landtypecodes_sage == NULL || lulc_area == NULL ||
+		lu_indices == NULL || refveg_them == NULL || refveg_area_out == NULL || lu_area == NULL) {
+		return ERROR_MEM;
+	}
+	for (j = 0; j < NUM_LU_CELLS; j++) {
+		if ((lu_area[j] = calloc(NUM_HYDE_TYPES, sizeof(double))) == NULL) { return ERROR_MEM; }
+	}
+	for (j = 0; j < NUM_SAGE_PVLT; j++) {
+		landtypecodes_sage[j] = j + 1;
+	}
+	for (j = 0; j < NUM_LULC_LC_TYPES; j++) {
+		lulc2sagecodes[j] = (j == NUM_LULC_LC_TYPES - 1) ? NOMATCH : j % NUM_SAGE_PVLT + 1;
+		lulc2hydecodes[j] = NOMATCH;
+	}
+	for (j = 0; j < NUM_MB_LULC_LU; j++) {
+		lulc2sagecodes[NUM_LULC_LC_TYPES + j] = NOMATCH;
+		lulc2hydecodes[NUM_LULC_LC_TYPES + j] = lu_lulc_hyde[j];
+	}
+
+	for (rep = 0; rep < num_reps; rep++) {
+		t = get_sec();
+		for (c = first_lulc; c < first_lulc + num_lulc; c++) {
+			// fill the inputs for this lulc cell, as in proc_land_type_area()
+			for (j = 0; j < NUM_LULC_TYPES; j++) {
+				lulc_area[j] = 100.0 * hash_unit(c, 40 + j);
+			}
+			row = (c / NUM_LON_LULC) * num_split;
+			col = (c % NUM_LON_LULC) * num_split;
+			count = 0;
+			for (m = row; m < row + num_split; m++) {
+				for (n = col; n < col + num_split; n++) {
+					lu_indices[count] = m * NUM_LON + n;
+					i = lu_indices[count];
+					if (land_area_hyde[i] != NODATA) {
+						lu_area[count][0] = 0.02 * land_area_hyde[i];
+						lu_area[count][1] = 0.3 * land_area_hyde[i] * hash_unit(i, 3);
+						lu_area[count][2] = 0.3 * land_area_hyde[i] * hash_unit(i, 4);
+						lu_area[count][3] = 0.5 * lu_area[count][2];
+						lu_area[count][4] = 0.5 * lu_area[count][2];
+						for (j = 5; j < NUM_HYDE_TYPES; j++) {
+							lu_area[count][j] = 0.25 * lu_area[count][1];
+						}
+					} else {
+						for (j = 0; j < NUM_HYDE_TYPES; j++) {
+							lu_area[count][j] = NODATA;
+						}
+					}
+					refveg_area_out[count] = 0;
+					refveg_them[count] = 0;
+					count++;
+				}
+			}
+			if ((err = proc_lulc_area(mb_args, mb_rinfo, lulc_area, lu_indices, lu_area, refveg_area_out, refveg_them,
+									  NUM_LU_CELLS, c)) != OK) {
+				fprintf(stderr, "proc_lulc_area() failed with error %i for lulc cell %i: moirai_microbench\n", err, c);
+				return err;
+			}
+		}
+		t = get_sec() - t;
+		if (rep == 0 || t < best) { best = t; }
+	}
+	print_result("proc_lulc_area", "cell", (long long) num_lulc * NUM_LU_CELLS,
+				 (long long) num_lulc * (NUM_LULC_TYPES + NUM_LU_CELLS * NUM_HYDE_TYPES) * sizeof(double), best);
+
+	for (c = first_lulc; c < first_lulc + num_lulc; c++) {
+		free(rand_order[c]);
+	}
+	free(rand_order);
+	for (j = 0; j < NUM_LU_CELLS; j++) {
+		free(lu_area[j]);
+	}
+	free(lu_area);
+	free(lulc_area);
+	free(lu_indices);
+	free(refveg_them);
+	free(refveg_area_out);
+	return OK;
+}
+
+/***** read_protected *****/
+
+static int bench_protected(void) {
+	int i, k, rep, err;
+	long long bytes = 0;
+	double t, best = 0;
+	double h;
+	// fractions of h for L1, L2, L3, L4, ALL_IUCN, IUCN_1a_1b_2
+	//	these satisfy L4 <= L2 <= L3 <= L1, IUCN_1a_1b_2 >= L1 - L2, and ALL_IUCN >= IUCN_1a_1b_2 + L2 - L4
+	const float epa_scale[] = {0.3, 0.1, 0.2, 0.05, 0.4, 0.25};
+	float *epa;
+	char fname[MAXCHAR];
+	FILE *fp;
+
+	strcpy(mb_args.inpath, scratch);
+	strcpy(mb_args.L1_fname, epa_names[0]);
+	strcpy(mb_args.L2_fname, epa_names[1]);
+	strcpy(mb_args.L3_fname, epa_names[2]);
+	strcpy(mb_args.L4_fname, epa_names[3]);
+	strcpy(mb_args.ALL_IUCN_fname, epa_names[4]);
+	strcpy(mb_args.IUCN_1a_1b_2_fname, epa_names[5]);
+
+	if ((epa = alloc_float(NUM_CELLS, "epa")) == NULL) { return ERROR_MEM; }
+	for (k = 0; k < 6; k++) {
+		for (i = 0; i < NUM_CELLS; i++) {
+			h = (land_area_hyde[i] != NODATA) ? hash_unit(i, 50) : 0;
+			epa[i] = epa_scale[k] * h;
+		}
+		if (make_path(fname, "%s%s", scratch, epa_names[k])) { return ERROR_FILE; }
+		if ((fp = fopen(fname, "wb")) == NULL || fwrite(epa, sizeof(float), NUM_CELLS, fp) != (size_t) NUM_CELLS) {
+			fprintf(stderr, "Failed to write file %s: moirai_microbench\n", fname);
+			return ERROR_FILE;
+		}
+		fclose(fp);
+		bytes += file_bytes(fname);
+	}
+	free(epa);
+
+	protected_EPA = calloc(NUM_EPA_PROTECTED, sizeof(float *));
+	if (protected_EPA == NULL) { return ERROR_MEM; }
+	for (k = 0; k < NUM_EPA_PROTECTED; k++) {
+		if ((protected_EPA[k] = alloc_float(NUM_CELLS, "protected_EPA")) == NULL) { return ERROR_MEM; }
+	}
+
+	for (rep = 0; rep < num_reps; rep++) {
+		t = get_sec();
+		if ((err = read_protected(mb_args, &mb_rinfo)) != OK) {
+			fprintf(stderr, "read_protected() failed with error %i: moirai_microbench\n", err);
+			return err;
+		}
+		t = get_sec() - t;
+		if (rep == 0 || t < best) { best = t; }
+	}
+	print_result("read_protected", "cell", NUM_CELLS, bytes, best);
+
+	for (k = 0; k < NUM_EPA_PROTECTED; k++) {
+		free(protected_EPA[k]);
+	}
+	free(protected_EPA);
+	return OK;
+}
+
+/***** lookups *****/
+
+// fao countries with shuffled codes and 1 to NUM_MB_MAX_GLU glus each, and the land type categories
+//	these are also used by the csv writers
+static int setup_tables(void) {
+	int i, j, k, m, tmp;
+
+	NUM_FAO_CTRY = NUM_MB_FAO_CTRY;
+	NUM_SAGE_CROP = NUM_MB_CROP;
+	countrycodes_fao = calloc(NUM_FAO_CTRY, sizeof(int));
+	ctry2ctry87codes_gtap = calloc(NUM_FAO_CTRY, sizeof(int));
+	ctry_aez_num = calloc(NUM_FAO_CTRY, sizeof(int));
+	ctry_aez_list = calloc(NUM_FAO_CTRY, sizeof(int *));
+	countryabbrs_iso = calloc(NUM_FAO_CTRY, sizeof(char *));
+	cropnames_gtap = calloc(NUM_SAGE_CROP, sizeof(char *));
+	cropcodes_sage = calloc(NUM_SAGE_CROP, sizeof(int));
+	if (countrycodes_fao == NULL || ctry2ctry87codes_gtap == NULL || ctry_aez_num == NULL || ctry_aez_list == NULL ||
+		countryabbrs_iso == NULL || cropnames_gtap == NULL || cropcodes_sage == NULL) {
+		return ERROR_MEM;
+	}
+	for (i = 0; i < NUM_FAO_CTRY; i++) {
+		countrycodes_fao[i] = i + 1;
+	}
+	for (i = NUM_FAO_CTRY - 1; i > 0; i--) {
+		m = (int) ((i + 1) * hash_unit(i, 60));
+		tmp = countrycodes_fao[i];
+		countrycodes_fao[i] = countrycodes_fao[m];
+		countrycodes_fao[m] = tmp;
+	}
+	for (i = 0; i < NUM_FAO_CTRY; i++) {
+		ctry2ctry87codes_gtap[i] = (i % 40 == 39) ? NOMATCH : i % 87 + 1;
+		ctry_aez_num[i] = 1 + (int) (NUM_MB_MAX_GLU * hash_unit(i, 61));
+		if ((ctry_aez_list[i] = calloc(ctry_aez_num[i], sizeof(int))) == NULL ||
+			(countryabbrs_iso[i] = calloc(4, sizeof(char))) == NULL) {
+			return ERROR_MEM;
+		}
+		for (j = 0; j < ctry_aez_num[i]; j++) {
+			ctry_aez_list[i][j] = 1 + (i * 7 + j * 13) % 235;
+		}
+		sprintf(countryabbrs_iso[i], "x%02x", i % 256);
+	}
+	for (k = 0; k < NUM_SAGE_CROP; k++) {
+		if ((cropnames_gtap[k] = calloc(MAXCHAR, sizeof(char))) == NULL) { return ERROR_MEM; }
+		sprintf(cropnames_gtap[k], "crop%03i", k + 1);
+		cropcodes_sage[k] = k + 1;
+	}
+
+	// land type categories, as in write_glu_mapping()
+	num_lt_cats = (NUM_SAGE_PVLT + 1) * NUM_LU_CATS * NUM_EPA_PROTECTED;
+	if ((lt_cats = calloc(num_lt_cats, sizeof(int))) == NULL) { return ERROR_MEM; }
+	m = 0;
+	for (k = 0; k <= NUM_SAGE_PVLT; k++) {
+		for (j = 0; j < NUM_LU_CATS; j++) {
+			for (i = 0; i < NUM_EPA_PROTECTED; i++) {
+				lt_cats[m++] = (k * SCALE_POTVEG) + (j * 10) + i;
+			}
+		}
+	}
+	return OK;
+}
+
+static int bench_lookups(void) {
+	int i, j, k, rep;
+	int num_cells = 0;
+	int ctry_code, ctry_ind, aez_val, aez_ind, cur_lt_cat, cur_lt_cat_ind;
+	long long sum_ind;		// keeps the lookups from being optimized away
+	int *cell_ctry, *cell_glu, *cell_pv;
+	double t, best_ctry = 0, best_glu = 0, best_cat = 0;
+
+	// one land cell in four, with a country, a glu in the country, and a potential vegetation type
+	for (i = 0; i < NUM_CELLS; i += 4) {
+		if (land_area_hyde[i] != NODATA) { num_cells++; }
+	}
+	cell_ctry = calloc(num_cells, sizeof(int));
+	cell_glu = calloc(num_cells, sizeof(int));
+	cell_pv = calloc(num_cells, sizeof(int));
+	if (cell_ctry == NULL || cell_glu == NULL || cell_pv == NULL) { return ERROR_MEM; }
+	j = 0;
+	for (i = 0; i < NUM_CELLS; i += 4) {
+		if (land_area_hyde[i] != NODATA) {
+			k = (int) (NUM_FAO_CTRY * hash_unit(i / 64, 62));
+			cell_ctry[j] = countrycodes_fao[k];
+			cell_glu[j] = ctry_aez_list[k][(int) (ctry_aez_num[k] * hash_unit(i / 16, 63))];
+			cell_pv[j] = potveg_thematic[i];
+			j++;
+		}
+	}
+
+	sum_ind = 0;
+	for (rep = 0; rep < num_reps; rep++) {
+		// country, as in proc_refveg_carbon()
+		t = get_sec();
+		for (j = 0; j < num_cells; j++) {
+			ctry_code = cell_ctry[j];
+			ctry_ind = NOMATCH;
+			for (i = 0; i < NUM_FAO_CTRY; i++) {
+				if (countrycodes_fao[i] == ctry_code) {
+					ctry_ind = i;
+					break;
+				}
+			}
+			cell_ctry[j] = countrycodes_fao[ctry_ind];
+			sum_ind += ctry_ind;
+		}
+		t = get_sec() - t;
+		if (rep == 0 || t < best_ctry) { best_ctry = t; }
+
+		// glu within the country, as in proc_refveg_carbon(); the country index lookup is not timed
+		for (j = 0; j < num_cells; j++) {
+			for (i = 0; i < NUM_FAO_CTRY; i++) {
+				if (countrycodes_fao[i] == cell_ctry[j]) {
+					cell_ctry[j] = i;
+					break;
+				}
+			}
+		}
+		t = get_sec();
+		for (j = 0; j < num_cells; j++) {
+			ctry_ind = cell_ctry[j];
+			aez_val = cell_glu[j];
+			aez_ind = NOMATCH;
+			for (i = 0; i < ctry_aez_num[ctry_ind]; i++) {
+				if (ctry_aez_list[ctry_ind][i] == aez_val) {
+					aez_ind = i;
+					break;
+				}
+			}
+			sum_ind += aez_ind;
+		}
+		t = get_sec() - t;
+		if (rep == 0 || t < best_glu) { best_glu = t; }
+		for (j = 0; j < num_cells; j++) {
+			cell_ctry[j] = countrycodes_fao[cell_ctry[j]];
+		}
+
+		// land type category for each protected category, as in proc_refveg_carbon()
+		t = get_sec();
+		for (j = 0; j < num_cells; j++) {
+			for (k = 0; k < NUM_EPA_PROTECTED; k++) {
+				cur_lt_cat = cell_pv[j] * SCALE_POTVEG + k;
+				cur_lt_cat_ind = NOMATCH;
+				for (i = 0; i < num_lt_cats; i++) {
+					if (lt_cats[i] == cur_lt_cat) {
+						cur_lt_cat_ind = i;
+						break;
+					}
+				}
+				sum_ind += cur_lt_cat_ind;
+			}
+		}
+		t = get_sec() - t;
+		if (rep == 0 || t < best_cat) { best_cat = t; }
+	}
+	print_result("lookup_country", "lookup", num_cells, (long long) num_cells * sizeof(int), best_ctry);
+	print_result("lookup_glu", "lookup", num_cells, (long long) num_cells * 2 * sizeof(int), best_glu);
+	print_result("lookup_category", "lookup", (long long) num_cells * NUM_EPA_PROTECTED, (long long) num_cells * sizeof(int), best_cat);
+	fprintf(fplog, "lookup index checksum %lld: moirai_microbench\n", sum_ind);
+
+	free(cell_ctry);
+	free(cell_glu);
+	free(cell_pv);
+	return OK;
+}
+
+/***** carbon quantiles *****/
+
+static int bench_carbon_quantile(void) {
+	int g, i, j, k, rep, size, size_max;
+	int num_cells = NUM_MB_GROUPS * group_size;
+	float ***carbon;		// dim 1 = soil (0) or veg (1); dim 2 = statistic; dim 3 = cells in the group
+	float out[2][NUM_MB_CARBON_STATS];
+	double check = 0;
+	double t, best = 0;
+
+	carbon = calloc(2, sizeof(float **));
+	if (carbon == NULL) { return ERROR_MEM; }
+	for (k = 0; k < 2; k++) {
+		if ((carbon[k] = calloc(NUM_MB_CARBON_STATS, sizeof(float *))) == NULL) { return ERROR_MEM; }
+		for (j = 0; j < NUM_MB_CARBON_STATS; j++) {
+			if ((carbon[k][j] = alloc_float(group_size, "carbon")) == NULL) { return ERROR_MEM; }
+		}
+	}
+
+	for (rep = 0; rep < num_reps; rep++) {
+		t = get_sec();
+		for (g = 0; g < NUM_MB_GROUPS; g++) {
+			// each cell is added to its group and the group arrays are sorted again
+			for (i = 0; i < group_size; i++) {
+				for (k = 0; k < 2; k++) {
+					for (j = 0; j < NUM_MB_CARBON_STATS; j++) {
+						carbon[k][j][i] = (float) (1000.0 * hash_unit(g * group_size + i, 80 + 10 * k + j));
+					}
+				}
+				size = i + 1;
+				size_max = size - 1;
+				for (k = 0; k < 2; k++) {
+					for (j = 0; j < NUM_MB_CARBON_STATS; j++) {
+						qsort(carbon[k][j], size, sizeof(float), cmpfunc);
+					}
+					out[k][0] = carbon[k][0][size / 2];
+					out[k][1] = carbon[k][1][0];
+					out[k][2] = carbon[k][2][size_max];
+					out[k][3] = carbon[k][3][(int) (size * 0.25)];
+					out[k][4] = carbon[k][4][(int) (size * 0.75)];
+				}
+			}
+			for (k = 0; k < 2; k++) {
+				for (j = 0; j < NUM_MB_CARBON_STATS; j++) {
+					check += out[k][j];
+				}
+			}
+		}
+		t = get_sec() - t;
+		if (rep == 0 || t < best) { best = t; }
+	}
+	print_result("carbon_quantile", "cell", num_cells, (long long) num_cells * 2 * NUM_MB_CARBON_STATS * sizeof(float), best);
+	fprintf(fplog, "carbon quantile checksum %f: moirai_microbench\n", check);
+
+	for (k = 0; k < 2; k++) {
+		for (j = 0; j < NUM_MB_CARBON_STATS; j++) {
+			free(carbon[k][j]);
+		}
+		free(carbon[k]);
+	}
+	free(carbon);
+	return OK;
+}
+
+/***** csv writers *****/
+
+static int bench_csv(void) {
+	int i, j, k, rep, err;
+	int num_glu = NUM_MB_MAX_GLU;
+	int *d1, *d2;
+	float *values;
+	double t, best_2d = 0, best_3d = 0, best_ha = 0;
+	char fname[MAXCHAR];
+
+	strcpy(mb_args.outpath, scratch);
+	strcpy(mb_args.harvestarea_fname, "mb_harvestarea.csv");
+
+	d1 = calloc(NUM_FAO_CTRY * num_glu > NUM_MB_CSV_RECORDS ? NUM_FAO_CTRY * num_glu : NUM_MB_CSV_RECORDS, sizeof(int));
+	d2 = calloc(num_glu, sizeof(int));
+	values = alloc_float((size_t) NUM_FAO_CTRY * num_glu * NUM_SAGE_CROP, "csv values");
+	if (d1 == NULL || d2 == NULL || values == NULL) { return ERROR_MEM; }
+	for (i = 0; i < NUM_FAO_CTRY * num_glu * NUM_SAGE_CROP; i++) {
+		values[i] = (float) (1.0e5 * hash_unit(i, 90));
+	}
+	for (i = 0; i < NUM_MB_CSV_RECORDS; i++) {
+		d1[i] = i;
+	}
+	for (j = 0; j < num_glu; j++) {
+		d2[j] = j + 1;
+	}
+
+	// the harvested area and production tables, with some zero values that are not written
+	harvestarea_crop_aez = calloc(NUM_FAO_CTRY, sizeof(float **));
+	production_crop_aez = calloc(NUM_FAO_CTRY, sizeof(float **));
+	if (harvestarea_crop_aez == NULL || production_crop_aez == NULL) { return ERROR_MEM; }
+	for (i = 0; i < NUM_FAO_CTRY; i++) {
+		harvestarea_crop_aez[i] = calloc(ctry_aez_num[i], sizeof(float *));
+		production_crop_aez[i] = calloc(ctry_aez_num[i], sizeof(float *));
+		if (harvestarea_crop_aez[i] == NULL || production_crop_aez[i] == NULL) { return ERROR_MEM; }
+		for (j = 0; j < ctry_aez_num[i]; j++) {
+			harvestarea_crop_aez[i][j] = alloc_float(NUM_SAGE_CROP, "harvestarea_crop_aez");
+			production_crop_aez[i][j] = alloc_float(NUM_SAGE_CROP, "production_crop_aez");
+			if (harvestarea_crop_aez[i][j] == NULL || production_crop_aez[i][j] == NULL) { return ERROR_MEM; }
+			for (k = 0; k < NUM_SAGE_CROP; k++) {
+				if (hash_unit((i * NUM_MB_MAX_GLU + j) * NUM_SAGE_CROP + k, 91) < 0.3) {
+					harvestarea_crop_aez[i][j][k] = 1.0e4 * hash_unit(k, 92) + 1;
+					production_crop_aez[i][j][k] = 3.0 * harvestarea_crop_aez[i][j][k];
+				}
+			}
+		}
+	}
+
+	for (rep = 0; rep < num_reps; rep++) {
+		t = get_sec();
+		if ((err = write_csv_float2d(values, d1, NUM_MB_CSV_RECORDS, NUM_LULC_TYPES, "mb_float2d.csv", mb_args)) != OK) {
+			fprintf(stderr, "write_csv_float2d() failed with error %i: moirai_microbench\n", err);
+			return err;
+		}
+		t = get_sec() - t;
+		if (rep == 0 || t < best_2d) { best_2d = t; }
+
+		t = get_sec();
+		if ((err = write_csv_float3d(values, d1, d2, NUM_FAO_CTRY, num_glu, NUM_SAGE_CROP, "mb_float3d.csv", mb_args)) != OK) {
+			fprintf(stderr, "write_csv_float3d() failed with error %i: moirai_microbench\n", err);
+			return err;
+		}
+		t = get_sec() - t;
+		if (rep == 0 || t < best_3d) { best_3d = t; }
+
+		t = get_sec();
+		if ((err = write_harvestarea_crop_aez(mb_args)) != OK) {
+			fprintf(stderr, "write_harvestarea_crop_aez() failed with error %i: moirai_microbench\n", err);
+			return err;
+		}
+		t = get_sec() - t;
+		if (rep == 0 || t < best_ha) { best_ha = t; }
+	}
+	if (make_path(fname, "%smb_float2d.csv", scratch)) { return ERROR_FILE; }
+	print_result("write_csv_float2d", "value", (long long) NUM_MB_CSV_RECORDS * NUM_LULC_TYPES, file_bytes(fname), best_2d);
+	if (make_path(fname, "%smb_float3d.csv", scratch)) { return ERROR_FILE; }
+	print_result("write_csv_float3d", "value", (long long) NUM_FAO_CTRY * num_glu * NUM_SAGE_CROP, file_bytes(fname), best_3d);
+	k = 0;
+	for (i = 0; i < NUM_FAO_CTRY; i++) {
+		k += ctry_aez_num[i] * NUM_SAGE_CROP;
+	}
+	if (make_path(fname, "%smb_harvestarea.csv", scratch)) { return ERROR_FILE; }
+	print_result("write_harvestarea", "value", k, file_bytes(fname), best_ha);
+
+	free(d1);
+	free(d2);
+	free(values);
+	return OK;
+}
+
+static void usage(void) {
+	fprintf(stderr, "usage: moirai_microbench [-n num_reps] [-r hyde_rows] [-l num_lulc] [-g group_size] [-k kernel] [-s seed] scratch_dir\n");
+}
+
+int main(int argc, char *argv[]) {
+
+	int opt;
+	int err = OK;
+	char fname[MAXCHAR];
+
+	memset(kernel_prefix, '\0', MAXCHAR);
+	while ((opt = getopt(argc, argv, "n:r:l:g:k:s:")) != -1) {
+		switch (opt) {
+			case 'n': num_reps = atoi(optarg); break;
+			case 'r': hyde_rows = atoi(optarg); break;
+			case 'l': num_lulc = atoi(optarg); break;
+			case 'g': group_size = atoi(optarg); break;
+			case 'k': strncpy(kernel_prefix, optarg, MAXCHAR - 1); break;
+			case 's': seed = strtoull(optarg, NULL, 10); break;
+			default: usage(); return ERROR_USAGE;
+		}
+	}
+	if (optind != argc - 1) {
+		usage();
+		return ERROR_USAGE;
+	}
+	if (num_reps < 1 || hyde_rows < 1 || num_lulc < 1 || group_size < 1) {
+		fprintf(stderr, "Invalid option value: num_reps, hyde_rows, num_lulc, and group_size must be positive\n");
+		return ERROR_USAGE;
+	}
+
+	if (make_path(scratch, "%s%s", argv[optind], (argv[optind][strlen(argv[optind]) - 1] != '/') ? "/" : "") ||
+		make_dir(scratch)) {
+		return ERROR_FILE;
+	}
+
+	// the moirai functions write their messages to the log file
+	if (make_path(fname, "%smoirai_microbench.log", scratch)) { return ERROR_FILE; }
+	if ((fplog = fopen(fname, "w")) == NULL) {
+		fprintf(stderr, "Failed to open file %s: moirai_microbench\n", fname);
+		return ERROR_FILE;
+	}
+	memset(&mb_args, 0, sizeof(args_struct));
+	memset(&mb_rinfo, 0, sizeof(rinfo_struct));
+	strcpy(mb_args.trace_fname, NONE_TEXT);
+
+	if ((err = setup_grid()) != OK || (err = setup_tables()) != OK) {
+		fprintf(stderr, "moirai_microbench terminated with error_code = %i\n", err);
+		return err;
+	}
+
+	fprintf(stdout, "# moirai_microbench: %i reps, best run reported; %s", num_reps, get_systime());
+	fprintf(stdout, "%-20s\t%-8s\t%12s\t%10s\t%12s\t%10s\n", "kernel", "units", "count", "best_sec", "ns_per_cell", "mb_per_sec");
+	if ((run_kernel("read_hyde32") && (err = bench_hyde32()) != OK) ||
+		(run_kernel("read_lulc_isam") && (err = bench_lulc_isam()) != OK) ||
+		(run_kernel("proc_lulc_area") && (err = bench_lulc_area()) != OK) ||
+		(run_kernel("read_protected") && (err = bench_protected()) != OK) ||
+		(run_kernel("lookup") && (err = bench_lookups()) != OK) ||
+		(run_kernel("carbon_quantile") && (err = bench_carbon_quantile()) != OK) ||
+		(run_kernel("write") && (err = bench_csv()) != OK)) {
+		fprintf(stderr, "moirai_microbench terminated with error_code = %i; see %s\n", err, fname);
+		return err;
+	}
+
+	fclose(fplog);
+	return OK;}
@@ -0,0 +1,371 @@
+/**********
+ moirai_reaggregate.c
+
+ rebuild the land type area table (iso,glu_code,land_type,year,value) for a new glu raster
+ 	from a per-cell land type area store written by a moirai run (see cell_store_fname and src/cell_store.c)
+ 	without reading and disaggregating the hyde and lulc data again
+
+ the store is memory mapped and its cells are summed in store order, which is the order of proc_land_type_area()
+ 	so the table is the same as the table of a moirai run with the new glu raster
+ each cell is added to the country X glu of its country in the store and its glu in the raster
+ 	cells with the raster nodata value are not added
+ the glus of each country are in increasing code order, and only positive values are written, as in proc_land_type_area()
+
+ the glu raster is read as read_aez_new() reads aez_new_fname: a BIL file with one band of 4 byte signed integers
+ 	on the working grid of the store (starting at the upper left corner), with nodata = NODATA
+ a region subset run stores only the cells in its subset box, so the new table covers only those cells
+
+ usage:
+ moirai_reaggregate [-o out_fname] cell_store_file glu_raster out_dir
+
+ 	-o out_fname:		name of the output table in out_dir; default Land_type_area_ha.csv
+ 	cell_store_file:	the store written by moirai, e.g. outputs/basins235/moirai_cell_store.bin
+ 	glu_raster:			the new glu raster
+ 	out_dir:			directory to write the table to
+
+ return value:
+ OK = 0 if the table is written
+ ERROR_USAGE for bad arguments, ERROR_FILE if a file cannot be read or written or the store is not valid,
+ ERROR_MEM if memory cannot be allocated, ERROR_IND if a land type category is not in the store
+
+ Created on 18 Oct 2026
+
+ Moirai Land Data System (Moirai) Copyright (c) 2019, The
+ Regents of the University of California, through Lawrence Berkeley National
+ Laboratory (subject to receipt of any required approvals from the U.S.
+ Dept. of Energy).  All rights reserved.
+
+ If you have questions about your rights to use or distribute this software,
+ please contact Berkeley Lab's Intellectual Property Office at
+ IPO@lbl.gov.
+
+ NOTICE.  This Software was developed under funding from the U.S. Department
+ of Energy and the U.S. Government consequently retains certain rights.  As
+ such, the U.S. Government has been granted for itself and others acting on
+ its behalf a paid-up, nonexclusive, irrevocable, worldwide license in the
+ Software to reproduce, distribute copies to the public, prepare derivative
+ works, and perform publicly and display publicly, and to permit other to do
+ so.
+
+ This file is part of Moirai.
+
+ Moirai is free software: you can use it under the terms of the modified BSD-3 license (see …/moirai/license.txt)
+ **********/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "moirai.h"
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define DEFAULT_OUT_FNAME	"Land_type_area_ha.csv"
+
+// size of a store section, padded to CELL_STORE_ALIGN bytes
+static size_t store_section(size_t size, size_t num) {
+	return (size * num + CELL_STORE_ALIGN - 1) / CELL_STORE_ALIGN * CELL_STORE_ALIGN;
+}
+
+static int cmp_int(const void *a, const void *b) {
+	int ia = *(const int *) a;
+	int ib = *(const int *) b;
+	return (ia > ib) - (ia < ib);
+}
+
+static void usage(void) {
+	fprintf(stderr, "usage: moirai_reaggregate [-o out_fname] cell_store_file glu_raster out_dir\n");
+}
+
+int main(int argc, char *argv[]) {
+
+	int opt;
+	int i, j, k, c, y;
+	int fd;
+	struct stat st;
+	char *store;						// the mapped store file
+	size_t offset;
+	size_t year_size;					// bytes of the columns of one year
+	cell_store_header_struct header;
+	int ncells;							// number of stored cells
+
+	// store sections
+	int *years;
+	int *lt_cats_store;
+	char *iso;
+	int *grid_ind;
+	int *ctry_ind;
+	float **prot;						// dim1 = protected category, dim2 = cell
+	double *refveg, *crop, *pasture, *urban;
+	int *rv;
+
+	char out_fname[MAXCHAR] = DEFAULT_OUT_FNAME;
+	char store_fname[MAXCHAR], glu_fname[MAXCHAR], fname[MAXCHAR];
+	FILE *fpin, *fpout;
+	int *glu;							// the new glu raster
+	size_t grid_ncells;
+
+	int *ctry_glu_num;					// number of glus in each country
+	int **ctry_glu_list;				// glu codes in each country, in increasing order
+	int *cell_slot;						// index of the cell glu in ctry_glu_list[ctry]; NOMATCH = no glu
+	int *lt_map;						// land type category index of each land type code; NOMATCH = none
+	int max_lt_code = 0;
+	double **area;						// dim1 = country, dim2 = glu X land type X year
+	double *cell_area;					// the areas of the current cell and year, in land use category order
+	int lu_codes[NUM_LU_CATS] = {0, CROP_LT_CODE, PASTURE_LT_CODE, URBAN_LT_CODE};
+	int lt_code, lt_ind;
+	int slot;
+	int *found;
+	float temp_frac;
+	double outval;
+	int nrecords = 0;
+
+	while ((opt = getopt(argc, argv, "o:")) != -1) {
+		switch (opt) {
+			case 'o': strncpy(out_fname, optarg, MAXCHAR - 1); break;
+			default: usage(); return ERROR_USAGE;
+		}
+	}
+	if (optind != argc - 3) {
+		usage();
+		return ERROR_USAGE;
+	}
+	strcpy(store_fname, argv[optind]);
+	strcpy(glu_fname, argv[optind + 1]);
+	strcpy(fname, argv[optind + 2]);
+	if (fname[strlen(fname) - 1] != '/') { strcat(fname, "/"); }
+	strcat(fname, out_fname);
+
+	// map the store and check its layout
+	if ((fd = open(store_fname, O_RDONLY)) < 0 || fstat(fd, &st) != 0) {
+		fprintf(stderr, "Failed to open file %s\n", store_fname);
+		return ERROR_FILE;
+	}
+	if ((size_t) st.st_size < sizeof(header)) {
+		fprintf(stderr, "File %s is not a moirai cell store\n", store_fname);
+		return ERROR_FILE;
+	}
+	store = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (store == MAP_FAILED) {
+		fprintf(stderr, "Failed to map file %s\n", store_fname);
+		return ERROR_FILE;
+	}
+	memcpy(&header, store, sizeof(header));
+	if (memcmp(header.magic, CELL_STORE_MAGIC, 8) != 0 || header.version != CELL_STORE_VERSION ||
+		header.num_protected != NUM_EPA_PROTECTED) {
+		fprintf(stderr, "File %s is not a version %i moirai cell store with %i protected categories\n", store_fname,
+				CELL_STORE_VERSION, NUM_EPA_PROTECTED);
+		return ERROR_FILE;
+	}
+	ncells = header.num_cells;
+
+	offset = store_section(sizeof(header), 1);
+	years = (int *) (store + offset);
+	offset += store_section(sizeof(int), header.num_years);
+	lt_cats_store = (int *) (store + offset);
+	offset += store_section(sizeof(int), header.num_lt_cats);
+	iso = store + offset;
+	offset += store_section(CELL_STORE_ISO_LEN, header.num_ctry);
+	grid_ind = (int *) (store + offset);
+	offset += store_section(sizeof(int), ncells);
+	ctry_ind = (int *) (store + offset);
+	offset += store_section(sizeof(int), ncells);
+	prot = calloc(NUM_EPA_PROTECTED, sizeof(float *));
+	if (prot == NULL) {
+		fprintf(stderr, "Failed to allocate memory for prot\n");
+		return ERROR_MEM;
+	}
+	for (k = 0; k < NUM_EPA_PROTECTED; k++) {
+		prot[k] = (float *) (store + offset);
+		offset += store_section(sizeof(float), ncells);
+	}
+	year_size = 4 * store_section(sizeof(double), ncells) + store_section(sizeof(int), ncells);
+	if ((size_t) st.st_size != offset + year_size * header.num_years) {
+		fprintf(stderr, "File %s has %lld bytes instead of %lld; it is incomplete\n", store_fname, (long long) st.st_size,
+				(long long) (offset + year_size * header.num_years));
+		return ERROR_FILE;
+	}
+
+	// read the glu raster
+	grid_ncells = (size_t) header.grid_nrows * header.grid_ncols;
+	glu = calloc(grid_ncells, sizeof(int));
+	if (glu == NULL) {
+		fprintf(stderr, "Failed to allocate memory for glu\n");
+		return ERROR_MEM;
+	}
+	if ((fpin = fopen(glu_fname, "rb")) == NULL) {
+		fprintf(stderr, "Failed to open file %s\n", glu_fname);
+		return ERROR_FILE;
+	}
+	if (fread(glu, sizeof(int), grid_ncells, fpin) != grid_ncells) {
+		fprintf(stderr, "Error reading file %s: it is not a %i X %i grid of 4 byte integers\n", glu_fname,
+				header.grid_nrows, header.grid_ncols);
+		return ERROR_FILE;
+	}
+	fclose(fpin);
+
+	// the glus of each country
+	ctry_glu_num = calloc(header.num_ctry, sizeof(int));
+	ctry_glu_list = calloc(header.num_ctry, sizeof(int *));
+	cell_slot = calloc(ncells, sizeof(int));
+	if (ctry_glu_num == NULL || ctry_glu_list == NULL || cell_slot == NULL) {
+		fprintf(stderr, "Failed to allocate memory for the country glu lists\n");
+		return ERROR_MEM;
+	}
+	for (c = 0; c < ncells; c++) {
+		if (glu[grid_ind[c]] == NODATA) {
+			continue;
+		}
+		i = ctry_ind[c];
+		for (j = 0; j < ctry_glu_num[i]; j++) {
+			if (ctry_glu_list[i][j] == glu[grid_ind[c]]) {
+				break;
+			}
+		}
+		if (j == ctry_glu_num[i]) {
+			ctry_glu_list[i] = realloc(ctry_glu_list[i], (ctry_glu_num[i] + 1) * sizeof(int));
+			if (ctry_glu_list[i] == NULL) {
+				fprintf(stderr, "Failed to allocate memory for ctry_glu_list[%i]\n", i);
+				return ERROR_MEM;
+			}
+			ctry_glu_list[i][ctry_glu_num[i]++] = glu[grid_ind[c]];
+		}
+	}
+	for (i = 0; i < header.num_ctry; i++) {
+		if (ctry_glu_num[i] > 0) {
+			qsort(ctry_glu_list[i], ctry_glu_num[i], sizeof(int), cmp_int);
+		}
+	}
+	for (c = 0; c < ncells; c++) {
+		cell_slot[c] = NOMATCH;
+		if (glu[grid_ind[c]] != NODATA) {
+			i = ctry_ind[c];
+			found = bsearch(&glu[grid_ind[c]], ctry_glu_list[i], ctry_glu_num[i], sizeof(int), cmp_int);
+			cell_slot[c] = (int) (found - ctry_glu_list[i]);
+		}
+	}
+
+	// the land type category index of each code
+	for (i = 0; i < header.num_lt_cats; i++) {
+		if (lt_cats_store[i] > max_lt_code) {
+			max_lt_code = lt_cats_store[i];
+		}
+	}
+	lt_map = calloc(max_lt_code + 1, sizeof(int));
+	if (lt_map == NULL) {
+		fprintf(stderr, "Failed to allocate memory for lt_map\n");
+		return ERROR_MEM;
+	}
+	for (i = 0; i <= max_lt_code; i++) {
+		lt_map[i] = NOMATCH;
+	}
+	for (i = 0; i < header.num_lt_cats; i++) {
+		if (lt_cats_store[i] >= 0) {
+			lt_map[lt_cats_store[i]] = i;
+		}
+	}
+
+	area = calloc(header.num_ctry, sizeof(double *));
+	if (area == NULL) {
+		fprintf(stderr, "Failed to allocate memory for area\n");
+		return ERROR_MEM;
+	}
+	for (i = 0; i < header.num_ctry; i++) {
+		area[i] = calloc((size_t) ctry_glu_num[i] * header.num_lt_cats * header.num_years + 1, sizeof(double));
+		if (area[i] == NULL) {
+			fprintf(stderr, "Failed to allocate memory for area[%i]\n", i);
+			return ERROR_MEM;
+		}
+	}
+	cell_area = calloc(NUM_LU_CATS, sizeof(double));
+	if (cell_area == NULL) {
+		fprintf(stderr, "Failed to allocate memory for cell_area\n");
+		return ERROR_MEM;
+	}
+
+	// add the cells to the country X glu X land type X year table, as proc_land_type_area() does
+	for (y = 0; y < header.num_years; y++) {
+		refveg = (double *) (store + offset);
+		crop = (double *) (store + offset + store_section(sizeof(double), ncells));
+		pasture = (double *) (store + offset + 2 * store_section(sizeof(double), ncells));
+		urban = (double *) (store + offset + 3 * store_section(sizeof(double), ncells));
+		rv = (int *) (store + offset + 4 * store_section(sizeof(double), ncells));
+		offset += year_size;
+
+		for (c = 0; c < ncells; c++) {
+			if (cell_slot[c] == NOMATCH) {
+				continue;
+			}
+			i = ctry_ind[c];
+			slot = cell_slot[c];
+			cell_area[0] = refveg[c];
+			cell_area[1] = crop[c];
+			cell_area[2] = pasture[c];
+			cell_area[3] = urban[c];
+			for (k = 0; k < NUM_EPA_PROTECTED; k++) {
+				temp_frac = prot[k][c];
+				for (j = 0; j < NUM_LU_CATS; j++) {
+					lt_code = rv[c] * SCALE_POTVEG + lu_codes[j] + k;
+					if (lt_code < 0 || lt_code > max_lt_code || (lt_ind = lt_map[lt_code]) == NOMATCH) {
+						fprintf(stderr, "Failed to match lt_cat %i for cell %i\n", lt_code, grid_ind[c]);
+						return ERROR_IND;
+					}
+					// the reference veg nodata value is NODATA, and the land use nodata value is lu_nodata
+					if ((j == 0 && cell_area[j] != header.refveg_nodata) || (j > 0 && cell_area[j] != header.lu_nodata)) {
+						area[i][((size_t) slot * header.num_lt_cats + lt_ind) * header.num_years + y] =
+							area[i][((size_t) slot * header.num_lt_cats + lt_ind) * header.num_years + y] +
+							(cell_area[j] * temp_frac);
+					}
+				}
+			}
+		} // end for c loop over the stored cells
+	} // end for y loop over the years
+
+	// write the table in the proc_land_type_area() format
+	if ((fpout = fopen(fname, "w")) == NULL) {
+		fprintf(stderr, "Failed to open file %s for write\n", fname);
+		return ERROR_FILE;
+	}
+	fprintf(fpout,"# File: %s\n", fname);
+	fprintf(fpout,"# Author: %s\n", CODENAME);
+	fprintf(fpout,"# Description: area (ha) for land cells in country X glu X land type X protected category X year\n");
+	fprintf(fpout,"# Original source: cell store %s; glu raster %s\n", store_fname, glu_fname);
+	fprintf(fpout,"# ----------\n");
+	fprintf(fpout,"iso,glu_code,land_type,year,value");
+	for (i = 0; i < header.num_ctry; i++) {
+		for (j = 0; j < ctry_glu_num[i]; j++) {
+			for (lt_ind = 0; lt_ind < header.num_lt_cats; lt_ind++) {
+				for (y = 0; y < header.num_years; y++) {
+					outval = floor(0.5 + area[i][((size_t) j * header.num_lt_cats + lt_ind) * header.num_years + y] * KMSQ2HA);
+					// output only positive values
+					if (outval > 0) {
+						fprintf(fpout,"\n%.*s,%i,%i,%i,%.0lf", CELL_STORE_ISO_LEN, iso + (size_t) i * CELL_STORE_ISO_LEN,
+								ctry_glu_list[i][j], lt_cats_store[lt_ind], years[y], outval);
+						nrecords++;
+					}
+				}
+			}
+		}
+	}
+	if (fclose(fpout) != 0) {
+		fprintf(stderr, "Error writing file %s\n", fname);
+		return ERROR_FILE;
+	}
+	fprintf(stdout, "Wrote file %s: %i cells X %i years; records written=%i\n", fname, ncells, header.num_years, nrecords);
+
+	for (i = 0; i < header.num_ctry; i++) {
+		free(area[i]);
+		free(ctry_glu_list[i]);
+	}
+	free(area);
+	free(ctry_glu_list);
+	free(ctry_glu_num);
+	free(cell_slot);
+	free(cell_area);
+	free(lt_map);
+	free(glu);
+	free(prot);
+	munmap(store, st.st_size);
+
+	return OK;}